@@ -0,0 +1,521 @@
+/*
+ *   Copyright (c) 2022 Project CHIP Authors
+ *   All rights reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ *
+ */
+
+#include "BatchReadCommand.h"
+
+#include <app/InteractionModelEngine.h>
+#include <lib/support/jsontlv/TlvJson.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <inttypes.h>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+using namespace ::chip;
+using namespace ::chip::app;
+
+namespace {
+
+constexpr uint16_t kDefaultMaxInFlight = 16;
+
+uint64_t NowMs()
+{
+    return System::SystemClock().GetMonotonicMilliseconds64().count();
+}
+
+template <typename T>
+bool ParseId(const std::string & token, T wildcard, T & out)
+{
+    if (token == "*")
+    {
+        out = wildcard;
+        return true;
+    }
+
+    VerifyOrReturnValue(!token.empty() && token[0] != '-', false);
+
+    char * end = nullptr;
+    errno      = 0;
+
+    unsigned long long value = strtoull(token.c_str(), &end, 0);
+    VerifyOrReturnValue(errno == 0 && *end == '\0' && value <= std::numeric_limits<T>::max(), false);
+
+    out = static_cast<T>(value);
+    return true;
+}
+
+void PutNodeId(JsonWriter & writer, NodeId nodeId)
+{
+    char buffer[2 + 16 + 1];
+    snprintf(buffer, sizeof(buffer), "0x" ChipLogFormatX64, ChipLogValueX64(nodeId));
+    writer.PutKey(CharSpan::fromCharString("node"));
+    writer.PutString(CharSpan::fromCharString(buffer));
+}
+
+void PutError(JsonWriter & writer, CHIP_ERROR error)
+{
+    writer.PutKey(CharSpan::fromCharString("error"));
+    writer.PutString(CharSpan::fromCharString(ErrorStr(error)));
+}
+
+void PutUnsigned(JsonWriter & writer, const char * key, uint64_t value)
+{
+    writer.PutKey(CharSpan::fromCharString(key));
+    writer.Put(value);
+}
+
+} // namespace
+
+BatchReadCommand::BatchReadCommand(const char * commandName, ReadClient::InteractionType interactionType,
+                                   CredentialIssuerCommands * credsIssuerConfig) :
+    CHIPCommand(commandName, credsIssuerConfig),
+    mInteractionType(interactionType)
+{
+    AddArgument("targets", &mTargetsPath,
+                "Path to a file listing one \"<node-id> <endpoint-id> <cluster-id> <attribute-id>\" target per line, or \"-\" to "
+                "read them from stdin.\n  Endpoint, cluster and attribute ids may be \"*\" to indicate a wildcard.");
+    if (IsSubscription())
+    {
+        AddArgument("min-interval", 0, UINT16_MAX, &mMinInterval,
+                    "Server should not send a new report if less than this number of seconds has elapsed since the last report.");
+        AddArgument("max-interval", 0, UINT16_MAX, &mMaxInterval,
+                    "Server must send a report if this number of seconds has elapsed since the last report.");
+    }
+    AddArgument("max-in-flight", 1, UINT16_MAX, &mMaxInFlight, "Number of targets in progress at once. Defaults to 16.");
+    AddArgument("output", &mOutputPath, "Path to the file the NDJSON records are written to. Defaults to stdout.");
+    AddArgument("fabric-filtered", 0, 1, &mFabricFiltered,
+                "Boolean indicating whether to do fabric-filtered reads. Defaults to true.");
+    AddArgument("timeout", 0, UINT16_MAX, &mTimeout,
+                "Time, in seconds, before the whole batch is considered to have timed out. Defaults to 120.");
+}
+
+CHIP_ERROR BatchReadCommand::RunCommand()
+{
+    // Starting another batch drops the subscriptions of the previous one
+    mTargets.clear();
+    CloseOutput();
+
+    ReturnErrorOnFailure(LoadTargets());
+    if (mTargets.empty())
+    {
+        ChipLogError(chipTool, "No targets to read");
+        return CHIP_ERROR_INVALID_ARGUMENT;
+    }
+    ReturnErrorOnFailure(OpenOutput());
+
+    mNextTarget   = 0;
+    mInFlight     = 0;
+    mCompleted    = 0;
+    mFinished     = false;
+    mStatus       = CHIP_NO_ERROR;
+    mBatchStartMs = NowMs();
+
+    ChipLogProgress(chipTool, "Batch %s of %u targets, %u at a time", IsSubscription() ? "subscription" : "read",
+                    static_cast<unsigned>(mTargets.size()), mMaxInFlight.ValueOr(kDefaultMaxInFlight));
+
+    StartTargets();
+    return CHIP_NO_ERROR;
+}
+
+void BatchReadCommand::Shutdown()
+{
+    // Established subscriptions are kept until Cleanup, but no target may start anymore
+    mNextTarget = mTargets.size();
+
+    // The batch timed out: still report the targets which completed
+    if (!mFinished && mOutput != nullptr)
+    {
+        mFinished = true;
+        WriteSummaryRecord();
+    }
+
+    CHIPCommand::Shutdown();
+}
+
+void BatchReadCommand::Cleanup()
+{
+    mTargets.clear();
+    CloseOutput();
+}
+
+CHIP_ERROR BatchReadCommand::LoadTargets()
+{
+    std::ifstream file;
+    std::istream * input = &std::cin;
+    if (strcmp(mTargetsPath, "-") != 0)
+    {
+        file.open(mTargetsPath);
+        if (!file.is_open())
+        {
+            ChipLogError(chipTool, "Can not open %s", mTargetsPath);
+            return CHIP_ERROR_OPEN_FAILED;
+        }
+        input = &file;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(*input, line))
+    {
+        lineNumber++;
+
+        std::istringstream tokens(line.substr(0, line.find('#')));
+        std::string nodeId, endpointId, clusterId, attributeId, extra;
+        if (!(tokens >> nodeId))
+        {
+            continue;
+        }
+
+        NodeId node;
+        AttributePathParams path;
+        bool valid = (tokens >> endpointId >> clusterId >> attributeId) && !(tokens >> extra);
+        valid      = valid && ParseId(nodeId, kUndefinedNodeId, node) && node != kUndefinedNodeId;
+        valid      = valid && ParseId(endpointId, kInvalidEndpointId, path.mEndpointId);
+        valid      = valid && ParseId(clusterId, kInvalidClusterId, path.mClusterId);
+        valid      = valid && ParseId(attributeId, kInvalidAttributeId, path.mAttributeId);
+        if (!valid)
+        {
+            ChipLogError(chipTool, "Invalid target on line %u: %s", static_cast<unsigned>(lineNumber), line.c_str());
+            return CHIP_ERROR_INVALID_ARGUMENT;
+        }
+
+        mTargets.push_back(std::make_unique<Target>(*this, mTargets.size(), node, path));
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR BatchReadCommand::OpenOutput()
+{
+    if (!mOutputPath.HasValue())
+    {
+        mOutput = stdout;
+        return CHIP_NO_ERROR;
+    }
+
+    mOutput = fopen(mOutputPath.Value(), "w");
+    if (mOutput == nullptr)
+    {
+        ChipLogError(chipTool, "Can not open %s for writing", mOutputPath.Value());
+        return CHIP_ERROR_OPEN_FAILED;
+    }
+    return CHIP_NO_ERROR;
+}
+
+void BatchReadCommand::CloseOutput()
+{
+    if (mOutput != nullptr && mOutput != stdout)
+    {
+        fclose(mOutput);
+    }
+    mOutput = nullptr;
+}
+
+void BatchReadCommand::StartTargets()
+{
+    // Targets may complete before Start returns, e.g. when the session with their node already exists
+    VerifyOrReturn(!mStartingTargets);
+    mStartingTargets = true;
+
+    const size_t maxInFlight = mMaxInFlight.ValueOr(kDefaultMaxInFlight);
+    while (mInFlight < maxInFlight && mNextTarget < mTargets.size())
+    {
+        Target & target = *mTargets[mNextTarget++];
+        mInFlight++;
+        target.Start();
+    }
+
+    mStartingTargets = false;
+
+    if (mCompleted == mTargets.size() && !mFinished)
+    {
+        Finish();
+    }
+}
+
+void BatchReadCommand::OnTargetComplete(Target & target)
+{
+    mInFlight--;
+    mCompleted++;
+    if (target.mError != CHIP_NO_ERROR)
+    {
+        mStatus = target.mError;
+    }
+
+    WriteTargetRecord(target);
+    StartTargets();
+}
+
+void BatchReadCommand::Finish()
+{
+    mFinished = true;
+    WriteSummaryRecord();
+
+    // The records already report the outcome of every target: the exit status only tells whether all of them succeeded
+    SetCommandExitStatus(mStatus);
+}
+
+void BatchReadCommand::WriteAttributeRecord(const Target & target, const ConcreteDataAttributePath & path, TLV::TLVReader * data,
+                                            const StatusIB & status)
+{
+    auto startRecord = [&](std::string & record) {
+        JsonWriter writer(record);
+        writer.StartObject();
+        writer.PutKey(CharSpan::fromCharString("type"));
+        writer.PutString(CharSpan::fromCharString("attribute"));
+        PutUnsigned(writer, "target", target.mIndex);
+        PutNodeId(writer, target.mNodeId);
+        PutUnsigned(writer, "endpoint", path.mEndpointId);
+        PutUnsigned(writer, "cluster", path.mClusterId);
+        PutUnsigned(writer, "attribute", path.mAttributeId);
+        if (path.mDataVersion.HasValue())
+        {
+            PutUnsigned(writer, "dataVersion", path.mDataVersion.Value());
+        }
+        return writer;
+    };
+
+    CHIP_ERROR error = status.ToChipError();
+    if (error == CHIP_NO_ERROR && data == nullptr)
+    {
+        error = CHIP_ERROR_INTERNAL;
+    }
+
+    std::string record;
+    if (error == CHIP_NO_ERROR)
+    {
+        JsonWriter writer = startRecord(record);
+        writer.PutKey(CharSpan::fromCharString("value"));
+        error = TlvToJson(*data, writer);
+        writer.EndObject();
+    }
+
+    if (error != CHIP_NO_ERROR)
+    {
+        // Also replaces a partially converted value
+        record.clear();
+        JsonWriter writer = startRecord(record);
+        PutError(writer, error);
+        writer.EndObject();
+    }
+
+    WriteRecord(record);
+}
+
+void BatchReadCommand::WriteTargetRecord(const Target & target)
+{
+    std::string record;
+    JsonWriter writer(record);
+
+    writer.StartObject();
+    writer.PutKey(CharSpan::fromCharString("type"));
+    writer.PutString(CharSpan::fromCharString("target"));
+    PutUnsigned(writer, "target", target.mIndex);
+    PutNodeId(writer, target.mNodeId);
+    PutUnsigned(writer, "reports", target.mReports);
+    PutUnsigned(writer, "sessionMs", target.mSessionMs);
+    PutUnsigned(writer, "latencyMs", target.mLatencyMs);
+    if (target.mError != CHIP_NO_ERROR)
+    {
+        PutError(writer, target.mError);
+    }
+    writer.EndObject();
+
+    WriteRecord(record);
+}
+
+void BatchReadCommand::WriteSummaryRecord()
+{
+    std::vector<uint64_t> latencies;
+    for (const auto & target : mTargets)
+    {
+        if (target->mDone && target->mError == CHIP_NO_ERROR)
+        {
+            latencies.push_back(target->mLatencyMs);
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    // Nearest-rank percentile of the successful targets
+    auto percentile = [&latencies](unsigned p) -> uint64_t {
+        size_t rank = (latencies.size() * p + 99) / 100;
+        return latencies[rank > 0 ? rank - 1 : 0];
+    };
+
+    const uint64_t elapsedMs = NowMs() - mBatchStartMs;
+    const size_t failed      = mCompleted - latencies.size();
+    const size_t incomplete  = mTargets.size() - mCompleted;
+
+    std::string record;
+    JsonWriter writer(record);
+
+    writer.StartObject();
+    writer.PutKey(CharSpan::fromCharString("type"));
+    writer.PutString(CharSpan::fromCharString("summary"));
+    PutUnsigned(writer, "targets", mTargets.size());
+    PutUnsigned(writer, "succeeded", latencies.size());
+    PutUnsigned(writer, "failed", failed);
+    PutUnsigned(writer, "incomplete", incomplete);
+    PutUnsigned(writer, "elapsedMs", elapsedMs);
+    if (!latencies.empty())
+    {
+        uint64_t total = 0;
+        for (uint64_t latency : latencies)
+        {
+            total += latency;
+        }
+
+        writer.PutKey(CharSpan::fromCharString("latencyMs"));
+        writer.StartObject();
+        PutUnsigned(writer, "min", latencies.front());
+        PutUnsigned(writer, "mean", total / latencies.size());
+        PutUnsigned(writer, "p50", percentile(50));
+        PutUnsigned(writer, "p90", percentile(90));
+        PutUnsigned(writer, "p99", percentile(99));
+        PutUnsigned(writer, "max", latencies.back());
+        writer.EndObject();
+    }
+    writer.EndObject();
+
+    WriteRecord(record);
+
+    ChipLogProgress(chipTool, "Batch done in %" PRIu64 "ms: %u succeeded, %u failed, %u incomplete", elapsedMs,
+                    static_cast<unsigned>(latencies.size()), static_cast<unsigned>(failed), static_cast<unsigned>(incomplete));
+    if (!latencies.empty())
+    {
+        ChipLogProgress(chipTool, "Latency (ms): min %" PRIu64 ", p50 %" PRIu64 ", p90 %" PRIu64 ", p99 %" PRIu64 ", max %" PRIu64,
+                        latencies.front(), percentile(50), percentile(90), percentile(99), latencies.back());
+    }
+}
+
+void BatchReadCommand::WriteRecord(const std::string & record)
+{
+    VerifyOrReturn(mOutput != nullptr);
+
+    fputs(record.c_str(), mOutput);
+    fputc('\n', mOutput);
+    // Records are consumed as they are received
+    fflush(mOutput);
+}
+
+BatchReadCommand::Target::Target(BatchReadCommand & command, size_t index, NodeId nodeId, const AttributePathParams & path) :
+    mCommand(command), mIndex(index), mNodeId(nodeId), mPath(path), mOnDeviceConnectedCallback(OnDeviceConnectedFn, this),
+    mOnDeviceConnectionFailureCallback(OnDeviceConnectionFailureFn, this)
+{}
+
+BatchReadCommand::Target::~Target()
+{
+    mOnDeviceConnectedCallback.Cancel();
+    mOnDeviceConnectionFailureCallback.Cancel();
+}
+
+void BatchReadCommand::Target::Start()
+{
+    mStartMs = NowMs();
+
+    CHIP_ERROR err = mCommand.CurrentCommissioner().GetConnectedDevice(mNodeId, &mOnDeviceConnectedCallback,
+                                                                       &mOnDeviceConnectionFailureCallback);
+    if (err != CHIP_NO_ERROR)
+    {
+        Complete(err);
+    }
+}
+
+void BatchReadCommand::Target::OnDeviceConnectedFn(void * context, Messaging::ExchangeManager & exchangeMgr,
+                                                   SessionHandle & sessionHandle)
+{
+    Target * target    = static_cast<Target *>(context);
+    target->mSessionMs = NowMs() - target->mStartMs;
+
+    CHIP_ERROR err = target->SendRequest(exchangeMgr, sessionHandle);
+    if (err != CHIP_NO_ERROR)
+    {
+        target->mClient.reset();
+        target->Complete(err);
+    }
+}
+
+void BatchReadCommand::Target::OnDeviceConnectionFailureFn(void * context, const ScopedNodeId & peerId, CHIP_ERROR error)
+{
+    Target * target    = static_cast<Target *>(context);
+    target->mSessionMs = NowMs() - target->mStartMs;
+    target->Complete(error);
+}
+
+CHIP_ERROR BatchReadCommand::Target::SendRequest(Messaging::ExchangeManager & exchangeMgr, const SessionHandle & sessionHandle)
+{
+    ReadPrepareParams params(sessionHandle);
+    params.mpAttributePathParamsList    = &mPath;
+    params.mAttributePathParamsListSize = 1;
+    params.mIsFabricFiltered            = mCommand.mFabricFiltered.ValueOr(true);
+    if (mCommand.IsSubscription())
+    {
+        params.mMinIntervalFloorSeconds   = mCommand.mMinInterval;
+        params.mMaxIntervalCeilingSeconds = mCommand.mMaxInterval;
+    }
+
+    mClient = std::make_unique<ReadClient>(InteractionModelEngine::GetInstance(), &exchangeMgr, *this, mCommand.mInteractionType);
+    return mClient->SendRequest(params);
+}
+
+void BatchReadCommand::Target::OnAttributeData(const ConcreteDataAttributePath & path, TLV::TLVReader * data,
+                                               const StatusIB & status)
+{
+    mReports++;
+    mCommand.WriteAttributeRecord(*this, path, data, status);
+}
+
+void BatchReadCommand::Target::OnError(CHIP_ERROR error)
+{
+    mError = error;
+}
+
+void BatchReadCommand::Target::OnSubscriptionEstablished(SubscriptionId subscriptionId)
+{
+    Complete(CHIP_NO_ERROR);
+}
+
+void BatchReadCommand::Target::OnDone(ReadClient * client)
+{
+    mClient.reset();
+
+    if (mDone)
+    {
+        // An established subscription was terminated
+        ChipLogError(chipTool, "Subscription for target %u terminated: %" CHIP_ERROR_FORMAT, static_cast<unsigned>(mIndex),
+                     mError.Format());
+        return;
+    }
+
+    Complete(mError);
+}
+
+void BatchReadCommand::Target::Complete(CHIP_ERROR error)
+{
+    VerifyOrReturn(!mDone);
+
+    mDone      = true;
+    mError     = error;
+    mLatencyMs = NowMs() - mStartMs;
+    mCommand.OnTargetComplete(*this);
+}
@@ -0,0 +1,161 @@
+/*
+ *   Copyright (c) 2022 Project CHIP Authors
+ *   All rights reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include "../common/CHIPCommand.h"
+
+#include <app/AttributePathParams.h>
+#include <app/ReadClient.h>
+#include <lib/core/CHIPCallback.h>
+#include <lib/support/jsontlv/JsonWriter.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Reads, or subscribes to, a list of (node, attribute path) targets.
+ *
+ * The targets are read from a file, or from stdin, with one
+ * "<node-id> <endpoint-id> <cluster-id> <attribute-id>" target per line. Ids
+ * are decimal or 0x-prefixed hexadecimal, and endpoint, cluster and attribute
+ * ids may be "*" for wildcards. Empty lines and lines starting with '#' are
+ * ignored.
+ *
+ * Up to `max-in-flight` targets are in progress at once, each with its own
+ * ReadClient: the CASE sessions with different nodes are established, and the
+ * interactions run, concurrently, while targets for the same node share its
+ * session.
+ *
+ * Every attribute report and every target outcome is written as one JSON
+ * object per line (NDJSON) as soon as it is received, followed by a summary
+ * record holding the latency statistics of the batch. The summary is written
+ * when the batch times out too, counting the targets that did not complete.
+ */
+class BatchReadCommand : public CHIPCommand
+{
+public:
+    BatchReadCommand(const char * commandName, chip::app::ReadClient::InteractionType interactionType,
+                     CredentialIssuerCommands * credsIssuerConfig);
+
+    /////////// CHIPCommand Interface /////////
+    CHIP_ERROR RunCommand() override;
+    chip::System::Clock::Timeout GetWaitDuration() const override { return chip::System::Clock::Seconds16(mTimeout.ValueOr(120)); }
+
+    void Shutdown() override;
+    void Cleanup() override;
+
+    // Subscriptions stay established until interactive mode is left.
+    bool DeferInteractiveCleanup() override { return IsSubscription(); }
+
+private:
+    class Target : public chip::app::ReadClient::Callback
+    {
+    public:
+        Target(BatchReadCommand & command, size_t index, chip::NodeId nodeId, const chip::app::AttributePathParams & path);
+        ~Target() override;
+
+        void Start();
+
+        /////////// ReadClient Callback Interface /////////
+        void OnAttributeData(const chip::app::ConcreteDataAttributePath & path, chip::TLV::TLVReader * data,
+                             const chip::app::StatusIB & status) override;
+        void OnError(CHIP_ERROR error) override;
+        void OnSubscriptionEstablished(chip::SubscriptionId subscriptionId) override;
+        void OnDone(chip::app::ReadClient * client) override;
+
+        BatchReadCommand & mCommand;
+        const size_t mIndex;
+        const chip::NodeId mNodeId;
+        chip::app::AttributePathParams mPath;
+
+        bool mDone        = false;
+        CHIP_ERROR mError = CHIP_NO_ERROR;
+        uint32_t mReports = 0;
+        uint64_t mStartMs = 0;
+        // Time to get a session, and to complete the target, from its start
+        uint64_t mSessionMs = 0;
+        uint64_t mLatencyMs = 0;
+
+    private:
+        static void OnDeviceConnectedFn(void * context, chip::Messaging::ExchangeManager & exchangeMgr,
+                                        chip::SessionHandle & sessionHandle);
+        static void OnDeviceConnectionFailureFn(void * context, const chip::ScopedNodeId & peerId, CHIP_ERROR error);
+
+        CHIP_ERROR SendRequest(chip::Messaging::ExchangeManager & exchangeMgr, const chip::SessionHandle & sessionHandle);
+        void Complete(CHIP_ERROR error);
+
+        std::unique_ptr<chip::app::ReadClient> mClient;
+        chip::Callback::Callback<chip::OnDeviceConnected> mOnDeviceConnectedCallback;
+        chip::Callback::Callback<chip::OnDeviceConnectionFailure> mOnDeviceConnectionFailureCallback;
+    };
+
+    bool IsSubscription() const { return mInteractionType == chip::app::ReadClient::InteractionType::Subscribe; }
+
+    CHIP_ERROR LoadTargets();
+    CHIP_ERROR OpenOutput();
+    void CloseOutput();
+
+    /// Start targets while under the in-flight limit, and finish the batch once all completed.
+    void StartTargets();
+    void OnTargetComplete(Target & target);
+    void Finish();
+
+    void WriteAttributeRecord(const Target & target, const chip::app::ConcreteDataAttributePath & path,
+                              chip::TLV::TLVReader * data, const chip::app::StatusIB & status);
+    void WriteTargetRecord(const Target & target);
+    void WriteSummaryRecord();
+    void WriteRecord(const std::string & record);
+
+    const chip::app::ReadClient::InteractionType mInteractionType;
+
+    char * mTargetsPath;
+    uint16_t mMinInterval = 0;
+    uint16_t mMaxInterval = 0;
+    chip::Optional<uint16_t> mMaxInFlight;
+    chip::Optional<char *> mOutputPath;
+    chip::Optional<bool> mFabricFiltered;
+    chip::Optional<uint16_t> mTimeout;
+
+    std::vector<std::unique_ptr<Target>> mTargets;
+    FILE * mOutput         = nullptr;
+    size_t mNextTarget     = 0;
+    size_t mInFlight       = 0;
+    size_t mCompleted      = 0;
+    bool mStartingTargets  = false;
+    bool mFinished         = false;
+    uint64_t mBatchStartMs = 0;
+    CHIP_ERROR mStatus     = CHIP_NO_ERROR;
+};
+
+class BatchRead : public BatchReadCommand
+{
+public:
+    BatchRead(CredentialIssuerCommands * credsIssuerConfig) :
+        BatchReadCommand("read", chip::app::ReadClient::InteractionType::Read, credsIssuerConfig)
+    {}
+};
+
+class BatchSubscribe : public BatchReadCommand
+{
+public:
+    BatchSubscribe(CredentialIssuerCommands * credsIssuerConfig) :
+        BatchReadCommand("subscribe", chip::app::ReadClient::InteractionType::Subscribe, credsIssuerConfig)
+    {}
+};
@@ -102,12 +102,24 @@ public:
      */
     const char * GetFileDesignator() const { return mFileDesignator; }
 
+    bool IsInUse() const { return mInitialized; }
+    bool IsTransferringTo(chip::FabricIndex fabricIndex, chip::NodeId nodeId) const
+    {
+        return mInitialized && mFabricIndex.ValueOr(chip::kUndefinedFabricIndex) == fabricIndex &&
+            mNodeId.ValueOr(chip::kUndefinedNodeId) == nodeId;
+    }
+
+    // Whether the requestor has started the transfer it was initialized for
+    bool HasTransferStarted() const { return mExchangeCtx != nullptr; }
+
+    uint64_t GetBytesSent() const { return mNumBytesSent; }
+
+    void Reset();
+
 private:
     // Inherited from bdx::TransferFacilitator
     void HandleTransferSessionOutput(chip::bdx::TransferSession::OutputEvent & event) override;
 
-    void Reset();
-
     uint32_t mNumBytesSent = 0;
 
     bool mInitialized = false;
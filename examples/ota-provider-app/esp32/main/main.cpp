@@ -77,12 +77,11 @@ static void InitServer(intptr_t context)
 {
     Esp32AppServer::Init(); // Init ZCL Data Model and CHIP App Server AND Initialize device attestation config
 
-    BdxOtaSender * bdxOtaSender = otaProvider.GetBdxOtaSender();
-    VerifyOrReturn(bdxOtaSender != nullptr, ESP_LOGE(TAG, "bdxOtaSender is nullptr"));
+    BdxOtaSender * bdxOtaSender = &otaProvider.GetBdxOtaSenderPool().GetSender(0);
 
     // Register handler to handle bdx messages
     CHIP_ERROR error = chip::Server::GetInstance().GetExchangeManager().RegisterUnsolicitedMessageHandlerForProtocol(
-        chip::Protocols::BDX::Id, bdxOtaSender);
+        chip::Protocols::BDX::Id, &otaProvider.GetBdxOtaSenderPool());
     if (error != CHIP_NO_ERROR)
     {
         ESP_LOGE(TAG, "RegisterUnsolicitedMessageHandler failed: %s", chip::ErrorStr(error));
@@ -156,8 +155,7 @@ DeviceLayer::DeviceInfoProviderImpl gExampleDeviceInfoProvider;
 
 CHIP_ERROR OnBlockQuery(void * context, chip::System::PacketBufferHandle & blockBuf, size_t & size, bool & isEof, uint32_t offset)
 {
-    BdxOtaSender * bdxOtaSender = otaProvider.GetBdxOtaSender();
-    VerifyOrReturnError(bdxOtaSender != nullptr, CHIP_ERROR_INCORRECT_STATE);
+    BdxOtaSender * bdxOtaSender = &otaProvider.GetBdxOtaSenderPool().GetSender(0);
 
     if (otaTransferInProgress == false)
     {
@@ -22,7 +22,7 @@
 #include <app/server/Server.h>
 #include <app/util/util.h>
 #include <json/json.h>
-#include <ota-provider-common/BdxOtaSender.h>
+#include <ota-provider-common/BdxOtaSenderPool.h>
 #include <ota-provider-common/OTAProviderExample.h>
 
 #include "AppMain.h"
@@ -50,6 +50,7 @@ constexpr uint16_t kOptionImageUri                  = 'i';
 constexpr uint16_t kOptionOtaImageList              = 'o';
 constexpr uint16_t kOptionDelayedApplyActionTimeSec = 'p';
 constexpr uint16_t kOptionQueryImageStatus          = 'q';
+constexpr uint16_t kOptionMaxBytesPerSecond         = 'r';
 constexpr uint16_t kOptionDelayedQueryActionTimeSec = 't';
 constexpr uint16_t kOptionUserConsentState          = 'u';
 constexpr uint16_t kOptionIgnoreQueryImage          = 'x';
@@ -72,6 +73,7 @@ static bool gUserConsentNeeded                       = false;
 static uint32_t gIgnoreQueryImageCount               = 0;
 static uint32_t gIgnoreApplyUpdateCount              = 0;
 static uint32_t gPollInterval                        = 0;
+static uint32_t gMaxBytesPerSecond                   = 0;
 
 // Parses the JSON filepath and extracts DeviceSoftwareVersionModel parameters
 static bool ParseJsonFileAndPopulateCandidates(const char * filepath,
@@ -245,6 +247,9 @@ bool HandleOptions(const char * aProgram, OptionSet * aOptions, int aIdentifier,
     case kOptionPollInterval:
         gPollInterval = static_cast<uint32_t>(strtoul(aValue, NULL, 0));
         break;
+    case kOptionMaxBytesPerSecond:
+        gMaxBytesPerSecond = static_cast<uint32_t>(strtoul(aValue, NULL, 0));
+        break;
 
     default:
         PrintArgError("%s: INTERNAL ERROR: Unhandled option: %s\n", aProgram, aName);
@@ -263,6 +268,7 @@ OptionDef cmdLineOptionsDef[] = {
     { "otaImageList", chip::ArgParser::kArgumentRequired, kOptionOtaImageList },
     { "delayedApplyActionTimeSec", chip::ArgParser::kArgumentRequired, kOptionDelayedApplyActionTimeSec },
     { "queryImageStatus", chip::ArgParser::kArgumentRequired, kOptionQueryImageStatus },
+    { "maxBytesPerSecond", chip::ArgParser::kArgumentRequired, kOptionMaxBytesPerSecond },
     { "delayedQueryActionTimeSec", chip::ArgParser::kArgumentRequired, kOptionDelayedQueryActionTimeSec },
     { "userConsentState", chip::ArgParser::kArgumentRequired, kOptionUserConsentState },
     { "ignoreQueryImage", chip::ArgParser::kArgumentRequired, kOptionIgnoreQueryImage },
@@ -293,6 +299,8 @@ OptionSet cmdLineOptions = { HandleOptions, cmdLineOptionsDef, "PROGRAM OPTIONS"
                              "  -q, --queryImageStatus <updateAvailable | busy | updateNotAvailable>\n"
                              "        Value for the Status field in the first QueryImageResponse.\n"
                              "        For all subsequent responses, the value of updateAvailable will be used.\n"
+                             "  -r, --maxBytesPerSecond <bytes per second>\n"
+                             "        Throughput limit of each BDX transfer. No limit if not set.\n"
                              "  -t, --delayedQueryActionTimeSec <time in seconds>\n"
                              "        Value for the DelayedActionTime field in the first QueryImageResponse.\n"
                              "        For all subsequent responses, the value of zero will be used.\n"
@@ -316,10 +324,9 @@ void ApplicationInit()
 {
     CHIP_ERROR err = CHIP_NO_ERROR;
 
-    BdxOtaSender * bdxOtaSender = gOtaProvider.GetBdxOtaSender();
-    VerifyOrReturn(bdxOtaSender != nullptr);
+    BdxOtaSenderPool & bdxOtaSenderPool = gOtaProvider.GetBdxOtaSenderPool();
     err = chip::Server::GetInstance().GetExchangeManager().RegisterUnsolicitedMessageHandlerForProtocol(chip::Protocols::BDX::Id,
-                                                                                                        bdxOtaSender);
+                                                                                                        &bdxOtaSenderPool);
     if (err != CHIP_NO_ERROR)
     {
         ChipLogDetail(SoftwareUpdate, "RegisterUnsolicitedMessageHandler failed: %s", chip::ErrorStr(err));
@@ -361,6 +368,11 @@ void ApplicationInit()
         gOtaProvider.SetPollInterval(gPollInterval);
     }
 
+    for (size_t i = 0; i < BdxOtaSenderPool::kMaxConcurrentTransfers; i++)
+    {
+        bdxOtaSenderPool.GetSender(i).SetMaxBytesPerSecond(gMaxBytesPerSecond);
+    }
+
     ChipLogDetail(SoftwareUpdate, "Using ImageList file: %s", gOtaImageListFilepath ? gOtaImageListFilepath : "(none)");
 
     if (gOtaImageListFilepath != nullptr)
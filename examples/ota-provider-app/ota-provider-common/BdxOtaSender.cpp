@@ -24,8 +24,6 @@
 #include <messaging/Flags.h>
 #include <protocols/bdx/BdxTransferSession.h>
 
-#include <fstream>
-
 using chip::bdx::StatusCode;
 using chip::bdx::TransferControlFlags;
 using chip::bdx::TransferSession;
@@ -73,6 +71,10 @@ void BdxOtaSender::HandleTransferSessionOutput(TransferSession::OutputEvent & ev
     switch (event.EventType)
     {
     case TransferSession::OutputEventType::kNone:
+        if (mBlockQueryPending && chip::System::SystemClock().GetMonotonicTimestamp() >= mNextBlockTime)
+        {
+            SendBlock();
+        }
         break;
     case TransferSession::OutputEventType::kMsgToSend: {
         chip::Messaging::SendFlags sendFlags;
@@ -103,77 +105,44 @@ void BdxOtaSender::HandleTransferSessionOutput(TransferSession::OutputEvent & ev
         break;
     }
     case TransferSession::OutputEventType::kInitReceived: {
-        // TransferSession will automatically reject a transfer if there are no
-        // common supported control modes. It will also default to the smaller
-        // block size.
-        TransferSession::TransferAcceptData acceptData;
-        acceptData.ControlMode  = TransferControlFlags::kReceiverDrive; // OTA must use receiver drive
-        acceptData.MaxBlockSize = mTransfer.GetTransferBlockSize();
-        acceptData.StartOffset  = mTransfer.GetStartOffset();
-        acceptData.Length       = mTransfer.GetTransferLength();
-        VerifyOrReturn(mTransfer.AcceptTransfer(acceptData) == CHIP_NO_ERROR,
-                       ChipLogError(BDX, "AcceptTransfer failed: %" CHIP_ERROR_FORMAT, err.Format()));
-
         // Store the file designator used during block query
         uint16_t fdl       = 0;
         const uint8_t * fd = mTransfer.GetFileDesignator(fdl);
-        VerifyOrReturn(fdl < chip::bdx::kMaxFileDesignatorLen,
-                       ChipLogError(BDX, "Cannot store file designator with length = %d", fdl));
-        memcpy(mFileDesignator, fd, fdl);
-        mFileDesignator[fdl] = 0;
-
-        break;
-    }
-    case TransferSession::OutputEventType::kQueryReceived: {
-        TransferSession::BlockData blockData;
-        uint16_t blockSize   = mTransfer.GetTransferBlockSize();
-        uint16_t bytesToRead = blockSize;
-
-        // TODO: This should be a utility function in TransferSession
-        if (mTransfer.GetTransferLength() > 0 && mNumBytesSent + blockSize > mTransfer.GetTransferLength())
-        {
-            // cast should be safe because of condition above
-            bytesToRead = static_cast<uint16_t>(mTransfer.GetTransferLength() - mNumBytesSent);
-        }
-
-        chip::System::PacketBufferHandle blockBuf = chip::System::PacketBufferHandle::New(bytesToRead);
-        if (blockBuf.IsNull())
+        if (fdl >= chip::bdx::kMaxFileDesignatorLen)
         {
-            // TODO(#13981): AbortTransfer() needs to support GeneralStatusCode failures as well as BDX specific errors.
-            mTransfer.AbortTransfer(StatusCode::kUnknown);
-            return;
-        }
-
-        std::ifstream otaFile(mFileDesignator, std::ifstream::in);
-        if (!otaFile.good())
-        {
-            ChipLogError(BDX, "OTA file open failed");
-            mTransfer.AbortTransfer(StatusCode::kFileDesignatorUnknown);
+            ChipLogError(BDX, "Cannot store file designator with length = %d", fdl);
+            mTransfer.RejectTransfer(StatusCode::kFileDesignatorUnknown);
             return;
         }
+        memcpy(mFileDesignator, fd, fdl);
+        mFileDesignator[fdl] = 0;
 
-        otaFile.seekg(mNumBytesSent);
-        otaFile.read(reinterpret_cast<char *>(blockBuf->Start()), bytesToRead);
-        if (!(otaFile.good() || otaFile.eof()))
+        mImage = OTAImageCache::GetInstance().Acquire(mFileDesignator);
+        if (mImage == nullptr)
         {
-            ChipLogError(BDX, "OTA file read failed");
-            mTransfer.AbortTransfer(StatusCode::kFileDesignatorUnknown);
+            mTransfer.RejectTransfer(StatusCode::kFileDesignatorUnknown);
             return;
         }
 
-        blockData.Data   = blockBuf->Start();
-        blockData.Length = static_cast<size_t>(otaFile.gcount());
-        blockData.IsEof  = (blockData.Length < blockSize) ||
-            (mNumBytesSent + static_cast<uint64_t>(blockData.Length) == mTransfer.GetTransferLength() || (otaFile.peek() == EOF));
-        mNumBytesSent = static_cast<uint32_t>(mNumBytesSent + blockData.Length);
-        otaFile.close();
-
-        err = mTransfer.PrepareBlock(blockData);
-        if (err != CHIP_NO_ERROR)
+        // TransferSession will automatically reject a transfer if there are no
+        // common supported control modes. It will also default to the smaller
+        // block size.
+        TransferSession::TransferAcceptData acceptData;
+        acceptData.ControlMode  = TransferControlFlags::kReceiverDrive; // OTA must use receiver drive
+        acceptData.MaxBlockSize = mTransfer.GetTransferBlockSize();
+        acceptData.StartOffset  = mTransfer.GetStartOffset();
+        acceptData.Length       = mTransfer.GetTransferLength();
+        err                     = mTransfer.AcceptTransfer(acceptData);
+        VerifyOrReturn(err == CHIP_NO_ERROR, ChipLogError(BDX, "AcceptTransfer failed: %" CHIP_ERROR_FORMAT, err.Format()));
+        break;
+    }
+    case TransferSession::OutputEventType::kQueryReceived: {
+        mBlockQueryPending = true;
+        if (chip::System::SystemClock().GetMonotonicTimestamp() >= mNextBlockTime)
         {
-            ChipLogError(BDX, "PrepareBlock failed: %" CHIP_ERROR_FORMAT, err.Format());
-            mTransfer.AbortTransfer(StatusCode::kUnknown);
+            SendBlock();
         }
+        // Otherwise the block is sent by a later poll of the transfer session.
         break;
     }
     case TransferSession::OutputEventType::kAckReceived:
@@ -202,6 +171,59 @@ void BdxOtaSender::HandleTransferSessionOutput(TransferSession::OutputEvent & ev
     }
 }
 
+void BdxOtaSender::SendBlock()
+{
+    mBlockQueryPending = false;
+    VerifyOrReturn(mImage != nullptr, mTransfer.AbortTransfer(StatusCode::kUnknown));
+
+    TransferSession::BlockData blockData;
+    uint16_t blockSize   = mTransfer.GetTransferBlockSize();
+    uint16_t bytesToRead = blockSize;
+
+    // TODO: This should be a utility function in TransferSession
+    if (mTransfer.GetTransferLength() > 0 && mNumBytesSent + blockSize > mTransfer.GetTransferLength())
+    {
+        // cast should be safe because of condition above
+        bytesToRead = static_cast<uint16_t>(mTransfer.GetTransferLength() - mNumBytesSent);
+    }
+
+    // The block points straight into the mapped image, PrepareBlock() copies it into the message.
+    const uint64_t offset = mTransfer.GetStartOffset() + mNumBytesSent;
+    chip::ByteSpan block  = mImage->GetBlock(offset, bytesToRead);
+
+    blockData.Data   = block.data();
+    blockData.Length = block.size();
+    blockData.IsEof  = (blockData.Length < blockSize) ||
+        (mNumBytesSent + static_cast<uint64_t>(blockData.Length) == mTransfer.GetTransferLength()) ||
+        (offset + blockData.Length == mImage->GetData().size());
+    mNumBytesSent = static_cast<uint32_t>(mNumBytesSent + blockData.Length);
+
+    if (mMaxBytesPerSecond > 0)
+    {
+        mNextBlockTime = chip::System::SystemClock().GetMonotonicTimestamp() +
+            chip::System::Clock::Milliseconds64(static_cast<uint64_t>(blockData.Length) * 1000 / mMaxBytesPerSecond);
+    }
+
+    CHIP_ERROR err = mTransfer.PrepareBlock(blockData);
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(BDX, "PrepareBlock failed: %" CHIP_ERROR_FORMAT, err.Format());
+        mTransfer.AbortTransfer(StatusCode::kUnknown);
+    }
+}
+
+uint64_t BdxOtaSender::GetTransferLength()
+{
+    if (mTransfer.GetTransferLength() > 0 || mImage == nullptr)
+    {
+        return mTransfer.GetTransferLength();
+    }
+
+    // Indefinite length transfers send the whole image from the start offset.
+    const uint64_t imageSize = mImage->GetData().size();
+    return (imageSize > mTransfer.GetStartOffset()) ? imageSize - mTransfer.GetStartOffset() : 0;
+}
+
 /* Reset() calls bdx::TransferSession::Reset() which sets the output event type to
  * TransferSession::OutputEventType::kNone. So, bdx::TransferFacilitator::PollForOutput()
  * will call HandleTransferSessionOutput() with event TransferSession::OutputEventType::kNone.
@@ -218,7 +240,12 @@ void BdxOtaSender::Reset()
         mExchangeCtx = nullptr;
     }
 
-    mInitialized  = false;
-    mNumBytesSent = 0;
+    OTAImageCache::GetInstance().Release(mImage);
+    mImage = nullptr;
+
+    mInitialized       = false;
+    mNumBytesSent      = 0;
+    mBlockQueryPending = false;
+    mNextBlockTime     = chip::System::Clock::kZero;
     memset(mFileDesignator, 0, chip::bdx::kMaxFileDesignatorLen);
 }
@@ -15,8 +15,10 @@
  *    limitations under the License.
  */
 
+#include <ota-provider-common/OTAImageCache.h>
 #include <protocols/bdx/BdxTransferSession.h>
 #include <protocols/bdx/TransferFacilitator.h>
+#include <system/SystemClock.h>
 
 #pragma once
 
@@ -28,19 +30,49 @@ public:
     // Initializes BDX transfer-related metadata. Should always be called first.
     CHIP_ERROR InitializeTransfer(chip::FabricIndex fabricIndex, chip::NodeId nodeId);
 
+    // Limits the throughput of each transfer by delaying the answer to BlockQuery messages. Zero means no limit.
+    void SetMaxBytesPerSecond(uint32_t maxBytesPerSecond) { mMaxBytesPerSecond = maxBytesPerSecond; }
+
+    bool IsInUse() const { return mInitialized; }
+    bool IsTransferringTo(chip::FabricIndex fabricIndex, chip::NodeId nodeId) const
+    {
+        return mInitialized && mFabricIndex.ValueOr(chip::kUndefinedFabricIndex) == fabricIndex &&
+            mNodeId.ValueOr(chip::kUndefinedNodeId) == nodeId;
+    }
+
+    // Whether the requestor has started the transfer it was initialized for
+    bool HasTransferStarted() const { return mExchangeCtx != nullptr; }
+
+    uint64_t GetBytesSent() const { return mNumBytesSent; }
+    uint64_t GetTransferLength();
+
+    void Reset();
+
 private:
     // Inherited from bdx::TransferFacilitator
     void HandleTransferSessionOutput(chip::bdx::TransferSession::OutputEvent & event) override;
 
-    void Reset();
+    // Answers the pending BlockQuery with the next block of the image
+    void SendBlock();
 
     // Null-terminated string representing file designator
     char mFileDesignator[chip::bdx::kMaxFileDesignatorLen];
 
+    // Image being transferred, shared with the other transfers of the same file
+    const OTAImageCache::Image * mImage = nullptr;
+
     uint32_t mNumBytesSent = 0;
 
     bool mInitialized = false;
 
+    // A BlockQuery is waiting for the flow control to allow the next block
+    bool mBlockQueryPending = false;
+
+    uint32_t mMaxBytesPerSecond = 0;
+
+    // The earliest time at which the next block may be sent
+    chip::System::Clock::Timestamp mNextBlockTime = chip::System::Clock::kZero;
+
     chip::Optional<chip::FabricIndex> mFabricIndex;
 
     chip::Optional<chip::NodeId> mNodeId;
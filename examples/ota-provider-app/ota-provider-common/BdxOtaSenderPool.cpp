@@ -0,0 +1,167 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <ota-provider-common/BdxOtaSenderPool.h>
+
+#include <lib/support/CodeUtils.h>
+#include <lib/support/logging/CHIPLogging.h>
+#include <messaging/ExchangeContext.h>
+
+using chip::FabricIndex;
+using chip::NodeId;
+using chip::System::Clock::Milliseconds64;
+using chip::System::Clock::Seconds32;
+
+constexpr size_t BdxOtaSenderPool::kMaxConcurrentTransfers;
+constexpr uint32_t BdxOtaSenderPool::kMinDelayedActionTimeSec;
+constexpr uint32_t BdxOtaSenderPool::kMaxDelayedActionTimeSec;
+constexpr Seconds32 BdxOtaSenderPool::kReservationTimeout;
+
+BdxOtaSender * BdxOtaSenderPool::ReserveSender(FabricIndex fabricIndex, NodeId nodeId)
+{
+    const auto now      = chip::System::SystemClock().GetMonotonicTimestamp();
+    size_t index        = kMaxConcurrentTransfers;
+    size_t freeIndex    = kMaxConcurrentTransfers;
+    size_t expiredIndex = kMaxConcurrentTransfers;
+
+    for (size_t i = 0; i < kMaxConcurrentTransfers; i++)
+    {
+        BdxOtaSender & sender = mSenders[i];
+        if (sender.IsTransferringTo(fabricIndex, nodeId))
+        {
+            // Stale transfer of the same requestor, InitializeTransfer() resets it.
+            index = i;
+            break;
+        }
+        if (freeIndex == kMaxConcurrentTransfers && !sender.IsInUse())
+        {
+            freeIndex = i;
+        }
+        if (expiredIndex == kMaxConcurrentTransfers && sender.IsInUse() && !sender.HasTransferStarted() &&
+            now - mStartTimes[i] > kReservationTimeout)
+        {
+            expiredIndex = i;
+        }
+    }
+
+    if (index == kMaxConcurrentTransfers)
+    {
+        index = freeIndex;
+    }
+    if (index == kMaxConcurrentTransfers && expiredIndex < kMaxConcurrentTransfers)
+    {
+        // The requestor this sender was reserved for never started its transfer.
+        mSenders[expiredIndex].Reset();
+        index = expiredIndex;
+    }
+    VerifyOrReturnValue(index < kMaxConcurrentTransfers, nullptr);
+
+    if (GetActiveTransferCount() == 0)
+    {
+        // Every requestor turned away before has been served, or has given up.
+        mDeferredRequestors = 0;
+    }
+    else if (mDeferredRequestors > 0)
+    {
+        mDeferredRequestors--;
+    }
+
+    VerifyOrReturnValue(mSenders[index].InitializeTransfer(fabricIndex, nodeId) == CHIP_NO_ERROR, nullptr);
+    mStartTimes[index] = now;
+    return &mSenders[index];
+}
+
+uint32_t BdxOtaSenderPool::DeferRequestor()
+{
+    // Each wave of requestors gets one chance at every sender. The next wave is asked to come back once the transfers of
+    // the current one are expected to be over.
+    const uint32_t wave     = mDeferredRequestors / static_cast<uint32_t>(kMaxConcurrentTransfers);
+    const uint32_t untilSec = EstimateTimeUntilFreeSender().count();
+    const uint64_t delaySec = untilSec + static_cast<uint64_t>(wave) * chip::max(untilSec, kMinDelayedActionTimeSec);
+
+    mDeferredRequestors++;
+    ChipLogDetail(SoftwareUpdate, "All %u BDX senders busy, deferring requestor in wave %" PRIu32 " by %" PRIu64 "s",
+                  static_cast<unsigned>(kMaxConcurrentTransfers), wave, delaySec);
+
+    return static_cast<uint32_t>(chip::min<uint64_t>(chip::max<uint64_t>(delaySec, kMinDelayedActionTimeSec),
+                                                     kMaxDelayedActionTimeSec));
+}
+
+size_t BdxOtaSenderPool::GetActiveTransferCount()
+{
+    size_t count = 0;
+    for (auto & sender : mSenders)
+    {
+        count += sender.IsInUse() ? 1 : 0;
+    }
+    return count;
+}
+
+Seconds32 BdxOtaSenderPool::EstimateTimeUntilFreeSender()
+{
+    const auto now    = chip::System::SystemClock().GetMonotonicTimestamp();
+    uint64_t estimate = kMaxDelayedActionTimeSec;
+    bool estimated    = false;
+
+    for (size_t i = 0; i < kMaxConcurrentTransfers; i++)
+    {
+        BdxOtaSender & sender  = mSenders[i];
+        const uint64_t sent    = sender.GetBytesSent();
+        const uint64_t length  = sender.GetTransferLength();
+        const uint64_t elapsed = std::chrono::duration_cast<Milliseconds64>(now - mStartTimes[i]).count();
+
+        // Transfers which have not sent anything yet give no throughput to extrapolate from.
+        if (!sender.IsInUse() || sent == 0 || length <= sent || elapsed == 0)
+        {
+            continue;
+        }
+
+        const uint64_t remainingMs = (length - sent) * elapsed / sent;
+        estimate                   = chip::min(estimate, remainingMs / 1000 + 1);
+        estimated                  = true;
+    }
+
+    return Seconds32(static_cast<uint32_t>(estimated ? estimate : kMinDelayedActionTimeSec));
+}
+
+CHIP_ERROR BdxOtaSenderPool::OnUnsolicitedMessageReceived(const chip::PayloadHeader & payloadHeader,
+                                                          chip::Messaging::ExchangeDelegate *& newDelegate)
+{
+    // The peer of the exchange is only known once the message is delivered, see OnMessageReceived().
+    newDelegate = this;
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR BdxOtaSenderPool::OnMessageReceived(chip::Messaging::ExchangeContext * ec, const chip::PayloadHeader & payloadHeader,
+                                               chip::System::PacketBufferHandle && payload)
+{
+    const chip::ScopedNodeId peer = ec->GetSessionHandle()->GetPeer();
+
+    for (auto & sender : mSenders)
+    {
+        if (sender.IsTransferringTo(peer.GetFabricIndex(), peer.GetNodeId()))
+        {
+            // The sender handles the rest of the exchange.
+            chip::Messaging::ExchangeDelegate & delegate = sender;
+            ec->SetDelegate(&delegate);
+            return delegate.OnMessageReceived(ec, payloadHeader, std::move(payload));
+        }
+    }
+
+    ChipLogError(SoftwareUpdate, "No BDX transfer expected from " ChipLogFormatX64, ChipLogValueX64(peer.GetNodeId()));
+    return CHIP_ERROR_INCORRECT_STATE;
+}
@@ -0,0 +1,88 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <messaging/ExchangeDelegate.h>
+#include <ota-provider-common/BdxOtaSender.h>
+#include <system/SystemClock.h>
+
+#ifndef OTA_PROVIDER_MAX_CONCURRENT_TRANSFERS
+#define OTA_PROVIDER_MAX_CONCURRENT_TRANSFERS 8
+#endif
+
+/**
+ * A pool of BdxOtaSender serving several OTA Requestors at once.
+ *
+ * A sender is reserved for a requestor when its QueryImage is answered. The pool is registered as the handler of
+ * unsolicited BDX messages and hands each incoming transfer over to the sender reserved for the peer of the exchange.
+ *
+ * When all the senders are busy, the pool schedules the requestors turned away: the DelayedActionTime they are given is
+ * estimated from the progress of the ongoing transfers, and successive requestors are spread over successive waves so that
+ * they do not all query the provider again at the same time.
+ */
+class BdxOtaSenderPool : public chip::Messaging::UnsolicitedMessageHandler, public chip::Messaging::ExchangeDelegate
+{
+public:
+    static constexpr size_t kMaxConcurrentTransfers = OTA_PROVIDER_MAX_CONCURRENT_TRANSFERS;
+
+    // Bounds of the DelayedActionTime given to the requestors turned away
+    static constexpr uint32_t kMinDelayedActionTimeSec = 10;
+    static constexpr uint32_t kMaxDelayedActionTimeSec = 60 * 60;
+
+    // How long a sender stays reserved for a requestor which does not start its transfer
+    static constexpr chip::System::Clock::Seconds32 kReservationTimeout = chip::System::Clock::Seconds32(2 * 60);
+
+    /**
+     * Reserve a sender for a requestor, reusing the one of its previous transfer if any.
+     *
+     * @return The sender, initialized for the requestor, or nullptr if all the senders are busy.
+     */
+    BdxOtaSender * ReserveSender(chip::FabricIndex fabricIndex, chip::NodeId nodeId);
+
+    /**
+     * Count a requestor turned away because all the senders are busy.
+     *
+     * @return The DelayedActionTime, in seconds, after which the requestor should query the provider again.
+     */
+    uint32_t DeferRequestor();
+
+    size_t GetActiveTransferCount();
+
+    BdxOtaSender & GetSender(size_t index) { return mSenders[index]; }
+
+private:
+    //// UnsolicitedMessageHandler Implementation ////
+    CHIP_ERROR OnUnsolicitedMessageReceived(const chip::PayloadHeader & payloadHeader,
+                                            chip::Messaging::ExchangeDelegate *& newDelegate) override;
+
+    //// ExchangeDelegate Implementation ////
+    CHIP_ERROR OnMessageReceived(chip::Messaging::ExchangeContext * ec, const chip::PayloadHeader & payloadHeader,
+                                 chip::System::PacketBufferHandle && payload) override;
+    void OnResponseTimeout(chip::Messaging::ExchangeContext * ec) override {}
+
+    /**
+     * Estimate how long it takes for the first of the ongoing transfers to complete, from the throughput observed so far.
+     */
+    chip::System::Clock::Seconds32 EstimateTimeUntilFreeSender();
+
+    BdxOtaSender mSenders[kMaxConcurrentTransfers];
+    chip::System::Clock::Timestamp mStartTimes[kMaxConcurrentTransfers];
+
+    // Number of requestors turned away which have not been served yet
+    uint32_t mDeferredRequestors = 0;
+};
@@ -0,0 +1,133 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <ota-provider-common/OTAImageCache.h>
+
+#include <lib/support/CHIPMemString.h>
+#include <lib/support/CodeUtils.h>
+#include <lib/support/logging/CHIPLogging.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+chip::ByteSpan OTAImageCache::Image::GetBlock(uint64_t aOffset, size_t aLength) const
+{
+    if (aOffset >= mSize)
+    {
+        return chip::ByteSpan();
+    }
+    const size_t offset = static_cast<size_t>(aOffset);
+    return chip::ByteSpan(mData + offset, chip::min(aLength, mSize - offset));
+}
+
+OTAImageCache & OTAImageCache::GetInstance()
+{
+    static OTAImageCache sInstance;
+    return sInstance;
+}
+
+OTAImageCache::~OTAImageCache()
+{
+    for (auto & image : mImages)
+    {
+        if (image.mData != nullptr)
+        {
+            munmap(const_cast<uint8_t *>(image.mData), image.mSize);
+        }
+    }
+}
+
+const OTAImageCache::Image * OTAImageCache::Acquire(const char * aPath)
+{
+    Image * freeImage = nullptr;
+
+    for (auto & image : mImages)
+    {
+        if (image.mRefCount > 0 && strcmp(image.mPath, aPath) == 0)
+        {
+            image.mRefCount++;
+            return &image;
+        }
+        if (image.mRefCount == 0 && freeImage == nullptr)
+        {
+            freeImage = &image;
+        }
+    }
+
+    if (freeImage == nullptr)
+    {
+        ChipLogError(BDX, "Too many OTA images in use to map %s", aPath);
+        return nullptr;
+    }
+
+    int fd = open(aPath, O_RDONLY);
+    if (fd < 0)
+    {
+        ChipLogError(BDX, "Cannot open OTA image %s", aPath);
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    void * data = MAP_FAILED;
+    if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping stays valid after the file is closed.
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        ChipLogError(BDX, "Cannot map OTA image %s", aPath);
+        return nullptr;
+    }
+
+    // Transfers mostly read forward: let the kernel read ahead.
+    madvise(data, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+    chip::Platform::CopyString(freeImage->mPath, aPath);
+    freeImage->mData     = static_cast<const uint8_t *>(data);
+    freeImage->mSize     = static_cast<size_t>(fileStat.st_size);
+    freeImage->mRefCount = 1;
+    ChipLogProgress(BDX, "Mapped OTA image %s (%u bytes)", aPath, static_cast<unsigned>(freeImage->mSize));
+    return freeImage;
+}
+
+void OTAImageCache::Release(const Image * aImage)
+{
+    VerifyOrReturn(aImage != nullptr);
+
+    for (auto & image : mImages)
+    {
+        if (&image != aImage)
+        {
+            continue;
+        }
+
+        VerifyOrReturn(image.mRefCount > 0);
+        if (--image.mRefCount == 0)
+        {
+            munmap(const_cast<uint8_t *>(image.mData), image.mSize);
+            image.mData    = nullptr;
+            image.mSize    = 0;
+            image.mPath[0] = 0;
+        }
+        return;
+    }
+}
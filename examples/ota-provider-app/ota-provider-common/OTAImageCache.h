@@ -0,0 +1,72 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <lib/support/Span.h>
+
+#include <limits.h>
+
+#ifndef OTA_PROVIDER_MAX_CACHED_IMAGES
+#define OTA_PROVIDER_MAX_CACHED_IMAGES 4
+#endif
+
+/**
+ * Read-only OTA images mapped in memory, shared by all the BDX transfers serving the same file.
+ *
+ * An image is mapped when the first transfer acquires it and unmapped when the last transfer releases it, so blocks are
+ * sliced straight out of the page cache instead of being read from the file for every BlockQuery.
+ */
+class OTAImageCache
+{
+public:
+    class Image
+    {
+    public:
+        chip::ByteSpan GetData() const { return chip::ByteSpan(mData, mSize); }
+
+        /**
+         * Get up to aLength bytes of the image, starting at aOffset. The returned span is shorter at the end of the image and
+         * empty past it.
+         */
+        chip::ByteSpan GetBlock(uint64_t aOffset, size_t aLength) const;
+
+    private:
+        friend class OTAImageCache;
+
+        char mPath[PATH_MAX]  = { 0 };
+        const uint8_t * mData = nullptr;
+        size_t mSize          = 0;
+        uint32_t mRefCount    = 0;
+    };
+
+    static OTAImageCache & GetInstance();
+
+    ~OTAImageCache();
+
+    /**
+     * Get the mapped image of the file at aPath, mapping it if no transfer uses it yet. Every image acquired must be released.
+     *
+     * @return The image, or nullptr if the file cannot be mapped or too many images are in use.
+     */
+    const Image * Acquire(const char * aPath);
+
+    void Release(const Image * aImage);
+
+private:
+    Image mImages[OTA_PROVIDER_MAX_CACHED_IMAGES];
+};
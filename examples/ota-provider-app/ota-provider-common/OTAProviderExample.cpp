@@ -271,11 +271,12 @@ void OTAProviderExample::SendQueryImageResponse(app::CommandHandler * commandObj
         // Initialize the transfer session in prepartion for a BDX transfer
         BitFlags<TransferControlFlags> bdxFlags;
         bdxFlags.Set(TransferControlFlags::kReceiverDrive);
-        if (mBdxOtaSender.InitializeTransfer(commandObj->GetSubjectDescriptor().fabricIndex,
-                                             commandObj->GetSubjectDescriptor().subject) == CHIP_NO_ERROR)
+        BdxOtaSender * bdxOtaSender = mBdxOtaSenderPool.ReserveSender(commandObj->GetSubjectDescriptor().fabricIndex,
+                                                                      commandObj->GetSubjectDescriptor().subject);
+        if (bdxOtaSender != nullptr)
         {
             CHIP_ERROR error =
-                mBdxOtaSender.PrepareForTransfer(&chip::DeviceLayer::SystemLayer(), chip::bdx::TransferRole::kSender, bdxFlags,
+                bdxOtaSender->PrepareForTransfer(&chip::DeviceLayer::SystemLayer(), chip::bdx::TransferRole::kSender, bdxFlags,
                                                  kMaxBdxBlockSize, kBdxTimeout, chip::System::Clock::Milliseconds32(mPollInterval));
             if (error != CHIP_NO_ERROR)
             {
@@ -291,8 +292,9 @@ void OTAProviderExample::SendQueryImageResponse(app::CommandHandler * commandObj
         }
         else
         {
-            // Another BDX transfer in progress
-            mQueryImageStatus = OTAQueryStatus::kBusy;
+            // As many BDX transfers in progress as the provider can serve, let the requestor come back when one is over
+            mQueryImageStatus          = OTAQueryStatus::kBusy;
+            mDelayedQueryActionTimeSec = chip::max(mDelayedQueryActionTimeSec, mBdxOtaSenderPool.DeferRequestor());
         }
     }
 
@@ -23,7 +23,7 @@
 #include <app/clusters/ota-provider/OTAProviderUserConsentDelegate.h>
 #include <app/clusters/ota-provider/ota-provider-delegate.h>
 #include <lib/core/OTAImageHeader.h>
-#include <ota-provider-common/BdxOtaSender.h>
+#include <ota-provider-common/BdxOtaSenderPool.h>
 #include <vector>
 
 /**
@@ -69,7 +69,7 @@ public:
     //////////// OTAProviderExample public APIs ///////////////
     void SetOTAFilePath(const char * path);
     void SetImageUri(const char * imageUri);
-    BdxOtaSender * GetBdxOtaSender() { return &mBdxOtaSender; }
+    BdxOtaSenderPool & GetBdxOtaSenderPool() { return mBdxOtaSenderPool; }
 
     void SetOTACandidates(std::vector<OTAProviderExample::DeviceSoftwareVersionModel> candidates);
     void SetIgnoreQueryImageCount(uint32_t count) { mIgnoreQueryImageCount = count; }
@@ -108,7 +108,7 @@ private:
     SendQueryImageResponse(chip::app::CommandHandler * commandObj, const chip::app::ConcreteCommandPath & commandPath,
                            const chip::app::Clusters::OtaSoftwareUpdateProvider::Commands::QueryImage::DecodableType & commandData);
 
-    BdxOtaSender mBdxOtaSender;
+    BdxOtaSenderPool mBdxOtaSenderPool;
     std::vector<DeviceSoftwareVersionModel> mCandidates;
     char mOTAFilePath[kFilepathBufLen]; // null-terminated
     char mImageUri[kUriMaxLen];
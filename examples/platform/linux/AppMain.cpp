@@ -67,6 +67,14 @@
 #include "TraceHandlers.h"
 #endif // CHIP_CONFIG_TRANSPORT_TRACE_ENABLED
 
+#if CHIP_CONFIG_ENABLE_METRICS
+#include <platform/Linux/MetricsExporter.h>
+#endif // CHIP_CONFIG_ENABLE_METRICS
+
+#if MATTER_TRACE_RECORDER
+#include <trace/TraceRecorder.h>
+#endif // MATTER_TRACE_RECORDER
+
 #if CHIP_DEVICE_CONFIG_ENABLE_OTA_REQUESTOR
 #include <app/clusters/ota-requestor/OTATestEventTriggerDelegate.h>
 #endif
@@ -121,6 +129,14 @@ void Cleanup()
     chip::trace::DeInitTrace();
 #endif // CHIP_CONFIG_TRANSPORT_TRACE_ENABLED
 
+#if CHIP_CONFIG_ENABLE_METRICS
+    chip::DeviceLayer::MetricsExporter::Instance().Stop();
+#endif // CHIP_CONFIG_ENABLE_METRICS
+
+#if MATTER_TRACE_RECORDER
+    chip::Tracing::TraceRecorder::Instance().Stop();
+#endif // MATTER_TRACE_RECORDER
+
     // TODO(16968): Lifecycle management of storage-using components like GroupDataProvider, etc
 }
 
@@ -281,6 +297,32 @@ int ChipLinuxAppInit(int argc, char * const argv[], OptionSet * customOptions)
     chip::trace::InitTrace();
 #endif // CHIP_CONFIG_TRANSPORT_TRACE_ENABLED
 
+#if CHIP_CONFIG_ENABLE_METRICS
+    {
+        const LinuxDeviceOptions & options = LinuxDeviceOptions::GetInstance();
+        if (options.metricsSocketPath.HasValue() || options.metricsFilePath.HasValue())
+        {
+            err = chip::DeviceLayer::MetricsExporter::Instance().Start(
+                options.metricsSocketPath.HasValue() ? options.metricsSocketPath.Value().c_str() : nullptr,
+                options.metricsFilePath.HasValue() ? options.metricsFilePath.Value().c_str() : nullptr);
+            SuccessOrExit(err);
+        }
+    }
+#endif // CHIP_CONFIG_ENABLE_METRICS
+
+#if MATTER_TRACE_RECORDER
+    {
+        const LinuxDeviceOptions & options = LinuxDeviceOptions::GetInstance();
+        if (options.traceEventsFilePath.HasValue())
+        {
+            err = chip::Tracing::TraceRecorder::Instance().Start(
+                options.traceEventsFilePath.Value().c_str(), options.traceEventsFormat,
+                options.traceEventsCategories.HasValue() ? options.traceEventsCategories.Value().c_str() : nullptr);
+            SuccessOrExit(err);
+        }
+    }
+#endif // MATTER_TRACE_RECORDER
+
 #if CONFIG_NETWORK_LAYER_BLE
     DeviceLayer::ConnectivityMgr().SetBLEDeviceName(nullptr); // Use default device name (CHIP-XXXX)
     DeviceLayer::Internal::BLEMgrImpl().ConfigureBle(LinuxDeviceOptions::GetInstance().mBleDevice, false);
@@ -73,6 +73,11 @@ enum
     kOptionCSRResponseCSRExistingKeyPair                = 0x101e,
     kDeviceOption_TestEventTriggerEnableKey             = 0x101f,
     kCommissionerOption_FabricID                        = 0x1020,
+    kDeviceOption_MetricsSocket                         = 0x1021,
+    kDeviceOption_MetricsFile                           = 0x1022,
+    kDeviceOption_TraceEventsFile                       = 0x1023,
+    kDeviceOption_TraceEventsFormat                     = 0x1024,
+    kDeviceOption_TraceEventsCategories                 = 0x1025,
 };
 
 constexpr unsigned kAppUsageLength = 64;
@@ -109,6 +114,15 @@ OptionDef sDeviceOptionDefs[] = {
     { "trace_log", kArgumentRequired, kDeviceOption_TraceLog },
     { "trace_decode", kArgumentRequired, kDeviceOption_TraceDecode },
 #endif // CHIP_CONFIG_TRANSPORT_TRACE_ENABLED
+#if CHIP_CONFIG_ENABLE_METRICS
+    { "metrics_socket", kArgumentRequired, kDeviceOption_MetricsSocket },
+    { "metrics_file", kArgumentRequired, kDeviceOption_MetricsFile },
+#endif // CHIP_CONFIG_ENABLE_METRICS
+#if MATTER_TRACE_RECORDER
+    { "trace_events_file", kArgumentRequired, kDeviceOption_TraceEventsFile },
+    { "trace_events_format", kArgumentRequired, kDeviceOption_TraceEventsFormat },
+    { "trace_events_categories", kArgumentRequired, kDeviceOption_TraceEventsCategories },
+#endif // MATTER_TRACE_RECORDER
     { "cert_error_csr_incorrect_type", kNoArgument, kOptionCSRResponseCSRIncorrectType },
     { "cert_error_csr_existing_keypair", kNoArgument, kOptionCSRResponseCSRExistingKeyPair },
     { "cert_error_csr_nonce_incorrect_type", kNoArgument, kOptionCSRResponseCSRNonceIncorrectType },
@@ -207,6 +221,22 @@ const char * sDeviceOptionHelp =
     "  --trace_decode <1/0>\n"
     "       A value of 1 enables traces decoding, 0 disables this (default 0).\n"
 #endif // CHIP_CONFIG_TRANSPORT_TRACE_ENABLED
+#if CHIP_CONFIG_ENABLE_METRICS
+    "\n"
+    "  --metrics_socket <path>\n"
+    "       Serve the runtime metrics, in the Prometheus text format, on a Unix domain socket at <path>.\n"
+    "  --metrics_file <path>\n"
+    "       Write the runtime metrics, in the Prometheus text format, to <path> every 10 seconds.\n"
+#endif // CHIP_CONFIG_ENABLE_METRICS
+#if MATTER_TRACE_RECORDER
+    "\n"
+    "  --trace_events_file <path>\n"
+    "       Record the MATTER_TRACE_EVENT trace events to <path>, for chrome://tracing or https://ui.perfetto.dev.\n"
+    "  --trace_events_format <json/perfetto>\n"
+    "       Write the trace events in the Chrome JSON format or as a Perfetto protobuf trace (default json).\n"
+    "  --trace_events_categories <categories>\n"
+    "       Comma-separated categories of the trace events to record, like CASESession,Reporting (default all).\n"
+#endif // MATTER_TRACE_RECORDER
     "  --cert_error_csr_incorrect_type\n"
     "       Configure the CSRResponse to be built with an invalid CSR type.\n"
     "  --cert_error_csr_existing_keypair\n"
@@ -428,6 +458,39 @@ bool HandleOption(const char * aProgram, OptionSet * aOptions, int aIdentifier,
         break;
 #endif // CHIP_CONFIG_TRANSPORT_TRACE_ENABLED
 
+#if CHIP_CONFIG_ENABLE_METRICS
+    case kDeviceOption_MetricsSocket:
+        LinuxDeviceOptions::GetInstance().metricsSocketPath.SetValue(std::string{ aValue });
+        break;
+    case kDeviceOption_MetricsFile:
+        LinuxDeviceOptions::GetInstance().metricsFilePath.SetValue(std::string{ aValue });
+        break;
+#endif // CHIP_CONFIG_ENABLE_METRICS
+
+#if MATTER_TRACE_RECORDER
+    case kDeviceOption_TraceEventsFile:
+        LinuxDeviceOptions::GetInstance().traceEventsFilePath.SetValue(std::string{ aValue });
+        break;
+    case kDeviceOption_TraceEventsFormat:
+        if (strcmp(aValue, "json") == 0)
+        {
+            LinuxDeviceOptions::GetInstance().traceEventsFormat = chip::Tracing::TraceRecorder::Format::kChromeJson;
+        }
+        else if (strcmp(aValue, "perfetto") == 0)
+        {
+            LinuxDeviceOptions::GetInstance().traceEventsFormat = chip::Tracing::TraceRecorder::Format::kPerfetto;
+        }
+        else
+        {
+            PrintArgError("%s: ERROR: invalid trace events format: %s\n", aProgram, aValue);
+            retval = false;
+        }
+        break;
+    case kDeviceOption_TraceEventsCategories:
+        LinuxDeviceOptions::GetInstance().traceEventsCategories.SetValue(std::string{ aValue });
+        break;
+#endif // MATTER_TRACE_RECORDER
+
     case kOptionCSRResponseCSRIncorrectType:
         LinuxDeviceOptions::GetInstance().mCSRResponseOptions.csrIncorrectType = true;
         break;
@@ -37,6 +37,10 @@
 #include <credentials/DeviceAttestationCredsProvider.h>
 #include <testing/CustomCSRResponse.h>
 
+#if MATTER_TRACE_RECORDER
+#include <trace/TraceRecorder.h>
+#endif // MATTER_TRACE_RECORDER
+
 struct LinuxDeviceOptions
 {
     chip::PayloadContents payload;
@@ -57,6 +61,13 @@ struct LinuxDeviceOptions
     bool traceStreamDecodeEnabled       = false;
     bool traceStreamToLogEnabled        = false;
     chip::Optional<std::string> traceStreamFilename;
+    chip::Optional<std::string> metricsSocketPath;
+    chip::Optional<std::string> metricsFilePath;
+#if MATTER_TRACE_RECORDER
+    chip::Optional<std::string> traceEventsFilePath;
+    chip::Optional<std::string> traceEventsCategories;
+    chip::Tracing::TraceRecorder::Format traceEventsFormat = chip::Tracing::TraceRecorder::Format::kChromeJson;
+#endif // MATTER_TRACE_RECORDER
     chip::Credentials::DeviceAttestationCredentialsProvider * dacProvider = nullptr;
     chip::CSRResponseOptions mCSRResponseOptions;
     uint8_t testEventTriggerEnableKey[16] = { 0 };
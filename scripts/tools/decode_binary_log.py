@@ -0,0 +1,268 @@
+#!/usr/bin/env -S python3 -B
+
+#
+#    Copyright (c) 2022 Project CHIP Authors
+#    All rights reserved.
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+#
+
+"""Decodes the binary log files written by the asynchronous Linux logging
+backend (src/platform/Linux/AsyncLogging.cpp) into the usual text log lines.
+
+Usage: decode_binary_log.py <log file> [output file]
+"""
+
+import argparse
+import math
+import re
+import struct
+import sys
+
+MAGIC = b'CHIPBLOG'
+VERSION = 1
+
+# A printf conversion specification, as parsed by AsyncLogging.cpp
+CONVERSION = re.compile(r"%([-+ #0']*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|q|j|z|t|L)?(.)?", re.DOTALL)
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def remaining(self):
+        return len(self.data) - self.offset
+
+    def read(self, fmt):
+        values = struct.unpack_from('<' + fmt, self.data, self.offset)
+        self.offset += struct.calcsize('<' + fmt)
+        return values if len(values) > 1 else values[0]
+
+    def read_bytes(self, length):
+        value = self.data[self.offset:self.offset + length]
+        if len(value) != length:
+            raise struct.error('truncated record')
+        self.offset += length
+        return value
+
+
+def read_arguments(reader, count):
+    arguments = []
+    for _ in range(count):
+        tag = chr(reader.read('B'))
+        if tag == 'i':
+            arguments.append(reader.read('q'))
+        elif tag in ('u', 'p'):
+            arguments.append(reader.read('Q'))
+        elif tag == 'f':
+            arguments.append(reader.read('d'))
+        elif tag == 's':
+            length = reader.read('H')
+            arguments.append(reader.read_bytes(length).decode('utf-8', errors='replace'))
+        else:
+            raise ValueError('unknown argument tag %r' % tag)
+    return arguments
+
+
+def pad(text, flags, width, prefix_length=0):
+    """Pads a converted value to its width, as printf does."""
+    if width is None or len(text) >= width:
+        return text
+    if '-' in flags:
+        return text.ljust(width)
+    if '0' in flags:
+        return text[:prefix_length] + '0' * (width - len(text)) + text[prefix_length:]
+    return text.rjust(width)
+
+
+def sign_prefix(negative, flags):
+    if negative:
+        return '-'
+    if '+' in flags:
+        return '+'
+    if ' ' in flags:
+        return ' '
+    return ''
+
+
+def format_integer(flags, width, precision, specifier, value):
+    """Formats an integer conversion; unlike Python, printf writes 0 for %#x of 0,
+    010 for %#o of 8, and ignores the 0 flag when there is a precision."""
+    if specifier in 'diu':
+        digits = '%d' % abs(value)
+    else:
+        digits = ('%' + specifier) % value
+    if precision is not None:
+        digits = '' if precision == 0 and value == 0 else digits.rjust(precision, '0')
+        flags = flags.replace('0', '')
+
+    prefix = sign_prefix(value < 0, flags) if specifier in 'di' else ''
+    if '#' in flags:
+        if specifier == 'o' and not digits.startswith('0'):
+            digits = '0' + digits
+        elif specifier in 'xX' and value != 0:
+            prefix = '0' + specifier
+    return pad(prefix + digits, flags, width, len(prefix))
+
+
+def format_hex_float(flags, width, precision, specifier, value):
+    """Formats a %a conversion, which Python has no equivalent of."""
+    if math.isinf(value) or math.isnan(value):
+        text = sign_prefix(math.copysign(1, value) < 0, flags) + ('inf' if math.isinf(value) else 'nan')
+        text = pad(text, flags.replace('0', ''), width)
+        return text.upper() if specifier == 'A' else text
+
+    sign = sign_prefix(math.copysign(1, value) < 0, flags)
+    mantissa, exponent = float.hex(abs(value))[2:].split('p')
+    lead, fraction = mantissa.split('.')
+    if precision is None:
+        fraction = fraction.rstrip('0')
+    elif precision < len(fraction):
+        # Round to nearest, ties to even, as glibc does
+        bits = 4 * (len(fraction) - precision)
+        quotient, remainder = divmod(int(lead + fraction, 16), 1 << bits)
+        half = 1 << (bits - 1)
+        if remainder > half or (remainder == half and quotient & 1):
+            quotient += 1
+        lead = '%x' % (quotient >> (4 * precision))
+        fraction = '%0*x' % (precision, quotient & ((1 << (4 * precision)) - 1)) if precision else ''
+    else:
+        fraction = fraction.ljust(precision, '0')
+
+    point = '.' if fraction or '#' in flags else ''
+    exponent = exponent if exponent[0] in '+-' else '+' + exponent
+    text = pad(sign + '0x' + lead + point + fraction + 'p' + exponent, flags, width, len(sign) + 2)
+    return text.upper() if specifier == 'A' else text
+
+
+def format_line(fmt, arguments):
+    """Formats a line as printf would have, from its captured arguments."""
+    output = []
+    position = 0
+    arguments = list(arguments)
+    while True:
+        percent = fmt.find('%', position)
+        if percent < 0:
+            output.append(fmt[position:])
+            break
+        output.append(fmt[position:percent])
+
+        match = CONVERSION.match(fmt, percent)
+        flags, width, precision, _, specifier = match.groups()
+        position = match.end()
+        if specifier == '%':
+            output.append('%')
+            continue
+        if specifier == 'n' or specifier is None:
+            continue
+
+        needed = 1 + (width == '*') + (precision == '*')
+        if len(arguments) < needed:
+            # Not captured: the rest of the line is printed as is
+            output.append(fmt[percent:])
+            break
+
+        if width == '*':
+            width = arguments.pop(0)
+            if width < 0:
+                flags += '-'
+                width = -width
+        if precision == '*':
+            precision = arguments.pop(0)
+            precision = None if precision < 0 else precision
+        value = arguments.pop(0)
+
+        flags = flags.replace("'", '')
+        width = int(width) if width is not None else None
+        if precision == '':
+            precision = 0
+        elif precision is not None:
+            precision = int(precision)
+
+        spec = '%' + flags
+        if width is not None:
+            spec += str(width)
+        if precision is not None:
+            spec += '.' + str(precision)
+
+        if specifier in 'diuoxX':
+            output.append(format_integer(flags, width, precision, specifier, value))
+        elif specifier == 'c':
+            output.append(pad(chr(value & 0xff), flags.replace('0', ''), width))
+        elif specifier in 'eEfFgG':
+            output.append((spec + specifier) % value)
+        elif specifier in 'aA':
+            output.append(format_hex_float(flags, width, precision, specifier, value))
+        elif specifier == 'p':
+            output.append((spec + 's') % ('0x%x' % value if value else '(nil)'))
+        elif specifier == 's':
+            output.append((spec + 's') % value)
+        else:
+            output.append(fmt[percent:position])
+    return ''.join(output)
+
+
+def decode(data, out):
+    header = Reader(data)
+    if header.read_bytes(len(MAGIC)) != MAGIC:
+        raise ValueError('not a CHIP binary log file')
+    version, pid = header.read('BI')
+    if version != VERSION:
+        raise ValueError('unsupported binary log version %d' % version)
+
+    formats = {}
+    reader = Reader(data[header.offset:])
+    while reader.remaining() > 0:
+        try:
+            record_type, length = reader.read('BI')
+            record = Reader(reader.read_bytes(length))
+        except struct.error:
+            print('Truncated log file', file=sys.stderr)
+            break
+
+        record_type = chr(record_type)
+        if record_type == 'F':
+            format_id, format_length = record.read('IH')
+            formats[format_id] = record.read_bytes(format_length).decode('utf-8', errors='replace')
+        elif record_type == 'L':
+            timestamp, thread_id, _category, module_length = record.read('QIBB')
+            module = record.read_bytes(module_length).decode('ascii', errors='replace')
+            format_id, count = record.read('IB')
+            text = format_line(formats.get(format_id, '<unknown format %d>' % format_id), read_arguments(record, count))
+            seconds, micros = divmod(timestamp, 1000000)
+            out.write('[%d.%06d][%d:%d] CHIP:%s: %s\n' % (seconds, micros, pid, thread_id, module, text))
+        elif record_type == 'D':
+            timestamp, count = record.read('QQ')
+            seconds, micros = divmod(timestamp, 1000000)
+            out.write('[%d.%06d][%d] CHIP:LOG: %d log lines dropped\n' % (seconds, micros, pid, count))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode a CHIP binary log file into text')
+    parser.add_argument('log', help='binary log file, as written with CHIP_BINARY_LOG_FILE')
+    parser.add_argument('output', nargs='?', help='text output file, stdout by default')
+    args = parser.parse_args()
+
+    with open(args.log, 'rb') as f:
+        data = f.read()
+
+    if args.output:
+        with open(args.output, 'w') as out:
+            decode(data, out)
+    else:
+        decode(data, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
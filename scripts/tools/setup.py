@@ -0,0 +1,27 @@
+# Copyright (c) 2022 Project CHIP Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+"""The decode_binary_log module."""
+
+import setuptools  # type: ignore
+
+setuptools.setup(
+    name='decode_binary_log',
+    version='0.0.1',
+    author='Project CHIP Authors',
+    description='Decode the binary log files of the Linux asynchronous logging',
+    py_modules=['decode_binary_log'],
+    zip_safe=False,
+)
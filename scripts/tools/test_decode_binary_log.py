@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+#
+#    Copyright (c) 2022 Project CHIP Authors
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+#
+
+"""Tests decode_binary_log.py against a binary log file written by the
+asynchronous Linux logging backend.
+
+tests/binary_log/capture.bin was written with CHIP_BINARY_LOG_FILE set, and
+tests/binary_log/capture.txt is its decoded text: each line is the one printf
+writes, but for the wide string conversion, which is not captured.
+"""
+
+import io
+import os
+import struct
+import unittest
+from contextlib import redirect_stderr
+
+import decode_binary_log
+
+TESTS_DIR = os.path.join(os.path.dirname(__file__), 'tests', 'binary_log')
+
+
+def read_test_file(name, mode='rb'):
+    with open(os.path.join(TESTS_DIR, name), mode) as f:
+        return f.read()
+
+
+def decode(data):
+    out = io.StringIO()
+    decode_binary_log.decode(data, out)
+    return out.getvalue()
+
+
+def record_types(data):
+    types = []
+    offset = len(decode_binary_log.MAGIC) + 5
+    while offset < len(data):
+        record_type, length = struct.unpack_from('<BI', data, offset)
+        types.append(chr(record_type))
+        offset += 5 + length
+    return types
+
+
+class TestDecodeBinaryLog(unittest.TestCase):
+    def setUp(self):
+        self.capture = read_test_file('capture.bin')
+
+    def test_captured_log(self):
+        self.assertEqual(decode(self.capture), read_test_file('capture.txt', 'r'))
+
+    def test_formats_are_interned(self):
+        # One of the formats is used twice, and only defined once
+        types = record_types(self.capture)
+        self.assertEqual(types.count('L'), 10)
+        self.assertEqual(types.count('F'), 9)
+        self.assertEqual(types[0], 'F')
+
+    def test_dropped_lines(self):
+        dropped = struct.pack('<BIQQ', ord('D'), 16, 1792419131000042, 17)
+        lines = decode(self.capture + dropped).splitlines()
+        self.assertEqual(lines[-1], '[1792419131.000042][1336] CHIP:LOG: 17 log lines dropped')
+
+    def test_truncated_log(self):
+        # The lines before a record cut short, as when the process is killed, are decoded
+        stderr = io.StringIO()
+        with redirect_stderr(stderr):
+            text = decode(self.capture[:-4])
+        self.assertEqual(text.splitlines(), read_test_file('capture.txt', 'r').splitlines()[:-1])
+        self.assertIn('Truncated', stderr.getvalue())
+
+    def test_not_a_binary_log(self):
+        with self.assertRaises(ValueError):
+            decode(b'CHIP:DL: a text log line\n')
+
+    def test_unsupported_version(self):
+        magic_length = len(decode_binary_log.MAGIC)
+        with self.assertRaises(ValueError):
+            decode(self.capture[:magic_length] + b'\x02' + self.capture[magic_length + 1:])
+
+    def test_format_line(self):
+        # Conversions Python formats differently from printf
+        cases = [
+            ('%#o %#o', [8, 0], '010 0'),
+            ('%#x %#X %#x', [255, 255, 0], '0xff 0XFF 0'),
+            ('[%05.3d] [%.0d] [%+u]', [5, 0, 3], '[  005] [] [3]'),
+            ('%a %A %a', [1.0, -0.5, 0.0], '0x1p+0 -0X1P-1 0x0p+0'),
+            ('%.3a %.0a %.1a', [1.0 / 3, 1.5, 1.96875], '0x1.555p-2 0x2p+0 0x2.0p+0'),
+            ('[%012a] [%-10a]', [-3.0, 3.0], '[-0x0001.8p+1] [0x1.8p+1  ]'),
+            ('[%-3c] [%*d]', [ord('A'), -4, 7], '[A  ] [7   ]'),
+            ('%d %s %d', [1], '1 %s %d'),
+        ]
+        for fmt, arguments, expected in cases:
+            self.assertEqual(decode_binary_log.format_line(fmt, arguments), expected, fmt)
+
+
+if __name__ == '__main__':
+    unittest.main()
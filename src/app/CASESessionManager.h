@@ -76,9 +76,12 @@ public:
      *
      * The `onFailure` callback may be called before the FindOrEstablishSession
      * call returns, for error cases that are detected synchronously.
+     *
+     * To establish sessions with many nodes at once, see CASESessionScheduler,
+     * which paces calls to this method.
      */
-    void FindOrEstablishSession(const ScopedNodeId & peerId, Callback::Callback<OnDeviceConnected> * onConnection,
-                                Callback::Callback<OnDeviceConnectionFailure> * onFailure);
+    virtual void FindOrEstablishSession(const ScopedNodeId & peerId, Callback::Callback<OnDeviceConnected> * onConnection,
+                                        Callback::Callback<OnDeviceConnectionFailure> * onFailure);
 
     void ReleaseSessionsForFabric(FabricIndex fabricIndex);
 
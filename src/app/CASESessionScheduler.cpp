@@ -0,0 +1,284 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <app/CASESessionScheduler.h>
+
+#include <crypto/RandUtils.h>
+#include <lib/support/logging/CHIPLogging.h>
+
+namespace chip {
+
+bool CASESessionScheduler::Request::GoesBefore(const Request & other) const
+{
+    if (priority != other.priority)
+    {
+        return priority > other.priority;
+    }
+    if (resumable != other.resumable)
+    {
+        return resumable;
+    }
+    return sequence < other.sequence;
+}
+
+CHIP_ERROR CASESessionScheduler::Init(System::Layer * systemLayer, CASESessionManager * sessionManager,
+                                      SessionResumptionStorage * resumptionStorage, const CASESessionSchedulerConfig & config)
+{
+    VerifyOrReturnError(mSystemLayer == nullptr, CHIP_ERROR_INCORRECT_STATE);
+    VerifyOrReturnError(systemLayer != nullptr && sessionManager != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(config.maxConcurrent > 0 && config.maxAttempts > 0, CHIP_ERROR_INVALID_ARGUMENT);
+
+    mSystemLayer       = systemLayer;
+    mSessionManager    = sessionManager;
+    mResumptionStorage = resumptionStorage;
+    mConfig            = config;
+    mStats             = Stats();
+    return CHIP_NO_ERROR;
+}
+
+void CASESessionScheduler::Shutdown()
+{
+    VerifyOrReturn(mSystemLayer != nullptr);
+
+    mSystemLayer->CancelTimer(OnTimer, this);
+    mRequests.ForEachActiveObject([this](Request * request) {
+        ReleaseRequest(*request);
+        return Loop::Continue;
+    });
+    mSystemLayer = nullptr;
+}
+
+CHIP_ERROR CASESessionScheduler::Enqueue(const ScopedNodeId & peerId, Priority priority,
+                                         Callback::Callback<OnDeviceConnected> * onConnection,
+                                         Callback::Callback<OnDeviceConnectionFailure> * onFailure)
+{
+    VerifyOrReturnError(mSystemLayer != nullptr, CHIP_ERROR_INCORRECT_STATE);
+    VerifyOrReturnError(FindRequest(peerId) == nullptr, CHIP_ERROR_INCORRECT_STATE);
+
+    Request * request = mRequests.CreateObject(*this, peerId, priority, onConnection, onFailure);
+    VerifyOrReturnError(request != nullptr, CHIP_ERROR_NO_MEMORY);
+
+    request->sequence  = mNextSequence++;
+    request->readyAt   = System::SystemClock().GetMonotonicTimestamp();
+    request->resumable = HasResumptionTicket(peerId);
+
+    mStats.queued++;
+    if (request->resumable)
+    {
+        mStats.resumable++;
+    }
+
+    // Requests start from the event loop, so that a batch of Enqueue calls is
+    // ordered by priority as a whole.
+    ArmTimer();
+    return CHIP_NO_ERROR;
+}
+
+void CASESessionScheduler::Cancel(const ScopedNodeId & peerId)
+{
+    Request * request = FindRequest(peerId);
+    VerifyOrReturn(request != nullptr);
+
+    ReleaseRequest(*request);
+    ArmTimer();
+}
+
+void CASESessionScheduler::StartReadyRequests()
+{
+    while (mSystemLayer != nullptr && mStats.inProgress < mConfig.maxConcurrent)
+    {
+        const System::Clock::Timestamp now = System::SystemClock().GetMonotonicTimestamp();
+
+        Request * next = nullptr;
+        mRequests.ForEachActiveObject([&](Request * request) {
+            if (!request->connecting && request->readyAt <= now && (next == nullptr || request->GoesBefore(*next)))
+            {
+                next = request;
+            }
+            return Loop::Continue;
+        });
+
+        if (next == nullptr)
+        {
+            break;
+        }
+
+        StartRequest(*next);
+    }
+
+    ArmTimer();
+}
+
+void CASESessionScheduler::StartRequest(Request & request)
+{
+    request.connecting = true;
+    request.attempts++;
+
+    mStats.queued--;
+    mStats.inProgress++;
+    if (request.attempts > 1)
+    {
+        mStats.retries++;
+    }
+
+    ChipLogDetail(CASESessionManager, "Scheduler: attempt %u for [%u:" ChipLogFormatX64 "]", request.attempts,
+                  request.peerId.GetFabricIndex(), ChipLogValueX64(request.peerId.GetNodeId()));
+
+    // May complete, and release the request, before returning
+    mSessionManager->FindOrEstablishSession(request.peerId, &request.connectedCallback, &request.failureCallback);
+}
+
+void CASESessionScheduler::ArmTimer()
+{
+    VerifyOrReturn(mSystemLayer != nullptr);
+
+    // Completions re-arm the timer once below the concurrency limit
+    bool hasWaiting = false;
+    System::Clock::Timestamp nextReadyAt;
+    if (mStats.inProgress < mConfig.maxConcurrent)
+    {
+        mRequests.ForEachActiveObject([&](Request * request) {
+            if (!request->connecting && (!hasWaiting || request->readyAt < nextReadyAt))
+            {
+                hasWaiting  = true;
+                nextReadyAt = request->readyAt;
+            }
+            return Loop::Continue;
+        });
+    }
+
+    if (!hasWaiting)
+    {
+        mSystemLayer->CancelTimer(OnTimer, this);
+        return;
+    }
+
+    const System::Clock::Timestamp now = System::SystemClock().GetMonotonicTimestamp();
+    const System::Clock::Timeout delay = (nextReadyAt > now) ? (nextReadyAt - now) : System::Clock::kZero;
+    if (mSystemLayer->StartTimer(delay, OnTimer, this) != CHIP_NO_ERROR)
+    {
+        ChipLogError(CASESessionManager, "Scheduler: failed to arm timer, %u requests stalled",
+                     static_cast<unsigned>(mStats.queued));
+    }
+}
+
+void CASESessionScheduler::HandleConnected(void * context, Messaging::ExchangeManager & exchangeMgr, SessionHandle & sessionHandle)
+{
+    Request * request                                    = static_cast<Request *>(context);
+    CASESessionScheduler & scheduler                     = request->scheduler;
+    Callback::Callback<OnDeviceConnected> * onConnection = request->onConnection;
+
+    scheduler.mStats.succeeded++;
+    scheduler.ReleaseRequest(*request);
+    scheduler.ArmTimer();
+
+    if (onConnection != nullptr)
+    {
+        onConnection->mCall(onConnection->mContext, exchangeMgr, sessionHandle);
+    }
+}
+
+void CASESessionScheduler::HandleFailure(void * context, const ScopedNodeId & peerId, CHIP_ERROR error)
+{
+    Request * request                = static_cast<Request *>(context);
+    CASESessionScheduler & scheduler = request->scheduler;
+
+    if (request->attempts < scheduler.mConfig.maxAttempts)
+    {
+        const System::Clock::Milliseconds32 backoff = scheduler.Backoff(request->attempts);
+
+        ChipLogProgress(CASESessionManager, "Scheduler: retry [%u:" ChipLogFormatX64 "] in %" PRIu32 "ms: %" CHIP_ERROR_FORMAT,
+                        peerId.GetFabricIndex(), ChipLogValueX64(peerId.GetNodeId()), backoff.count(), error.Format());
+
+        request->connecting = false;
+        request->readyAt    = System::SystemClock().GetMonotonicTimestamp() + backoff;
+        scheduler.mStats.inProgress--;
+        scheduler.mStats.queued++;
+        scheduler.ArmTimer();
+        return;
+    }
+
+    Callback::Callback<OnDeviceConnectionFailure> * onFailure = request->onFailure;
+
+    scheduler.mStats.failed++;
+    scheduler.ReleaseRequest(*request);
+    scheduler.ArmTimer();
+
+    if (onFailure != nullptr)
+    {
+        onFailure->mCall(onFailure->mContext, peerId, error);
+    }
+}
+
+CASESessionScheduler::Request * CASESessionScheduler::FindRequest(const ScopedNodeId & peerId)
+{
+    Request * found = nullptr;
+    mRequests.ForEachActiveObject([&](Request * request) {
+        if (request->peerId == peerId)
+        {
+            found = request;
+            return Loop::Break;
+        }
+        return Loop::Continue;
+    });
+    return found;
+}
+
+void CASESessionScheduler::ReleaseRequest(Request & request)
+{
+    if (request.connecting)
+    {
+        // No-ops once CASESessionManager dequeued them to report the outcome
+        request.connectedCallback.Cancel();
+        request.failureCallback.Cancel();
+        mStats.inProgress--;
+    }
+    else
+    {
+        mStats.queued--;
+    }
+    mRequests.ReleaseObject(&request);
+}
+
+bool CASESessionScheduler::HasResumptionTicket(const ScopedNodeId & peerId)
+{
+    VerifyOrReturnValue(mResumptionStorage != nullptr, false);
+
+    SessionResumptionStorage::ResumptionIdStorage resumptionId;
+    Crypto::P256ECDHDerivedSecret sharedSecret;
+    CATValues peerCATs;
+    return mResumptionStorage->FindByScopedNodeId(peerId, resumptionId, sharedSecret, peerCATs) == CHIP_NO_ERROR;
+}
+
+System::Clock::Milliseconds32 CASESessionScheduler::Backoff(uint8_t failedAttempts) const
+{
+    // Doubled for every failed attempt but the first, capped at maxBackoff
+    uint64_t backoffMs = mConfig.initialBackoff.count();
+    for (uint8_t i = 1; i < failedAttempts && backoffMs < mConfig.maxBackoff.count(); i++)
+    {
+        backoffMs *= 2;
+    }
+    backoffMs = std::min<uint64_t>(backoffMs, mConfig.maxBackoff.count());
+
+    // Up to 25% of jitter, so that peers which failed together do not retry together
+    backoffMs += backoffMs * Crypto::GetRandU8() / 1024;
+
+    return System::Clock::Milliseconds32(static_cast<uint32_t>(backoffMs));
+}
+
+} // namespace chip
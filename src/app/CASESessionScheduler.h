@@ -0,0 +1,163 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <app/CASESessionManager.h>
+#include <lib/core/CHIPCallback.h>
+#include <lib/core/CHIPConfig.h>
+#include <lib/support/Pool.h>
+#include <protocols/secure_channel/SessionResumptionStorage.h>
+#include <system/SystemClock.h>
+#include <system/SystemLayer.h>
+
+namespace chip {
+
+struct CASESessionSchedulerConfig
+{
+    /// Session establishments in progress at once; should not exceed the CASE client pool size
+    uint16_t maxConcurrent = CHIP_CONFIG_CONTROLLER_MAX_ACTIVE_CASE_CLIENTS;
+    /// Attempts made for a peer before its failure is reported
+    uint8_t maxAttempts = 5;
+    /// Backoff after the first failed attempt, doubled after every further one
+    System::Clock::Milliseconds32 initialBackoff = System::Clock::Milliseconds32(1000);
+    System::Clock::Milliseconds32 maxBackoff     = System::Clock::Milliseconds32(60000);
+};
+
+/**
+ * Paces the establishment of CASE sessions with many peers, e.g. when a
+ * controller reconnects to all its nodes after a restart.
+ *
+ * Requests are queued and handed to CASESessionManager::FindOrEstablishSession
+ * at most `maxConcurrent` at a time, so that the session setup and CASE client
+ * pools are never exhausted. Among the requests ready to start, higher
+ * priorities go first, then peers for which a resumption ticket is stored
+ * (their handshake is shorter), then the oldest requests.
+ *
+ * Failed attempts are retried after an exponential backoff per peer. The
+ * callbacks given to Enqueue are called once, with the final outcome.
+ */
+class CASESessionScheduler
+{
+public:
+    enum class Priority : uint8_t
+    {
+        kLow,
+        kNormal,
+        kHigh,
+    };
+
+    /// Progress of the scheduled session establishments
+    struct Stats
+    {
+        size_t queued      = 0; ///< requests waiting for their first attempt or a retry
+        size_t inProgress  = 0; ///< session establishments in progress
+        uint32_t succeeded = 0;
+        uint32_t failed    = 0; ///< requests which failed their last attempt
+        uint32_t retries   = 0; ///< attempts started after a failure
+        uint32_t resumable = 0; ///< requests for peers with a stored resumption ticket
+    };
+
+    CASESessionScheduler() = default;
+    ~CASESessionScheduler() { Shutdown(); }
+
+    /// [resumptionStorage] may be null, in which case no peer is preferred for resumption.
+    CHIP_ERROR Init(System::Layer * systemLayer, CASESessionManager * sessionManager, SessionResumptionStorage * resumptionStorage,
+                    const CASESessionSchedulerConfig & config = CASESessionSchedulerConfig());
+
+    /// Cancel all requests without calling their callbacks.
+    void Shutdown();
+
+    /**
+     * Queue the establishment of a session with [peerId].
+     *
+     * `onConnection` or `onFailure` is called once the session is established,
+     * or once the last attempt failed. They are never called before Enqueue
+     * returns. Only one request per peer may be queued.
+     */
+    CHIP_ERROR Enqueue(const ScopedNodeId & peerId, Priority priority, Callback::Callback<OnDeviceConnected> * onConnection,
+                       Callback::Callback<OnDeviceConnectionFailure> * onFailure);
+
+    /**
+     * Remove the request for [peerId] without calling its callbacks.
+     *
+     * An establishment in progress is not aborted: CASESessionManager still
+     * completes it, but its outcome is no longer reported.
+     */
+    void Cancel(const ScopedNodeId & peerId);
+
+    const Stats & GetStats() const { return mStats; }
+
+private:
+    struct Request
+    {
+        Request(CASESessionScheduler & aScheduler, const ScopedNodeId & aPeerId, Priority aPriority,
+                Callback::Callback<OnDeviceConnected> * aOnConnection, Callback::Callback<OnDeviceConnectionFailure> * aOnFailure) :
+            scheduler(aScheduler), peerId(aPeerId), priority(aPriority), onConnection(aOnConnection), onFailure(aOnFailure),
+            connectedCallback(HandleConnected, this), failureCallback(HandleFailure, this)
+        {}
+
+        CASESessionScheduler & scheduler;
+        ScopedNodeId peerId;
+        Priority priority;
+        bool resumable    = false;
+        bool connecting   = false;
+        uint8_t attempts  = 0;
+        uint32_t sequence = 0; // order of the Enqueue calls
+        System::Clock::Timestamp readyAt;
+
+        Callback::Callback<OnDeviceConnected> * onConnection;
+        Callback::Callback<OnDeviceConnectionFailure> * onFailure;
+
+        // Given to CASESessionManager for the attempt in progress
+        Callback::Callback<OnDeviceConnected> connectedCallback;
+        Callback::Callback<OnDeviceConnectionFailure> failureCallback;
+
+        /// Whether this request starts before [other] when both are ready
+        bool GoesBefore(const Request & other) const;
+    };
+
+    static void HandleConnected(void * context, Messaging::ExchangeManager & exchangeMgr, SessionHandle & sessionHandle);
+    static void HandleFailure(void * context, const ScopedNodeId & peerId, CHIP_ERROR error);
+    static void OnTimer(System::Layer * layer, void * context)
+    {
+        static_cast<CASESessionScheduler *>(context)->StartReadyRequests();
+    }
+
+    /// Start ready requests while under the concurrency limit
+    void StartReadyRequests();
+    void StartRequest(Request & request);
+
+    /// Arm the timer for the next request to start, if any can start.
+    void ArmTimer();
+
+    Request * FindRequest(const ScopedNodeId & peerId);
+    void ReleaseRequest(Request & request);
+    bool HasResumptionTicket(const ScopedNodeId & peerId);
+    System::Clock::Milliseconds32 Backoff(uint8_t failedAttempts) const;
+
+    System::Layer * mSystemLayer                  = nullptr;
+    CASESessionManager * mSessionManager          = nullptr;
+    SessionResumptionStorage * mResumptionStorage = nullptr;
+    CASESessionSchedulerConfig mConfig;
+    Stats mStats;
+    uint32_t mNextSequence = 0;
+    ObjectPool<Request, CHIP_CONFIG_CASE_SESSION_SCHEDULER_MAX_REQUESTS> mRequests;
+};
+
+} // namespace chip
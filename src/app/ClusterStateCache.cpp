@@ -16,39 +16,107 @@
  *    limitations under the License.
  */
 
-#include "system/SystemPacketBuffer.h"
 #include <app/ClusterStateCache.h>
 #include <app/InteractionModelEngine.h>
-#include <tuple>
+#include <algorithm>
+#include <string.h>
 
 namespace chip {
 namespace app {
 
-CHIP_ERROR ClusterStateCache::GetElementTLVSize(TLV::TLVReader * apData, size_t & aSize)
+constexpr size_t ClusterStateCache::Arena::kBlockSize;
+
+MutableByteSpan ClusterStateCache::Arena::GetFreeSpace()
+{
+    if (mBlocks.empty())
+    {
+        return MutableByteSpan();
+    }
+
+    Block & block = mBlocks.back();
+    return MutableByteSpan(block.mData.Get() + block.mUsed, block.mData.AllocatedSize() - block.mUsed);
+}
+
+CHIP_ERROR ClusterStateCache::Arena::AddBlock(size_t aMinSize)
+{
+    Block block;
+    block.mData.Alloc(std::max(aMinSize, kBlockSize));
+    VerifyOrReturnError(block.mData.Get() != nullptr, CHIP_ERROR_NO_MEMORY);
+    mBlocks.push_back(std::move(block));
+    return CHIP_NO_ERROR;
+}
+
+ByteSpan ClusterStateCache::Arena::Commit(size_t aLength)
+{
+    Block & block = mBlocks.back();
+    ByteSpan committed(block.mData.Get() + block.mUsed, aLength);
+    block.mUsed += aLength;
+    mUsedSize += aLength;
+    return committed;
+}
+
+CHIP_ERROR ClusterStateCache::Arena::CopyElement(const TLV::TLVReader & aReader, ByteSpan & aEncoded)
 {
-    Platform::ScopedMemoryBufferWithSize<uint8_t> backingBuffer;
+    //
+    // Measure the element by skipping over it: the reader has already consumed its head, so the length read meanwhile is the
+    // rest of the element. Re-encoded with an anonymous tag, its head is at most a control byte and an 8-byte length.
+    //
     TLV::TLVReader reader;
-    reader.Init(*apData);
-    size_t totalBufSize = reader.GetTotalLength();
-    backingBuffer.Calloc(totalBufSize);
-    VerifyOrReturnError(backingBuffer.Get() != nullptr, CHIP_ERROR_NO_MEMORY);
-    TLV::ScopedBufferTLVWriter writer(std::move(backingBuffer), totalBufSize);
+    reader.Init(aReader);
+    const uint32_t headEnd = reader.GetLengthRead();
+    ReturnErrorOnFailure(reader.Skip());
+    ReturnErrorOnFailure(Reserve(reader.GetLengthRead() - headEnd + 1 + sizeof(uint64_t)));
+
+    TLV::TLVWriter writer;
+    reader.Init(aReader);
+    writer.Init(GetFreeSpace());
     ReturnErrorOnFailure(writer.CopyElement(TLV::AnonymousTag(), reader));
-    aSize = writer.GetLengthWritten();
-    ReturnErrorOnFailure(writer.Finalize(backingBuffer));
+    ReturnErrorOnFailure(writer.Finalize());
+    aEncoded = Commit(writer.GetLengthWritten());
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR ClusterStateCache::Arena::Reserve(size_t aSize)
+{
+    if (GetFreeSpace().size() < aSize)
+    {
+        return AddBlock(aSize);
+    }
     return CHIP_NO_ERROR;
 }
 
+CHIP_ERROR ClusterStateCache::Arena::Copy(const ByteSpan & aData, ByteSpan & aCopy)
+{
+    ReturnErrorOnFailure(Reserve(aData.size()));
+    memcpy(GetFreeSpace().data(), aData.data(), aData.size());
+    aCopy = Commit(aData.size());
+    return CHIP_NO_ERROR;
+}
+
+ClusterStateCache::ClusterState & ClusterStateCache::GetOrCreateClusterState(const ConcreteClusterPath & aPath)
+{
+    auto clusterIter = LowerBoundCluster(aPath);
+    if (clusterIter == mClusters.end() || clusterIter->mPath != aPath)
+    {
+        ClusterState clusterState;
+        clusterState.mPath = ConcreteClusterPath(aPath.mEndpointId, aPath.mClusterId);
+        clusterIter        = mClusters.insert(clusterIter, clusterState);
+    }
+
+    return mClusters[static_cast<size_t>(clusterIter - mClusters.cbegin())];
+}
+
 CHIP_ERROR ClusterStateCache::UpdateCache(const ConcreteDataAttributePath & aPath, TLV::TLVReader * apData,
                                           const StatusIB & aStatus)
 {
     AttributeState state;
+    auto endpointIter  = LowerBoundCluster(ConcreteClusterPath(aPath.mEndpointId, 0));
     bool endpointIsNew = false;
 
-    if (mCache.find(aPath.mEndpointId) == mCache.end())
+    if (endpointIter == mClusters.end() || endpointIter->mPath.mEndpointId != aPath.mEndpointId)
     {
         //
-        // Since we might potentially be creating a new entry at mCache[aPath.mEndpointId][aPath.mClusterId] that
+        // Since we might potentially be creating a new cluster entry for aPath.mEndpointId that
         // wasn't there before, we need to check if an entry didn't exist there previously and remember that so that
         // we can appropriately notify our clients of the addition of a new endpoint.
         //
@@ -57,21 +125,15 @@ CHIP_ERROR ClusterStateCache::UpdateCache(const ConcreteDataAttributePath & aPat
 
     if (apData)
     {
-        size_t elementSize = 0;
-        ReturnErrorOnFailure(GetElementTLVSize(apData, elementSize));
-        Platform::ScopedMemoryBufferWithSize<uint8_t> backingBuffer;
-        backingBuffer.Calloc(elementSize);
-        VerifyOrReturnError(backingBuffer.Get() != nullptr, CHIP_ERROR_NO_MEMORY);
-        TLV::ScopedBufferTLVWriter writer(std::move(backingBuffer), elementSize);
-        ReturnErrorOnFailure(writer.CopyElement(TLV::AnonymousTag(), *apData));
-        ReturnErrorOnFailure(writer.Finalize(backingBuffer));
-
-        state.Set<Platform::ScopedMemoryBufferWithSize<uint8_t>>(std::move(backingBuffer));
+        ByteSpan encoded;
+        ReturnErrorOnFailure(mAttributeArena.CopyElement(*apData, encoded));
+
+        state.Set<ByteSpan>(encoded);
         //
         // Clear out the committed data version and only set it again once we have received all data for this cluster.
         // Otherwise, we may have incomplete data that looks like it's complete since it has a valid data version.
         //
-        mCache[aPath.mEndpointId][aPath.mClusterId].mCommittedDataVersion.ClearValue();
+        GetOrCreateClusterState(aPath).mCommittedDataVersion.ClearValue();
 
         // This commits a pending data version if the last report path is valid and it is different from the current path.
         if (mLastReportDataPath.IsValidConcreteClusterPath() && mLastReportDataPath != aPath)
@@ -92,10 +154,11 @@ CHIP_ERROR ClusterStateCache::UpdateCache(const ConcreteDataAttributePath & aPat
         // if this data item is encompassed by a wildcard path, let's go ahead and update its pending data version.
         if (foundEncompassingWildcardPath)
         {
-            mCache[aPath.mEndpointId][aPath.mClusterId].mPendingDataVersion = aPath.mDataVersion;
+            GetOrCreateClusterState(aPath).mPendingDataVersion = aPath.mDataVersion;
         }
 
         mLastReportDataPath = aPath;
+        mAttributeDataSize += encoded.size();
     }
     else
     {
@@ -111,8 +174,26 @@ CHIP_ERROR ClusterStateCache::UpdateCache(const ConcreteDataAttributePath & aPat
         mAddedEndpoints.push_back(aPath.mEndpointId);
     }
 
-    mCache[aPath.mEndpointId][aPath.mClusterId].mAttributes[aPath.mAttributeId] = std::move(state);
-    mChangedAttributeSet.insert(aPath);
+    GetOrCreateClusterState(aPath);
+
+    const ConcreteAttributePath attributePath(aPath.mEndpointId, aPath.mClusterId, aPath.mAttributeId);
+    auto attributeIter = LowerBoundAttribute(attributePath);
+    if (attributeIter != mAttributes.end() && attributeIter->mPath == attributePath)
+    {
+        AttributeEntry & attribute = mAttributes[static_cast<size_t>(attributeIter - mAttributes.cbegin())];
+        if (attribute.mState.Is<ByteSpan>())
+        {
+            // The previous value stays in the arena until the next compaction.
+            mAttributeDataSize -= attribute.mState.Get<ByteSpan>().size();
+        }
+        attribute.mState = state;
+    }
+    else
+    {
+        mAttributes.insert(attributeIter, AttributeEntry{ attributePath, state });
+    }
+
+    mChangedAttributes.push_back(attributePath);
     return CHIP_NO_ERROR;
 }
 
@@ -127,26 +208,20 @@ CHIP_ERROR ClusterStateCache::UpdateEventCache(const EventHeader & aEventHeader,
         {
             return CHIP_NO_ERROR;
         }
-        System::PacketBufferHandle handle = System::PacketBufferHandle::New(chip::app::kMaxSecureSduLengthBytes);
-        VerifyOrReturnError(!handle.IsNull(), CHIP_ERROR_NO_MEMORY);
 
-        System::PacketBufferTLVWriter writer;
-        writer.Init(std::move(handle), false);
-
-        ReturnErrorOnFailure(writer.CopyElement(TLV::AnonymousTag(), *apData));
-        ReturnErrorOnFailure(writer.Finalize(&handle));
+        ByteSpan encoded;
+        ReturnErrorOnFailure(mEventArena.CopyElement(*apData, encoded));
 
         //
-        // Compact the buffer down to a more reasonably sized packet buffer
-        // if we can.
+        // Event numbers only increase, so this is almost always an insertion at the end.
         //
-        handle.RightSize();
-
-        EventData eventData;
-        eventData.first  = aEventHeader;
-        eventData.second = std::move(handle);
-
-        mEventDataCache.insert(std::move(eventData));
+        auto eventIter = std::lower_bound(
+            mEventDataCache.begin(), mEventDataCache.end(), aEventHeader.mEventNumber,
+            [](const EventData & eventData, EventNumber eventNumber) { return eventData.first.mEventNumber < eventNumber; });
+        if (eventIter == mEventDataCache.end() || eventIter->first.mEventNumber != aEventHeader.mEventNumber)
+        {
+            mEventDataCache.insert(eventIter, EventData(aEventHeader, encoded));
+        }
 
         mHighestReceivedEventNumber.SetValue(aEventHeader.mEventNumber);
     }
@@ -158,11 +233,51 @@ CHIP_ERROR ClusterStateCache::UpdateEventCache(const EventHeader & aEventHeader,
     return CHIP_NO_ERROR;
 }
 
+CHIP_ERROR ClusterStateCache::Compact()
+{
+    Arena compacted;
+
+    //
+    // Reserve a single block for all the values in use up front, so that the copies below cannot fail half-way through.
+    //
+    if (mAttributeDataSize > 0)
+    {
+        ReturnErrorOnFailure(compacted.Reserve(mAttributeDataSize));
+    }
+
+    for (auto & attribute : mAttributes)
+    {
+        if (attribute.mState.Is<ByteSpan>())
+        {
+            ByteSpan copy;
+            VerifyOrDie(compacted.Copy(attribute.mState.Get<ByteSpan>(), copy) == CHIP_NO_ERROR);
+            attribute.mState.Set<ByteSpan>(copy);
+        }
+    }
+
+    mAttributeArena.Swap(compacted);
+    return CHIP_NO_ERROR;
+}
+
 void ClusterStateCache::OnReportBegin()
 {
     mLastReportDataPath = ConcreteClusterPath(kInvalidEndpointId, kInvalidClusterId);
-    mChangedAttributeSet.clear();
+    mChangedAttributes.clear();
     mAddedEndpoints.clear();
+
+    //
+    // Nothing can be holding on to cached values between reports, so this is the time to reclaim the space of the values
+    // replaced by previous reports, once that is worth a copy of the values still in use.
+    //
+    if (GetReclaimableSize() > std::max(mAttributeDataSize, Arena::kBlockSize))
+    {
+        CHIP_ERROR err = Compact();
+        if (err != CHIP_NO_ERROR)
+        {
+            ChipLogError(DataManagement, "Failed to compact the cluster state cache: %" CHIP_ERROR_FORMAT, err.Format());
+        }
+    }
+
     mCallback.OnReportBegin();
 }
 
@@ -173,7 +288,7 @@ void ClusterStateCache::CommitPendingDataVersion()
         return;
     }
 
-    auto & lastClusterInfo = mCache[mLastReportDataPath.mEndpointId][mLastReportDataPath.mClusterId];
+    auto & lastClusterInfo = GetOrCreateClusterState(mLastReportDataPath);
     if (lastClusterInfo.mPendingDataVersion.HasValue())
     {
         lastClusterInfo.mCommittedDataVersion = lastClusterInfo.mPendingDataVersion;
@@ -185,21 +300,26 @@ void ClusterStateCache::OnReportEnd()
 {
     CommitPendingDataVersion();
     mLastReportDataPath = ConcreteClusterPath(kInvalidEndpointId, kInvalidClusterId);
-    std::set<std::tuple<EndpointId, ClusterId>> changedClusters;
 
-    //
-    // Add the EndpointId and ClusterId into a set so that we only
-    // convey unique combinations in the subsequent OnClusterChanged callback.
-    //
-    for (auto & path : mChangedAttributeSet)
+    std::sort(mChangedAttributes.begin(), mChangedAttributes.end());
+    mChangedAttributes.erase(std::unique(mChangedAttributes.begin(), mChangedAttributes.end()), mChangedAttributes.end());
+
+    for (auto & path : mChangedAttributes)
     {
         mCallback.OnAttributeChanged(this, path);
-        changedClusters.insert(std::make_tuple(path.mEndpointId, path.mClusterId));
     }
 
-    for (auto & item : changedClusters)
+    //
+    // The changed attributes are sorted by path, so the attributes of a cluster are next to each other and we only
+    // need to skip repeats to convey unique combinations of EndpointId and ClusterId in the OnClusterChanged callback.
+    //
+    for (size_t i = 0; i < mChangedAttributes.size(); i++)
     {
-        mCallback.OnClusterChanged(this, std::get<0>(item), std::get<1>(item));
+        const ConcreteAttributePath & path = mChangedAttributes[i];
+        if (i == 0 || ConcreteClusterPath(mChangedAttributes[i - 1]) != path)
+        {
+            mCallback.OnClusterChanged(this, path.mEndpointId, path.mClusterId);
+        }
     }
 
     for (auto endpoint : mAddedEndpoints)
@@ -220,8 +340,7 @@ CHIP_ERROR ClusterStateCache::Get(const ConcreteAttributePath & path, TLV::TLVRe
         return CHIP_ERROR_IM_STATUS_CODE_RECEIVED;
     }
 
-    reader.Init(attributeState->Get<Platform::ScopedMemoryBufferWithSize<uint8_t>>().Get(),
-                attributeState->Get<Platform::ScopedMemoryBufferWithSize<uint8_t>>().AllocatedSize());
+    reader.Init(attributeState->Get<ByteSpan>());
     return reader.Next();
 }
 
@@ -232,75 +351,46 @@ CHIP_ERROR ClusterStateCache::Get(EventNumber eventNumber, TLV::TLVReader & read
     auto eventData = GetEventData(eventNumber, err);
     ReturnErrorOnFailure(err);
 
-    System::PacketBufferTLVReader bufReader;
-
-    bufReader.Init(eventData->second.Retain());
-    ReturnErrorOnFailure(bufReader.Next());
-
-    reader.Init(bufReader);
-    return CHIP_NO_ERROR;
-}
-
-const ClusterStateCache::EndpointState * ClusterStateCache::GetEndpointState(EndpointId endpointId, CHIP_ERROR & err) const
-{
-    auto endpointIter = mCache.find(endpointId);
-    if (endpointIter == mCache.end())
-    {
-        err = CHIP_ERROR_KEY_NOT_FOUND;
-        return nullptr;
-    }
-
-    err = CHIP_NO_ERROR;
-    return &endpointIter->second;
+    reader.Init(eventData->second);
+    return reader.Next();
 }
 
 const ClusterStateCache::ClusterState * ClusterStateCache::GetClusterState(EndpointId endpointId, ClusterId clusterId,
                                                                            CHIP_ERROR & err) const
 {
-    auto endpointState = GetEndpointState(endpointId, err);
-    if (err != CHIP_NO_ERROR)
-    {
-        return nullptr;
-    }
-
-    auto clusterState = endpointState->find(clusterId);
-    if (clusterState == endpointState->end())
+    const ConcreteClusterPath path(endpointId, clusterId);
+    auto clusterState = LowerBoundCluster(path);
+    if (clusterState == mClusters.end() || clusterState->mPath != path)
     {
         err = CHIP_ERROR_KEY_NOT_FOUND;
         return nullptr;
     }
 
     err = CHIP_NO_ERROR;
-    return &clusterState->second;
+    return &(*clusterState);
 }
 
 const ClusterStateCache::AttributeState * ClusterStateCache::GetAttributeState(EndpointId endpointId, ClusterId clusterId,
                                                                                AttributeId attributeId, CHIP_ERROR & err) const
 {
-    auto clusterState = GetClusterState(endpointId, clusterId, err);
-    if (err != CHIP_NO_ERROR)
-    {
-        return nullptr;
-    }
-
-    auto attributeState = clusterState->mAttributes.find(attributeId);
-    if (attributeState == clusterState->mAttributes.end())
+    const ConcreteAttributePath path(endpointId, clusterId, attributeId);
+    auto attributeState = LowerBoundAttribute(path);
+    if (attributeState == mAttributes.end() || attributeState->mPath != path)
     {
         err = CHIP_ERROR_KEY_NOT_FOUND;
         return nullptr;
     }
 
     err = CHIP_NO_ERROR;
-    return &attributeState->second;
+    return &attributeState->mState;
 }
 
 const ClusterStateCache::EventData * ClusterStateCache::GetEventData(EventNumber eventNumber, CHIP_ERROR & err) const
 {
-    EventData compareKey;
-
-    compareKey.first.mEventNumber = eventNumber;
-    auto eventData                = mEventDataCache.find(std::move(compareKey));
-    if (eventData == mEventDataCache.end())
+    auto eventData = std::lower_bound(
+        mEventDataCache.begin(), mEventDataCache.end(), eventNumber,
+        [](const EventData & item, EventNumber number) { return item.first.mEventNumber < number; });
+    if (eventData == mEventDataCache.end() || eventData->first.mEventNumber != eventNumber)
     {
         err = CHIP_ERROR_KEY_NOT_FOUND;
         return nullptr;
@@ -394,54 +484,46 @@ CHIP_ERROR ClusterStateCache::GetStatus(const ConcreteEventPath & path, StatusIB
 
 void ClusterStateCache::GetSortedFilters(std::vector<std::pair<DataVersionFilter, size_t>> & aVector) const
 {
-    for (auto const & endpointIter : mCache)
+    for (auto const & clusterState : mClusters)
     {
-        EndpointId endpointId = endpointIter.first;
-        for (auto const & clusterIter : endpointIter.second)
+        if (!clusterState.mCommittedDataVersion.HasValue())
         {
-            if (!clusterIter.second.mCommittedDataVersion.HasValue())
-            {
-                continue;
-            }
-            DataVersion dataVersion = clusterIter.second.mCommittedDataVersion.Value();
-            uint32_t clusterSize    = 0;
-            ClusterId clusterId     = clusterIter.first;
-
-            for (auto const & attributeIter : clusterIter.second.mAttributes)
+            continue;
+        }
+        DataVersion dataVersion = clusterState.mCommittedDataVersion.Value();
+        size_t clusterSize      = 0;
+        EndpointId endpointId   = clusterState.mPath.mEndpointId;
+        ClusterId clusterId     = clusterState.mPath.mClusterId;
+
+        for (auto attributeIter = LowerBoundAttribute(ConcreteAttributePath(endpointId, clusterId, 0));
+             attributeIter != mAttributes.end() && attributeIter->mPath.mEndpointId == endpointId &&
+             attributeIter->mPath.mClusterId == clusterId;
+             ++attributeIter)
+        {
+            if (attributeIter->mState.Is<StatusIB>())
             {
-                if (attributeIter.second.Is<StatusIB>())
+                clusterSize += 5; // 1 byte: anonymous tag control byte for struct. 1 byte: control byte for uint8 value. 1 byte:
+                                  // context-specific tag for uint8 value.1 byte: the uint8 value. 1 byte: end of container.
+                if (attributeIter->mState.Get<StatusIB>().mClusterStatus.HasValue())
                 {
-                    clusterSize +=
-                        5; // 1 byte: anonymous tag control byte for struct. 1 byte: control byte for uint8 value. 1 byte:
-                           // context-specific tag for uint8 value.1 byte: the uint8 value. 1 byte: end of container.
-                    if (attributeIter.second.Get<StatusIB>().mClusterStatus.HasValue())
-                    {
-                        clusterSize += 3; // 1 byte: control byte for uint8 value. 1 byte: context-specific tag for uint8 value. 1
-                                          // byte: the uint8 value.
-                    }
-                }
-                else
-                {
-                    TLV::TLVReader bufReader;
-                    bufReader.Init(attributeIter.second.Get<Platform::ScopedMemoryBufferWithSize<uint8_t>>().Get(),
-                                   attributeIter.second.Get<Platform::ScopedMemoryBufferWithSize<uint8_t>>().AllocatedSize());
-                    ReturnOnFailure(bufReader.Next());
-                    // Skip to the end of the element.
-                    ReturnOnFailure(bufReader.Skip());
-
-                    // Compute the amount of value data
-                    clusterSize += bufReader.GetLengthRead();
+                    clusterSize += 3; // 1 byte: control byte for uint8 value. 1 byte: context-specific tag for uint8 value. 1
+                                      // byte: the uint8 value.
                 }
             }
-            if (clusterSize == 0)
+            else
             {
-                continue;
+                // The cached element is exactly the value data.
+                clusterSize += attributeIter->mState.Get<ByteSpan>().size();
             }
+        }
+        if (clusterSize == 0)
+        {
+            continue;
+        }
 
-            DataVersionFilter filter(endpointId, clusterId, dataVersion);
+        DataVersionFilter filter(endpointId, clusterId, dataVersion);
 
-            aVector.push_back(std::make_pair(filter, clusterSize));
-        }
+        aVector.push_back(std::make_pair(filter, clusterSize));
     }
     std::sort(aVector.begin(), aVector.end(),
               [](const std::pair<DataVersionFilter, size_t> & x, const std::pair<DataVersionFilter, size_t> & y) {
@@ -26,10 +26,12 @@
 #include <app/ReadClient.h>
 #include <app/data-model/DecodableList.h>
 #include <app/data-model/Decode.h>
+#include <lib/support/ScopedBuffer.h>
+#include <lib/support/Span.h>
 #include <lib/support/Variant.h>
+#include <algorithm>
 #include <list>
 #include <map>
-#include <queue>
 #include <set>
 #include <vector>
 
@@ -55,6 +57,11 @@ namespace app {
  * The data is stored internally in the cache as TLV. This permits re-use of the existing cluster objects
  * to de-serialize the state on-demand.
  *
+ * Clusters and attributes are kept in flat vectors sorted by path, and the TLV payloads are packed into arenas
+ * of large blocks instead of being allocated one by one. Payloads replaced by newer reports stay in the arena until it is
+ * compacted, which happens automatically at the start of a report once enough space can be reclaimed, or on demand through
+ * Compact().
+ *
  * The cache serves as a callback adapter as well in that it 'forwards' the ReadClient::Callback calls transparently
  * through to a registered callback. In addition, it provides its own enhancements to the base ReadClient::Callback
  * to make it easier to know what has changed in the cache.
@@ -110,7 +117,7 @@ public:
      *
      * For some types of attributes, the value for the attribute is directly backed by the underlying TLV buffer
      * and has pointers into that buffer. (e.g octet strings, char strings and lists).  This buffer only remains
-     * valid until the cached value for that path is updated, so it must not be held
+     * valid until the cached value for that path is updated or the cache is compacted, so it must not be held
      * across any async call boundaries.
      *
      * The template parameter AttributeObjectTypeT is generally expected to be a
@@ -171,7 +178,7 @@ public:
      *
      * For some types of attributes, the value for the attribute is directly backed by the underlying TLV buffer
      * and has pointers into that buffer. (e.g octet strings, char strings and lists).  This buffer only remains
-     * valid until the cached value for that path is updated, so it must not be held
+     * valid until the cached value for that path is updated or the cache is compacted, so it must not be held
      * across any async call boundaries.
      *
      * The template parameter ClusterObjectT is generally expected to be a
@@ -218,8 +225,8 @@ public:
      * Retrieve the value of an attribute by updating a in-out TLVReader to be positioned
      * right at the attribute value.
      *
-     * The underlying TLV buffer only remains valid until the cached value for that path is updated, so it must
-     * not be held across any async call boundaries.
+     * The underlying TLV buffer only remains valid until the cached value for that path is updated or the cache is
+     * compacted, so it must not be held across any async call boundaries.
      *
      * Notable return values:
      *      - If neither data nor status for the specified path exist in the cache, CHIP_ERROR_KEY_NOT_FOUND
@@ -332,12 +339,15 @@ public:
     {
         CHIP_ERROR err;
 
-        auto clusterState = GetClusterState(endpointId, clusterId, err);
+        GetClusterState(endpointId, clusterId, err);
         ReturnErrorOnFailure(err);
 
-        for (auto & attributeIter : clusterState->mAttributes)
+        for (auto attributeIter = LowerBoundAttribute(ConcreteAttributePath(endpointId, clusterId, 0));
+             attributeIter != mAttributes.end() && attributeIter->mPath.mEndpointId == endpointId &&
+             attributeIter->mPath.mClusterId == clusterId;
+             ++attributeIter)
         {
-            const ConcreteAttributePath path(endpointId, clusterId, attributeIter.first);
+            const ConcreteAttributePath path = attributeIter->mPath;
             ReturnErrorOnFailure(func(path));
         }
 
@@ -360,18 +370,12 @@ public:
     template <typename IteratorFunc>
     CHIP_ERROR ForEachAttribute(ClusterId clusterId, IteratorFunc func) const
     {
-        for (auto & endpointIter : mCache)
+        for (const auto & attribute : mAttributes)
         {
-            for (auto & clusterIter : endpointIter.second)
+            if (attribute.mPath.mClusterId == clusterId)
             {
-                if (clusterIter.first == clusterId)
-                {
-                    for (auto & attributeIter : clusterIter.second.mAttributes)
-                    {
-                        const ConcreteAttributePath path(endpointIter.first, clusterId, attributeIter.first);
-                        ReturnErrorOnFailure(func(path));
-                    }
-                }
+                const ConcreteAttributePath path = attribute.mPath;
+                ReturnErrorOnFailure(func(path));
             }
         }
         return CHIP_NO_ERROR;
@@ -393,13 +397,10 @@ public:
     template <typename IteratorFunc>
     CHIP_ERROR ForEachCluster(EndpointId endpointId, IteratorFunc func) const
     {
-        auto endpointIter = mCache.find(endpointId);
-        if (endpointIter->first == endpointId)
+        for (auto clusterIter = LowerBoundCluster(ConcreteClusterPath(endpointId, 0));
+             clusterIter != mClusters.end() && clusterIter->mPath.mEndpointId == endpointId; ++clusterIter)
         {
-            for (auto & clusterIter : endpointIter->second)
-            {
-                ReturnErrorOnFailure(func(clusterIter.first));
-            }
+            ReturnErrorOnFailure(func(clusterIter->mPath.mClusterId));
         }
         return CHIP_NO_ERROR;
     }
@@ -460,6 +461,7 @@ public:
         {
             ReturnErrorOnFailure(func(item.first, item.second));
         }
+        return CHIP_NO_ERROR;
     }
 
     /*
@@ -475,6 +477,7 @@ public:
     void ClearEventCache(bool resetTrackedEventCounters = false)
     {
         mEventDataCache.clear();
+        mEventArena.Clear();
         if (resetTrackedEventCounters)
         {
             mHighestReceivedEventNumber.ClearValue();
@@ -485,8 +488,85 @@ public:
 
     CHIP_ERROR GetLastReportDataPath(ConcreteClusterPath & aPath);
 
+    /*
+     * Repack the attribute values still in use into a new arena, releasing the memory held by values that have been
+     * replaced since the last compaction. This invalidates any TLVReader or decoded value pointing into the cache.
+     *
+     * The cache compacts itself at the start of a report once the reclaimable space exceeds the space in use, so this
+     * only needs to be called to release memory eagerly, e.g. after a large priming report.
+     */
+    CHIP_ERROR Compact();
+
+    /*
+     * Return the number of bytes of attribute data that Compact() would release.
+     */
+    size_t GetReclaimableSize() const { return mAttributeArena.GetUsedSize() - mAttributeDataSize; }
+
 private:
-    using AttributeState = Variant<Platform::ScopedMemoryBufferWithSize<uint8_t>, StatusIB>;
+    friend class TestClusterStateCacheArena;
+
+    /*
+     * A bump allocator for TLV payloads. Memory is obtained in blocks of at least kBlockSize bytes which are never moved,
+     * so the spans handed out remain valid until Clear() is called, and is only returned to the system by Clear().
+     */
+    class Arena
+    {
+        friend class TestClusterStateCacheArena;
+
+    public:
+        static constexpr size_t kBlockSize = 2048;
+
+        /*
+         * Copy the element aReader is positioned on, with an anonymous tag, into the arena.
+         */
+        CHIP_ERROR CopyElement(const TLV::TLVReader & aReader, ByteSpan & aEncoded);
+
+        CHIP_ERROR Copy(const ByteSpan & aData, ByteSpan & aCopy);
+
+        /*
+         * Make sure the next aSize bytes can be copied without allocating.
+         */
+        CHIP_ERROR Reserve(size_t aSize);
+
+        void Clear()
+        {
+            mBlocks.clear();
+            mUsedSize = 0;
+        }
+
+        // The number of bytes handed out since the last Clear().
+        size_t GetUsedSize() const { return mUsedSize; }
+
+        void Swap(Arena & aOther)
+        {
+            mBlocks.swap(aOther.mBlocks);
+            std::swap(mUsedSize, aOther.mUsedSize);
+        }
+
+    private:
+        struct Block
+        {
+            Platform::ScopedMemoryBufferWithSize<uint8_t> mData;
+            size_t mUsed = 0;
+        };
+
+        MutableByteSpan GetFreeSpace();
+        CHIP_ERROR AddBlock(size_t aMinSize);
+        ByteSpan Commit(size_t aLength);
+
+        std::vector<Block> mBlocks;
+        size_t mUsedSize = 0;
+    };
+
+    // The ByteSpan points to the anonymous-tagged TLV element of the value in mAttributeArena.
+    using AttributeState = Variant<ByteSpan, StatusIB>;
+
+    struct AttributeEntry
+    {
+        ConcreteAttributePath mPath;
+        AttributeState mState;
+    };
+
     // mPendingDataVersion represents a tentative data version for a cluster that we have gotten some reports for.
     //
     // mCurrentDataVersion represents a known data version for a cluster.  In order for this to have a
@@ -494,12 +574,27 @@ private:
     // and we must not be in the middle of receiving reports for that cluster.
     struct ClusterState
     {
-        std::map<AttributeId, AttributeState> mAttributes;
+        ConcreteClusterPath mPath;
         Optional<DataVersion> mPendingDataVersion;
         Optional<DataVersion> mCommittedDataVersion;
     };
-    using EndpointState = std::map<ClusterId, ClusterState>;
-    using NodeState     = std::map<EndpointId, EndpointState>;
+
+    static bool IsClusterPathLess(const ConcreteClusterPath & x, const ConcreteClusterPath & y)
+    {
+        return x.mEndpointId < y.mEndpointId || (x.mEndpointId == y.mEndpointId && x.mClusterId < y.mClusterId);
+    }
+
+    std::vector<ClusterState>::const_iterator LowerBoundCluster(const ConcreteClusterPath & aPath) const
+    {
+        return std::lower_bound(mClusters.begin(), mClusters.end(), aPath,
+                                [](const ClusterState & x, const ConcreteClusterPath & y) { return IsClusterPathLess(x.mPath, y); });
+    }
+
+    std::vector<AttributeEntry>::const_iterator LowerBoundAttribute(const ConcreteAttributePath & aPath) const
+    {
+        return std::lower_bound(mAttributes.begin(), mAttributes.end(), aPath,
+                                [](const AttributeEntry & x, const ConcreteAttributePath & y) { return x.mPath < y; });
+    }
 
     struct Comparator
     {
@@ -509,19 +604,8 @@ private:
         }
     };
 
-    using EventData = std::pair<EventHeader, System::PacketBufferHandle>;
-
-    //
-    // This is a custom comparator for use with the std::set<EventData> below. Uniqueness
-    // is determined solely by the event number associated with each event.
-    //
-    struct EventDataCompare
-    {
-        bool operator()(const EventData & lhs, const EventData & rhs) const
-        {
-            return (lhs.first.mEventNumber < rhs.first.mEventNumber);
-        }
-    };
+    // The ByteSpan points to the anonymous-tagged TLV element of the event payload in mEventArena.
+    using EventData = std::pair<EventHeader, ByteSpan>;
 
     /*
      * These functions provide a way to index into the cached state with different sub-sets of a path, returning
@@ -535,13 +619,17 @@ private:
      *        CHIP_ERROR_KEY_NOT_FOUND shall be returned.
      *
      */
-    const EndpointState * GetEndpointState(EndpointId endpointId, CHIP_ERROR & err) const;
     const ClusterState * GetClusterState(EndpointId endpointId, ClusterId clusterId, CHIP_ERROR & err) const;
     const AttributeState * GetAttributeState(EndpointId endpointId, ClusterId clusterId, AttributeId attributeId,
                                              CHIP_ERROR & err) const;
 
     const EventData * GetEventData(EventNumber number, CHIP_ERROR & err) const;
 
+    /*
+     * Return the state of the given cluster, creating it if needed.
+     */
+    ClusterState & GetOrCreateClusterState(const ConcreteClusterPath & aPath);
+
     /*
      * Updates the state of an attribute in the cache given a reader. If the reader is null, the state is updated
      * with the provided status.
@@ -600,15 +688,21 @@ private:
     // on the wire if not all filters can be applied.
     void GetSortedFilters(std::vector<std::pair<DataVersionFilter, size_t>> & aVector) const;
 
-    CHIP_ERROR GetElementTLVSize(TLV::TLVReader * apData, size_t & aSize);
-
     Callback & mCallback;
-    NodeState mCache;
-    std::set<ConcreteAttributePath> mChangedAttributeSet;
+    // Both sorted by path. Every attribute in mAttributes has its cluster in mClusters.
+    std::vector<ClusterState> mClusters;
+    std::vector<AttributeEntry> mAttributes;
+    Arena mAttributeArena;
+    // The number of bytes of mAttributeArena referenced by mAttributes.
+    size_t mAttributeDataSize = 0;
+    // May contain duplicates until OnReportEnd().
+    std::vector<ConcreteAttributePath> mChangedAttributes;
     std::set<AttributePathParams, Comparator> mRequestPathSet; // wildcard attribute request path only
     std::vector<EndpointId> mAddedEndpoints;
 
-    std::set<EventData, EventDataCompare> mEventDataCache;
+    // Sorted by event number.
+    std::vector<EventData> mEventDataCache;
+    Arena mEventArena;
     Optional<EventNumber> mHighestReceivedEventNumber;
     std::map<ConcreteEventPath, StatusIB> mEventStatusCache;
     BufferedReadCallback mBufferedReader;
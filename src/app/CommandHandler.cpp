@@ -37,6 +37,7 @@
 #include <lib/support/TypeTraits.h>
 #include <platform/LockTracker.h>
 #include <protocols/secure_channel/Constants.h>
+#include <trace/trace.h>
 
 namespace chip {
 namespace app {
@@ -70,6 +71,7 @@ CHIP_ERROR CommandHandler::AllocateBuffer()
 void CommandHandler::OnInvokeCommandRequest(Messaging::ExchangeContext * ec, const PayloadHeader & payloadHeader,
                                             System::PacketBufferHandle && payload, bool isTimedInvoke)
 {
+    MATTER_TRACE_EVENT_SCOPE("OnInvokeCommandRequest", "CommandHandler");
     System::PacketBufferHandle response;
     Status status = Status::Failure;
     VerifyOrDieWithMsg(ec != nullptr, DataManagement, "Incoming exchange context should not be null");
@@ -244,6 +246,7 @@ constexpr uint8_t sNoFields[] = {
 
 Status CommandHandler::ProcessCommandDataIB(CommandDataIB::Parser & aCommandElement)
 {
+    MATTER_TRACE_EVENT_SCOPE("ProcessCommandDataIB", "CommandHandler");
     CHIP_ERROR err = CHIP_NO_ERROR;
     CommandPathIB::Parser commandPath;
     ConcreteCommandPath concretePath(0, 0, 0);
@@ -342,6 +345,7 @@ exit:
 
 Status CommandHandler::ProcessGroupCommandDataIB(CommandDataIB::Parser & aCommandElement)
 {
+    MATTER_TRACE_EVENT_SCOPE("ProcessGroupCommandDataIB", "CommandHandler");
     CHIP_ERROR err = CHIP_NO_ERROR;
     CommandPathIB::Parser commandPath;
     TLV::TLVReader commandDataReader;
@@ -58,6 +58,62 @@ public:
     virtual ~CircularEventReader() = default;
 };
 
+/**
+ * @brief
+ *   A TLVBackingStore reading a range of the events stored in a CircularEventBuffer, which may start at any event
+ *   found through the buffer's EventIndex and may wrap around the end of the buffer storage.
+ */
+class CircularEventBufferSlice : public TLV::TLVBackingStore
+{
+public:
+    CircularEventBufferSlice(const CircularEventBuffer & aBuffer, uint32_t aOffset, uint32_t aLength) :
+        mpBuffer(&aBuffer), mOffset(aOffset), mLength(aLength)
+    {}
+
+    CHIP_ERROR OnInit(TLVReader & aReader, const uint8_t *& aBufStart, uint32_t & aBufLen) override
+    {
+        return GetNextBuffer(aReader, aBufStart, aBufLen);
+    }
+
+    CHIP_ERROR GetNextBuffer(TLVReader & aReader, const uint8_t *& aBufStart, uint32_t & aBufLen) override
+    {
+        const uint8_t * queueEnd  = mpBuffer->GetQueue() + mpBuffer->GetTotalDataLength();
+        const uint32_t firstChunk = std::min(mLength, mpBuffer->GetTotalDataLength() - mOffset);
+
+        if (aBufStart == nullptr)
+        {
+            aBufStart = mpBuffer->GetQueue() + mOffset;
+            aBufLen   = firstChunk;
+        }
+        else if (aBufStart == queueEnd)
+        {
+            // The range wraps around the end of the storage.
+            aBufStart = mpBuffer->GetQueue();
+            aBufLen   = mLength - firstChunk;
+        }
+        else
+        {
+            aBufLen = 0;
+        }
+        return CHIP_NO_ERROR;
+    }
+
+    CHIP_ERROR OnInit(TLVWriter & aWriter, uint8_t *& aBufStart, uint32_t & aBufLen) override { return CHIP_ERROR_NOT_IMPLEMENTED; }
+    CHIP_ERROR GetNewBuffer(TLVWriter & aWriter, uint8_t *& aBufStart, uint32_t & aBufLen) override
+    {
+        return CHIP_ERROR_NOT_IMPLEMENTED;
+    }
+    CHIP_ERROR FinalizeBuffer(TLVWriter & aWriter, uint8_t * aBufStart, uint32_t aBufLen) override
+    {
+        return CHIP_ERROR_NOT_IMPLEMENTED;
+    }
+
+private:
+    const CircularEventBuffer * mpBuffer;
+    uint32_t mOffset;
+    uint32_t mLength;
+};
+
 EventManagement & EventManagement::GetInstance(void)
 {
     return sInstance;
@@ -135,6 +191,8 @@ CHIP_ERROR EventManagement::CopyToNextBuffer(CircularEventBuffer * apEventBuffer
         return CHIP_ERROR_INVALID_ARGUMENT;
     }
     CircularEventBuffer backup = *nextBuffer;
+    const EventIndex & index   = apEventBuffer->GetIndex();
+    EventIndex::Entry entry;
 
     // Set up the next buffer s.t. it fails if needs to evict an element
     nextBuffer->mProcessEvictedElement = AlwaysFail;
@@ -147,12 +205,26 @@ CHIP_ERROR EventManagement::CopyToNextBuffer(CircularEventBuffer * apEventBuffer
     err = reader.Next();
     SuccessOrExit(err);
 
+    // The head event is usually indexed already, unless the index of this buffer overflowed.
+    if (!index.IsEmpty() && index.Front().mOffset == apEventBuffer->GetHeadOffset())
+    {
+        entry = index.Front();
+    }
+    else
+    {
+        err = GetEventIndexEntry(reader, entry);
+        SuccessOrExit(err);
+    }
+    entry.mOffset = nextBuffer->GetTailOffset();
+
     err = writer.CopyElement(reader);
     SuccessOrExit(err);
 
     err = writer.Finalize();
     SuccessOrExit(err);
 
+    nextBuffer->GetIndex().Append(entry);
+
     ChipLogDetail(EventLogging, "Copy Event to next buffer with priority %u", static_cast<unsigned>(nextBuffer->GetPriority()));
 exit:
     if (err != CHIP_NO_ERROR)
@@ -185,6 +257,7 @@ CHIP_ERROR EventManagement::EnsureSpaceInCircularBuffer(size_t aRequiredSpace)
             eventBuffer->mProcessEvictedElement = EvictEvent;
             eventBuffer->mAppData               = &ctx;
             err                                 = eventBuffer->EvictHead();
+            eventBuffer->TrimIndex();
 
             // one of two things happened: either the element was evicted immediately if the head's priority is same as current
             // buffer(final one), or we figured out how much space we need to evict it into the next buffer, the check happens in
@@ -207,6 +280,7 @@ CHIP_ERROR EventManagement::EnsureSpaceInCircularBuffer(size_t aRequiredSpace)
                     // success; evict head unconditionally
                     eventBuffer->mProcessEvictedElement = nullptr;
                     err                                 = eventBuffer->EvictHead();
+                    eventBuffer->TrimIndex();
                     // if unconditional eviction failed, this
                     // means that we have no way of further
                     // clearing the buffer.  fail out and let the
@@ -411,6 +485,7 @@ CHIP_ERROR EventManagement::LogEventPrivate(EventLoggingDelegate * apDelegate, c
     CircularEventBuffer * buffer = nullptr;
     EventLoadOutContext ctxt     = EventLoadOutContext(writer, aEventOptions.mPriority, mLastEventNumber);
     EventOptions opts;
+    EventIndex::Entry indexEntry;
 #if CHIP_CONFIG_EVENT_LOGGING_UTC_TIMESTAMPS & CHIP_SYSTEM_CONFIG_PLATFORM_PROVIDES_TIME
     Timestamp timestamp;
     System::Clock::Timestamp utc_time;
@@ -443,6 +518,13 @@ CHIP_ERROR EventManagement::LogEventPrivate(EventLoggingDelegate * apDelegate, c
     err = EnsureSpaceInCircularBuffer(requestSize);
     SuccessOrExit(err);
 
+    // The writer may have evicted an event when it was initialized on a full buffer.
+    mpEventBuffer->TrimIndex();
+    indexEntry.mOffset     = mpEventBuffer->GetTailOffset();
+    indexEntry.mEndpointId = opts.mPath.mEndpointId;
+    indexEntry.mClusterId  = opts.mPath.mClusterId;
+    indexEntry.mEventId    = opts.mPath.mEventId;
+
     err = ConstructEvent(&ctxt, apDelegate, &opts);
     SuccessOrExit(err);
 
@@ -474,6 +556,8 @@ exit:
     {
         aEventNumber = mLastEventNumber;
         VendEventNumber();
+        indexEntry.mEventNumber = aEventNumber;
+        mpEventBuffer->GetIndex().Append(indexEntry);
         mLastEventTimestamp = timestamp;
 #if CHIP_CONFIG_EVENT_LOGGING_VERBOSE_DEBUG_LOGS
         ChipLogDetail(EventLogging,
@@ -633,29 +717,103 @@ CHIP_ERROR EventManagement::CopyEventsSince(const TLVReader & aReader, size_t aD
     return err;
 }
 
+CHIP_ERROR EventManagement::CopyEventsInRange(const CircularEventBuffer & aBuffer, uint32_t aOffset, uint32_t aLength,
+                                              EventLoadOutContext & aContext)
+{
+    CircularEventBufferSlice slice(aBuffer, aOffset, aLength);
+    TLVReader reader;
+
+    ReturnErrorOnFailure(reader.Init(slice, aLength));
+    CHIP_ERROR err = TLV::Utilities::Iterate(reader, CopyEventsSince, &aContext, false /*recurse*/);
+    if (err == CHIP_END_OF_TLV)
+    {
+        err = CHIP_NO_ERROR;
+    }
+    return err;
+}
+
+static bool IsInterestedEvent(const EventLoadOutContext & aContext, const EventIndex::Entry & aEntry)
+{
+    ConcreteEventPath path(aEntry.mEndpointId, aEntry.mClusterId, aEntry.mEventId);
+    for (auto * interestedPath = aContext.mpInterestedEventPaths; interestedPath != nullptr; interestedPath = interestedPath->mpNext)
+    {
+        if (interestedPath->mValue.IsEventPathSupersetOf(path))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+CHIP_ERROR EventManagement::FetchEventsFromBuffer(const CircularEventBuffer & aBuffer, EventLoadOutContext & aContext)
+{
+    const EventIndex & index  = aBuffer.GetIndex();
+    const uint32_t bufferSize = aBuffer.GetTotalDataLength();
+    const uint32_t headOffset = aBuffer.GetHeadOffset();
+
+    VerifyOrReturnError(aBuffer.DataLength() > 0, CHIP_NO_ERROR);
+
+    if (index.IsEmpty())
+    {
+        return CopyEventsInRange(aBuffer, headOffset, aBuffer.DataLength(), aContext);
+    }
+
+    // The events older than the indexed ones need to be read, unless even the oldest indexed event is not newer than the
+    // starting event.
+    const uint32_t unindexedLength = (index.Front().mOffset + bufferSize - headOffset) % bufferSize;
+    if (unindexedLength > 0 && index.Front().mEventNumber > aContext.mStartingEventNumber)
+    {
+        ReturnErrorOnFailure(CopyEventsInRange(aBuffer, headOffset, unindexedLength, aContext));
+    }
+
+    // Copy the runs of consecutive events on the interested paths, and skip the others without reading them.
+    size_t i = index.LowerBound(aContext.mStartingEventNumber);
+    while (i < index.Count())
+    {
+        if (!IsInterestedEvent(aContext, index[i]))
+        {
+            aContext.mCurrentEventNumber = index[i].mEventNumber;
+            i++;
+            continue;
+        }
+
+        size_t end = i + 1;
+        while (end < index.Count() && IsInterestedEvent(aContext, index[end]))
+        {
+            end++;
+        }
+
+        const uint32_t endOffset = (end < index.Count()) ? index[end].mOffset : aBuffer.GetTailOffset();
+        uint32_t length          = (endOffset + bufferSize - index[i].mOffset) % bufferSize;
+        if (length == 0)
+        {
+            // A single event filling the whole buffer.
+            length = bufferSize;
+        }
+        ReturnErrorOnFailure(CopyEventsInRange(aBuffer, index[i].mOffset, length, aContext));
+        i = end;
+    }
+
+    return CHIP_NO_ERROR;
+}
+
 CHIP_ERROR EventManagement::FetchEventsSince(TLVWriter & aWriter, const ObjectList<EventPathParams> * apEventPathList,
                                              EventNumber & aEventMin, size_t & aEventCount,
                                              const Access::SubjectDescriptor & aSubjectDescriptor)
 {
-    // TODO: Add particular set of event Paths in FetchEventsSince so that we can filter the interested paths
-    CHIP_ERROR err     = CHIP_NO_ERROR;
-    const bool recurse = false;
-    TLVReader reader;
-    CircularEventBufferWrapper bufWrapper;
+    CHIP_ERROR err = CHIP_NO_ERROR;
     EventLoadOutContext context(aWriter, PriorityLevel::Invalid, aEventMin);
 
     context.mSubjectDescriptor     = aSubjectDescriptor;
     context.mpInterestedEventPaths = apEventPathList;
-    err                            = GetEventReader(reader, PriorityLevel::Critical, &bufWrapper);
-    SuccessOrExit(err);
 
-    err = TLV::Utilities::Iterate(reader, CopyEventsSince, &context, recurse);
-    if (err == CHIP_END_OF_TLV)
+    // Events are stored from the oldest ones, in the buffer of the highest priority, to the newest ones, in the first buffer.
+    for (CircularEventBuffer * buffer = GetPriorityBuffer(PriorityLevel::Critical); buffer != nullptr && err == CHIP_NO_ERROR;
+         buffer                       = buffer->GetPreviousCircularEventBuffer())
     {
-        err = CHIP_NO_ERROR;
+        err = FetchEventsFromBuffer(*buffer, context);
     }
 
-exit:
     if (err == CHIP_ERROR_BUFFER_TOO_SMALL || err == CHIP_ERROR_NO_MEMORY)
     {
         // We failed to fetch the current event because the buffer is too small, we will start from this one the next time.
@@ -796,6 +954,33 @@ CHIP_ERROR EventManagement::FetchEventParameters(const TLVReader & aReader, size
     return CHIP_NO_ERROR;
 }
 
+CHIP_ERROR EventManagement::GetEventIndexEntry(const TLVReader & aReader, EventIndex::Entry & aEntry)
+{
+    TLVReader reader;
+    TLVType containerType;
+    TLVType containerType1;
+    EventEnvelopeContext envelope;
+
+    reader.Init(aReader);
+    ReturnErrorOnFailure(reader.EnterContainer(containerType));
+    ReturnErrorOnFailure(reader.Next());
+    ReturnErrorOnFailure(reader.EnterContainer(containerType1));
+
+    CHIP_ERROR err = TLV::Utilities::Iterate(reader, FetchEventParameters, &envelope, false /*recurse*/);
+    if (err == CHIP_END_OF_TLV)
+    {
+        err = CHIP_NO_ERROR;
+    }
+    ReturnErrorOnFailure(err);
+    VerifyOrReturnError(envelope.mFieldsToRead == kRequiredEventField, CHIP_ERROR_INVALID_ARGUMENT);
+
+    aEntry.mEventNumber = envelope.mEventNumber;
+    aEntry.mEndpointId  = envelope.mEndpointId;
+    aEntry.mClusterId   = envelope.mClusterId;
+    aEntry.mEventId     = envelope.mEventId;
+    return CHIP_NO_ERROR;
+}
+
 CHIP_ERROR EventManagement::EvictEvent(CHIPCircularTLVBuffer & apBuffer, void * apAppData, TLVReader & aReader)
 {
     // pull out the delta time, pull out the priority
@@ -844,6 +1029,42 @@ void EventManagement::SetScheduledEventInfo(EventNumber & aEventNumber, uint32_t
     aInitialWrittenEventBytes = mBytesWritten;
 }
 
+void EventIndex::Append(const Entry & aEntry)
+{
+    if (mCount == kCapacity)
+    {
+        PopFront();
+    }
+    mEntries[(mFirst + mCount) % kCapacity] = aEntry;
+    mCount++;
+}
+
+void EventIndex::PopFront()
+{
+    VerifyOrReturn(mCount > 0);
+    mFirst = (mFirst + 1) % kCapacity;
+    mCount--;
+}
+
+size_t EventIndex::LowerBound(EventNumber aEventNumber) const
+{
+    size_t low  = 0;
+    size_t high = mCount;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if ((*this)[middle].mEventNumber < aEventNumber)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
 void CircularEventBuffer::Init(uint8_t * apBuffer, uint32_t aBufferLength, CircularEventBuffer * apPrev,
                                CircularEventBuffer * apNext, PriorityLevel aPriorityLevel)
 {
@@ -851,6 +1072,19 @@ void CircularEventBuffer::Init(uint8_t * apBuffer, uint32_t aBufferLength, Circu
     mpPrev    = apPrev;
     mpNext    = apNext;
     mPriority = aPriorityLevel;
+    mIndex.Clear();
+}
+
+void CircularEventBuffer::TrimIndex()
+{
+    // Events are evicted from the head, so the entries of evicted events are the oldest ones, and their offsets are now
+    // outside of the stored data.
+    while (!mIndex.IsEmpty())
+    {
+        const uint32_t distance = (mIndex.Front().mOffset + GetTotalDataLength() - GetHeadOffset()) % GetTotalDataLength();
+        VerifyOrReturn(distance >= DataLength());
+        mIndex.PopFront();
+    }
 }
 
 bool CircularEventBuffer::IsFinalDestinationForPriority(PriorityLevel aPriority) const
@@ -34,6 +34,7 @@
 #include <app/ObjectList.h>
 #include <app/util/basic-types.h>
 #include <lib/core/CHIPCircularTLVBuffer.h>
+#include <lib/core/CHIPEventLoggingConfig.h>
 #include <lib/support/CHIPCounter.h>
 #include <messaging/ExchangeMgr.h>
 
@@ -47,6 +48,63 @@ constexpr size_t kMaxEventSizeReserve            = 512;
 constexpr uint16_t kRequiredEventField =
     (1 << to_underlying(EventDataIB::Tag::kPriority)) | (1 << to_underlying(EventDataIB::Tag::kPath));
 
+/**
+ * @brief
+ *   An index of the most recent events stored in a CircularEventBuffer, oldest first.
+ *
+ * Each entry records where an event starts in the buffer storage, along with its number and path, so that
+ * fetching events can seek to the first event a reader has not seen yet and skip events outside of the
+ * interested paths without decoding them. The index covers a suffix of the events in the buffer: when it is
+ * full, the entries of the oldest events are dropped and these events are read sequentially instead.
+ */
+class EventIndex
+{
+public:
+    struct Entry
+    {
+        EventNumber mEventNumber = 0;
+        ClusterId mClusterId     = 0;
+        EventId mEventId         = 0;
+        uint32_t mOffset         = 0; ///< Offset of the event from the start of the buffer storage
+        EndpointId mEndpointId   = 0;
+    };
+
+    static constexpr size_t kCapacity = CHIP_CONFIG_EVENT_LOGGING_INDEX_SIZE;
+    static_assert(kCapacity > 0, "CHIP_CONFIG_EVENT_LOGGING_INDEX_SIZE must be greater than 0");
+
+    void Clear()
+    {
+        mFirst = 0;
+        mCount = 0;
+    }
+
+    bool IsEmpty() const { return mCount == 0; }
+    size_t Count() const { return mCount; }
+
+    /**
+     * Access the entries in storage order, 0 being the oldest one.
+     */
+    const Entry & operator[](size_t aIndex) const { return mEntries[(mFirst + aIndex) % kCapacity]; }
+    const Entry & Front() const { return (*this)[0]; }
+    const Entry & Back() const { return (*this)[mCount - 1]; }
+
+    /**
+     * Append the entry of the newest event, dropping the entry of the oldest one if the index is full.
+     */
+    void Append(const Entry & aEntry);
+    void PopFront();
+
+    /**
+     * Return the position of the first entry whose event number is at least aEventNumber, or Count() if there is none.
+     */
+    size_t LowerBound(EventNumber aEventNumber) const;
+
+private:
+    Entry mEntries[kCapacity];
+    size_t mFirst = 0;
+    size_t mCount = 0;
+};
+
 /**
  * @brief
  *   Internal event buffer, built around the TLV::CHIPCircularTLVBuffer
@@ -99,6 +157,23 @@ public:
     void SetRequiredSpaceforEvicted(size_t aRequiredSpace) { mRequiredSpaceForEvicted = aRequiredSpace; }
     size_t GetRequiredSpaceforEvicted() const { return mRequiredSpaceForEvicted; }
 
+    EventIndex & GetIndex() { return mIndex; }
+    const EventIndex & GetIndex() const { return mIndex; }
+
+    /**
+     * @brief
+     *   Drop the index entries of the events which are no longer stored in the buffer. This must be called after
+     *   evicting events, before anything else is written to the buffer.
+     */
+    void TrimIndex();
+
+    /**
+     * @brief
+     *   The offsets of the oldest event and of the end of the newest event from the start of the buffer storage.
+     */
+    uint32_t GetHeadOffset() const { return static_cast<uint32_t>(QueueHead() - GetQueue()); }
+    uint32_t GetTailOffset() const { return static_cast<uint32_t>(QueueTail() - GetQueue()); }
+
     ~CircularEventBuffer() override = default;
 
 private:
@@ -109,6 +184,8 @@ private:
                                                       ///< lesser priority are dropped when they get bumped out of this buffer
 
     size_t mRequiredSpaceForEvicted = 0; ///< Required space for previous buffer to evict event to new buffer
+
+    EventIndex mIndex; ///< Positions of the most recent events stored in this buffer
 };
 
 class CircularEventReader;
@@ -455,6 +532,11 @@ private:
      */
     static CHIP_ERROR FetchEventParameters(const TLV::TLVReader & aReader, size_t aDepth, void * apContext);
 
+    /**
+     * @brief Decode the number and path of the event aReader is positioned on into an index entry.
+     */
+    static CHIP_ERROR GetEventIndexEntry(const TLV::TLVReader & aReader, EventIndex::Entry & aEntry);
+
     /**
      * @brief Internal iterator function used to scan and filter though event logs
      * First event gets a timestamp, subsequent ones get a delta T
@@ -485,6 +567,20 @@ private:
      */
     static CHIP_ERROR CheckEventContext(EventLoadOutContext * eventLoadOutContext, const EventEnvelopeContext & event);
 
+    /**
+     * @brief Fetch the events of a single buffer into the context, seeking to the events found through the buffer's index.
+     *
+     * Events older than the indexed ones are read sequentially, unless the index shows they are all older than the
+     * starting event number. Indexed events are only decoded when their path is one of the interested paths.
+     */
+    static CHIP_ERROR FetchEventsFromBuffer(const CircularEventBuffer & aBuffer, EventLoadOutContext & aContext);
+
+    /**
+     * @brief Read the events stored in aLength bytes from aOffset in aBuffer, and copy those matching the context.
+     */
+    static CHIP_ERROR CopyEventsInRange(const CircularEventBuffer & aBuffer, uint32_t aOffset, uint32_t aLength,
+                                        EventLoadOutContext & aContext);
+
     /**
      * @brief copy event from circular buffer to target buffer for report
      */
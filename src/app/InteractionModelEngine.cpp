@@ -32,6 +32,7 @@
 #include <app/RequiredPrivilege.h>
 #include <lib/core/CHIPTLVUtilities.hpp>
 #include <lib/support/CodeUtils.h>
+#include <lib/support/Metrics.h>
 
 extern bool emberAfContainsAttribute(chip::EndpointId endpoint, chip::ClusterId clusterId, chip::AttributeId attributeId);
 
@@ -40,9 +41,20 @@ namespace app {
 
 using Protocols::InteractionModel::Status;
 
+namespace {
+
+CHIP_METRIC_POOL(gReadHandlerPoolMetrics, "read_handlers");
+CHIP_METRIC_POOL(gCommandHandlerPoolMetrics, "command_handlers");
+
+} // namespace
+
 InteractionModelEngine sInteractionModelEngine;
 
-InteractionModelEngine::InteractionModelEngine() {}
+InteractionModelEngine::InteractionModelEngine()
+{
+    CHIP_METRIC_POOL_ATTACH(mReadHandlers, gReadHandlerPoolMetrics);
+    CHIP_METRIC_POOL_ATTACH(mCommandHandlerObjs, gCommandHandlerPoolMetrics);
+}
 
 InteractionModelEngine * InteractionModelEngine::GetInstance()
 {
@@ -62,7 +74,7 @@ CHIP_ERROR InteractionModelEngine::Init(Messaging::ExchangeManager * apExchangeM
     ReturnErrorOnFailure(mpFabricTable->AddFabricDelegate(this));
     ReturnErrorOnFailure(mpExchangeMgr->RegisterUnsolicitedMessageHandlerForProtocol(Protocols::InteractionModel::Id, this));
 
-    mReportingEngine.Init();
+    ReturnErrorOnFailure(mReportingEngine.Init());
     mMagic++;
 
     StatusIB::RegisterErrorFormatter();
@@ -66,11 +66,7 @@ ReadHandler::~ReadHandler()
 
     if (IsType(InteractionType::Subscribe))
     {
-        InteractionModelEngine::GetInstance()->GetExchangeManager()->GetSessionManager()->SystemLayer()->CancelTimer(
-            OnUnblockHoldReportCallback, this);
-
-        InteractionModelEngine::GetInstance()->GetExchangeManager()->GetSessionManager()->SystemLayer()->CancelTimer(
-            OnRefreshSubscribeTimerSyncCallback, this);
+        InteractionModelEngine::GetInstance()->GetReportingEngine().GetReportScheduler().CancelReport(*this);
     }
 
     if (IsAwaitingReportResponse())
@@ -637,37 +633,27 @@ CHIP_ERROR ReadHandler::ProcessSubscribeRequest(System::PacketBufferHandle && aP
     return CHIP_NO_ERROR;
 }
 
-void ReadHandler::OnUnblockHoldReportCallback(System::Layer * apSystemLayer, void * apAppState)
+void ReadHandler::OnMinIntervalElapsed()
 {
-    VerifyOrReturn(apAppState != nullptr);
-    ReadHandler * readHandler = static_cast<ReadHandler *>(apAppState);
-    ChipLogDetail(DataManagement, "Unblock report hold after min %d seconds", readHandler->mMinIntervalFloorSeconds);
-    readHandler->mFlags.Set(ReadHandlerFlags::HoldReport, false);
-    if (readHandler->IsDirty())
+    ChipLogDetail(DataManagement, "Unblock report hold after min %d seconds", mMinIntervalFloorSeconds);
+    mFlags.Set(ReadHandlerFlags::HoldReport, false);
+    if (IsDirty())
     {
         InteractionModelEngine::GetInstance()->GetReportingEngine().ScheduleRun();
     }
-    InteractionModelEngine::GetInstance()->GetExchangeManager()->GetSessionManager()->SystemLayer()->StartTimer(
-        System::Clock::Seconds16(readHandler->mMaxInterval - readHandler->mMinIntervalFloorSeconds),
-        OnRefreshSubscribeTimerSyncCallback, readHandler);
 }
 
-void ReadHandler::OnRefreshSubscribeTimerSyncCallback(System::Layer * apSystemLayer, void * apAppState)
+void ReadHandler::OnMaxIntervalElapsed()
 {
-    VerifyOrReturn(apAppState != nullptr);
-    ReadHandler * readHandler = static_cast<ReadHandler *>(apAppState);
-    readHandler->mFlags.Set(ReadHandlerFlags::HoldSync, false);
-    ChipLogProgress(DataManagement, "Refresh subscribe timer sync after %d seconds",
-                    readHandler->mMaxInterval - readHandler->mMinIntervalFloorSeconds);
+    mFlags.Set(ReadHandlerFlags::HoldSync, false);
+    ChipLogProgress(DataManagement, "Refresh subscribe timer sync after %d seconds", mMaxInterval - mMinIntervalFloorSeconds);
     InteractionModelEngine::GetInstance()->GetReportingEngine().ScheduleRun();
 }
 
 CHIP_ERROR ReadHandler::RefreshSubscribeSyncTimer()
 {
-    InteractionModelEngine::GetInstance()->GetExchangeManager()->GetSessionManager()->SystemLayer()->CancelTimer(
-        OnUnblockHoldReportCallback, this);
-    InteractionModelEngine::GetInstance()->GetExchangeManager()->GetSessionManager()->SystemLayer()->CancelTimer(
-        OnRefreshSubscribeTimerSyncCallback, this);
+    reporting::ReportScheduler & scheduler = InteractionModelEngine::GetInstance()->GetReportingEngine().GetReportScheduler();
+    scheduler.CancelReport(*this);
 
     if (!IsChunkedReport())
     {
@@ -675,9 +661,8 @@ CHIP_ERROR ReadHandler::RefreshSubscribeSyncTimer()
                         mMinIntervalFloorSeconds, mMaxInterval);
         mFlags.Set(ReadHandlerFlags::HoldReport);
         mFlags.Set(ReadHandlerFlags::HoldSync);
-        ReturnErrorOnFailure(
-            InteractionModelEngine::GetInstance()->GetExchangeManager()->GetSessionManager()->SystemLayer()->StartTimer(
-                System::Clock::Seconds16(mMinIntervalFloorSeconds), OnUnblockHoldReportCallback, this));
+        ReturnErrorOnFailure(scheduler.ScheduleReport(*this, System::Clock::Seconds16(mMinIntervalFloorSeconds),
+                                                      System::Clock::Seconds16(mMaxInterval)));
     }
 
     return CHIP_NO_ERROR;
@@ -36,6 +36,7 @@
 #include <app/MessageDef/EventFilterIBs.h>
 #include <app/MessageDef/EventPathIBs.h>
 #include <app/ObjectList.h>
+#include <app/reporting/ReportScheduler.h>
 #include <lib/core/CHIPCore.h>
 #include <lib/core/CHIPTLVDebug.hpp>
 #include <lib/support/CodeUtils.h>
@@ -191,6 +192,29 @@ public:
         return CHIP_NO_ERROR;
     }
 
+    /**
+     * Called by the report scheduler once the min interval floor of the subscription has elapsed: dirty data may be reported
+     * from now on.
+     */
+    void OnMinIntervalElapsed();
+
+    /**
+     * Called by the report scheduler once the max interval ceiling of the subscription has elapsed (or is about to): a report
+     * must be sent, even an empty one, to keep the subscription alive.
+     */
+    void OnMaxIntervalElapsed();
+
+    reporting::ReportScheduler::Node & GetReportSchedulerNode() { return mReportSchedulerNode; }
+
+    /**
+     * When the next report of this handler is due: right away for reads and priming reports, and by the end of the max interval
+     * for subscriptions.
+     */
+    System::Clock::Timestamp GetReportDeadline() const
+    {
+        return (IsType(InteractionType::Subscribe) && !IsPriming()) ? mReportSchedulerNode.mMaxTimestamp : System::Clock::kZero;
+    }
+
 private:
     PriorityLevel GetCurrentPriority() const { return mCurrentPriority; }
     EventNumber & GetEventMin() { return mEventMin; }
@@ -356,8 +380,6 @@ private:
      */
     void Close();
 
-    static void OnUnblockHoldReportCallback(System::Layer * apSystemLayer, void * apAppState);
-    static void OnRefreshSubscribeTimerSyncCallback(System::Layer * apSystemLayer, void * apAppState);
     CHIP_ERROR RefreshSubscribeSyncTimer();
     CHIP_ERROR SendSubscribeResponse();
     CHIP_ERROR ProcessSubscribeRequest(System::PacketBufferHandle && aPayload);
@@ -438,6 +460,9 @@ private:
 
     uint32_t mLastWrittenEventsBytes = 0;
 
+    // The min/max interval deadlines of this subscription, owned by the report scheduler.
+    reporting::ReportScheduler::Node mReportSchedulerNode;
+
     // The detailed encoding state for a single attribute, used by list chunking feature.
     // The size of AttributeEncoderState is 2 bytes for now.
     AttributeValueEncoder::AttributeEncodeState mAttributeEncoderState;
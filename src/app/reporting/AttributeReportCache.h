@@ -0,0 +1,168 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file defines a cache of encoded AttributeReportIBs shared by all the ReadHandlers serviced
+ *      during a single run of the reporting engine.
+ *
+ */
+
+#pragma once
+
+#include <app/ConcreteAttributePath.h>
+#include <lib/core/CHIPConfig.h>
+#include <lib/core/CHIPError.h>
+#include <lib/core/DataModelTypes.h>
+#include <lib/support/CodeUtils.h>
+#include <lib/support/Span.h>
+
+namespace chip {
+namespace app {
+namespace reporting {
+
+/*
+ *  @class AttributeReportCache
+ *
+ *  @brief When several ReadHandlers are interested in the same attribute, the reporting engine would otherwise read the
+ * attribute from the data model and encode it once per handler.  This cache keeps the encoded AttributeReportIBs produced for
+ * the first handler so that the following ones can copy the encoded bytes instead.
+ *
+ *         Encodings are keyed by the concrete path, the accessing fabric and whether the read is fabric filtered, since
+ * these are the only properties of the reader that the encoded data depends on once the reader has passed the access control
+ * check.  The whole cache is tied to a dirty set generation of the reporting engine: any attribute change (which also bumps
+ * the cluster DataVersion embedded in the cached AttributeDataIBs) invalidates all entries.
+ *
+ *         Storage is a fixed-size arena filled front-to-back; once it is full, new encodings are simply not cached until the
+ * cache is cleared.
+ */
+template <size_t kArenaSize, size_t kMaxEntries>
+class AttributeReportCache
+{
+public:
+    struct Key
+    {
+        Key(const ConcreteAttributePath & aPath, FabricIndex aAccessingFabricIndex, bool aIsFabricFiltered) :
+            mPath(aPath), mAccessingFabricIndex(aAccessingFabricIndex), mIsFabricFiltered(aIsFabricFiltered)
+        {}
+
+        bool operator==(const Key & aOther) const
+        {
+            return mPath == aOther.mPath && mAccessingFabricIndex == aOther.mAccessingFabricIndex &&
+                mIsFabricFiltered == aOther.mIsFabricFiltered;
+        }
+
+        ConcreteAttributePath mPath;
+        FabricIndex mAccessingFabricIndex = kUndefinedFabricIndex;
+        bool mIsFabricFiltered            = false;
+    };
+
+    /**
+     * Drop all the cached encodings.
+     */
+    void Clear()
+    {
+        mEntryCount = 0;
+        mArenaUsed  = 0;
+    }
+
+    /**
+     * Drop all the cached encodings if they were produced for another dirty set generation than aGeneration.
+     */
+    void Refresh(uint64_t aGeneration)
+    {
+        if (aGeneration != mGeneration)
+        {
+            Clear();
+            mGeneration = aGeneration;
+        }
+    }
+
+    /**
+     * Find the encoding cached for aKey.
+     *
+     * @retval true if an encoding was found, in which case aEncoded points to it.
+     */
+    bool Find(const Key & aKey, ByteSpan & aEncoded) const
+    {
+        for (size_t i = 0; i < mEntryCount; i++)
+        {
+            if (mEntries[i].mKey == aKey)
+            {
+                aEncoded = ByteSpan(&mArena[mEntries[i].mOffset], mEntries[i].mLength);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Get the unused part of the arena, which callers can encode into before calling Commit.  The returned span is empty if
+     * no more entries can be added.
+     */
+    MutableByteSpan GetFreeSpace()
+    {
+        if (mEntryCount >= kMaxEntries)
+        {
+            return MutableByteSpan();
+        }
+        return MutableByteSpan(&mArena[mArenaUsed], kArenaSize - mArenaUsed);
+    }
+
+    /**
+     * Record the first aLength bytes of the span last returned by GetFreeSpace as the encoding for aKey.
+     *
+     * @retval #CHIP_NO_ERROR On success, aEncoded then points to the cached encoding.
+     * @retval #CHIP_ERROR_NO_MEMORY If the cache is full.
+     */
+    CHIP_ERROR Commit(const Key & aKey, size_t aLength, ByteSpan & aEncoded)
+    {
+        VerifyOrReturnError(mEntryCount < kMaxEntries && aLength <= kArenaSize - mArenaUsed, CHIP_ERROR_NO_MEMORY);
+
+        Entry & entry = mEntries[mEntryCount++];
+        entry.mKey    = aKey;
+        entry.mOffset = mArenaUsed;
+        entry.mLength = aLength;
+        mArenaUsed += aLength;
+
+        aEncoded = ByteSpan(&mArena[entry.mOffset], entry.mLength);
+        return CHIP_NO_ERROR;
+    }
+
+    size_t GetEntryCount() const { return mEntryCount; }
+
+private:
+    struct Entry
+    {
+        Entry() : mKey(ConcreteAttributePath(), kUndefinedFabricIndex, false) {}
+
+        Key mKey;
+        size_t mOffset = 0;
+        size_t mLength = 0;
+    };
+
+    uint64_t mGeneration = 0;
+    size_t mEntryCount   = 0;
+    size_t mArenaUsed    = 0;
+    Entry mEntries[kMaxEntries];
+    uint8_t mArena[kArenaSize];
+};
+
+} // namespace reporting
+} // namespace app
+} // namespace chip
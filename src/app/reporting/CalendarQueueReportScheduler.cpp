@@ -0,0 +1,258 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <app/ReadHandler.h>
+#include <app/reporting/CalendarQueueReportScheduler.h>
+#include <lib/support/CodeUtils.h>
+
+#include <algorithm>
+
+namespace chip {
+namespace app {
+namespace reporting {
+
+using Node = ReportScheduler::Node;
+using System::Clock::Timestamp;
+
+constexpr Timestamp CalendarQueue::kBucketWidth;
+constexpr Timestamp CalendarQueueReportScheduler::kCoalescingWindow;
+
+void CalendarQueue::Insert(Node & aNode)
+{
+    Node ** link = &mBuckets[BucketIndex(aNode.mDeadline)];
+    while (*link != nullptr && (*link)->mDeadline <= aNode.mDeadline)
+    {
+        link = &(*link)->mpNext;
+    }
+    aNode.mpNext = *link;
+    *link        = &aNode;
+    mCount++;
+
+    if (mCount == 1 || aNode.mDeadline < mCursor)
+    {
+        mCursor = aNode.mDeadline;
+    }
+}
+
+void CalendarQueue::Remove(Node & aNode)
+{
+    Node ** link = &mBuckets[BucketIndex(aNode.mDeadline)];
+    while (*link != nullptr && *link != &aNode)
+    {
+        link = &(*link)->mpNext;
+    }
+    VerifyOrReturn(*link == &aNode);
+
+    *link        = aNode.mpNext;
+    aNode.mpNext = nullptr;
+    mCount--;
+}
+
+Node * CalendarQueue::Earliest()
+{
+    VerifyOrReturnValue(mCount > 0, nullptr);
+
+    // Walk one turn of the ring starting at the bucket of the cursor, looking for a bucket whose first node falls within the
+    // time slot the bucket covers during this turn.
+    size_t index        = BucketIndex(mCursor);
+    Timestamp bucketEnd = Timestamp((mCursor.count() / kBucketWidth.count() + 1) * kBucketWidth.count());
+    for (size_t i = 0; i < kNumBuckets; i++)
+    {
+        Node * head = mBuckets[index];
+        if (head != nullptr && head->mDeadline < bucketEnd)
+        {
+            mCursor = head->mDeadline;
+            return head;
+        }
+        index = (index + 1) % kNumBuckets;
+        bucketEnd += kBucketWidth;
+    }
+
+    // All the deadlines are more than one turn of the ring away, just look at the first node of every bucket.
+    Node * earliest = nullptr;
+    for (Node * head : mBuckets)
+    {
+        if (head != nullptr && (earliest == nullptr || head->mDeadline < earliest->mDeadline))
+        {
+            earliest = head;
+        }
+    }
+    mCursor = earliest->mDeadline;
+    return earliest;
+}
+
+void CalendarQueue::Clear()
+{
+    for (Node *& head : mBuckets)
+    {
+        while (head != nullptr)
+        {
+            Node * next  = head->mpNext;
+            head->mpNext = nullptr;
+            head->mState = Node::State::Idle;
+            head         = next;
+        }
+    }
+    mCount = 0;
+}
+
+CHIP_ERROR CalendarQueueReportScheduler::Init(System::Layer * aSystemLayer)
+{
+    VerifyOrReturnError(aSystemLayer != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+    mpSystemLayer = aSystemLayer;
+    return CHIP_NO_ERROR;
+}
+
+void CalendarQueueReportScheduler::Shutdown()
+{
+    if (mpSystemLayer != nullptr)
+    {
+        mpSystemLayer->CancelTimer(OnTimerExpired, this);
+    }
+    mMinIntervalQueue.Clear();
+    mMaxIntervalQueue.Clear();
+    mpSystemLayer = nullptr;
+}
+
+CHIP_ERROR CalendarQueueReportScheduler::ScheduleReport(ReadHandler & aReadHandler, System::Clock::Timeout aMinInterval,
+                                                        System::Clock::Timeout aMaxInterval)
+{
+    VerifyOrReturnError(mpSystemLayer != nullptr, CHIP_ERROR_INCORRECT_STATE);
+    VerifyOrReturnError(aMinInterval <= aMaxInterval, CHIP_ERROR_INVALID_ARGUMENT);
+
+    CancelReport(aReadHandler);
+
+    Node & node                 = aReadHandler.GetReportSchedulerNode();
+    Timestamp now               = System::SystemClock().GetMonotonicTimestamp();
+    Timestamp window            = std::min(kCoalescingWindow, Timestamp((aMaxInterval - aMinInterval).count() / 4));
+    node.mpReadHandler          = &aReadHandler;
+    node.mState                 = Node::State::WaitingForMinInterval;
+    node.mDeadline              = now + aMinInterval;
+    node.mMaxTimestamp          = now + aMaxInterval;
+    node.mEarliestSyncTimestamp = node.mMaxTimestamp - window;
+    mMinIntervalQueue.Insert(node);
+
+    if (!mServicing)
+    {
+        ArmTimer(now);
+    }
+    return CHIP_NO_ERROR;
+}
+
+void CalendarQueueReportScheduler::CancelReport(ReadHandler & aReadHandler)
+{
+    Node & node = aReadHandler.GetReportSchedulerNode();
+    switch (node.mState)
+    {
+    case Node::State::WaitingForMinInterval:
+        mMinIntervalQueue.Remove(node);
+        break;
+    case Node::State::WaitingForMaxInterval:
+        mMaxIntervalQueue.Remove(node);
+        break;
+    case Node::State::Idle:
+        return;
+    }
+    node.mState = Node::State::Idle;
+
+    // The timer is left armed: if it was armed for this node, it will expire without anything to do and get re-armed then.
+}
+
+void CalendarQueueReportScheduler::OnTimerExpired(System::Layer * aSystemLayer, void * aAppState)
+{
+    auto * scheduler = static_cast<CalendarQueueReportScheduler *>(aAppState);
+    scheduler->ServiceDeadlines(System::SystemClock().GetMonotonicTimestamp());
+}
+
+void CalendarQueueReportScheduler::ServiceDeadlines(Timestamp aNow)
+{
+    Node * node     = nullptr;
+    Node * deferred = nullptr;
+
+    mServicing = true;
+
+    // The ReadHandler callbacks only schedule a run of the reporting engine, so none of the queued nodes can go away while we
+    // iterate.
+    while ((node = mMinIntervalQueue.Earliest()) != nullptr && node->mDeadline <= aNow)
+    {
+        mMinIntervalQueue.Remove(*node);
+        node->mState    = Node::State::WaitingForMaxInterval;
+        node->mDeadline = node->mMaxTimestamp;
+        mMaxIntervalQueue.Insert(*node);
+        node->mpReadHandler->OnMinIntervalElapsed();
+    }
+
+    while ((node = mMaxIntervalQueue.Earliest()) != nullptr && node->mDeadline <= aNow + kCoalescingWindow)
+    {
+        mMaxIntervalQueue.Remove(*node);
+        if (node->mEarliestSyncTimestamp > aNow)
+        {
+            // Signaling this one now would shorten its reporting cycle too much, put it back after this loop.
+            node->mpNext = deferred;
+            deferred     = node;
+            continue;
+        }
+        node->mState = Node::State::Idle;
+        node->mpReadHandler->OnMaxIntervalElapsed();
+    }
+
+    while (deferred != nullptr)
+    {
+        node     = deferred;
+        deferred = deferred->mpNext;
+        mMaxIntervalQueue.Insert(*node);
+    }
+
+    mServicing = false;
+    ArmTimer(aNow);
+}
+
+void CalendarQueueReportScheduler::ArmTimer(Timestamp aNow)
+{
+    Node * nextMin = mMinIntervalQueue.Earliest();
+    Node * nextMax = mMaxIntervalQueue.Earliest();
+
+    mpSystemLayer->CancelTimer(OnTimerExpired, this);
+    VerifyOrReturn(nextMin != nullptr || nextMax != nullptr);
+
+    Timestamp deadline;
+    if (nextMin != nullptr && nextMax != nullptr)
+    {
+        deadline = std::min(nextMin->mDeadline, nextMax->mDeadline);
+    }
+    else
+    {
+        deadline = (nextMin != nullptr) ? nextMin->mDeadline : nextMax->mDeadline;
+    }
+
+    System::Clock::Timeout delay = System::Clock::kZero;
+    if (deadline > aNow)
+    {
+        delay = std::chrono::duration_cast<System::Clock::Timeout>(deadline - aNow);
+    }
+
+    CHIP_ERROR err = mpSystemLayer->StartTimer(delay, OnTimerExpired, this);
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(DataManagement, "Failed to arm the report scheduler timer: %" CHIP_ERROR_FORMAT, err.Format());
+    }
+}
+
+} // namespace reporting
+} // namespace app
+} // namespace chip
@@ -0,0 +1,120 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file defines the default report scheduler, which keeps subscription deadlines in calendar queues
+ *      serviced by a single timer.
+ *
+ */
+
+#pragma once
+
+#include <app/reporting/ReportScheduler.h>
+#include <lib/core/CHIPConfig.h>
+
+namespace chip {
+namespace app {
+namespace reporting {
+
+/*
+ *  @class CalendarQueue
+ *
+ *  @brief A priority queue of ReportScheduler::Node sorted on their deadline. Nodes are hashed into a ring of buckets, each
+ * covering a fixed time width, and kept sorted within their bucket. Finding the earliest node walks the ring from the last
+ * earliest deadline, which is O(1) on average when deadlines are spread over the ring.
+ */
+class CalendarQueue
+{
+public:
+    static constexpr size_t kNumBuckets                   = CHIP_IM_REPORT_SCHEDULER_NUM_BUCKETS;
+    static constexpr System::Clock::Timestamp kBucketWidth = System::Clock::Milliseconds64(CHIP_IM_REPORT_SCHEDULER_BUCKET_WIDTH_MS);
+
+    void Insert(ReportScheduler::Node & aNode);
+    void Remove(ReportScheduler::Node & aNode);
+
+    /**
+     * Return the node with the earliest deadline, or nullptr if the queue is empty.
+     */
+    ReportScheduler::Node * Earliest();
+
+    bool IsEmpty() const { return mCount == 0; }
+    size_t Count() const { return mCount; }
+
+    void Clear();
+
+private:
+    static size_t BucketIndex(System::Clock::Timestamp aTimestamp)
+    {
+        return static_cast<size_t>((aTimestamp.count() / kBucketWidth.count()) % kNumBuckets);
+    }
+
+    ReportScheduler::Node * mBuckets[kNumBuckets] = {};
+    size_t mCount                                 = 0;
+    // No node in the queue has a deadline earlier than mCursor.
+    System::Clock::Timestamp mCursor = System::Clock::kZero;
+};
+
+/*
+ *  @class CalendarQueueReportScheduler
+ *
+ *  @brief The default report scheduler. All the subscriptions share a single timer, armed for the earliest deadline.
+ *
+ *         Subscriptions waiting for their min interval floor and subscriptions waiting for their max interval ceiling are kept in
+ * two calendar queues. Min interval floors are always signaled at or after their deadline. Since the max interval is only a
+ * ceiling, subscriptions whose max interval would elapse shortly after a wakeup are signaled during that wakeup instead of arming
+ * the timer again, so that their keep-alive reports are batched with the reports generated at that time.
+ */
+class CalendarQueueReportScheduler : public ReportScheduler
+{
+public:
+    /**
+     * How far ahead of its max interval ceiling a subscription may be signaled to share a wakeup. This is further bounded for
+     * each subscription to a quarter of the time between its min and max intervals.
+     */
+    static constexpr System::Clock::Timestamp kCoalescingWindow =
+        System::Clock::Milliseconds64(CHIP_IM_REPORT_SCHEDULER_COALESCING_WINDOW_MS);
+
+    CHIP_ERROR Init(System::Layer * aSystemLayer) override;
+    void Shutdown() override;
+    CHIP_ERROR ScheduleReport(ReadHandler & aReadHandler, System::Clock::Timeout aMinInterval,
+                              System::Clock::Timeout aMaxInterval) override;
+    void CancelReport(ReadHandler & aReadHandler) override;
+
+private:
+    friend class TestReportingEngine;
+
+    static void OnTimerExpired(System::Layer * aSystemLayer, void * aAppState);
+
+    /**
+     * Signal all the nodes which are due at aNow, then re-arm the timer for the next deadline.
+     */
+    void ServiceDeadlines(System::Clock::Timestamp aNow);
+    void ArmTimer(System::Clock::Timestamp aNow);
+
+    System::Layer * mpSystemLayer = nullptr;
+    CalendarQueue mMinIntervalQueue;
+    CalendarQueue mMaxIntervalQueue;
+    // Set while the nodes are being signaled, so that ScheduleReport/CancelReport calls made from ReadHandler callbacks do not
+    // re-arm the timer in the middle of the loop.
+    bool mServicing = false;
+};
+
+} // namespace reporting
+} // namespace app
+} // namespace chip
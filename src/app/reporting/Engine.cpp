@@ -28,17 +28,35 @@
 #include <app/RequiredPrivilege.h>
 #include <app/reporting/Engine.h>
 #include <app/util/MatterCallbacks.h>
+#include <lib/support/Metrics.h>
+#include <trace/trace.h>
 
 using namespace chip::Access;
 
 namespace chip {
 namespace app {
 namespace reporting {
+
+namespace {
+
+CHIP_METRIC_COUNTER(gReportsSent, "chip_im_reports_sent_total", "Report data messages sent");
+CHIP_METRIC_GAUGE(gReportsInFlight, "chip_im_reports_in_flight", "Report data messages waiting for a status response");
+CHIP_METRIC_GAUGE(gDirtySetSize, "chip_im_dirty_set_size", "Attribute paths in the global dirty set");
+CHIP_METRIC_HISTOGRAM(gReportBuildTime, "chip_im_report_build_time_us", "Time to build and send a report data message", 100, 250,
+                      500, 1000, 2500, 5000, 10000, 50000);
+CHIP_METRIC_HISTOGRAM(gDirtyToCleanTime, "chip_im_dirty_to_clean_time_ms",
+                      "Time from an attribute change until all read handlers reported it", 1, 10, 50, 100, 500, 1000, 5000,
+                      30000);
+
+} // namespace
+
 CHIP_ERROR Engine::Init()
 {
     mNumReportsInFlight = 0;
     mCurReadHandlerIdx  = 0;
-    return CHIP_NO_ERROR;
+    CHIP_METRIC_GAUGE_SET(gReportsInFlight, 0);
+    return mpReportScheduler->Init(
+        InteractionModelEngine::GetInstance()->GetExchangeManager()->GetSessionManager()->SystemLayer());
 }
 
 void Engine::Shutdown()
@@ -49,6 +67,9 @@ void Engine::Shutdown()
     mNumReportsInFlight = 0;
     mCurReadHandlerIdx  = 0;
     mGlobalDirtySet.ReleaseAll();
+    CHIP_METRIC_GAUGE_SET(gReportsInFlight, 0);
+    CHIP_METRIC_GAUGE_SET(gDirtySetSize, 0);
+    mpReportScheduler->Shutdown();
 }
 
 bool Engine::IsClusterDataVersionMatch(const ObjectList<DataVersionFilter> * aDataVersionFilterList,
@@ -84,6 +105,56 @@ Engine::RetrieveClusterData(const SubjectDescriptor & aSubjectDescriptor, bool a
     return CHIP_NO_ERROR;
 }
 
+#if CHIP_IM_SERVER_REPORT_CACHE_SIZE > 0
+CHIP_ERROR Engine::CopyClusterDataFromCache(ReadHandler * apReadHandler, AttributeReportIBs::Builder & aAttributeReportIBs,
+                                            const ConcreteReadAttributePath & aPath)
+{
+    // Once access is granted, the encoded data only depends on the accessing fabric and on fabric filtering. Readers which are
+    // denied access get a status (or nothing) depending on their own request, so they always go through RetrieveClusterData.
+    Access::RequestPath requestPath{ .cluster = aPath.mClusterId, .endpoint = aPath.mEndpointId };
+    ReturnErrorOnFailure(Access::GetAccessControl().Check(apReadHandler->GetSubjectDescriptor(), requestPath,
+                                                          RequiredPrivilege::ForReadAttribute(aPath)));
+
+    mReportCache.Refresh(GetDirtySetGeneration());
+
+    decltype(mReportCache)::Key key(aPath, apReadHandler->GetAccessingFabricIndex(), apReadHandler->IsFabricFiltered());
+    ByteSpan encoded;
+    VerifyOrReturnError(mReportCache.Find(key, encoded), CHIP_ERROR_KEY_NOT_FOUND);
+
+    ChipLogDetail(DataManagement, "<RE:Run> Reusing encoded data for Cluster %" PRIx32 ", Attribute %" PRIx32, aPath.mClusterId,
+                  aPath.mAttributeId);
+
+    // The encoding is the sequence of AttributeReportIBs the attribute was reported as.
+    TLV::TLVReader reader;
+    reader.Init(encoded);
+
+    CHIP_ERROR err = CHIP_NO_ERROR;
+    while ((err = reader.Next()) == CHIP_NO_ERROR)
+    {
+        ReturnErrorOnFailure(aAttributeReportIBs.GetWriter()->CopyElement(TLV::AnonymousTag(), reader));
+    }
+    return err == CHIP_END_OF_TLV ? CHIP_NO_ERROR : err;
+}
+
+void Engine::CacheClusterData(ReadHandler * apReadHandler, const ConcreteReadAttributePath & aPath, const TLV::TLVWriter & aBegin,
+                              const TLV::TLVWriter & aEnd)
+{
+    VerifyOrReturn(mpReportBufferStart != nullptr);
+
+    // Reports are written contiguously into a single buffer, so the attribute is the data written between the two states.
+    const size_t length       = aEnd.GetLengthWritten() - aBegin.GetLengthWritten();
+    MutableByteSpan freeSpace = mReportCache.GetFreeSpace();
+
+    // Attributes which do not fit in the cache are not shared.
+    VerifyOrReturn(length > 0 && length <= freeSpace.size());
+    memcpy(freeSpace.data(), mpReportBufferStart + aBegin.GetLengthWritten(), length);
+
+    decltype(mReportCache)::Key key(aPath, apReadHandler->GetAccessingFabricIndex(), apReadHandler->IsFabricFiltered());
+    ByteSpan encoded;
+    LogErrorOnFailure(mReportCache.Commit(key, length, encoded));
+}
+#endif
+
 CHIP_ERROR Engine::BuildSingleReportDataAttributeReportIBs(ReportDataMessage::Builder & aReportDataBuilder,
                                                            ReadHandler * apReadHandler, bool * apHasMoreChunks,
                                                            bool * apHasEncodedData)
@@ -177,8 +248,30 @@ CHIP_ERROR Engine::BuildSingleReportDataAttributeReportIBs(ReportDataMessage::Bu
             ConcreteReadAttributePath pathForRetrieval(readPath);
             // Load the saved state from previous encoding session for chunking of one single attribute (list chunking).
             AttributeValueEncoder::AttributeEncodeState encodeState = apReadHandler->GetAttributeEncodeState();
+#if CHIP_IM_SERVER_REPORT_CACHE_SIZE > 0
+            bool shareEncoding = false;
+            // Only attributes we are not in the middle of chunking for this ReadHandler can be shared with other ReadHandlers.
+            if (!encodeState.AllowPartialData())
+            {
+                err = CopyClusterDataFromCache(apReadHandler, attributeReportIBs, pathForRetrieval);
+                if (err == CHIP_NO_ERROR)
+                {
+                    continue;
+                }
+                attributeReportIBs.Rollback(attributeBackup);
+                // The attribute is encoded straight into the report below, and shared from there, so that it is never encoded
+                // twice.
+                shareEncoding = (err == CHIP_ERROR_KEY_NOT_FOUND);
+            }
+#endif
             err = RetrieveClusterData(apReadHandler->GetSubjectDescriptor(), apReadHandler->IsFabricFiltered(), attributeReportIBs,
                                       pathForRetrieval, &encodeState);
+#if CHIP_IM_SERVER_REPORT_CACHE_SIZE > 0
+            if (err == CHIP_NO_ERROR && shareEncoding)
+            {
+                CacheClusterData(apReadHandler, pathForRetrieval, attributeBackup, *attributeReportIBs.GetWriter());
+            }
+#endif
             if (err != CHIP_NO_ERROR)
             {
                 ChipLogError(DataManagement,
@@ -445,6 +538,7 @@ exit:
 
 CHIP_ERROR Engine::BuildAndSendSingleReportData(ReadHandler * apReadHandler)
 {
+    MATTER_TRACE_EVENT_SCOPE("BuildAndSendSingleReportData", "Reporting");
     CHIP_ERROR err = CHIP_NO_ERROR;
     chip::System::PacketBufferTLVWriter reportDataWriter;
     ReportDataMessage::Builder reportDataBuilder;
@@ -452,6 +546,9 @@ CHIP_ERROR Engine::BuildAndSendSingleReportData(ReadHandler * apReadHandler)
     uint16_t reservedSize                      = 0;
     bool hasMoreChunks                         = false;
     bool needCloseReadHandler                  = false;
+#if CHIP_CONFIG_ENABLE_METRICS
+    System::Clock::Microseconds64 buildStart = System::SystemClock().GetMonotonicMicroseconds64();
+#endif
 
     // Reserved size for the MoreChunks boolean flag, which takes up 1 byte for the control tag and 1 byte for the context tag.
     const uint32_t kReservedSizeForMoreChunksFlag = 1 + 1;
@@ -475,6 +572,9 @@ CHIP_ERROR Engine::BuildAndSendSingleReportData(ReadHandler * apReadHandler)
         reservedSize = static_cast<uint16_t>(bufHandle->AvailableDataLength() - kMaxSecureSduLengthBytes);
     }
 
+#if CHIP_IM_SERVER_REPORT_CACHE_SIZE > 0
+    mpReportBufferStart = bufHandle->Start() + bufHandle->DataLength();
+#endif
     reportDataWriter.Init(std::move(bufHandle));
 
 #if CONFIG_BUILD_FOR_HOST_UNIT_TEST
@@ -559,8 +659,12 @@ CHIP_ERROR Engine::BuildAndSendSingleReportData(ReadHandler * apReadHandler)
 
     ChipLogDetail(DataManagement, "<RE> ReportsInFlight = %" PRIu32 " with readHandler %" PRIu32 ", RE has %s", mNumReportsInFlight,
                   mCurReadHandlerIdx, hasMoreChunks ? "more messages" : "no more messages");
+    CHIP_METRIC_RECORD(gReportBuildTime, (System::SystemClock().GetMonotonicMicroseconds64() - buildStart).count());
 
 exit:
+#if CHIP_IM_SERVER_REPORT_CACHE_SIZE > 0
+    mpReportBufferStart = nullptr;
+#endif
     if (err != CHIP_NO_ERROR || (apReadHandler->IsType(ReadHandler::InteractionType::Read) && !hasMoreChunks) ||
         needCloseReadHandler)
     {
@@ -615,29 +719,35 @@ void Engine::Run()
 
     InteractionModelEngine * imEngine = InteractionModelEngine::GetInstance();
 
+#if CHIP_IM_SERVER_REPORT_CACHE_SIZE > 0
+    // Attributes which changed without being marked dirty since the last run must not be served from the cache.
+    mReportCache.Clear();
+#endif
+
     // We may be deallocating read handlers as we go.  Track how many we had
-    // initially, so we make sure to go through all of them.
+    // initially, so we never service more than that in one run.
     size_t initialAllocated = imEngine->mReadHandlers.Allocated();
     while ((mNumReportsInFlight < CHIP_IM_MAX_REPORTS_IN_FLIGHT) && (numReadHandled < initialAllocated))
     {
-        ReadHandler * readHandler = imEngine->ActiveHandlerAt(mCurReadHandlerIdx % (uint32_t) imEngine->mReadHandlers.Allocated());
-        VerifyOrDie(readHandler != nullptr);
+        // When reports in flight are limited, the handlers closest to their max interval deadline get to report first.
+        ReadHandler * readHandler = NextReadHandlerToReport();
+        if (readHandler == nullptr)
+        {
+            break;
+        }
 
-        if (readHandler->IsReportable())
+        mRunningReadHandler = readHandler;
+        CHIP_ERROR err      = BuildAndSendSingleReportData(readHandler);
+        mRunningReadHandler = nullptr;
+        if (err != CHIP_NO_ERROR)
         {
-            mRunningReadHandler = readHandler;
-            CHIP_ERROR err      = BuildAndSendSingleReportData(readHandler);
-            mRunningReadHandler = nullptr;
-            if (err != CHIP_NO_ERROR)
-            {
-                return;
-            }
+            return;
         }
 
         numReadHandled++;
-        // If readHandler removed itself from our list, we also decremented
-        // mCurReadHandlerIdx to account for that removal, so it's safe to
-        // increment here.
+        // Move the round-robin cursor past the handler just served, so that it goes last among the handlers with the same
+        // deadline. If the handler was destroyed while reporting, ResetReadHandlerTracker moved the cursor back by one, and
+        // the increment leaves it on the handler which followed.
         mCurReadHandlerIdx++;
     }
 
@@ -667,8 +777,51 @@ void Engine::Run()
     {
         ChipLogDetail(DataManagement, "All ReadHandler-s are clean, clear GlobalDirtySet");
 
+#if CHIP_CONFIG_ENABLE_METRICS
+        if (mGlobalDirtySet.Allocated() > 0)
+        {
+            CHIP_METRIC_RECORD(gDirtyToCleanTime, (System::SystemClock().GetMonotonicTimestamp() - mDirtySince).count());
+        }
+#endif
         mGlobalDirtySet.ReleaseAll();
+        CHIP_METRIC_GAUGE_SET(gDirtySetSize, 0);
+    }
+}
+
+ReadHandler * Engine::NextReadHandlerToReport()
+{
+    InteractionModelEngine * imEngine = InteractionModelEngine::GetInstance();
+    const uint32_t count              = static_cast<uint32_t>(imEngine->mReadHandlers.Allocated());
+    VerifyOrReturnValue(count > 0, nullptr);
+
+    const uint32_t start = mCurReadHandlerIdx % count;
+    ReadHandler * next   = nullptr;
+    uint32_t nextIndex   = 0;
+    uint32_t index       = 0;
+    System::Clock::Timestamp nextDeadline;
+
+    imEngine->mReadHandlers.ForEachActiveObject([&](ReadHandler * handler) {
+        if (handler->IsReportable())
+        {
+            System::Clock::Timestamp deadline = handler->GetReportDeadline();
+            // Distance from the round-robin cursor, to break ties.
+            bool isBefore = (index + count - start) % count < (nextIndex + count - start) % count;
+            if (next == nullptr || deadline < nextDeadline || (deadline == nextDeadline && isBefore))
+            {
+                next         = handler;
+                nextIndex    = index;
+                nextDeadline = deadline;
+            }
+        }
+        index++;
+        return Loop::Continue;
+    });
+
+    if (next != nullptr)
+    {
+        mCurReadHandlerIdx = nextIndex;
     }
+    return next;
 }
 
 bool Engine::MergeOverlappedAttributePath(const AttributePathParams & aAttributePath)
@@ -836,7 +989,14 @@ CHIP_ERROR Engine::SetDirty(AttributePathParams & aAttributePath)
     {
         return CHIP_NO_ERROR;
     }
+#if CHIP_CONFIG_ENABLE_METRICS
+    if (mGlobalDirtySet.Allocated() == 0)
+    {
+        mDirtySince = System::SystemClock().GetMonotonicTimestamp();
+    }
+#endif
     ReturnErrorOnFailure(InsertPathIntoDirtySet(aAttributePath));
+    CHIP_METRIC_GAUGE_SET(gDirtySetSize, mGlobalDirtySet.Allocated());
 
     // Schedule work to run asynchronously on the CHIP thread. The scheduled
     // work won't execute until the current execution context has
@@ -855,6 +1015,8 @@ CHIP_ERROR Engine::SendReport(ReadHandler * apReadHandler, System::PacketBufferH
 
     // We can only have 1 report in flight for any given read - increment and break out.
     mNumReportsInFlight++;
+    CHIP_METRIC_INCREMENT(gReportsSent);
+    CHIP_METRIC_GAUGE_SET(gReportsInFlight, mNumReportsInFlight);
     err = apReadHandler->SendReportData(std::move(aPayload), aHasMoreChunks);
     return err;
 }
@@ -870,6 +1032,7 @@ void Engine::OnReportConfirm()
         ScheduleRun();
     }
     mNumReportsInFlight--;
+    CHIP_METRIC_GAUGE_SET(gReportsInFlight, mNumReportsInFlight);
     ChipLogDetail(DataManagement, "<RE> OnReportConfirm: NumReports = %" PRIu32, mNumReportsInFlight);
 }
 
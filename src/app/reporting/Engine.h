@@ -27,6 +27,9 @@
 #include <access/AccessControl.h>
 #include <app/MessageDef/ReportDataMessage.h>
 #include <app/ReadHandler.h>
+#include <app/reporting/AttributeReportCache.h>
+#include <app/reporting/CalendarQueueReportScheduler.h>
+#include <app/reporting/ReportScheduler.h>
 #include <app/util/basic-types.h>
 #include <lib/core/CHIPCore.h>
 #include <lib/support/CodeUtils.h>
@@ -63,6 +66,17 @@ public:
 
     void Shutdown();
 
+    /**
+     * Replace the scheduler used to track the min/max intervals of subscriptions. This SHALL be called before Init, and
+     * apScheduler has to outlive the engine. Passing nullptr restores the default CalendarQueueReportScheduler.
+     */
+    void SetReportScheduler(ReportScheduler * apScheduler)
+    {
+        mpReportScheduler = (apScheduler != nullptr) ? apScheduler : &mDefaultReportScheduler;
+    }
+
+    ReportScheduler & GetReportScheduler() { return *mpReportScheduler; }
+
 #if CONFIG_BUILD_FOR_HOST_UNIT_TEST
     void SetWriterReserved(uint32_t aReservedSize) { mReservedSize = aReservedSize; }
 
@@ -129,6 +143,9 @@ public:
 
 #if CONFIG_BUILD_FOR_HOST_UNIT_TEST
     size_t GetGlobalDirtySetSize() { return mGlobalDirtySet.Allocated(); }
+#if CHIP_IM_SERVER_REPORT_CACHE_SIZE > 0
+    size_t GetReportCacheEntryCount() const { return mReportCache.GetEntryCount(); }
+#endif
 #endif
 
 private:
@@ -146,6 +163,14 @@ private:
         uint64_t mGeneration = 0;
     };
 
+    /**
+     * Pick the reportable ReadHandler whose report is due first, see ReadHandler::GetReportDeadline. Handlers due at the same time
+     * are picked round-robin, starting at mCurReadHandlerIdx, which is moved to the picked handler.
+     *
+     * @return nullptr if no ReadHandler is reportable.
+     */
+    ReadHandler * NextReadHandlerToReport();
+
     /**
      * Build Single Report Data including attribute changes and event data stream, and send out
      *
@@ -160,6 +185,26 @@ private:
                                    AttributeReportIBs::Builder & aAttributeReportIBs,
                                    const ConcreteReadAttributePath & aClusterInfo,
                                    AttributeValueEncoder::AttributeEncodeState * apEncoderState);
+#if CHIP_IM_SERVER_REPORT_CACHE_SIZE > 0
+    /**
+     * Copy into aAttributeReportIBs the whole attribute at aPath, as encoded for another ReadHandler from the same fabric
+     * during this run.
+     *
+     * @retval #CHIP_ERROR_KEY_NOT_FOUND if the attribute was not encoded yet, in which case the caller should encode it with
+     *         RetrieveClusterData and share the result with CacheClusterData.
+     * @retval other errors if the shared encoding cannot be used by apReadHandler, in which case the caller should roll back
+     *         aAttributeReportIBs and fall back to RetrieveClusterData.
+     */
+    CHIP_ERROR CopyClusterDataFromCache(ReadHandler * apReadHandler, AttributeReportIBs::Builder & aAttributeReportIBs,
+                                        const ConcreteReadAttributePath & aPath);
+
+    /**
+     * Share with the next ReadHandlers the whole attribute at aPath that RetrieveClusterData encoded for apReadHandler into
+     * the report being built, between the aBegin and aEnd states of its writer.
+     */
+    void CacheClusterData(ReadHandler * apReadHandler, const ConcreteReadAttributePath & aPath, const TLV::TLVWriter & aBegin,
+                          const TLV::TLVWriter & aEnd);
+#endif
     CHIP_ERROR CheckAccessDeniedEventPaths(TLV::TLVWriter & aWriter, bool & aHasEncodedData, ReadHandler * apReadHandler);
 
     // If version match, it means don't send, if version mismatch, it means send.
@@ -269,6 +314,29 @@ private:
      */
     uint64_t mDirtyGeneration = 1;
 
+#if CHIP_CONFIG_ENABLE_METRICS
+    /**
+     * When the global dirty set went from empty to non-empty, to measure how long it takes
+     * until every read handler reported the change.
+     */
+    System::Clock::Timestamp mDirtySince = System::Clock::kZero;
+#endif
+
+#if CHIP_IM_SERVER_REPORT_CACHE_SIZE > 0
+    /**
+     * Encoded attribute data shared by the ReadHandlers serviced during one run, see AttributeReportCache.
+     */
+    AttributeReportCache<CHIP_IM_SERVER_REPORT_CACHE_SIZE, CHIP_IM_SERVER_REPORT_CACHE_MAX_ENTRIES> mReportCache;
+
+    /**
+     * Start of the buffer of the report being built, which CacheClusterData copies encoded attributes from.
+     */
+    const uint8_t * mpReportBufferStart = nullptr;
+#endif
+
+    CalendarQueueReportScheduler mDefaultReportScheduler;
+    ReportScheduler * mpReportScheduler = &mDefaultReportScheduler;
+
 #if CONFIG_BUILD_FOR_HOST_UNIT_TEST
     uint32_t mReservedSize          = 0;
     uint32_t mMaxAttributesPerChunk = UINT32_MAX;
@@ -0,0 +1,95 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file defines the interface used by the reporting engine to schedule the min/max interval
+ *      deadlines of subscriptions.
+ *
+ */
+
+#pragma once
+
+#include <lib/core/CHIPError.h>
+#include <system/SystemClock.h>
+#include <system/SystemLayer.h>
+
+namespace chip {
+namespace app {
+
+class ReadHandler;
+
+namespace reporting {
+
+/*
+ *  @class ReportScheduler
+ *
+ *  @brief A report scheduler tracks, for every subscription, when its min interval floor elapses (after which the subscription
+ * may report dirty data) and when its max interval ceiling elapses (at which point a report must be sent, even an empty one, to
+ * keep the subscription alive).
+ *
+ *         Once a subscription has been scheduled through ScheduleReport, the scheduler SHALL call
+ * ReadHandler::OnMinIntervalElapsed no earlier than the min interval, and then ReadHandler::OnMaxIntervalElapsed no later than the
+ * max interval. Implementations are free to group these calls across subscriptions to reduce the number of wakeups.
+ */
+class ReportScheduler
+{
+public:
+    /**
+     * Per-subscription scheduling state. It is embedded in each ReadHandler so that schedulers never need to allocate.
+     */
+    struct Node
+    {
+        enum class State : uint8_t
+        {
+            Idle,                  ///< Not scheduled.
+            WaitingForMinInterval, ///< Waiting for the min interval floor to elapse.
+            WaitingForMaxInterval, ///< The min interval floor has elapsed, waiting for the max interval ceiling.
+        };
+
+        ReadHandler * mpReadHandler = nullptr;
+        Node * mpNext               = nullptr;
+        // The timestamp this node is currently sorted on by the scheduler.
+        System::Clock::Timestamp mDeadline = System::Clock::kZero;
+        // The timestamp before which the max interval may not be signaled early to share a wakeup with another subscription.
+        System::Clock::Timestamp mEarliestSyncTimestamp = System::Clock::kZero;
+        System::Clock::Timestamp mMaxTimestamp          = System::Clock::kZero;
+        State mState                                    = State::Idle;
+    };
+
+    virtual ~ReportScheduler() = default;
+
+    virtual CHIP_ERROR Init(System::Layer * aSystemLayer) = 0;
+    virtual void Shutdown()                               = 0;
+
+    /**
+     * Start the min/max intervals of aReadHandler, counted from now. Any previously scheduled intervals of aReadHandler are
+     * discarded.
+     */
+    virtual CHIP_ERROR ScheduleReport(ReadHandler & aReadHandler, System::Clock::Timeout aMinInterval,
+                                      System::Clock::Timeout aMaxInterval) = 0;
+
+    /**
+     * Stop tracking the intervals of aReadHandler. This is a no-op if aReadHandler is not scheduled.
+     */
+    virtual void CancelReport(ReadHandler & aReadHandler) = 0;
+};
+
+} // namespace reporting
+} // namespace app
+} // namespace chip
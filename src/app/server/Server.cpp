@@ -65,6 +65,9 @@ using chip::Inet::IPAddressType;
 using chip::Transport::BleListenParameters;
 #endif
 using chip::Transport::PeerAddress;
+#if INET_CONFIG_ENABLE_TCP_ENDPOINT && CHIP_CONFIG_ENABLE_TCP_TRANSPORT
+using chip::Transport::TcpListenParameters;
+#endif
 using chip::Transport::UdpListenParameters;
 
 namespace {
@@ -188,6 +191,12 @@ CHIP_ERROR Server::Init(const ServerInitParams & initParams)
 #if CONFIG_NETWORK_LAYER_BLE
                                ,
                            BleListenParameters(DeviceLayer::ConnectivityMgr().GetBleLayer())
+#endif
+#if INET_CONFIG_ENABLE_TCP_ENDPOINT && CHIP_CONFIG_ENABLE_TCP_TRANSPORT
+                               ,
+                           TcpListenParameters(DeviceLayer::TCPEndPointManager())
+                               .SetAddressType(IPAddressType::kIPv6)
+                               .SetListenPort(mOperationalServicePort)
 #endif
     );
 
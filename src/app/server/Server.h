@@ -60,6 +60,9 @@
 #if CONFIG_NETWORK_LAYER_BLE
 #include <transport/raw/BLE.h>
 #endif
+#if INET_CONFIG_ENABLE_TCP_ENDPOINT && CHIP_CONFIG_ENABLE_TCP_TRANSPORT
+#include <transport/raw/TCP.h>
+#endif
 #include <transport/raw/UDP.h>
 
 namespace chip {
@@ -78,6 +81,11 @@ using ServerTransportMgr = chip::TransportMgr<chip::Transport::UDP
 #if CONFIG_NETWORK_LAYER_BLE
                                               ,
                                               chip::Transport::BLE<kMaxBlePendingPackets>
+#endif
+#if INET_CONFIG_ENABLE_TCP_ENDPOINT && CHIP_CONFIG_ENABLE_TCP_TRANSPORT
+                                              ,
+                                              chip::Transport::TCP<CHIP_CONFIG_MAX_ACTIVE_TCP_CONNECTIONS,
+                                                                   CHIP_CONFIG_MAX_TCP_PENDING_PACKETS>
 #endif
                                               >;
 
@@ -0,0 +1,216 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <app/CASESessionScheduler.h>
+#include <app/tests/AppTestContext.h>
+#include <lib/support/TestPersistentStorageDelegate.h>
+#include <lib/support/UnitTestContext.h>
+#include <lib/support/UnitTestRegistration.h>
+#include <nlunit-test.h>
+#include <protocols/secure_channel/SimpleSessionResumptionStorage.h>
+
+using namespace chip;
+
+namespace {
+
+using TestContext = chip::Test::AppContext;
+
+constexpr FabricIndex kFabric = 1;
+
+/// Records the session establishments started by the scheduler, which the
+/// tests complete by calling the recorded callbacks.
+class FakeSessionManager : public CASESessionManager
+{
+public:
+    static constexpr size_t kMaxAttempts = 8;
+
+    void FindOrEstablishSession(const ScopedNodeId & peerId, Callback::Callback<OnDeviceConnected> * onConnection,
+                                Callback::Callback<OnDeviceConnectionFailure> * onFailure) override
+    {
+        VerifyOrDie(mAttemptCount < kMaxAttempts);
+        mPeers[mAttemptCount]     = peerId;
+        mOnFailure[mAttemptCount] = onFailure;
+        mAttemptCount++;
+    }
+
+    void Fail(size_t attempt, CHIP_ERROR error)
+    {
+        VerifyOrDie(attempt < mAttemptCount);
+        mOnFailure[attempt]->mCall(mOnFailure[attempt]->mContext, mPeers[attempt], error);
+    }
+
+    size_t mAttemptCount = 0;
+    ScopedNodeId mPeers[kMaxAttempts];
+    Callback::Callback<OnDeviceConnectionFailure> * mOnFailure[kMaxAttempts];
+};
+
+struct FailureRecorder
+{
+    static void OnFailure(void * context, const ScopedNodeId & peerId, CHIP_ERROR error)
+    {
+        auto * self = static_cast<FailureRecorder *>(context);
+        self->mCount++;
+        self->mPeer  = peerId;
+        self->mError = error;
+    }
+
+    size_t mCount = 0;
+    ScopedNodeId mPeer;
+    CHIP_ERROR mError = CHIP_NO_ERROR;
+};
+
+void TestPriorityAndConcurrency(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx = *static_cast<TestContext *>(inContext);
+
+    TestPersistentStorageDelegate storage;
+    SimpleSessionResumptionStorage resumptionStorage;
+    NL_TEST_ASSERT(inSuite, resumptionStorage.Init(&storage) == CHIP_NO_ERROR);
+
+    // Peer 4 has a resumption ticket
+    SessionResumptionStorage::ResumptionIdStorage resumptionId = {};
+    Crypto::P256ECDHDerivedSecret sharedSecret;
+    sharedSecret.SetLength(sharedSecret.Capacity());
+    NL_TEST_ASSERT(inSuite,
+                   resumptionStorage.Save(ScopedNodeId(4, kFabric), resumptionId, sharedSecret, kUndefinedCATs) == CHIP_NO_ERROR);
+
+    FakeSessionManager sessionManager;
+    CASESessionScheduler scheduler;
+    CASESessionSchedulerConfig config;
+    config.maxConcurrent = 2;
+    config.maxAttempts   = 1;
+    NL_TEST_ASSERT(inSuite, scheduler.Init(&ctx.GetSystemLayer(), &sessionManager, &resumptionStorage, config) == CHIP_NO_ERROR);
+
+    FailureRecorder recorder;
+    Callback::Callback<OnDeviceConnectionFailure> onFailure(FailureRecorder::OnFailure, &recorder);
+
+    using Priority = CASESessionScheduler::Priority;
+    NL_TEST_ASSERT(inSuite, scheduler.Enqueue(ScopedNodeId(1, kFabric), Priority::kNormal, nullptr, &onFailure) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, scheduler.Enqueue(ScopedNodeId(2, kFabric), Priority::kLow, nullptr, &onFailure) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, scheduler.Enqueue(ScopedNodeId(3, kFabric), Priority::kHigh, nullptr, &onFailure) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, scheduler.Enqueue(ScopedNodeId(4, kFabric), Priority::kNormal, nullptr, &onFailure) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite,
+                   scheduler.Enqueue(ScopedNodeId(1, kFabric), Priority::kHigh, nullptr, &onFailure) == CHIP_ERROR_INCORRECT_STATE);
+
+    // Nothing starts before the event loop runs
+    NL_TEST_ASSERT(inSuite, sessionManager.mAttemptCount == 0);
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().queued == 4);
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().resumable == 1);
+
+    // Highest priority first, then the resumable peer among normal priorities
+    ctx.DrainAndServiceIO();
+    NL_TEST_ASSERT(inSuite, sessionManager.mAttemptCount == 2);
+    NL_TEST_ASSERT(inSuite, sessionManager.mPeers[0] == ScopedNodeId(3, kFabric));
+    NL_TEST_ASSERT(inSuite, sessionManager.mPeers[1] == ScopedNodeId(4, kFabric));
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().queued == 2);
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().inProgress == 2);
+
+    // A completion frees a slot for the next request
+    sessionManager.Fail(0, CHIP_ERROR_TIMEOUT);
+    NL_TEST_ASSERT(inSuite, recorder.mCount == 1);
+    NL_TEST_ASSERT(inSuite, recorder.mPeer == ScopedNodeId(3, kFabric));
+    NL_TEST_ASSERT(inSuite, recorder.mError == CHIP_ERROR_TIMEOUT);
+
+    ctx.DrainAndServiceIO();
+    NL_TEST_ASSERT(inSuite, sessionManager.mAttemptCount == 3);
+    NL_TEST_ASSERT(inSuite, sessionManager.mPeers[2] == ScopedNodeId(1, kFabric));
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().failed == 1);
+
+    // Cancelled requests neither start nor report
+    scheduler.Cancel(ScopedNodeId(2, kFabric));
+    sessionManager.Fail(1, CHIP_ERROR_TIMEOUT);
+    ctx.DrainAndServiceIO();
+    NL_TEST_ASSERT(inSuite, sessionManager.mAttemptCount == 3);
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().queued == 0);
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().inProgress == 1);
+
+    scheduler.Shutdown();
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().inProgress == 0);
+    NL_TEST_ASSERT(inSuite, recorder.mCount == 2);
+}
+
+void TestRetryWithBackoff(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx = *static_cast<TestContext *>(inContext);
+
+    FakeSessionManager sessionManager;
+    CASESessionScheduler scheduler;
+    CASESessionSchedulerConfig config;
+    config.maxAttempts    = 3;
+    config.initialBackoff = System::Clock::Milliseconds32(100);
+    NL_TEST_ASSERT(inSuite, scheduler.Init(&ctx.GetSystemLayer(), &sessionManager, nullptr, config) == CHIP_NO_ERROR);
+
+    FailureRecorder recorder;
+    Callback::Callback<OnDeviceConnectionFailure> onFailure(FailureRecorder::OnFailure, &recorder);
+
+    const ScopedNodeId peer(1, kFabric);
+    NL_TEST_ASSERT(inSuite, scheduler.Enqueue(peer, CASESessionScheduler::Priority::kNormal, nullptr, &onFailure) == CHIP_NO_ERROR);
+    ctx.DrainAndServiceIO();
+    NL_TEST_ASSERT(inSuite, sessionManager.mAttemptCount == 1);
+
+    // Failures are retried after a backoff and not reported
+    sessionManager.Fail(0, CHIP_ERROR_TIMEOUT);
+    ctx.DrainAndServiceIO();
+    NL_TEST_ASSERT(inSuite, recorder.mCount == 0);
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().queued == 1);
+
+    ctx.GetIOContext().DriveIOUntil(System::Clock::Seconds16(1), [&]() { return sessionManager.mAttemptCount == 2; });
+    NL_TEST_ASSERT(inSuite, sessionManager.mAttemptCount == 2);
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().retries == 1);
+
+    sessionManager.Fail(1, CHIP_ERROR_TIMEOUT);
+    ctx.GetIOContext().DriveIOUntil(System::Clock::Seconds16(1), [&]() { return sessionManager.mAttemptCount == 3; });
+    NL_TEST_ASSERT(inSuite, sessionManager.mAttemptCount == 3);
+
+    // The last attempt reports the failure
+    sessionManager.Fail(2, CHIP_ERROR_NOT_CONNECTED);
+    NL_TEST_ASSERT(inSuite, recorder.mCount == 1);
+    NL_TEST_ASSERT(inSuite, recorder.mError == CHIP_ERROR_NOT_CONNECTED);
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().failed == 1);
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().retries == 2);
+    NL_TEST_ASSERT(inSuite, scheduler.GetStats().inProgress == 0);
+
+    scheduler.Shutdown();
+}
+
+// clang-format off
+const nlTest sTests[] =
+{
+    NL_TEST_DEF("TestPriorityAndConcurrency", TestPriorityAndConcurrency),
+    NL_TEST_DEF("TestRetryWithBackoff", TestRetryWithBackoff),
+    NL_TEST_SENTINEL()
+};
+// clang-format on
+
+// clang-format off
+nlTestSuite sSuite =
+{
+    "TestCASESessionScheduler",
+    &sTests[0],
+    TestContext::Initialize,
+    TestContext::Finalize
+};
+// clang-format on
+
+} // namespace
+
+int TestCASESessionScheduler()
+{
+    return chip::ExecuteTestsWithContext<TestContext>(&sSuite);
+}
+
+CHIP_REGISTER_TEST_SUITE(TestCASESessionScheduler)
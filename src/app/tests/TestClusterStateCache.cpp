@@ -617,10 +617,231 @@ void TestCache(nlTestSuite * apSuite, void * apContext)
                              AttributeInstruction(AttributeInstruction::kAttributeB, 0, AttributeInstruction::kData) });
 }
 
+class NullCacheCallback : public ClusterStateCache::Callback
+{
+    void OnDone(ReadClient *) override {}
+};
+
+//
+// Send a report for kAttributeA (int) and kAttributeD (list of structs) on the given endpoints of the
+// test cluster, through the buffered callback of the cache.
+//
+void GenerateReport(ReadClient::Callback & callback, EndpointId firstEndpoint, EndpointId endpointCount, uint16_t value)
+{
+    StatusIB status;
+    callback.OnReportBegin();
+
+    for (EndpointId endpointId = firstEndpoint; endpointId < firstEndpoint + endpointCount; endpointId++)
+    {
+        for (auto attributeType : { AttributeInstruction::kAttributeA, AttributeInstruction::kAttributeD })
+        {
+            AttributeInstruction instruction(attributeType, endpointId, AttributeInstruction::kData);
+            ConcreteDataAttributePath path(endpointId, Clusters::TestCluster::Id, instruction.GetAttributeId());
+            path.mDataVersion.SetValue(value);
+
+            uint8_t buffer[1024];
+            TLV::TLVWriter writer;
+            writer.Init(buffer);
+
+            if (attributeType == AttributeInstruction::kAttributeA)
+            {
+                NL_TEST_ASSERT(gSuite, DataModel::Encode(writer, TLV::AnonymousTag(), value) == CHIP_NO_ERROR);
+            }
+            else
+            {
+                Clusters::TestCluster::Structs::TestListStructOctet::Type items[16];
+                for (auto & item : items)
+                {
+                    item.member1 = value;
+                }
+                Clusters::TestCluster::Attributes::ListStructOctetString::TypeInfo::Type list;
+                list         = items;
+                path.mListOp = ConcreteDataAttributePath::ListOperation::ReplaceAll;
+                NL_TEST_ASSERT(gSuite, DataModel::Encode(writer, TLV::AnonymousTag(), list) == CHIP_NO_ERROR);
+            }
+
+            TLV::TLVReader reader;
+            reader.Init(buffer, writer.GetLengthWritten());
+            NL_TEST_ASSERT(gSuite, reader.Next() == CHIP_NO_ERROR);
+            callback.OnAttributeData(path, &reader, status);
+        }
+    }
+
+    callback.OnReportEnd();
+}
+
+void ValidateReport(ClusterStateCache & cache, EndpointId firstEndpoint, EndpointId endpointCount, uint16_t value)
+{
+    for (EndpointId endpointId = firstEndpoint; endpointId < firstEndpoint + endpointCount; endpointId++)
+    {
+        Clusters::TestCluster::Attributes::Int16u::TypeInfo::DecodableType intValue = 0;
+        NL_TEST_ASSERT(gSuite,
+                       cache.Get<Clusters::TestCluster::Attributes::Int16u::TypeInfo>(
+                           ConcreteAttributePath(endpointId, Clusters::TestCluster::Id,
+                                                 Clusters::TestCluster::Attributes::Int16u::Id),
+                           intValue) == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(gSuite, intValue == value);
+
+        Clusters::TestCluster::Attributes::ListStructOctetString::TypeInfo::DecodableType list;
+        NL_TEST_ASSERT(gSuite,
+                       cache.Get<Clusters::TestCluster::Attributes::ListStructOctetString::TypeInfo>(
+                           ConcreteAttributePath(endpointId, Clusters::TestCluster::Id,
+                                                 Clusters::TestCluster::Attributes::ListStructOctetString::Id),
+                           list) == CHIP_NO_ERROR);
+        size_t count  = 0;
+        auto listIter = list.begin();
+        while (listIter.Next())
+        {
+            NL_TEST_ASSERT(gSuite, listIter.GetValue().member1 == value);
+            count++;
+        }
+        NL_TEST_ASSERT(gSuite, listIter.GetStatus() == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(gSuite, count == 16);
+    }
+}
+
+/*
+ * Overwrite cached values and make sure the space they held is reclaimed by Compact(), without affecting the values in use.
+ */
+void TestCompaction(nlTestSuite * apSuite, void * apContext)
+{
+    NullCacheCallback callback;
+    ClusterStateCache cache(callback);
+
+    GenerateReport(cache.GetBufferedCallback(), 0, 4, 1);
+    NL_TEST_ASSERT(apSuite, cache.GetReclaimableSize() == 0);
+
+    GenerateReport(cache.GetBufferedCallback(), 0, 4, 2);
+    size_t reportSize = cache.GetReclaimableSize();
+    NL_TEST_ASSERT(apSuite, reportSize > 0);
+    ValidateReport(cache, 0, 4, 2);
+
+    NL_TEST_ASSERT(apSuite, cache.Compact() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, cache.GetReclaimableSize() == 0);
+    ValidateReport(cache, 0, 4, 2);
+
+    uint32_t count = 0;
+    NL_TEST_ASSERT(apSuite, cache.ForEachCluster(2, [&count](ClusterId) {
+        count++;
+        return CHIP_NO_ERROR;
+    }) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, count == 1);
+
+    count = 0;
+    NL_TEST_ASSERT(apSuite, cache.ForEachAttribute(Clusters::TestCluster::Id, [&count](const ConcreteAttributePath &) {
+        count++;
+        return CHIP_NO_ERROR;
+    }) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, count == 8);
+
+    //
+    // Many more reports than that: the cache compacts itself at the start of reports, so the reclaimable space stays
+    // bounded by the space in use.
+    //
+    for (uint16_t value = 3; value < 64; value++)
+    {
+        GenerateReport(cache.GetBufferedCallback(), 0, 4, value);
+        ValidateReport(cache, 0, 4, value);
+    }
+    Optional<DataVersion> version;
+    NL_TEST_ASSERT(apSuite, cache.GetVersion(ConcreteClusterPath(3, Clusters::TestCluster::Id), version) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, version.HasValue() == false);
+    NL_TEST_ASSERT(apSuite, cache.GetReclaimableSize() < 8 * reportSize);
+}
+
+} // namespace
+
+namespace chip {
+namespace app {
+
+class TestClusterStateCacheArena
+{
+public:
+    /*
+     * Clearing an arena releases its blocks and resets the usage it reports.
+     */
+    static void TestClear(nlTestSuite * apSuite, void * apContext)
+    {
+        ClusterStateCache::Arena arena;
+        const uint8_t data[] = { 1, 2, 3, 4 };
+        ByteSpan copy;
+
+        NL_TEST_ASSERT(apSuite, arena.Copy(ByteSpan(data), copy) == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, copy.data_equal(ByteSpan(data)));
+        NL_TEST_ASSERT(apSuite, arena.GetUsedSize() == sizeof(data));
+
+        arena.Clear();
+        NL_TEST_ASSERT(apSuite, arena.GetUsedSize() == 0);
+
+        NL_TEST_ASSERT(apSuite, arena.Copy(ByteSpan(data), copy) == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, arena.GetUsedSize() == sizeof(data));
+    }
+
+    /*
+     * Elements read through a backing store, whose total length is unknown, are copied into blocks sized for the element.
+     */
+    static void TestCopyElementFromBackingStore(nlTestSuite * apSuite, void * apContext)
+    {
+        uint8_t data[64];
+        memset(data, 0x5a, sizeof(data));
+
+        System::PacketBufferTLVWriter writer;
+        TLV::TLVType containerType;
+        writer.Init(System::PacketBufferHandle::New(System::PacketBuffer::kMaxSize));
+        NL_TEST_ASSERT(apSuite,
+                       writer.StartContainer(TLV::AnonymousTag(), TLV::kTLVType_Structure, containerType) == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, writer.Put(TLV::ContextTag(1), static_cast<uint32_t>(42)) == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, writer.PutBytes(TLV::ContextTag(2), data, sizeof(data)) == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, writer.EndContainer(containerType) == CHIP_NO_ERROR);
+        System::PacketBufferHandle buffer;
+        NL_TEST_ASSERT(apSuite, writer.Finalize(&buffer) == CHIP_NO_ERROR);
+
+        System::TLVPacketBufferBackingStore store(std::move(buffer));
+        TLV::TLVReader reader;
+        NL_TEST_ASSERT(apSuite, reader.Init(store) == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, reader.GetTotalLength() == UINT32_MAX);
+        NL_TEST_ASSERT(apSuite, reader.Next() == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, reader.EnterContainer(containerType) == CHIP_NO_ERROR);
+
+        ClusterStateCache::Arena arena;
+        ByteSpan first;
+        ByteSpan second;
+
+        NL_TEST_ASSERT(apSuite, reader.Next() == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, arena.CopyElement(reader, first) == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, reader.Next() == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, arena.CopyElement(reader, second) == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, reader.Next() == CHIP_END_OF_TLV);
+
+        NL_TEST_ASSERT(apSuite, arena.mBlocks.size() == 1);
+        NL_TEST_ASSERT(apSuite, arena.mBlocks.back().mData.AllocatedSize() == ClusterStateCache::Arena::kBlockSize);
+
+        uint32_t value = 0;
+        ByteSpan bytes;
+        TLV::TLVReader copy;
+        copy.Init(first);
+        NL_TEST_ASSERT(apSuite, copy.Next() == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, copy.GetTag() == TLV::AnonymousTag());
+        NL_TEST_ASSERT(apSuite, copy.Get(value) == CHIP_NO_ERROR && value == 42);
+        copy.Init(second);
+        NL_TEST_ASSERT(apSuite, copy.Next() == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(apSuite, copy.GetTag() == TLV::AnonymousTag());
+        NL_TEST_ASSERT(apSuite, copy.Get(bytes) == CHIP_NO_ERROR && bytes.data_equal(ByteSpan(data)));
+    }
+};
+
+} // namespace app
+} // namespace chip
+
+namespace {
+
 // clang-format off
 const nlTest sTests[] =
 {
     NL_TEST_DEF("TestCache", TestCache),
+    NL_TEST_DEF("TestCompaction", TestCompaction),
+    NL_TEST_DEF("TestArenaClear", TestClusterStateCacheArena::TestClear),
+    NL_TEST_DEF("TestArenaCopyElementFromBackingStore", TestClusterStateCacheArena::TestCopyElementFromBackingStore),
     NL_TEST_SENTINEL()
 };
 
@@ -311,12 +311,101 @@ static void CheckLogEventWithDiscardLowEvent(nlTestSuite * apSuite, void * apCon
     NL_TEST_ASSERT(apSuite, err == CHIP_NO_ERROR);
     CheckLogState(apSuite, logMgmt, 3, chip::app::PriorityLevel::Debug);
 }
+
+static void CheckEventIndex(nlTestSuite * apSuite, void * apContext)
+{
+    chip::app::EventIndex index;
+    chip::app::EventIndex::Entry entry = { 0, kLivenessClusterId, kLivenessChangeEvent, 0, kTestEndpointId1 };
+    constexpr size_t kCapacity         = chip::app::EventIndex::kCapacity;
+
+    NL_TEST_ASSERT(apSuite, index.IsEmpty());
+    NL_TEST_ASSERT(apSuite, index.LowerBound(0) == 0);
+
+    // Fill the index past its capacity: the oldest entries are dropped.
+    for (size_t i = 0; i < kCapacity + 2; i++)
+    {
+        entry.mEventNumber = 10 + 2 * i;
+        entry.mOffset      = static_cast<uint32_t>(i);
+        index.Append(entry);
+    }
+    NL_TEST_ASSERT(apSuite, index.Count() == kCapacity);
+    NL_TEST_ASSERT(apSuite, index.Front().mEventNumber == 14);
+    NL_TEST_ASSERT(apSuite, index.Back().mEventNumber == 10 + 2 * (kCapacity + 1));
+    for (size_t i = 1; i < index.Count(); i++)
+    {
+        NL_TEST_ASSERT(apSuite, index[i].mEventNumber == index[i - 1].mEventNumber + 2);
+    }
+
+    NL_TEST_ASSERT(apSuite, index.LowerBound(0) == 0);
+    NL_TEST_ASSERT(apSuite, index.LowerBound(14) == 0);
+    NL_TEST_ASSERT(apSuite, index.LowerBound(15) == 1);
+    NL_TEST_ASSERT(apSuite, index.LowerBound(16) == 1);
+    NL_TEST_ASSERT(apSuite, index.LowerBound(index.Back().mEventNumber) == kCapacity - 1);
+    NL_TEST_ASSERT(apSuite, index.LowerBound(index.Back().mEventNumber + 1) == kCapacity);
+
+    index.PopFront();
+    NL_TEST_ASSERT(apSuite, index.Count() == kCapacity - 1);
+    NL_TEST_ASSERT(apSuite, index.Front().mEventNumber == 16);
+    NL_TEST_ASSERT(apSuite, index.Front().mOffset == 3);
+
+    index.Clear();
+    NL_TEST_ASSERT(apSuite, index.IsEmpty());
+}
+
+static void CheckFetchEventsAfterWrap(nlTestSuite * apSuite, void * apContext)
+{
+    constexpr size_t kNumEvents = 20;
+    chip::EventNumber eids[kNumEvents];
+    chip::app::EventOptions options;
+    options.mPriority = chip::app::PriorityLevel::Critical;
+    TestEventGenerator testEventGenerator;
+
+    chip::app::EventManagement & logMgmt = chip::app::EventManagement::GetInstance();
+
+    // Log far more events than all the buffers can hold, alternating between two endpoints, so that every buffer wraps around
+    // and only the newest events survive.
+    for (size_t i = 0; i < kNumEvents; i++)
+    {
+        options.mPath = { (i % 2 == 0) ? kTestEndpointId1 : kTestEndpointId2, kLivenessClusterId, kLivenessChangeEvent };
+        testEventGenerator.SetStatus(static_cast<int32_t>(i));
+        NL_TEST_ASSERT(apSuite, logMgmt.LogEvent(&testEventGenerator, options, eids[i]) == CHIP_NO_ERROR);
+    }
+
+    chip::TLV::TLVReader reader;
+    size_t numStored = 0;
+    chip::app::CircularEventBufferWrapper bufWrapper;
+    NL_TEST_ASSERT(apSuite, logMgmt.GetEventReader(reader, chip::app::PriorityLevel::Critical, &bufWrapper) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, chip::TLV::Utilities::Count(reader, numStored, false) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, numStored >= 4 && numStored < kNumEvents);
+
+    // Start from an event in the middle of the ones still stored.
+    const size_t start = kNumEvents - numStored / 2;
+
+    chip::app::ObjectList<chip::app::EventPathParams> wildcardPath;
+    CheckLogReadOut(apSuite, logMgmt, eids[start], kNumEvents - start, &wildcardPath);
+
+    chip::app::ObjectList<chip::app::EventPathParams> endpoint1Path;
+    endpoint1Path.mValue.mEndpointId = kTestEndpointId1;
+    endpoint1Path.mValue.mClusterId  = kLivenessClusterId;
+    size_t expectedOnEndpoint1       = 0;
+    for (size_t i = start; i < kNumEvents; i++)
+    {
+        expectedOnEndpoint1 += (i % 2 == 0) ? 1 : 0;
+    }
+    CheckLogReadOut(apSuite, logMgmt, eids[start], expectedOnEndpoint1, &endpoint1Path);
+
+    // An event number older than everything stored returns all the stored events.
+    CheckLogReadOut(apSuite, logMgmt, eids[0], numStored, &wildcardPath);
+}
+
 /**
  *   Test Suite. It lists all the test functions.
  */
 
 const nlTest sTests[] = { NL_TEST_DEF("CheckLogEventWithEvictToNextBuffer", CheckLogEventWithEvictToNextBuffer),
-                          NL_TEST_DEF("CheckLogEventWithDiscardLowEvent", CheckLogEventWithDiscardLowEvent), NL_TEST_SENTINEL() };
+                          NL_TEST_DEF("CheckLogEventWithDiscardLowEvent", CheckLogEventWithDiscardLowEvent),
+                          NL_TEST_DEF("CheckEventIndex", CheckEventIndex),
+                          NL_TEST_DEF("CheckFetchEventsAfterWrap", CheckFetchEventsAfterWrap), NL_TEST_SENTINEL() };
 
 // clang-format off
 nlTestSuite sSuite =
@@ -0,0 +1,125 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <app/reporting/CalendarQueueReportScheduler.h>
+#include <lib/support/UnitTestRegistration.h>
+#include <nlunit-test.h>
+
+using chip::app::reporting::CalendarQueue;
+using chip::app::reporting::ReportScheduler;
+using chip::System::Clock::Timestamp;
+
+namespace {
+
+using Node = ReportScheduler::Node;
+
+Node MakeNode(Timestamp aDeadline)
+{
+    Node node;
+    node.mDeadline = aDeadline;
+    return node;
+}
+
+void TestEmptyQueue(nlTestSuite * aSuite, void * aContext)
+{
+    CalendarQueue queue;
+    NL_TEST_ASSERT(aSuite, queue.IsEmpty());
+    NL_TEST_ASSERT(aSuite, queue.Earliest() == nullptr);
+}
+
+void TestOrdering(nlTestSuite * aSuite, void * aContext)
+{
+    CalendarQueue queue;
+    const Timestamp width = CalendarQueue::kBucketWidth;
+
+    // Two nodes in the same bucket, one in a later bucket and one more than a full turn of the ring away, which hashes to the
+    // same bucket as the first ones.
+    Node a = MakeNode(width * 2 + Timestamp(10));
+    Node b = MakeNode(width * 2 + Timestamp(5));
+    Node c = MakeNode(width * 3);
+    Node d = MakeNode(width * (2 + CalendarQueue::kNumBuckets));
+
+    queue.Insert(d);
+    queue.Insert(a);
+    queue.Insert(c);
+    queue.Insert(b);
+    NL_TEST_ASSERT(aSuite, queue.Count() == 4);
+
+    Node * expected[] = { &b, &a, &c, &d };
+    for (Node * node : expected)
+    {
+        NL_TEST_ASSERT(aSuite, queue.Earliest() == node);
+        queue.Remove(*node);
+    }
+    NL_TEST_ASSERT(aSuite, queue.IsEmpty());
+}
+
+void TestRemoveAndReinsert(nlTestSuite * aSuite, void * aContext)
+{
+    CalendarQueue queue;
+    const Timestamp width = CalendarQueue::kBucketWidth;
+
+    Node a = MakeNode(width * 5);
+    Node b = MakeNode(width * 7);
+    queue.Insert(a);
+    queue.Insert(b);
+    NL_TEST_ASSERT(aSuite, queue.Earliest() == &a);
+
+    // Removing the earliest node and inserting one before the cursor must still be found.
+    queue.Remove(a);
+    NL_TEST_ASSERT(aSuite, queue.Earliest() == &b);
+
+    a.mDeadline = width;
+    queue.Insert(a);
+    NL_TEST_ASSERT(aSuite, queue.Earliest() == &a);
+
+    // Only deadlines far past the ring left: the fallback search has to find them.
+    queue.Remove(a);
+    queue.Remove(b);
+    b.mDeadline = width * (7 + 3 * CalendarQueue::kNumBuckets);
+    a.mDeadline = width * (9 + 3 * CalendarQueue::kNumBuckets);
+    queue.Insert(a);
+    queue.Insert(b);
+    NL_TEST_ASSERT(aSuite, queue.Earliest() == &b);
+
+    queue.Clear();
+    NL_TEST_ASSERT(aSuite, queue.IsEmpty());
+    NL_TEST_ASSERT(aSuite, queue.Earliest() == nullptr);
+}
+
+} // namespace
+
+int TestReportScheduler()
+{
+    static nlTest sTests[] = {
+        NL_TEST_DEF("TestEmptyQueue", TestEmptyQueue),
+        NL_TEST_DEF("TestOrdering", TestOrdering),
+        NL_TEST_DEF("TestRemoveAndReinsert", TestRemoveAndReinsert),
+        NL_TEST_SENTINEL(),
+    };
+
+    nlTestSuite theSuite = {
+        "ReportScheduler",
+        &sTests[0],
+        nullptr,
+        nullptr,
+    };
+    nlTestRunner(&theSuite, nullptr);
+    return (nlTestRunnerStats(&theSuite));
+}
+
+CHIP_REGISTER_TEST_SUITE(TestReportScheduler)
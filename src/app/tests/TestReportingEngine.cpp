@@ -24,8 +24,11 @@
 
 #include <app/ConcreteAttributePath.h>
 #include <app/InteractionModelEngine.h>
+#include <app/reporting/AttributeReportCache.h>
+#include <app/reporting/CalendarQueueReportScheduler.h>
 #include <app/reporting/Engine.h>
 #include <app/tests/AppTestContext.h>
+#include <app/util/MatterCallbacks.h>
 #include <lib/core/CHIPCore.h>
 #include <lib/core/CHIPTLV.h>
 #include <lib/core/CHIPTLVDebug.hpp>
@@ -41,6 +44,15 @@
 
 using TestContext = chip::Test::AppContext;
 
+namespace {
+uint32_t gAttributeReadCount = 0;
+} // namespace
+
+void MatterPreAttributeReadCallback(const chip::app::ConcreteAttributePath & attributePath)
+{
+    gAttributeReadCount++;
+}
+
 namespace chip {
 
 constexpr ClusterId kTestClusterId        = 6;
@@ -56,9 +68,14 @@ public:
     static void TestBuildAndSendSingleReportData(nlTestSuite * apSuite, void * apContext);
     static void TestMergeOverlappedAttributePath(nlTestSuite * apSuite, void * apContext);
     static void TestMergeAttributePathWhenDirtySetPoolExhausted(nlTestSuite * apSuite, void * apContext);
+    static void TestAttributeReportCache(nlTestSuite * apSuite, void * apContext);
+    static void TestSharedAttributeReport(nlTestSuite * apSuite, void * apContext);
+    static void TestReportOrder(nlTestSuite * apSuite, void * apContext);
+    static void TestServiceDeadlines(nlTestSuite * apSuite, void * apContext);
 
 private:
     static bool InsertToDirtySet(const AttributePathParams & aPath);
+    static System::PacketBufferHandle GenerateReadRequest(nlTestSuite * apSuite, AttributeId aAttributeId);
 
     struct ExpectedDirtySetContent : public AttributePathParams
     {
@@ -321,6 +338,245 @@ void TestReportingEngine::TestMergeAttributePathWhenDirtySetPoolExhausted(nlTest
     InteractionModelEngine::GetInstance()->GetReportingEngine().Shutdown();
 }
 
+void TestReportingEngine::TestAttributeReportCache(nlTestSuite * apSuite, void * apContext)
+{
+    using Cache = AttributeReportCache<8, 2>;
+    Cache cache;
+    ByteSpan encoded;
+    const uint8_t data[] = { 1, 2, 3 };
+
+    Cache::Key key1(ConcreteAttributePath(kTestEndpointId, kTestClusterId, kTestFieldId1), 1, false);
+    Cache::Key key1Filtered(ConcreteAttributePath(kTestEndpointId, kTestClusterId, kTestFieldId1), 1, true);
+    Cache::Key key1OtherFabric(ConcreteAttributePath(kTestEndpointId, kTestClusterId, kTestFieldId1), 2, false);
+    Cache::Key key2(ConcreteAttributePath(kTestEndpointId, kTestClusterId, kTestFieldId2), 1, false);
+
+    cache.Refresh(1);
+    NL_TEST_ASSERT(apSuite, !cache.Find(key1, encoded));
+
+    MutableByteSpan freeSpace = cache.GetFreeSpace();
+    NL_TEST_ASSERT(apSuite, freeSpace.size() == 8);
+    memcpy(freeSpace.data(), data, sizeof(data));
+    NL_TEST_ASSERT(apSuite, cache.Commit(key1, sizeof(data), encoded) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, encoded.data_equal(ByteSpan(data)));
+
+    // The fabric and fabric filtering are part of the key.
+    NL_TEST_ASSERT(apSuite, cache.Find(key1, encoded) && encoded.data_equal(ByteSpan(data)));
+    NL_TEST_ASSERT(apSuite, !cache.Find(key1Filtered, encoded));
+    NL_TEST_ASSERT(apSuite, !cache.Find(key1OtherFabric, encoded));
+    NL_TEST_ASSERT(apSuite, !cache.Find(key2, encoded));
+
+    // Encodings which do not fit in the arena are not cached.
+    NL_TEST_ASSERT(apSuite, cache.GetFreeSpace().size() == 5);
+    NL_TEST_ASSERT(apSuite, cache.Commit(key2, 6, encoded) == CHIP_ERROR_NO_MEMORY);
+    NL_TEST_ASSERT(apSuite, cache.Commit(key2, 5, encoded) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, cache.GetFreeSpace().empty());
+    NL_TEST_ASSERT(apSuite, cache.GetEntryCount() == 2);
+
+    // Refreshing with the same generation keeps the entries, a new generation drops them.
+    cache.Refresh(1);
+    NL_TEST_ASSERT(apSuite, cache.Find(key1, encoded));
+    cache.Refresh(2);
+    NL_TEST_ASSERT(apSuite, !cache.Find(key1, encoded));
+    NL_TEST_ASSERT(apSuite, cache.GetEntryCount() == 0);
+    NL_TEST_ASSERT(apSuite, cache.GetFreeSpace().size() == 8);
+}
+
+System::PacketBufferHandle TestReportingEngine::GenerateReadRequest(nlTestSuite * apSuite, AttributeId aAttributeId)
+{
+    System::PacketBufferTLVWriter writer;
+    System::PacketBufferHandle readRequestbuf = System::PacketBufferHandle::New(System::PacketBuffer::kMaxSize);
+    ReadRequestMessage::Builder readRequestBuilder;
+
+    writer.Init(std::move(readRequestbuf));
+    NL_TEST_ASSERT(apSuite, readRequestBuilder.Init(&writer) == CHIP_NO_ERROR);
+    AttributePathIBs::Builder & attributePathListBuilder = readRequestBuilder.CreateAttributeRequests();
+    NL_TEST_ASSERT(apSuite, readRequestBuilder.GetError() == CHIP_NO_ERROR);
+    AttributePathIB::Builder & attributePathBuilder = attributePathListBuilder.CreatePath();
+    NL_TEST_ASSERT(apSuite, attributePathListBuilder.GetError() == CHIP_NO_ERROR);
+    attributePathBuilder.Node(1).Endpoint(kTestEndpointId).Cluster(kTestClusterId).Attribute(aAttributeId).EndOfAttributePathIB();
+    NL_TEST_ASSERT(apSuite, attributePathBuilder.GetError() == CHIP_NO_ERROR);
+    attributePathListBuilder.EndOfAttributePathIBs();
+    readRequestBuilder.IsFabricFiltered(false).EndOfReadRequestMessage();
+    NL_TEST_ASSERT(apSuite, readRequestBuilder.GetError() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, writer.Finalize(&readRequestbuf) == CHIP_NO_ERROR);
+    return readRequestbuf;
+}
+
+void TestReportingEngine::TestSharedAttributeReport(nlTestSuite * apSuite, void * apContext)
+{
+    TestContext & ctx = *static_cast<TestContext *>(apContext);
+    DummyDelegate dummy;
+    TestExchangeDelegate delegate;
+    Engine & engine = InteractionModelEngine::GetInstance()->GetReportingEngine();
+
+    NL_TEST_ASSERT(apSuite, InteractionModelEngine::GetInstance()->Init(&ctx.GetExchangeManager(), &ctx.GetFabricTable()) ==
+                       CHIP_NO_ERROR);
+
+    // Start from a new dirty set generation, so that nothing is cached yet.
+    engine.BumpDirtySetGeneration();
+
+    app::ReadHandler readHandler1(dummy, ctx.NewExchangeToAlice(&delegate), chip::app::ReadHandler::InteractionType::Read);
+    readHandler1.OnInitialRequest(GenerateReadRequest(apSuite, kTestFieldId1));
+    app::ReadHandler readHandler2(dummy, ctx.NewExchangeToAlice(&delegate), chip::app::ReadHandler::InteractionType::Read);
+    readHandler2.OnInitialRequest(GenerateReadRequest(apSuite, kTestFieldId1));
+
+    gAttributeReadCount = 0;
+    NL_TEST_ASSERT(apSuite, engine.BuildAndSendSingleReportData(&readHandler1) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, gAttributeReadCount == 1);
+    NL_TEST_ASSERT(apSuite, engine.BuildAndSendSingleReportData(&readHandler2) == CHIP_NO_ERROR);
+    ctx.DrainAndServiceIO();
+
+#if CHIP_IM_SERVER_REPORT_CACHE_SIZE > 0
+    // The second ReadHandler got the attribute encoded for the first one, which was read from the data model once.
+    NL_TEST_ASSERT(apSuite, gAttributeReadCount == 1);
+    NL_TEST_ASSERT(apSuite, engine.GetReportCacheEntryCount() == 1);
+#else
+    NL_TEST_ASSERT(apSuite, gAttributeReadCount == 2);
+#endif
+
+    engine.Shutdown();
+}
+
+void TestReportingEngine::TestReportOrder(nlTestSuite * apSuite, void * apContext)
+{
+    TestContext & ctx = *static_cast<TestContext *>(apContext);
+    DummyDelegate dummy;
+    TestExchangeDelegate delegate;
+    InteractionModelEngine * imEngine = InteractionModelEngine::GetInstance();
+    Engine & engine                   = imEngine->GetReportingEngine();
+
+    NL_TEST_ASSERT(apSuite, imEngine->Init(&ctx.GetExchangeManager(), &ctx.GetFabricTable()) == CHIP_NO_ERROR);
+
+    ReadHandler * handlers[3];
+    for (ReadHandler *& handler : handlers)
+    {
+        handler = imEngine->GetReadHandlerPool().CreateObject(dummy, ctx.NewExchangeToAlice(&delegate),
+                                                              ReadHandler::InteractionType::Subscribe);
+        NL_TEST_ASSERT(apSuite, handler != nullptr);
+        handler->mState = ReadHandler::HandlerState::GeneratingReports;
+        handler->mFlags.Clear(ReadHandler::ReadHandlerFlags::PrimingReports);
+    }
+
+    // The position of each handler in the pool, which the round-robin cursor counts in.
+    uint32_t positions[3] = {};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        for (uint32_t position = 0; position < 3; position++)
+        {
+            if (imEngine->ActiveHandlerAt(position) == handlers[i])
+            {
+                positions[i] = position;
+            }
+        }
+    }
+
+    const System::Clock::Timestamp now              = System::SystemClock().GetMonotonicTimestamp();
+    handlers[0]->mReportSchedulerNode.mMaxTimestamp = now + System::Clock::Seconds16(20);
+    handlers[1]->mReportSchedulerNode.mMaxTimestamp = now + System::Clock::Seconds16(10);
+    handlers[2]->mReportSchedulerNode.mMaxTimestamp = now + System::Clock::Seconds16(5);
+    handlers[2]->mFlags.Set(ReadHandler::ReadHandlerFlags::HoldReport);
+
+    // The reportable handler closest to its max interval reports first, wherever the round-robin cursor is.
+    engine.mCurReadHandlerIdx = positions[0];
+    NL_TEST_ASSERT(apSuite, engine.NextReadHandlerToReport() == handlers[1]);
+    NL_TEST_ASSERT(apSuite, engine.mCurReadHandlerIdx == positions[1]);
+
+    // Handlers due at the same time report round-robin.
+    handlers[0]->mReportSchedulerNode.mMaxTimestamp = handlers[1]->mReportSchedulerNode.mMaxTimestamp;
+    engine.mCurReadHandlerIdx                       = positions[0];
+    NL_TEST_ASSERT(apSuite, engine.NextReadHandlerToReport() == handlers[0]);
+    engine.mCurReadHandlerIdx = positions[1];
+    NL_TEST_ASSERT(apSuite, engine.NextReadHandlerToReport() == handlers[1]);
+
+    // Priming reports are due right away.
+    handlers[0]->mFlags.Set(ReadHandler::ReadHandlerFlags::PrimingReports);
+    NL_TEST_ASSERT(apSuite, engine.NextReadHandlerToReport() == handlers[0]);
+
+    for (ReadHandler * handler : handlers)
+    {
+        handler->mState = ReadHandler::HandlerState::Idle;
+    }
+    NL_TEST_ASSERT(apSuite, engine.NextReadHandlerToReport() == nullptr);
+
+    imEngine->GetReadHandlerPool().ReleaseAll();
+    ctx.DrainAndServiceIO();
+    engine.Shutdown();
+}
+
+void TestReportingEngine::TestServiceDeadlines(nlTestSuite * apSuite, void * apContext)
+{
+    using Node  = ReportScheduler::Node;
+    using Flags = ReadHandler::ReadHandlerFlags;
+
+    TestContext & ctx = *static_cast<TestContext *>(apContext);
+    DummyDelegate dummy;
+    TestExchangeDelegate delegate;
+    Engine & engine = InteractionModelEngine::GetInstance()->GetReportingEngine();
+
+    NL_TEST_ASSERT(apSuite, InteractionModelEngine::GetInstance()->Init(&ctx.GetExchangeManager(), &ctx.GetFabricTable()) ==
+                       CHIP_NO_ERROR);
+    CalendarQueueReportScheduler & scheduler = engine.mDefaultReportScheduler;
+
+    ReadHandler readHandler1(dummy, ctx.NewExchangeToAlice(&delegate), ReadHandler::InteractionType::Subscribe);
+    ReadHandler readHandler2(dummy, ctx.NewExchangeToAlice(&delegate), ReadHandler::InteractionType::Subscribe);
+    ReadHandler readHandler3(dummy, ctx.NewExchangeToAlice(&delegate), ReadHandler::InteractionType::Subscribe);
+    for (ReadHandler * handler : { &readHandler1, &readHandler2, &readHandler3 })
+    {
+        handler->mFlags.Set(Flags::HoldReport).Set(Flags::HoldSync);
+    }
+
+    // The second subscription is due half a coalescing window after the first one, so it shares the first one's wakeup. The
+    // third one is due as late, but the bound on its coalescing window, a quarter of the time between its min and max
+    // intervals, keeps it from being signaled that early.
+    const uint32_t window                = CHIP_IM_REPORT_SCHEDULER_COALESCING_WINDOW_MS;
+    const System::Clock::Timestamp start = System::SystemClock().GetMonotonicTimestamp();
+    NL_TEST_ASSERT(apSuite,
+                   scheduler.ScheduleReport(readHandler1, System::Clock::Milliseconds32(1000),
+                                            System::Clock::Milliseconds32(60000)) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite,
+                   scheduler.ScheduleReport(readHandler2, System::Clock::Milliseconds32(1000),
+                                            System::Clock::Milliseconds32(60000 + window / 2)) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite,
+                   scheduler.ScheduleReport(readHandler3, System::Clock::Milliseconds32(60000 - window / 8),
+                                            System::Clock::Milliseconds32(60000 + window / 2)) == CHIP_NO_ERROR);
+
+    // Min interval floors are signaled once they elapse.
+    scheduler.ServiceDeadlines(start + System::Clock::Seconds16(2));
+    NL_TEST_ASSERT(apSuite, readHandler1.mReportSchedulerNode.mState == Node::State::WaitingForMaxInterval);
+    NL_TEST_ASSERT(apSuite, readHandler2.mReportSchedulerNode.mState == Node::State::WaitingForMaxInterval);
+    NL_TEST_ASSERT(apSuite, readHandler3.mReportSchedulerNode.mState == Node::State::WaitingForMinInterval);
+    NL_TEST_ASSERT(apSuite, !readHandler1.mFlags.Has(Flags::HoldReport) && !readHandler2.mFlags.Has(Flags::HoldReport));
+    NL_TEST_ASSERT(apSuite, readHandler3.mFlags.Has(Flags::HoldReport));
+    NL_TEST_ASSERT(apSuite, readHandler1.mFlags.Has(Flags::HoldSync) && readHandler2.mFlags.Has(Flags::HoldSync));
+
+    ctx.DrainAndServiceIO();
+
+    // When the first max interval elapses, the keep-alive reports of the first two subscriptions are coalesced into one run of
+    // the reporting engine.
+    scheduler.ServiceDeadlines(readHandler1.mReportSchedulerNode.mMaxTimestamp);
+    NL_TEST_ASSERT(apSuite, readHandler1.mReportSchedulerNode.mState == Node::State::Idle);
+    NL_TEST_ASSERT(apSuite, !readHandler1.mFlags.Has(Flags::HoldSync));
+    NL_TEST_ASSERT(apSuite, readHandler3.mReportSchedulerNode.mState == Node::State::WaitingForMaxInterval);
+    NL_TEST_ASSERT(apSuite, !readHandler3.mFlags.Has(Flags::HoldReport) && readHandler3.mFlags.Has(Flags::HoldSync));
+    if (window > 0)
+    {
+        NL_TEST_ASSERT(apSuite, readHandler2.mReportSchedulerNode.mState == Node::State::Idle);
+        NL_TEST_ASSERT(apSuite, !readHandler2.mFlags.Has(Flags::HoldSync));
+    }
+    NL_TEST_ASSERT(apSuite, engine.mRunScheduled);
+
+    ctx.DrainAndServiceIO();
+    NL_TEST_ASSERT(apSuite, !engine.mRunScheduled);
+
+    // The third subscription is signaled by its own deadline.
+    scheduler.ServiceDeadlines(readHandler3.mReportSchedulerNode.mMaxTimestamp);
+    NL_TEST_ASSERT(apSuite, readHandler3.mReportSchedulerNode.mState == Node::State::Idle);
+    NL_TEST_ASSERT(apSuite, !readHandler3.mFlags.Has(Flags::HoldSync));
+
+    ctx.DrainAndServiceIO();
+    engine.Shutdown();
+}
+
 } // namespace reporting
 } // namespace app
 } // namespace chip
@@ -332,6 +588,10 @@ const nlTest sTests[] =
     NL_TEST_DEF("CheckBuildAndSendSingleReportData", chip::app::reporting::TestReportingEngine::TestBuildAndSendSingleReportData),
     NL_TEST_DEF("TestMergeOverlappedAttributePath", chip::app::reporting::TestReportingEngine::TestMergeOverlappedAttributePath),
     NL_TEST_DEF("TestMergeAttributePathWhenDirtySetPoolExhausted", chip::app::reporting::TestReportingEngine::TestMergeAttributePathWhenDirtySetPoolExhausted),
+    NL_TEST_DEF("TestAttributeReportCache", chip::app::reporting::TestReportingEngine::TestAttributeReportCache),
+    NL_TEST_DEF("TestSharedAttributeReport", chip::app::reporting::TestReportingEngine::TestSharedAttributeReport),
+    NL_TEST_DEF("TestReportOrder", chip::app::reporting::TestReportingEngine::TestReportOrder),
+    NL_TEST_DEF("TestServiceDeadlines", chip::app::reporting::TestReportingEngine::TestServiceDeadlines),
     NL_TEST_SENTINEL()
 };
 // clang-format on
@@ -0,0 +1,826 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements chip-im-bench, which measures the interaction model end to end, from the client objects to the
+ *      mock ember attribute storage, over the loopback transport of the unit tests.
+ *
+ *      Each run executes one workload:
+ *        - read:      wildcard reads of all the attributes of N mock endpoints, B reads in flight at a time.
+ *        - subscribe: M subscriptions to the attributes of N mock endpoints; every round marks D cluster paths dirty and waits
+ *                     for a report on each subscription.
+ *        - invoke:    B invokes in flight at a time.
+ *        - session:   back to back CASE session establishments to a CASEServer, with the test fabric certificates.
+ *
+ *      The results (throughput, latency percentiles, heap allocations and peak pool usage) are printed as JSON.
+ */
+
+#include <CHIPVersion.h>
+#include <app/CommandSender.h>
+#include <app/InteractionModelEngine.h>
+#include <app/ReadClient.h>
+#include <app/tests/AppTestContext.h>
+#include <app/util/mock/Constants.h>
+#include <app/util/mock/Functions.h>
+#include <credentials/GroupDataProviderImpl.h>
+#include <lib/support/CHIPArgParser.hpp>
+#include <lib/support/CHIPMem.h>
+#include <lib/support/CodeUtils.h>
+#include <lib/support/TestPersistentStorageDelegate.h>
+#include <lib/support/logging/CHIPLogging.h>
+#include <protocols/secure_channel/CASEServer.h>
+#include <protocols/secure_channel/CASESession.h>
+#include <system/SystemStats.h>
+
+#include <algorithm>
+#include <atomic>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace {
+
+// Heap allocations since the start of the measured phase. They are counted by wrapping the glibc allocator, which sanitizers
+// replace with their own.
+std::atomic<uint64_t> gAllocationCount{ 0 };
+
+} // namespace
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define CHIP_IM_BENCH_COUNT_ALLOCATIONS 1
+
+extern "C" {
+
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t count, size_t size);
+void * __libc_realloc(void * ptr, size_t size);
+
+void * malloc(size_t size) __THROW
+{
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void * calloc(size_t count, size_t size) __THROW
+{
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void * realloc(void * ptr, size_t size) __THROW
+{
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+} // extern "C"
+
+#else
+#define CHIP_IM_BENCH_COUNT_ALLOCATIONS 0
+#endif
+
+namespace {
+
+using namespace chip;
+using namespace chip::app;
+using namespace chip::ArgParser;
+
+#define TOOL_NAME "chip-im-bench"
+#define COPYRIGHT_STRING "Copyright (c) 2022 Project CHIP Authors.\nAll rights reserved.\n"
+
+// Longest wait for the completion of one batch of requests or one round of reports
+constexpr System::Clock::Timeout kRoundTimeout = System::Clock::Seconds16(10);
+
+// Max interval requested by the subscriptions, long enough for the benchmark to see only the reports of dirty paths
+constexpr uint16_t kMaxIntervalCeilingSeconds = 3600;
+
+// Mock command sent by the invoke workload
+constexpr CommandId kBenchCommandId = 1;
+
+// Endpoints of the mock attribute storage; the first one has 2 clusters, and each following one a cluster more
+constexpr EndpointId kMockEndpoints[]         = { Test::kMockEndpoint1, Test::kMockEndpoint2, Test::kMockEndpoint3 };
+constexpr uint16_t kMockFirstEndpointClusters = 2;
+
+bool HandleOption(const char * progName, OptionSet * optSet, int id, const char * name, const char * arg);
+
+// clang-format off
+OptionDef gCmdOptionDefs[] =
+{
+    { "workload",      kArgumentRequired, 'w' },
+    { "iterations",    kArgumentRequired, 'n' },
+    { "batch",         kArgumentRequired, 'b' },
+    { "endpoints",     kArgumentRequired, 'e' },
+    { "subscriptions", kArgumentRequired, 's' },
+    { "dirty-rate",    kArgumentRequired, 'd' },
+    { "output",        kArgumentRequired, 'o' },
+    { }
+};
+
+const char * const gCmdOptionHelp =
+    "   -w, --workload <read | subscribe | invoke | session>\n"
+    "\n"
+    "       Workload to run. Defaults to read.\n"
+    "\n"
+    "   -n, --iterations <count>\n"
+    "\n"
+    "       Number of batches of reads or invokes, of report rounds, or of sessions established. Defaults to 1000.\n"
+    "\n"
+    "   -b, --batch <count>\n"
+    "\n"
+    "       Number of reads or invokes in flight at a time. Defaults to 1.\n"
+    "\n"
+    "   -e, --endpoints <count>\n"
+    "\n"
+    "       Number of mock endpoints read or subscribed to, from 1 to 3. Defaults to 3.\n"
+    "\n"
+    "   -s, --subscriptions <count>\n"
+    "\n"
+    "       Number of subscriptions of the subscribe workload. Defaults to 1.\n"
+    "\n"
+    "   -d, --dirty-rate <count>\n"
+    "\n"
+    "       Number of cluster paths marked dirty per round of the subscribe workload. Defaults to 1.\n"
+    "\n"
+    "   -o, --output <file>\n"
+    "\n"
+    "       Write the JSON results to a file rather than to stdout.\n"
+    "\n"
+    ;
+
+OptionSet gCmdOptions =
+{
+    HandleOption,
+    gCmdOptionDefs,
+    "COMMAND OPTIONS",
+    gCmdOptionHelp
+};
+
+HelpOptions gHelpOptions(
+    TOOL_NAME,
+    "Usage: " TOOL_NAME " [ <options...> ]\n",
+    CHIP_VERSION_STRING "\n" COPYRIGHT_STRING,
+    "Benchmark interaction model workloads over a loopback transport and print the results as JSON."
+);
+
+OptionSet * gCmdOptionSets[] =
+{
+    &gCmdOptions,
+    &gHelpOptions,
+    nullptr
+};
+// clang-format on
+
+enum class Workload
+{
+    kRead,
+    kSubscribe,
+    kInvoke,
+    kSession,
+};
+
+const char * const kWorkloadNames[] = { "read", "subscribe", "invoke", "session" };
+
+Workload gWorkload       = Workload::kRead;
+uint32_t gIterations     = 1000;
+uint16_t gBatchSize      = 1;
+uint16_t gEndpointCount  = ArraySize(kMockEndpoints);
+uint16_t gSubscriptions  = 1;
+uint16_t gDirtyRate      = 1;
+const char * gOutputPath = nullptr;
+
+bool HandleOption(const char * progName, OptionSet * optSet, int id, const char * name, const char * arg)
+{
+    bool valid = true;
+
+    switch (id)
+    {
+    case 'w':
+        valid = false;
+        for (size_t i = 0; i < ArraySize(kWorkloadNames); i++)
+        {
+            if (strcmp(arg, kWorkloadNames[i]) == 0)
+            {
+                gWorkload = static_cast<Workload>(i);
+                valid     = true;
+            }
+        }
+        break;
+    case 'n':
+        valid = ParseInt(arg, gIterations) && gIterations > 0;
+        break;
+    case 'b':
+        valid = ParseInt(arg, gBatchSize) && gBatchSize > 0;
+        break;
+    case 'e':
+        valid = ParseInt(arg, gEndpointCount) && gEndpointCount > 0 && gEndpointCount <= ArraySize(kMockEndpoints);
+        break;
+    case 's':
+        valid = ParseInt(arg, gSubscriptions) && gSubscriptions > 0;
+        break;
+    case 'd':
+        valid = ParseInt(arg, gDirtyRate) && gDirtyRate > 0;
+        break;
+    case 'o':
+        gOutputPath = arg;
+        break;
+    default:
+        PrintArgError("%s: INTERNAL ERROR: Unhandled option: %s\n", progName, name);
+        return false;
+    }
+
+    if (!valid)
+    {
+        PrintArgError("%s: Invalid value specified for %s: %s\n", progName, name, arg);
+    }
+    return valid;
+}
+
+Test::AppContext gContext;
+
+uint64_t NowMicroseconds()
+{
+    return System::SystemClock().GetMonotonicMicroseconds64().count();
+}
+
+struct BenchResult
+{
+    // Latency of each completed operation
+    std::vector<uint64_t> latencies;
+    uint32_t failures       = 0;
+    uint64_t startTime      = 0;
+    uint64_t duration       = 0;
+    uint64_t allocations    = 0;
+    size_t peakReadHandlers = 0;
+
+    void Start()
+    {
+        startTime = NowMicroseconds();
+        gAllocationCount.store(0, std::memory_order_relaxed);
+    }
+
+    void Stop()
+    {
+        duration    = NowMicroseconds() - startTime;
+        allocations = gAllocationCount.load(std::memory_order_relaxed);
+    }
+
+    void SampleReadHandlers()
+    {
+        peakReadHandlers = std::max<size_t>(peakReadHandlers, InteractionModelEngine::GetInstance()->GetNumActiveReadHandlers());
+    }
+};
+
+/**
+ * Run the IO loop until [isDone] returns true, or a round timed out.
+ */
+template <typename Predicate>
+bool DriveIOUntil(Predicate isDone)
+{
+    gContext.DrainAndServiceIO();
+    gContext.GetIOContext().DriveIOUntil(kRoundTimeout, isDone);
+    return isDone();
+}
+
+/// Paths of all the attributes of the mock endpoints benchmarked.
+void FillEndpointPaths(AttributePathParams (&paths)[ArraySize(kMockEndpoints)])
+{
+    for (uint16_t i = 0; i < gEndpointCount; i++)
+    {
+        paths[i].mEndpointId = kMockEndpoints[i];
+    }
+}
+
+class BenchReadClient : public ReadClient::Callback
+{
+public:
+    BenchReadClient(BenchResult & result, ReadClient::InteractionType type) : mResult(result), mType(type) {}
+
+    CHIP_ERROR Send(uint16_t minIntervalFloorSeconds = 0, uint16_t maxIntervalCeilingSeconds = 0)
+    {
+        // A ReadClient only sends one request
+        mClient = Platform::MakeUnique<ReadClient>(InteractionModelEngine::GetInstance(), &gContext.GetExchangeManager(), *this,
+                                                   mType);
+        VerifyOrReturnError(mClient, CHIP_ERROR_NO_MEMORY);
+
+        AttributePathParams paths[ArraySize(kMockEndpoints)];
+        FillEndpointPaths(paths);
+
+        ReadPrepareParams params(gContext.GetSessionBobToAlice());
+        params.mpAttributePathParamsList    = paths;
+        params.mAttributePathParamsListSize = gEndpointCount;
+        params.mMinIntervalFloorSeconds     = minIntervalFloorSeconds;
+        params.mMaxIntervalCeilingSeconds   = maxIntervalCeilingSeconds;
+        params.mKeepSubscriptions           = true;
+
+        mRequestTime = NowMicroseconds();
+        mDone        = false;
+        return mClient->SendRequest(params);
+    }
+
+    /// Start timing the next report.
+    void ExpectReport()
+    {
+        mRequestTime = NowMicroseconds();
+        mGotReport   = false;
+    }
+
+    bool IsDone() const { return mDone; }
+    bool GotReport() const { return mGotReport; }
+    bool IsSubscribed() const { return mSubscribed; }
+
+    void OnReportEnd() override
+    {
+        if (!mGotReport)
+        {
+            mResult.latencies.push_back(NowMicroseconds() - mRequestTime);
+            mGotReport = true;
+        }
+    }
+
+    void OnSubscriptionEstablished(SubscriptionId aSubscriptionId) override { mSubscribed = true; }
+
+    void OnError(CHIP_ERROR aError) override
+    {
+        ChipLogError(DataManagement, "Read failed: %" CHIP_ERROR_FORMAT, aError.Format());
+        mResult.failures++;
+    }
+
+    void OnDone(ReadClient * apReadClient) override { mDone = true; }
+
+private:
+    BenchResult & mResult;
+    const ReadClient::InteractionType mType;
+    Platform::UniquePtr<ReadClient> mClient;
+    uint64_t mRequestTime = 0;
+    bool mDone            = true;
+    bool mGotReport       = false;
+    bool mSubscribed      = false;
+};
+
+CHIP_ERROR RunRead(BenchResult & result)
+{
+    std::vector<Platform::UniquePtr<BenchReadClient>> clients;
+    for (uint16_t i = 0; i < gBatchSize; i++)
+    {
+        clients.push_back(Platform::MakeUnique<BenchReadClient>(result, ReadClient::InteractionType::Read));
+        VerifyOrReturnError(clients.back(), CHIP_ERROR_NO_MEMORY);
+    }
+
+    result.Start();
+    for (uint32_t iteration = 0; iteration < gIterations; iteration++)
+    {
+        for (auto & client : clients)
+        {
+            ReturnErrorOnFailure(client->Send());
+        }
+        result.SampleReadHandlers();
+
+        bool done = DriveIOUntil([&clients]() {
+            return std::all_of(clients.begin(), clients.end(), [](const auto & client) { return client->IsDone(); });
+        });
+        VerifyOrReturnError(done, CHIP_ERROR_TIMEOUT);
+    }
+    result.Stop();
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR RunSubscribe(BenchResult & result)
+{
+    // Cluster paths of the subscribed endpoints, marked dirty in turn
+    std::vector<AttributePathParams> dirtyPaths;
+    for (uint16_t i = 0; i < gEndpointCount; i++)
+    {
+        for (uint16_t cluster = 1; cluster <= i + kMockFirstEndpointClusters; cluster++)
+        {
+            dirtyPaths.emplace_back(kMockEndpoints[i], Test::MockClusterId(cluster));
+        }
+    }
+
+    std::vector<Platform::UniquePtr<BenchReadClient>> clients;
+    for (uint16_t i = 0; i < gSubscriptions; i++)
+    {
+        clients.push_back(Platform::MakeUnique<BenchReadClient>(result, ReadClient::InteractionType::Subscribe));
+        VerifyOrReturnError(clients.back(), CHIP_ERROR_NO_MEMORY);
+        ReturnErrorOnFailure(clients.back()->Send(0, kMaxIntervalCeilingSeconds));
+    }
+
+    bool subscribed = DriveIOUntil([&clients]() {
+        return std::all_of(clients.begin(), clients.end(), [](const auto & client) { return client->IsSubscribed(); });
+    });
+    VerifyOrReturnError(subscribed, CHIP_ERROR_TIMEOUT);
+
+    // The priming reports are not part of the measurement
+    result.latencies.clear();
+    result.SampleReadHandlers();
+
+    auto & reportingEngine = InteractionModelEngine::GetInstance()->GetReportingEngine();
+    size_t nextDirtyPath   = 0;
+
+    result.Start();
+    for (uint32_t round = 0; round < gIterations; round++)
+    {
+        for (auto & client : clients)
+        {
+            client->ExpectReport();
+        }
+
+        Test::BumpVersion();
+        for (uint16_t i = 0; i < gDirtyRate; i++)
+        {
+            ReturnErrorOnFailure(reportingEngine.SetDirty(dirtyPaths[nextDirtyPath]));
+            nextDirtyPath = (nextDirtyPath + 1) % dirtyPaths.size();
+        }
+
+        bool reported = DriveIOUntil([&clients]() {
+            return std::all_of(clients.begin(), clients.end(), [](const auto & client) { return client->GotReport(); });
+        });
+        VerifyOrReturnError(reported, CHIP_ERROR_TIMEOUT);
+    }
+    result.Stop();
+
+    return CHIP_NO_ERROR;
+}
+
+class BenchCommandSender : public CommandSender::Callback
+{
+public:
+    BenchCommandSender(BenchResult & result) : mResult(result) {}
+
+    CHIP_ERROR Send()
+    {
+        mSender = Platform::MakeUnique<CommandSender>(this, &gContext.GetExchangeManager());
+        VerifyOrReturnError(mSender, CHIP_ERROR_NO_MEMORY);
+
+        CommandPathParams path(Test::kMockEndpoint1, /* group id */ 0, Test::MockClusterId(1), kBenchCommandId,
+                               CommandPathFlags::kEndpointIdValid);
+        ReturnErrorOnFailure(mSender->PrepareCommand(path));
+        ReturnErrorOnFailure(mSender->FinishCommand());
+
+        mRequestTime = NowMicroseconds();
+        mDone        = false;
+        return mSender->SendCommandRequest(gContext.GetSessionBobToAlice());
+    }
+
+    bool IsDone() const { return mDone; }
+
+    void OnResponse(CommandSender * apCommandSender, const ConcreteCommandPath & aPath, const StatusIB & aStatusIB,
+                    TLV::TLVReader * apData) override
+    {
+        mResult.latencies.push_back(NowMicroseconds() - mRequestTime);
+    }
+
+    void OnError(const CommandSender * apCommandSender, CHIP_ERROR aError) override
+    {
+        ChipLogError(DataManagement, "Invoke failed: %" CHIP_ERROR_FORMAT, aError.Format());
+        mResult.failures++;
+    }
+
+    void OnDone(CommandSender * apCommandSender) override { mDone = true; }
+
+private:
+    BenchResult & mResult;
+    Platform::UniquePtr<CommandSender> mSender;
+    uint64_t mRequestTime = 0;
+    bool mDone            = true;
+};
+
+CHIP_ERROR RunInvoke(BenchResult & result)
+{
+    std::vector<Platform::UniquePtr<BenchCommandSender>> senders;
+    for (uint16_t i = 0; i < gBatchSize; i++)
+    {
+        senders.push_back(Platform::MakeUnique<BenchCommandSender>(result));
+        VerifyOrReturnError(senders.back(), CHIP_ERROR_NO_MEMORY);
+    }
+
+    result.Start();
+    for (uint32_t iteration = 0; iteration < gIterations; iteration++)
+    {
+        for (auto & sender : senders)
+        {
+            ReturnErrorOnFailure(sender->Send());
+        }
+
+        bool done = DriveIOUntil([&senders]() {
+            return std::all_of(senders.begin(), senders.end(), [](const auto & sender) { return sender->IsDone(); });
+        });
+        VerifyOrReturnError(done, CHIP_ERROR_TIMEOUT);
+    }
+    result.Stop();
+
+    return CHIP_NO_ERROR;
+}
+
+class BenchPairingDelegate : public SessionEstablishmentDelegate
+{
+public:
+    void OnSessionEstablishmentError(CHIP_ERROR error) override { mError = error; }
+
+    void OnSessionEstablished(const SessionHandle & session) override { mSession.Grab(session); }
+
+    bool IsDone() const { return mError != CHIP_NO_ERROR || mSession; }
+    CHIP_ERROR GetError() const { return mError; }
+
+    /// Evict the established session, which the secure session table would otherwise keep.
+    void EvictSession()
+    {
+        if (mSession)
+        {
+            mSession->AsSecureSession()->MarkForEviction();
+        }
+    }
+
+private:
+    SessionHolder mSession;
+    CHIP_ERROR mError = CHIP_NO_ERROR;
+};
+
+/// CASE server of the session workload, which keeps the last session it established.
+class BenchCASEServer : public CASEServer
+{
+public:
+    void OnSessionEstablished(const SessionHandle & session) override
+    {
+        mSession.Grab(session);
+        CASEServer::OnSessionEstablished(session);
+    }
+
+    /// Evict the last established session, which the secure session table would otherwise keep.
+    void EvictSession()
+    {
+        if (mSession)
+        {
+            mSession->AsSecureSession()->MarkForEviction();
+        }
+    }
+
+private:
+    SessionHolder mSession;
+};
+
+/// Give the fabrics of the loopback context the identity protection key CASE derives its destination IDs from.
+CHIP_ERROR SetIdentityProtectionKeys(Credentials::GroupDataProvider & groupDataProvider)
+{
+    using KeySet = Credentials::GroupDataProvider::KeySet;
+
+    KeySet ipkKeySet(Credentials::GroupDataProvider::kIdentityProtectionKeySetId,
+                     Credentials::GroupDataProvider::SecurityPolicy::kTrustFirst, 1);
+    ipkKeySet.ClearKeys();
+
+    for (const FabricInfo * fabricInfo : { gContext.GetAliceFabric(), gContext.GetBobFabric() })
+    {
+        VerifyOrReturnError(fabricInfo != nullptr, CHIP_ERROR_INCORRECT_STATE);
+
+        uint8_t compressedId[sizeof(uint64_t)];
+        MutableByteSpan compressedIdSpan(compressedId);
+        ReturnErrorOnFailure(fabricInfo->GetCompressedFabricIdBytes(compressedIdSpan));
+        ReturnErrorOnFailure(groupDataProvider.SetKeySet(fabricInfo->GetFabricIndex(), compressedIdSpan, ipkKeySet));
+    }
+    return CHIP_NO_ERROR;
+}
+
+/**
+ * Bob establishes CASE sessions with Alice, one after the other. Both have operational certificates of the same test fabric.
+ *
+ * The CASEServer handles one handshake at a time and drops the Sigma1 messages received meanwhile, so there is no concurrent
+ * mode: the establishments of a storm are serialized by the server anyway.
+ */
+CHIP_ERROR RunSession(BenchResult & result)
+{
+    auto & sessionManager = gContext.GetSecureSessionManager();
+    auto & fabricTable    = gContext.GetFabricTable();
+
+    TestPersistentStorageDelegate storage;
+    Credentials::GroupDataProviderImpl groupDataProvider;
+    groupDataProvider.SetStorageDelegate(&storage);
+    ReturnErrorOnFailure(groupDataProvider.Init());
+
+    BenchCASEServer server;
+    CHIP_ERROR err = SetIdentityProtectionKeys(groupDataProvider);
+    SuccessOrExit(err);
+    SuccessOrExit(err = server.ListenForSessionEstablishment(&gContext.GetExchangeManager(), &sessionManager, &fabricTable,
+                                                             nullptr, nullptr, &groupDataProvider));
+
+    result.Start();
+    for (uint32_t iteration = 0; iteration < gIterations; iteration++)
+    {
+        CASESession initiator;
+        BenchPairingDelegate initiatorDelegate;
+        initiator.SetGroupDataProvider(&groupDataProvider);
+
+        const uint64_t startTime = NowMicroseconds();
+
+        Messaging::ExchangeContext * exchange = gContext.NewUnauthenticatedExchangeToAlice(&initiator);
+        VerifyOrExit(exchange != nullptr, err = CHIP_ERROR_NO_MEMORY);
+        SuccessOrExit(err = initiator.EstablishSession(sessionManager, &fabricTable,
+                                                       ScopedNodeId(gContext.GetAliceFabric()->GetNodeId(),
+                                                                    gContext.GetBobFabricIndex()),
+                                                       exchange, nullptr, nullptr, &initiatorDelegate,
+                                                       Optional<ReliableMessageProtocolConfig>::Missing()));
+
+        // The initiator is done last, once the responder acknowledged Sigma3
+        VerifyOrExit(DriveIOUntil([&initiatorDelegate]() { return initiatorDelegate.IsDone(); }), err = CHIP_ERROR_TIMEOUT);
+
+        if (initiatorDelegate.GetError() == CHIP_NO_ERROR)
+        {
+            result.latencies.push_back(NowMicroseconds() - startTime);
+        }
+        else
+        {
+            result.failures++;
+        }
+
+        initiatorDelegate.EvictSession();
+        server.EvictSession();
+        gContext.DrainAndServiceIO();
+    }
+    result.Stop();
+
+exit:
+    server.Shutdown();
+    groupDataProvider.Finish();
+    return err;
+}
+
+/// Latency of the given percentile, by the nearest-rank method.
+uint64_t Percentile(const std::vector<uint64_t> & sortedLatencies, unsigned percentile)
+{
+    VerifyOrReturnValue(!sortedLatencies.empty(), 0);
+    size_t rank = (sortedLatencies.size() * percentile + 99) / 100;
+    return sortedLatencies[std::max<size_t>(rank, 1) - 1];
+}
+
+void PrintResult(FILE * out, BenchResult & result)
+{
+    std::sort(result.latencies.begin(), result.latencies.end());
+    const uint64_t operations = result.latencies.size();
+    const uint64_t duration   = std::max<uint64_t>(result.duration, 1);
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"workload\": \"%s\",\n", kWorkloadNames[static_cast<size_t>(gWorkload)]);
+    fprintf(out,
+            "  \"parameters\": { \"iterations\": %" PRIu32 ", \"batch\": %u, \"endpoints\": %u, \"subscriptions\": %u, "
+            "\"dirty_rate\": %u },\n",
+            gIterations, gBatchSize, gEndpointCount, gSubscriptions, gDirtyRate);
+    fprintf(out, "  \"operations\": %" PRIu64 ",\n", operations);
+    fprintf(out, "  \"failures\": %" PRIu32 ",\n", result.failures);
+    fprintf(out, "  \"duration_us\": %" PRIu64 ",\n", result.duration);
+    fprintf(out, "  \"throughput_ops_per_s\": %.1f,\n", static_cast<double>(operations) * 1e6 / static_cast<double>(duration));
+    fprintf(out, "  \"latency_us\": { \"p50\": %" PRIu64 ", \"p99\": %" PRIu64 ", \"max\": %" PRIu64 " },\n",
+            Percentile(result.latencies, 50), Percentile(result.latencies, 99), Percentile(result.latencies, 100));
+#if CHIP_IM_BENCH_COUNT_ALLOCATIONS
+    fprintf(out, "  \"allocations\": { \"total\": %" PRIu64 ", \"per_operation\": %.1f },\n", result.allocations,
+            static_cast<double>(result.allocations) / static_cast<double>(std::max<uint64_t>(operations, 1)));
+#else
+    fprintf(out, "  \"allocations\": null,\n");
+#endif
+    fprintf(out, "  \"peak_pool_usage\": {\n");
+    fprintf(out, "    \"exchanges\": %zu,\n", gContext.GetExchangeManager().GetPeakActiveExchanges());
+#if CHIP_SYSTEM_CONFIG_PROVIDE_STATISTICS
+    const System::Stats::Label * labels       = System::Stats::GetStrings();
+    const System::Stats::count_t * watermarks = System::Stats::GetHighWatermarks();
+    for (int i = 0; i < System::Stats::kNumEntries; i++)
+    {
+        fprintf(out, "    \"%s\": %d,\n", labels[i], watermarks[i]);
+    }
+#endif
+    fprintf(out, "    \"read_handlers\": %zu\n", result.peakReadHandlers);
+    fprintf(out, "  }\n");
+    fprintf(out, "}\n");
+}
+
+} // namespace
+
+namespace chip {
+namespace app {
+
+Protocols::InteractionModel::Status ServerClusterCommandExists(const ConcreteCommandPath & aCommandPath)
+{
+    return aCommandPath.mEndpointId >= Test::kMockEndpointMin ? Protocols::InteractionModel::Status::Success
+                                                              : Protocols::InteractionModel::Status::UnsupportedEndpoint;
+}
+
+void DispatchSingleClusterCommand(const ConcreteCommandPath & aCommandPath, chip::TLV::TLVReader & aReader,
+                                  CommandHandler * apCommandObj)
+{
+    apCommandObj->AddStatus(aCommandPath, Protocols::InteractionModel::Status::Success);
+}
+
+CHIP_ERROR ReadSingleClusterData(const Access::SubjectDescriptor & aSubjectDescriptor, bool aIsFabricFiltered,
+                                 const ConcreteReadAttributePath & aPath, AttributeReportIBs::Builder & aAttributeReports,
+                                 AttributeValueEncoder::AttributeEncodeState * apEncoderState)
+{
+    return Test::ReadSingleMockClusterData(aSubjectDescriptor.fabricIndex, aPath, aAttributeReports, apEncoderState);
+}
+
+const EmberAfAttributeMetadata * GetAttributeMetadata(const ConcreteAttributePath & aConcreteClusterPath)
+{
+    // Note: The benchmark does not make use of the real attribute metadata.
+    static EmberAfAttributeMetadata stub = { .defaultValue = EmberAfDefaultOrMinMaxAttributeValue(uint32_t(0)) };
+    return &stub;
+}
+
+bool ConcreteAttributePathExists(const ConcreteAttributePath & aPath)
+{
+    return true;
+}
+
+CHIP_ERROR WriteSingleClusterData(const Access::SubjectDescriptor & aSubjectDescriptor, const ConcreteDataAttributePath & aPath,
+                                  TLV::TLVReader & aReader, WriteHandler *)
+{
+    return CHIP_ERROR_UNSUPPORTED_CHIP_FEATURE;
+}
+
+bool IsClusterDataVersionEqual(const ConcreteClusterPath & aConcreteClusterPath, DataVersion aRequiredVersion)
+{
+    return Test::GetVersion() == aRequiredVersion;
+}
+
+bool IsDeviceTypeOnEndpoint(DeviceTypeId deviceType, EndpointId endpoint)
+{
+    return false;
+}
+
+} // namespace app
+} // namespace chip
+
+int main(int argc, char * argv[])
+{
+    if (!ParseArgs(TOOL_NAME, argc, argv, gCmdOptionSets))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // The interaction model logs every message.
+    Logging::SetLogFilter(Logging::kLogCategory_Error);
+
+    CHIP_ERROR err = gContext.Init();
+    if (err != CHIP_NO_ERROR)
+    {
+        fprintf(stderr, "Failed to initialize the loopback context: %" CHIP_ERROR_FORMAT "\n", err.Format());
+        return EXIT_FAILURE;
+    }
+
+    BenchResult result;
+    switch (gWorkload)
+    {
+    case Workload::kRead:
+        err = RunRead(result);
+        break;
+    case Workload::kSubscribe:
+        err = RunSubscribe(result);
+        break;
+    case Workload::kInvoke:
+        err = RunInvoke(result);
+        break;
+    case Workload::kSession:
+        err = RunSession(result);
+        break;
+    }
+
+    int status = EXIT_SUCCESS;
+    if (err != CHIP_NO_ERROR)
+    {
+        fprintf(stderr, "The %s workload failed: %" CHIP_ERROR_FORMAT "\n", kWorkloadNames[static_cast<size_t>(gWorkload)],
+                err.Format());
+        status = EXIT_FAILURE;
+    }
+    else
+    {
+        FILE * out = gOutputPath != nullptr ? fopen(gOutputPath, "w") : stdout;
+        if (out == nullptr)
+        {
+            fprintf(stderr, "Failed to open %s\n", gOutputPath);
+            status = EXIT_FAILURE;
+        }
+        else
+        {
+            PrintResult(out, result);
+            if (out != stdout)
+            {
+                fclose(out);
+            }
+        }
+    }
+
+    gContext.Shutdown();
+    return status;
+}
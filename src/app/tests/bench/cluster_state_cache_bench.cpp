@@ -0,0 +1,255 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements chip-cluster-state-cache-bench, which measures the time taken by a ClusterStateCache to absorb a
+ *      priming report for a large node, a series of subscription reports updating it, and the lookups an application makes
+ *      afterwards.
+ *
+ *      Every endpoint of the report holds two attributes of the test cluster: an integer and a list of 16 structs.
+ */
+
+#include <CHIPVersion.h>
+#include <app-common/zap-generated/cluster-objects.h>
+#include <app/ClusterStateCache.h>
+#include <app/data-model/Encode.h>
+#include <lib/support/CHIPArgParser.hpp>
+#include <lib/support/CHIPMem.h>
+#include <lib/support/CodeUtils.h>
+#include <lib/support/logging/CHIPLogging.h>
+#include <system/SystemClock.h>
+
+#include <algorithm>
+#include <inttypes.h>
+#include <stdio.h>
+
+namespace {
+
+using namespace chip;
+using namespace chip::app;
+using namespace chip::ArgParser;
+
+#define TOOL_NAME "chip-cluster-state-cache-bench"
+#define COPYRIGHT_STRING "Copyright (c) 2022 Project CHIP Authors.\nAll rights reserved.\n"
+
+bool HandleOption(const char * progName, OptionSet * optSet, int id, const char * name, const char * arg);
+
+// clang-format off
+OptionDef gCmdOptionDefs[] =
+{
+    { "endpoints",     kArgumentRequired, 'e' },
+    { "reports",       kArgumentRequired, 'r' },
+    { }
+};
+
+const char * const gCmdOptionHelp =
+    "   -e, --endpoints <count>\n"
+    "\n"
+    "       Number of endpoints of the node. Defaults to 200.\n"
+    "\n"
+    "   -r, --reports <count>\n"
+    "\n"
+    "       Number of subscription reports after the priming report, each updating a tenth of the endpoints.\n"
+    "       Defaults to 50.\n"
+    "\n"
+    ;
+
+OptionSet gCmdOptions =
+{
+    HandleOption,
+    gCmdOptionDefs,
+    "COMMAND OPTIONS",
+    gCmdOptionHelp
+};
+
+HelpOptions gHelpOptions(
+    TOOL_NAME,
+    "Usage: " TOOL_NAME " [ <options...> ]\n",
+    CHIP_VERSION_STRING "\n" COPYRIGHT_STRING,
+    "Measure the storage of reports and the lookups of attributes by a ClusterStateCache."
+);
+
+OptionSet * gCmdOptionSets[] =
+{
+    &gCmdOptions,
+    &gHelpOptions,
+    nullptr
+};
+// clang-format on
+
+uint16_t gEndpointCount = 200;
+uint16_t gReportCount   = 50;
+
+bool HandleOption(const char * progName, OptionSet * optSet, int id, const char * name, const char * arg)
+{
+    bool valid = true;
+
+    switch (id)
+    {
+    case 'e':
+        // Endpoint kInvalidEndpointId is not usable
+        valid = ParseInt(arg, gEndpointCount) && gEndpointCount > 0 && gEndpointCount < kInvalidEndpointId;
+        break;
+    case 'r':
+        valid = ParseInt(arg, gReportCount);
+        break;
+    default:
+        PrintArgError("%s: INTERNAL ERROR: Unhandled option: %s\n", progName, name);
+        return false;
+    }
+
+    if (!valid)
+    {
+        PrintArgError("%s: Invalid value specified for %s: %s\n", progName, name, arg);
+    }
+    return valid;
+}
+
+class NullCacheCallback : public ClusterStateCache::Callback
+{
+    void OnDone(ReadClient *) override {}
+};
+
+uint64_t NowUs()
+{
+    return System::SystemClock().GetMonotonicMicroseconds64().count();
+}
+
+//
+// Send a report for the int16u and list attributes of the test cluster on the given endpoints, wrapping around the end of
+// the node, through the buffered callback of the cache.
+//
+CHIP_ERROR GenerateReport(ReadClient::Callback & callback, EndpointId firstEndpoint, EndpointId endpointCount, uint16_t value)
+{
+    using namespace Clusters::TestCluster;
+
+    StatusIB status;
+    callback.OnReportBegin();
+
+    for (EndpointId i = 0; i < endpointCount; i++)
+    {
+        const auto endpointId = static_cast<EndpointId>((firstEndpoint + i) % gEndpointCount);
+        for (AttributeId attributeId : { Attributes::Int16u::Id, Attributes::ListStructOctetString::Id })
+        {
+            ConcreteDataAttributePath path(endpointId, Id, attributeId);
+            path.mDataVersion.SetValue(value);
+
+            uint8_t buffer[1024];
+            TLV::TLVWriter writer;
+            writer.Init(buffer);
+
+            if (attributeId == Attributes::Int16u::Id)
+            {
+                ReturnErrorOnFailure(DataModel::Encode(writer, TLV::AnonymousTag(), value));
+            }
+            else
+            {
+                Structs::TestListStructOctet::Type items[16];
+                for (auto & item : items)
+                {
+                    item.member1 = value;
+                }
+                Attributes::ListStructOctetString::TypeInfo::Type list;
+                list         = items;
+                path.mListOp = ConcreteDataAttributePath::ListOperation::ReplaceAll;
+                ReturnErrorOnFailure(DataModel::Encode(writer, TLV::AnonymousTag(), list));
+            }
+
+            TLV::TLVReader reader;
+            reader.Init(buffer, writer.GetLengthWritten());
+            ReturnErrorOnFailure(reader.Next());
+            callback.OnAttributeData(path, &reader, status);
+        }
+    }
+
+    callback.OnReportEnd();
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR RunBench()
+{
+    NullCacheCallback callback;
+    ClusterStateCache cache(callback);
+
+    const uint64_t start = NowUs();
+    ReturnErrorOnFailure(GenerateReport(cache.GetBufferedCallback(), 0, gEndpointCount, 0));
+    const uint64_t primed = NowUs();
+
+    // Each report updates a tenth of the endpoints
+    const auto updatedCount = static_cast<EndpointId>(std::max(gEndpointCount / 10, 1));
+    for (uint16_t value = 1; value <= gReportCount; value++)
+    {
+        ReturnErrorOnFailure(GenerateReport(cache.GetBufferedCallback(),
+                                            static_cast<EndpointId>((value * updatedCount) % gEndpointCount), updatedCount,
+                                            value));
+    }
+    const uint64_t updated = NowUs();
+
+    uint32_t attributeCount = 0;
+    for (EndpointId endpointId = 0; endpointId < gEndpointCount; endpointId++)
+    {
+        ReturnErrorOnFailure(
+            cache.ForEachAttribute(endpointId, Clusters::TestCluster::Id, [&](const ConcreteAttributePath & path) {
+                TLV::TLVReader reader;
+                attributeCount++;
+                return cache.Get(path, reader);
+            }));
+    }
+    const uint64_t iterated = NowUs();
+    VerifyOrReturnError(attributeCount == 2u * gEndpointCount, CHIP_ERROR_INTERNAL);
+
+    printf("%-28s %12s %14s\n", "phase", "time (us)", "us/attribute");
+    printf("%-28s %12" PRIu64 " %14.2f\n", "priming report", primed - start,
+           static_cast<double>(primed - start) / (2u * gEndpointCount));
+    printf("%-28s %12" PRIu64 " %14.2f\n", "update reports", updated - primed,
+           gReportCount == 0 ? 0.0 : static_cast<double>(updated - primed) / (2u * updatedCount * gReportCount));
+    printf("%-28s %12" PRIu64 " %14.2f\n", "attribute lookups", iterated - updated,
+           static_cast<double>(iterated - updated) / attributeCount);
+    printf("%-28s %12zu\n", "reclaimable bytes", cache.GetReclaimableSize());
+    return CHIP_NO_ERROR;
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    if (!ParseArgs(TOOL_NAME, argc, argv, gCmdOptionSets))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (Platform::MemoryInit() != CHIP_NO_ERROR)
+    {
+        fprintf(stderr, "Failed to initialize the memory\n");
+        return EXIT_FAILURE;
+    }
+
+    // Keep logging out of the measured phases.
+    Logging::SetLogFilter(Logging::kLogCategory_Error);
+
+    int status     = EXIT_SUCCESS;
+    CHIP_ERROR err = RunBench();
+    if (err != CHIP_NO_ERROR)
+    {
+        printf("Failed: %" CHIP_ERROR_FORMAT "\n", err.Format());
+        status = EXIT_FAILURE;
+    }
+
+    Platform::MemoryShutdown();
+    return status;
+}
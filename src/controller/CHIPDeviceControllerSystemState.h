@@ -40,6 +40,9 @@
 #include <protocols/secure_channel/UnsolicitedStatusHandler.h>
 
 #include <transport/TransportMgr.h>
+#if INET_CONFIG_ENABLE_TCP_ENDPOINT && CHIP_CONFIG_ENABLE_TCP_TRANSPORT
+#include <transport/raw/TCP.h>
+#endif
 #include <transport/raw/UDP.h>
 #if CONFIG_DEVICE_LAYER
 #include <platform/CHIPDeviceLayer.h>
@@ -62,6 +65,11 @@ using DeviceTransportMgr = TransportMgr<Transport::UDP /* IPv6 */
 #if CONFIG_NETWORK_LAYER_BLE
                                         ,
                                         Transport::BLE<kMaxDeviceTransportBlePendingPackets> /* BLE */
+#endif
+#if INET_CONFIG_ENABLE_TCP_ENDPOINT && CHIP_CONFIG_ENABLE_TCP_TRANSPORT
+                                        ,
+                                        Transport::TCP<CHIP_CONFIG_MAX_ACTIVE_TCP_CONNECTIONS,
+                                                       CHIP_CONFIG_MAX_TCP_PENDING_PACKETS> /* TCP */
 #endif
                                         >;
 
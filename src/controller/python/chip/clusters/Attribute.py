@@ -23,7 +23,7 @@ from asyncio.futures import Future
 import ctypes
 from dataclasses import dataclass, field
 from typing import Tuple, Type, Union, List, Any, Callable, Dict, Set
-from ctypes import CFUNCTYPE, c_char_p, c_size_t, c_void_p, c_uint64, c_uint32,  c_uint16, c_uint8, py_object, c_uint64
+from ctypes import CFUNCTYPE, POINTER, c_char_p, c_size_t, c_void_p, c_uint64, c_uint32,  c_uint16, c_uint8, py_object, c_uint64
 import construct
 from rich.pretty import pprint
 
@@ -38,6 +38,10 @@ import logging
 import threading
 import builtins
 
+# Attribute reports are decoded by the native library, Python only builds the
+# resulting objects. Set to False to decode them with chip.tlv.TLVReader instead.
+NativeTLVDecode = True
+
 
 @unique
 class EventTimestampType(Enum):
@@ -648,7 +652,9 @@ class AsyncReadTransaction:
     def GetAllEventValues(self):
         return self._events
 
-    def handleAttributeData(self, path: AttributePathWithListIndex, dataVersion: int, status: int, data: bytes):
+    def handleAttributeData(self, path: AttributePathWithListIndex, dataVersion: int, status: int, data: bytes, elements=None, elementCount: int = 0):
+        ''' elements, if given, are the FlatTLVElements of data decoded by the native library.
+        '''
         try:
             imStatus = status
             try:
@@ -659,6 +665,8 @@ class AsyncReadTransaction:
             if (imStatus != chip.interaction_model.Status.Success):
                 attributeValue = ValueDecodeFailure(
                     None, chip.interaction_model.InteractionModelError(imStatus))
+            elif elements is not None and NativeTLVDecode:
+                attributeValue = chip.tlv.FlatTLVReader(elements, elementCount, data).get().get("Any", {})
             else:
                 tlvData = chip.tlv.TLVReader(data).get().get("Any", {})
                 attributeValue = tlvData
@@ -826,7 +834,7 @@ class AsyncWriteTransaction:
 
 
 _OnReadAttributeDataCallbackFunct = CFUNCTYPE(
-    None, py_object, c_uint32, c_uint16, c_uint32, c_uint32, c_uint8, c_void_p, c_size_t)
+    None, py_object, c_uint32, c_uint16, c_uint32, c_uint32, c_uint8, c_void_p, c_size_t, POINTER(chip.tlv.FlatTLVElement), c_uint32)
 _OnSubscriptionEstablishedCallbackFunct = CFUNCTYPE(None, py_object, c_uint32)
 _OnResubscriptionAttemptedCallbackFunct = CFUNCTYPE(None, py_object, c_uint32, c_uint32)
 _OnReadEventDataCallbackFunct = CFUNCTYPE(
@@ -842,10 +850,11 @@ _OnReportEndCallbackFunct = CFUNCTYPE(
 
 
 @_OnReadAttributeDataCallbackFunct
-def _OnReadAttributeDataCallback(closure, dataVersion: int, endpoint: int, cluster: int, attribute: int, status, data, len):
+def _OnReadAttributeDataCallback(closure, dataVersion: int, endpoint: int, cluster: int, attribute: int, status, data, len, elements, elementCount: int):
     dataBytes = ctypes.string_at(data, len)
+    # elements are only valid during the callback
     closure.handleAttributeData(AttributePath(
-        EndpointId=endpoint, ClusterId=cluster, AttributeId=attribute), dataVersion, status, dataBytes[:])
+        EndpointId=endpoint, ClusterId=cluster, AttributeId=attribute), dataVersion, status, dataBytes[:], elements, elementCount)
 
 
 @_OnReadEventDataCallbackFunct
@@ -1060,6 +1069,20 @@ def ReadEvents(future: Future, eventLoop, device, devCtrl, events: List[EventPat
     return Read(future=future, eventLoop=eventLoop, device=device, devCtrl=devCtrl, attributes=None, dataVersionFilters=None, events=events, returnClusterObject=returnClusterObject, subscriptionParameters=subscriptionParameters, fabricFiltered=fabricFiltered)
 
 
+def DecodeTLV(data: bytes):
+    ''' Decodes TLV with the native library, returning the same representation as chip.tlv.TLVReader(data).get().
+    '''
+    handle = chip.native.GetLibraryHandle()
+
+    # Every element takes at least one byte of TLV
+    elements = (chip.tlv.FlatTLVElement * max(len(data), 1))()
+    elementCount = c_uint32(0)
+    res = handle.pychip_TLV_DecodeFlat(data, len(data), elements, len(elements), ctypes.byref(elementCount))
+    if res != 0:
+        raise chip.exceptions.ChipStackError(res)
+    return chip.tlv.FlatTLVReader(elements, elementCount.value, data).get()
+
+
 def Init():
     handle = chip.native.GetLibraryHandle()
 
@@ -1075,6 +1098,8 @@ def Init():
         setter.Set('pychip_ReadClient_InitCallbacks', None, [
                    _OnReadAttributeDataCallbackFunct, _OnReadEventDataCallbackFunct, _OnSubscriptionEstablishedCallbackFunct, _OnResubscriptionAttemptedCallbackFunct, _OnReadErrorCallbackFunct, _OnReadDoneCallbackFunct,
                    _OnReportBeginCallbackFunct, _OnReportEndCallbackFunct])
+        setter.Set('pychip_TLV_DecodeFlat', c_uint32, [
+                   c_char_p, c_uint32, POINTER(chip.tlv.FlatTLVElement), c_uint32, POINTER(c_uint32)])
 
     handle.pychip_WriteClient_InitCallbacks(
         _OnWriteResponseCallback, _OnWriteErrorCallback, _OnWriteDoneCallback)
@@ -65,10 +65,185 @@ struct __attribute__((packed)) DataVersionFilter
     chip::DataVersion dataVersion;
 };
 
+// A TLV element decoded for Python, see FlatTLVElement in chip/tlv/__init__.py. Elements are stored in pre-order: the
+// elements of a container follow it, up to index `end`.
+struct __attribute__((packed)) FlatTLVElement
+{
+    enum Kind : uint8_t
+    {
+        kNull = 0,
+        kBoolean,
+        kSignedInteger,
+        kUnsignedInteger,
+        kFloat32,
+        kFloat64,
+        kUTF8String,
+        kByteString,
+        kStructure,
+        kArray,
+        kList,
+    };
+
+    enum TagKind : uint8_t
+    {
+        kAnonymous = 0,
+        kContext,
+        kCommonProfile,
+        kImplicitProfile,
+        kFullyQualified,
+    };
+
+    uint8_t kind;
+    uint8_t tagKind;
+    uint32_t profileId;
+    uint32_t tagNumber;
+    uint32_t end;    // containers: index following their last element
+    uint32_t length; // strings: length of the data
+    uint64_t value;  // integers and booleans: the value, floats: the bits of the double, strings: offset of the data
+};
+
+// Implicit profile tags keep their tag number when read with a known implicit profile
+constexpr uint32_t kFlatTLVImplicitProfileId = 0xFFFFFFFE;
+
+CHIP_ERROR DecodeFlatTLVElement(TLV::TLVReader & reader, const uint8_t * tlv, FlatTLVElement * elements, uint32_t capacity,
+                                uint32_t & count);
+
+// Decodes the elements of the container the reader is positioned on, whose element was just added
+CHIP_ERROR DecodeFlatTLVContainer(TLV::TLVReader & reader, const uint8_t * tlv, FlatTLVElement * elements, uint32_t capacity,
+                                  uint32_t & count)
+{
+    const uint32_t index = count - 1;
+
+    TLV::TLVType containerType;
+    ReturnErrorOnFailure(reader.EnterContainer(containerType));
+    CHIP_ERROR err;
+    while ((err = reader.Next()) == CHIP_NO_ERROR)
+    {
+        ReturnErrorOnFailure(DecodeFlatTLVElement(reader, tlv, elements, capacity, count));
+    }
+    VerifyOrReturnError(err == CHIP_END_OF_TLV, err);
+    ReturnErrorOnFailure(reader.ExitContainer(containerType));
+
+    elements[index].end = count;
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR DecodeFlatTLVElement(TLV::TLVReader & reader, const uint8_t * tlv, FlatTLVElement * elements, uint32_t capacity,
+                                uint32_t & count)
+{
+    VerifyOrReturnError(count < capacity, CHIP_ERROR_BUFFER_TOO_SMALL);
+    FlatTLVElement & element = elements[count++];
+    element                  = {};
+
+    const TLV::Tag tag = reader.GetTag();
+    switch (static_cast<TLV::TLVTagControl>(reader.GetControlByte() & TLV::kTLVTagControlMask))
+    {
+    case TLV::TLVTagControl::Anonymous:
+        element.tagKind = FlatTLVElement::kAnonymous;
+        break;
+    case TLV::TLVTagControl::ContextSpecific:
+        element.tagKind = FlatTLVElement::kContext;
+        break;
+    case TLV::TLVTagControl::CommonProfile_2Bytes:
+    case TLV::TLVTagControl::CommonProfile_4Bytes:
+        element.tagKind = FlatTLVElement::kCommonProfile;
+        break;
+    case TLV::TLVTagControl::ImplicitProfile_2Bytes:
+    case TLV::TLVTagControl::ImplicitProfile_4Bytes:
+        element.tagKind = FlatTLVElement::kImplicitProfile;
+        break;
+    default:
+        element.tagKind   = FlatTLVElement::kFullyQualified;
+        element.profileId = TLV::ProfileIdFromTag(tag);
+        break;
+    }
+    if (element.tagKind != FlatTLVElement::kAnonymous)
+    {
+        element.tagNumber = TLV::TagNumFromTag(tag);
+    }
+
+    switch (reader.GetType())
+    {
+    case TLV::kTLVType_Null:
+        element.kind = FlatTLVElement::kNull;
+        break;
+    case TLV::kTLVType_Boolean: {
+        bool value;
+        ReturnErrorOnFailure(reader.Get(value));
+        element.kind  = FlatTLVElement::kBoolean;
+        element.value = value ? 1 : 0;
+        break;
+    }
+    case TLV::kTLVType_SignedInteger: {
+        int64_t value;
+        ReturnErrorOnFailure(reader.Get(value));
+        element.kind  = FlatTLVElement::kSignedInteger;
+        element.value = static_cast<uint64_t>(value);
+        break;
+    }
+    case TLV::kTLVType_UnsignedInteger: {
+        uint64_t value;
+        ReturnErrorOnFailure(reader.Get(value));
+        element.kind  = FlatTLVElement::kUnsignedInteger;
+        element.value = value;
+        break;
+    }
+    case TLV::kTLVType_FloatingPointNumber: {
+        const bool isFloat32 = (reader.GetControlByte() & TLV::kTLVTypeMask) ==
+            static_cast<uint8_t>(TLV::TLVElementType::FloatingPointNumber32);
+        double value;
+        ReturnErrorOnFailure(reader.Get(value));
+        element.kind = isFloat32 ? FlatTLVElement::kFloat32 : FlatTLVElement::kFloat64;
+        memcpy(&element.value, &value, sizeof(value));
+        break;
+    }
+    case TLV::kTLVType_UTF8String:
+    case TLV::kTLVType_ByteString: {
+        const uint8_t * data = nullptr;
+        ReturnErrorOnFailure(reader.GetDataPtr(data));
+        element.kind   = (reader.GetType() == TLV::kTLVType_UTF8String) ? FlatTLVElement::kUTF8String : FlatTLVElement::kByteString;
+        element.length = reader.GetLength();
+        element.value  = (data == nullptr) ? 0 : static_cast<uint64_t>(data - tlv);
+        break;
+    }
+    case TLV::kTLVType_Structure:
+        element.kind = FlatTLVElement::kStructure;
+        return DecodeFlatTLVContainer(reader, tlv, elements, capacity, count);
+    case TLV::kTLVType_Array:
+        element.kind = FlatTLVElement::kArray;
+        return DecodeFlatTLVContainer(reader, tlv, elements, capacity, count);
+    case TLV::kTLVType_List:
+        element.kind = FlatTLVElement::kList;
+        return DecodeFlatTLVContainer(reader, tlv, elements, capacity, count);
+    default:
+        return CHIP_ERROR_WRONG_TLV_TYPE;
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+// Decodes the elements of [tlv] into [elements]. Every element takes at least one byte of TLV, so a capacity of tlvLen elements
+// is always enough.
+CHIP_ERROR DecodeFlatTLV(const uint8_t * tlv, uint32_t tlvLen, FlatTLVElement * elements, uint32_t capacity, uint32_t & count)
+{
+    TLV::TLVReader reader;
+    reader.Init(tlv, tlvLen);
+    reader.ImplicitProfileId = kFlatTLVImplicitProfileId;
+
+    count = 0;
+    CHIP_ERROR err;
+    while ((err = reader.Next()) == CHIP_NO_ERROR)
+    {
+        ReturnErrorOnFailure(DecodeFlatTLVElement(reader, tlv, elements, capacity, count));
+    }
+    VerifyOrReturnError(err == CHIP_END_OF_TLV, err);
+    return CHIP_NO_ERROR;
+}
+
 using OnReadAttributeDataCallback       = void (*)(PyObject * appContext, chip::DataVersion version, chip::EndpointId endpointId,
                                              chip::ClusterId clusterId, chip::AttributeId attributeId,
                                              std::underlying_type_t<Protocols::InteractionModel::Status> imstatus, uint8_t * data,
-                                             uint32_t dataLen);
+                                             uint32_t dataLen, const FlatTLVElement * elements, uint32_t elementCount);
 using OnReadEventDataCallback           = void (*)(PyObject * appContext, chip::EndpointId endpointId, chip::ClusterId clusterId,
                                          chip::EventId eventId, chip::EventNumber eventNumber, uint8_t priority, uint64_t timestamp,
                                          uint8_t timestampType, uint8_t * data, uint32_t dataLen,
@@ -112,6 +287,8 @@ public:
         size_t bufferLen                  = (apData == nullptr ? 0 : apData->GetRemainingLength() + apData->GetLengthRead());
         std::unique_ptr<uint8_t[]> buffer = std::unique_ptr<uint8_t[]>(apData == nullptr ? nullptr : new uint8_t[bufferLen]);
         uint32_t size                     = 0;
+        std::unique_ptr<FlatTLVElement[]> elements;
+        uint32_t elementCount = 0;
         // When the apData is nullptr, means we did not receive a valid attribute data from server, status will be some error
         // status.
         if (apData != nullptr)
@@ -128,6 +305,15 @@ public:
                 return;
             }
             size = writer.GetLengthWritten();
+
+            // Decoded here so that Python only builds the final objects
+            elements = std::unique_ptr<FlatTLVElement[]>(new FlatTLVElement[size]);
+            err      = DecodeFlatTLV(buffer.get(), size, elements.get(), size, elementCount);
+            if (err != CHIP_NO_ERROR)
+            {
+                this->OnError(err);
+                return;
+            }
         }
 
         DataVersion version = 0;
@@ -137,7 +323,7 @@ public:
         }
 
         gOnReadAttributeDataCallback(mAppContext, version, aPath.mEndpointId, aPath.mClusterId, aPath.mAttributeId,
-                                     to_underlying(aStatus.mStatus), buffer.get(), size);
+                                     to_underlying(aStatus.mStatus), buffer.get(), size, elements.get(), elementCount);
     }
 
     void OnSubscriptionEstablished(SubscriptionId aSubscriptionId) override
@@ -498,4 +684,12 @@ exit:
     va_end(args);
     return err.AsInteger();
 }
+
+// Decodes TLV for Python without a read interaction, e.g. to benchmark the decoding of a report.
+chip::ChipError::StorageType pychip_TLV_DecodeFlat(const uint8_t * tlv, uint32_t tlvLen, FlatTLVElement * elements,
+                                                   uint32_t capacity, uint32_t * elementCount)
+{
+    VerifyOrReturnError(elementCount != nullptr, CHIP_ERROR_INVALID_ARGUMENT.AsInteger());
+    return DecodeFlatTLV(tlv, tlvLen, elements, capacity, *elementCount).AsInteger();
+}
 }
@@ -28,6 +28,7 @@
 from __future__ import absolute_import
 from __future__ import print_function
 
+import ctypes
 import struct
 from collections import OrderedDict
 from collections.abc import Mapping, Sequence
@@ -689,6 +690,121 @@ class TLVReader(object):
                     raise ValueError("Attempt to decode unsupported TLV tag")
 
 
+class FlatTLVElement(ctypes.Structure):
+    """A TLV element decoded by the native library (see FlatTLVElement in
+    chip/clusters/attribute.cpp).
+
+    Elements are stored in pre-order: the elements of a container follow it,
+    up to the index in `end`."""
+    _pack_ = 1
+    _fields_ = [
+        ("kind", ctypes.c_uint8),
+        ("tagKind", ctypes.c_uint8),
+        ("profileId", ctypes.c_uint32),
+        ("tagNumber", ctypes.c_uint32),
+        ("end", ctypes.c_uint32),
+        ("length", ctypes.c_uint32),
+        ("value", ctypes.c_uint64),
+    ]
+
+    KIND_NULL = 0
+    KIND_BOOLEAN = 1
+    KIND_SIGNED_INTEGER = 2
+    KIND_UNSIGNED_INTEGER = 3
+    KIND_FLOAT32 = 4
+    KIND_FLOAT64 = 5
+    KIND_UTF8_STRING = 6
+    KIND_BYTE_STRING = 7
+    KIND_STRUCTURE = 8
+    KIND_ARRAY = 9
+    KIND_LIST = 10
+
+    TAG_ANONYMOUS = 0
+    TAG_CONTEXT = 1
+    TAG_COMMON_PROFILE = 2
+    TAG_IMPLICIT_PROFILE = 3
+    TAG_FULLY_QUALIFIED = 4
+
+
+_FlatTLVDoubleBits = struct.Struct("<Q")
+_FlatTLVDouble = struct.Struct("<d")
+
+
+class FlatTLVReader(object):
+    """Builds the same representation as TLVReader.get() from TLV decoded by the
+    native library, so that Python does not parse the TLV bytes itself.
+
+    elements is an indexable sequence of FlatTLVElement (e.g. a ctypes array or
+    pointer), tlv the bytes the elements were decoded from."""
+
+    def __init__(self, elements, count, tlv):
+        self._elements = elements
+        self._count = count
+        self._tlv = tlv
+
+    def get(self):
+        """Get the dictionary representation of tlv data"""
+        out = {}
+        self._getContainer(0, self._count, out)
+        return out
+
+    def _getContainer(self, index, end, out):
+        elements = self._elements
+        isMapping = isinstance(out, Mapping)
+
+        while index < end:
+            element = elements[index]
+            kind = element.kind
+
+            if kind >= FlatTLVElement.KIND_STRUCTURE:
+                value = {} if kind == FlatTLVElement.KIND_STRUCTURE else []
+                self._getContainer(index + 1, element.end, value)
+                index = element.end
+            else:
+                value = self._getValue(element, kind)
+                index += 1
+
+            tagKind = element.tagKind
+            if tagKind == FlatTLVElement.TAG_ANONYMOUS:
+                if isMapping:
+                    out["Any"] = value
+                else:
+                    out.append(value)
+            elif tagKind == FlatTLVElement.TAG_CONTEXT:
+                if isMapping:
+                    out[element.tagNumber] = value
+                else:
+                    out.append(value)
+            elif tagKind == FlatTLVElement.TAG_COMMON_PROFILE:
+                out[(0, element.tagNumber)] = value
+            elif tagKind == FlatTLVElement.TAG_IMPLICIT_PROFILE:
+                out[(None, element.tagNumber)] = value
+            else:
+                out[(element.profileId, element.tagNumber)] = value
+
+    def _getValue(self, element, kind):
+        if kind == FlatTLVElement.KIND_UNSIGNED_INTEGER:
+            return uint(element.value)
+        if kind == FlatTLVElement.KIND_SIGNED_INTEGER:
+            value = element.value
+            return value - (1 << 64) if value >= (1 << 63) else value
+        if kind == FlatTLVElement.KIND_UTF8_STRING:
+            val = self._tlv[element.value: element.value + element.length]
+            try:
+                return str(val, "utf-8")
+            except Exception as ex:
+                return val
+        if kind == FlatTLVElement.KIND_BYTE_STRING:
+            return self._tlv[element.value: element.value + element.length]
+        if kind == FlatTLVElement.KIND_BOOLEAN:
+            return element.value != 0
+        if kind == FlatTLVElement.KIND_NULL:
+            return None
+
+        (value,) = _FlatTLVDouble.unpack(_FlatTLVDoubleBits.pack(element.value))
+        return float32(value) if kind == FlatTLVElement.KIND_FLOAT32 else value
+
+
 def tlvTagToSortKey(tag):
     if tag is None:
         return -1
@@ -19,6 +19,7 @@ import pprint
 import chip.clusters as Clusters
 import chip.exceptions
 import logging
+import chip.clusters.Attribute as Attribute
 from chip.clusters.Attribute import AttributePath, AttributeReadResult, AttributeStatus, ValueDecodeFailure, TypedAttributePath, SubscriptionTransaction, DataVersion
 import chip.interaction_model
 import asyncio
@@ -315,6 +316,28 @@ class ClusterObjectTests:
         #     raise AssertionError(
         #         "Expect the fabric index matches the one current reading")
 
+    @classmethod
+    @base.test_case
+    async def TestWildcardReadDecodeThroughput(cls, devCtrl):
+        '''
+        Benchmarks the decoding of attribute reports: a wildcard read is decoded natively, then with chip.tlv.TLVReader.
+        '''
+        req = ['*']
+        timings = {}
+        try:
+            for native in [True, False]:
+                Attribute.NativeTLVDecode = native
+                start = time.perf_counter()
+                res = await devCtrl.ReadAttribute(nodeid=NODE_ID, attributes=req)
+                timings[native] = time.perf_counter() - start
+                VerifyDecodeSuccess(res)
+        finally:
+            Attribute.NativeTLVDecode = True
+
+        numAttributes = sum(len(cluster) for endpoint in res.values() for cluster in endpoint.values())
+        logger.info(f"Wildcard read of {numAttributes} attributes: native decode {timings[True]:.3f}s, "
+                    f"Python decode {timings[False]:.3f}s")
+
     @classmethod
     async def _TriggerEvent(cls, devCtrl):
         # We trigger sending an event a couple of times just to be safe.
@@ -575,6 +598,7 @@ class ClusterObjectTests:
             await cls.TestReadEventRequests(devCtrl, 1)
             await cls.TestReadWriteAttributeRequestsWithVersion(devCtrl)
             await cls.TestReadAttributeRequests(devCtrl)
+            await cls.TestWildcardReadDecodeThroughput(devCtrl)
             await cls.TestSubscribeZeroMinInterval(devCtrl)
             await cls.TestSubscribeAttribute(devCtrl)
             await cls.TestMixedReadAttributeAndEvents(devCtrl)
@@ -16,9 +16,12 @@
 #
 
 
-from chip.tlv import TLVWriter, TLVReader
+from chip.tlv import TLVWriter, TLVReader, FlatTLVElement, FlatTLVReader
 from chip.tlv import uint as tlvUint
+from chip.tlv import float32
+import chip.native
 
+import ctypes
 import unittest
 
 
@@ -161,5 +164,127 @@ class TestTLVReader(unittest.TestCase):
             self._read_case(tlv_bytes, answer)
 
 
+class TestFlatTLVReader(unittest.TestCase):
+    def _element(self, kind, tagKind=FlatTLVElement.TAG_ANONYMOUS, tagNumber=0, end=0, length=0, value=0):
+        return FlatTLVElement(kind=kind, tagKind=tagKind, tagNumber=tagNumber, end=end, length=length, value=value)
+
+    def test_matches_tlv_reader(self):
+        # {1: [uint 5, -2, 'ab', b'\x01'], 2: None, 3: True, 4: float32 1.5}
+        data = (b'\x15\x36\x01\x04\x05\x00\xfe\x0c\x02ab\x10\x01\x01\x18'
+                b'\x34\x02\x29\x03\x2a\x04\x00\x00\xc0\x3f\x18')
+        elements = [
+            self._element(FlatTLVElement.KIND_STRUCTURE, end=10),
+            self._element(FlatTLVElement.KIND_ARRAY, FlatTLVElement.TAG_CONTEXT, 1, end=6),
+            self._element(FlatTLVElement.KIND_UNSIGNED_INTEGER, value=5),
+            self._element(FlatTLVElement.KIND_SIGNED_INTEGER, value=(1 << 64) - 2),
+            self._element(FlatTLVElement.KIND_UTF8_STRING, length=2, value=9),
+            self._element(FlatTLVElement.KIND_BYTE_STRING, length=1, value=13),
+            self._element(FlatTLVElement.KIND_NULL, FlatTLVElement.TAG_CONTEXT, 2),
+            self._element(FlatTLVElement.KIND_BOOLEAN, FlatTLVElement.TAG_CONTEXT, 3, value=1),
+            self._element(FlatTLVElement.KIND_FLOAT32, FlatTLVElement.TAG_CONTEXT, 4, value=0x3FF8000000000000),
+        ]
+        elements[0].end = len(elements)
+
+        expected = TLVReader(data).get()
+        decoded = FlatTLVReader(elements, len(elements), data).get()
+        self.assertEqual(decoded, expected)
+        self.assertEqual(decoded, {'Any': {1: [5, -2, 'ab', b'\x01'], 2: None, 3: True, 4: 1.5}})
+        self.assertEqual(type(decoded['Any'][1][0]), tlvUint)
+        self.assertEqual(type(decoded['Any'][4]), float32)
+
+
+class TestNativeFlatTLVDecode(unittest.TestCase):
+    '''Runs TLV encoded by TLVWriter through the C++ decoder of the controller library.'''
+
+    @classmethod
+    def setUpClass(cls):
+        # Decoding does not need the CHIP stack, only the library
+        cls._handle = ctypes.CDLL(chip.native.FindNativeLibraryPath())
+        cls._handle.pychip_TLV_DecodeFlat.restype = ctypes.c_uint32
+        cls._handle.pychip_TLV_DecodeFlat.argtypes = [
+            ctypes.c_char_p, ctypes.c_uint32, ctypes.POINTER(FlatTLVElement), ctypes.c_uint32, ctypes.POINTER(ctypes.c_uint32)]
+
+    def _decode(self, data):
+        elements = (FlatTLVElement * max(len(data), 1))()
+        elementCount = ctypes.c_uint32(0)
+        res = self._handle.pychip_TLV_DecodeFlat(data, len(data), elements, len(elements), ctypes.byref(elementCount))
+        self.assertEqual(res, 0)
+        return FlatTLVReader(elements, elementCount.value, data).get()
+
+    def _assertSameTypes(self, decoded, expected):
+        self.assertIs(type(decoded), type(expected))
+        if isinstance(expected, dict):
+            for key, value in expected.items():
+                self._assertSameTypes(decoded[key], value)
+        elif isinstance(expected, list):
+            for decodedValue, value in zip(decoded, expected):
+                self._assertSameTypes(decodedValue, value)
+
+    def _check(self, writer):
+        data = bytes(writer.encoding)
+        expected = TLVReader(data).get()
+        decoded = self._decode(data)
+        self.assertEqual(decoded, expected)
+        self._assertSameTypes(decoded, expected)
+
+    def test_values(self):
+        writer = TLVWriter()
+        writer.put(None, {
+            0: tlvUint(1),
+            1: -5,
+            2: 3.25,
+            3: float32(0.5),
+            4: 'hello',
+            5: b'\x00\x01\x02',
+            6: True,
+            7: False,
+            8: None,
+            9: [tlvUint(1), tlvUint(2), 'x', {1: []}],
+            10: {},
+            11: tlvUint(0xFFFFFFFFFFFFFFFF),
+            12: -(1 << 63),
+            13: '',
+            14: b'',
+            15: 'a' * 300,
+            16: b'\xab' * 70000,
+        })
+        self._check(writer)
+
+    def test_profile_tags(self):
+        writer = TLVWriter(implicitProfile=0x235A0042)
+        writer.put(None, {
+            (0, 1): tlvUint(2),
+            (0, 0x10000): 'common',
+            (0x235A0042, 7): -1,
+            (0x235A0042, 0x10001): [None],
+        })
+        self._check(writer)
+
+    def test_list_and_top_level_elements(self):
+        writer = TLVWriter()
+        writer.startPath(None)
+        writer.put(0, tlvUint(1))
+        writer.put(2, [{1: tlvUint(3)}, {1: tlvUint(4)}])
+        writer.endContainer()
+        writer.put(None, tlvUint(5))
+        self._check(writer)
+
+    def test_attribute_report(self):
+        # An AttributeReportIB holding an AttributeDataIB with a list of structures, as the controller receives it
+        writer = TLVWriter()
+        writer.startStructure(None)
+        writer.startStructure(1)
+        writer.put(0, tlvUint(3))
+        writer.startPath(1)
+        writer.put(2, tlvUint(0))
+        writer.put(3, tlvUint(0x1F))
+        writer.put(4, tlvUint(0))
+        writer.endContainer()
+        writer.put(2, [{1: tlvUint(5), 2: tlvUint(1), 3: [tlvUint(112233)], 4: None, 254: tlvUint(1)} for _ in range(20)])
+        writer.endContainer()
+        writer.endContainer()
+        self._check(writer)
+
+
 if __name__ == '__main__':
     unittest.main()
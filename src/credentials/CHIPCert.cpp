@@ -488,11 +488,23 @@ CHIP_ERROR ChipCertificateSet::ValidateCert(const ChipCertificateData * cert, Va
         ExitNow(err = CHIP_ERROR_CA_CERT_NOT_FOUND);
     }
 
+    // A signature verified before, with the same CA key and in a chain up to the same trust anchor, is still valid.
+    if (context.mValidationCache != nullptr && context.mTrustAnchor != nullptr &&
+        context.mValidationCache->Contains(*cert, *caCert, *context.mTrustAnchor))
+    {
+        ExitNow(err = CHIP_NO_ERROR);
+    }
+
     // Verify signature of the current certificate against public key of the CA certificate. If signature verification
     // succeeds, the current certificate is valid.
     err = VerifySignature(cert, caCert);
     SuccessOrExit(err);
 
+    if (context.mValidationCache != nullptr && context.mTrustAnchor != nullptr)
+    {
+        context.mValidationCache->Add(*cert, *caCert, *context.mTrustAnchor);
+    }
+
 exit:
     return err;
 }
@@ -583,9 +595,10 @@ bool ChipCertificateData::IsEqual(const ChipCertificateData & other) const
 
 void ValidationContext::Reset()
 {
-    mEffectiveTime  = EffectiveTime{};
-    mTrustAnchor    = nullptr;
-    mValidityPolicy = nullptr;
+    mEffectiveTime   = EffectiveTime{};
+    mTrustAnchor     = nullptr;
+    mValidityPolicy  = nullptr;
+    mValidationCache = nullptr;
     mRequiredKeyUsages.ClearAll();
     mRequiredKeyPurposes.ClearAll();
     mRequiredCertType = kCertType_NotSpecified;
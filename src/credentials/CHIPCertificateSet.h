@@ -31,6 +31,7 @@
 #include <string.h>
 
 #include "CHIPCert.h"
+#include "CertificateValidationCache.h"
 #include "CertificateValidityPolicy.h"
 #include <lib/support/Variant.h>
 
@@ -74,6 +75,8 @@ struct ValidationContext
 
     CertificateValidityPolicy * mValidityPolicy =
         nullptr; /**< Optional application policy to apply for certificate validity period evaluation. */
+    CertificateValidationCache * mValidationCache =
+        nullptr; /**< Optional cache of verified signatures, to skip verifying them again. */
 
     void Reset();
 
@@ -0,0 +1,116 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <credentials/CertificateValidationCache.h>
+
+#include <credentials/CHIPCert.h>
+#include <lib/support/CodeUtils.h>
+
+#include <string.h>
+
+namespace chip {
+namespace Credentials {
+
+bool CertificateValidationCache::Contains(const ChipCertificateData & cert, const ChipCertificateData & caCert,
+                                          const ChipCertificateData & trustAnchor)
+{
+    VerifyOrReturnValue(kCapacity > 0, false);
+
+    Key key;
+    VerifyOrReturnValue(ComputeKey(cert, caCert, trustAnchor, key) == CHIP_NO_ERROR, false);
+
+    for (Entry & entry : mEntries)
+    {
+        if (entry.lastUse != 0 && memcmp(entry.key, key, sizeof(key)) == 0)
+        {
+            entry.lastUse = ++mUseCounter;
+            mHits++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CertificateValidationCache::Add(const ChipCertificateData & cert, const ChipCertificateData & caCert,
+                                     const ChipCertificateData & trustAnchor)
+{
+    VerifyOrReturn(kCapacity > 0);
+
+    Key key;
+    VerifyOrReturn(ComputeKey(cert, caCert, trustAnchor, key) == CHIP_NO_ERROR);
+
+    // Replace an unused entry, or else the least recently used one
+    Entry * victim = &mEntries[0];
+    for (Entry & entry : mEntries)
+    {
+        if (entry.lastUse < victim->lastUse)
+        {
+            victim = &entry;
+        }
+    }
+
+    if (mUseCounter == UINT32_MAX)
+    {
+        // Keep lastUse of used entries non-zero
+        Clear();
+        victim = &mEntries[0];
+    }
+
+    memcpy(victim->key, key, sizeof(key));
+    victim->lastUse = ++mUseCounter;
+}
+
+void CertificateValidationCache::Clear()
+{
+    for (Entry & entry : mEntries)
+    {
+        entry.lastUse = 0;
+    }
+    mUseCounter = 0;
+}
+
+size_t CertificateValidationCache::GetEntryCount() const
+{
+    size_t count = 0;
+    for (const Entry & entry : mEntries)
+    {
+        if (entry.lastUse != 0)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+CHIP_ERROR CertificateValidationCache::ComputeKey(const ChipCertificateData & cert, const ChipCertificateData & caCert,
+                                                  const ChipCertificateData & trustAnchor, Key & key)
+{
+    VerifyOrReturnError(cert.mCertFlags.Has(CertFlags::kTBSHashPresent), CHIP_ERROR_INVALID_ARGUMENT);
+
+    Crypto::Hash_SHA256_stream hash;
+    ReturnErrorOnFailure(hash.Begin());
+    ReturnErrorOnFailure(hash.AddData(ByteSpan(cert.mTBSHash)));
+    ReturnErrorOnFailure(hash.AddData(cert.mSignature));
+    ReturnErrorOnFailure(hash.AddData(caCert.mPublicKey));
+    ReturnErrorOnFailure(hash.AddData(trustAnchor.mPublicKey));
+
+    MutableByteSpan keySpan(key);
+    return hash.Finish(keySpan);
+}
+
+} // namespace Credentials
+} // namespace chip
@@ -0,0 +1,84 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ * @brief Defines a cache of verified certificate signatures.
+ */
+
+#pragma once
+
+#include <crypto/CHIPCryptoPAL.h>
+#include <lib/core/CHIPConfig.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace chip {
+namespace Credentials {
+
+struct ChipCertificateData;
+
+/**
+ * Remembers the certificates whose signature was verified, with the public
+ * key of their issuer, in a chain up to a given trust anchor.
+ *
+ * Set in a ValidationContext, it lets ChipCertificateSet::ValidateCert skip
+ * the ECDSA verification of certificates it validated before. Everything else
+ * (certificate usages, types and validity period against the effective time)
+ * is still checked on every validation, so an entry never makes a certificate
+ * valid for longer than it is.
+ *
+ * Entries are keyed by a digest of the certificate's TBS hash and signature
+ * and of the issuer and trust anchor public keys; the least recently used
+ * entry is evicted when full.
+ */
+class CertificateValidationCache
+{
+public:
+    static constexpr size_t kCapacity = CHIP_CONFIG_CERT_VALIDATION_CACHE_SIZE;
+
+    /// Whether the signature of [cert] was verified with the key of [caCert], in a chain up to [trustAnchor].
+    bool Contains(const ChipCertificateData & cert, const ChipCertificateData & caCert, const ChipCertificateData & trustAnchor);
+
+    /// Record that the signature of [cert] was verified with the key of [caCert], in a chain up to [trustAnchor].
+    void Add(const ChipCertificateData & cert, const ChipCertificateData & caCert, const ChipCertificateData & trustAnchor);
+
+    void Clear();
+
+    size_t GetEntryCount() const;
+    uint32_t GetHitCount() const { return mHits; }
+
+private:
+    using Key = uint8_t[Crypto::kSHA256_Hash_Length];
+
+    struct Entry
+    {
+        Key key;
+        // 0 for unused entries
+        uint32_t lastUse = 0;
+    };
+
+    static CHIP_ERROR ComputeKey(const ChipCertificateData & cert, const ChipCertificateData & caCert,
+                                 const ChipCertificateData & trustAnchor, Key & key);
+
+    Entry mEntries[kCapacity > 0 ? kCapacity : 1];
+    uint32_t mUseCounter = 0;
+    uint32_t mHits       = 0;
+};
+
+} // namespace Credentials
+} // namespace chip
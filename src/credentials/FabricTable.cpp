@@ -349,8 +349,17 @@ CHIP_ERROR FabricTable::VerifyCredentials(FabricIndex fabricIndex, const ByteSpa
     uint8_t rootCertBuf[kMaxCHIPCertLength];
     MutableByteSpan rootCertSpan{ rootCertBuf };
     ReturnErrorOnFailure(FetchRootCert(fabricIndex, rootCertSpan));
-    return VerifyCredentials(noc, icac, rootCertSpan, context, outCompressedFabricId, outFabricId, outNodeId, outNocPubkey,
-                             outRootPublicKey);
+
+    // Peers keep presenting the same NOCs and ICACs: skip verifying their signatures again
+    Credentials::CertificateValidationCache * callerCache = context.mValidationCache;
+    if (callerCache == nullptr)
+    {
+        context.mValidationCache = &mValidationCache;
+    }
+    CHIP_ERROR err = VerifyCredentials(noc, icac, rootCertSpan, context, outCompressedFabricId, outFabricId, outNodeId,
+                                       outNocPubkey, outRootPublicKey);
+    context.mValidationCache = callerCache;
+    return err;
 }
 
 CHIP_ERROR FabricTable::VerifyCredentials(const ByteSpan & noc, const ByteSpan & icac, const ByteSpan & rcac,
@@ -742,6 +751,8 @@ public:
 
 CHIP_ERROR FabricTable::NotifyFabricUpdated(FabricIndex fabricIndex)
 {
+    mValidationCache.Clear();
+
     FabricTable::Delegate * delegate = mDelegateListRoot;
     while (delegate)
     {
@@ -756,6 +767,8 @@ CHIP_ERROR FabricTable::NotifyFabricUpdated(FabricIndex fabricIndex)
 
 CHIP_ERROR FabricTable::NotifyFabricCommitted(FabricIndex fabricIndex)
 {
+    mValidationCache.Clear();
+
     FabricTable::Delegate * delegate = mDelegateListRoot;
     while (delegate)
     {
@@ -998,6 +1011,8 @@ CHIP_ERROR FabricTable::Delete(FabricIndex fabricIndex)
         ChipLogProgress(FabricProvisioning, "Fabric (0x%x) deleted.", static_cast<unsigned>(fabricIndex));
     }
 
+    mValidationCache.Clear();
+
     if (mDelegateListRoot != nullptr)
     {
         FabricTable::Delegate * delegate = mDelegateListRoot;
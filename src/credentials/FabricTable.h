@@ -26,6 +26,7 @@
 #include <app/util/basic-types.h>
 #include <credentials/CHIPCert.h>
 #include <credentials/CHIPCertificateSet.h>
+#include <credentials/CertificateValidationCache.h>
 #include <credentials/CertificateValidityPolicy.h>
 #include <credentials/LastKnownGoodTime.h>
 #include <credentials/OperationalCertificateStore.h>
@@ -913,7 +914,8 @@ public:
     void RevertPendingOpCertsExceptRoot();
 
     // Verifies credentials, with the fabric's root under fabricIndex, and extract critical bits.
-    // This call is used for CASE.
+    // This call is used for CASE: signatures it verified before are not verified again, unless
+    // context already sets a validation cache.
     CHIP_ERROR VerifyCredentials(FabricIndex fabricIndex, const ByteSpan & noc, const ByteSpan & icac,
                                  Credentials::ValidationContext & context, CompressedFabricId & outCompressedFabricId,
                                  FabricId & outFabricId, NodeId & outNodeId, Crypto::P256PublicKey & outNocPubkey,
@@ -1143,6 +1145,9 @@ private:
 
     LastKnownGoodTime mLastKnownGoodTime;
 
+    // Signatures verified by VerifyCredentials, cleared whenever delegates are notified of a fabric change
+    mutable Credentials::CertificateValidationCache mValidationCache;
+
     // We may not have an mNextAvailableFabricIndex if our table is as large as
     // it can go and is full.
     Optional<FabricIndex> mNextAvailableFabricIndex;
@@ -998,6 +998,49 @@ static void TestChipCert_CertValidityPolicyInjection(nlTestSuite * inSuite, void
     certSet.Release();
 }
 
+static void TestChipCert_CertValidationCache(nlTestSuite * inSuite, void * inContext)
+{
+    CHIP_ERROR err;
+    ChipCertificateSet certSet;
+    ValidationContext validContext;
+    CertificateValidationCache cache;
+    ChipCertificateData certDataArray[kStandardCertsCount];
+
+    err = certSet.Init(certDataArray, ArraySize(certDataArray));
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+
+    err = LoadTestCertSet01(certSet);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+
+    validContext.Reset();
+    validContext.mRequiredKeyUsages.Set(KeyUsageFlags::kDigitalSignature);
+    validContext.mValidationCache = &cache;
+
+    err = SetCurrentTime(validContext, 2020, 10, 16);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+
+    // The NOC and ICAC signatures are verified, then remembered
+    err = certSet.ValidateCert(certSet.GetLastCert(), validContext);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, cache.GetEntryCount() == 2);
+    NL_TEST_ASSERT(inSuite, cache.GetHitCount() == 0);
+
+    err = certSet.ValidateCert(certSet.GetLastCert(), validContext);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, cache.GetHitCount() == 2);
+
+    // Cached signatures do not extend validity periods
+    err = SetCurrentTime(validContext, 2020, 1, 3);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    err = certSet.ValidateCert(certSet.GetLastCert(), validContext);
+    NL_TEST_ASSERT(inSuite, err == CHIP_ERROR_CERT_NOT_VALID_YET);
+
+    cache.Clear();
+    NL_TEST_ASSERT(inSuite, cache.GetEntryCount() == 0);
+
+    certSet.Release();
+}
+
 static void TestChipCert_CertUsage(nlTestSuite * inSuite, void * inContext)
 {
     CHIP_ERROR err;
@@ -2054,6 +2097,7 @@ static const nlTest sTests[] = {
     NL_TEST_DEF("Test CHIP Certificate Validation time", TestChipCert_CertValidTime),
     NL_TEST_DEF("Test CHIP Root Certificate Validation", TestChipCert_ValidateChipRCAC),
     NL_TEST_DEF("Test CHIP Certificate Validity Policy injection", TestChipCert_CertValidityPolicyInjection),
+    NL_TEST_DEF("Test CHIP Certificate Validation Cache", TestChipCert_CertValidationCache),
     NL_TEST_DEF("Test CHIP Certificate Usage", TestChipCert_CertUsage),
     NL_TEST_DEF("Test CHIP Certificate Type", TestChipCert_CertType),
     NL_TEST_DEF("Test CHIP Certificate ID", TestChipCert_CertId),
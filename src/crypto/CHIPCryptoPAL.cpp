@@ -716,6 +716,182 @@ CHIP_ERROR AES_CTR_crypt(const uint8_t * input, size_t input_length, const uint8
     return AES_CCM_encrypt(input, input_length, nullptr, 0, key, key_length, nonce, nonce_length, output, tag, kTagLen);
 }
 
+// AES-CCM as per NIST SP 800-38C and RFC 3610: the CBC-MAC of the formatted input, then CTR mode
+// encryption of the plaintext and of the MAC. Both run block by block over the plaintext, so a
+// single pass over its parts computes them.
+
+AES_CCM_encrypt_stream::AES_CCM_encrypt_stream() {}
+
+AES_CCM_encrypt_stream::~AES_CCM_encrypt_stream()
+{
+    Clear();
+}
+
+CHIP_ERROR AES_CCM_encrypt_stream::Begin(const uint8_t * key, size_t key_length, const uint8_t * nonce, size_t nonce_length,
+                                         const uint8_t * aad, size_t aad_length, size_t plaintext_length, size_t tag_length)
+{
+    constexpr size_t kBlockLength = kAES_CCM128_Block_Length;
+
+    Clear();
+
+    VerifyOrReturnError(key != nullptr && key_length == kAES_CCM128_Key_Length, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(nonce != nullptr && nonce_length >= 7 && nonce_length <= kAES_CCM128_Nonce_Length,
+                        CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(aad != nullptr || aad_length == 0, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(tag_length >= 4 && tag_length <= kAES_CCM128_Tag_Length && (tag_length % 2) == 0,
+                        CHIP_ERROR_INVALID_ARGUMENT);
+
+    // The counter, and the plaintext length in the first block, take the bytes the nonce leaves
+    const size_t counterLength = kBlockLength - 1 - nonce_length;
+    VerifyOrReturnError(counterLength >= 8 || static_cast<uint64_t>(plaintext_length) < (UINT64_C(1) << (8 * counterLength)),
+                        CHIP_ERROR_INVALID_ARGUMENT);
+
+    mStarted = true;
+    ReturnErrorOnFailure(SetKey(key));
+    mRemaining     = plaintext_length;
+    mTagLength     = tag_length;
+    mCounterLength = static_cast<uint8_t>(counterLength);
+
+    // B_0: flags, nonce, then the plaintext length
+    mMac[0] = static_cast<uint8_t>(((aad_length > 0) ? 0x40 : 0) | (((tag_length - 2) / 2) << 3) | (counterLength - 1));
+    memcpy(&mMac[1], nonce, nonce_length);
+    uint64_t length = plaintext_length;
+    for (size_t i = kBlockLength - 1; i > nonce_length; i--)
+    {
+        mMac[i] = static_cast<uint8_t>(length);
+        length >>= 8;
+    }
+    ReturnErrorOnFailure(EncryptBlock(mMac, mMac));
+
+    if (aad_length > 0)
+    {
+        uint8_t encodedLength[10];
+        size_t encodedLengthSize = 0;
+        if (aad_length < 0xFF00)
+        {
+            Encoding::BigEndian::Put16(encodedLength, static_cast<uint16_t>(aad_length));
+            encodedLengthSize = 2;
+        }
+        else if (static_cast<uint64_t>(aad_length) <= UINT32_MAX)
+        {
+            encodedLength[0] = 0xFF;
+            encodedLength[1] = 0xFE;
+            Encoding::BigEndian::Put32(&encodedLength[2], static_cast<uint32_t>(aad_length));
+            encodedLengthSize = 6;
+        }
+        else
+        {
+            encodedLength[0] = 0xFF;
+            encodedLength[1] = 0xFF;
+            Encoding::BigEndian::Put64(&encodedLength[2], static_cast<uint64_t>(aad_length));
+            encodedLengthSize = 10;
+        }
+        ReturnErrorOnFailure(AddToMac(encodedLength, encodedLengthSize));
+        ReturnErrorOnFailure(AddToMac(aad, aad_length));
+        ReturnErrorOnFailure(FinishMacBlock());
+    }
+
+    // A_0: flags, nonce, then a zero counter. A_0 encrypts the MAC, the plaintext starts at A_1.
+    memset(mCounter, 0, sizeof(mCounter));
+    mCounter[0] = static_cast<uint8_t>(counterLength - 1);
+    memcpy(&mCounter[1], nonce, nonce_length);
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR AES_CCM_encrypt_stream::EncryptInPlace(MutableByteSpan data)
+{
+    VerifyOrReturnError(mStarted, CHIP_ERROR_INCORRECT_STATE);
+    VerifyOrReturnError(data.size() <= mRemaining, CHIP_ERROR_INVALID_ARGUMENT);
+    mRemaining -= data.size();
+
+    uint8_t * bytes = data.data();
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        if (mBlockOffset == 0)
+        {
+            ReturnErrorOnFailure(NextKeyStream());
+        }
+        mMac[mBlockOffset] ^= bytes[i];
+        bytes[i] ^= mKeyStream[mBlockOffset];
+        if (++mBlockOffset == kAES_CCM128_Block_Length)
+        {
+            ReturnErrorOnFailure(FinishMacBlock());
+        }
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR AES_CCM_encrypt_stream::Finish(uint8_t * tag)
+{
+    VerifyOrReturnError(mStarted && mRemaining == 0, CHIP_ERROR_INCORRECT_STATE);
+    VerifyOrReturnError(tag != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+
+    ReturnErrorOnFailure(FinishMacBlock());
+
+    // S_0 encrypts the MAC
+    memset(&mCounter[kAES_CCM128_Block_Length - mCounterLength], 0, mCounterLength);
+    ReturnErrorOnFailure(EncryptBlock(mCounter, mKeyStream));
+    for (size_t i = 0; i < mTagLength; i++)
+    {
+        tag[i] = mMac[i] ^ mKeyStream[i];
+    }
+
+    Clear();
+    return CHIP_NO_ERROR;
+}
+
+void AES_CCM_encrypt_stream::Clear()
+{
+    if (mStarted)
+    {
+        ClearKey();
+    }
+    ClearSecretData(mMac);
+    ClearSecretData(mCounter);
+    ClearSecretData(mKeyStream);
+    mBlockOffset   = 0;
+    mRemaining     = 0;
+    mTagLength     = 0;
+    mCounterLength = 0;
+    mStarted       = false;
+}
+
+CHIP_ERROR AES_CCM_encrypt_stream::AddToMac(const uint8_t * data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        mMac[mBlockOffset] ^= data[i];
+        if (++mBlockOffset == kAES_CCM128_Block_Length)
+        {
+            ReturnErrorOnFailure(FinishMacBlock());
+        }
+    }
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR AES_CCM_encrypt_stream::FinishMacBlock()
+{
+    // A partial block is padded with zeroes, which leave the MAC as is.
+    VerifyOrReturnValue(mBlockOffset > 0, CHIP_NO_ERROR);
+    mBlockOffset = 0;
+    return EncryptBlock(mMac, mMac);
+}
+
+CHIP_ERROR AES_CCM_encrypt_stream::NextKeyStream()
+{
+    // Begin checked that the counter cannot overflow into the nonce for the plaintext length
+    for (size_t i = kAES_CCM128_Block_Length - 1; i > 0; i--)
+    {
+        if (++mCounter[i] != 0)
+        {
+            break;
+        }
+    }
+    return EncryptBlock(mCounter, mKeyStream);
+}
+
 CHIP_ERROR GenerateCompressedFabricId(const Crypto::P256PublicKey & root_public_key, uint64_t fabric_id,
                                       MutableByteSpan & out_compressed_fabric_id)
 {
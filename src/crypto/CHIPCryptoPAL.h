@@ -92,6 +92,7 @@ constexpr size_t kEmitDerIntegerWithoutTagOverhead = 1; // 1 sign stuffer
 constexpr size_t kEmitDerIntegerOverhead           = 3; // Tag + Length byte + 1 sign stuffer
 
 constexpr size_t kMAX_Hash_SHA256_Context_Size = CHIP_CONFIG_SHA256_CONTEXT_SIZE;
+constexpr size_t kMAX_AES128_Context_Size       = CHIP_CONFIG_AES128_CONTEXT_SIZE;
 
 constexpr size_t kSpake2p_WS_Length                 = kP256_FE_Length + 8;
 constexpr size_t kSpake2p_VerifierSerialized_Length = kP256_FE_Length + kP256_Point_Length;
@@ -640,6 +641,88 @@ CHIP_ERROR AES_CCM_decrypt(const uint8_t * ciphertext, size_t ciphertext_length,
 CHIP_ERROR AES_CTR_crypt(const uint8_t * input, size_t input_length, const uint8_t * key, size_t key_length, const uint8_t * nonce,
                          size_t nonce_length, uint8_t * output);
 
+struct alignas(size_t) AES128OpaqueContext
+{
+    uint8_t mOpaque[kMAX_AES128_Context_Size];
+};
+
+/**
+ * @brief A class that implements AES-CCM encryption of a plaintext given in parts,
+ *        like the buffers of a chain, which are encrypted in place.
+ *
+ * It produces the same ciphertext and tag as AES_CCM_encrypt over the whole plaintext,
+ * without gathering the parts into a contiguous buffer. The length of the plaintext
+ * must be known when starting.
+ **/
+class AES_CCM_encrypt_stream
+{
+public:
+    AES_CCM_encrypt_stream();
+    ~AES_CCM_encrypt_stream();
+
+    /**
+     * @brief Start the encryption of a plaintext.
+     *
+     * @param key Encryption key
+     * @param key_length Length of encryption key (in bytes)
+     * @param nonce Encryption nonce
+     * @param nonce_length Length of encryption nonce, between 7 and 13 bytes
+     * @param aad Additional authentication data
+     * @param aad_length Length of additional authentication data
+     * @param plaintext_length Total length of the parts of the plaintext
+     * @param tag_length Length of the tag, an even number between 4 and 16
+     * @return CHIP_ERROR_INVALID_ARGUMENT if the lengths are not supported by AES-CCM,
+     *         CHIP_ERROR_INTERNAL on failure to set the key, CHIP_NO_ERROR otherwise.
+     **/
+    CHIP_ERROR Begin(const uint8_t * key, size_t key_length, const uint8_t * nonce, size_t nonce_length, const uint8_t * aad,
+                     size_t aad_length, size_t plaintext_length, size_t tag_length);
+
+    /**
+     * @brief Encrypt, in place, the next part of the plaintext.
+     *
+     * @return CHIP_ERROR_INVALID_ARGUMENT if the parts are longer than the plaintext length
+     *         given to Begin, CHIP_ERROR_INTERNAL on failure to encrypt, CHIP_NO_ERROR otherwise.
+     **/
+    CHIP_ERROR EncryptInPlace(MutableByteSpan data);
+
+    /**
+     * @brief Finish the encryption once all the parts were encrypted, getting the tag.
+     *
+     * @param tag Buffer to write the tag into, of the tag length given to Begin
+     * @return CHIP_ERROR_INCORRECT_STATE if the parts are shorter than the plaintext length
+     *         given to Begin, CHIP_ERROR_INTERNAL on failure to encrypt, CHIP_NO_ERROR otherwise.
+     **/
+    CHIP_ERROR Finish(uint8_t * tag);
+
+    /**
+     * @brief Clear-out the key and the internal state to avoid lingering them.
+     */
+    void Clear();
+
+private:
+    // The AES-128 block cipher, which each CryptoPAL backend provides.
+    CHIP_ERROR SetKey(const uint8_t * key);
+    CHIP_ERROR EncryptBlock(const uint8_t * input, uint8_t * output);
+    void ClearKey();
+
+    CHIP_ERROR AddToMac(const uint8_t * data, size_t length);
+    CHIP_ERROR FinishMacBlock();
+    CHIP_ERROR NextKeyStream();
+
+    AES128OpaqueContext mContext;
+    // CBC-MAC of the data so far, with the input of the current block XORed in
+    uint8_t mMac[kAES_CCM128_Block_Length];
+    // Counter block A_i of the current block and its key stream S_i
+    uint8_t mCounter[kAES_CCM128_Block_Length];
+    uint8_t mKeyStream[kAES_CCM128_Block_Length];
+    size_t mBlockOffset    = 0;
+    size_t mRemaining      = 0;
+    size_t mTagLength      = 0;
+    uint8_t mCounterLength = 0;
+    // Whether Begin initialized the key, which Clear must then clear
+    bool mStarted = false;
+};
+
 /**
  * @brief Generate a PKCS#10 CSR, usable for Matter, from a P256Keypair.
  *
@@ -28,6 +28,7 @@
 #include <openssl/aead.h>
 #endif // CHIP_CRYPTO_BORINGSSL
 
+#include <openssl/aes.h>
 #include <openssl/bn.h>
 #include <openssl/conf.h>
 #include <openssl/ec.h>
@@ -435,6 +436,35 @@ CHIP_ERROR Hash_SHA1(const uint8_t * data, const size_t data_length, uint8_t * o
     return CHIP_NO_ERROR;
 }
 
+static_assert(kMAX_AES128_Context_Size >= sizeof(AES_KEY),
+              "kMAX_AES128_Context_Size is too small for the size of underlying AES_KEY");
+
+static inline AES_KEY * to_inner_aes128_context(AES128OpaqueContext * context)
+{
+    return SafePointerCast<AES_KEY *>(context);
+}
+
+CHIP_ERROR AES_CCM_encrypt_stream::SetKey(const uint8_t * key)
+{
+    AES_KEY * const context = to_inner_aes128_context(&mContext);
+
+    const int result = AES_set_encrypt_key(Uint8::to_const_uchar(key), static_cast<int>(kAES_CCM128_Key_Length * 8), context);
+    VerifyOrReturnError(result == 0, CHIP_ERROR_INTERNAL);
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR AES_CCM_encrypt_stream::EncryptBlock(const uint8_t * input, uint8_t * output)
+{
+    AES_encrypt(Uint8::to_const_uchar(input), Uint8::to_uchar(output), to_inner_aes128_context(&mContext));
+    return CHIP_NO_ERROR;
+}
+
+void AES_CCM_encrypt_stream::ClearKey()
+{
+    OPENSSL_cleanse(&mContext, sizeof(mContext));
+}
+
 Hash_SHA256_stream::Hash_SHA256_stream() {}
 
 Hash_SHA256_stream::~Hash_SHA256_stream()
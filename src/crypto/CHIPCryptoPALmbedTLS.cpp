@@ -24,6 +24,7 @@
 
 #include <type_traits>
 
+#include <mbedtls/aes.h>
 #include <mbedtls/bignum.h>
 #include <mbedtls/ccm.h>
 #include <mbedtls/ctr_drbg.h>
@@ -233,6 +234,42 @@ CHIP_ERROR Hash_SHA1(const uint8_t * data, const size_t data_length, uint8_t * o
     return CHIP_NO_ERROR;
 }
 
+static_assert(kMAX_AES128_Context_Size >= sizeof(mbedtls_aes_context),
+              "kMAX_AES128_Context_Size is too small for the size of underlying mbedtls_aes_context");
+
+static inline mbedtls_aes_context * to_inner_aes128_context(AES128OpaqueContext * context)
+{
+    return SafePointerCast<mbedtls_aes_context *>(context);
+}
+
+CHIP_ERROR AES_CCM_encrypt_stream::SetKey(const uint8_t * key)
+{
+    mbedtls_aes_context * const context = to_inner_aes128_context(&mContext);
+    mbedtls_aes_init(context);
+
+    const int result =
+        mbedtls_aes_setkey_enc(context, Uint8::to_const_uchar(key), static_cast<unsigned int>(kAES_CCM128_Key_Length * 8));
+    VerifyOrReturnError(result == 0, CHIP_ERROR_INTERNAL);
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR AES_CCM_encrypt_stream::EncryptBlock(const uint8_t * input, uint8_t * output)
+{
+    mbedtls_aes_context * const context = to_inner_aes128_context(&mContext);
+
+    const int result = mbedtls_aes_crypt_ecb(context, MBEDTLS_AES_ENCRYPT, Uint8::to_const_uchar(input), Uint8::to_uchar(output));
+    VerifyOrReturnError(result == 0, CHIP_ERROR_INTERNAL);
+
+    return CHIP_NO_ERROR;
+}
+
+void AES_CCM_encrypt_stream::ClearKey()
+{
+    mbedtls_aes_free(to_inner_aes128_context(&mContext));
+    mbedtls_platform_zeroize(&mContext, sizeof(mContext));
+}
+
 static_assert(kMAX_Hash_SHA256_Context_Size >= sizeof(mbedtls_sha256_context),
               "kMAX_Hash_SHA256_Context_Size is too small for the size of underlying mbedtls_sha256_context");
 
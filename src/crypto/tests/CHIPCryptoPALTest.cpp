@@ -45,6 +45,7 @@
 #include <lib/support/UnitTestRegistration.h>
 #include <nlunit-test.h>
 
+#include <algorithm>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -300,6 +301,81 @@ static void TestAES_CCM_128EncryptTestVectors(nlTestSuite * inSuite, void * inCo
     NL_TEST_ASSERT(inSuite, numOfTestsRan > 0);
 }
 
+static void TestAES_CCM_128EncryptStreamTestVectors(nlTestSuite * inSuite, void * inContext)
+{
+    HeapChecker heapChecker(inSuite);
+    int numOfTestVectors = ArraySize(ccm_128_test_vectors);
+    int numOfTestsRan    = 0;
+    for (int vectorIndex = 0; vectorIndex < numOfTestVectors; vectorIndex++)
+    {
+        const ccm_128_test_vector * vector = ccm_128_test_vectors[vectorIndex];
+        if (vector->result != CHIP_NO_ERROR)
+        {
+            continue;
+        }
+
+        // Encrypt the plaintext in parts of growing sizes, which start and end within blocks
+        for (size_t firstPartLength = 1; firstPartLength <= 17; firstPartLength += 8)
+        {
+            numOfTestsRan++;
+            chip::Platform::ScopedMemoryBuffer<uint8_t> data;
+            data.Alloc(vector->pt_len + 1);
+            NL_TEST_ASSERT(inSuite, data);
+            memcpy(data.Get(), vector->pt, vector->pt_len);
+            uint8_t out_tag[kAES_CCM128_Tag_Length];
+
+            AES_CCM_encrypt_stream stream;
+            CHIP_ERROR err = stream.Begin(vector->key, vector->key_len, vector->nonce, vector->nonce_len, vector->aad,
+                                          vector->aad_len, vector->pt_len, vector->tag_len);
+            NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+
+            size_t offset     = 0;
+            size_t partLength = firstPartLength;
+            while (err == CHIP_NO_ERROR && offset < vector->pt_len)
+            {
+                partLength = std::min(partLength, vector->pt_len - offset);
+                err        = stream.EncryptInPlace(MutableByteSpan(data.Get() + offset, partLength));
+                offset += partLength;
+                partLength += 5;
+            }
+            NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+
+            // The parts may not go past the plaintext length
+            NL_TEST_ASSERT(inSuite, stream.EncryptInPlace(MutableByteSpan(data.Get(), 1)) == CHIP_ERROR_INVALID_ARGUMENT);
+
+            err = stream.Finish(out_tag);
+            NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+
+            bool areCTsEqual  = memcmp(data.Get(), vector->ct, vector->ct_len) == 0;
+            bool areTagsEqual = memcmp(out_tag, vector->tag, vector->tag_len) == 0;
+            NL_TEST_ASSERT(inSuite, areCTsEqual);
+            NL_TEST_ASSERT(inSuite, areTagsEqual);
+            if (!areCTsEqual || !areTagsEqual)
+            {
+                printf("\n Test %d failed with parts starting at %u bytes\n", vector->tcId, static_cast<unsigned>(firstPartLength));
+            }
+        }
+    }
+    NL_TEST_ASSERT(inSuite, numOfTestsRan > 0);
+
+    // Finishing requires the whole plaintext
+    const ccm_128_test_vector * vector = ccm_128_test_vectors[0];
+    uint8_t out_tag[kAES_CCM128_Tag_Length];
+    AES_CCM_encrypt_stream stream;
+    NL_TEST_ASSERT(inSuite,
+                   stream.Begin(vector->key, vector->key_len, vector->nonce, vector->nonce_len, vector->aad, vector->aad_len,
+                                vector->pt_len + 1, vector->tag_len) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, stream.Finish(out_tag) == CHIP_ERROR_INCORRECT_STATE);
+
+    // Invalid tag and nonce lengths
+    NL_TEST_ASSERT(inSuite,
+                   stream.Begin(vector->key, vector->key_len, vector->nonce, vector->nonce_len, vector->aad, vector->aad_len,
+                                vector->pt_len, 3) == CHIP_ERROR_INVALID_ARGUMENT);
+    NL_TEST_ASSERT(inSuite,
+                   stream.Begin(vector->key, vector->key_len, vector->nonce, 6, vector->aad, vector->aad_len, vector->pt_len,
+                                vector->tag_len) == CHIP_ERROR_INVALID_ARGUMENT);
+}
+
 static void TestAES_CCM_128DecryptTestVectors(nlTestSuite * inSuite, void * inContext)
 {
     HeapChecker heapChecker(inSuite);
@@ -2406,6 +2482,7 @@ static void TestGroup_PrivacyKeyDerivation(nlTestSuite * inSuite, void * inConte
 static const nlTest sTests[] = {
 
     NL_TEST_DEF("Test encrypting AES-CCM-128 test vectors", TestAES_CCM_128EncryptTestVectors),
+    NL_TEST_DEF("Test encrypting AES-CCM-128 test vectors in parts", TestAES_CCM_128EncryptStreamTestVectors),
     NL_TEST_DEF("Test decrypting AES-CCM-128 test vectors", TestAES_CCM_128DecryptTestVectors),
     NL_TEST_DEF("Test encrypting AES-CCM-128 using nil key", TestAES_CCM_128EncryptNilKey),
     NL_TEST_DEF("Test encrypting AES-CCM-128 using invalid nonce", TestAES_CCM_128EncryptInvalidNonceLen),
@@ -535,7 +535,11 @@ protected:
     TCPEndPoint(EndPointManager<TCPEndPoint> & endPointManager) :
         EndPointBasis(endPointManager), OnConnectComplete(nullptr), OnDataReceived(nullptr), OnDataSent(nullptr),
         OnConnectionClosed(nullptr), OnPeerClose(nullptr), OnConnectionReceived(nullptr), OnAcceptError(nullptr),
-        mState(State::kReady), mReceiveEnabled(true), mConnectTimeoutMsecs(0) // Initialize to zero for using system defaults.
+        mState(State::kReady), mReceiveEnabled(true),
+#if INET_TCP_IDLE_CHECK_INTERVAL > 0
+        mIdleTimeout(0), mRemainingIdleTime(0),
+#endif                          // INET_TCP_IDLE_CHECK_INTERVAL > 0
+        mConnectTimeoutMsecs(0) // Initialize to zero for using system defaults.
 #if INET_CONFIG_OVERRIDE_SYSTEM_TCP_USER_TIMEOUT
         ,
         mUserTimeoutMillis(INET_CONFIG_DEFAULT_TCP_USER_TIMEOUT_MSEC), mUserTimeoutTimerRunning(false)
@@ -224,9 +224,6 @@ CHIP_ERROR UDPEndPointImplOT::SendMsgImpl(const IPPacketInfo * aPktInfo, System:
     otMessage * message;
     otMessageInfo messageInfo;
 
-    // For now the entire message must fit within a single buffer.
-    VerifyOrReturnError(!msg->HasChainedBuffer(), CHIP_ERROR_MESSAGE_TOO_LONG);
-
     memset(&messageInfo, 0, sizeof(messageInfo));
 
     messageInfo.mSockAddr = aPktInfo->SrcAddress.ToIPv6();
@@ -237,7 +234,11 @@ CHIP_ERROR UDPEndPointImplOT::SendMsgImpl(const IPPacketInfo * aPktInfo, System:
     message = otUdpNewMessage(mOTInstance, NULL);
     VerifyOrExit(message != NULL, error = OT_ERROR_NO_BUFS);
 
-    error = otMessageAppend(message, msg->Start(), msg->DataLength());
+    // Append each buffer of a chained message.
+    for (System::PacketBufferHandle buffer = msg.Retain(); error == OT_ERROR_NONE && !buffer.IsNull(); buffer.Advance())
+    {
+        error = otMessageAppend(message, buffer->Start(), buffer->DataLength());
+    }
 
     if (error == OT_ERROR_NONE)
     {
@@ -85,6 +85,9 @@ namespace Inet {
 
 namespace {
 
+// Most buffers a message sent in one datagram can be chained from.
+constexpr size_t kMaxSendBuffers = 8;
+
 CHIP_ERROR IPv6Bind(int socket, const IPAddress & address, uint16_t port, InterfaceId interface)
 {
     struct sockaddr_in6 sa;
@@ -284,12 +287,16 @@ CHIP_ERROR UDPEndPointImplSockets::SendMsgImpl(const IPPacketInfo * aPktInfo, Sy
     // Ensure the destination address type is compatible with the endpoint address type.
     VerifyOrReturnError(mAddrType == aPktInfo->DestAddress.Type(), CHIP_ERROR_INVALID_ARGUMENT);
 
-    // For now the entire message must fit within a single buffer.
-    VerifyOrReturnError(!msg->HasChainedBuffer(), CHIP_ERROR_MESSAGE_TOO_LONG);
-
-    struct iovec msgIOV;
-    msgIOV.iov_base = msg->Start();
-    msgIOV.iov_len  = msg->DataLength();
+    // Gather the buffers of a chained message into the datagram, without copying them.
+    struct iovec msgIOV[kMaxSendBuffers];
+    size_t msgIOVCount = 0;
+    for (System::PacketBufferHandle buffer = msg.Retain(); !buffer.IsNull(); buffer.Advance())
+    {
+        VerifyOrReturnError(msgIOVCount < kMaxSendBuffers, CHIP_ERROR_MESSAGE_TOO_LONG);
+        msgIOV[msgIOVCount].iov_base = buffer->Start();
+        msgIOV[msgIOVCount].iov_len  = buffer->DataLength();
+        msgIOVCount++;
+    }
 
 #if defined(IP_PKTINFO) || defined(IPV6_PKTINFO)
     uint8_t controlData[256];
@@ -298,8 +305,8 @@ CHIP_ERROR UDPEndPointImplSockets::SendMsgImpl(const IPPacketInfo * aPktInfo, Sy
 
     struct msghdr msgHeader;
     memset(&msgHeader, 0, sizeof(msgHeader));
-    msgHeader.msg_iov    = &msgIOV;
-    msgHeader.msg_iovlen = 1;
+    msgHeader.msg_iov    = msgIOV;
+    msgHeader.msg_iovlen = msgIOVCount;
 
     // Construct a sockaddr_in/sockaddr_in6 structure containing the destination information.
     SockAddr peerSockAddr;
@@ -408,7 +415,7 @@ CHIP_ERROR UDPEndPointImplSockets::SendMsgImpl(const IPPacketInfo * aPktInfo, Sy
     {
         return CHIP_ERROR_POSIX(errno);
     }
-    if (lenSent != msg->DataLength())
+    if (lenSent != msg->TotalLength())
     {
         return CHIP_ERROR_OUTBOUND_MESSAGE_TOO_BIG;
     }
@@ -97,6 +97,7 @@ void NodeLookupHandle::ResetForLookup(System::Clock::Timestamp now, const NodeLo
     mRequest          = request;
     mBestResult       = ResolveResult();
     mBestAddressScore = ScoreValue(IpScore::kInvalid);
+    mResolvePending   = true;
 }
 
 void NodeLookupHandle::LookupResult(const ResolveResult & result)
@@ -181,13 +182,51 @@ CHIP_ERROR Resolver::LookupNode(const NodeLookupRequest & request, Impl::NodeLoo
 {
     VerifyOrReturnError(mSystemLayer != nullptr, CHIP_ERROR_INCORRECT_STATE);
 
+    // Resolves start from the event loop, so that lookups requested together
+    // (e.g. when reconnecting to many nodes) share DNS-SD query packets.
+    ReturnErrorOnFailure(mSystemLayer->StartTimer(System::Clock::kZero, &OnStartResolvesTimer, this));
+
     handle.ResetForLookup(mTimeSource.GetMonotonicTimestamp(), request);
-    ReturnErrorOnFailure(Dnssd::Resolver::Instance().ResolveNodeId(request.GetPeerId(), Inet::IPAddressType::kAny));
     mActiveLookups.PushBack(&handle);
     ReArmTimer();
     return CHIP_NO_ERROR;
 }
 
+void Resolver::StartPendingResolves()
+{
+    constexpr size_t kMaxResolvesPerCall = 16;
+
+    while (true)
+    {
+        PeerId peerIds[kMaxResolvesPerCall];
+        size_t count = 0;
+
+        for (auto it = mActiveLookups.begin(); it != mActiveLookups.end() && count < kMaxResolvesPerCall; it++)
+        {
+            if (it->IsResolvePending())
+            {
+                it->MarkResolveStarted();
+                peerIds[count++] = it->GetRequest().GetPeerId();
+            }
+        }
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        CHIP_ERROR err = Dnssd::Resolver::Instance().ResolveNodeIds(Span<const PeerId>(peerIds, count), Inet::IPAddressType::kAny);
+        if (err != CHIP_NO_ERROR)
+        {
+            ChipLogError(Discovery, "Failed to start node lookups: %" CHIP_ERROR_FORMAT, err.Format());
+            for (size_t i = 0; i < count; i++)
+            {
+                OnOperationalNodeResolutionFailed(peerIds[i], err);
+            }
+        }
+    }
+}
+
 CHIP_ERROR Resolver::CancelLookup(Impl::NodeLookupHandle & handle, FailureCallback cancel_method)
 {
     VerifyOrReturnError(handle.IsActive(), CHIP_ERROR_INVALID_ARGUMENT);
@@ -238,6 +277,7 @@ void Resolver::Shutdown()
     // Re-arm of timer is expected to cancel any active timer as the
     // internal list of active lookups is empty at this point.
     ReArmTimer();
+    mSystemLayer->CancelTimer(&OnStartResolvesTimer, this);
 
     mSystemLayer = nullptr;
     Dnssd::Resolver::Instance().SetOperationalDelegate(nullptr);
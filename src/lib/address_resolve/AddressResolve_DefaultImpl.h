@@ -119,8 +119,13 @@ public:
     /// be triggered for this lookup handle
     System::Clock::Timeout NextEventTimeout(System::Clock::Timestamp now);
 
+    /// Whether the DNS-SD resolve of this lookup still has to be started
+    bool IsResolvePending() const { return mResolvePending; }
+    void MarkResolveStarted() { mResolvePending = false; }
+
 private:
     System::Clock::Timestamp mRequestStartTime;
+    bool mResolvePending = false;
     NodeLookupRequest mRequest; // active request to process
     AddressResolve::ResolveResult mBestResult;
     unsigned mBestAddressScore = 0;
@@ -145,6 +150,14 @@ public:
 
 private:
     static void OnResolveTimer(System::Layer * layer, void * context) { static_cast<Resolver *>(context)->HandleTimer(); }
+    static void OnStartResolvesTimer(System::Layer * layer, void * context)
+    {
+        static_cast<Resolver *>(context)->StartPendingResolves();
+    }
+
+    /// Start the DNS-SD resolves of the lookups requested since the last
+    /// call, all at once so that they share query packets.
+    void StartPendingResolves();
 
     /// Timer on lookup node events: min and max search times.
     void HandleTimer();
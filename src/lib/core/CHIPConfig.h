@@ -185,6 +185,24 @@
 #define CHIP_CONFIG_SHA256_CONTEXT_SIZE ((sizeof(unsigned int) * (8 + 2 + 16 + 2)) + sizeof(uint64_t))
 #endif // CHIP_CONFIG_SHA256_CONTEXT_SIZE
 
+/**
+ *  @def CHIP_CONFIG_AES128_CONTEXT_SIZE
+ *
+ *  @brief
+ *    Size of the statically allocated context for AES-128 block operations in CryptoPAL
+ *
+ *    The default size is based on the worst software implementation, mbedTLS, which
+ *    keeps the round keys of all the key sizes along with a pointer to them:
+ *      int nr;
+ *      uint32_t *rk;
+ *      uint32_t buf[68];
+ *
+ *    A static assert will tell us if we are wrong.
+ */
+#ifndef CHIP_CONFIG_AES128_CONTEXT_SIZE
+#define CHIP_CONFIG_AES128_CONTEXT_SIZE ((sizeof(uint32_t) * 68) + (2 * sizeof(uint64_t)))
+#endif // CHIP_CONFIG_AES128_CONTEXT_SIZE
+
 /**
  *  @def CHIP_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS
  *
@@ -690,6 +708,49 @@
 #define CHIP_CONFIG_SECURE_SESSION_REFCOUNT_LOGGING 0
 #endif
 
+/**
+ * @def CHIP_CONFIG_TCP_IDLE_TIMEOUT_SECS
+ *
+ * @brief Default time, in seconds, after which the TCP transport closes a
+ * connection without any traffic. The connection is established again when a
+ * message is next sent to its peer. Zero keeps idle connections open.
+ */
+#ifndef CHIP_CONFIG_TCP_IDLE_TIMEOUT_SECS
+#define CHIP_CONFIG_TCP_IDLE_TIMEOUT_SECS 300
+#endif // CHIP_CONFIG_TCP_IDLE_TIMEOUT_SECS
+
+/**
+ * @def CHIP_CONFIG_ENABLE_TCP_TRANSPORT
+ *
+ * @brief Add a TCP transport to the transports of the server and of the
+ * controllers, so that sessions carrying large interactions can be moved to
+ * TCP with SessionManager::SetSessionTransport. Requires
+ * INET_CONFIG_ENABLE_TCP_ENDPOINT.
+ */
+#ifndef CHIP_CONFIG_ENABLE_TCP_TRANSPORT
+#define CHIP_CONFIG_ENABLE_TCP_TRANSPORT 0
+#endif // CHIP_CONFIG_ENABLE_TCP_TRANSPORT
+
+/**
+ * @def CHIP_CONFIG_MAX_ACTIVE_TCP_CONNECTIONS
+ *
+ * @brief Maximum number of TCP connections the TCP transport of the server
+ * and of the controllers keeps open at the same time.
+ */
+#ifndef CHIP_CONFIG_MAX_ACTIVE_TCP_CONNECTIONS
+#define CHIP_CONFIG_MAX_ACTIVE_TCP_CONNECTIONS 4
+#endif // CHIP_CONFIG_MAX_ACTIVE_TCP_CONNECTIONS
+
+/**
+ * @def CHIP_CONFIG_MAX_TCP_PENDING_PACKETS
+ *
+ * @brief Maximum number of messages the TCP transport of the server and of
+ * the controllers holds while their connection is being established.
+ */
+#ifndef CHIP_CONFIG_MAX_TCP_PENDING_PACKETS
+#define CHIP_CONFIG_MAX_TCP_PENDING_PACKETS 4
+#endif // CHIP_CONFIG_MAX_TCP_PENDING_PACKETS
+
 /**
  *  @def CHIP_CONFIG_MAX_FABRICS
  *
@@ -702,6 +763,18 @@
 #define CHIP_CONFIG_MAX_FABRICS 16
 #endif // CHIP_CONFIG_MAX_FABRICS
 
+/**
+ *  @def CHIP_CONFIG_CERT_VALIDATION_CACHE_SIZE
+ *
+ *  @brief
+ *    Number of certificate signatures the fabric table remembers having
+ *    verified, so that repeated CASE handshakes with the same peers skip
+ *    their ECDSA verifications.  0 disables the cache.
+ */
+#ifndef CHIP_CONFIG_CERT_VALIDATION_CACHE_SIZE
+#define CHIP_CONFIG_CERT_VALIDATION_CACHE_SIZE 8
+#endif // CHIP_CONFIG_CERT_VALIDATION_CACHE_SIZE
+
 /**
  *  @def CHIP_CONFIG_MAX_GROUP_DATA_PEERS
  *
@@ -787,6 +860,11 @@ extern const char CHIP_NON_PRODUCTION_MARKER[];
  *      * #CHIP_IM_MAX_REPORTS_IN_FLIGHT
  *      * #CHIP_IM_SERVER_MAX_NUM_PATH_GROUPS
  *      * #CHIP_IM_SERVER_MAX_NUM_DIRTY_SET
+ *      * #CHIP_IM_SERVER_REPORT_CACHE_SIZE
+ *      * #CHIP_IM_SERVER_REPORT_CACHE_MAX_ENTRIES
+ *      * #CHIP_IM_REPORT_SCHEDULER_NUM_BUCKETS
+ *      * #CHIP_IM_REPORT_SCHEDULER_BUCKET_WIDTH_MS
+ *      * #CHIP_IM_REPORT_SCHEDULER_COALESCING_WINDOW_MS
  *      * #CHIP_IM_MAX_NUM_WRITE_HANDLER
  *      * #CHIP_IM_MAX_NUM_WRITE_CLIENT
  *      * #CHIP_IM_MAX_NUM_TIMED_HANDLER
@@ -864,6 +942,54 @@ extern const char CHIP_NON_PRODUCTION_MARKER[];
 #define CHIP_IM_SERVER_MAX_NUM_DIRTY_SET 8
 #endif
 
+/**
+ * @def CHIP_IM_SERVER_REPORT_CACHE_SIZE
+ *
+ * @brief Defines the size in bytes of the buffer used by the reporting engine to share encoded attribute data between the
+ *        ReadHandlers serviced in the same run. Setting this to 0 disables the cache.
+ */
+#ifndef CHIP_IM_SERVER_REPORT_CACHE_SIZE
+#define CHIP_IM_SERVER_REPORT_CACHE_SIZE 0
+#endif
+
+/**
+ * @def CHIP_IM_SERVER_REPORT_CACHE_MAX_ENTRIES
+ *
+ * @brief Defines the maximum number of attribute encodings held by the reporting engine cache.
+ */
+#ifndef CHIP_IM_SERVER_REPORT_CACHE_MAX_ENTRIES
+#define CHIP_IM_SERVER_REPORT_CACHE_MAX_ENTRIES 32
+#endif
+
+/**
+ * @def CHIP_IM_REPORT_SCHEDULER_NUM_BUCKETS
+ *
+ * @brief Defines the number of buckets in the calendar queues used by the default report scheduler to order subscription
+ *        deadlines.
+ */
+#ifndef CHIP_IM_REPORT_SCHEDULER_NUM_BUCKETS
+#define CHIP_IM_REPORT_SCHEDULER_NUM_BUCKETS 16
+#endif
+
+/**
+ * @def CHIP_IM_REPORT_SCHEDULER_BUCKET_WIDTH_MS
+ *
+ * @brief Defines the span of time, in milliseconds, covered by each bucket of the report scheduler calendar queues.
+ */
+#ifndef CHIP_IM_REPORT_SCHEDULER_BUCKET_WIDTH_MS
+#define CHIP_IM_REPORT_SCHEDULER_BUCKET_WIDTH_MS 1000
+#endif
+
+/**
+ * @def CHIP_IM_REPORT_SCHEDULER_COALESCING_WINDOW_MS
+ *
+ * @brief Defines how early, in milliseconds, the max interval of a subscription may be signaled so that its report is sent in
+ *        the same wakeup as other reports. Setting this to 0 signals every max interval exactly when it elapses.
+ */
+#ifndef CHIP_IM_REPORT_SCHEDULER_COALESCING_WINDOW_MS
+#define CHIP_IM_REPORT_SCHEDULER_COALESCING_WINDOW_MS 1000
+#endif
+
 /**
  * @def CHIP_IM_MAX_NUM_WRITE_HANDLER
  *
@@ -950,6 +1076,15 @@ extern const char CHIP_NON_PRODUCTION_MARKER[];
 #define CHIP_CONFIG_CONTROLLER_MAX_ACTIVE_CASE_CLIENTS 16
 #endif
 
+/**
+ * @def CHIP_CONFIG_CASE_SESSION_SCHEDULER_MAX_REQUESTS
+ *
+ * @brief Number of session establishment requests a CASESessionScheduler can queue.
+ */
+#ifndef CHIP_CONFIG_CASE_SESSION_SCHEDULER_MAX_REQUESTS
+#define CHIP_CONFIG_CASE_SESSION_SCHEDULER_MAX_REQUESTS CHIP_CONFIG_CONTROLLER_MAX_ACTIVE_DEVICES
+#endif
+
 /**
  * @def CHIP_CONFIG_DEVICE_MAX_ACTIVE_CASE_CLIENTS
  *
@@ -1260,6 +1395,65 @@ extern const char CHIP_NON_PRODUCTION_MARKER[];
 #define CHIP_CONFIG_MINMDNS_MAX_PARALLEL_RESOLVES 2
 #endif // CHIP_CONFIG_MINMDNS_MAX_PARALLEL_RESOLVES
 
+/*
+ * @def CHIP_CONFIG_MINMDNS_MAX_PENDING_QUERIES
+ *
+ * @brief Determines the number of resolves and browses for which the minmdns
+ *        resolver keeps retrying queries until a reply is received. Starting
+ *        more evicts the oldest pending ones, which then only get their first
+ *        query.
+ *
+ *        Controllers which resolve many nodes at once (see
+ *        Dnssd::Resolver::ResolveNodeIds) should raise this to the number of
+ *        nodes they expect to resolve together.
+ */
+#ifndef CHIP_CONFIG_MINMDNS_MAX_PENDING_QUERIES
+#define CHIP_CONFIG_MINMDNS_MAX_PENDING_QUERIES 4
+#endif // CHIP_CONFIG_MINMDNS_MAX_PENDING_QUERIES
+
+/*
+ * @def CHIP_CONFIG_MINMDNS_RECORD_CACHE_SIZE
+ *
+ * @brief Determines the number of DNS-SD services (SRV/TXT records) and the number
+ *        of hosts (AAAA records) the minmdns resolver caches. Operational resolves
+ *        of cached nodes are answered without querying the network for as long
+ *        as their records are valid.
+ *
+ *        Controllers which keep reconnecting to many nodes should raise this to
+ *        the number of nodes they manage.
+ */
+#ifndef CHIP_CONFIG_MINMDNS_RECORD_CACHE_SIZE
+#define CHIP_CONFIG_MINMDNS_RECORD_CACHE_SIZE 8
+#endif // CHIP_CONFIG_MINMDNS_RECORD_CACHE_SIZE
+
+/*
+ * @def CHIP_CONFIG_MINMDNS_MAX_THROTTLED_INTERFACES
+ *
+ * @brief Determines the number of interfaces on which the minmdns advertiser
+ *        tracks when each record was last multicast, to multicast every record
+ *        at most once per second per interface (RFC 6762 section 6).
+ *
+ *        Devices answering queries on more interfaces may multicast records
+ *        more often on some of them.
+ */
+#ifndef CHIP_CONFIG_MINMDNS_MAX_THROTTLED_INTERFACES
+#define CHIP_CONFIG_MINMDNS_MAX_THROTTLED_INTERFACES 2
+#endif // CHIP_CONFIG_MINMDNS_MAX_THROTTLED_INTERFACES
+
+/*
+ * @def CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE
+ *
+ * @brief Determines the number of serialized unicast responses the minmdns
+ *        advertiser keeps to answer repeated queries without walking its
+ *        records again. Cached responses are allocated on the heap and dropped
+ *        whenever the advertised records change.
+ *
+ *        Set to 0 to disable the cache.
+ */
+#ifndef CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE
+#define CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE 4
+#endif // CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE
+
 /*
  * @def CHIP_CONFIG_NETWORK_COMMISSIONING_DEBUG_TEXT_BUFFER_SIZE
  *
@@ -1305,6 +1499,29 @@ extern const char CHIP_NON_PRODUCTION_MARKER[];
 #ifndef CHIP_CONFIG_NUM_CD_KEY_SLOTS
 #define CHIP_CONFIG_NUM_CD_KEY_SLOTS 5
 #endif // CHIP_CONFIG_NUM_CD_KEY_SLOTS
+
+/**
+ * @def CHIP_CONFIG_BDX_MAX_WINDOW_SIZE
+ *
+ * @brief Largest number of Blocks a BDX sender may send ahead of the receiver in a windowed transfer.
+ *
+ * Each TransferSession keeps the length of that many Blocks to be able to send them again.
+ */
+#ifndef CHIP_CONFIG_BDX_MAX_WINDOW_SIZE
+#define CHIP_CONFIG_BDX_MAX_WINDOW_SIZE 16
+#endif // CHIP_CONFIG_BDX_MAX_WINDOW_SIZE
+
+/**
+ * @def CHIP_CONFIG_BDX_WINDOW_RECOVERY_INTERVAL_MS
+ *
+ * @brief Time after which the receiver of a windowed BDX transfer asks again for the Blocks it is waiting for.
+ *
+ * The Blocks of a windowed transfer are not acknowledged by MRP, so the receiver sends a BlockQueryWithSkip when it receives
+ * no Block for this long.
+ */
+#ifndef CHIP_CONFIG_BDX_WINDOW_RECOVERY_INTERVAL_MS
+#define CHIP_CONFIG_BDX_WINDOW_RECOVERY_INTERVAL_MS 1000
+#endif // CHIP_CONFIG_BDX_WINDOW_RECOVERY_INTERVAL_MS
 /**
  * @}
  */
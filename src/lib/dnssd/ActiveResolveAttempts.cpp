@@ -17,9 +17,12 @@
 
 #include "ActiveResolveAttempts.h"
 
+#include <lib/support/CHIPMem.h>
+#include <lib/support/CodeUtils.h>
 #include <lib/support/logging/CHIPLogging.h>
 
 #include <algorithm>
+#include <new>
 
 using namespace chip;
 
@@ -29,17 +32,71 @@ namespace Minimal {
 constexpr chip::System::Clock::Timeout ActiveResolveAttempts::kMaxRetryDelay;
 
 void ActiveResolveAttempts::Reset()
+{
+    FreeRetryQueue();
+}
 
+void ActiveResolveAttempts::FreeRetryQueue()
 {
-    for (auto & item : mRetryQueue)
+    if (mRetryQueue != mInlineRetryQueue)
+    {
+        for (auto & item : RetryQueue())
+        {
+            item.~RetryEntry();
+        }
+        chip::Platform::MemoryFree(mRetryQueue);
+
+        mRetryQueue     = mInlineRetryQueue;
+        mRetryQueueSize = kRetryQueueSize;
+    }
+
+    for (auto & item : mInlineRetryQueue)
     {
         item.attempt.Clear();
     }
 }
 
+bool ActiveResolveAttempts::Reserve(size_t count)
+{
+    size_t required = count;
+    for (auto & item : RetryQueue())
+    {
+        if (!item.attempt.IsEmpty())
+        {
+            required++;
+        }
+    }
+    VerifyOrReturnValue(required > mRetryQueueSize, true);
+
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    auto * queue = static_cast<RetryEntry *>(chip::Platform::MemoryCalloc(required, sizeof(RetryEntry)));
+    VerifyOrReturnValue(queue != nullptr, false);
+
+    // Entries keep their place in the queue
+    for (size_t i = 0; i < required; i++)
+    {
+        if (i < mRetryQueueSize)
+        {
+            new (&queue[i]) RetryEntry(mRetryQueue[i]);
+        }
+        else
+        {
+            new (&queue[i]) RetryEntry();
+        }
+    }
+
+    FreeRetryQueue();
+    mRetryQueue     = queue;
+    mRetryQueueSize = required;
+    return true;
+#else
+    return false;
+#endif // CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+}
+
 void ActiveResolveAttempts::Complete(const PeerId & peerId)
 {
-    for (auto & item : mRetryQueue)
+    for (auto & item : RetryQueue())
     {
         if (item.attempt.Matches(peerId))
         {
@@ -57,7 +114,7 @@ void ActiveResolveAttempts::Complete(const PeerId & peerId)
 
 void ActiveResolveAttempts::Complete(const chip::Dnssd::DiscoveredNodeData & data)
 {
-    for (auto & item : mRetryQueue)
+    for (auto & item : RetryQueue())
     {
         if (item.attempt.Matches(data))
         {
@@ -69,7 +126,7 @@ void ActiveResolveAttempts::Complete(const chip::Dnssd::DiscoveredNodeData & dat
 
 void ActiveResolveAttempts::CompleteIpResolution(SerializedQNameIterator targetHostName)
 {
-    for (auto & item : mRetryQueue)
+    for (auto & item : RetryQueue())
     {
         if (item.attempt.MatchesIpResolve(targetHostName))
         {
@@ -105,7 +162,7 @@ void ActiveResolveAttempts::MarkPending(ScheduledAttempt && attempt)
 
     RetryEntry * entryToUse = &mRetryQueue[0];
 
-    for (size_t i = 1; i < kRetryQueueSize; i++)
+    for (size_t i = 1; i < mRetryQueueSize; i++)
     {
         if (entryToUse->attempt.Matches(attempt))
         {
@@ -170,7 +227,7 @@ Optional<System::Clock::Timeout> ActiveResolveAttempts::GetTimeUntilNextExpected
 
     chip::System::Clock::Timestamp now = mClock->GetMonotonicTimestamp();
 
-    for (auto & entry : mRetryQueue)
+    for (auto & entry : RetryQueue())
     {
         if (entry.attempt.IsEmpty())
         {
@@ -197,7 +254,7 @@ Optional<ActiveResolveAttempts::ScheduledAttempt> ActiveResolveAttempts::NextSch
 {
     chip::System::Clock::Timestamp now = mClock->GetMonotonicTimestamp();
 
-    for (auto & entry : mRetryQueue)
+    for (auto & entry : RetryQueue())
     {
         if (entry.attempt.IsEmpty())
         {
@@ -230,7 +287,7 @@ Optional<ActiveResolveAttempts::ScheduledAttempt> ActiveResolveAttempts::NextSch
 
 bool ActiveResolveAttempts::IsWaitingForIpResolutionFor(SerializedQNameIterator hostName) const
 {
-    for (auto & entry : mRetryQueue)
+    for (auto & entry : RetryQueue())
     {
         if (entry.attempt.IsEmpty())
         {
@@ -251,5 +308,21 @@ bool ActiveResolveAttempts::IsWaitingForIpResolutionFor(SerializedQNameIterator
     return false;
 }
 
+size_t ActiveResolveAttempts::GetPendingResolves(chip::PeerId * peers, size_t maxPeers, size_t & cursor) const
+{
+    size_t count = 0;
+
+    for (; cursor < mRetryQueueSize && count < maxPeers; cursor++)
+    {
+        const RetryEntry & entry = mRetryQueue[cursor];
+        if (entry.attempt.IsResolve())
+        {
+            peers[count++] = entry.attempt.ResolveData().peerId;
+        }
+    }
+
+    return count;
+}
+
 } // namespace Minimal
 } // namespace mdns
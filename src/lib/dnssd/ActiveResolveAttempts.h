@@ -20,12 +20,15 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <lib/core/CHIPConfig.h>
 #include <lib/core/Optional.h>
 #include <lib/core/PeerId.h>
 #include <lib/dnssd/Resolver.h>
 #include <lib/dnssd/minimal_mdns/core/HeapQName.h>
+#include <lib/support/Span.h>
 #include <lib/support/Variant.h>
 #include <system/SystemClock.h>
+#include <system/SystemConfig.h>
 
 namespace mdns {
 namespace Minimal {
@@ -41,7 +44,7 @@ namespace Minimal {
 class ActiveResolveAttempts
 {
 public:
-    static constexpr size_t kRetryQueueSize                      = 4;
+    static constexpr size_t kRetryQueueSize                      = CHIP_CONFIG_MINMDNS_MAX_PENDING_QUERIES;
     static constexpr chip::System::Clock::Timeout kMaxRetryDelay = chip::System::Clock::Seconds16(16);
 
     struct ScheduledAttempt
@@ -195,10 +198,27 @@ public:
     };
 
     ActiveResolveAttempts(chip::System::Clock::ClockBase * clock) : mClock(clock) { Reset(); }
+    ~ActiveResolveAttempts() { FreeRetryQueue(); }
+
+    ActiveResolveAttempts(const ActiveResolveAttempts &) = delete;
+    ActiveResolveAttempts & operator=(const ActiveResolveAttempts &) = delete;
 
     /// Clear out the internal queue
     void Reset();
 
+    /// Make room for [count] more pending attempts, so that marking them
+    /// pending does not evict any attempt.
+    ///
+    /// The queue grows on the heap when heap pools are used
+    /// (CHIP_SYSTEM_CONFIG_POOL_USE_HEAP), until the next Reset. Otherwise it
+    /// keeps its kRetryQueueSize entries.
+    ///
+    /// Returns whether the queue has room for [count] more attempts.
+    bool Reserve(size_t count);
+
+    /// Number of attempts the queue holds before evicting the oldest one
+    size_t GetCapacity() const { return mRetryQueueSize; }
+
     /// Mark a resolution as a success, removing it from the internal list
     void Complete(const chip::PeerId & peerId);
     void Complete(const chip::Dnssd::DiscoveredNodeData & data);
@@ -231,6 +251,15 @@ public:
     /// IP resolution.
     bool IsWaitingForIpResolutionFor(SerializedQNameIterator hostName) const;
 
+    /// Get the peer ids of the pending operational resolves, starting at
+    /// entry [cursor] of the queue.
+    ///
+    /// Fills up to [maxPeers] entries of [peers], moves [cursor] past the
+    /// entries read and returns the number of entries filled. Entries keep
+    /// their place in the queue, so reading can continue after completing
+    /// some of the resolves.
+    size_t GetPendingResolves(chip::PeerId * peers, size_t maxPeers, size_t & cursor) const;
+
 private:
     struct RetryEntry
     {
@@ -249,8 +278,19 @@ private:
         chip::System::Clock::Timeout nextRetryDelay = chip::System::Clock::Seconds16(1);
     };
     void MarkPending(ScheduledAttempt && attempt);
+
+    chip::Span<RetryEntry> RetryQueue() { return chip::Span<RetryEntry>(mRetryQueue, mRetryQueueSize); }
+    chip::Span<const RetryEntry> RetryQueue() const { return chip::Span<const RetryEntry>(mRetryQueue, mRetryQueueSize); }
+
+    /// Go back to the inline queue, clearing every entry
+    void FreeRetryQueue();
+
     chip::System::Clock::ClockBase * mClock;
-    RetryEntry mRetryQueue[kRetryQueueSize];
+    RetryEntry mInlineRetryQueue[kRetryQueueSize];
+
+    // Either the inline queue, or a larger one on the heap made by Reserve
+    RetryEntry * mRetryQueue = mInlineRetryQueue;
+    size_t mRetryQueueSize   = kRetryQueueSize;
 };
 
 } // namespace Minimal
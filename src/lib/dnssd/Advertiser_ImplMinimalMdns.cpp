@@ -304,10 +304,12 @@ void AdvertiserMinMdns::OnMdnsPacketData(const BytesRange & data, const chip::In
 #endif
 
     mCurrentSource = info;
+    mResponseSender.SetKnownAnswers(data);
     if (!ParsePacket(data, this))
     {
         ChipLogError(Discovery, "Failed to parse mDNS query");
     }
+    mResponseSender.ClearKnownAnswers();
     mCurrentSource = nullptr;
 }
 
@@ -345,6 +347,7 @@ CHIP_ERROR AdvertiserMinMdns::Init(chip::Inet::EndPointManager<chip::Inet::UDPEn
     // Re-set the server in the response sender in case this has been swapped in the
     // GlobalMinimalMdnsServer (used for testing).
     mResponseSender.SetServer(&GlobalMinimalMdnsServer::Server());
+    mResponseSender.SetSystemLayer(&udpEndPointManager->SystemLayer());
 
     ReturnErrorOnFailure(GlobalMinimalMdnsServer::Instance().StartServer(udpEndPointManager, kMdnsPort));
 
@@ -361,12 +364,19 @@ void AdvertiserMinMdns::Shutdown()
 {
     AdvertiseRecords(BroadcastAdvertiseType::kRemovingAll);
 
+    // Pending replies were sent by the removal broadcast
+    mResponseSender.SetSystemLayer(nullptr);
+
     GlobalMinimalMdnsServer::Server().Shutdown();
     mIsInitialized = false;
 }
 
 CHIP_ERROR AdvertiserMinMdns::RemoveServices()
 {
+    // Replies built from the services being removed
+    LogErrorOnFailure(mResponseSender.FlushDelayedResponse());
+    mResponseSender.InvalidateResponseCache();
+
     while (mOperationalResponders.begin() != mOperationalResponders.end())
     {
         auto it = mOperationalResponders.begin();
@@ -872,6 +882,9 @@ void AdvertiserMinMdns::AdvertiseRecords(BroadcastAdvertiseType type)
         responseConfiguration.SetTtlSecondsOverride(0);
     }
 
+    // Advertised data is about to change or just changed
+    mResponseSender.InvalidateResponseCache();
+
     UniquePtr<ListenIterator> allInterfaces = GetAddressPolicy()->GetListenEndpoints();
 
     chip::Inet::InterfaceId interfaceId;
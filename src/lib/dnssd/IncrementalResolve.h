@@ -146,6 +146,14 @@ public:
     /// it was parsed so far.
     CHIP_ERROR Take(ResolvedNodeData & outputData);
 
+    /// Notify that a new IP addres has been found.
+    ///
+    /// This is to be called on both A (if IPv4 support is enabled) and AAAA
+    /// addresses, received or cached.
+    ///
+    /// Prerequisite: IP address belongs to the right nost name
+    CHIP_ERROR OnIpAddress(Inet::InterfaceId interface, const Inet::IPAddress & addr);
+
     /// Clears current state, setting as inactive
     void ResetToInactive()
     {
@@ -159,14 +167,6 @@ private:
     /// Input data MUST have GetType() == QType::TXT
     CHIP_ERROR OnTxtRecord(const mdns::Minimal::ResourceData & data, mdns::Minimal::BytesRange packetRange);
 
-    /// Notify that a new IP addres has been found.
-    ///
-    /// This is to be called on both A (if IPv4 support is enabled) and AAAA
-    /// addresses.
-    ///
-    /// Prerequisite: IP address belongs to the right nost name
-    CHIP_ERROR OnIpAddress(Inet::InterfaceId interface, const Inet::IPAddress & addr);
-
     using ParsedRecordSpecificData = Variant<OperationalNodeData, CommissionNodeData>;
 
     StoredServerName mRecordName;     // Record name for what is parsed (SRV/PTR/TXT)
@@ -0,0 +1,512 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+#include <lib/dnssd/RecordCache.h>
+
+#include <lib/dnssd/ServiceNaming.h>
+#include <lib/dnssd/TxtFields.h>
+#include <lib/dnssd/minimal_mdns/RecordData.h>
+#include <lib/dnssd/minimal_mdns/core/HeapQName.h>
+#include <lib/dnssd/minimal_mdns/records/Ptr.h>
+#include <lib/support/CHIPMemString.h>
+#include <lib/support/CodeUtils.h>
+
+namespace chip {
+namespace Dnssd {
+
+using namespace mdns::Minimal;
+using System::Clock::Timestamp;
+
+constexpr size_t RecordCache::kServiceCacheSize;
+constexpr size_t RecordCache::kHostCacheSize;
+constexpr size_t RecordCache::kMaxTxtSize;
+constexpr uint32_t RecordCache::kMaxTtlSeconds;
+
+namespace {
+
+// Service types of the instances cached
+constexpr QNamePart kOperationalSuffix[]    = { kOperationalServiceName, kOperationalProtocol, kLocalDomain };
+constexpr QNamePart kCommissionableSuffix[] = { kCommissionableServiceName, kCommissionProtocol, kLocalDomain };
+constexpr QNamePart kCommissionerSuffix[]   = { kCommissionerServiceName, kCommissionProtocol, kLocalDomain };
+
+// RFC 6762 section 10.2: records older than this are flushed by a record with the cache-flush bit
+constexpr System::Clock::Milliseconds64 kCacheFlushDelay = System::Clock::Seconds16(1);
+
+/// Advances [name] past its instance label, so that it compares as the service type.
+bool SkipInstanceLabel(SerializedQNameIterator & name)
+{
+    return name.Next() && name.IsValid();
+}
+
+bool IsMatterInstanceName(SerializedQNameIterator name)
+{
+    return SkipInstanceLabel(name) && (name == kOperationalSuffix || name == kCommissionableSuffix || name == kCommissionerSuffix);
+}
+
+/// A TXT record replaying the data of a received one
+class CachedTxtResourceRecord : public ResourceRecord
+{
+public:
+    CachedTxtResourceRecord(const FullQName & qName, const BytesRange & data) : ResourceRecord(QType::TXT, qName), mData(data) {}
+
+protected:
+    bool WriteData(RecordWriter & out) const override { return out.Put(mData).Fit(); }
+
+private:
+    const BytesRange mData;
+};
+
+class TxtParser : public TxtRecordDelegate
+{
+public:
+    explicit TxtParser(CommonResolutionData & data) : mData(data) {}
+    void OnRecord(const BytesRange & name, const BytesRange & value) override
+    {
+        FillNodeDataFromTxt(ByteSpan(name.Start(), name.Size()), ByteSpan(value.Start(), value.Size()), mData);
+    }
+
+private:
+    CommonResolutionData & mData;
+};
+
+} // namespace
+
+void RecordCache::RecordTtl::Set(Timestamp now, uint64_t ttl)
+{
+    received   = now;
+    ttlSeconds = static_cast<uint32_t>(std::min<uint64_t>(ttl, kMaxTtlSeconds));
+}
+
+bool RecordCache::RecordTtl::IsKnownAnswer(Timestamp now) const
+{
+    return ttlSeconds > 0 && now < received + System::Clock::Milliseconds64(ttlSeconds * 500ull);
+}
+
+uint32_t RecordCache::RecordTtl::GetRemainingSeconds(Timestamp now) const
+{
+    VerifyOrReturnValue(IsValid(now), 0);
+    return static_cast<uint32_t>(std::chrono::duration_cast<System::Clock::Seconds32>(Expiry() - now).count());
+}
+
+bool RecordCache::HostEntry::HasValidAddress(Timestamp now) const
+{
+    for (size_t i = 0; i < numAddresses; i++)
+    {
+        if (addressTtls[i].IsValid(now))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RecordCache::Clear()
+{
+    for (auto & service : mServices)
+    {
+        service.Clear();
+    }
+    for (auto & host : mHosts)
+    {
+        host.Clear();
+    }
+}
+
+void RecordCache::OnRecord(Inet::InterfaceId interface, const ResourceData & data, BytesRange packetRange)
+{
+    switch (data.GetType())
+    {
+    case QType::SRV:
+        OnSrvRecord(data, packetRange);
+        break;
+    case QType::TXT:
+        OnTxtRecord(data);
+        break;
+    case QType::PTR:
+        OnPtrRecord(data, packetRange);
+        break;
+    case QType::AAAA: {
+        Inet::IPAddress address;
+        if (ParseAAAARecord(data.GetData(), &address))
+        {
+            OnIpAddress(interface, data, address);
+        }
+        break;
+    }
+#if INET_CONFIG_ENABLE_IPV4
+    case QType::A: {
+        Inet::IPAddress address;
+        if (ParseARecord(data.GetData(), &address))
+        {
+            OnIpAddress(interface, data, address);
+        }
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+}
+
+void RecordCache::OnSrvRecord(const ResourceData & data, BytesRange packetRange)
+{
+    VerifyOrReturn(IsMatterInstanceName(data.GetName()));
+
+    SrvRecord srv;
+    VerifyOrReturn(srv.Parse(data.GetData(), packetRange));
+
+    const Timestamp now     = mClock->GetMonotonicTimestamp();
+    ServiceEntry * existing = FindService(data.GetName());
+
+    if (data.GetTtlSeconds() == 0)
+    {
+        if (existing != nullptr)
+        {
+            existing->Clear();
+        }
+        return;
+    }
+
+    ServiceEntry & service = (existing != nullptr) ? *existing : AllocateService();
+    if (existing == nullptr)
+    {
+        service.Clear();
+        if (service.instanceName.Set(data.GetName()) != CHIP_NO_ERROR)
+        {
+            return;
+        }
+    }
+
+    if (service.hostName.Set(srv.GetName()) != CHIP_NO_ERROR)
+    {
+        service.Clear();
+        return;
+    }
+    service.port = srv.GetPort();
+    service.srv.Set(now, data.GetTtlSeconds());
+}
+
+void RecordCache::OnTxtRecord(const ResourceData & data)
+{
+    ServiceEntry * service = FindService(data.GetName());
+    VerifyOrReturn(service != nullptr);
+
+    service->txt.Clear();
+    VerifyOrReturn(data.GetTtlSeconds() > 0 && data.GetData().Size() <= sizeof(service->txtData));
+
+    memcpy(service->txtData, data.GetData().Start(), data.GetData().Size());
+    service->txtSize = data.GetData().Size();
+    service->txt.Set(mClock->GetMonotonicTimestamp(), data.GetTtlSeconds());
+}
+
+void RecordCache::OnPtrRecord(const ResourceData & data, BytesRange packetRange)
+{
+    SerializedQNameIterator instanceName;
+    VerifyOrReturn(ParsePtrRecord(data.GetData(), packetRange, &instanceName));
+
+    ServiceEntry * service = FindService(instanceName);
+    VerifyOrReturn(service != nullptr);
+
+    // Only the PTR record of the service type itself is cached, not the ones of its subtypes
+    SerializedQNameIterator serviceName = service->instanceName.Get();
+    VerifyOrReturn(SkipInstanceLabel(serviceName) && serviceName == data.GetName());
+
+    if (data.GetTtlSeconds() == 0)
+    {
+        service->ptr.Clear();
+        return;
+    }
+    service->ptr.Set(mClock->GetMonotonicTimestamp(), data.GetTtlSeconds());
+}
+
+void RecordCache::OnIpAddress(Inet::InterfaceId interface, const ResourceData & data, const Inet::IPAddress & address)
+{
+    const Timestamp now = mClock->GetMonotonicTimestamp();
+    HostEntry * host    = FindHost(data.GetName());
+
+    if (host == nullptr)
+    {
+        VerifyOrReturn(data.GetTtlSeconds() > 0 && IsTargetOfValidService(data.GetName()));
+        host = &AllocateHost();
+        host->Clear();
+        VerifyOrReturn(host->hostName.Set(data.GetName()) == CHIP_NO_ERROR);
+        host->interface = interface;
+    }
+    else if (host->interface != interface)
+    {
+        // Like the resolver, only keep the addresses received over a single interface: the latest one.
+        host->numAddresses = 0;
+        host->interface    = interface;
+    }
+
+    // Drop the addresses the record replaces: its own previous value, or all the older
+    // addresses of the host if it has the cache-flush bit.
+    const bool flush = (data.GetClass() == QClass::IN_FLUSH);
+    size_t kept      = 0;
+    for (size_t i = 0; i < host->numAddresses; i++)
+    {
+        const bool replaced = (host->addresses[i] == address) || !host->addressTtls[i].IsValid(now) ||
+            (flush && now >= host->addressTtls[i].received + kCacheFlushDelay);
+        if (!replaced)
+        {
+            host->addresses[kept]   = host->addresses[i];
+            host->addressTtls[kept] = host->addressTtls[i];
+            kept++;
+        }
+    }
+    host->numAddresses = kept;
+
+    VerifyOrReturn(data.GetTtlSeconds() > 0);
+
+    size_t index = host->numAddresses;
+    if (index == ArraySize(host->addresses))
+    {
+        // Replace the address which expires first
+        index = 0;
+        for (size_t i = 1; i < host->numAddresses; i++)
+        {
+            if (host->addressTtls[i].Expiry() < host->addressTtls[index].Expiry())
+            {
+                index = i;
+            }
+        }
+    }
+    else
+    {
+        host->numAddresses++;
+    }
+
+    host->addresses[index] = address;
+    host->addressTtls[index].Set(now, data.GetTtlSeconds());
+}
+
+CHIP_ERROR RecordCache::GetOperationalNode(const PeerId & peerId, ResolvedNodeData & nodeData)
+{
+    const Timestamp now    = mClock->GetMonotonicTimestamp();
+    ServiceEntry * service = FindOperationalService(peerId);
+
+    VerifyOrReturnError(service != nullptr && service->srv.IsValid(now), CHIP_ERROR_NOT_FOUND);
+
+    HostEntry * host = FindHost(service->hostName.Get());
+    VerifyOrReturnError(host != nullptr && host->HasValidAddress(now), CHIP_ERROR_NOT_FOUND);
+
+    nodeData                        = ResolvedNodeData();
+    nodeData.operationalData.peerId = peerId;
+
+    CommonResolutionData & resolution = nodeData.resolutionData;
+    resolution.port                   = service->port;
+    resolution.interfaceId            = host->interface;
+
+    // Like the resolver, only keep the first label of the host name
+    SerializedQNameIterator hostName = service->hostName.Get();
+    if (hostName.Next() && hostName.IsValid())
+    {
+        Platform::CopyString(resolution.hostName, hostName.Value());
+    }
+
+    for (size_t i = 0; i < host->numAddresses && resolution.numIPs < ArraySize(resolution.ipAddress); i++)
+    {
+        if (host->addressTtls[i].IsValid(now))
+        {
+            resolution.ipAddress[resolution.numIPs++] = host->addresses[i];
+        }
+    }
+
+    FillTxtData(peerId, resolution);
+
+    return CHIP_NO_ERROR;
+}
+
+bool RecordCache::FillTxtData(const PeerId & peerId, CommonResolutionData & data)
+{
+    ServiceEntry * service = FindOperationalService(peerId);
+    VerifyOrReturnValue(service != nullptr && service->txt.IsValid(mClock->GetMonotonicTimestamp()), false);
+
+    TxtParser delegate(data);
+    return ParseTxtRecord(BytesRange(service->txtData, service->txtData + service->txtSize), &delegate);
+}
+
+size_t RecordCache::FillAddresses(SerializedQNameIterator hostName, IncrementalResolver & resolver)
+{
+    const Timestamp now = mClock->GetMonotonicTimestamp();
+    HostEntry * host    = FindHost(hostName);
+    size_t count        = 0;
+
+    VerifyOrReturnValue(host != nullptr, 0);
+
+    for (size_t i = 0; i < host->numAddresses; i++)
+    {
+        if (host->addressTtls[i].IsValid(now) && resolver.OnIpAddress(host->interface, host->addresses[i]) == CHIP_NO_ERROR)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+void RecordCache::AddKnownTxtAnswer(QueryBuilder & builder, const FullQName & instanceName)
+{
+    const Timestamp now    = mClock->GetMonotonicTimestamp();
+    ServiceEntry * service = FindService(instanceName);
+
+    VerifyOrReturn(service != nullptr && service->txt.IsKnownAnswer(now));
+
+    CachedTxtResourceRecord record(instanceName, BytesRange(service->txtData, service->txtData + service->txtSize));
+    record.SetTtl(service->txt.GetRemainingSeconds(now));
+    builder.AddAnswer(record);
+}
+
+void RecordCache::AddKnownPtrAnswers(QueryBuilder & builder, const FullQName & serviceName, Timestamp since)
+{
+    const Timestamp now = mClock->GetMonotonicTimestamp();
+
+    for (auto & service : mServices)
+    {
+        if (!service.ptr.IsKnownAnswer(now) || service.ptr.received < since)
+        {
+            continue;
+        }
+
+        SerializedQNameIterator type = service.instanceName.Get();
+        if (!SkipInstanceLabel(type) || type != serviceName)
+        {
+            continue;
+        }
+
+        HeapQName instanceName(service.instanceName.Get());
+        if (!instanceName.IsOk())
+        {
+            return;
+        }
+
+        PtrResourceRecord record(serviceName, instanceName.Content());
+        record.SetTtl(service.ptr.GetRemainingSeconds(now));
+        if (!builder.AddAnswer(record))
+        {
+            // The packet is full
+            return;
+        }
+    }
+}
+
+RecordCache::ServiceEntry * RecordCache::FindService(SerializedQNameIterator instanceName)
+{
+    for (auto & service : mServices)
+    {
+        if (service.srv.ttlSeconds > 0 && service.instanceName.Get() == instanceName)
+        {
+            return &service;
+        }
+    }
+    return nullptr;
+}
+
+RecordCache::ServiceEntry * RecordCache::FindService(const FullQName & instanceName)
+{
+    for (auto & service : mServices)
+    {
+        if (service.srv.ttlSeconds > 0 && service.instanceName.Get() == instanceName)
+        {
+            return &service;
+        }
+    }
+    return nullptr;
+}
+
+RecordCache::ServiceEntry * RecordCache::FindOperationalService(const PeerId & peerId)
+{
+    char instanceName[kMaxOperationalServiceNameSize];
+    VerifyOrReturnValue(MakeInstanceName(instanceName, sizeof(instanceName), peerId) == CHIP_NO_ERROR, nullptr);
+
+    const QNamePart instanceQName[] = { instanceName, kOperationalServiceName, kOperationalProtocol, kLocalDomain };
+    return FindService(FullQName(instanceQName));
+}
+
+RecordCache::HostEntry * RecordCache::FindHost(SerializedQNameIterator hostName)
+{
+    for (auto & host : mHosts)
+    {
+        if (host.numAddresses > 0 && host.hostName.Get() == hostName)
+        {
+            return &host;
+        }
+    }
+    return nullptr;
+}
+
+bool RecordCache::IsTargetOfValidService(SerializedQNameIterator hostName)
+{
+    const Timestamp now = mClock->GetMonotonicTimestamp();
+
+    for (auto & service : mServices)
+    {
+        if (service.srv.IsValid(now) && service.hostName.Get() == hostName)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+RecordCache::ServiceEntry & RecordCache::AllocateService()
+{
+    const Timestamp now     = mClock->GetMonotonicTimestamp();
+    ServiceEntry * selected = &mServices[0];
+
+    for (auto & service : mServices)
+    {
+        if (!service.srv.IsValid(now))
+        {
+            return service;
+        }
+        if (service.srv.Expiry() < selected->srv.Expiry())
+        {
+            selected = &service;
+        }
+    }
+    return *selected;
+}
+
+RecordCache::HostEntry & RecordCache::AllocateHost()
+{
+    const Timestamp now  = mClock->GetMonotonicTimestamp();
+    HostEntry * selected = nullptr;
+    Timestamp selectedExpiry;
+
+    for (auto & host : mHosts)
+    {
+        // A host expires with its last address
+        Timestamp expiry = System::Clock::kZero;
+        for (size_t i = 0; i < host.numAddresses; i++)
+        {
+            expiry = std::max(expiry, host.addressTtls[i].Expiry());
+        }
+
+        if (expiry <= now)
+        {
+            return host;
+        }
+        if (selected == nullptr || expiry < selectedExpiry)
+        {
+            selected       = &host;
+            selectedExpiry = expiry;
+        }
+    }
+    return *selected;
+}
+
+} // namespace Dnssd
+} // namespace chip
@@ -0,0 +1,181 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+#pragma once
+
+#include <lib/core/CHIPConfig.h>
+#include <lib/dnssd/IncrementalResolve.h>
+#include <lib/dnssd/Resolver.h>
+#include <lib/dnssd/minimal_mdns/Parser.h>
+#include <lib/dnssd/minimal_mdns/QueryBuilder.h>
+#include <lib/dnssd/minimal_mdns/core/QName.h>
+#include <system/SystemClock.h>
+
+namespace chip {
+namespace Dnssd {
+
+/// Caches the DNS-SD records received by the minimal mDNS resolver.
+///
+/// Every response goes through the cache, including unsolicited announcements,
+/// so that:
+///   - operational resolves are answered without querying the network while
+///     the SRV and AAAA records of the node are valid (RFC 6762 section 10)
+///   - resolves which only receive part of their records in a packet can be
+///     completed with the records received before
+///   - outgoing queries can list the answers already known (RFC 6762
+///     section 7.1), see AddKnownTxtAnswer and AddKnownPtrAnswers.
+///
+/// Services are keyed by instance name and hold the SRV, TXT and PTR data of
+/// Matter services. Hosts are keyed by host name and hold their addresses; only
+/// hosts targeted by a cached service are kept.
+///
+/// The cache is bounded: once full, a new entry replaces the one which expires
+/// first.
+class RecordCache
+{
+public:
+    static constexpr size_t kServiceCacheSize = CHIP_CONFIG_MINMDNS_RECORD_CACHE_SIZE;
+    static constexpr size_t kHostCacheSize    = CHIP_CONFIG_MINMDNS_RECORD_CACHE_SIZE;
+
+    // Operational TXT records fit, larger (commissionable) ones are not cached
+    static constexpr size_t kMaxTxtSize = 128;
+
+    // Upper bound of the TTL of a cached record: the longest TTL minimal mDNS advertises
+    static constexpr uint32_t kMaxTtlSeconds = 4500;
+
+    RecordCache(System::Clock::ClockBase * clock) : mClock(clock) {}
+
+    void Clear();
+
+    /// Cache a record of a DNS-SD response.
+    ///
+    /// SRV records must be given before the other records of the same packet,
+    /// since TXT, PTR and address records are only cached for known services.
+    /// A TTL of 0 (goodbye) removes the record.
+    ///
+    /// [packetRange] represents the range of valid bytes within the packet for
+    /// the purpose of QName parsing.
+    void OnRecord(Inet::InterfaceId interface, const mdns::Minimal::ResourceData & data, mdns::Minimal::BytesRange packetRange);
+
+    /// Fill [nodeData] with the cached records of an operational node.
+    ///
+    /// Returns CHIP_ERROR_NOT_FOUND unless both the SRV record of the node and
+    /// at least one address of its host are valid. TXT data is included if
+    /// valid.
+    CHIP_ERROR GetOperationalNode(const PeerId & peerId, ResolvedNodeData & nodeData);
+
+    /// Apply the cached TXT data of an operational node to [data].
+    ///
+    /// Used to complete resolves whose response omitted the TXT record because
+    /// it was listed as a known answer. Returns false if no valid TXT record is
+    /// cached for the node.
+    bool FillTxtData(const PeerId & peerId, CommonResolutionData & data);
+
+    /// Add the valid cached addresses of [hostName] to [resolver].
+    ///
+    /// Returns the number of addresses added.
+    size_t FillAddresses(mdns::Minimal::SerializedQNameIterator hostName, IncrementalResolver & resolver);
+
+    /// List the cached TXT record of an operational instance as a known answer
+    /// of a query for it.
+    ///
+    /// Only the TXT record is listed: the SRV record and the addresses which
+    /// come along with it are needed in the response to resolve the node, and
+    /// resolves get their TXT data from the cache.
+    void AddKnownTxtAnswer(mdns::Minimal::QueryBuilder & builder, const mdns::Minimal::FullQName & instanceName);
+
+    /// List the cached PTR records of [serviceName] received since [since] as
+    /// known answers of a browse query for it.
+    ///
+    /// Instances are expected to have been reported since [since]: responders
+    /// do not answer again for known answers.
+    void AddKnownPtrAnswers(mdns::Minimal::QueryBuilder & builder, const mdns::Minimal::FullQName & serviceName,
+                            System::Clock::Timestamp since);
+
+private:
+    /// Validity of a cached record
+    struct RecordTtl
+    {
+        System::Clock::Timestamp received;
+        uint32_t ttlSeconds = 0;
+
+        void Set(System::Clock::Timestamp now, uint64_t ttl);
+        void Clear() { ttlSeconds = 0; }
+
+        System::Clock::Timestamp Expiry() const { return received + System::Clock::Seconds32(ttlSeconds); }
+        bool IsValid(System::Clock::Timestamp now) const { return ttlSeconds > 0 && now < Expiry(); }
+
+        /// RFC 6762 section 7.1: records are known answers while more than half their TTL remains
+        bool IsKnownAnswer(System::Clock::Timestamp now) const;
+        uint32_t GetRemainingSeconds(System::Clock::Timestamp now) const;
+    };
+
+    struct ServiceEntry
+    {
+        StoredServerName instanceName;
+        StoredServerName hostName;
+        uint16_t port = 0;
+        RecordTtl srv;
+
+        uint8_t txtData[kMaxTxtSize];
+        size_t txtSize = 0;
+        RecordTtl txt;
+
+        RecordTtl ptr;
+
+        void Clear()
+        {
+            srv.Clear();
+            txt.Clear();
+            ptr.Clear();
+        }
+    };
+
+    struct HostEntry
+    {
+        StoredServerName hostName;
+        Inet::InterfaceId interface;
+        size_t numAddresses = 0;
+        Inet::IPAddress addresses[CommonResolutionData::kMaxIPAddresses];
+        RecordTtl addressTtls[CommonResolutionData::kMaxIPAddresses];
+
+        void Clear() { numAddresses = 0; }
+        bool HasValidAddress(System::Clock::Timestamp now) const;
+    };
+
+    void OnSrvRecord(const mdns::Minimal::ResourceData & data, mdns::Minimal::BytesRange packetRange);
+    void OnTxtRecord(const mdns::Minimal::ResourceData & data);
+    void OnPtrRecord(const mdns::Minimal::ResourceData & data, mdns::Minimal::BytesRange packetRange);
+    void OnIpAddress(Inet::InterfaceId interface, const mdns::Minimal::ResourceData & data, const Inet::IPAddress & address);
+
+    ServiceEntry * FindService(mdns::Minimal::SerializedQNameIterator instanceName);
+    ServiceEntry * FindService(const mdns::Minimal::FullQName & instanceName);
+    ServiceEntry * FindOperationalService(const PeerId & peerId);
+    HostEntry * FindHost(mdns::Minimal::SerializedQNameIterator hostName);
+    bool IsTargetOfValidService(mdns::Minimal::SerializedQNameIterator hostName);
+
+    /// Find an entry to store a new service or host: an unused or expired one,
+    /// or else the one which expires first.
+    ServiceEntry & AllocateService();
+    HostEntry & AllocateHost();
+
+    System::Clock::ClockBase * mClock;
+    ServiceEntry mServices[kServiceCacheSize];
+    HostEntry mHosts[kHostCacheSize];
+};
+
+} // namespace Dnssd
+} // namespace chip
@@ -30,6 +30,7 @@
 #include <lib/core/PeerId.h>
 #include <lib/dnssd/Constants.h>
 #include <lib/support/BytesToHex.h>
+#include <lib/support/Span.h>
 #include <messaging/ReliableMessageProtocolConfig.h>
 
 namespace chip {
@@ -374,6 +375,24 @@ public:
      */
     virtual CHIP_ERROR ResolveNodeId(const PeerId & peerId, Inet::IPAddressType type) = 0;
 
+    /**
+     * Requests resolution of several operational node services at once.
+     *
+     * Implementations may pack the queries for all the nodes in as few packets as
+     * possible and share their retries. Results are reported node by node to the
+     * operational delegate as they arrive, like for `ResolveNodeId`.
+     *
+     * The default implementation resolves every node separately.
+     */
+    virtual CHIP_ERROR ResolveNodeIds(Span<const PeerId> peerIds, Inet::IPAddressType type)
+    {
+        for (const PeerId & peerId : peerIds)
+        {
+            ReturnErrorOnFailure(ResolveNodeId(peerId, type));
+        }
+        return CHIP_NO_ERROR;
+    }
+
     /**
      * Finds all commissionable nodes matching the given filter.
      *
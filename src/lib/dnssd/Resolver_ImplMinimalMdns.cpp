@@ -17,12 +17,14 @@
 
 #include "Resolver.h"
 
+#include <algorithm>
 #include <limits>
 
 #include <lib/core/CHIPConfig.h>
 #include <lib/dnssd/ActiveResolveAttempts.h>
 #include <lib/dnssd/IncrementalResolve.h>
 #include <lib/dnssd/MinimalMdnsServer.h>
+#include <lib/dnssd/RecordCache.h>
 #include <lib/dnssd/ResolverProxy.h>
 #include <lib/dnssd/ServiceNaming.h>
 #include <lib/dnssd/minimal_mdns/Logging.h>
@@ -52,14 +54,18 @@ using namespace mdns::Minimal;
 /// Can process multiple incremental resolves based on SRV data and allows
 /// retrieval of pending (e.g. to ask for AAAA) and complete data items.
 ///
+/// All the records of responses are also stored in the record cache.
+///
 class PacketParser : private ParserDelegate
 {
 public:
-    PacketParser(ActiveResolveAttempts & activeResolves) : mActiveResolves(activeResolves) {}
+    PacketParser(ActiveResolveAttempts & activeResolves, RecordCache & recordCache) :
+        mActiveResolves(activeResolves), mRecordCache(recordCache)
+    {}
 
     /// Goes through the given SRV records within a response packet
     /// and sets up data resolution
-    void ParseSrvRecords(const BytesRange & packet);
+    void ParseSrvRecords(Inet::InterfaceId interface, const BytesRange & packet);
 
     /// Goes through non-SRV records and feeds them through the initialized
     /// SRV record parsing.
@@ -104,6 +110,7 @@ private:
 
     // resolvers kept between parse steps
     ActiveResolveAttempts & mActiveResolves;
+    RecordCache & mRecordCache;
     IncrementalResolver mResolvers[kMinMdnsNumParallelResolvers];
 };
 
@@ -114,8 +121,8 @@ void PacketParser::OnHeader(ConstHeaderRef & header)
 #ifdef MINMDNS_RESOLVER_OVERLY_VERBOSE
     if (header.GetFlags().IsTruncated())
     {
-        // MinMdns does not cache data, so receiving piecewise data does not work
-        ChipLogError(Discovery, "Truncated responses not supported for address resolution");
+        // Records of truncated responses are cached, the rest is expected in later packets
+        ChipLogDetail(Discovery, "Received a truncated response");
     }
 #endif
 }
@@ -142,14 +149,16 @@ void PacketParser::OnResource(ResourceType type, const ResourceData & data)
             return;
         }
         mdns::Minimal::Logging::LogReceivedResource(data);
+        mRecordCache.OnRecord(mInterfaceId, data, mPacketRange);
         ParseSRVResource(data);
         break;
     }
     case RecordParsingState::kRecordParsing:
         if (data.GetType() != QType::SRV)
         {
-            // SRV packets logged during 'SrvInitialization' phase
+            // SRV packets logged and cached during 'SrvInitialization' phase
             mdns::Minimal::Logging::LogReceivedResource(data);
+            mRecordCache.OnRecord(mInterfaceId, data, mPacketRange);
         }
         ParseResource(data);
         break;
@@ -235,10 +244,11 @@ void PacketParser::ParseSRVResource(const ResourceData & data)
 #endif
 }
 
-void PacketParser::ParseSrvRecords(const BytesRange & packet)
+void PacketParser::ParseSrvRecords(Inet::InterfaceId interface, const BytesRange & packet)
 {
     mParsingState = RecordParsingState::kSrvInitialization;
     mPacketRange  = packet;
+    mInterfaceId  = interface;
 
     if (!ParsePacket(packet, this))
     {
@@ -265,7 +275,9 @@ void PacketParser::ParseNonSrvRecords(Inet::InterfaceId interface, const BytesRa
 class MinMdnsResolver : public Resolver, public MdnsPacketDelegate
 {
 public:
-    MinMdnsResolver() : mActiveResolves(&chip::System::SystemClock()), mPacketParser(mActiveResolves)
+    MinMdnsResolver() :
+        mActiveResolves(&chip::System::SystemClock()), mRecordCache(&chip::System::SystemClock()),
+        mPacketParser(mActiveResolves, mRecordCache)
     {
         GlobalMinimalMdnsServer::Instance().SetResponseDelegate(this);
     }
@@ -279,25 +291,68 @@ public:
     void SetOperationalDelegate(OperationalResolveDelegate * delegate) override { mOperationalDelegate = delegate; }
     void SetCommissioningDelegate(CommissioningResolveDelegate * delegate) override { mCommissioningDelegate = delegate; }
     CHIP_ERROR ResolveNodeId(const PeerId & peerId, Inet::IPAddressType type) override;
+    CHIP_ERROR ResolveNodeIds(Span<const PeerId> peerIds, Inet::IPAddressType type) override;
     CHIP_ERROR DiscoverCommissionableNodes(DiscoveryFilter filter = DiscoveryFilter()) override;
     CHIP_ERROR DiscoverCommissioners(DiscoveryFilter filter = DiscoveryFilter()) override;
 
 private:
+    /// Operational resolve queries sent together in one packet
+    struct ResolveBatch
+    {
+        // Operational queries take 58 bytes (names are not compressed)
+        static constexpr size_t kMaxQueries = kMdnsMaxPacketSize / 64;
+
+        QueryBuilder builder;
+        PeerId peers[kMaxQueries];
+        size_t count = 0;
+    };
+
     OperationalResolveDelegate * mOperationalDelegate     = nullptr;
     CommissioningResolveDelegate * mCommissioningDelegate = nullptr;
     System::Layer * mSystemLayer                          = nullptr;
     ActiveResolveAttempts mActiveResolves;
+    RecordCache mRecordCache;
     PacketParser mPacketParser;
 
+    // Resolves answered from the record cache, reported from the event loop
+    static constexpr size_t kMaxCachedResolves = ActiveResolveAttempts::kRetryQueueSize;
+    PeerId mCachedResolves[kMaxCachedResolves];
+    size_t mCachedResolveCount = 0;
+
+    // Start of the latest browse, PTR records received since are known answers
+    System::Clock::Timestamp mLastBrowseStart;
+
     void ScheduleIpAddressResolve(SerializedQNameIterator hostName);
 
+    /// Report an operational resolve result to the delegate
+    void OnOperationalNodeResolved(const ResolvedNodeData & nodeData);
+
+    /// Complete the pending operational resolves which the record cache can answer
+    void ResolveFromCache();
+    void ResolveFromCache(const PeerId * peers, size_t count);
+    void ReportCachedResolves();
+
+    /// Schedule reporting [peerId] from the record cache. Returns false if the
+    /// cache cannot answer.
+    bool ScheduleCachedResolve(const PeerId & peerId);
+
     CHIP_ERROR SendAllPendingQueries();
     CHIP_ERROR ScheduleRetries();
+    CHIP_ERROR SendQuery(QueryBuilder & builder, bool firstSend);
+
+    /// Add the query for [peerId] to [batch], sending the batch first if the
+    /// query does not fit.
+    CHIP_ERROR AddToBatch(ResolveBatch & batch, const PeerId & peerId, bool firstSend);
+    CHIP_ERROR SendBatch(ResolveBatch & batch, bool firstSend);
 
     /// Prepare a query for the given schedule attempt
     CHIP_ERROR BuildQuery(QueryBuilder & builder, const ActiveResolveAttempts::ScheduledAttempt & attempt);
 
     /// Prepare a query for specific resolve types
+    ///
+    /// Operational resolve queries are packed with others: they return
+    /// CHIP_ERROR_BUFFER_TOO_SMALL if the packet is full, and their known
+    /// answers are added by SendBatch once all queries are in the packet.
     CHIP_ERROR BuildQuery(QueryBuilder & builder, const ActiveResolveAttempts::ScheduledAttempt::Browse & data, bool firstSend);
     CHIP_ERROR BuildQuery(QueryBuilder & builder, const ActiveResolveAttempts::ScheduledAttempt::Resolve & data, bool firstSend);
     CHIP_ERROR BuildQuery(QueryBuilder & builder, const ActiveResolveAttempts::ScheduledAttempt::IpResolve & data, bool firstSend);
@@ -307,6 +362,7 @@ private:
     void AdvancePendingResolverStates();
 
     static void RetryCallback(System::Layer *, void * self);
+    static void CachedResolveCallback(System::Layer *, void * self);
 
     CHIP_ERROR BrowseNodes(DiscoveryType type, DiscoveryFilter subtype);
     template <typename... Args>
@@ -345,6 +401,13 @@ void MinMdnsResolver::AdvancePendingResolverStates()
 
         IncrementalResolver::RequiredInformationFlags missing = resolver->GetMissingRequiredInformation();
 
+        // Addresses may have been received in an earlier packet
+        if (missing.Has(IncrementalResolver::RequiredInformationBitFlags::kIpAddress) &&
+            mRecordCache.FillAddresses(resolver->GetTargetHostName(), *resolver) > 0)
+        {
+            missing = resolver->GetMissingRequiredInformation();
+        }
+
         if (missing.Has(IncrementalResolver::RequiredInformationBitFlags::kIpAddress))
         {
             ScheduleIpAddressResolve(resolver->GetTargetHostName());
@@ -392,17 +455,11 @@ void MinMdnsResolver::AdvancePendingResolverStates()
                 ChipLogError(Discovery, "Failed to take discovery result: %" CHIP_ERROR_FORMAT, err.Format());
             }
 
+            // The TXT record is omitted from responses when listed as a known answer
+            mRecordCache.FillTxtData(nodeData.operationalData.peerId, nodeData.resolutionData);
+
             mActiveResolves.Complete(nodeData.operationalData.peerId);
-            if (mOperationalDelegate != nullptr)
-            {
-                mOperationalDelegate->OnOperationalNodeResolved(nodeData);
-            }
-            else
-            {
-#if CHIP_MINMDNS_HIGH_VERBOSITY
-                ChipLogError(Discovery, "No delegate to report operational node discovery");
-#endif
-            }
+            OnOperationalNodeResolved(nodeData);
         }
         else
         {
@@ -412,13 +469,72 @@ void MinMdnsResolver::AdvancePendingResolverStates()
     }
 }
 
+void MinMdnsResolver::OnOperationalNodeResolved(const ResolvedNodeData & nodeData)
+{
+    if (mOperationalDelegate != nullptr)
+    {
+        mOperationalDelegate->OnOperationalNodeResolved(nodeData);
+    }
+    else
+    {
+#if CHIP_MINMDNS_HIGH_VERBOSITY
+        ChipLogError(Discovery, "No delegate to report operational node discovery");
+#endif
+    }
+}
+
+void MinMdnsResolver::ResolveFromCache()
+{
+    // Records of a node may come in separate packets, which the incremental
+    // resolvers do not track.
+    PeerId peers[ActiveResolveAttempts::kRetryQueueSize];
+    size_t cursor = 0;
+    size_t count  = 0;
+
+    do
+    {
+        count = mActiveResolves.GetPendingResolves(peers, ArraySize(peers), cursor);
+        ResolveFromCache(peers, count);
+    } while (count == ArraySize(peers));
+}
+
+void MinMdnsResolver::ResolveFromCache(const PeerId * peers, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        ResolvedNodeData nodeData;
+        if (mRecordCache.GetOperationalNode(peers[i], nodeData) != CHIP_NO_ERROR)
+        {
+            continue;
+        }
+
+        char nameBuffer[kMaxOperationalServiceNameSize];
+        if (MakeInstanceName(nameBuffer, sizeof(nameBuffer), peers[i]) == CHIP_NO_ERROR)
+        {
+            const char * instanceQName[] = { nameBuffer, kOperationalServiceName, kOperationalProtocol, kLocalDomain };
+            for (IncrementalResolver * resolver = mPacketParser.ResolverBegin(); resolver != mPacketParser.ResolverEnd();
+                 resolver++)
+            {
+                if (resolver->IsActiveOperationalParse() && resolver->GetRecordName() == FullQName(instanceQName))
+                {
+                    resolver->ResetToInactive();
+                }
+            }
+        }
+
+        mActiveResolves.Complete(peers[i]);
+        OnOperationalNodeResolved(nodeData);
+    }
+}
+
 void MinMdnsResolver::OnMdnsPacketData(const BytesRange & data, const chip::Inet::IPPacketInfo * info)
 {
     // Fill up any relevant data
-    mPacketParser.ParseSrvRecords(data);
+    mPacketParser.ParseSrvRecords(info->Interface, data);
     mPacketParser.ParseNonSrvRecords(info->Interface, data);
 
     AdvancePendingResolverStates();
+    ResolveFromCache();
 
     ScheduleRetries();
 }
@@ -439,6 +555,14 @@ CHIP_ERROR MinMdnsResolver::Init(chip::Inet::EndPointManager<chip::Inet::UDPEndP
 
 void MinMdnsResolver::Shutdown()
 {
+    if (mSystemLayer != nullptr)
+    {
+        mSystemLayer->CancelTimer(&CachedResolveCallback, this);
+        mSystemLayer->CancelTimer(&RetryCallback, this);
+    }
+    mCachedResolveCount = 0;
+    mActiveResolves.Reset();
+
     GlobalMinimalMdnsServer::Instance().ShutdownServer();
 }
 
@@ -498,6 +622,12 @@ CHIP_ERROR MinMdnsResolver::BuildQuery(QueryBuilder & builder, const ActiveResol
     mdns::Minimal::Logging::LogSendingQuery(query);
     builder.AddQuery(query);
 
+    if (!firstSend)
+    {
+        // Nodes reported since the browse started need not answer again
+        mRecordCache.AddKnownPtrAnswers(builder, qname, mLastBrowseStart);
+    }
+
     return CHIP_NO_ERROR;
 }
 
@@ -518,8 +648,8 @@ CHIP_ERROR MinMdnsResolver::BuildQuery(QueryBuilder & builder, const ActiveResol
         .SetAnswerViaUnicast(firstSend) //
         ;
 
+    ReturnErrorCodeIf(!builder.TryAddQuery(query), CHIP_ERROR_BUFFER_TOO_SMALL);
     mdns::Minimal::Logging::LogSendingQuery(query);
-    builder.AddQuery(query);
 
     return CHIP_NO_ERROR;
 }
@@ -565,8 +695,79 @@ CHIP_ERROR MinMdnsResolver::BuildQuery(QueryBuilder & builder, const ActiveResol
     return CHIP_NO_ERROR;
 }
 
+CHIP_ERROR MinMdnsResolver::SendQuery(QueryBuilder & builder, bool firstSend)
+{
+    if (firstSend)
+    {
+        return GlobalMinimalMdnsServer::Server().BroadcastUnicastQuery(builder.ReleasePacket(), kMdnsPort);
+    }
+    return GlobalMinimalMdnsServer::Server().BroadcastSend(builder.ReleasePacket(), kMdnsPort);
+}
+
+CHIP_ERROR MinMdnsResolver::AddToBatch(ResolveBatch & batch, const PeerId & peerId, bool firstSend)
+{
+    if (batch.count == ResolveBatch::kMaxQueries)
+    {
+        ReturnErrorOnFailure(SendBatch(batch, firstSend));
+    }
+
+    auto newPacket = [&batch]() {
+        System::PacketBufferHandle buffer = System::PacketBufferHandle::New(kMdnsMaxPacketSize);
+        ReturnErrorCodeIf(buffer.IsNull(), CHIP_ERROR_NO_MEMORY);
+
+        batch.builder.Reset(std::move(buffer));
+        batch.builder.Header().SetMessageId(0);
+        return CHIP_NO_ERROR;
+    };
+
+    if (batch.count == 0)
+    {
+        ReturnErrorOnFailure(newPacket());
+    }
+
+    const ActiveResolveAttempts::ScheduledAttempt::Resolve resolve(peerId);
+    CHIP_ERROR err = BuildQuery(batch.builder, resolve, firstSend);
+    if (err == CHIP_ERROR_BUFFER_TOO_SMALL && batch.count > 0)
+    {
+        // Packet full: send it and add the query to a new one
+        ReturnErrorOnFailure(SendBatch(batch, firstSend));
+        ReturnErrorOnFailure(newPacket());
+        err = BuildQuery(batch.builder, resolve, firstSend);
+    }
+    ReturnErrorOnFailure(err);
+
+    batch.peers[batch.count++] = peerId;
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR MinMdnsResolver::SendBatch(ResolveBatch & batch, bool firstSend)
+{
+    ReturnErrorCodeIf(batch.count == 0, CHIP_NO_ERROR);
+
+    // Known answers follow all the queries, as long as they fit
+    for (size_t i = 0; i < batch.count; i++)
+    {
+        char nameBuffer[kMaxOperationalServiceNameSize] = "";
+        if (MakeInstanceName(nameBuffer, sizeof(nameBuffer), batch.peers[i]) != CHIP_NO_ERROR)
+        {
+            continue;
+        }
+
+        const char * instanceQName[] = { nameBuffer, kOperationalServiceName, kOperationalProtocol, kLocalDomain };
+        mRecordCache.AddKnownTxtAnswer(batch.builder, instanceQName);
+    }
+
+    batch.count = 0;
+    return SendQuery(batch.builder, firstSend);
+}
+
 CHIP_ERROR MinMdnsResolver::SendAllPendingQueries()
 {
+    // Operational resolves are packed in as few packets as possible. First
+    // queries ask for unicast replies, so they are not mixed with retries.
+    ResolveBatch firstSendBatch;
+    ResolveBatch retryBatch;
+
     while (true)
     {
         Optional<ActiveResolveAttempts::ScheduledAttempt> resolve = mActiveResolves.NextScheduled();
@@ -576,6 +777,14 @@ CHIP_ERROR MinMdnsResolver::SendAllPendingQueries()
             break;
         }
 
+        if (resolve.Value().IsResolve())
+        {
+            const bool firstSend = resolve.Value().firstSend;
+            ResolveBatch & batch = firstSend ? firstSendBatch : retryBatch;
+            ReturnErrorOnFailure(AddToBatch(batch, resolve.Value().ResolveData().peerId, firstSend));
+            continue;
+        }
+
         System::PacketBufferHandle buffer = System::PacketBufferHandle::New(kMdnsMaxPacketSize);
         ReturnErrorCodeIf(buffer.IsNull(), CHIP_ERROR_NO_MEMORY);
 
@@ -583,17 +792,12 @@ CHIP_ERROR MinMdnsResolver::SendAllPendingQueries()
         builder.Header().SetMessageId(0);
 
         ReturnErrorOnFailure(BuildQuery(builder, resolve.Value()));
-
-        if (resolve.Value().firstSend)
-        {
-            ReturnErrorOnFailure(GlobalMinimalMdnsServer::Server().BroadcastUnicastQuery(builder.ReleasePacket(), kMdnsPort));
-        }
-        else
-        {
-            ReturnErrorOnFailure(GlobalMinimalMdnsServer::Server().BroadcastSend(builder.ReleasePacket(), kMdnsPort));
-        }
+        ReturnErrorOnFailure(SendQuery(builder, resolve.Value().firstSend));
     }
 
+    ReturnErrorOnFailure(SendBatch(firstSendBatch, /* firstSend */ true));
+    ReturnErrorOnFailure(SendBatch(retryBatch, /* firstSend */ false));
+
     ExpireIncrementalResolvers();
 
     return ScheduleRetries();
@@ -635,18 +839,95 @@ CHIP_ERROR MinMdnsResolver::DiscoverCommissioners(DiscoveryFilter filter)
 
 CHIP_ERROR MinMdnsResolver::BrowseNodes(DiscoveryType type, DiscoveryFilter filter)
 {
+    mLastBrowseStart = System::SystemClock().GetMonotonicTimestamp();
     mActiveResolves.MarkPending(filter, type);
 
     return SendAllPendingQueries();
 }
 
+bool MinMdnsResolver::ScheduleCachedResolve(const PeerId & peerId)
+{
+    ResolvedNodeData nodeData;
+
+    // Results are always reported asynchronously, as callers expect for
+    // network resolves.
+    VerifyOrReturnValue(mSystemLayer != nullptr && mCachedResolveCount < kMaxCachedResolves, false);
+    VerifyOrReturnValue(mRecordCache.GetOperationalNode(peerId, nodeData) == CHIP_NO_ERROR, false);
+    VerifyOrReturnValue(mSystemLayer->StartTimer(System::Clock::kZero, &CachedResolveCallback, this) == CHIP_NO_ERROR, false);
+
+    mCachedResolves[mCachedResolveCount++] = peerId;
+    return true;
+}
+
 CHIP_ERROR MinMdnsResolver::ResolveNodeId(const PeerId & peerId, Inet::IPAddressType type)
 {
+    // Answer from the cache when possible
+    if (ScheduleCachedResolve(peerId))
+    {
+        return CHIP_NO_ERROR;
+    }
+
     mActiveResolves.MarkPending(peerId);
 
     return SendAllPendingQueries();
 }
 
+CHIP_ERROR MinMdnsResolver::ResolveNodeIds(Span<const PeerId> peerIds, Inet::IPAddressType type)
+{
+    // Make room for every resolve in the retry queue, so that all of them are
+    // retried. When the queue cannot grow, queries are sent whenever it is
+    // full: queueing more would evict resolves never queried.
+    mActiveResolves.Reserve(peerIds.size());
+
+    size_t queued = 0;
+    for (const PeerId & peerId : peerIds)
+    {
+        if (ScheduleCachedResolve(peerId))
+        {
+            continue;
+        }
+
+        mActiveResolves.MarkPending(peerId);
+        if (++queued == mActiveResolves.GetCapacity())
+        {
+            ReturnErrorOnFailure(SendAllPendingQueries());
+            queued = 0;
+        }
+    }
+
+    return SendAllPendingQueries();
+}
+
+void MinMdnsResolver::ReportCachedResolves()
+{
+    // Delegates may start new resolves
+    PeerId peers[kMaxCachedResolves];
+    size_t count = mCachedResolveCount;
+    std::copy(mCachedResolves, mCachedResolves + count, peers);
+    mCachedResolveCount = 0;
+
+    bool queryNeeded = false;
+    for (size_t i = 0; i < count; i++)
+    {
+        ResolvedNodeData nodeData;
+        if (mRecordCache.GetOperationalNode(peers[i], nodeData) == CHIP_NO_ERROR)
+        {
+            OnOperationalNodeResolved(nodeData);
+        }
+        else
+        {
+            // Expired meanwhile
+            mActiveResolves.MarkPending(peers[i]);
+            queryNeeded = true;
+        }
+    }
+
+    if (queryNeeded)
+    {
+        SendAllPendingQueries();
+    }
+}
+
 CHIP_ERROR MinMdnsResolver::ScheduleRetries()
 {
     ReturnErrorCodeIf(mSystemLayer == nullptr, CHIP_ERROR_INCORRECT_STATE);
@@ -667,6 +948,11 @@ void MinMdnsResolver::RetryCallback(System::Layer *, void * self)
     reinterpret_cast<MinMdnsResolver *>(self)->SendAllPendingQueries();
 }
 
+void MinMdnsResolver::CachedResolveCallback(System::Layer *, void * self)
+{
+    reinterpret_cast<MinMdnsResolver *>(self)->ReportCachedResolves();
+}
+
 MinMdnsResolver gResolver;
 
 } // namespace
@@ -21,6 +21,7 @@
 
 #include <lib/dnssd/minimal_mdns/Query.h>
 #include <lib/dnssd/minimal_mdns/core/DnsHeader.h>
+#include <lib/dnssd/minimal_mdns/records/ResourceRecord.h>
 
 namespace mdns {
 namespace Minimal {
@@ -28,8 +29,12 @@ namespace Minimal {
 class QueryBuilder
 {
 public:
-    QueryBuilder() : mHeader(nullptr) {}
-    QueryBuilder(chip::System::PacketBufferHandle && packet) : mHeader(nullptr) { Reset(std::move(packet)); }
+    QueryBuilder() : mHeader(nullptr), mEndianOutput(nullptr, 0), mWriter(&mEndianOutput), mCommittedWriter(&mEndianOutput) {}
+    QueryBuilder(chip::System::PacketBufferHandle && packet) :
+        mHeader(nullptr), mEndianOutput(nullptr, 0), mWriter(&mEndianOutput), mCommittedWriter(&mEndianOutput)
+    {
+        Reset(std::move(packet));
+    }
 
     QueryBuilder & Reset(chip::System::PacketBufferHandle && packet)
     {
@@ -40,6 +45,7 @@ public:
         {
             mPacket->SetDataLength(HeaderRef::kSizeBytes);
             mHeader.Clear();
+            mQueryBuildOk = true;
         }
         else
         {
@@ -47,6 +53,15 @@ public:
         }
 
         mHeader.SetFlags(mHeader.GetFlags().SetQuery());
+
+        // A single writer over the whole message, so that compressed names point at offsets from the start of the message
+        mEndianOutput =
+            chip::Encoding::BigEndian::BufferWriter(mPacket->Start(), mPacket->DataLength() + mPacket->AvailableDataLength());
+        mEndianOutput.Skip(mPacket->DataLength());
+
+        mWriter.Reset();
+        mCommittedWriter = mWriter;
+
         return *this;
     }
 
@@ -62,30 +77,70 @@ public:
 
     QueryBuilder & AddQuery(const Query & query)
     {
-        if (!mQueryBuildOk)
+        if (mQueryBuildOk && !TryAddQuery(query))
         {
-            return *this;
+            mQueryBuildOk = false;
         }
+        return *this;
+    }
 
-        chip::Encoding::BigEndian::BufferWriter out(mPacket->Start() + mPacket->DataLength(), mPacket->AvailableDataLength());
-        RecordWriter writer(&out);
-
-        if (!query.Append(mHeader, writer))
+    /// Add a query if it fits in the packet.
+    ///
+    /// Used to pack several queries in a packet: unlike AddQuery, a query which
+    /// does not fit leaves the packet valid so that it can be sent as is.
+    /// Returns whether the query was added.
+    bool TryAddQuery(const Query & query)
+    {
+        if (!mQueryBuildOk)
         {
-            mQueryBuildOk = false;
+            return false;
         }
-        else
+
+        // Append only updates the query count on success
+        return Commit(query.Append(mHeader, mWriter));
+    }
+
+    /// Add a known answer (RFC 6762 section 7.1) after the queries.
+    ///
+    /// Known answers are optional: one which does not fit in the packet is
+    /// skipped and leaves the query valid. Returns whether it was added.
+    bool AddAnswer(const ResourceRecord & record)
+    {
+        if (!mQueryBuildOk)
         {
-            mPacket->SetDataLength(static_cast<uint16_t>(mPacket->DataLength() + out.Needed()));
+            return false;
         }
-        return *this;
+
+        // Append only updates the answer count on success
+        return Commit(record.Append(mHeader, ResourceType::kAnswer, mWriter));
     }
 
     bool Ok() const { return mQueryBuildOk; }
 
 private:
+    /// Keeps the data written by the last append if it succeeded, otherwise
+    /// drops it along with the names it made available for compression.
+    bool Commit(bool appended)
+    {
+        if (appended && mEndianOutput.Fit())
+        {
+            mPacket->SetDataLength(static_cast<uint16_t>(mEndianOutput.Needed()));
+            mCommittedWriter = mWriter;
+            return true;
+        }
+
+        mEndianOutput = chip::Encoding::BigEndian::BufferWriter(mPacket->Start(),
+                                                                mPacket->DataLength() + mPacket->AvailableDataLength());
+        mEndianOutput.Skip(mPacket->DataLength());
+        mWriter = mCommittedWriter;
+        return false;
+    }
+
     chip::System::PacketBufferHandle mPacket;
     HeaderRef mHeader;
+    chip::Encoding::BigEndian::BufferWriter mEndianOutput;
+    RecordWriter mWriter;
+    RecordWriter mCommittedWriter; // mWriter as of the last successful append
     bool mQueryBuildOk = true;
 };
 
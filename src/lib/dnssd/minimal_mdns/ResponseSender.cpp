@@ -18,9 +18,13 @@
 #include "ResponseSender.h"
 
 #include "QueryReplyFilter.h"
+#include "RecordData.h"
 
+#include <crypto/RandUtils.h>
 #include <system/SystemClock.h>
 
+#include <string.h>
+
 namespace mdns {
 namespace Minimal {
 
@@ -35,6 +39,44 @@ constexpr uint16_t kMdnsStandardPort = 5353;
 //    the header.
 constexpr uint16_t kPacketSizeBytes = 512;
 
+// Random delay of multicast replies to shared records: https://tools.ietf.org/html/rfc6762#section-6
+constexpr uint16_t kMinResponseDelayMs = 20;
+constexpr uint16_t kMaxResponseDelayMs = 120;
+
+// Addresses are read when the reply is built: refresh cached replies regularly
+// to pick up address changes.
+constexpr chip::System::Clock::Seconds16 kCachedResponseMaxAge(10);
+
+// Large enough to serialize any record minimal mDNS advertises, except for
+// large TXT records which are not compared against known answers.
+constexpr size_t kKnownAnswerScratchSize = 256;
+
+// Strip the cache flush bit, which does not change the record identity
+constexpr uint16_t kClassMask = 0x7FFF;
+
+bool SameRecordData(const ResourceData & a, const BytesRange & aPacket, const ResourceData & b, const BytesRange & bPacket)
+{
+    switch (a.GetType())
+    {
+    case QType::PTR: {
+        SerializedQNameIterator aName;
+        SerializedQNameIterator bName;
+        return ParsePtrRecord(a.GetData(), aPacket, &aName) && ParsePtrRecord(b.GetData(), bPacket, &bName) && (aName == bName);
+    }
+    case QType::SRV: {
+        SrvRecord aSrv;
+        SrvRecord bSrv;
+        return aSrv.Parse(a.GetData(), aPacket) && bSrv.Parse(b.GetData(), bPacket) && (aSrv.GetPort() == bSrv.GetPort()) &&
+            (aSrv.GetPriority() == bSrv.GetPriority()) && (aSrv.GetWeight() == bSrv.GetWeight()) &&
+            (aSrv.GetName() == bSrv.GetName());
+    }
+    default:
+        // No names within the data: compare as is
+        return (a.GetData().Size() == b.GetData().Size()) &&
+            (memcmp(a.GetData().Start(), b.GetData().Start(), a.GetData().Size()) == 0);
+    }
+}
+
 } // namespace
 namespace Internal {
 
@@ -50,8 +92,18 @@ bool ResponseSendingState::IncludeQuery() const
 
 } // namespace Internal
 
+ResponseSender::~ResponseSender()
+{
+    if (mDelayedResponseScheduled)
+    {
+        mSystemLayer->CancelTimer(DelayedResponseTimerCallback, this);
+    }
+}
+
 CHIP_ERROR ResponseSender::AddQueryResponder(QueryResponderBase * queryResponder)
 {
+    InvalidateResponseCache();
+
     // If already existing or we find a free slot, just use it
     // Note that dynamic memory implementations are never expected to be nullptr
     //
@@ -74,6 +126,8 @@ CHIP_ERROR ResponseSender::AddQueryResponder(QueryResponderBase * queryResponder
 
 CHIP_ERROR ResponseSender::RemoveQueryResponder(QueryResponderBase * queryResponder)
 {
+    InvalidateResponseCache();
+
     for (auto it = mResponders.begin(); it != mResponders.end(); it++)
     {
         if (*it == queryResponder)
@@ -100,11 +154,143 @@ bool ResponseSender::HasQueryResponders() const
     return false;
 }
 
+void ResponseSender::SetSystemLayer(chip::System::Layer * systemLayer)
+{
+    if (mSystemLayer != nullptr)
+    {
+        // Nothing may stay pending without a timer to send it
+        LogErrorOnFailure(FlushDelayedResponse());
+    }
+    mSystemLayer = systemLayer;
+}
+
+void ResponseSender::SetKnownAnswers(const BytesRange & packet)
+{
+    ClearKnownAnswers();
+
+    VerifyOrReturn(packet.Size() >= HeaderRef::kSizeBytes);
+    ConstHeaderRef header(packet.Start());
+
+    // Known answers follow the queries
+    const uint8_t * data = packet.Start() + HeaderRef::kSizeBytes;
+    for (uint16_t i = 0; i < header.GetQueryCount(); i++)
+    {
+        QueryData query;
+        VerifyOrReturn(query.Parse(packet, &data));
+    }
+
+    mKnownAnswersPacket = packet;
+    mKnownAnswers       = data;
+    mKnownAnswerCount   = header.GetAnswerCount();
+}
+
+void ResponseSender::ClearKnownAnswers()
+{
+    mKnownAnswersPacket = BytesRange();
+    mKnownAnswers       = nullptr;
+    mKnownAnswerCount   = 0;
+}
+
+bool ResponseSender::IsKnownAnswer(const ResourceRecord & record) const
+{
+    VerifyOrReturnValue(mKnownAnswerCount > 0, false);
+
+    // Serialize the record to compare it with the parsed known answers
+    uint8_t buffer[kKnownAnswerScratchSize];
+    chip::Encoding::BigEndian::BufferWriter output(buffer, sizeof(buffer));
+    RecordWriter writer(&output);
+    HeaderRef header(buffer);
+
+    header.Clear();
+    output.Skip(HeaderRef::kSizeBytes);
+    VerifyOrReturnValue(record.Append(header, ResourceType::kAnswer, writer) && output.Fit(), false);
+
+    const BytesRange recordPacket(buffer, buffer + output.Needed());
+    const uint8_t * recordStart = buffer + HeaderRef::kSizeBytes;
+    ResourceData ours;
+    VerifyOrReturnValue(ours.Parse(recordPacket, &recordStart), false);
+
+    const uint8_t * data = mKnownAnswers;
+    for (uint16_t i = 0; i < mKnownAnswerCount; i++)
+    {
+        ResourceData known;
+        VerifyOrReturnValue(known.Parse(mKnownAnswersPacket, &data), false);
+
+        if ((known.GetType() != ours.GetType()) ||
+            ((static_cast<uint16_t>(known.GetClass()) & kClassMask) != (static_cast<uint16_t>(ours.GetClass()) & kClassMask)))
+        {
+            continue;
+        }
+
+        // https://tools.ietf.org/html/rfc6762#section-7.1: known answers with
+        // less than half the correct TTL are sent again
+        if (known.GetTtlSeconds() * 2 < ours.GetTtlSeconds())
+        {
+            continue;
+        }
+
+        if ((known.GetName() == ours.GetName()) && SameRecordData(known, mKnownAnswersPacket, ours, recordPacket))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 CHIP_ERROR ResponseSender::Respond(uint32_t messageId, const QueryData & query, const chip::Inet::IPPacketInfo * querySource,
                                    const ResponseConfiguration & configuration)
 {
     mSendState.Reset(messageId, query, querySource);
 
+    const bool sendUnicast = mSendState.SendUnicast();
+
+    const chip::System::Clock::Timestamp kTimeNow = chip::System::SystemClock().GetMonotonicTimestamp();
+
+    QueryReplyFilter queryReplyFilter(query);
+    QueryResponderRecordFilter responseFilter;
+
+    responseFilter.SetReplyFilter(&queryReplyFilter);
+
+    if (!sendUnicast)
+    {
+        // According to https://tools.ietf.org/html/rfc6762#section-6  we should multicast at most 1/sec
+        // per interface
+        responseFilter.SetIncludeOnlyMulticastBeforeMS(kTimeNow - chip::System::Clock::Seconds32(1), querySource->Interface);
+    }
+
+    // Only multicast replies with shared answers are delayed. Replies to queries
+    // received during the delay go into the same packet as long as they are
+    // multicast on the same interface. Internal broadcasts are sent after any
+    // pending reply.
+    mDelayingResponse = (mSystemLayer != nullptr) && !sendUnicast && !query.IsInternalBroadcast() &&
+        HasSharedAnswers(query, responseFilter);
+    if (!sendUnicast && mDelayedResponseBuilder.HasPacketBuffer() &&
+        (!mDelayingResponse || (mDelayedInterface != querySource->Interface) ||
+         (mDelayedAddressType != querySource->SrcAddress.Type())))
+    {
+        LogErrorOnFailure(FlushDelayedResponse());
+    }
+
+#if CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE > 0
+    mCaptureEntry = nullptr;
+    {
+        CachedResponse key;
+        if (MakeCacheKey(configuration, key))
+        {
+            const chip::System::Clock::Timestamp now = chip::System::SystemClock().GetMonotonicTimestamp();
+            CachedResponse * cached                  = FindCachedResponse(key, now);
+            if (cached != nullptr)
+            {
+                return SendCachedResponse(*cached);
+            }
+
+            mCaptureEntry = &AllocateCachedResponse();
+            MakeCacheKey(configuration, *mCaptureEntry);
+        }
+    }
+#endif
+
     // Responder has a stateful 'additional replies required' that is used within the response
     // loop. 'no additionals required' is set at the start and additionals are marked as the query
     // reply is built.
@@ -120,21 +306,6 @@ CHIP_ERROR ResponseSender::Respond(uint32_t messageId, const QueryData & query,
 
     // send all 'Answer' replies
     {
-        const chip::System::Clock::Timestamp kTimeNow = chip::System::SystemClock().GetMonotonicTimestamp();
-
-        QueryReplyFilter queryReplyFilter(query);
-        QueryResponderRecordFilter responseFilter;
-
-        responseFilter.SetReplyFilter(&queryReplyFilter);
-
-        if (!mSendState.SendUnicast())
-        {
-            // According to https://tools.ietf.org/html/rfc6762#section-6  we should multicast at most 1/sec
-            //
-            // TODO: the 'last sent' value does NOT track the interface we used to send, so this may cause
-            //       broadcasts on one interface to throttle broadcasts on another interface.
-            responseFilter.SetIncludeOnlyMulticastBeforeMS(kTimeNow - chip::System::Clock::Seconds32(1));
-        }
         for (auto responder = mResponders.begin(); responder != mResponders.end(); responder++)
         {
             if (*responder == nullptr)
@@ -148,9 +319,11 @@ CHIP_ERROR ResponseSender::Respond(uint32_t messageId, const QueryData & query,
 
                 (*responder)->MarkAdditionalRepliesFor(it);
 
-                if (!mSendState.SendUnicast())
+                if (!sendUnicast)
                 {
-                    it->lastMulticastTime = kTimeNow;
+                    // Delayed replies count as sent: queries received during the delay do
+                    // not add the record again.
+                    it->multicastThrottle.MarkMulticast(querySource->Interface, kTimeNow);
                 }
             }
         }
@@ -182,14 +355,230 @@ CHIP_ERROR ResponseSender::Respond(uint32_t messageId, const QueryData & query,
         }
     }
 
+    if (mDelayingResponse)
+    {
+        return ScheduleDelayedResponse();
+    }
+
+#if CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE > 0
+    if ((mCaptureEntry != nullptr) && !mResponseBuilder.HasPacketBuffer())
+    {
+        // Remember that there is nothing to reply
+        StoreCachedResponse(nullptr, 0);
+    }
+#endif
+
     return FlushReply();
 }
 
+bool ResponseSender::HasSharedAnswers(const QueryData & query, QueryResponderRecordFilter & responseFilter)
+{
+    // https://tools.ietf.org/html/rfc6762#section-6: only answers from shared record sets, which other responders may
+    // send as well, are delayed. Minimal mDNS only advertises PTR records as shared.
+    VerifyOrReturnValue(query.GetType() == QType::PTR || query.GetType() == QType::ANY, false);
+
+    for (auto responder = mResponders.begin(); responder != mResponders.end(); responder++)
+    {
+        if (*responder == nullptr)
+        {
+            continue;
+        }
+        for (auto it = (*responder)->begin(&responseFilter); it != (*responder)->end(); it++)
+        {
+            if (it->responder->GetQType() == QType::PTR)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+CHIP_ERROR ResponseSender::ScheduleDelayedResponse()
+{
+    // Nothing to send, or already scheduled by a previous query
+    ReturnErrorCodeIf(!mDelayedResponseBuilder.HasPacketBuffer() || mDelayedResponseScheduled, CHIP_NO_ERROR);
+
+    mDelayedInterface   = mSendState.GetSourceInterfaceId();
+    mDelayedAddressType = mSendState.GetSourceAddress().Type();
+
+    const uint16_t delayMs =
+        static_cast<uint16_t>(kMinResponseDelayMs + chip::Crypto::GetRandU16() % (kMaxResponseDelayMs - kMinResponseDelayMs + 1));
+    CHIP_ERROR err = mSystemLayer->StartTimer(chip::System::Clock::Milliseconds32(delayMs), DelayedResponseTimerCallback, this);
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(Discovery, "Failed to delay mDNS reply: %" CHIP_ERROR_FORMAT, err.Format());
+        return FlushDelayedResponse();
+    }
+
+    mDelayedResponseScheduled = true;
+    return CHIP_NO_ERROR;
+}
+
+void ResponseSender::DelayedResponseTimerCallback(chip::System::Layer *, void * appState)
+{
+    ResponseSender * sender = static_cast<ResponseSender *>(appState);
+
+    sender->mDelayedResponseScheduled = false;
+    CHIP_ERROR err                    = sender->FlushDelayedResponse();
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(Discovery, "Failed to send delayed mDNS reply: %" CHIP_ERROR_FORMAT, err.Format());
+    }
+}
+
+CHIP_ERROR ResponseSender::FlushDelayedResponse()
+{
+    if (mDelayedResponseScheduled)
+    {
+        mSystemLayer->CancelTimer(DelayedResponseTimerCallback, this);
+        mDelayedResponseScheduled = false;
+    }
+
+    ReturnErrorCodeIf(!mDelayedResponseBuilder.HasPacketBuffer(), CHIP_NO_ERROR); // nothing to flush
+
+    chip::System::PacketBufferHandle packet = mDelayedResponseBuilder.ReleasePacket();
+
+#if CHIP_MINMDNS_HIGH_VERBOSITY
+    ChipLogDetail(Discovery, "Broadcasting delayed mDns reply");
+#endif
+    return mServer->BroadcastSend(std::move(packet), kMdnsStandardPort, mDelayedInterface, mDelayedAddressType);
+}
+
+void ResponseSender::InvalidateResponseCache()
+{
+#if CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE > 0
+    for (auto & entry : mResponseCache)
+    {
+        entry.valid = false;
+        entry.packet.Free();
+    }
+    mCaptureEntry = nullptr;
+#endif
+}
+
+#if CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE > 0
+
+bool ResponseSender::CachedResponse::SameKey(const CachedResponse & other) const
+{
+    return (interface == other.interface) && (addressType == other.addressType) && (type == other.type) &&
+        (klass == other.klass) && (unicastRequested == other.unicastRequested) && (includeQuery == other.includeQuery) &&
+        (nameSize == other.nameSize) && (memcmp(name, other.name, nameSize) == 0);
+}
+
+bool ResponseSender::MakeCacheKey(const ResponseConfiguration & configuration, CachedResponse & entry) const
+{
+    const QueryData & query = *mSendState.GetQuery();
+
+    // Only plain unicast replies are cached: multicast replies depend on the
+    // throttling state and filtered replies depend on the known answers.
+    VerifyOrReturnValue(mSendState.SendUnicast() && !query.IsInternalBroadcast(), false);
+    VerifyOrReturnValue(mKnownAnswerCount == 0, false);
+    VerifyOrReturnValue(!configuration.GetTtlSecondsOverride().HasValue(), false);
+
+    entry.interface        = mSendState.GetSourceInterfaceId();
+    entry.addressType      = mSendState.GetSourceAddress().Type();
+    entry.type             = query.GetType();
+    entry.klass            = query.GetClass();
+    entry.unicastRequested = query.RequestedUnicastAnswer();
+    entry.includeQuery     = mSendState.IncludeQuery();
+
+    // Flatten the name as length-prefixed labels
+    SerializedQNameIterator name = query.GetName();
+    size_t nameSize              = 0;
+    while (name.Next())
+    {
+        const size_t labelSize = strlen(name.Value());
+        VerifyOrReturnValue(nameSize + 1 + labelSize <= sizeof(entry.name), false);
+        entry.name[nameSize++] = static_cast<uint8_t>(labelSize);
+        memcpy(entry.name + nameSize, name.Value(), labelSize);
+        nameSize += labelSize;
+    }
+    VerifyOrReturnValue(name.IsValid(), false);
+    entry.nameSize = nameSize;
+
+    return true;
+}
+
+ResponseSender::CachedResponse * ResponseSender::FindCachedResponse(const CachedResponse & key,
+                                                                    chip::System::Clock::Timestamp now)
+{
+    for (auto & entry : mResponseCache)
+    {
+        if (!entry.valid || !entry.SameKey(key))
+        {
+            continue;
+        }
+        if (now - entry.created >= kCachedResponseMaxAge)
+        {
+            entry.valid = false;
+            entry.packet.Free();
+            return nullptr;
+        }
+        return &entry;
+    }
+    return nullptr;
+}
+
+ResponseSender::CachedResponse & ResponseSender::AllocateCachedResponse()
+{
+    CachedResponse * oldest = &mResponseCache[0];
+    for (auto & entry : mResponseCache)
+    {
+        if (!entry.valid)
+        {
+            return entry;
+        }
+        if (entry.created < oldest->created)
+        {
+            oldest = &entry;
+        }
+    }
+    oldest->valid = false;
+    oldest->packet.Free();
+    return *oldest;
+}
+
+CHIP_ERROR ResponseSender::SendCachedResponse(const CachedResponse & entry)
+{
+    ReturnErrorCodeIf(entry.packetSize == 0, CHIP_NO_ERROR); // nothing to reply
+
+    chip::System::PacketBufferHandle buffer = chip::System::PacketBufferHandle::NewWithData(entry.packet.Get(), entry.packetSize);
+    ReturnErrorCodeIf(buffer.IsNull(), CHIP_ERROR_NO_MEMORY);
+
+    HeaderRef(buffer->Start()).SetMessageId(static_cast<uint16_t>(mSendState.GetMessageId()));
+
+#if CHIP_MINMDNS_HIGH_VERBOSITY
+    ChipLogDetail(Discovery, "Directly sending cached mDns reply on port %d", mSendState.GetSourcePort());
+#endif
+    return mServer->DirectSend(std::move(buffer), mSendState.GetSourceAddress(), mSendState.GetSourcePort(),
+                               mSendState.GetSourceInterfaceId());
+}
+
+void ResponseSender::StoreCachedResponse(const uint8_t * data, size_t size)
+{
+    CachedResponse & entry = *mCaptureEntry;
+    mCaptureEntry          = nullptr;
+
+    if (size > 0)
+    {
+        VerifyOrReturn(entry.packet.Alloc(size));
+        memcpy(entry.packet.Get(), data, size);
+    }
+    entry.packetSize = size;
+    entry.created    = chip::System::SystemClock().GetMonotonicTimestamp();
+    entry.valid      = true;
+}
+
+#endif // CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE > 0
+
 CHIP_ERROR ResponseSender::FlushReply()
 {
-    ReturnErrorCodeIf(!mResponseBuilder.HasPacketBuffer(), CHIP_NO_ERROR); // nothing to flush
+    ResponseBuilder & builder = CurrentBuilder();
+
+    ReturnErrorCodeIf(!builder.HasPacketBuffer(), CHIP_NO_ERROR); // nothing to flush
 
-    if (mResponseBuilder.HasResponseRecords())
+    if (builder.HasResponseRecords())
     {
         char srcAddressString[chip::Inet::IPAddress::kMaxStringLength];
         VerifyOrDie(mSendState.GetSourceAddress().ToString(srcAddressString) != nullptr);
@@ -200,15 +589,22 @@ CHIP_ERROR ResponseSender::FlushReply()
             ChipLogDetail(Discovery, "Directly sending mDns reply to peer %s on port %d", srcAddressString,
                           mSendState.GetSourcePort());
 #endif
-            ReturnErrorOnFailure(mServer->DirectSend(mResponseBuilder.ReleasePacket(), mSendState.GetSourceAddress(),
-                                                     mSendState.GetSourcePort(), mSendState.GetSourceInterfaceId()));
+            chip::System::PacketBufferHandle packet = builder.ReleasePacket();
+#if CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE > 0
+            if (mCaptureEntry != nullptr)
+            {
+                StoreCachedResponse(packet->Start(), packet->DataLength());
+            }
+#endif
+            ReturnErrorOnFailure(mServer->DirectSend(std::move(packet), mSendState.GetSourceAddress(), mSendState.GetSourcePort(),
+                                                     mSendState.GetSourceInterfaceId()));
         }
         else
         {
 #if CHIP_MINMDNS_HIGH_VERBOSITY
             ChipLogDetail(Discovery, "Broadcasting mDns reply for query from %s", srcAddressString);
 #endif
-            ReturnErrorOnFailure(mServer->BroadcastSend(mResponseBuilder.ReleasePacket(), kMdnsStandardPort,
+            ReturnErrorOnFailure(mServer->BroadcastSend(builder.ReleasePacket(), kMdnsStandardPort,
                                                         mSendState.GetSourceInterfaceId(), mSendState.GetSourceAddress().Type()));
         }
     }
@@ -221,12 +617,17 @@ CHIP_ERROR ResponseSender::PrepareNewReplyPacket()
     chip::System::PacketBufferHandle buffer = chip::System::PacketBufferHandle::New(kPacketSizeBytes);
     ReturnErrorCodeIf(buffer.IsNull(), CHIP_ERROR_NO_MEMORY);
 
-    mResponseBuilder.Reset(std::move(buffer));
-    mResponseBuilder.Header().SetMessageId(mSendState.GetMessageId());
+    ResponseBuilder & builder = CurrentBuilder();
+
+    builder.Reset(std::move(buffer));
+
+    // Aggregated multicast replies answer several queries: use a zero id as
+    // recommended by https://tools.ietf.org/html/rfc6762#section-18.1
+    builder.Header().SetMessageId(mDelayingResponse ? 0 : static_cast<uint16_t>(mSendState.GetMessageId()));
 
     if (mSendState.IncludeQuery())
     {
-        mResponseBuilder.AddQuery(*mSendState.GetQuery());
+        builder.AddQuery(*mSendState.GetQuery());
     }
 
     return CHIP_NO_ERROR;
@@ -236,32 +637,44 @@ void ResponseSender::AddResponse(const ResourceRecord & record)
 {
     ReturnOnFailure(mSendState.GetError());
 
-    if (!mResponseBuilder.HasPacketBuffer())
+    if (IsKnownAnswer(record))
+    {
+        return;
+    }
+
+    ResponseBuilder & builder = CurrentBuilder();
+
+    if (!builder.HasPacketBuffer())
     {
         mSendState.SetError(PrepareNewReplyPacket());
         ReturnOnFailure(mSendState.GetError());
     }
 
-    if (!mResponseBuilder.Ok())
+    if (!builder.Ok())
     {
         mSendState.SetError(CHIP_ERROR_INCORRECT_STATE);
         return;
     }
 
-    mResponseBuilder.AddRecord(mSendState.GetResourceType(), record);
+    builder.AddRecord(mSendState.GetResourceType(), record);
 
     // ResponseBuilder AddRecord will only fail if insufficient space is available (or at least this is
     // the assumption here). It also guarantees that existing data and header are unchanged on
     // failure, hence we can flush and try again. This allows for split replies.
-    if (!mResponseBuilder.Ok())
+    if (!builder.Ok())
     {
-        mResponseBuilder.Header().SetFlags(mResponseBuilder.Header().GetFlags().SetTruncated(true));
+        builder.Header().SetFlags(builder.Header().GetFlags().SetTruncated(true));
+
+#if CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE > 0
+        // Only single packet replies are cached
+        mCaptureEntry = nullptr;
+#endif
 
         ReturnOnFailure(mSendState.SetError(FlushReply()));
         ReturnOnFailure(mSendState.SetError(PrepareNewReplyPacket()));
 
-        mResponseBuilder.AddRecord(mSendState.GetResourceType(), record);
-        if (!mResponseBuilder.Ok())
+        builder.AddRecord(mSendState.GetResourceType(), record);
+        if (!builder.Ok())
         {
             // Very much unexpected: single record addition should fit (our records should not be that big).
             ChipLogError(Discovery, "Failed to add single record to mDNS response.");
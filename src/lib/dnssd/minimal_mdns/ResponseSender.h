@@ -22,7 +22,10 @@
 #include "Server.h"
 
 #include <lib/dnssd/minimal_mdns/responders/QueryResponder.h>
+#include <lib/support/ScopedBuffer.h>
 
+#include <system/SystemClock.h>
+#include <system/SystemLayer.h>
 #include <system/SystemPacketBuffer.h>
 
 #if CHIP_CONFIG_MINMDNS_DYNAMIC_OPERATIONAL_RESPONDER_LIST
@@ -102,10 +105,23 @@ private:
 ///
 /// Handles processing the query via a QueryResponderBase and then sending back the reply
 /// using appropriate paths (unicast or multicast) via the given Server.
+///
+/// Following RFC 6762:
+///   - records are multicast at most once per second on every interface (section 6)
+///   - records listed as known answers by the query are not sent (section 7.1)
+///   - when a system layer is set, multicast replies containing shared (PTR)
+///     answers are delayed by 20-120ms and replies to queries received
+///     meanwhile are aggregated into the same packet (section 6). Replies made
+///     only of unique records are sent immediately.
+///
+/// Unicast replies are cached as serialized packets (see
+/// CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE) until the responders change or
+/// InvalidateResponseCache is called.
 class ResponseSender : public ResponderDelegate
 {
 public:
     ResponseSender(ServerBase * server) : mServer(server) {}
+    ~ResponseSender();
 
     CHIP_ERROR AddQueryResponder(QueryResponderBase * queryResponder);
     CHIP_ERROR RemoveQueryResponder(QueryResponderBase * queryResponder);
@@ -120,16 +136,95 @@ public:
 
     void SetServer(ServerBase * server) { mServer = server; }
 
+    /// Set the system layer used to delay multicast replies.
+    ///
+    /// Without a system layer (the default), all replies are sent immediately.
+    void SetSystemLayer(chip::System::Layer * systemLayer);
+
+    /// Use the answer section of [packet] as the known answers of the queries
+    /// it contains. Records listed with at least half their TTL are not sent
+    /// back.
+    ///
+    /// [packet] must remain valid until ClearKnownAnswers is called.
+    void SetKnownAnswers(const BytesRange & packet);
+    void ClearKnownAnswers();
+
+    /// Send the pending delayed multicast reply, if any, right away.
+    CHIP_ERROR FlushDelayedResponse();
+
+    /// Forget all cached responses. To be called whenever the advertised data
+    /// changes.
+    void InvalidateResponseCache();
+
 private:
+    static void DelayedResponseTimerCallback(chip::System::Layer * layer, void * appState);
+
     CHIP_ERROR FlushReply();
     CHIP_ERROR PrepareNewReplyPacket();
+    CHIP_ERROR ScheduleDelayedResponse();
+    ResponseBuilder & CurrentBuilder() { return mDelayingResponse ? mDelayedResponseBuilder : mResponseBuilder; }
+
+    /// Check if the answers to [query] include shared records, which are the
+    /// only ones whose multicast replies are delayed.
+    bool HasSharedAnswers(const QueryData & query, QueryResponderRecordFilter & responseFilter);
+
+    /// Check if [record] is listed in the known answers with at least half its TTL.
+    bool IsKnownAnswer(const ResourceRecord & record) const;
 
     ServerBase * mServer;
-    QueryResponderPtrPool mResponders = {};
+    chip::System::Layer * mSystemLayer = nullptr;
+    QueryResponderPtrPool mResponders  = {};
 
     /// Current send state
     ResponseBuilder mResponseBuilder;          // packet being built
     Internal::ResponseSendingState mSendState; // sending state
+    bool mDelayingResponse = false;            // current reply goes to mDelayedResponseBuilder
+
+    /// Multicast reply waiting for its delay to expire
+    ResponseBuilder mDelayedResponseBuilder;
+    chip::Inet::InterfaceId mDelayedInterface;
+    chip::Inet::IPAddressType mDelayedAddressType = chip::Inet::IPAddressType::kUnknown;
+    bool mDelayedResponseScheduled                = false;
+
+    /// Known answers of the packet being processed
+    BytesRange mKnownAnswersPacket;
+    const uint8_t * mKnownAnswers = nullptr;
+    uint16_t mKnownAnswerCount    = 0;
+
+#if CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE > 0
+    /// Serialized unicast reply to a query
+    struct CachedResponse
+    {
+        static constexpr size_t kMaxNameSize = 96;
+
+        chip::Inet::InterfaceId interface;
+        chip::Inet::IPAddressType addressType = chip::Inet::IPAddressType::kUnknown;
+        QType type                            = QType::ANY;
+        QClass klass                          = QClass::ANY;
+        bool unicastRequested                 = false;
+        bool includeQuery                     = false;
+        uint8_t name[kMaxNameSize];
+        size_t nameSize = 0;
+
+        chip::System::Clock::Timestamp created = chip::System::Clock::kZero;
+        chip::Platform::ScopedMemoryBuffer<uint8_t> packet;
+        size_t packetSize = 0; // 0 if there is nothing to reply
+        bool valid        = false;
+
+        bool SameKey(const CachedResponse & other) const;
+    };
+
+    /// Fill the key of [entry] for the current query. Returns false if the
+    /// reply to the current query cannot be cached.
+    bool MakeCacheKey(const ResponseConfiguration & configuration, CachedResponse & entry) const;
+    CachedResponse * FindCachedResponse(const CachedResponse & key, chip::System::Clock::Timestamp now);
+    CachedResponse & AllocateCachedResponse();
+    CHIP_ERROR SendCachedResponse(const CachedResponse & entry);
+    void StoreCachedResponse(const uint8_t * data, size_t size);
+
+    CachedResponse mResponseCache[CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE];
+    CachedResponse * mCaptureEntry = nullptr; // where to store the reply being sent
+#endif
 };
 
 } // namespace Minimal
@@ -21,17 +21,78 @@
 #include "ReplyFilter.h"
 #include "Responder.h"
 
+#include <inet/InetInterface.h>
+#include <lib/core/CHIPConfig.h>
 #include <system/SystemClock.h>
 
 namespace mdns {
 namespace Minimal {
 
+/// Tracks the last time a record was multicast on each interface.
+///
+/// RFC 6762 section 6 limits multicasting a record to once per second per
+/// interface. Up to kMaxInterfaces interfaces are tracked, the least recently
+/// used one is forgotten when more are used.
+class MulticastThrottle
+{
+public:
+    static constexpr size_t kMaxInterfaces = CHIP_CONFIG_MINMDNS_MAX_THROTTLED_INTERFACES;
+
+    /// Check if the record was multicast on [interface] at or after [time].
+    bool MulticastSince(chip::Inet::InterfaceId interface, chip::System::Clock::Timestamp time) const
+    {
+        for (auto & entry : mEntries)
+        {
+            if ((entry.lastMulticastTime != chip::System::Clock::kZero) && (entry.interface == interface))
+            {
+                return entry.lastMulticastTime >= time;
+            }
+        }
+        return false;
+    }
+
+    void MarkMulticast(chip::Inet::InterfaceId interface, chip::System::Clock::Timestamp time)
+    {
+        Entry * selected = &mEntries[0];
+        for (auto & entry : mEntries)
+        {
+            if ((entry.lastMulticastTime != chip::System::Clock::kZero) && (entry.interface == interface))
+            {
+                selected = &entry;
+                break;
+            }
+            if (entry.lastMulticastTime < selected->lastMulticastTime)
+            {
+                selected = &entry;
+            }
+        }
+        selected->interface         = interface;
+        selected->lastMulticastTime = time;
+    }
+
+    void Clear()
+    {
+        for (auto & entry : mEntries)
+        {
+            entry.lastMulticastTime = chip::System::Clock::kZero;
+        }
+    }
+
+private:
+    struct Entry
+    {
+        chip::Inet::InterfaceId interface;
+        chip::System::Clock::Timestamp lastMulticastTime = chip::System::Clock::kZero;
+    };
+    Entry mEntries[kMaxInterfaces];
+};
+
 /// Represents available data (replies) for mDNS queries.
 struct QueryResponderRecord
 {
-    Responder * responder                            = nullptr; // what response/data is available
-    bool reportService                               = false;   // report as a service when listing dnssd services
-    chip::System::Clock::Timestamp lastMulticastTime = chip::System::Clock::kZero; // last time this record was multicast
+    Responder * responder = nullptr; // what response/data is available
+    bool reportService    = false;   // report as a service when listing dnssd services
+    MulticastThrottle multicastThrottle; // when this record was last multicast
 };
 
 namespace Internal {
@@ -120,11 +181,13 @@ public:
         return *this;
     }
 
-    /// Filter out anything that was multicast past ms.
+    /// Filter out anything that was multicast on the given interface past ms.
     /// If ms is 0, no filtering is done
-    QueryResponderRecordFilter & SetIncludeOnlyMulticastBeforeMS(chip::System::Clock::Timestamp time)
+    QueryResponderRecordFilter & SetIncludeOnlyMulticastBeforeMS(chip::System::Clock::Timestamp time,
+                                                                 chip::Inet::InterfaceId interface)
     {
         mIncludeOnlyMulticastBefore = time;
+        mMulticastInterface         = interface;
         return *this;
     }
 
@@ -141,7 +204,7 @@ public:
         }
 
         if ((mIncludeOnlyMulticastBefore > chip::System::Clock::kZero) &&
-            (record->lastMulticastTime >= mIncludeOnlyMulticastBefore))
+            record->multicastThrottle.MulticastSince(mMulticastInterface, mIncludeOnlyMulticastBefore))
         {
             return false;
         }
@@ -158,6 +221,7 @@ private:
     bool mIncludeAdditionalRepliesOnly                         = false;
     ReplyFilter * mReplyFilter                                 = nullptr;
     chip::System::Clock::Timestamp mIncludeOnlyMulticastBefore = chip::System::Clock::kZero;
+    chip::Inet::InterfaceId mMulticastInterface                = chip::Inet::InterfaceId::Null();
 };
 
 /// Iterates over an array of QueryResponderRecord items, providing only 'valid' ones, where
@@ -18,6 +18,7 @@
 
 #include <vector>
 
+#include <inet/InetInterface.h>
 #include <lib/dnssd/minimal_mdns/records/Ptr.h>
 
 #include <lib/support/UnitTestRegistration.h>
@@ -169,12 +170,48 @@ void NonDiscoverableService(nlTestSuite * inSuite, void * inContext)
     }
 }
 
+void MulticastThrottlePerInterface(nlTestSuite * inSuite, void * inContext)
+{
+    using namespace chip::System::Clock::Literals;
+
+    const Inet::InterfaceId interface1 = Inet::InterfaceId::Null();
+    Inet::InterfaceId interface2       = Inet::InterfaceId::Null();
+    for (Inet::InterfaceIterator it; it.HasCurrent(); it.Next())
+    {
+        interface2 = it.GetInterfaceId();
+        break;
+    }
+
+    MulticastThrottle throttle;
+    NL_TEST_ASSERT(inSuite, !throttle.MulticastSince(interface1, 1000_ms));
+
+    throttle.MarkMulticast(interface1, 2000_ms);
+    NL_TEST_ASSERT(inSuite, throttle.MulticastSince(interface1, 1000_ms));
+    NL_TEST_ASSERT(inSuite, throttle.MulticastSince(interface1, 2000_ms));
+    NL_TEST_ASSERT(inSuite, !throttle.MulticastSince(interface1, 2001_ms));
+
+    if (interface2 != interface1)
+    {
+        // Multicasting on one interface does not throttle the others
+        NL_TEST_ASSERT(inSuite, !throttle.MulticastSince(interface2, 1000_ms));
+
+        throttle.MarkMulticast(interface2, 3000_ms);
+        NL_TEST_ASSERT(inSuite, throttle.MulticastSince(interface2, 2500_ms));
+        NL_TEST_ASSERT(inSuite, !throttle.MulticastSince(interface1, 2500_ms));
+    }
+
+    throttle.Clear();
+    NL_TEST_ASSERT(inSuite, !throttle.MulticastSince(interface1, 1000_ms));
+    NL_TEST_ASSERT(inSuite, !throttle.MulticastSince(interface2, 1000_ms));
+}
+
 const nlTest sTests[] = {
-    NL_TEST_DEF("CanIterateOverResponders", CanIterateOverResponders), //
-    NL_TEST_DEF("RespondsToDnsSdQueries", RespondsToDnsSdQueries),     //
-    NL_TEST_DEF("LimitedStorage", LimitedStorage),                     //
-    NL_TEST_DEF("NonDiscoverableService", NonDiscoverableService),     //
-    NL_TEST_SENTINEL()                                                 //
+    NL_TEST_DEF("CanIterateOverResponders", CanIterateOverResponders),           //
+    NL_TEST_DEF("RespondsToDnsSdQueries", RespondsToDnsSdQueries),               //
+    NL_TEST_DEF("LimitedStorage", LimitedStorage),                               //
+    NL_TEST_DEF("NonDiscoverableService", NonDiscoverableService),               //
+    NL_TEST_DEF("MulticastThrottlePerInterface", MulticastThrottlePerInterface), //
+    NL_TEST_SENTINEL()                                                           //
 };
 
 } // namespace
@@ -0,0 +1,200 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+#include <lib/dnssd/minimal_mdns/QueryBuilder.h>
+
+#include <lib/dnssd/minimal_mdns/Parser.h>
+#include <lib/dnssd/minimal_mdns/RecordData.h>
+#include <lib/dnssd/minimal_mdns/records/Ptr.h>
+#include <lib/support/CHIPMem.h>
+#include <lib/support/UnitTestRegistration.h>
+
+#include <nlunit-test.h>
+
+namespace {
+
+using namespace chip;
+using namespace mdns::Minimal;
+
+// Same packet size as the minimal mDNS resolver queries
+constexpr size_t kMdnsMaxPacketSize = 1024;
+
+const QNamePart kServiceParts[]   = { "_matter", "_tcp", "local" };
+const QNamePart kInstance1Parts[] = { "1111111111111111-2222222222222222", "_matter", "_tcp", "local" };
+const QNamePart kInstance2Parts[] = { "3333333333333333-4444444444444444", "_matter", "_tcp", "local" };
+const QNamePart kInstance3Parts[] = { "5555555555555555-6666666666666666", "_matter", "_tcp", "local" };
+
+const FullQName kService     = FullQName(kServiceParts);
+const FullQName kInstances[] = { FullQName(kInstance1Parts), FullQName(kInstance2Parts), FullQName(kInstance3Parts) };
+
+/// Collects the queries and answers of a packet
+class PacketContent : public ParserDelegate
+{
+public:
+    static constexpr size_t kMaxItems = 8;
+
+    PacketContent(nlTestSuite * inSuite, const BytesRange & packet) : mSuite(inSuite)
+    {
+        NL_TEST_ASSERT(inSuite, ParsePacket(packet, this));
+    }
+
+    void OnHeader(ConstHeaderRef & header) override
+    {
+        mQueryCount  = header.GetQueryCount();
+        mAnswerCount = header.GetAnswerCount();
+    }
+
+    void OnQuery(const QueryData & data) override
+    {
+        if (mQueries < kMaxItems)
+        {
+            mQueryData[mQueries] = data;
+        }
+        mQueries++;
+    }
+
+    void OnResource(ResourceType type, const ResourceData & data) override
+    {
+        NL_TEST_ASSERT(mSuite, type == ResourceType::kAnswer);
+        NL_TEST_ASSERT(mSuite, mAnswers < kMaxItems);
+        if (mAnswers < kMaxItems)
+        {
+            mAnswerData[mAnswers++] = data;
+        }
+    }
+
+    uint16_t mQueryCount  = 0;
+    uint16_t mAnswerCount = 0;
+    size_t mQueries       = 0;
+    size_t mAnswers       = 0;
+    QueryData mQueryData[kMaxItems];
+    ResourceData mAnswerData[kMaxItems];
+
+private:
+    nlTestSuite * mSuite;
+};
+
+BytesRange PacketRange(const System::PacketBufferHandle & packet)
+{
+    return BytesRange(packet->Start(), packet->Start() + packet->DataLength());
+}
+
+/// Adds operational queries to the builder until one does not fit
+size_t FillWithQueries(QueryBuilder & builder)
+{
+    size_t added = 0;
+    while (builder.TryAddQuery(Query(kInstances[added % ArraySize(kInstances)]).SetType(QType::SRV).SetAnswerViaUnicast(true)))
+    {
+        added++;
+    }
+    return added;
+}
+
+void TestTryAddQueryFillsPacket(nlTestSuite * inSuite, void * inContext)
+{
+    QueryBuilder builder(System::PacketBufferHandle::New(kMdnsMaxPacketSize));
+    NL_TEST_ASSERT(inSuite, builder.Ok());
+
+    const size_t added = FillWithQueries(builder);
+
+    // The query which did not fit is skipped, leaving the packet as it was
+    NL_TEST_ASSERT(inSuite, added > ArraySize(kInstances));
+    NL_TEST_ASSERT(inSuite, builder.Ok());
+    NL_TEST_ASSERT(inSuite, builder.Header().GetQueryCount() == added);
+
+    System::PacketBufferHandle packet = builder.ReleasePacket();
+    PacketContent content(inSuite, PacketRange(packet));
+    NL_TEST_ASSERT(inSuite, content.mQueryCount == added && content.mQueries == added);
+    for (size_t i = 0; i < content.mQueries && i < PacketContent::kMaxItems; i++)
+    {
+        NL_TEST_ASSERT(inSuite, content.mQueryData[i].GetName() == kInstances[i % ArraySize(kInstances)]);
+        NL_TEST_ASSERT(inSuite, content.mQueryData[i].GetType() == QType::SRV);
+        NL_TEST_ASSERT(inSuite, content.mQueryData[i].RequestedUnicastAnswer());
+    }
+}
+
+void TestAddQueryFailureInvalidatesPacket(nlTestSuite * inSuite, void * inContext)
+{
+    QueryBuilder builder(System::PacketBufferHandle::New(kMdnsMaxPacketSize));
+    FillWithQueries(builder);
+    NL_TEST_ASSERT(inSuite, builder.Ok());
+
+    // Unlike TryAddQuery, a query that does not fit makes the whole packet invalid
+    builder.AddQuery(Query(kInstances[0]).SetType(QType::SRV));
+    NL_TEST_ASSERT(inSuite, !builder.Ok());
+    NL_TEST_ASSERT(inSuite, !builder.TryAddQuery(Query(kService).SetType(QType::PTR)));
+
+    // Reset makes the builder usable again
+    builder.Reset(System::PacketBufferHandle::New(kMdnsMaxPacketSize));
+    NL_TEST_ASSERT(inSuite, builder.Ok());
+    NL_TEST_ASSERT(inSuite, builder.TryAddQuery(Query(kService).SetType(QType::PTR)));
+    NL_TEST_ASSERT(inSuite, builder.Header().GetQueryCount() == 1);
+}
+
+void TestAnswersFollowQueries(nlTestSuite * inSuite, void * inContext)
+{
+    QueryBuilder builder(System::PacketBufferHandle::New(kMdnsMaxPacketSize));
+    NL_TEST_ASSERT(inSuite, builder.TryAddQuery(Query(kService).SetType(QType::PTR)));
+    NL_TEST_ASSERT(inSuite, builder.AddAnswer(PtrResourceRecord(kService, kInstances[0])));
+    NL_TEST_ASSERT(inSuite, builder.AddAnswer(PtrResourceRecord(kService, kInstances[1])));
+
+    // Questions cannot follow answers: the packet stays valid without it
+    NL_TEST_ASSERT(inSuite, !builder.TryAddQuery(Query(kInstances[2]).SetType(QType::SRV)));
+    NL_TEST_ASSERT(inSuite, builder.Ok());
+
+    System::PacketBufferHandle packet = builder.ReleasePacket();
+    const BytesRange range            = PacketRange(packet);
+    PacketContent content(inSuite, range);
+    NL_TEST_ASSERT(inSuite, content.mQueryCount == 1 && content.mQueries == 1);
+    NL_TEST_ASSERT(inSuite, content.mAnswerCount == 2 && content.mAnswers == 2);
+
+    for (size_t i = 0; i < content.mAnswers; i++)
+    {
+        SerializedQNameIterator target;
+        NL_TEST_ASSERT(inSuite, content.mAnswerData[i].GetName() == kService);
+        NL_TEST_ASSERT(inSuite, ParsePtrRecord(content.mAnswerData[i].GetData(), range, &target));
+        NL_TEST_ASSERT(inSuite, target == kInstances[i]);
+    }
+}
+
+int Setup(void * inContext)
+{
+    return (Platform::MemoryInit() == CHIP_NO_ERROR) ? SUCCESS : FAILURE;
+}
+
+int Teardown(void * inContext)
+{
+    Platform::MemoryShutdown();
+    return SUCCESS;
+}
+
+const nlTest sTests[] = {
+    NL_TEST_DEF("TestTryAddQueryFillsPacket", TestTryAddQueryFillsPacket),                     //
+    NL_TEST_DEF("TestAddQueryFailureInvalidatesPacket", TestAddQueryFailureInvalidatesPacket), //
+    NL_TEST_DEF("TestAnswersFollowQueries", TestAnswersFollowQueries),                         //
+    NL_TEST_SENTINEL()                                                                         //
+};
+
+} // namespace
+
+int TestQueryBuilder(void)
+{
+    nlTestSuite theSuite = { "QueryBuilder", sTests, &Setup, &Teardown };
+    nlTestRunner(&theSuite, nullptr);
+    return nlTestRunnerStats(&theSuite);
+}
+
+CHIP_REGISTER_TEST_SUITE(TestQueryBuilder)
@@ -0,0 +1,355 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <lib/address_resolve/AddressResolve.h>
+#include <lib/dnssd/ActiveResolveAttempts.h>
+#include <lib/dnssd/MinimalMdnsServer.h>
+#include <lib/dnssd/Resolver.h>
+#include <lib/dnssd/ServiceNaming.h>
+#include <lib/dnssd/minimal_mdns/Parser.h>
+#include <lib/dnssd/minimal_mdns/Server.h>
+#include <lib/dnssd/minimal_mdns/core/QNameString.h>
+#include <lib/support/CHIPMem.h>
+#include <lib/support/UnitTestRegistration.h>
+#include <system/SystemPacketBuffer.h>
+#include <transport/raw/tests/NetworkTestHelpers.h>
+
+#include <nlunit-test.h>
+
+#include <algorithm>
+
+namespace {
+
+using namespace chip;
+using namespace chip::Dnssd;
+using namespace mdns::Minimal;
+
+/// Records the operational queries sent by the resolver instead of sending them
+class QueryCaptureServer : private chip::PoolImpl<ServerBase::EndpointInfo, 0, chip::ObjectPoolMem::kInline,
+                                                  ServerBase::EndpointInfoPoolType::Interface>,
+                           public ServerBase,
+                           public ParserDelegate
+{
+public:
+    static constexpr size_t kMaxPackets          = 4;
+    static constexpr size_t kMaxQueriesPerPacket = 16;
+
+    struct SentPacket
+    {
+        bool unicastQuery     = false; // sent through BroadcastUnicastQuery
+        bool unicastAnswers   = true;  // every query has the QU bit set
+        uint16_t headerCount  = 0;
+        size_t queryCount     = 0;
+        PeerId peers[kMaxQueriesPerPacket];
+
+        bool Contains(const PeerId & peerId) const
+        {
+            for (size_t i = 0; i < queryCount; i++)
+            {
+                if (peers[i] == peerId)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    QueryCaptureServer(nlTestSuite * inSuite) :
+        ServerBase(*static_cast<ServerBase::EndpointInfoPoolType *>(this)), mSuite(inSuite)
+    {}
+
+    using ServerBase::BroadcastSend;
+    using ServerBase::BroadcastUnicastQuery;
+
+    CHIP_ERROR BroadcastUnicastQuery(System::PacketBufferHandle && data, uint16_t port) override
+    {
+        return Capture(std::move(data), /* unicastQuery */ true);
+    }
+
+    CHIP_ERROR BroadcastSend(System::PacketBufferHandle && data, uint16_t port) override
+    {
+        return Capture(std::move(data), /* unicastQuery */ false);
+    }
+
+    // Parser delegates
+    void OnHeader(ConstHeaderRef & header) override
+    {
+        NL_TEST_ASSERT(mSuite, header.GetFlags().IsQuery());
+        mCurrent->headerCount = header.GetQueryCount();
+    }
+
+    void OnQuery(const QueryData & data) override
+    {
+        // Operational resolves ask for any record of the instance name
+        NL_TEST_ASSERT(mSuite, data.GetType() == QType::ANY);
+        mCurrent->unicastAnswers = mCurrent->unicastAnswers && data.RequestedUnicastAnswer();
+
+        PeerId peerId;
+        QNameString name(data.GetName());
+        NL_TEST_ASSERT(mSuite, ExtractIdFromInstanceName(name.c_str(), &peerId) == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(mSuite, mCurrent->queryCount < kMaxQueriesPerPacket);
+        if (mCurrent->queryCount < kMaxQueriesPerPacket)
+        {
+            mCurrent->peers[mCurrent->queryCount++] = peerId;
+        }
+    }
+
+    void OnResource(ResourceType type, const ResourceData & data) override {}
+
+    size_t GetPacketCount() const { return mPacketCount; }
+    const SentPacket & GetPacket(size_t index) const { return mPackets[index]; }
+    void Reset() { mPacketCount = 0; }
+
+private:
+    CHIP_ERROR Capture(System::PacketBufferHandle && data, bool unicastQuery)
+    {
+        NL_TEST_ASSERT(mSuite, mPacketCount < kMaxPackets);
+        VerifyOrReturnError(mPacketCount < kMaxPackets, CHIP_ERROR_NO_MEMORY);
+
+        mCurrent               = &mPackets[mPacketCount++];
+        *mCurrent              = SentPacket();
+        mCurrent->unicastQuery = unicastQuery;
+
+        NL_TEST_ASSERT(mSuite, ParsePacket(BytesRange(data->Start(), data->Start() + data->DataLength()), this));
+        return CHIP_NO_ERROR;
+    }
+
+    nlTestSuite * mSuite;
+    SentPacket mPackets[kMaxPackets];
+    SentPacket * mCurrent = nullptr;
+    size_t mPacketCount   = 0;
+};
+
+class NoopListener : public AddressResolve::NodeListener
+{
+public:
+    void OnNodeAddressResolved(const PeerId & peerId, const AddressResolve::ResolveResult & result) override {}
+    void OnNodeAddressResolutionFailed(const PeerId & peerId, CHIP_ERROR reason) override {}
+};
+
+struct TestContext
+{
+    Test::IOContext * ioContext;
+    QueryCaptureServer * server;
+};
+
+PeerId MakePeerId(uint64_t index)
+{
+    return PeerId().SetCompressedFabricId(0x1000 + index).SetNodeId(0x2000 + index);
+}
+
+void CheckPacketPeers(nlTestSuite * inSuite, const QueryCaptureServer::SentPacket & packet, const PeerId * peers, size_t count)
+{
+    NL_TEST_ASSERT(inSuite, packet.unicastQuery);
+    NL_TEST_ASSERT(inSuite, packet.unicastAnswers);
+    NL_TEST_ASSERT(inSuite, packet.headerCount == count);
+    NL_TEST_ASSERT(inSuite, packet.queryCount == count);
+    for (size_t i = 0; i < packet.queryCount && i < count; i++)
+    {
+        NL_TEST_ASSERT(inSuite, packet.peers[i] == peers[i]);
+    }
+}
+
+/// Drop the resolves left pending by earlier tests
+void ResetResolver(TestContext & ctx)
+{
+    Resolver::Instance().Shutdown();
+    Resolver::Instance().Init(ctx.ioContext->GetUDPEndPointManager());
+}
+
+void TestResolveNodeIdsBatchesQueries(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx           = *static_cast<TestContext *>(inContext);
+    QueryCaptureServer & server = *ctx.server;
+
+    // More resolves than the retry queue holds by default
+    constexpr size_t kQueueSize = ActiveResolveAttempts::kRetryQueueSize;
+    PeerId peers[kQueueSize + 6];
+    for (size_t i = 0; i < ArraySize(peers); i++)
+    {
+        peers[i] = MakePeerId(i);
+    }
+
+    ResetResolver(ctx);
+    server.Reset();
+    NL_TEST_ASSERT(inSuite,
+                   Resolver::Instance().ResolveNodeIds(Span<const PeerId>(peers), Inet::IPAddressType::kAny) == CHIP_NO_ERROR);
+
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    // The retry queue grows to hold every resolve, which all share one packet
+    NL_TEST_ASSERT(inSuite, server.GetPacketCount() == 1);
+    if (server.GetPacketCount() == 1)
+    {
+        CheckPacketPeers(inSuite, server.GetPacket(0), peers, ArraySize(peers));
+    }
+#else
+    // Resolves are sent once the retry queue is full, so that none is evicted
+    // before its first query goes out
+    constexpr size_t kPacketCount = (ArraySize(peers) + kQueueSize - 1) / kQueueSize;
+    NL_TEST_ASSERT(inSuite, server.GetPacketCount() == kPacketCount);
+    for (size_t i = 0; i < server.GetPacketCount() && i < kPacketCount; i++)
+    {
+        const size_t first = i * kQueueSize;
+        CheckPacketPeers(inSuite, server.GetPacket(i), peers + first, std::min(kQueueSize, ArraySize(peers) - first));
+    }
+#endif
+}
+
+void TestSingleResolveSendsOneQuery(nlTestSuite * inSuite, void * inContext)
+{
+    QueryCaptureServer & server = *static_cast<TestContext *>(inContext)->server;
+    const PeerId peer           = MakePeerId(100);
+
+    server.Reset();
+    NL_TEST_ASSERT(inSuite, Resolver::Instance().ResolveNodeId(peer, Inet::IPAddressType::kAny) == CHIP_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, server.GetPacketCount() == 1);
+    if (server.GetPacketCount() == 1)
+    {
+        CheckPacketPeers(inSuite, server.GetPacket(0), &peer, 1);
+    }
+}
+
+void TestLookupsStartTogether(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx           = *static_cast<TestContext *>(inContext);
+    QueryCaptureServer & server = *ctx.server;
+    auto & addressResolver      = AddressResolve::Resolver::Instance();
+
+    NL_TEST_ASSERT(inSuite, addressResolver.Init(&ctx.ioContext->GetSystemLayer()) == CHIP_NO_ERROR);
+
+    constexpr size_t kLookupCount = 3;
+    static_assert(kLookupCount <= ActiveResolveAttempts::kRetryQueueSize, "Lookups must fit in a single resolve batch");
+
+    NoopListener listener;
+    PeerId peers[kLookupCount];
+    AddressResolve::Impl::NodeLookupHandle handles[kLookupCount];
+
+    server.Reset();
+    for (size_t i = 0; i < kLookupCount; i++)
+    {
+        peers[i] = MakePeerId(200 + i);
+        handles[i].SetListener(&listener);
+        NL_TEST_ASSERT(inSuite,
+                       addressResolver.LookupNode(AddressResolve::NodeLookupRequest(peers[i]), handles[i]) == CHIP_NO_ERROR);
+    }
+
+    // Lookups only start from the event loop...
+    NL_TEST_ASSERT(inSuite, server.GetPacketCount() == 0);
+
+    ctx.ioContext->DriveIOUntil(System::Clock::Seconds16(1), [&server]() { return server.GetPacketCount() > 0; });
+
+    // ... where all the lookups requested meanwhile share one query packet
+    NL_TEST_ASSERT(inSuite, server.GetPacketCount() == 1);
+    if (server.GetPacketCount() == 1)
+    {
+        CheckPacketPeers(inSuite, server.GetPacket(0), peers, kLookupCount);
+    }
+
+    for (auto & handle : handles)
+    {
+        NL_TEST_ASSERT(inSuite,
+                       addressResolver.CancelLookup(handle, AddressResolve::Resolver::FailureCallback::Skip) == CHIP_NO_ERROR);
+    }
+    addressResolver.Shutdown();
+}
+
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+void TestBulkResolveRetriesEveryPeer(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx           = *static_cast<TestContext *>(inContext);
+    QueryCaptureServer & server = *ctx.server;
+
+    PeerId peers[ActiveResolveAttempts::kRetryQueueSize + 6];
+    for (size_t i = 0; i < ArraySize(peers); i++)
+    {
+        peers[i] = MakePeerId(300 + i);
+    }
+
+    ResetResolver(ctx);
+    server.Reset();
+    NL_TEST_ASSERT(inSuite,
+                   Resolver::Instance().ResolveNodeIds(Span<const PeerId>(peers), Inet::IPAddressType::kAny) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, server.GetPacketCount() == 1);
+
+    // No answer comes back, so every peer is queried again on the first retry
+    auto allRetried = [&server, &peers]() {
+        for (const auto & peer : peers)
+        {
+            bool retried = false;
+            for (size_t i = 1; i < server.GetPacketCount() && !retried; i++)
+            {
+                retried = server.GetPacket(i).Contains(peer);
+            }
+            if (!retried)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    ctx.ioContext->DriveIOUntil(System::Clock::Seconds16(3), allRetried);
+
+    NL_TEST_ASSERT(inSuite, allRetried());
+    for (size_t i = 1; i < server.GetPacketCount(); i++)
+    {
+        // Retries are multicast queries
+        NL_TEST_ASSERT(inSuite, !server.GetPacket(i).unicastQuery);
+    }
+
+    ResetResolver(ctx);
+}
+#endif // CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+
+const nlTest sTests[] = {
+    NL_TEST_DEF("ResolveNodeIdsBatchesQueries", TestResolveNodeIdsBatchesQueries), //
+    NL_TEST_DEF("SingleResolveSendsOneQuery", TestSingleResolveSendsOneQuery),     //
+    NL_TEST_DEF("LookupsStartTogether", TestLookupsStartTogether),                 //
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    NL_TEST_DEF("BulkResolveRetriesEveryPeer", TestBulkResolveRetriesEveryPeer),   //
+#endif
+    NL_TEST_SENTINEL()                                                             //
+};
+
+} // namespace
+
+int TestResolveBatching(void)
+{
+    chip::Platform::MemoryInit();
+    chip::Test::IOContext ioContext;
+    ioContext.Init();
+
+    nlTestSuite theSuite = { "ResolveBatching", sTests, nullptr, nullptr };
+    QueryCaptureServer server(&theSuite);
+    GlobalMinimalMdnsServer::Instance().SetReplacementServer(&server);
+
+    // Listening is not needed: queries are captured by the replacement server
+    Resolver::Instance().Init(ioContext.GetUDPEndPointManager());
+
+    TestContext context = { &ioContext, &server };
+    nlTestRunner(&theSuite, &context);
+
+    Resolver::Instance().Shutdown();
+    GlobalMinimalMdnsServer::Instance().SetReplacementServer(nullptr);
+    ioContext.Shutdown();
+    chip::Platform::MemoryShutdown();
+
+    return nlTestRunnerStats(&theSuite);
+}
+
+CHIP_REGISTER_TEST_SUITE(TestResolveBatching)
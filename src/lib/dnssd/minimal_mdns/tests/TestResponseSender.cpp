@@ -19,6 +19,7 @@
 #include <string>
 #include <vector>
 
+#include <lib/dnssd/minimal_mdns/QueryBuilder.h>
 #include <lib/dnssd/minimal_mdns/RecordData.h>
 #include <lib/dnssd/minimal_mdns/core/FlatAllocatedQName.h>
 #include <lib/dnssd/minimal_mdns/core/RecordWriter.h>
@@ -344,6 +345,236 @@ void PtrSrvTxtMultipleRespondersToServiceListing(nlTestSuite * inSuite, void * i
     NL_TEST_ASSERT(inSuite, common1.server.GetHeaderFound());
 }
 
+#if CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE > 0
+void CachedResponseIsReused(nlTestSuite * inSuite, void * inContext)
+{
+    CommonTestElements common(inSuite, "test");
+    ResponseSender responseSender(&common.server);
+    NL_TEST_ASSERT(inSuite, responseSender.AddQueryResponder(&common.queryResponder) == CHIP_NO_ERROR);
+    common.queryResponder.AddResponder(&common.srvResponder);
+
+    common.recordWriter.WriteQName(common.instance);
+    QueryData queryData = QueryData(QType::ANY, QClass::IN, false, common.requestNameStart, common.requestBytesRange);
+
+    common.server.AddExpectedRecord(&common.srvRecord);
+    NL_TEST_ASSERT(inSuite, responseSender.Respond(1, queryData, &common.packetInfo, ResponseConfiguration()) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, common.server.GetSendCalled());
+    NL_TEST_ASSERT(inSuite, common.server.GetHeaderFound());
+
+    // The sender is not told about the new responder: the cached reply is sent
+    common.queryResponder.AddResponder(&common.txtResponder);
+    common.server.Reset();
+    common.server.AddExpectedRecord(&common.srvRecord);
+    NL_TEST_ASSERT(inSuite, responseSender.Respond(2, queryData, &common.packetInfo, ResponseConfiguration()) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, common.server.GetSendCalled());
+    NL_TEST_ASSERT(inSuite, common.server.GetHeaderFound());
+
+    // Once invalidated, the reply is built again
+    responseSender.InvalidateResponseCache();
+    common.server.Reset();
+    common.server.AddExpectedRecord(&common.srvRecord);
+    common.server.AddExpectedRecord(&common.txtRecord);
+    NL_TEST_ASSERT(inSuite, responseSender.Respond(3, queryData, &common.packetInfo, ResponseConfiguration()) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, common.server.GetSendCalled());
+    NL_TEST_ASSERT(inSuite, common.server.GetHeaderFound());
+}
+#endif
+
+/// Build a query with a known answer, and check that the known answer decodes
+/// back to the record: its name is compressed against the query name.
+System::PacketBufferHandle BuildKnownAnswerQuery(nlTestSuite * inSuite, const Query & query, const ResourceRecord & answer)
+{
+    QueryBuilder builder(System::PacketBufferHandle::New(512));
+    builder.AddQuery(query);
+    NL_TEST_ASSERT(inSuite, builder.AddAnswer(answer));
+    NL_TEST_ASSERT(inSuite, builder.Ok());
+    System::PacketBufferHandle packet = builder.ReleasePacket();
+
+    const BytesRange packetRange(packet->Start(), packet->Start() + packet->DataLength());
+    const uint8_t * data = packet->Start() + HeaderRef::kSizeBytes;
+    QueryData queryData;
+    ResourceData answerData;
+    NL_TEST_ASSERT(inSuite, queryData.Parse(packetRange, &data));
+    NL_TEST_ASSERT(inSuite, answerData.Parse(packetRange, &data));
+    NL_TEST_ASSERT(inSuite, data == packetRange.End());
+    NL_TEST_ASSERT(inSuite, answerData.GetType() == answer.GetType());
+    NL_TEST_ASSERT(inSuite, answerData.GetName() == answer.GetName());
+
+    return packet;
+}
+
+/// Reply to the query at the start of [packet], using its answers as known answers.
+void RespondWithKnownAnswers(nlTestSuite * inSuite, ResponseSender & responseSender, const System::PacketBufferHandle & packet,
+                             const Inet::IPPacketInfo & packetInfo)
+{
+    const BytesRange packetRange(packet->Start(), packet->Start() + packet->DataLength());
+    const uint8_t * queryStart = packet->Start() + HeaderRef::kSizeBytes;
+    QueryData queryData;
+    NL_TEST_ASSERT(inSuite, queryData.Parse(packetRange, &queryStart));
+
+    responseSender.SetKnownAnswers(packetRange);
+    NL_TEST_ASSERT(inSuite, responseSender.Respond(1, queryData, &packetInfo, ResponseConfiguration()) == CHIP_NO_ERROR);
+    responseSender.ClearKnownAnswers();
+}
+
+void KnownSrvAnswerIsNotSent(nlTestSuite * inSuite, void * inContext)
+{
+    CommonTestElements common(inSuite, "test");
+    ResponseSender responseSender(&common.server);
+    NL_TEST_ASSERT(inSuite, responseSender.AddQueryResponder(&common.queryResponder) == CHIP_NO_ERROR);
+    common.queryResponder.AddResponder(&common.srvResponder);
+    common.queryResponder.AddResponder(&common.txtResponder);
+
+    // Query for the instance, listing its SRV record as known answer
+    const Query query = Query(common.instance).SetType(QType::ANY).SetClass(QClass::IN);
+    System::PacketBufferHandle packet = BuildKnownAnswerQuery(inSuite, query, common.srvRecord);
+
+    common.server.AddExpectedRecord(&common.txtRecord);
+    RespondWithKnownAnswers(inSuite, responseSender, packet, common.packetInfo);
+    NL_TEST_ASSERT(inSuite, common.server.GetSendCalled());
+    NL_TEST_ASSERT(inSuite, common.server.GetHeaderFound());
+
+    // Known answers with less than half their TTL left are sent again
+    SrvResourceRecord expiringSrv = common.srvRecord;
+    expiringSrv.SetTtl(common.srvRecord.GetTtl() / 2 - 1);
+    packet = BuildKnownAnswerQuery(inSuite, query, expiringSrv);
+
+    common.server.Reset();
+    common.server.AddExpectedRecord(&common.srvRecord);
+    common.server.AddExpectedRecord(&common.txtRecord);
+    RespondWithKnownAnswers(inSuite, responseSender, packet, common.packetInfo);
+    NL_TEST_ASSERT(inSuite, common.server.GetSendCalled());
+    NL_TEST_ASSERT(inSuite, common.server.GetHeaderFound());
+}
+
+void KnownPtrAnswerIsNotSent(nlTestSuite * inSuite, void * inContext)
+{
+    CommonTestElements common(inSuite, "test");
+    ResponseSender responseSender(&common.server);
+    NL_TEST_ASSERT(inSuite, responseSender.AddQueryResponder(&common.queryResponder) == CHIP_NO_ERROR);
+    common.queryResponder.AddResponder(&common.ptrResponder);
+
+    // A browse listing the only instance as known answer, the way browse retries are sent
+    System::PacketBufferHandle packet =
+        BuildKnownAnswerQuery(inSuite, Query(common.service).SetType(QType::PTR).SetClass(QClass::IN), common.ptrRecord);
+
+    const BytesRange packetRange(packet->Start(), packet->Start() + packet->DataLength());
+    const uint8_t * data = packet->Start() + HeaderRef::kSizeBytes;
+    QueryData queryData;
+    ResourceData answerData;
+    SerializedQNameIterator target;
+    NL_TEST_ASSERT(inSuite, queryData.Parse(packetRange, &data) && answerData.Parse(packetRange, &data));
+    NL_TEST_ASSERT(inSuite, ParsePtrRecord(answerData.GetData(), packetRange, &target));
+    NL_TEST_ASSERT(inSuite, target == common.instance);
+
+    // The only answer is known: nothing is sent
+    RespondWithKnownAnswers(inSuite, responseSender, packet, common.packetInfo);
+    NL_TEST_ASSERT(inSuite, !common.server.GetSendCalled());
+}
+
+/// Fires the timer of the delayed reply on demand
+class ManualTimerLayer : public System::Layer
+{
+public:
+    CHIP_ERROR Init() override { return CHIP_NO_ERROR; }
+    void Shutdown() override {}
+    bool IsInitialized() const override { return true; }
+
+    CHIP_ERROR StartTimer(System::Clock::Timeout aDelay, System::TimerCompleteCallback aComplete, void * aAppState) override
+    {
+        mDelay    = aDelay;
+        mCallback = aComplete;
+        mAppState = aAppState;
+        return CHIP_NO_ERROR;
+    }
+
+    void CancelTimer(System::TimerCompleteCallback aOnComplete, void * aAppState) override
+    {
+        if (mCallback == aOnComplete && mAppState == aAppState)
+        {
+            mCallback = nullptr;
+        }
+    }
+
+    CHIP_ERROR ScheduleWork(System::TimerCompleteCallback aComplete, void * aAppState) override
+    {
+        return CHIP_ERROR_NOT_IMPLEMENTED;
+    }
+
+    bool TimerStarted() const { return mCallback != nullptr; }
+
+    void FireTimer()
+    {
+        System::TimerCompleteCallback callback = mCallback;
+        mCallback                              = nullptr;
+        callback(this, mAppState);
+    }
+
+    System::Clock::Timeout mDelay;
+
+private:
+    System::TimerCompleteCallback mCallback = nullptr;
+    void * mAppState                        = nullptr;
+};
+
+/// Checks multicast replies the same way as unicast ones
+class MulticastCheckServer : public CheckOnlyServer
+{
+public:
+    MulticastCheckServer(nlTestSuite * inSuite) : CheckOnlyServer(inSuite) {}
+
+    CHIP_ERROR BroadcastSend(System::PacketBufferHandle && data, uint16_t port, Inet::InterfaceId interface,
+                             Inet::IPAddressType addressType) override
+    {
+        return DirectSend(std::move(data), Inet::IPAddress::Any, port, interface);
+    }
+};
+
+void OnlySharedAnswersAreDelayed(nlTestSuite * inSuite, void * inContext)
+{
+    CommonTestElements common(inSuite, "test");
+    MulticastCheckServer server(inSuite);
+    ManualTimerLayer timerLayer;
+    ResponseSender responseSender(&server);
+    responseSender.SetSystemLayer(&timerLayer);
+    NL_TEST_ASSERT(inSuite, responseSender.AddQueryResponder(&common.queryResponder) == CHIP_NO_ERROR);
+    common.queryResponder.AddResponder(&common.ptrResponder);
+    common.queryResponder.AddResponder(&common.srvResponder);
+    common.queryResponder.AddResponder(&common.txtResponder);
+
+    // Queries from the mDNS port get multicast replies
+    Inet::IPPacketInfo packetInfo = common.packetInfo;
+    packetInfo.SrcPort            = 5353;
+
+    // SRV and TXT records are unique: they are multicast right away
+    common.recordWriter.WriteQName(common.instance);
+    QueryData instanceQuery = QueryData(QType::ANY, QClass::IN, false, common.requestNameStart, common.requestBytesRange);
+    server.AddExpectedRecord(&common.srvRecord);
+    server.AddExpectedRecord(&common.txtRecord);
+    NL_TEST_ASSERT(inSuite, responseSender.Respond(1, instanceQuery, &packetInfo, ResponseConfiguration()) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, server.GetSendCalled());
+    NL_TEST_ASSERT(inSuite, server.GetHeaderFound());
+    NL_TEST_ASSERT(inSuite, !timerLayer.TimerStarted());
+
+    // PTR records are shared: the reply waits for 20-120ms
+    uint8_t serviceQueryStorage[64];
+    Encoding::BigEndian::BufferWriter serviceQueryWriter(serviceQueryStorage, sizeof(serviceQueryStorage));
+    RecordWriter(&serviceQueryWriter).WriteQName(common.service);
+    QueryData serviceQuery = QueryData(QType::PTR, QClass::IN, false, serviceQueryStorage,
+                                       BytesRange(serviceQueryStorage, serviceQueryStorage + serviceQueryWriter.Needed()));
+    server.Reset();
+    server.AddExpectedRecord(&common.ptrRecord);
+    NL_TEST_ASSERT(inSuite, responseSender.Respond(2, serviceQuery, &packetInfo, ResponseConfiguration()) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, !server.GetSendCalled());
+    NL_TEST_ASSERT(inSuite, timerLayer.TimerStarted());
+    NL_TEST_ASSERT(inSuite, timerLayer.mDelay >= System::Clock::Milliseconds32(20));
+    NL_TEST_ASSERT(inSuite, timerLayer.mDelay <= System::Clock::Milliseconds32(120));
+
+    timerLayer.FireTimer();
+    NL_TEST_ASSERT(inSuite, server.GetSendCalled());
+    NL_TEST_ASSERT(inSuite, server.GetHeaderFound());
+}
+
 const nlTest sTests[] = {
     NL_TEST_DEF("SrvAnyResponseToInstance", SrvAnyResponseToInstance),                                       //
     NL_TEST_DEF("SrvTxtAnyResponseToInstance", SrvTxtAnyResponseToInstance),                                 //
@@ -355,6 +586,12 @@ const nlTest sTests[] = {
     NL_TEST_DEF("AddManyQueryResponders", AddManyQueryResponders),                                           //
     NL_TEST_DEF("PtrSrvTxtMultipleRespondersToInstance", PtrSrvTxtMultipleRespondersToInstance),             //
     NL_TEST_DEF("PtrSrvTxtMultipleRespondersToServiceListing", PtrSrvTxtMultipleRespondersToServiceListing), //
+#if CHIP_CONFIG_MINMDNS_RESPONSE_CACHE_SIZE > 0
+    NL_TEST_DEF("CachedResponseIsReused", CachedResponseIsReused), //
+#endif
+    NL_TEST_DEF("KnownSrvAnswerIsNotSent", KnownSrvAnswerIsNotSent),                                         //
+    NL_TEST_DEF("KnownPtrAnswerIsNotSent", KnownPtrAnswerIsNotSent),                                         //
+    NL_TEST_DEF("OnlySharedAnswersAreDelayed", OnlySharedAnswersAreDelayed),                                 //
 
     NL_TEST_SENTINEL() //
 };
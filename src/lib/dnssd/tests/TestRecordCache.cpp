@@ -0,0 +1,348 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <lib/dnssd/RecordCache.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <lib/dnssd/minimal_mdns/Parser.h>
+#include <lib/dnssd/minimal_mdns/Query.h>
+#include <lib/dnssd/minimal_mdns/QueryBuilder.h>
+#include <lib/dnssd/minimal_mdns/RecordData.h>
+#include <lib/dnssd/minimal_mdns/core/tests/QNameStrings.h>
+#include <lib/dnssd/minimal_mdns/records/IP.h>
+#include <lib/dnssd/minimal_mdns/records/Ptr.h>
+#include <lib/dnssd/minimal_mdns/records/ResourceRecord.h>
+#include <lib/dnssd/minimal_mdns/records/Srv.h>
+#include <lib/dnssd/minimal_mdns/records/Txt.h>
+#include <lib/support/CHIPMem.h>
+#include <lib/support/UnitTestRegistration.h>
+#include <system/SystemPacketBuffer.h>
+
+#include <nlunit-test.h>
+
+using namespace chip;
+using namespace chip::Dnssd;
+using namespace mdns::Minimal;
+using namespace chip::System::Clock::Literals;
+
+namespace {
+
+const auto kTestOperationalName  = testing::TestQName<4>({ "1234567898765432-ABCDEFEDCBAABCDE", "_matter", "_tcp", "local" });
+const auto kOtherOperationalName = testing::TestQName<4>({ "1234567898765432-0000000000000001", "_matter", "_tcp", "local" });
+const auto kOperationalService   = testing::TestQName<3>({ "_matter", "_tcp", "local" });
+const auto kTestHostName         = testing::TestQName<2>({ "abcd", "local" });
+const auto kOtherHostName        = testing::TestQName<2>({ "efgh", "local" });
+const auto kNonMatterName        = testing::TestQName<4>({ "printer", "_ipp", "_tcp", "local" });
+
+const PeerId kTestPeerId = PeerId().SetCompressedFabricId(0x1234567898765432ULL).SetNodeId(0xABCDEFEDCBAABCDEULL);
+
+void CallOnRecord(nlTestSuite * inSuite, RecordCache & cache, const ResourceRecord & record)
+{
+    uint8_t headerBuffer[HeaderRef::kSizeBytes] = {};
+    HeaderRef dummyHeader(headerBuffer);
+
+    uint8_t dataBuffer[256];
+    chip::Encoding::BigEndian::BufferWriter output(dataBuffer, sizeof(dataBuffer));
+    RecordWriter writer(&output);
+
+    NL_TEST_ASSERT(inSuite, record.Append(dummyHeader, ResourceType::kAnswer, writer));
+    NL_TEST_ASSERT(inSuite, writer.Fit());
+
+    ResourceData resource;
+    BytesRange packet(dataBuffer, dataBuffer + sizeof(dataBuffer));
+    const uint8_t * _ptr = dataBuffer;
+    NL_TEST_ASSERT(inSuite, resource.Parse(packet, &_ptr));
+    cache.OnRecord(Inet::InterfaceId::Null(), resource, packet);
+}
+
+void AddSrv(nlTestSuite * inSuite, RecordCache & cache, const FullQName & instance, const FullQName & host, uint32_t ttl = 120)
+{
+    SrvResourceRecord record(instance, host, 0x1234 /* port */);
+    record.SetTtl(ttl);
+    CallOnRecord(inSuite, cache, record);
+}
+
+void AddAddress(nlTestSuite * inSuite, RecordCache & cache, const FullQName & host, const char * address, uint32_t ttl = 120,
+                bool cacheFlush = false)
+{
+    Inet::IPAddress addr;
+    NL_TEST_ASSERT(inSuite, Inet::IPAddress::FromString(address, addr));
+
+    IPResourceRecord record(host, addr);
+    record.SetTtl(ttl);
+    record.SetCacheFlush(cacheFlush);
+    CallOnRecord(inSuite, cache, record);
+}
+
+void TestOperationalResolve(nlTestSuite * inSuite, void * inContext)
+{
+    System::Clock::Internal::MockClock mockClock;
+    RecordCache cache(&mockClock);
+    ResolvedNodeData nodeData;
+
+    mockClock.AdvanceMonotonic(1234_ms32);
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_ERROR_NOT_FOUND);
+
+    // Addresses of unknown hosts are not cached
+    AddAddress(inSuite, cache, kTestHostName.Full(), "fe80::abcd:ef11:2233:4455");
+    AddSrv(inSuite, cache, kTestOperationalName.Full(), kTestHostName.Full());
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_ERROR_NOT_FOUND);
+
+    AddAddress(inSuite, cache, kTestHostName.Full(), "fe80::abcd:ef11:2233:4455");
+    AddAddress(inSuite, cache, kOtherHostName.Full(), "fe80::1234");
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, nodeData.operationalData.peerId == kTestPeerId);
+    NL_TEST_ASSERT(inSuite, nodeData.resolutionData.port == 0x1234);
+    NL_TEST_ASSERT(inSuite, strcmp(nodeData.resolutionData.hostName, "abcd") == 0);
+    NL_TEST_ASSERT(inSuite, nodeData.resolutionData.numIPs == 1);
+    NL_TEST_ASSERT(inSuite, !nodeData.resolutionData.GetMrpRetryIntervalIdle().HasValue());
+
+    // TXT data is included once received
+    {
+        const char * entries[] = { "SII=23" };
+        CallOnRecord(inSuite, cache, TxtResourceRecord(kTestOperationalName.Full(), entries));
+    }
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, nodeData.resolutionData.GetMrpRetryIntervalIdle() == MakeOptional(23_ms32));
+
+    // Records expire with their TTL
+    mockClock.AdvanceMonotonic(119_s);
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_NO_ERROR);
+    mockClock.AdvanceMonotonic(1_s);
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_ERROR_NOT_FOUND);
+}
+
+void TestGoodbyeAndFlush(nlTestSuite * inSuite, void * inContext)
+{
+    System::Clock::Internal::MockClock mockClock;
+    RecordCache cache(&mockClock);
+    ResolvedNodeData nodeData;
+
+    AddSrv(inSuite, cache, kTestOperationalName.Full(), kTestHostName.Full());
+    AddAddress(inSuite, cache, kTestHostName.Full(), "fe80::1");
+    AddAddress(inSuite, cache, kTestHostName.Full(), "fe80::2");
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, nodeData.resolutionData.numIPs == 2);
+
+    // A record with the cache-flush bit replaces the addresses received more than a second before
+    mockClock.AdvanceMonotonic(2_s);
+    AddAddress(inSuite, cache, kTestHostName.Full(), "fe80::3", 120, true /* cacheFlush */);
+    AddAddress(inSuite, cache, kTestHostName.Full(), "fe80::4", 120, true /* cacheFlush */);
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, nodeData.resolutionData.numIPs == 2);
+
+    Inet::IPAddress addr;
+    NL_TEST_ASSERT(inSuite, Inet::IPAddress::FromString("fe80::3", addr));
+    NL_TEST_ASSERT(inSuite, nodeData.resolutionData.ipAddress[0] == addr);
+
+    // Goodbye records remove the data
+    AddAddress(inSuite, cache, kTestHostName.Full(), "fe80::3", 0);
+    AddAddress(inSuite, cache, kTestHostName.Full(), "fe80::4", 0);
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_ERROR_NOT_FOUND);
+
+    AddAddress(inSuite, cache, kTestHostName.Full(), "fe80::5");
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_NO_ERROR);
+    AddSrv(inSuite, cache, kTestOperationalName.Full(), kTestHostName.Full(), 0);
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_ERROR_NOT_FOUND);
+}
+
+void TestBounded(nlTestSuite * inSuite, void * inContext)
+{
+    System::Clock::Internal::MockClock mockClock;
+    RecordCache cache(&mockClock);
+    ResolvedNodeData nodeData;
+
+    // Non-matter services are ignored
+    AddSrv(inSuite, cache, kNonMatterName.Full(), kOtherHostName.Full(), 4500);
+
+    AddSrv(inSuite, cache, kTestOperationalName.Full(), kTestHostName.Full(), 60);
+    AddAddress(inSuite, cache, kTestHostName.Full(), "fe80::1");
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_NO_ERROR);
+
+    // Filling the cache with longer lived services replaces the one which expires first
+    char names[RecordCache::kServiceCacheSize][Operational::kInstanceNameMaxLength + 1];
+    for (size_t i = 0; i < RecordCache::kServiceCacheSize; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "1234567898765432-%016X", static_cast<unsigned>(i + 1));
+        const char * instance[] = { names[i], "_matter", "_tcp", "local" };
+        AddSrv(inSuite, cache, FullQName(instance), kOtherHostName.Full(), 600);
+    }
+    NL_TEST_ASSERT(inSuite, cache.GetOperationalNode(kTestPeerId, nodeData) == CHIP_ERROR_NOT_FOUND);
+}
+
+/// Parses a built query and checks that each known answer decodes to the expected names.
+class KnownAnswerChecker : public ParserDelegate
+{
+public:
+    KnownAnswerChecker(nlTestSuite * inSuite, const BytesRange & packet) : mSuite(inSuite), mPacket(packet) {}
+
+    void OnHeader(ConstHeaderRef & header) override {}
+    void OnQuery(const QueryData & data) override {}
+
+    void OnResource(ResourceType type, const ResourceData & data) override
+    {
+        NL_TEST_ASSERT(mSuite, type == ResourceType::kAnswer);
+
+        if (data.GetType() == QType::TXT)
+        {
+            NL_TEST_ASSERT(mSuite, data.GetName() == kTestOperationalName.Full());
+            mTxtCount++;
+            return;
+        }
+
+        NL_TEST_ASSERT(mSuite, data.GetType() == QType::PTR);
+        NL_TEST_ASSERT(mSuite, data.GetName() == kOperationalService.Full());
+
+        SerializedQNameIterator instance;
+        NL_TEST_ASSERT(mSuite, ParsePtrRecord(data.GetData(), mPacket, &instance));
+        if (instance == kTestOperationalName.Full())
+        {
+            mTestPtrCount++;
+        }
+        else if (instance == kOtherOperationalName.Full())
+        {
+            mOtherPtrCount++;
+        }
+        else
+        {
+            NL_TEST_ASSERT(mSuite, false);
+        }
+    }
+
+    size_t mTxtCount      = 0;
+    size_t mTestPtrCount  = 0;
+    size_t mOtherPtrCount = 0;
+
+private:
+    nlTestSuite * mSuite;
+    BytesRange mPacket;
+};
+
+/// Builds a browse query for the operational service, as the resolver does, so that the
+/// known answers may be compressed against the query name.
+void StartBrowseQuery(nlTestSuite * inSuite, QueryBuilder & builder)
+{
+    builder.Reset(System::PacketBufferHandle::New(512));
+    builder.AddQuery(Query(kOperationalService.Full()).SetType(QType::PTR));
+    NL_TEST_ASSERT(inSuite, builder.Ok());
+}
+
+KnownAnswerChecker ParseKnownAnswers(nlTestSuite * inSuite, const System::PacketBufferHandle & packet)
+{
+    BytesRange range(packet->Start(), packet->Start() + packet->DataLength());
+    KnownAnswerChecker checker(inSuite, range);
+    NL_TEST_ASSERT(inSuite, ParsePacket(range, &checker));
+    return checker;
+}
+
+void TestKnownAnswers(nlTestSuite * inSuite, void * inContext)
+{
+    System::Clock::Internal::MockClock mockClock;
+    RecordCache cache(&mockClock);
+
+    AddSrv(inSuite, cache, kTestOperationalName.Full(), kTestHostName.Full());
+    AddSrv(inSuite, cache, kOtherOperationalName.Full(), kTestHostName.Full());
+    {
+        const char * entries[] = { "SII=23", "SAI=42" };
+        CallOnRecord(inSuite, cache, TxtResourceRecord(kTestOperationalName.Full(), entries).SetTtl(100));
+    }
+    CallOnRecord(inSuite, cache, PtrResourceRecord(kOperationalService.Full(), kTestOperationalName.Full()).SetTtl(100));
+    mockClock.AdvanceMonotonic(10_s);
+    CallOnRecord(inSuite, cache, PtrResourceRecord(kOperationalService.Full(), kOtherOperationalName.Full()).SetTtl(100));
+
+    QueryBuilder builder;
+    {
+        StartBrowseQuery(inSuite, builder);
+        cache.AddKnownTxtAnswer(builder, kTestOperationalName.Full());
+        cache.AddKnownTxtAnswer(builder, kOtherOperationalName.Full());
+        NL_TEST_ASSERT(inSuite, builder.Ok());
+        NL_TEST_ASSERT(inSuite, builder.Header().GetAnswerCount() == 1);
+
+        System::PacketBufferHandle packet = builder.ReleasePacket();
+        KnownAnswerChecker checker        = ParseKnownAnswers(inSuite, packet);
+        NL_TEST_ASSERT(inSuite, checker.mTxtCount == 1);
+    }
+
+    {
+        // Only the PTR records received since the given time are listed
+        StartBrowseQuery(inSuite, builder);
+        cache.AddKnownPtrAnswers(builder, kOperationalService.Full(), mockClock.GetMonotonicTimestamp());
+        NL_TEST_ASSERT(inSuite, builder.Header().GetAnswerCount() == 1);
+
+        System::PacketBufferHandle packet = builder.ReleasePacket();
+        KnownAnswerChecker checker        = ParseKnownAnswers(inSuite, packet);
+        NL_TEST_ASSERT(inSuite, checker.mTestPtrCount == 0 && checker.mOtherPtrCount == 1);
+    }
+
+    {
+        // The names of the known answers are compressed against each other and against the query: they must decode
+        // from offsets counted from the start of the message.
+        StartBrowseQuery(inSuite, builder);
+        cache.AddKnownPtrAnswers(builder, kOperationalService.Full(), System::Clock::kZero);
+        NL_TEST_ASSERT(inSuite, builder.Header().GetAnswerCount() == 2);
+
+        System::PacketBufferHandle packet = builder.ReleasePacket();
+        KnownAnswerChecker checker        = ParseKnownAnswers(inSuite, packet);
+        NL_TEST_ASSERT(inSuite, checker.mTestPtrCount == 1 && checker.mOtherPtrCount == 1);
+    }
+
+    // Records past half their TTL are not known answers anymore
+    mockClock.AdvanceMonotonic(45_s);
+    {
+        StartBrowseQuery(inSuite, builder);
+        cache.AddKnownTxtAnswer(builder, kTestOperationalName.Full());
+        cache.AddKnownPtrAnswers(builder, kOperationalService.Full(), System::Clock::kZero);
+        NL_TEST_ASSERT(inSuite, builder.Header().GetAnswerCount() == 1);
+
+        System::PacketBufferHandle packet = builder.ReleasePacket();
+        KnownAnswerChecker checker        = ParseKnownAnswers(inSuite, packet);
+        NL_TEST_ASSERT(inSuite, checker.mTxtCount == 0 && checker.mOtherPtrCount == 1);
+    }
+}
+
+int Setup(void * inContext)
+{
+    return (Platform::MemoryInit() == CHIP_NO_ERROR) ? SUCCESS : FAILURE;
+}
+
+int Teardown(void * inContext)
+{
+    Platform::MemoryShutdown();
+    return SUCCESS;
+}
+
+const nlTest sTests[] = {
+    NL_TEST_DEF("TestOperationalResolve", TestOperationalResolve), //
+    NL_TEST_DEF("TestGoodbyeAndFlush", TestGoodbyeAndFlush),       //
+    NL_TEST_DEF("TestBounded", TestBounded),                       //
+    NL_TEST_DEF("TestKnownAnswers", TestKnownAnswers),             //
+    NL_TEST_SENTINEL()                                             //
+};
+
+} // namespace
+
+int TestRecordCache(void)
+{
+    nlTestSuite theSuite = { "RecordCache", sTests, &Setup, &Teardown };
+    nlTestRunner(&theSuite, nullptr);
+    return nlTestRunnerStats(&theSuite);
+}
+
+CHIP_REGISTER_TEST_SUITE(TestRecordCache)
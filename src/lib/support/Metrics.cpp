@@ -0,0 +1,185 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <lib/support/Metrics.h>
+
+#include <lib/support/CodeUtils.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace chip {
+namespace Metrics {
+
+namespace {
+
+const Metric * gFirstMetric = nullptr;
+
+void PutUnsigned(Encoding::BufferWriter & writer, uint64_t value)
+{
+    char text[21];
+    snprintf(text, sizeof(text), "%" PRIu64, value);
+    writer.Put(text);
+}
+
+void PutSigned(Encoding::BufferWriter & writer, int64_t value)
+{
+    char text[21];
+    snprintf(text, sizeof(text), "%" PRId64, value);
+    writer.Put(text);
+}
+
+const char * TypeName(Metric::Type type)
+{
+    switch (type)
+    {
+    case Metric::Type::kCounter:
+        return "counter";
+    case Metric::Type::kGauge:
+        return "gauge";
+    case Metric::Type::kHistogram:
+        return "histogram";
+    }
+    return "untyped";
+}
+
+// Write the labels of [metric] between braces, followed by [extra] if not nullptr, e.g. {pool="exchanges",le="10"}
+void PutLabels(Encoding::BufferWriter & writer, const Metric & metric, const char * extra = nullptr)
+{
+    VerifyOrReturn(metric.GetLabels() != nullptr || extra != nullptr);
+    writer.Put('{');
+    if (metric.GetLabels() != nullptr)
+    {
+        writer.Put(metric.GetLabels());
+    }
+    if (extra != nullptr)
+    {
+        writer.Put(metric.GetLabels() != nullptr ? "," : "").Put(extra);
+    }
+    writer.Put('}');
+}
+
+void WriteHistogram(Encoding::BufferWriter & writer, const HistogramBase & histogram)
+{
+    // Prometheus buckets are cumulative: each counts the values up to its bound.
+    uint64_t count = 0;
+    for (size_t i = 0; i <= histogram.GetBoundCount(); i++)
+    {
+        count += histogram.GetBucket(i);
+        char bound[28] = "le=\"+Inf\"";
+        if (i < histogram.GetBoundCount())
+        {
+            snprintf(bound, sizeof(bound), "le=\"%" PRIu64 "\"", histogram.GetBound(i));
+        }
+        writer.Put(histogram.GetName()).Put("_bucket");
+        PutLabels(writer, histogram, bound);
+        writer.Put(' ');
+        PutUnsigned(writer, count);
+        writer.Put('\n');
+    }
+
+    writer.Put(histogram.GetName()).Put("_sum");
+    PutLabels(writer, histogram);
+    writer.Put(' ');
+    PutUnsigned(writer, histogram.GetSum());
+    writer.Put('\n');
+    writer.Put(histogram.GetName()).Put("_count");
+    PutLabels(writer, histogram);
+    writer.Put(' ');
+    PutUnsigned(writer, count);
+    writer.Put('\n');
+}
+
+void WriteSample(Encoding::BufferWriter & writer, const Metric & metric)
+{
+    switch (metric.GetType())
+    {
+    case Metric::Type::kCounter:
+        writer.Put(metric.GetName());
+        PutLabels(writer, metric);
+        writer.Put(' ');
+        PutUnsigned(writer, static_cast<const Counter &>(metric).Get());
+        writer.Put('\n');
+        break;
+    case Metric::Type::kGauge:
+        writer.Put(metric.GetName());
+        PutLabels(writer, metric);
+        writer.Put(' ');
+        PutSigned(writer, static_cast<const Gauge &>(metric).Get());
+        writer.Put('\n');
+        break;
+    case Metric::Type::kHistogram:
+        WriteHistogram(writer, static_cast<const HistogramBase &>(metric));
+        break;
+    }
+}
+
+bool SameFamily(const Metric & a, const Metric & b)
+{
+    return strcmp(a.GetName(), b.GetName()) == 0;
+}
+
+} // namespace
+
+Registration::Registration(Metric & metric)
+{
+    metric.mNext = gFirstMetric;
+    gFirstMetric = &metric;
+}
+
+Registration::Registration(PoolMetrics & metrics)
+{
+    Registration allocations(metrics.mAllocations);
+    Registration exhaustions(metrics.mExhaustions);
+    Registration objectsInUse(metrics.mObjectsInUse);
+}
+
+const Metric * GetFirstMetric()
+{
+    return gFirstMetric;
+}
+
+void WritePrometheusText(Encoding::BufferWriter & writer)
+{
+    // The samples of a family are written together, under the first metric of the family
+    for (const Metric * metric = gFirstMetric; metric != nullptr; metric = metric->GetNext())
+    {
+        const Metric * previous = gFirstMetric;
+        while (previous != metric && !SameFamily(*previous, *metric))
+        {
+            previous = previous->GetNext();
+        }
+        if (previous != metric)
+        {
+            continue;
+        }
+
+        writer.Put("# HELP ").Put(metric->GetName()).Put(' ').Put(metric->GetHelp()).Put('\n');
+        writer.Put("# TYPE ").Put(metric->GetName()).Put(' ').Put(TypeName(metric->GetType())).Put('\n');
+        for (const Metric * sample = metric; sample != nullptr; sample = sample->GetNext())
+        {
+            if (SameFamily(*sample, *metric))
+            {
+                WriteSample(writer, *sample);
+            }
+        }
+    }
+}
+
+} // namespace Metrics
+} // namespace chip
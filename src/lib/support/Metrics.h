@@ -0,0 +1,267 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      A registry of runtime metrics: counters, gauges and fixed-bucket
+ *      histograms, enabled by the chip_enable_metrics build argument.
+ *
+ *      Metrics are defined at namespace scope, in the file which records them:
+ *
+ *          CHIP_METRIC_COUNTER(gRetransmissions, "chip_mrp_retransmissions_total", "Messages retransmitted by MRP");
+ *          CHIP_METRIC_HISTOGRAM(gReportTime, "chip_im_report_build_time_us", "Time to build a report", 100, 1000, 10000);
+ *          ...
+ *          CHIP_METRIC_INCREMENT(gRetransmissions);
+ *          CHIP_METRIC_RECORD(gReportTime, elapsedUs);
+ *
+ *      Metrics sharing a name are written as one family, told apart by their
+ *      labels: e.g. each object pool given its own PoolMetrics by
+ *      CHIP_METRIC_POOL is labeled with the name of the pool.
+ *
+ *      Metric objects are constant-initialized, so they can be recorded from any
+ *      static initializer, and each update is a single relaxed atomic operation.
+ *      When metrics are disabled, the macros expand to nothing and their
+ *      arguments are not evaluated.
+ */
+
+#pragma once
+
+#include <lib/core/CHIPConfig.h>
+#include <lib/support/BufferWriter.h>
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace chip {
+namespace Metrics {
+
+class Metric
+{
+public:
+    enum class Type : uint8_t
+    {
+        kCounter,
+        kGauge,
+        kHistogram,
+    };
+
+    const char * GetName() const { return mName; }
+    const char * GetHelp() const { return mHelp; }
+    Type GetType() const { return mType; }
+
+    /// Labels of the metric in the Prometheus syntax, e.g. `pool="exchanges"`, nullptr if it has none.
+    const char * GetLabels() const { return mLabels; }
+
+    /// The next registered metric, nullptr for the last one.
+    const Metric * GetNext() const { return mNext; }
+
+protected:
+    constexpr Metric(const char * name, const char * help, Type type, const char * labels) :
+        mName(name), mHelp(help), mLabels(labels), mType(type)
+    {}
+
+private:
+    friend class Registration;
+
+    const char * const mName;
+    const char * const mHelp;
+    const char * const mLabels;
+    const Type mType;
+    const Metric * mNext = nullptr;
+};
+
+/// A value which only goes up, like a number of events.
+class Counter : public Metric
+{
+public:
+    constexpr Counter(const char * name, const char * help, const char * labels = nullptr) :
+        Metric(name, help, Type::kCounter, labels)
+    {}
+
+    void Increment(uint64_t amount = 1) { mValue.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t Get() const { return mValue.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> mValue{ 0 };
+};
+
+/// A value which goes up and down, like the depth of a queue.
+class Gauge : public Metric
+{
+public:
+    constexpr Gauge(const char * name, const char * help, const char * labels = nullptr) : Metric(name, help, Type::kGauge, labels)
+    {}
+
+    void Set(int64_t value) { mValue.store(value, std::memory_order_relaxed); }
+    void Increment(int64_t amount = 1) { mValue.fetch_add(amount, std::memory_order_relaxed); }
+    void Decrement(int64_t amount = 1) { mValue.fetch_sub(amount, std::memory_order_relaxed); }
+    int64_t Get() const { return mValue.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> mValue{ 0 };
+};
+
+/**
+ * The distribution of a value, like a latency, in buckets with fixed upper
+ * bounds. Values above the last bound go into an overflow bucket.
+ */
+class HistogramBase : public Metric
+{
+public:
+    void Record(uint64_t value)
+    {
+        size_t bucket = 0;
+        while (bucket < mBoundCount && value > mBounds[bucket])
+        {
+            bucket++;
+        }
+        mBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        mSum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    size_t GetBoundCount() const { return mBoundCount; }
+    uint64_t GetBound(size_t index) const { return mBounds[index]; }
+
+    /// Number of values recorded in a bucket; the bucket at GetBoundCount() is the overflow bucket.
+    uint64_t GetBucket(size_t index) const { return mBuckets[index].load(std::memory_order_relaxed); }
+    uint64_t GetSum() const { return mSum.load(std::memory_order_relaxed); }
+
+protected:
+    constexpr HistogramBase(const char * name, const char * help, const uint64_t * bounds, size_t boundCount,
+                            std::atomic<uint64_t> * buckets) :
+        Metric(name, help, Type::kHistogram, nullptr),
+        mBounds(bounds), mBoundCount(boundCount), mBuckets(buckets)
+    {}
+
+private:
+    const uint64_t * const mBounds;
+    const size_t mBoundCount;
+    std::atomic<uint64_t> * const mBuckets;
+    std::atomic<uint64_t> mSum{ 0 };
+};
+
+template <size_t kBoundCount>
+class Histogram : public HistogramBase
+{
+public:
+    /// [bounds] are in increasing order, and must outlive the histogram.
+    constexpr Histogram(const char * name, const char * help, const uint64_t (&bounds)[kBoundCount]) :
+        HistogramBase(name, help, bounds, kBoundCount, mStorage)
+    {}
+
+private:
+    std::atomic<uint64_t> mStorage[kBoundCount + 1] = {};
+};
+
+/**
+ * The metrics of an object pool (lib/support/Pool.h), labeled with the name
+ * of the pool. Pools not given their own count under the "other" pool.
+ */
+class PoolMetrics
+{
+public:
+    constexpr explicit PoolMetrics(const char * labels) :
+        mAllocations("chip_pool_allocations_total", "Objects allocated from object pools", labels),
+        mExhaustions("chip_pool_exhaustions_total", "Object pool allocations which failed", labels),
+        mObjectsInUse("chip_pool_objects_in_use", "Objects allocated from object pools and not released", labels)
+    {}
+
+    Counter mAllocations;
+    Counter mExhaustions;
+    Gauge mObjectsInUse;
+};
+
+/**
+ * Adds a metric to the registry. Registrations are static objects: metrics
+ * must be registered before other threads export them.
+ */
+class Registration
+{
+public:
+    explicit Registration(Metric & metric);
+    explicit Registration(PoolMetrics & metrics);
+};
+
+/// The first metric in the registry, nullptr if there is none.
+const Metric * GetFirstMetric();
+
+/**
+ * Write all the registered metrics in the Prometheus text exposition format.
+ * The writer tells how many bytes were needed if they did not fit.
+ */
+void WritePrometheusText(Encoding::BufferWriter & writer);
+
+} // namespace Metrics
+} // namespace chip
+
+#if CHIP_CONFIG_ENABLE_METRICS
+
+#define CHIP_METRIC_COUNTER(variable, name, help)                                                                                  \
+    ::chip::Metrics::Counter variable{ name, help };                                                                               \
+    static ::chip::Metrics::Registration variable##Registration { variable }
+
+#define CHIP_METRIC_GAUGE(variable, name, help)                                                                                    \
+    ::chip::Metrics::Gauge variable{ name, help };                                                                                 \
+    static ::chip::Metrics::Registration variable##Registration { variable }
+
+/// The variadic arguments are the upper bounds of the buckets, in increasing order.
+#define CHIP_METRIC_HISTOGRAM(variable, name, help, ...)                                                                           \
+    static constexpr uint64_t variable##Bounds[] = { __VA_ARGS__ };                                                                \
+    ::chip::Metrics::Histogram<sizeof(variable##Bounds) / sizeof(uint64_t)> variable{ name, help, variable##Bounds };              \
+    static ::chip::Metrics::Registration variable##Registration { variable }
+
+/// The metrics of the object pools given them with CHIP_METRIC_POOL_ATTACH, labeled pool="<pool>".
+#define CHIP_METRIC_POOL(variable, pool)                                                                                           \
+    ::chip::Metrics::PoolMetrics variable{ "pool=\"" pool "\"" };                                                                  \
+    static ::chip::Metrics::Registration variable##Registration { variable }
+
+/// Declare metrics defined in another file.
+#define CHIP_METRIC_DECLARE_COUNTER(variable) extern ::chip::Metrics::Counter variable
+#define CHIP_METRIC_DECLARE_GAUGE(variable) extern ::chip::Metrics::Gauge variable
+#define CHIP_METRIC_DECLARE_POOL(variable) extern ::chip::Metrics::PoolMetrics variable
+
+#define CHIP_METRIC_INCREMENT(counter) (counter).Increment()
+#define CHIP_METRIC_ADD(counter, amount) (counter).Increment(amount)
+#define CHIP_METRIC_GAUGE_SET(gauge, value) (gauge).Set(static_cast<int64_t>(value))
+#define CHIP_METRIC_GAUGE_INCREMENT(gauge) (gauge).Increment()
+#define CHIP_METRIC_GAUGE_DECREMENT(gauge) (gauge).Decrement()
+#define CHIP_METRIC_GAUGE_SUBTRACT(gauge, amount) (gauge).Decrement(static_cast<int64_t>(amount))
+#define CHIP_METRIC_RECORD(histogram, value) (histogram).Record(static_cast<uint64_t>(value))
+/// Count the objects of an object pool in [metrics]; called before the pool allocates any.
+#define CHIP_METRIC_POOL_ATTACH(objectPool, metrics) (objectPool).SetMetrics(metrics)
+
+#else // CHIP_CONFIG_ENABLE_METRICS
+
+#define CHIP_METRIC_COUNTER(variable, name, help) static_assert(true, "")
+#define CHIP_METRIC_GAUGE(variable, name, help) static_assert(true, "")
+#define CHIP_METRIC_HISTOGRAM(variable, name, help, ...) static_assert(true, "")
+#define CHIP_METRIC_DECLARE_COUNTER(variable) static_assert(true, "")
+#define CHIP_METRIC_DECLARE_GAUGE(variable) static_assert(true, "")
+#define CHIP_METRIC_POOL(variable, pool) static_assert(true, "")
+#define CHIP_METRIC_DECLARE_POOL(variable) static_assert(true, "")
+
+#define CHIP_METRIC_INCREMENT(counter) ((void) 0)
+#define CHIP_METRIC_ADD(counter, amount) ((void) 0)
+#define CHIP_METRIC_GAUGE_SET(gauge, value) ((void) 0)
+#define CHIP_METRIC_GAUGE_INCREMENT(gauge) ((void) 0)
+#define CHIP_METRIC_GAUGE_DECREMENT(gauge) ((void) 0)
+#define CHIP_METRIC_GAUGE_SUBTRACT(gauge, amount) ((void) 0)
+#define CHIP_METRIC_RECORD(histogram, value) ((void) 0)
+#define CHIP_METRIC_POOL_ATTACH(objectPool, metrics) ((void) 0)
+
+#endif // CHIP_CONFIG_ENABLE_METRICS
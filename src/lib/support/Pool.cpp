@@ -24,6 +24,8 @@ namespace chip {
 
 namespace internal {
 
+CHIP_METRIC_POOL(gOtherPoolMetrics, "other");
+
 StaticAllocatorBitmap::StaticAllocatorBitmap(void * storage, std::atomic<tBitChunkType> * usage, size_t capacity,
                                              size_t elementSize) :
     StaticAllocatorBase(capacity),
@@ -55,6 +57,7 @@ void * StaticAllocatorBitmap::Allocate()
             }
         }
     }
+    CHIP_METRIC_INCREMENT(mMetrics->mExhaustions);
     return nullptr;
 }
 
@@ -24,6 +24,7 @@
 
 #include <lib/support/CHIPMem.h>
 #include <lib/support/CodeUtils.h>
+#include <lib/support/Metrics.h>
 #include <system/SystemConfig.h>
 
 #include <lib/support/Iterators.h>
@@ -38,6 +39,9 @@ namespace chip {
 
 namespace internal {
 
+// Metrics of the object pools not given their own, defined in Pool.cpp
+CHIP_METRIC_DECLARE_POOL(gOtherPoolMetrics);
+
 class Statistics
 {
 public:
@@ -51,12 +55,26 @@ public:
         {
             mHighWaterMark = mAllocated;
         }
+        CHIP_METRIC_INCREMENT(mMetrics->mAllocations);
+        CHIP_METRIC_GAUGE_INCREMENT(mMetrics->mObjectsInUse);
+    }
+    void DecreaseUsage()
+    {
+        --mAllocated;
+        CHIP_METRIC_GAUGE_DECREMENT(mMetrics->mObjectsInUse);
     }
-    void DecreaseUsage() { --mAllocated; }
+
+#if CHIP_CONFIG_ENABLE_METRICS
+    /// Use CHIP_METRIC_POOL_ATTACH, before the pool allocates any object.
+    void SetMetrics(Metrics::PoolMetrics & metrics) { mMetrics = &metrics; }
+#endif // CHIP_CONFIG_ENABLE_METRICS
 
 protected:
     size_t mAllocated;
     size_t mHighWaterMark;
+#if CHIP_CONFIG_ENABLE_METRICS
+    Metrics::PoolMetrics * mMetrics = &gOtherPoolMetrics;
+#endif // CHIP_CONFIG_ENABLE_METRICS
 };
 
 class StaticAllocatorBase : public Statistics
@@ -334,6 +352,7 @@ public:
                 return object;
             }
         }
+        CHIP_METRIC_INCREMENT(mMetrics->mExhaustions);
         return nullptr;
     }
 
@@ -0,0 +1,587 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <lib/support/Base64.h>
+#include <lib/support/ScopedBuffer.h>
+#include <lib/support/jsontlv/JsonReader.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace chip {
+
+namespace {
+
+// Longer numbers cannot be represented by a double more precisely anyway.
+constexpr size_t kMaxNumberLength = 64;
+
+bool IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool ParseHexDigit(char c, uint16_t & aValue)
+{
+    if (c >= '0' && c <= '9')
+    {
+        aValue = static_cast<uint16_t>((aValue << 4) | (c - '0'));
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+        aValue = static_cast<uint16_t>((aValue << 4) | (c - 'a' + 10));
+    }
+    else if (c >= 'A' && c <= 'F')
+    {
+        aValue = static_cast<uint16_t>((aValue << 4) | (c - 'A' + 10));
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool ParseHex4(const char * aText, uint16_t & aValue)
+{
+    aValue = 0;
+    for (size_t i = 0; i < 4; i++)
+    {
+        VerifyOrReturnValue(ParseHexDigit(aText[i], aValue), false);
+    }
+    return true;
+}
+
+size_t EncodeUtf8(uint32_t aCodePoint, char * aOut)
+{
+    if (aCodePoint < 0x80)
+    {
+        aOut[0] = static_cast<char>(aCodePoint);
+        return 1;
+    }
+    if (aCodePoint < 0x800)
+    {
+        aOut[0] = static_cast<char>(0xC0 | (aCodePoint >> 6));
+        aOut[1] = static_cast<char>(0x80 | (aCodePoint & 0x3F));
+        return 2;
+    }
+    if (aCodePoint < 0x10000)
+    {
+        aOut[0] = static_cast<char>(0xE0 | (aCodePoint >> 12));
+        aOut[1] = static_cast<char>(0x80 | ((aCodePoint >> 6) & 0x3F));
+        aOut[2] = static_cast<char>(0x80 | (aCodePoint & 0x3F));
+        return 3;
+    }
+    aOut[0] = static_cast<char>(0xF0 | (aCodePoint >> 18));
+    aOut[1] = static_cast<char>(0x80 | ((aCodePoint >> 12) & 0x3F));
+    aOut[2] = static_cast<char>(0x80 | ((aCodePoint >> 6) & 0x3F));
+    aOut[3] = static_cast<char>(0x80 | (aCodePoint & 0x3F));
+    return 4;
+}
+
+/*
+ * Unescape the contents of a JSON string into aOut, which must be at least as large as aIn. An escaped code
+ * point never takes more bytes in UTF-8 than its escape sequence, so the output cannot overflow.
+ */
+CHIP_ERROR Unescape(const CharSpan & aIn, char * aOut, size_t & aOutLength)
+{
+    const char * in  = aIn.data();
+    const char * end = in + aIn.size();
+    char * out       = aOut;
+
+    while (in < end)
+    {
+        if (*in != '\\')
+        {
+            *out++ = *in++;
+            continue;
+        }
+
+        // ScanString() already checked that escape sequences are complete.
+        in++;
+        switch (*in++)
+        {
+        case '"':
+            *out++ = '"';
+            break;
+        case '\\':
+            *out++ = '\\';
+            break;
+        case '/':
+            *out++ = '/';
+            break;
+        case 'b':
+            *out++ = '\b';
+            break;
+        case 'f':
+            *out++ = '\f';
+            break;
+        case 'n':
+            *out++ = '\n';
+            break;
+        case 'r':
+            *out++ = '\r';
+            break;
+        case 't':
+            *out++ = '\t';
+            break;
+        case 'u': {
+            uint16_t unit;
+            VerifyOrReturnError(ParseHex4(in, unit), CHIP_ERROR_INVALID_ARGUMENT);
+            in += 4;
+
+            uint32_t codePoint = unit;
+            if (unit >= 0xD800 && unit <= 0xDBFF)
+            {
+                // A high surrogate must be followed by an escaped low surrogate.
+                uint16_t low;
+                VerifyOrReturnError(end - in >= 6 && in[0] == '\\' && in[1] == 'u', CHIP_ERROR_INVALID_ARGUMENT);
+                VerifyOrReturnError(ParseHex4(in + 2, low) && low >= 0xDC00 && low <= 0xDFFF, CHIP_ERROR_INVALID_ARGUMENT);
+                in += 6;
+                codePoint = 0x10000 + ((static_cast<uint32_t>(unit - 0xD800) << 10) | static_cast<uint32_t>(low - 0xDC00));
+            }
+            else
+            {
+                VerifyOrReturnError(unit < 0xDC00 || unit > 0xDFFF, CHIP_ERROR_INVALID_ARGUMENT);
+            }
+            out += EncodeUtf8(codePoint, out);
+            break;
+        }
+        default:
+            return CHIP_ERROR_INVALID_ARGUMENT;
+        }
+    }
+
+    aOutLength = static_cast<size_t>(out - aOut);
+    return CHIP_NO_ERROR;
+}
+
+} // namespace
+
+void JsonReader::Init(const CharSpan & aJson)
+{
+    mJson             = aJson;
+    mPos              = 0;
+    mType             = Type::kNotSpecified;
+    mKey              = CharSpan();
+    mValue            = CharSpan();
+    mValueHasEscapes  = false;
+    mDepth            = 0;
+    mFirstInContainer = true;
+    mRootRead         = false;
+}
+
+void JsonReader::SkipWhitespace()
+{
+    while (!IsAtEnd())
+    {
+        char c = Peek();
+        VerifyOrReturn(c == ' ' || c == '\t' || c == '\n' || c == '\r');
+        mPos++;
+    }
+}
+
+CHIP_ERROR JsonReader::Next()
+{
+    // A container that was not entered is skipped as a whole.
+    if (mType == Type::kObject || mType == Type::kArray)
+    {
+        ReturnErrorOnFailure(SkipContainer());
+    }
+    mType  = Type::kNotSpecified;
+    mKey   = CharSpan();
+    mValue = CharSpan();
+
+    SkipWhitespace();
+
+    if (mDepth == 0)
+    {
+        if (mRootRead)
+        {
+            VerifyOrReturnError(IsAtEnd(), CHIP_ERROR_INVALID_ARGUMENT);
+            return CHIP_END_OF_INPUT;
+        }
+        mRootRead = true;
+        return ReadValue();
+    }
+
+    VerifyOrReturnError(!IsAtEnd(), CHIP_ERROR_INVALID_ARGUMENT);
+
+    const bool inObject = (mContainers[mDepth - 1] == Type::kObject);
+    if (Peek() == (inObject ? '}' : ']'))
+    {
+        // The closing character is consumed by ExitContainer().
+        return CHIP_END_OF_INPUT;
+    }
+
+    if (!mFirstInContainer)
+    {
+        VerifyOrReturnError(Peek() == ',', CHIP_ERROR_INVALID_ARGUMENT);
+        mPos++;
+        SkipWhitespace();
+        VerifyOrReturnError(!IsAtEnd(), CHIP_ERROR_INVALID_ARGUMENT);
+    }
+    mFirstInContainer = false;
+
+    if (inObject)
+    {
+        bool keyHasEscapes;
+        VerifyOrReturnError(Peek() == '"', CHIP_ERROR_INVALID_ARGUMENT);
+        ReturnErrorOnFailure(ScanString(mKey, keyHasEscapes));
+        SkipWhitespace();
+        VerifyOrReturnError(!IsAtEnd() && Peek() == ':', CHIP_ERROR_INVALID_ARGUMENT);
+        mPos++;
+        SkipWhitespace();
+    }
+
+    return ReadValue();
+}
+
+CHIP_ERROR JsonReader::ReadValue()
+{
+    VerifyOrReturnError(!IsAtEnd(), CHIP_ERROR_INVALID_ARGUMENT);
+
+    char c = Peek();
+    switch (c)
+    {
+    case '{':
+        mType = Type::kObject;
+        return CHIP_NO_ERROR;
+    case '[':
+        mType = Type::kArray;
+        return CHIP_NO_ERROR;
+    case '"':
+        ReturnErrorOnFailure(ScanString(mValue, mValueHasEscapes));
+        mType = Type::kString;
+        return CHIP_NO_ERROR;
+    case 't':
+        ReturnErrorOnFailure(ScanLiteral("true"));
+        mType = Type::kBoolean;
+        return CHIP_NO_ERROR;
+    case 'f':
+        ReturnErrorOnFailure(ScanLiteral("false"));
+        mType = Type::kBoolean;
+        return CHIP_NO_ERROR;
+    case 'n':
+        ReturnErrorOnFailure(ScanLiteral("null"));
+        mType = Type::kNull;
+        return CHIP_NO_ERROR;
+    default:
+        VerifyOrReturnError(c == '-' || IsDigit(c), CHIP_ERROR_INVALID_ARGUMENT);
+        return ScanNumber();
+    }
+}
+
+CHIP_ERROR JsonReader::ScanString(CharSpan & aContents, bool & aHasEscapes)
+{
+    // Skip the opening quote.
+    size_t start = ++mPos;
+
+    aHasEscapes = false;
+    while (!IsAtEnd())
+    {
+        char c = Peek();
+        if (c == '"')
+        {
+            aContents = mJson.SubSpan(start, mPos - start);
+            mPos++;
+            return CHIP_NO_ERROR;
+        }
+
+        VerifyOrReturnError(static_cast<unsigned char>(c) >= 0x20, CHIP_ERROR_INVALID_ARGUMENT);
+        if (c == '\\')
+        {
+            aHasEscapes = true;
+            mPos++;
+            VerifyOrReturnError(!IsAtEnd(), CHIP_ERROR_INVALID_ARGUMENT);
+            if (Peek() == 'u')
+            {
+                uint16_t unit;
+                VerifyOrReturnError(mJson.size() - mPos > 4, CHIP_ERROR_INVALID_ARGUMENT);
+                VerifyOrReturnError(ParseHex4(mJson.data() + mPos + 1, unit), CHIP_ERROR_INVALID_ARGUMENT);
+                mPos += 4;
+            }
+            else
+            {
+                VerifyOrReturnError(strchr("\"\\/bfnrt", Peek()) != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+            }
+        }
+        mPos++;
+    }
+
+    return CHIP_ERROR_INVALID_ARGUMENT;
+}
+
+CHIP_ERROR JsonReader::ScanNumber()
+{
+    size_t start  = mPos;
+    bool negative = false;
+    bool isFloat  = false;
+
+    auto skipDigits = [this]() {
+        size_t digitsStart = mPos;
+        while (!IsAtEnd() && IsDigit(Peek()))
+        {
+            mPos++;
+        }
+        return mPos - digitsStart;
+    };
+
+    if (Peek() == '-')
+    {
+        negative = true;
+        mPos++;
+    }
+
+    // Leading zeros are not allowed.
+    VerifyOrReturnError(!IsAtEnd() && IsDigit(Peek()), CHIP_ERROR_INVALID_ARGUMENT);
+    if (Peek() == '0')
+    {
+        mPos++;
+    }
+    else
+    {
+        skipDigits();
+    }
+
+    if (!IsAtEnd() && Peek() == '.')
+    {
+        isFloat = true;
+        mPos++;
+        VerifyOrReturnError(skipDigits() > 0, CHIP_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (!IsAtEnd() && (Peek() == 'e' || Peek() == 'E'))
+    {
+        isFloat = true;
+        mPos++;
+        if (!IsAtEnd() && (Peek() == '+' || Peek() == '-'))
+        {
+            mPos++;
+        }
+        VerifyOrReturnError(skipDigits() > 0, CHIP_ERROR_INVALID_ARGUMENT);
+    }
+
+    mValue = mJson.SubSpan(start, mPos - start);
+    if (isFloat)
+    {
+        mType = Type::kFloatingPointNumber;
+    }
+    else
+    {
+        mType = negative ? Type::kSignedInteger : Type::kUnsignedInteger;
+    }
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonReader::ScanLiteral(const char * aLiteral)
+{
+    size_t length = strlen(aLiteral);
+    VerifyOrReturnError(mJson.size() - mPos >= length, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(memcmp(mJson.data() + mPos, aLiteral, length) == 0, CHIP_ERROR_INVALID_ARGUMENT);
+
+    mValue = mJson.SubSpan(mPos, length);
+    mPos += length;
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonReader::SkipContainer()
+{
+    // Only balance the brackets: the contents of a skipped container are not validated, as TLVReader does not validate
+    // skipped elements either. Strings still need to be scanned so that brackets within them are ignored.
+    size_t depth = 0;
+    while (!IsAtEnd())
+    {
+        char c = Peek();
+        if (c == '"')
+        {
+            CharSpan contents;
+            bool hasEscapes;
+            ReturnErrorOnFailure(ScanString(contents, hasEscapes));
+            continue;
+        }
+
+        mPos++;
+        if (c == '{' || c == '[')
+        {
+            depth++;
+        }
+        else if (c == '}' || c == ']')
+        {
+            VerifyOrReturnError(depth > 0, CHIP_ERROR_INVALID_ARGUMENT);
+            if (--depth == 0)
+            {
+                return CHIP_NO_ERROR;
+            }
+        }
+    }
+
+    return CHIP_ERROR_INVALID_ARGUMENT;
+}
+
+CHIP_ERROR JsonReader::Get(bool & aValue) const
+{
+    VerifyOrReturnError(mType == Type::kBoolean, CHIP_ERROR_WRONG_TLV_TYPE);
+    aValue = (mValue.data()[0] == 't');
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonReader::Get(uint64_t & aValue) const
+{
+    VerifyOrReturnError(mType == Type::kUnsignedInteger, CHIP_ERROR_WRONG_TLV_TYPE);
+
+    uint64_t value = 0;
+    for (char c : mValue)
+    {
+        uint64_t digit = static_cast<uint64_t>(c - '0');
+        VerifyOrReturnError(value <= (UINT64_MAX - digit) / 10, CHIP_ERROR_INVALID_INTEGER_VALUE);
+        value = value * 10 + digit;
+    }
+    aValue = value;
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonReader::Get(int64_t & aValue) const
+{
+    VerifyOrReturnError(mType == Type::kSignedInteger || mType == Type::kUnsignedInteger, CHIP_ERROR_WRONG_TLV_TYPE);
+
+    // Accumulate the magnitude as unsigned so that INT64_MIN can be represented.
+    const bool negative = (mType == Type::kSignedInteger);
+    uint64_t magnitude  = 0;
+    for (char c : mValue.SubSpan(negative ? 1 : 0))
+    {
+        uint64_t digit = static_cast<uint64_t>(c - '0');
+        VerifyOrReturnError(magnitude <= (UINT64_MAX - digit) / 10, CHIP_ERROR_INVALID_INTEGER_VALUE);
+        magnitude = magnitude * 10 + digit;
+    }
+
+    if (negative)
+    {
+        VerifyOrReturnError(magnitude <= static_cast<uint64_t>(INT64_MAX) + 1, CHIP_ERROR_INVALID_INTEGER_VALUE);
+        aValue = (magnitude == static_cast<uint64_t>(INT64_MAX) + 1) ? INT64_MIN : -static_cast<int64_t>(magnitude);
+    }
+    else
+    {
+        VerifyOrReturnError(magnitude <= static_cast<uint64_t>(INT64_MAX), CHIP_ERROR_INVALID_INTEGER_VALUE);
+        aValue = static_cast<int64_t>(magnitude);
+    }
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonReader::Get(double & aValue) const
+{
+    VerifyOrReturnError(mType == Type::kFloatingPointNumber || mType == Type::kSignedInteger ||
+                            mType == Type::kUnsignedInteger,
+                        CHIP_ERROR_WRONG_TLV_TYPE);
+    VerifyOrReturnError(mValue.size() < kMaxNumberLength, CHIP_ERROR_INVALID_ARGUMENT);
+
+    // strtod() needs a null-terminated string, and the token is followed by the rest of the text.
+    char buffer[kMaxNumberLength];
+    memcpy(buffer, mValue.data(), mValue.size());
+    buffer[mValue.size()] = '\0';
+
+    errno        = 0;
+    double value = strtod(buffer, nullptr);
+    VerifyOrReturnError(errno != ERANGE || value == 0.0, CHIP_ERROR_INVALID_ARGUMENT);
+    aValue = value;
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonReader::Get(CharSpan & aValue) const
+{
+    VerifyOrReturnError(mType == Type::kString, CHIP_ERROR_WRONG_TLV_TYPE);
+    VerifyOrReturnError(!mValueHasEscapes, CHIP_ERROR_NOT_IMPLEMENTED);
+    aValue = mValue;
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonReader::GetString(MutableCharSpan & aBuffer) const
+{
+    VerifyOrReturnError(mType == Type::kString, CHIP_ERROR_WRONG_TLV_TYPE);
+
+    if (!mValueHasEscapes)
+    {
+        return CopyCharSpanToMutableCharSpan(mValue, aBuffer);
+    }
+
+    // Unescaping may need the whole raw length before shrinking.
+    VerifyOrReturnError(aBuffer.size() >= mValue.size(), CHIP_ERROR_BUFFER_TOO_SMALL);
+    size_t length;
+    ReturnErrorOnFailure(Unescape(mValue, aBuffer.data(), length));
+    aBuffer.reduce_size(length);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonReader::GetBytes(MutableByteSpan & aBuffer) const
+{
+    VerifyOrReturnError(mType == Type::kString, CHIP_ERROR_WRONG_TLV_TYPE);
+
+    CharSpan encoded = mValue;
+    Platform::ScopedMemoryBuffer<char> unescaped;
+    if (mValueHasEscapes)
+    {
+        // Escaped base64 is unusual ("\/" is the only escape that makes sense), but valid JSON.
+        size_t length;
+        VerifyOrReturnError(unescaped.Alloc(mValue.size()), CHIP_ERROR_NO_MEMORY);
+        ReturnErrorOnFailure(Unescape(mValue, unescaped.Get(), length));
+        encoded = CharSpan(unescaped.Get(), length);
+    }
+
+    VerifyOrReturnError(CanCastTo<uint16_t>(encoded.size()), CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(aBuffer.size() >= BASE64_MAX_DECODED_LEN(encoded.size()), CHIP_ERROR_BUFFER_TOO_SMALL);
+
+    uint16_t decodedLength = Base64Decode(encoded.data(), static_cast<uint16_t>(encoded.size()), aBuffer.data());
+    VerifyOrReturnError(decodedLength != UINT16_MAX, CHIP_ERROR_INVALID_ARGUMENT);
+    aBuffer.reduce_size(decodedLength);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonReader::EnterContainer()
+{
+    VerifyOrReturnError(mType == Type::kObject || mType == Type::kArray, CHIP_ERROR_INCORRECT_STATE);
+    VerifyOrReturnError(mDepth < kMaxDepth, CHIP_ERROR_INVALID_ARGUMENT);
+
+    // Consume the opening character.
+    mPos++;
+    mContainers[mDepth++] = mType;
+    mType                 = Type::kNotSpecified;
+    mKey                  = CharSpan();
+    mFirstInContainer     = true;
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonReader::ExitContainer()
+{
+    VerifyOrReturnError(mDepth > 0, CHIP_ERROR_INCORRECT_STATE);
+
+    CHIP_ERROR err;
+    while ((err = Next()) == CHIP_NO_ERROR)
+    {
+    }
+    VerifyOrReturnError(err == CHIP_END_OF_INPUT, err);
+
+    // Consume the closing character Next() stopped on.
+    mPos++;
+    mDepth--;
+    mType             = Type::kNotSpecified;
+    mKey              = CharSpan();
+    mValue            = CharSpan();
+    mFirstInContainer = false;
+    return CHIP_NO_ERROR;
+}
+
+} // namespace chip
@@ -0,0 +1,170 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <lib/core/CHIPError.h>
+#include <lib/support/CodeUtils.h>
+#include <lib/support/SafeInt.h>
+#include <lib/support/Span.h>
+
+#include <type_traits>
+
+namespace chip {
+
+/*
+ * A pull parser for JSON text, modeled after TLV::TLVReader.
+ *
+ * The reader walks the text in place: values are never copied into an intermediate document, and strings are
+ * only unescaped (or base64-decoded) into a buffer provided by the caller when they are retrieved. Unlike a DOM
+ * parser, this lets a consumer decode JSON straight into its own structures, or into a TLV::TLVWriter (see JsonToTlv).
+ *
+ * Usage mirrors the TLVReader: Next() positions the reader on the next value of the current container (or on the
+ * root value), GetType()/GetKey() describe it, Get*() retrieve scalars, and EnterContainer()/ExitContainer() descend
+ * into objects and arrays. Values that are not read or entered are skipped by the following Next().
+ *
+ * The text must outlive the reader.
+ */
+class JsonReader
+{
+public:
+    enum class Type : uint8_t
+    {
+        kNotSpecified,
+        kObject,
+        kArray,
+        kString,
+        kUnsignedInteger,     ///< A number without fraction or exponent, and without a minus sign.
+        kSignedInteger,       ///< A number without fraction or exponent, with a minus sign.
+        kFloatingPointNumber, ///< A number with a fraction or an exponent.
+        kBoolean,
+        kNull,
+    };
+
+    // The maximum nesting of objects and arrays.
+    static constexpr uint8_t kMaxDepth = 16;
+
+    void Init(const CharSpan & aJson);
+
+    /*
+     * Advance to the next value of the current container, or to the root value right after Init().
+     *
+     * @retval #CHIP_NO_ERROR           On success.
+     * @retval #CHIP_END_OF_INPUT       If there are no more values in the current container (or after the root value).
+     * @retval #CHIP_ERROR_INVALID_ARGUMENT If the text is not valid JSON.
+     */
+    CHIP_ERROR Next();
+
+    Type GetType() const { return mType; }
+
+    /*
+     * The key of the current value if it is an object member, empty otherwise. The key is returned as it appears in
+     * the text: escape sequences are not processed.
+     */
+    const CharSpan & GetKey() const { return mKey; }
+
+    CHIP_ERROR Get(bool & aValue) const;
+    CHIP_ERROR Get(uint64_t & aValue) const;
+    CHIP_ERROR Get(int64_t & aValue) const;
+    CHIP_ERROR Get(double & aValue) const;
+
+    /*
+     * Get an integer value, checking that it fits in T.
+     *
+     * @retval #CHIP_ERROR_INVALID_INTEGER_VALUE If the value does not fit in T.
+     */
+    template <typename T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value, int> = 0>
+    CHIP_ERROR Get(T & aValue) const
+    {
+        if (std::is_signed<T>::value)
+        {
+            int64_t v;
+            ReturnErrorOnFailure(Get(v));
+            VerifyOrReturnError(CanCastTo<T>(v), CHIP_ERROR_INVALID_INTEGER_VALUE);
+            aValue = static_cast<T>(v);
+        }
+        else
+        {
+            uint64_t v;
+            ReturnErrorOnFailure(Get(v));
+            VerifyOrReturnError(CanCastTo<T>(v), CHIP_ERROR_INVALID_INTEGER_VALUE);
+            aValue = static_cast<T>(v);
+        }
+        return CHIP_NO_ERROR;
+    }
+
+    /*
+     * Get the current string value without copying it. This only succeeds for strings that contain no escape
+     * sequences, use GetString() otherwise.
+     *
+     * @retval #CHIP_ERROR_NOT_IMPLEMENTED If the string needs to be unescaped.
+     */
+    CHIP_ERROR Get(CharSpan & aValue) const;
+
+    /*
+     * Unescape the current string value into aBuffer, which is resized to the length of the string. A buffer as
+     * large as GetRawStringLength() is always enough.
+     */
+    CHIP_ERROR GetString(MutableCharSpan & aBuffer) const;
+
+    /*
+     * Base64-decode the current string value into aBuffer, which is resized to the decoded length.
+     */
+    CHIP_ERROR GetBytes(MutableByteSpan & aBuffer) const;
+
+    /*
+     * The length of the current string value as it appears in the text, which bounds its unescaped length.
+     */
+    size_t GetRawStringLength() const { return mValue.size(); }
+
+    /*
+     * Descend into the current object or array. Next() then iterates over its values.
+     */
+    CHIP_ERROR EnterContainer();
+
+    /*
+     * Skip the remaining values of the current container and return to its parent.
+     */
+    CHIP_ERROR ExitContainer();
+
+private:
+    void SkipWhitespace();
+    bool IsAtEnd() const { return mPos >= mJson.size(); }
+    char Peek() const { return mJson.data()[mPos]; }
+
+    CHIP_ERROR ReadValue();
+    CHIP_ERROR ScanString(CharSpan & aContents, bool & aHasEscapes);
+    CHIP_ERROR ScanNumber();
+    CHIP_ERROR ScanLiteral(const char * aLiteral);
+    CHIP_ERROR SkipContainer();
+
+    CharSpan mJson;
+    size_t mPos = 0;
+
+    Type mType = Type::kNotSpecified;
+    CharSpan mKey;
+    // The token of the current scalar value, without the quotes for strings.
+    CharSpan mValue;
+    bool mValueHasEscapes = false;
+
+    Type mContainers[kMaxDepth];
+    uint8_t mDepth         = 0;
+    bool mFirstInContainer = true;
+    bool mRootRead         = false;
+};
+
+} // namespace chip
@@ -0,0 +1,205 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <lib/support/Base64.h>
+#include <lib/support/jsontlv/JsonWriter.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace chip {
+
+namespace {
+
+// Bytes are base64-encoded through a stack buffer, a multiple of 3 bytes at a time so that no padding is emitted
+// before the end.
+constexpr size_t kBase64ChunkSize = 48;
+
+void AppendEscaped(std::string & aOut, const CharSpan & aValue)
+{
+    static const char kHexDigits[] = "0123456789abcdef";
+
+    aOut.push_back('"');
+
+    // Append runs of characters which need no escaping in one go.
+    const char * runStart = aValue.data();
+    for (const char & c : aValue)
+    {
+        auto uc = static_cast<unsigned char>(c);
+        if (c != '"' && c != '\\' && uc >= 0x20)
+        {
+            continue;
+        }
+
+        aOut.append(runStart, static_cast<size_t>(&c - runStart));
+        runStart = &c + 1;
+
+        aOut.push_back('\\');
+        switch (c)
+        {
+        case '"':
+        case '\\':
+            aOut.push_back(c);
+            break;
+        case '\b':
+            aOut.push_back('b');
+            break;
+        case '\f':
+            aOut.push_back('f');
+            break;
+        case '\n':
+            aOut.push_back('n');
+            break;
+        case '\r':
+            aOut.push_back('r');
+            break;
+        case '\t':
+            aOut.push_back('t');
+            break;
+        default:
+            aOut.append("u00");
+            aOut.push_back(kHexDigits[uc >> 4]);
+            aOut.push_back(kHexDigits[uc & 0xF]);
+            break;
+        }
+    }
+    aOut.append(runStart, static_cast<size_t>(aValue.data() + aValue.size() - runStart));
+
+    aOut.push_back('"');
+}
+
+} // namespace
+
+void JsonWriter::StartValue()
+{
+    if (mNeedComma)
+    {
+        mOut.push_back(',');
+    }
+    mNeedComma = true;
+}
+
+void JsonWriter::StartObject()
+{
+    StartValue();
+    mOut.push_back('{');
+    mNeedComma = false;
+}
+
+void JsonWriter::EndObject()
+{
+    mOut.push_back('}');
+    mNeedComma = true;
+}
+
+void JsonWriter::StartArray()
+{
+    StartValue();
+    mOut.push_back('[');
+    mNeedComma = false;
+}
+
+void JsonWriter::EndArray()
+{
+    mOut.push_back(']');
+    mNeedComma = true;
+}
+
+void JsonWriter::PutKey(const CharSpan & aKey)
+{
+    StartValue();
+    AppendEscaped(mOut, aKey);
+    mOut.push_back(':');
+    // The value which follows must not be preceded by a separator.
+    mNeedComma = false;
+}
+
+void JsonWriter::Put(uint64_t aValue)
+{
+    char buffer[24];
+    StartValue();
+    snprintf(buffer, sizeof(buffer), "%" PRIu64, aValue);
+    mOut.append(buffer);
+}
+
+void JsonWriter::Put(int64_t aValue)
+{
+    char buffer[24];
+    StartValue();
+    snprintf(buffer, sizeof(buffer), "%" PRId64, aValue);
+    mOut.append(buffer);
+}
+
+void JsonWriter::Put(bool aValue)
+{
+    StartValue();
+    mOut.append(aValue ? "true" : "false");
+}
+
+void JsonWriter::Put(double aValue)
+{
+    if (!std::isfinite(aValue))
+    {
+        PutNull();
+        return;
+    }
+
+    // 17 significant digits are enough for the value to be read back exactly.
+    char buffer[32];
+    StartValue();
+    snprintf(buffer, sizeof(buffer), "%.17g", aValue);
+    mOut.append(buffer);
+
+    // Keep the value distinguishable from an integer when it is read back.
+    if (strpbrk(buffer, ".eE") == nullptr)
+    {
+        mOut.append(".0");
+    }
+}
+
+void JsonWriter::PutString(const CharSpan & aValue)
+{
+    StartValue();
+    AppendEscaped(mOut, aValue);
+}
+
+void JsonWriter::PutBytes(const ByteSpan & aValue)
+{
+    char encoded[BASE64_ENCODED_LEN(kBase64ChunkSize)];
+
+    StartValue();
+    mOut.push_back('"');
+    mOut.reserve(mOut.size() + BASE64_ENCODED_LEN(aValue.size()) + 1);
+    for (size_t offset = 0; offset < aValue.size(); offset += kBase64ChunkSize)
+    {
+        size_t chunkSize = std::min(kBase64ChunkSize, aValue.size() - offset);
+        uint16_t length  = Base64Encode(aValue.data() + offset, static_cast<uint16_t>(chunkSize), encoded);
+        mOut.append(encoded, length);
+    }
+    mOut.push_back('"');
+}
+
+void JsonWriter::PutNull()
+{
+    StartValue();
+    mOut.append("null");
+}
+
+} // namespace chip
@@ -0,0 +1,70 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <lib/support/Span.h>
+
+#include <string>
+
+namespace chip {
+
+/*
+ * Appends compact JSON text to a string as values are written, without building an intermediate document.
+ *
+ * The writer only takes care of separators and of escaping: the caller is responsible for balancing
+ * Start*()/End*() calls and for calling PutKey() before every value written inside an object.
+ */
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::string & aOut) : mOut(aOut) {}
+
+    void StartObject();
+    void EndObject();
+    void StartArray();
+    void EndArray();
+
+    void PutKey(const CharSpan & aKey);
+
+    void Put(uint64_t aValue);
+    void Put(int64_t aValue);
+    void Put(bool aValue);
+
+    /*
+     * Non-finite numbers cannot be represented in JSON and are written as null.
+     */
+    void Put(double aValue);
+
+    void PutString(const CharSpan & aValue);
+
+    /*
+     * Write a byte string as a base64-encoded JSON string.
+     */
+    void PutBytes(const ByteSpan & aValue);
+
+    void PutNull();
+
+private:
+    void StartValue();
+
+    std::string & mOut;
+    // Whether a separator is needed before the next key or value.
+    bool mNeedComma = false;
+};
+
+} // namespace chip
@@ -19,6 +19,7 @@
 #include "lib/support/ScopedBuffer.h"
 #include <lib/core/DataModelTypes.h>
 #include <lib/support/Base64.h>
+#include <lib/support/jsontlv/JsonWriter.h>
 #include <lib/support/jsontlv/TlvJson.h>
 
 namespace {
@@ -240,4 +241,223 @@ CHIP_ERROR TlvToJson(TLV::TLVReader & reader, Json::Value & root)
     return TlvToJson(reader, context, root);
 }
 
+/*
+ * Streaming counterpart of the conversion above: the key of the element, if any, has already been written, so
+ * this only writes the value.
+ */
+CHIP_ERROR TlvToJson(TLV::TLVReader & reader, JsonWriter & writer)
+{
+    switch (reader.GetType())
+    {
+    case TLV::kTLVType_UnsignedInteger: {
+        uint64_t v;
+        ReturnErrorOnFailure(reader.Get(v));
+        writer.Put(v);
+        break;
+    }
+
+    case TLV::kTLVType_SignedInteger: {
+        int64_t v;
+        ReturnErrorOnFailure(reader.Get(v));
+        writer.Put(v);
+        break;
+    }
+
+    case TLV::kTLVType_Boolean: {
+        bool v;
+        ReturnErrorOnFailure(reader.Get(v));
+        writer.Put(v);
+        break;
+    }
+
+    case TLV::kTLVType_FloatingPointNumber: {
+        double v;
+        ReturnErrorOnFailure(reader.Get(v));
+        writer.Put(v);
+        break;
+    }
+
+    case TLV::kTLVType_ByteString: {
+        ByteSpan span;
+        ReturnErrorOnFailure(reader.Get(span));
+        VerifyOrReturnError(span.size() < kMaxStringLen, CHIP_ERROR_INVALID_TLV_ELEMENT);
+        writer.PutBytes(span);
+        break;
+    }
+
+    case TLV::kTLVType_UTF8String: {
+        CharSpan span;
+        ReturnErrorOnFailure(reader.Get(span));
+        VerifyOrReturnError(span.size() < kMaxStringLen, CHIP_ERROR_INVALID_TLV_ELEMENT);
+        writer.PutString(span);
+        break;
+    }
+
+    case TLV::kTLVType_Null:
+        writer.PutNull();
+        break;
+
+    case TLV::kTLVType_Structure:
+    case TLV::kTLVType_Array: {
+        const bool isStruct = (reader.GetType() == TLV::kTLVType_Structure);
+        TLV::TLVType containerType;
+        CHIP_ERROR err;
+
+        ReturnErrorOnFailure(reader.EnterContainer(containerType));
+
+        // The conversion above leaves the value of an empty container unset, which jsoncpp writes as null: do the same.
+        err = reader.Next();
+        if (err == CHIP_END_OF_TLV)
+        {
+            writer.PutNull();
+        }
+        else
+        {
+            isStruct ? writer.StartObject() : writer.StartArray();
+            for (; err == CHIP_NO_ERROR; err = reader.Next())
+            {
+                if (isStruct)
+                {
+                    VerifyOrReturnError(TLV::IsContextTag(reader.GetTag()), CHIP_ERROR_INVALID_TLV_TAG);
+
+                    char keyBuf[12];
+                    snprintf(keyBuf, sizeof(keyBuf), "%" PRIu32, TLV::TagNumFromTag(reader.GetTag()));
+                    writer.PutKey(CharSpan::fromCharString(keyBuf));
+                }
+                ReturnErrorOnFailure(TlvToJson(reader, writer));
+            }
+            VerifyOrReturnError(err == CHIP_END_OF_TLV, err);
+            isStruct ? writer.EndObject() : writer.EndArray();
+        }
+
+        ReturnErrorOnFailure(reader.ExitContainer(containerType));
+        break;
+    }
+
+    default:
+        return CHIP_ERROR_INVALID_TLV_ELEMENT;
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR TlvToJson(TLV::TLVReader & reader, std::string & json)
+{
+    JsonWriter writer(json);
+    writer.StartObject();
+    writer.PutKey(CharSpan::fromCharString("value"));
+    ReturnErrorOnFailure(TlvToJson(reader, writer));
+    writer.EndObject();
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR JsonToTlv(JsonReader & reader, TLV::TLVWriter & writer, TLV::Tag tag)
+{
+    switch (reader.GetType())
+    {
+    case JsonReader::Type::kUnsignedInteger: {
+        uint64_t v;
+        ReturnErrorOnFailure(reader.Get(v));
+        return writer.Put(tag, v);
+    }
+
+    case JsonReader::Type::kSignedInteger: {
+        int64_t v;
+        ReturnErrorOnFailure(reader.Get(v));
+        return writer.Put(tag, v);
+    }
+
+    case JsonReader::Type::kFloatingPointNumber: {
+        double v;
+        ReturnErrorOnFailure(reader.Get(v));
+        return writer.Put(tag, v);
+    }
+
+    case JsonReader::Type::kBoolean: {
+        bool v;
+        ReturnErrorOnFailure(reader.Get(v));
+        return writer.PutBoolean(tag, v);
+    }
+
+    case JsonReader::Type::kNull:
+        return writer.PutNull(tag);
+
+    case JsonReader::Type::kString: {
+        CharSpan span;
+        CHIP_ERROR err = reader.Get(span);
+        if (err != CHIP_ERROR_NOT_IMPLEMENTED)
+        {
+            ReturnErrorOnFailure(err);
+            VerifyOrReturnError(span.size() < kMaxStringLen, CHIP_ERROR_INVALID_ARGUMENT);
+            return writer.PutString(tag, span);
+        }
+
+        // Only strings with escape sequences need a copy.
+        Platform::ScopedMemoryBuffer<char> buffer;
+        VerifyOrReturnError(reader.GetRawStringLength() < kMaxStringLen, CHIP_ERROR_INVALID_ARGUMENT);
+        VerifyOrReturnError(buffer.Alloc(reader.GetRawStringLength()), CHIP_ERROR_NO_MEMORY);
+        MutableCharSpan unescaped(buffer.Get(), reader.GetRawStringLength());
+        ReturnErrorOnFailure(reader.GetString(unescaped));
+        return writer.PutString(tag, unescaped);
+    }
+
+    case JsonReader::Type::kObject:
+    case JsonReader::Type::kArray: {
+        const bool isStruct = (reader.GetType() == JsonReader::Type::kObject);
+        TLV::TLVType containerType;
+        CHIP_ERROR err;
+
+        ReturnErrorOnFailure(writer.StartContainer(tag, isStruct ? TLV::kTLVType_Structure : TLV::kTLVType_Array, containerType));
+        ReturnErrorOnFailure(reader.EnterContainer());
+
+        while ((err = reader.Next()) == CHIP_NO_ERROR)
+        {
+            TLV::Tag elementTag = TLV::AnonymousTag();
+            if (isStruct)
+            {
+                // Keys are the field IDs written by TlvToJson, which are context tags.
+                const CharSpan & key = reader.GetKey();
+                uint32_t fieldId     = 0;
+                VerifyOrReturnError(!key.empty() && key.size() <= 3, CHIP_ERROR_INVALID_TLV_TAG);
+                for (char c : key)
+                {
+                    VerifyOrReturnError(c >= '0' && c <= '9', CHIP_ERROR_INVALID_TLV_TAG);
+                    fieldId = fieldId * 10 + static_cast<uint32_t>(c - '0');
+                }
+                VerifyOrReturnError(CanCastTo<uint8_t>(fieldId), CHIP_ERROR_INVALID_TLV_TAG);
+                elementTag = TLV::ContextTag(static_cast<uint8_t>(fieldId));
+            }
+            ReturnErrorOnFailure(JsonToTlv(reader, writer, elementTag));
+        }
+
+        VerifyOrReturnError(err == CHIP_END_OF_INPUT, err);
+        ReturnErrorOnFailure(reader.ExitContainer());
+        return writer.EndContainer(containerType);
+    }
+
+    default:
+        return CHIP_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+CHIP_ERROR JsonToTlv(const CharSpan & json, TLV::TLVWriter & writer)
+{
+    JsonReader reader;
+    reader.Init(json);
+
+    ReturnErrorOnFailure(reader.Next());
+    VerifyOrReturnError(reader.GetType() == JsonReader::Type::kObject, CHIP_ERROR_INVALID_ARGUMENT);
+    ReturnErrorOnFailure(reader.EnterContainer());
+
+    ReturnErrorOnFailure(reader.Next());
+    VerifyOrReturnError(reader.GetKey().data_equal(CharSpan::fromCharString("value")), CHIP_ERROR_INVALID_ARGUMENT);
+    ReturnErrorOnFailure(JsonToTlv(reader, writer, TLV::AnonymousTag()));
+
+    // The root object holds nothing but the value.
+    VerifyOrReturnError(reader.Next() == CHIP_END_OF_INPUT, CHIP_ERROR_INVALID_ARGUMENT);
+    ReturnErrorOnFailure(reader.ExitContainer());
+    VerifyOrReturnError(reader.Next() == CHIP_END_OF_INPUT, CHIP_ERROR_INVALID_ARGUMENT);
+    return CHIP_NO_ERROR;
+}
+
 } // namespace chip
@@ -18,6 +18,10 @@
 
 #include <json/json.h>
 #include <lib/core/CHIPTLV.h>
+#include <lib/support/jsontlv/JsonReader.h>
+#include <lib/support/jsontlv/JsonWriter.h>
+
+#include <string>
 
 namespace chip {
 
@@ -35,4 +39,33 @@ CHIP_ERROR TlvToJson(TLV::TLVReader & reader, Json::Value & root);
  */
 std::string JsonToString(Json::Value & json);
 
+/*
+ * Same as above, but streams the JSON text straight into a string instead of building a Json::Value first.
+ * The output has the same shape as JsonToString(root), except that struct members appear in TLV order instead of being
+ * sorted by key.
+ */
+CHIP_ERROR TlvToJson(TLV::TLVReader & reader, std::string & json);
+
+/*
+ * Writes the value the TLVReader is positioned on to the given writer, e.g. to embed it in a larger document. The key
+ * of the value, if any, must already have been written.
+ */
+CHIP_ERROR TlvToJson(TLV::TLVReader & reader, JsonWriter & writer);
+
+/*
+ * Converts the value the JsonReader is positioned on into TLV, written with the given tag.
+ *
+ * Objects are written as structures, whose keys must be context tag numbers in decimal. Arrays are written as arrays,
+ * numbers according to the JsonReader type, and strings as UTF-8 strings: the JSON text carries no schema, so octet
+ * strings encoded in base64 by TlvToJson come back as their base64 text. Consumers which know the schema should use
+ * JsonReader::GetBytes() instead.
+ */
+CHIP_ERROR JsonToTlv(JsonReader & reader, TLV::TLVWriter & writer, TLV::Tag tag);
+
+/*
+ * Converts a JSON object of the form produced by TlvToJson, i.e. {"value": <payload>}, into TLV. The payload is
+ * written with an anonymous tag.
+ */
+CHIP_ERROR JsonToTlv(const CharSpan & json, TLV::TLVWriter & writer);
+
 } // namespace chip
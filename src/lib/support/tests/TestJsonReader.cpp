@@ -0,0 +1,320 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <lib/support/CHIPMem.h>
+#include <lib/support/UnitTestRegistration.h>
+#include <lib/support/jsontlv/JsonReader.h>
+#include <lib/support/jsontlv/JsonWriter.h>
+#include <lib/support/jsontlv/TlvJson.h>
+#include <nlunit-test.h>
+
+#include <cstring>
+
+namespace {
+
+using namespace chip;
+using Type = JsonReader::Type;
+
+void InitReader(JsonReader & reader, const char * json)
+{
+    reader.Init(CharSpan(json, strlen(json)));
+}
+
+bool KeyIs(const JsonReader & reader, const char * key)
+{
+    return reader.GetKey().data_equal(CharSpan(key, strlen(key)));
+}
+
+void TestScalars(nlTestSuite * inSuite, void * inContext)
+{
+    JsonReader reader;
+    uint64_t u;
+    int64_t i;
+    double d;
+    bool b;
+    uint8_t u8;
+    int8_t i8;
+
+    InitReader(reader, " [ 0, 18446744073709551615, -9223372036854775808, 1.5e3, -0.25, true, false, null, 256, -129, 42 ] ");
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.GetType() == Type::kArray);
+    NL_TEST_ASSERT(inSuite, reader.EnterContainer() == CHIP_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.GetType() == Type::kUnsignedInteger);
+    NL_TEST_ASSERT(inSuite, reader.Get(u) == CHIP_NO_ERROR && u == 0);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Get(u) == CHIP_NO_ERROR && u == UINT64_MAX);
+    NL_TEST_ASSERT(inSuite, reader.Get(i) == CHIP_ERROR_INVALID_INTEGER_VALUE);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.GetType() == Type::kSignedInteger);
+    NL_TEST_ASSERT(inSuite, reader.Get(i) == CHIP_NO_ERROR && i == INT64_MIN);
+    NL_TEST_ASSERT(inSuite, reader.Get(u) == CHIP_ERROR_WRONG_TLV_TYPE);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.GetType() == Type::kFloatingPointNumber);
+    NL_TEST_ASSERT(inSuite, reader.Get(d) == CHIP_NO_ERROR && d == 1500.0);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Get(d) == CHIP_NO_ERROR && d == -0.25);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Get(b) == CHIP_NO_ERROR && b);
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Get(b) == CHIP_NO_ERROR && !b);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.GetType() == Type::kNull);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Get(u8) == CHIP_ERROR_INVALID_INTEGER_VALUE);
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Get(i8) == CHIP_ERROR_INVALID_INTEGER_VALUE);
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Get(u8) == CHIP_NO_ERROR && u8 == 42);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_END_OF_INPUT);
+    NL_TEST_ASSERT(inSuite, reader.ExitContainer() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_END_OF_INPUT);
+}
+
+void TestStrings(nlTestSuite * inSuite, void * inContext)
+{
+    JsonReader reader;
+    CharSpan span;
+    char buf[32];
+
+    InitReader(reader, R"({"plain": "hello", "escaped": "a\"b\\c\/\n\u00e9\ud83d\ude00", "bytes": "AQID/w=="})");
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.EnterContainer() == CHIP_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, KeyIs(reader, "plain"));
+    NL_TEST_ASSERT(inSuite, reader.Get(span) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, span.data_equal(CharSpan::fromCharString("hello")));
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, KeyIs(reader, "escaped"));
+    NL_TEST_ASSERT(inSuite, reader.Get(span) == CHIP_ERROR_NOT_IMPLEMENTED);
+
+    MutableCharSpan tooSmall(buf, 4);
+    NL_TEST_ASSERT(inSuite, reader.GetString(tooSmall) == CHIP_ERROR_BUFFER_TOO_SMALL);
+
+    MutableCharSpan unescaped(buf);
+    const char expected[] = "a\"b\\c/\n\xc3\xa9\xf0\x9f\x98\x80";
+    NL_TEST_ASSERT(inSuite, reader.GetString(unescaped) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, unescaped.data_equal(CharSpan(expected, sizeof(expected) - 1)));
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, KeyIs(reader, "bytes"));
+    uint8_t bytesBuf[8];
+    MutableByteSpan bytes(bytesBuf);
+    const uint8_t expectedBytes[] = { 0x01, 0x02, 0x03, 0xff };
+    NL_TEST_ASSERT(inSuite, reader.GetBytes(bytes) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, bytes.data_equal(ByteSpan(expectedBytes)));
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_END_OF_INPUT);
+    NL_TEST_ASSERT(inSuite, reader.ExitContainer() == CHIP_NO_ERROR);
+}
+
+void TestSkipping(nlTestSuite * inSuite, void * inContext)
+{
+    JsonReader reader;
+    uint64_t u;
+
+    // Containers which are not entered, or only partially read, are skipped, including brackets within strings.
+    InitReader(reader, R"({"a": {"x": [1, 2, {"y": "]}"}]}, "b": [[3], 4], "c": 5})");
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.EnterContainer() == CHIP_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, KeyIs(reader, "a") && reader.GetType() == Type::kObject);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, KeyIs(reader, "b") && reader.GetType() == Type::kArray);
+    NL_TEST_ASSERT(inSuite, reader.EnterContainer() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.GetType() == Type::kArray);
+    NL_TEST_ASSERT(inSuite, reader.ExitContainer() == CHIP_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, KeyIs(reader, "c"));
+    NL_TEST_ASSERT(inSuite, reader.Get(u) == CHIP_NO_ERROR && u == 5);
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_END_OF_INPUT);
+}
+
+void TestMalformed(nlTestSuite * inSuite, void * inContext)
+{
+    static const char * const kMalformed[] = {
+        "",
+        "[1 2]",
+        "[1,]",
+        "{\"a\" 1}",
+        "{1: 2}",
+        "[01]",
+        "[1.]",
+        "[-]",
+        "[tru]",
+        "[\"a]",
+        "[\"\\x\"]",
+        "[\"\\u12\"]",
+        "[1] [2]",
+        "[\"a\tb\"]",
+        "[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]",
+    };
+
+    for (const char * json : kMalformed)
+    {
+        JsonReader reader;
+        CHIP_ERROR err;
+
+        // Read everything, entering every container, until an error is found.
+        InitReader(reader, json);
+        while (true)
+        {
+            err = reader.Next();
+            if (err == CHIP_END_OF_INPUT)
+            {
+                err = reader.ExitContainer();
+                if (err == CHIP_ERROR_INCORRECT_STATE)
+                {
+                    // Back at the root: the whole text was read.
+                    err = CHIP_NO_ERROR;
+                    break;
+                }
+            }
+            else if (err == CHIP_NO_ERROR && (reader.GetType() == Type::kObject || reader.GetType() == Type::kArray))
+            {
+                err = reader.EnterContainer();
+            }
+            if (err != CHIP_NO_ERROR)
+            {
+                break;
+            }
+        }
+
+        if (err == CHIP_NO_ERROR)
+        {
+            printf("Malformed JSON accepted: %s\n", json);
+        }
+        NL_TEST_ASSERT(inSuite, err != CHIP_NO_ERROR);
+    }
+}
+
+void TestWriter(nlTestSuite * inSuite, void * inContext)
+{
+    std::string out;
+    JsonWriter writer(out);
+    const uint8_t bytes[] = { 0x01, 0x02, 0x03, 0xff };
+    const char text[]     = "a\"b\\\n\x01";
+
+    writer.StartObject();
+    writer.PutKey(CharSpan::fromCharString("a"));
+    writer.StartArray();
+    writer.Put(static_cast<uint64_t>(1));
+    writer.Put(static_cast<int64_t>(-2));
+    writer.Put(2.0);
+    writer.Put(true);
+    writer.PutNull();
+    writer.EndArray();
+    writer.PutKey(CharSpan::fromCharString("b"));
+    writer.PutString(CharSpan(text, sizeof(text) - 1));
+    writer.PutKey(CharSpan::fromCharString("c"));
+    writer.PutBytes(ByteSpan(bytes));
+    writer.EndObject();
+
+    const char * expected = R"({"a":[1,-2,2.0,true,null],"b":"a\"b\\\n\u0001","c":"AQID/w=="})";
+    NL_TEST_ASSERT(inSuite, out == expected);
+    if (out != expected)
+    {
+        printf("Generated: %s\n", out.c_str());
+    }
+}
+
+void TestJsonToTlv(nlTestSuite * inSuite, void * inContext)
+{
+    uint8_t buf[256];
+    TLV::TLVWriter writer;
+    TLV::TLVReader reader;
+    TLV::TLVType containerType;
+    CharSpan span;
+    int64_t i;
+
+    const char json[] = R"({"value": {"0": -1, "1": "a\nb", "2": [true, null]}})";
+    writer.Init(buf);
+    NL_TEST_ASSERT(inSuite, JsonToTlv(CharSpan(json, sizeof(json) - 1), writer) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, writer.Finalize() == CHIP_NO_ERROR);
+
+    reader.Init(buf, writer.GetLengthWritten());
+    NL_TEST_ASSERT(inSuite, reader.Next(TLV::kTLVType_Structure, TLV::AnonymousTag()) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.EnterContainer(containerType) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Next(TLV::ContextTag(0)) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Get(i) == CHIP_NO_ERROR && i == -1);
+    NL_TEST_ASSERT(inSuite, reader.Next(TLV::ContextTag(1)) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Get(span) == CHIP_NO_ERROR && span.data_equal(CharSpan::fromCharString("a\nb")));
+    NL_TEST_ASSERT(inSuite, reader.Next(TLV::kTLVType_Array, TLV::ContextTag(2)) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.Next() == CHIP_END_OF_TLV);
+    NL_TEST_ASSERT(inSuite, reader.ExitContainer(containerType) == CHIP_NO_ERROR);
+
+    // Struct keys have to be context tag numbers, and the root object must only hold the value.
+    const char * const kInvalid[] = {
+        R"({"value": {"name": 1}})",
+        R"({"value": {"256": 1}})",
+        R"({"value": 1, "other": 2})",
+        R"({"other": 1})",
+    };
+    for (const char * invalid : kInvalid)
+    {
+        writer.Init(buf);
+        NL_TEST_ASSERT(inSuite, JsonToTlv(CharSpan(invalid, strlen(invalid)), writer) != CHIP_NO_ERROR);
+    }
+}
+
+int Initialize(void * apSuite)
+{
+    VerifyOrReturnError(chip::Platform::MemoryInit() == CHIP_NO_ERROR, FAILURE);
+    return SUCCESS;
+}
+
+int Finalize(void * aContext)
+{
+    chip::Platform::MemoryShutdown();
+    return SUCCESS;
+}
+
+const nlTest sTests[] = {
+    NL_TEST_DEF("TestScalars", TestScalars),
+    NL_TEST_DEF("TestStrings", TestStrings),
+    NL_TEST_DEF("TestSkipping", TestSkipping),
+    NL_TEST_DEF("TestMalformed", TestMalformed),
+    NL_TEST_DEF("TestWriter", TestWriter),
+    NL_TEST_DEF("TestJsonToTlv", TestJsonToTlv),
+    NL_TEST_SENTINEL(),
+};
+
+} // namespace
+
+int TestJsonReader()
+{
+    nlTestSuite theSuite = { "JsonReader", sTests, Initialize, Finalize };
+    nlTestRunner(&theSuite, nullptr);
+    return nlTestRunnerStats(&theSuite);
+}
+
+CHIP_REGISTER_TEST_SUITE(TestJsonReader)
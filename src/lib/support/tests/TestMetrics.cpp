@@ -0,0 +1,216 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <lib/support/Metrics.h>
+#include <lib/support/Pool.h>
+#include <lib/support/UnitTestRegistration.h>
+
+#include <cstring>
+#include <nlunit-test.h>
+
+using namespace chip;
+using namespace chip::Metrics;
+
+namespace {
+
+// Registered without the macros, so that the tests run whether or not chip_enable_metrics is set
+Counter sTestCounter("test_events_total", "Test events");
+Registration sTestCounterRegistration(sTestCounter);
+Gauge sTestGauge("test_level", "Test level");
+Registration sTestGaugeRegistration(sTestGauge);
+constexpr uint64_t kTestBounds[] = { 10, 100 };
+Histogram<2> sTestHistogram("test_latency_ms", "Test latency", kTestBounds);
+Registration sTestHistogramRegistration(sTestHistogram);
+
+// A family of two labeled gauges, registered apart from each other
+Gauge sTestQueueA("test_queue_depth", "Test queue depth", "queue=\"a\"");
+Registration sTestQueueARegistration(sTestQueueA);
+Counter sTestOther("test_other_total", "Test other");
+Registration sTestOtherRegistration(sTestOther);
+Gauge sTestQueueB("test_queue_depth", "Test queue depth", "queue=\"b\"");
+Registration sTestQueueBRegistration(sTestQueueB);
+
+PoolMetrics sTestPoolMetrics("pool=\"test\"");
+Registration sTestPoolMetricsRegistration(sTestPoolMetrics);
+
+size_t WriteText(char * text, size_t size)
+{
+    Encoding::BufferWriter writer(reinterpret_cast<uint8_t *>(text), size - 1);
+    WritePrometheusText(writer);
+    VerifyOrReturnValue(writer.Fit(), 0);
+    text[writer.Needed()] = '\0';
+    return writer.Needed();
+}
+
+size_t CountOccurrences(const char * text, const char * pattern)
+{
+    size_t count = 0;
+    for (const char * found = strstr(text, pattern); found != nullptr; found = strstr(found + 1, pattern))
+    {
+        count++;
+    }
+    return count;
+}
+
+void TestCounterAndGauge(nlTestSuite * inSuite, void * inContext)
+{
+    Counter counter("counter", "");
+    counter.Increment();
+    counter.Increment(41);
+    NL_TEST_ASSERT(inSuite, counter.Get() == 42);
+
+    Gauge gauge("gauge", "");
+    gauge.Set(5);
+    gauge.Increment();
+    gauge.Decrement(10);
+    NL_TEST_ASSERT(inSuite, gauge.Get() == -4);
+}
+
+void TestHistogramBuckets(nlTestSuite * inSuite, void * inContext)
+{
+    constexpr uint64_t bounds[] = { 1, 10, 100 };
+    Histogram<3> histogram("histogram", "", bounds);
+
+    // Bounds are inclusive, and values above the last bound go into the overflow bucket
+    histogram.Record(0);
+    histogram.Record(1);
+    histogram.Record(2);
+    histogram.Record(100);
+    histogram.Record(101);
+    histogram.Record(5000);
+
+    NL_TEST_ASSERT(inSuite, histogram.GetBoundCount() == 3);
+    NL_TEST_ASSERT(inSuite, histogram.GetBucket(0) == 2);
+    NL_TEST_ASSERT(inSuite, histogram.GetBucket(1) == 1);
+    NL_TEST_ASSERT(inSuite, histogram.GetBucket(2) == 1);
+    NL_TEST_ASSERT(inSuite, histogram.GetBucket(3) == 2);
+    NL_TEST_ASSERT(inSuite, histogram.GetSum() == 5204);
+}
+
+void TestRegistry(nlTestSuite * inSuite, void * inContext)
+{
+    bool found = false;
+    for (const Metric * metric = GetFirstMetric(); metric != nullptr; metric = metric->GetNext())
+    {
+        found = found || metric == &sTestHistogram;
+    }
+    NL_TEST_ASSERT(inSuite, found);
+}
+
+void TestPrometheusText(nlTestSuite * inSuite, void * inContext)
+{
+    sTestCounter.Increment(3);
+    sTestGauge.Set(-2);
+    sTestHistogram.Record(5);
+    sTestHistogram.Record(50);
+    sTestHistogram.Record(500);
+
+    static char text[16384];
+    Encoding::BufferWriter writer(reinterpret_cast<uint8_t *>(text), sizeof(text) - 1);
+    WritePrometheusText(writer);
+    NL_TEST_ASSERT(inSuite, writer.Fit());
+    text[writer.Needed()] = '\0';
+
+    NL_TEST_ASSERT(inSuite, strstr(text, "# HELP test_events_total Test events\n# TYPE test_events_total counter\n") != nullptr);
+    NL_TEST_ASSERT(inSuite, strstr(text, "\ntest_events_total 3\n") != nullptr);
+    NL_TEST_ASSERT(inSuite, strstr(text, "# TYPE test_level gauge\ntest_level -2\n") != nullptr);
+    NL_TEST_ASSERT(inSuite,
+                   strstr(text,
+                          "# TYPE test_latency_ms histogram\n"
+                          "test_latency_ms_bucket{le=\"10\"} 1\n"
+                          "test_latency_ms_bucket{le=\"100\"} 2\n"
+                          "test_latency_ms_bucket{le=\"+Inf\"} 3\n"
+                          "test_latency_ms_sum 555\n"
+                          "test_latency_ms_count 3\n") != nullptr);
+
+    // A short buffer tells how much was needed
+    uint8_t shortBuffer[8];
+    Encoding::BufferWriter shortWriter(shortBuffer, sizeof(shortBuffer));
+    WritePrometheusText(shortWriter);
+    NL_TEST_ASSERT(inSuite, !shortWriter.Fit());
+    NL_TEST_ASSERT(inSuite, shortWriter.Needed() == writer.Needed());
+}
+
+void TestLabeledFamilies(nlTestSuite * inSuite, void * inContext)
+{
+    sTestQueueA.Set(1);
+    sTestQueueB.Set(2);
+
+    static char text[16384];
+    NL_TEST_ASSERT(inSuite, WriteText(text, sizeof(text)) > 0);
+
+    // One header for the family, followed by all its samples
+    NL_TEST_ASSERT(inSuite, CountOccurrences(text, "# TYPE test_queue_depth gauge\n") == 1);
+    NL_TEST_ASSERT(inSuite,
+                   strstr(text,
+                          "# TYPE test_queue_depth gauge\n"
+                          "test_queue_depth{queue=\"b\"} 2\n"
+                          "test_queue_depth{queue=\"a\"} 1\n") != nullptr);
+    NL_TEST_ASSERT(inSuite, strstr(text, "\ntest_other_total 0\n") != nullptr);
+    NL_TEST_ASSERT(inSuite, CountOccurrences(text, "# TYPE chip_pool_objects_in_use gauge\n") == 1);
+    NL_TEST_ASSERT(inSuite, strstr(text, "\nchip_pool_objects_in_use{pool=\"test\"} 0\n") != nullptr);
+}
+
+#if CHIP_CONFIG_ENABLE_METRICS
+void TestPoolMetrics(nlTestSuite * inSuite, void * inContext)
+{
+    ObjectPool<uint32_t, 2> pool;
+    CHIP_METRIC_POOL_ATTACH(pool, sTestPoolMetrics);
+
+    uint32_t * first = pool.CreateObject(1u);
+    NL_TEST_ASSERT(inSuite, pool.CreateObject(2u) != nullptr);
+#if !CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    NL_TEST_ASSERT(inSuite, pool.CreateObject(3u) == nullptr);
+    NL_TEST_ASSERT(inSuite, sTestPoolMetrics.mExhaustions.Get() == 1);
+#endif
+    pool.ReleaseObject(first);
+
+    NL_TEST_ASSERT(inSuite, sTestPoolMetrics.mAllocations.Get() == 2);
+    NL_TEST_ASSERT(inSuite, sTestPoolMetrics.mObjectsInUse.Get() == 1);
+
+    static char text[16384];
+    NL_TEST_ASSERT(inSuite, WriteText(text, sizeof(text)) > 0);
+    NL_TEST_ASSERT(inSuite, strstr(text, "\nchip_pool_allocations_total{pool=\"test\"} 2\n") != nullptr);
+    NL_TEST_ASSERT(inSuite, strstr(text, "\nchip_pool_objects_in_use{pool=\"test\"} 1\n") != nullptr);
+
+    pool.ReleaseAll();
+    NL_TEST_ASSERT(inSuite, sTestPoolMetrics.mObjectsInUse.Get() == 0);
+}
+#endif // CHIP_CONFIG_ENABLE_METRICS
+
+const nlTest sTests[] = { NL_TEST_DEF("Test counter and gauge", TestCounterAndGauge),
+                          NL_TEST_DEF("Test histogram buckets", TestHistogramBuckets),
+                          NL_TEST_DEF("Test registry", TestRegistry),
+                          NL_TEST_DEF("Test Prometheus text", TestPrometheusText),
+                          NL_TEST_DEF("Test labeled families", TestLabeledFamilies),
+#if CHIP_CONFIG_ENABLE_METRICS
+                          NL_TEST_DEF("Test pool metrics", TestPoolMetrics),
+#endif
+                          NL_TEST_SENTINEL() };
+
+} // namespace
+
+int TestMetrics()
+{
+    nlTestSuite theSuite = { "CHIP Metrics tests", &sTests[0], nullptr, nullptr };
+
+    nlTestRunner(&theSuite, nullptr);
+    return nlTestRunnerStats(&theSuite);
+}
+
+CHIP_REGISTER_TEST_SUITE(TestMetrics)
@@ -102,6 +102,39 @@ void EncodeAndValidate(T val, const char * expectedJsonString)
 
     bool matches = Matches(expectedJsonString, d);
     NL_TEST_ASSERT(gSuite, matches);
+
+    // The streaming converter must produce the same value.
+    err = SetupReader();
+    NL_TEST_ASSERT(gSuite, err == CHIP_NO_ERROR);
+
+    std::string streamed;
+    err = TlvToJson(gReader, streamed);
+    NL_TEST_ASSERT(gSuite, err == CHIP_NO_ERROR);
+
+    Json::Reader jsonReader;
+    Json::Value streamedValue;
+    NL_TEST_ASSERT(gSuite, jsonReader.parse(streamed, streamedValue));
+    matches = Matches(expectedJsonString, streamedValue);
+    NL_TEST_ASSERT(gSuite, matches);
+
+    // Converting it back to TLV and then to JSON again must give the same text.
+    uint8_t roundTripBuf[1024];
+    TLV::TLVWriter roundTripWriter;
+    roundTripWriter.Init(roundTripBuf);
+    err = JsonToTlv(CharSpan(streamed.data(), streamed.size()), roundTripWriter);
+    NL_TEST_ASSERT(gSuite, err == CHIP_NO_ERROR);
+    err = roundTripWriter.Finalize();
+    NL_TEST_ASSERT(gSuite, err == CHIP_NO_ERROR);
+
+    TLV::TLVReader roundTripReader;
+    roundTripReader.Init(roundTripBuf, roundTripWriter.GetLengthWritten());
+    err = roundTripReader.Next();
+    NL_TEST_ASSERT(gSuite, err == CHIP_NO_ERROR);
+
+    std::string roundTrip;
+    err = TlvToJson(roundTripReader, roundTrip);
+    NL_TEST_ASSERT(gSuite, err == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(gSuite, roundTrip == streamed);
 }
 
 void TestConverter(nlTestSuite * inSuite, void * inContext)
@@ -188,6 +221,13 @@ void TestConverter(nlTestSuite * inSuite, void * inContext)
                       "   \"value\" : [ 1, 2, 3, 4 ]\n"
                       "}\n");
 
+    // Empty containers are converted to null.
+    DataModel::List<uint8_t> emptyList;
+    EncodeAndValidate(emptyList,
+                      "{\n"
+                      "   \"value\" : null\n"
+                      "}\n");
+
     Clusters::TestCluster::Structs::SimpleStruct::Type structListData[2] = { structVal, structVal };
     DataModel::List<Clusters::TestCluster::Structs::SimpleStruct::Type> structList;
 
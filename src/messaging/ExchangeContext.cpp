@@ -36,6 +36,7 @@
 #include <lib/core/CHIPEncoding.h>
 #include <lib/core/CHIPKeyIds.h>
 #include <lib/support/Defer.h>
+#include <lib/support/Metrics.h>
 #include <lib/support/TypeTraits.h>
 #include <lib/support/logging/CHIPLogging.h>
 #include <messaging/ApplicationExchangeDispatch.h>
@@ -57,6 +58,13 @@ using namespace chip::System;
 namespace chip {
 namespace Messaging {
 
+namespace {
+
+CHIP_METRIC_COUNTER(gExchangesOpened, "chip_messaging_exchanges_opened_total", "Exchanges opened");
+CHIP_METRIC_GAUGE(gExchanges, "chip_messaging_exchanges", "Exchanges open");
+
+} // namespace
+
 static void DefaultOnMessageReceived(ExchangeContext * ec, Protocols::Id protocolId, uint8_t msgType, uint32_t messageCounter,
                                      PacketBufferHandle && payload)
 {
@@ -324,6 +332,8 @@ ExchangeContext::ExchangeContext(ExchangeManager * em, uint16_t ExchangeId, cons
     mFlags.Set(Flags::kFlagEphemeralExchange, isEphemeralExchange);
     mDelegate = delegate;
 
+    em->AddToExchangeIndex(this);
+
     //
     // If we're an initiator and we just created this exchange, we obviously did so to send a message. Let's go ahead and
     // set the flag on this to correctly mark it as so.
@@ -346,6 +356,8 @@ ExchangeContext::ExchangeContext(ExchangeManager * em, uint16_t ExchangeId, cons
     ChipLogDetail(ExchangeManager, "ec++ id: " ChipLogFormatExchange, ChipLogValueExchange(this));
 #endif
     SYSTEM_STATS_INCREMENT(chip::System::Stats::kExchangeMgr_NumContexts);
+    CHIP_METRIC_INCREMENT(gExchangesOpened);
+    CHIP_METRIC_GAUGE_INCREMENT(gExchanges);
 }
 
 ExchangeContext::~ExchangeContext()
@@ -367,12 +379,14 @@ ExchangeContext::~ExchangeContext()
     // the boolean parameter passed to DoClose() should not matter.
 
     DoClose(false);
+    mExchangeMgr->RemoveFromExchangeIndex(this);
     mExchangeMgr = nullptr;
 
 #if defined(CHIP_EXCHANGE_CONTEXT_DETAIL_LOGGING)
     ChipLogDetail(ExchangeManager, "ec-- id: " ChipLogFormatExchange, ChipLogValueExchange(this));
 #endif
     SYSTEM_STATS_DECREMENT(chip::System::Stats::kExchangeMgr_NumContexts);
+    CHIP_METRIC_GAUGE_DECREMENT(gExchanges);
 }
 
 bool ExchangeContext::MatchExchange(const SessionHandle & session, const PacketHeader & packetHeader,
@@ -38,6 +38,7 @@
 #include <lib/core/CHIPEncoding.h>
 #include <lib/support/CHIPFaultInjection.h>
 #include <lib/support/CodeUtils.h>
+#include <lib/support/Metrics.h>
 #include <lib/support/logging/CHIPLogging.h>
 #include <messaging/ExchangeContext.h>
 #include <messaging/ExchangeMgr.h>
@@ -50,6 +51,12 @@ using namespace chip::System;
 namespace chip {
 namespace Messaging {
 
+namespace {
+
+CHIP_METRIC_POOL(gExchangePoolMetrics, "exchanges");
+
+} // namespace
+
 /**
  *  Constructor for the ExchangeManager class.
  *  It sets the state to kState_NotInitialized.
@@ -59,9 +66,10 @@ namespace Messaging {
  *    prior to use.
  *
  */
-ExchangeManager::ExchangeManager() : mReliableMessageMgr(mContextPool)
+ExchangeManager::ExchangeManager()
 {
     mState = State::kState_NotInitialized;
+    CHIP_METRIC_POOL_ATTACH(mContextPool, gExchangePoolMetrics);
 }
 
 CHIP_ERROR ExchangeManager::Init(SessionManager * sessionManager)
@@ -82,6 +90,7 @@ CHIP_ERROR ExchangeManager::Init(SessionManager * sessionManager)
         // then re-initializes without removing registered handlers.
         handler.Reset();
     }
+    mUMHandlerCount = 0;
 
     sessionManager->SetMessageDelegate(this);
 
@@ -142,28 +151,26 @@ CHIP_ERROR ExchangeManager::UnregisterUnsolicitedMessageHandlerForType(Protocols
 
 CHIP_ERROR ExchangeManager::RegisterUMH(Protocols::Id protocolId, int16_t msgType, UnsolicitedMessageHandler * handler)
 {
-    UnsolicitedMessageHandlerSlot * selected = nullptr;
-
-    for (auto & umh : UMHandlerPool)
+    const size_t index = LowerBoundUMH(protocolId, msgType);
+    if (index < mUMHandlerCount && UMHandlerPool[index].Matches(protocolId, msgType))
     {
-        if (!umh.IsInUse())
-        {
-            if (selected == nullptr)
-                selected = &umh;
-        }
-        else if (umh.Matches(protocolId, msgType))
-        {
-            umh.Handler = handler;
-            return CHIP_NO_ERROR;
-        }
+        UMHandlerPool[index].Handler = handler;
+        return CHIP_NO_ERROR;
     }
 
-    if (selected == nullptr)
+    if (mUMHandlerCount == ArraySize(UMHandlerPool))
         return CHIP_ERROR_TOO_MANY_UNSOLICITED_MESSAGE_HANDLERS;
 
-    selected->Handler     = handler;
-    selected->ProtocolId  = protocolId;
-    selected->MessageType = msgType;
+    for (size_t i = mUMHandlerCount; i > index; i--)
+    {
+        UMHandlerPool[i] = UMHandlerPool[i - 1];
+    }
+    mUMHandlerCount++;
+
+    UnsolicitedMessageHandlerSlot & selected = UMHandlerPool[index];
+    selected.Handler                         = handler;
+    selected.ProtocolId                      = protocolId;
+    selected.MessageType                     = msgType;
 
     SYSTEM_STATS_INCREMENT(chip::System::Stats::kExchangeMgr_NumUMHandlers);
 
@@ -172,17 +179,96 @@ CHIP_ERROR ExchangeManager::RegisterUMH(Protocols::Id protocolId, int16_t msgTyp
 
 CHIP_ERROR ExchangeManager::UnregisterUMH(Protocols::Id protocolId, int16_t msgType)
 {
-    for (auto & umh : UMHandlerPool)
+    const size_t index = LowerBoundUMH(protocolId, msgType);
+    if (index == mUMHandlerCount || !UMHandlerPool[index].Matches(protocolId, msgType))
+        return CHIP_ERROR_NO_UNSOLICITED_MESSAGE_HANDLER;
+
+    mUMHandlerCount--;
+    for (size_t i = index; i < mUMHandlerCount; i++)
     {
-        if (umh.IsInUse() && umh.Matches(protocolId, msgType))
+        UMHandlerPool[i] = UMHandlerPool[i + 1];
+    }
+    UMHandlerPool[mUMHandlerCount].Reset();
+
+    SYSTEM_STATS_DECREMENT(chip::System::Stats::kExchangeMgr_NumUMHandlers);
+    return CHIP_NO_ERROR;
+}
+
+size_t ExchangeManager::LowerBoundUMH(Protocols::Id protocolId, int16_t msgType) const
+{
+    size_t low  = 0;
+    size_t high = mUMHandlerCount;
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if (UMHandlerPool[middle].GoesBefore(protocolId, msgType))
         {
-            umh.Reset();
-            SYSTEM_STATS_DECREMENT(chip::System::Stats::kExchangeMgr_NumUMHandlers);
-            return CHIP_NO_ERROR;
+            low = middle + 1;
         }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+ExchangeManager::UnsolicitedMessageHandlerSlot * ExchangeManager::FindUMH(Protocols::Id protocolId, uint8_t msgType)
+{
+    // The kAnyMessageType handler of the protocol, if any, immediately precedes its other handlers
+    const size_t any = LowerBoundUMH(protocolId, kAnyMessageType);
+    VerifyOrReturnValue(any < mUMHandlerCount && UMHandlerPool[any].ProtocolId == protocolId, nullptr);
+
+    const size_t exact = LowerBoundUMH(protocolId, msgType);
+    if (exact < mUMHandlerCount && UMHandlerPool[exact].Matches(protocolId, msgType))
+    {
+        return &UMHandlerPool[exact];
+    }
+
+    return UMHandlerPool[any].Matches(protocolId, kAnyMessageType) ? &UMHandlerPool[any] : nullptr;
+}
+
+size_t ExchangeManager::ExchangeIndexBucket(uint16_t exchangeId, bool isInitiator)
+{
+    // Exchange ids are allocated sequentially, so consecutive exchanges land in different buckets
+    return ((static_cast<size_t>(exchangeId) << 1) | (isInitiator ? 1 : 0)) % kExchangeIndexBuckets;
+}
+
+void ExchangeManager::AddToExchangeIndex(ExchangeContext * ec)
+{
+    ExchangeContext *& head = mExchangeIndex[ExchangeIndexBucket(ec->GetExchangeId(), ec->IsInitiator())];
+    ec->mNextInIndex        = head;
+    head                    = ec;
+}
+
+void ExchangeManager::RemoveFromExchangeIndex(ExchangeContext * ec)
+{
+    ExchangeContext ** link = &mExchangeIndex[ExchangeIndexBucket(ec->GetExchangeId(), ec->IsInitiator())];
+    while (*link != nullptr && *link != ec)
+    {
+        link = &(*link)->mNextInIndex;
     }
 
-    return CHIP_ERROR_NO_UNSOLICITED_MESSAGE_HANDLER;
+    if (*link != nullptr)
+    {
+        *link            = ec->mNextInIndex;
+        ec->mNextInIndex = nullptr;
+    }
+}
+
+ExchangeContext * ExchangeManager::FindExchange(const SessionHandle & session, const PacketHeader & packetHeader,
+                                                const PayloadHeader & payloadHeader)
+{
+    // Messages sent by the initiator of an exchange go to the responder's context, and conversely
+    const size_t bucket = ExchangeIndexBucket(payloadHeader.GetExchangeID(), !payloadHeader.IsInitiator());
+    for (ExchangeContext * ec = mExchangeIndex[bucket]; ec != nullptr; ec = ec->mNextInIndex)
+    {
+        if (ec->MatchExchange(session, packetHeader, payloadHeader))
+        {
+            return ec;
+        }
+    }
+    return nullptr;
 }
 
 void ExchangeManager::OnMessageReceived(const PacketHeader & packetHeader, const PayloadHeader & payloadHeader,
@@ -238,23 +324,14 @@ void ExchangeManager::OnMessageReceived(const PacketHeader & packetHeader, const
     if (!packetHeader.IsGroupSession())
     {
         // Search for an existing exchange that the message applies to. If a match is found...
-        bool found = false;
-        mContextPool.ForEachActiveObject([&](auto * ec) {
-            if (ec->MatchExchange(session, packetHeader, payloadHeader))
-            {
-                ChipLogDetail(ExchangeManager, "Found matching exchange: " ChipLogFormatExchange ", Delegate: %p",
-                              ChipLogValueExchange(ec), ec->GetDelegate());
-
-                // Matched ExchangeContext; send to message handler.
-                ec->HandleMessage(packetHeader.GetMessageCounter(), payloadHeader, msgFlags, std::move(msgBuf));
-                found = true;
-                return Loop::Break;
-            }
-            return Loop::Continue;
-        });
-
-        if (found)
+        ExchangeContext * ec = FindExchange(session, packetHeader, payloadHeader);
+        if (ec != nullptr)
         {
+            ChipLogDetail(ExchangeManager, "Found matching exchange: " ChipLogFormatExchange ", Delegate: %p",
+                          ChipLogValueExchange(ec), ec->GetDelegate());
+
+            // Matched ExchangeContext; send to message handler.
+            ec->HandleMessage(packetHeader.GetMessageCounter(), payloadHeader, msgFlags, std::move(msgBuf));
             return;
         }
     }
@@ -279,22 +356,7 @@ void ExchangeManager::OnMessageReceived(const PacketHeader & packetHeader, const
     {
         // Search for an unsolicited message handler that can handle the message. Prefer handlers that can explicitly
         // handle the message type over handlers that handle all messages for a profile.
-        matchingUMH = nullptr;
-
-        for (auto & umh : UMHandlerPool)
-        {
-            if (umh.IsInUse() && payloadHeader.HasProtocol(umh.ProtocolId))
-            {
-                if (umh.MessageType == payloadHeader.GetMessageType())
-                {
-                    matchingUMH = &umh;
-                    break;
-                }
-
-                if (umh.MessageType == kAnyMessageType)
-                    matchingUMH = &umh;
-            }
-        }
+        matchingUMH = FindUMH(payloadHeader.GetProtocolID(), payloadHeader.GetMessageType());
     }
     // Discard the message if it isn't marked as being sent by an initiator and the message does not need to send
     // an ack to the peer.
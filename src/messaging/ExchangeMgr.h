@@ -193,6 +193,9 @@ public:
 
     size_t GetNumActiveExchanges() { return mContextPool.Allocated(); }
 
+    /// Largest number of exchanges that were active at the same time.
+    size_t GetPeakActiveExchanges() { return mContextPool.HighWaterMark(); }
+
 private:
     enum class State
     {
@@ -211,6 +214,13 @@ private:
         {
             return ProtocolId == aProtocolId && MessageType == aMessageType;
         }
+        // Order of the slots in UMHandlerPool: by protocol, then by message type, with the
+        // kAnyMessageType handler of a protocol first.
+        constexpr bool GoesBefore(Protocols::Id aProtocolId, int16_t aMessageType) const
+        {
+            return ProtocolId.ToFullyQualifiedSpecForm() < aProtocolId.ToFullyQualifiedSpecForm() ||
+                (ProtocolId == aProtocolId && MessageType < aMessageType);
+        }
 
         Protocols::Id ProtocolId;
         // Message types are normally 8-bit unsigned ints, but we use
@@ -230,14 +240,34 @@ private:
 
     ObjectPool<ExchangeContext, CHIP_CONFIG_MAX_EXCHANGE_CONTEXTS> mContextPool;
 
+    // Buckets of the exchanges keyed by exchange id and initiator flag, chained through
+    // ExchangeContext::mNextInIndex, so that incoming messages find their exchange without
+    // scanning the whole pool. The session of an exchange may be released during its lifetime,
+    // so it is not part of the bucket key but is compared by MatchExchange.
+    static constexpr size_t kExchangeIndexBuckets = CHIP_CONFIG_MAX_EXCHANGE_CONTEXTS;
+    ExchangeContext * mExchangeIndex[kExchangeIndexBuckets] = {};
+
     SessionManager * mSessionManager;
     ReliableMessageMgr mReliableMessageMgr;
 
+    // The first mUMHandlerCount slots are in use, sorted as per UnsolicitedMessageHandlerSlot::GoesBefore
     UnsolicitedMessageHandlerSlot UMHandlerPool[CHIP_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS];
+    size_t mUMHandlerCount = 0;
 
     CHIP_ERROR RegisterUMH(Protocols::Id protocolId, int16_t msgType, UnsolicitedMessageHandler * handler);
     CHIP_ERROR UnregisterUMH(Protocols::Id protocolId, int16_t msgType);
 
+    /// Index of the first handler slot which does not go before (protocolId, msgType)
+    size_t LowerBoundUMH(Protocols::Id protocolId, int16_t msgType) const;
+    /// The handler for messages of this type, or else the handler for the whole protocol
+    UnsolicitedMessageHandlerSlot * FindUMH(Protocols::Id protocolId, uint8_t msgType);
+
+    static size_t ExchangeIndexBucket(uint16_t exchangeId, bool isInitiator);
+    void AddToExchangeIndex(ExchangeContext * ec);
+    void RemoveFromExchangeIndex(ExchangeContext * ec);
+    ExchangeContext * FindExchange(const SessionHandle & session, const PacketHeader & packetHeader,
+                                   const PayloadHeader & payloadHeader);
+
     void OnMessageReceived(const PacketHeader & packetHeader, const PayloadHeader & payloadHeader, const SessionHandle & session,
                            DuplicateMessage isDuplicate, System::PacketBufferHandle && msgBuf) override;
     void SendStandaloneAckIfNeeded(const PacketHeader & packetHeader, const PayloadHeader & payloadHeader,
@@ -156,10 +156,10 @@ CHIP_ERROR ReliableMessageContext::HandleNeedsAckInner(uint32_t messageCounter,
         ReturnErrorOnFailure(SendStandaloneAckMessage());
     }
 
-    // Replace the Pending ack message counter.
-    SetPendingPeerAckMessageCounter(messageCounter);
+    // Replace the Pending ack message counter. The ack time is set first, so that the ack is queued by it.
     using namespace System::Clock::Literals;
     mNextAckTime = System::SystemClock().GetMonotonicTimestamp() + CHIP_CONFIG_RMP_DEFAULT_ACK_TIMEOUT;
+    SetPendingPeerAckMessageCounter(messageCounter);
     return CHIP_NO_ERROR;
 }
 
@@ -193,6 +193,20 @@ CHIP_ERROR ReliableMessageContext::SendStandaloneAckMessage()
     return err;
 }
 
+void ReliableMessageContext::SetAckPending(bool inAckPending)
+{
+    mFlags.Set(Flags::kFlagAckPending, inAckPending);
+
+    if (inAckPending)
+    {
+        GetReliableMessageMgr()->ScheduleAck(this);
+    }
+    else
+    {
+        Unlink();
+    }
+}
+
 void ReliableMessageContext::SetPendingPeerAckMessageCounter(uint32_t aPeerAckMessageCounter)
 {
     mPendingPeerAckMessageCounter = aPeerAckMessageCounter;
@@ -31,6 +31,7 @@
 #include <lib/core/CHIPError.h>
 #include <lib/core/ReferenceCounted.h>
 #include <lib/support/DLLUtil.h>
+#include <lib/support/IntrusiveList.h>
 #include <messaging/ReliableMessageProtocolConfig.h>
 #include <system/SystemLayer.h>
 #include <transport/raw/MessageHeader.h>
@@ -43,7 +44,8 @@ class ExchangeContext;
 enum class MessageFlagValues : uint32_t;
 class ReliableMessageMgr;
 
-class ReliableMessageContext
+// Linked, while an ack is pending, into the ReliableMessageMgr queue of standalone acks ordered by mNextAckTime.
+class ReliableMessageContext : public IntrusiveListNodeBase<IntrusiveMode::AutoUnlink>
 {
 public:
     ReliableMessageContext();
@@ -228,11 +230,6 @@ inline void ReliableMessageContext::SetAutoRequestAck(bool autoReqAck)
     mFlags.Set(Flags::kFlagAutoRequestAck, autoReqAck);
 }
 
-inline void ReliableMessageContext::SetAckPending(bool inAckPending)
-{
-    mFlags.Set(Flags::kFlagAckPending, inAckPending);
-}
-
 inline void ReliableMessageContext::SetMessageNotAcked(bool messageNotAcked)
 {
     mFlags.Set(Flags::kFlagMessageNotAcked, messageNotAcked);
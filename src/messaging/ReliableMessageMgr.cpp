@@ -28,13 +28,16 @@
 
 #include <lib/support/BitFlags.h>
 #include <lib/support/CHIPFaultInjection.h>
+#include <lib/support/CHIPMem.h>
 #include <lib/support/CodeUtils.h>
+#include <lib/support/Metrics.h>
 #include <lib/support/logging/CHIPLogging.h>
 #include <messaging/ErrorCategory.h>
 #include <messaging/ExchangeMessageDispatch.h>
 #include <messaging/ExchangeMgr.h>
 #include <messaging/Flags.h>
 #include <messaging/ReliableMessageContext.h>
+#include <messaging/ReliableMessageRttEstimator.h>
 #include <platform/ConnectivityManager.h>
 
 using namespace chip::System::Clock::Literals;
@@ -42,8 +45,19 @@ using namespace chip::System::Clock::Literals;
 namespace chip {
 namespace Messaging {
 
+namespace {
+
+CHIP_METRIC_COUNTER(gRetransmissions, "chip_mrp_retransmissions_total", "Messages retransmitted by MRP");
+CHIP_METRIC_COUNTER(gSendFailures, "chip_mrp_send_failures_total", "Messages not acknowledged after the maximum retransmissions");
+CHIP_METRIC_GAUGE(gRetransTableEntries, "chip_mrp_retrans_table_entries", "Messages waiting for an acknowledgement");
+CHIP_METRIC_POOL(gRetransPoolMetrics, "retrans_table");
+CHIP_METRIC_HISTOGRAM(gRoundTripTime, "chip_mrp_round_trip_time_ms", "Time to acknowledge messages sent only once", 10, 50, 100,
+                      250, 500, 1000, 2500, 5000);
+
+} // namespace
+
 ReliableMessageMgr::RetransTableEntry::RetransTableEntry(ReliableMessageContext * rc) :
-    ec(*rc->GetExchangeContext()), nextRetransTime(0), sendCount(0)
+    ec(*rc->GetExchangeContext()), nextRetransTime(0), firstSendTime(0), sendCount(0), queueIndex(kNotQueued)
 {
     ec->SetMessageNotAcked(true);
 }
@@ -53,11 +67,17 @@ ReliableMessageMgr::RetransTableEntry::~RetransTableEntry()
     ec->SetMessageNotAcked(false);
 }
 
-ReliableMessageMgr::ReliableMessageMgr(ObjectPool<ExchangeContext, CHIP_CONFIG_MAX_EXCHANGE_CONTEXTS> & contextPool) :
-    mContextPool(contextPool), mSystemLayer(nullptr)
-{}
+ReliableMessageMgr::ReliableMessageMgr() : mSystemLayer(nullptr)
+{
+    CHIP_METRIC_POOL_ATTACH(mRetransTable, gRetransPoolMetrics);
+}
 
-ReliableMessageMgr::~ReliableMessageMgr() {}
+ReliableMessageMgr::~ReliableMessageMgr()
+{
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    Platform::MemoryFree(mRetransQueue);
+#endif
+}
 
 void ReliableMessageMgr::Init(chip::System::Layer * systemLayer)
 {
@@ -70,10 +90,16 @@ void ReliableMessageMgr::Shutdown()
 
     // Clear the retransmit table
     mRetransTable.ForEachActiveObject([&](auto * entry) {
-        mRetransTable.ReleaseObject(entry);
+        ReleaseRetransEntry(entry);
         return Loop::Continue;
     });
 
+    // Exchanges outliving the manager keep their pending acks, but are no longer queued
+    while (!mAckQueue.Empty())
+    {
+        mAckQueue.Remove(&*mAckQueue.begin());
+    }
+
     mSystemLayer = nullptr;
 }
 
@@ -102,23 +128,34 @@ void ReliableMessageMgr::ExecuteActions()
     ChipLogDetail(ExchangeManager, "ReliableMessageMgr::ExecuteActions at % " PRIu64 "ms", now.count());
 #endif
 
-    ExecuteForAllContext([&](ReliableMessageContext * rc) {
-        if (rc->IsAckPending())
-        {
-            if (rc->mNextAckTime <= now)
-            {
+    // Sending an ack dequeues it, so the acks which are due are always at the head of the queue
+    const System::Clock::Timestamp ackDeadline = now + CHIP_CONFIG_RMP_STANDALONE_ACK_BATCH_WINDOW;
+    IntrusiveList<ReliableMessageContext, IntrusiveMode::AutoUnlink> unsentAcks;
+    while (!mAckQueue.Empty() && mAckQueue.begin()->mNextAckTime <= ackDeadline)
+    {
+        ReliableMessageContext * rc = &*mAckQueue.begin();
 #if defined(RMP_TICKLESS_DEBUG)
-                ChipLogDetail(ExchangeManager, "ReliableMessageMgr::ExecuteActions sending ACK %p", rc);
+        ChipLogDetail(ExchangeManager, "ReliableMessageMgr::ExecuteActions sending ACK %p", rc);
 #endif
-                rc->SendStandaloneAckMessage();
-            }
+        rc->SendStandaloneAckMessage();
+
+        if (!mAckQueue.Empty() && &*mAckQueue.begin() == rc)
+        {
+            // The ack could not be sent and is still pending: set it aside so that the next acks are sent, and retry it from
+            // the next timer tick.
+            mAckQueue.Remove(rc);
+            unsentAcks.PushBack(rc);
         }
-    });
+    }
+    while (!unsentAcks.Empty())
+    {
+        ScheduleAck(&*unsentAcks.begin());
+    }
 
     // Retransmit / cancel anything in the retrans table whose retrans timeout has expired
-    mRetransTable.ForEachActiveObject([&](auto * entry) {
-        if (entry->nextRetransTime > now)
-            return Loop::Continue;
+    while (mRetransQueueSize > 0 && mRetransQueue[0]->nextRetransTime <= now)
+    {
+        RetransTableEntry * entry = mRetransQueue[0];
 
         VerifyOrDie(!entry->retainedBuf.IsNull());
 
@@ -133,6 +170,7 @@ void ReliableMessageMgr::ExecuteActions()
                          "Failed to Send CHIP MessageCounter:" ChipLogFormatMessageCounter " on exchange " ChipLogFormatExchange
                          " sendCount: %u max retries: %d",
                          messageCounter, ChipLogValueExchange(&entry->ec.Get()), sendCount, CHIP_CONFIG_RMP_DEFAULT_MAX_RETRANS);
+            CHIP_METRIC_INCREMENT(gSendFailures);
 
             // Don't check whether the session in the exchange is valid, because when the session is released, the retrans entry is
             // cleared inside ExchangeContext::OnSessionReleased, so the session must be valid if the entry exists.
@@ -141,7 +179,13 @@ void ReliableMessageMgr::ExecuteActions()
             // If the exchange is expecting a response, it will handle sending
             // this notification once it detects that it has not gotten a
             // response.  Otherwise, we need to do it.
-            if (!entry->ec->IsResponseExpected())
+            bool notifySessionHang = !entry->ec->IsResponseExpected();
+
+            // Release the entry before notifying, as the notification may close the exchange, and with it the queue order.
+            // Do not StartTimer, we will schedule the timer at the end of the timer handler.
+            ReleaseRetransEntry(entry);
+
+            if (notifySessionHang)
             {
                 if (session->IsSecureSession() && session->AsSecureSession()->IsCASESession())
                 {
@@ -149,13 +193,11 @@ void ReliableMessageMgr::ExecuteActions()
                 }
                 session->DispatchSessionEvent(&SessionDelegate::OnSessionHang);
             }
-
-            // Do not StartTimer, we will schedule the timer at the end of the timer handler.
-            mRetransTable.ReleaseObject(entry);
-            return Loop::Continue;
+            continue;
         }
 
         entry->sendCount++;
+        CHIP_METRIC_INCREMENT(gRetransmissions);
         ChipLogDetail(ExchangeManager,
                       "Retransmitting MessageCounter:" ChipLogFormatMessageCounter " on exchange " ChipLogFormatExchange
                       " Send Cnt %d",
@@ -165,10 +207,9 @@ void ReliableMessageMgr::ExecuteActions()
         System::Clock::Timestamp baseTimeout = entry->ec->GetSessionHandle()->GetMRPBaseTimeout();
         System::Clock::Timestamp backoff     = ReliableMessageMgr::GetBackoff(baseTimeout, entry->sendCount);
         entry->nextRetransTime               = System::SystemClock().GetMonotonicTimestamp() + backoff;
+        ScheduleRetransmission(entry);
         SendFromRetransTable(entry);
-
-        return Loop::Continue;
-    });
+    }
 
     TicklessDebugDumpRetransTable("ReliableMessageMgr::ExecuteActions Dumping mRetransTable entries after processing");
 }
@@ -194,12 +235,20 @@ CHIP_ERROR ReliableMessageMgr::AddToRetransTable(ReliableMessageContext * rc, Re
 {
     VerifyOrDie(!rc->IsMessageNotAcked());
 
-    *rEntry = mRetransTable.CreateObject(rc);
+    // Every entry of the table can be queued for retransmission
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    if (mRetransTable.Allocated() >= mRetransQueueCapacity)
+    {
+        VerifyOrReturnError(GrowRetransQueue(), CHIP_ERROR_NO_MEMORY);
+    }
+#endif
+    *rEntry = (mRetransTable.Allocated() < mRetransQueueCapacity) ? mRetransTable.CreateObject(rc) : nullptr;
     if (*rEntry == nullptr)
     {
         ChipLogError(ExchangeManager, "mRetransTable Already Full");
         return CHIP_ERROR_RETRANS_TABLE_FULL;
     }
+    CHIP_METRIC_GAUGE_SET(gRetransTableEntries, mRetransTable.Allocated());
 
     return CHIP_NO_ERROR;
 }
@@ -270,7 +319,9 @@ void ReliableMessageMgr::StartRetransmision(RetransTableEntry * entry)
     // Choose active/idle timeout from PeerActiveMode of session per 4.11.2.1. Retransmissions.
     System::Clock::Timestamp baseTimeout = entry->ec->GetSessionHandle()->GetMRPBaseTimeout();
     System::Clock::Timestamp backoff     = ReliableMessageMgr::GetBackoff(baseTimeout, entry->sendCount);
-    entry->nextRetransTime               = System::SystemClock().GetMonotonicTimestamp() + backoff;
+    entry->firstSendTime                 = System::SystemClock().GetMonotonicTimestamp();
+    entry->nextRetransTime               = entry->firstSendTime + backoff;
+    ScheduleRetransmission(entry);
     StartTimer();
 }
 
@@ -280,6 +331,8 @@ bool ReliableMessageMgr::CheckAndRemRetransTable(ReliableMessageContext * rc, ui
     mRetransTable.ForEachActiveObject([&](auto * entry) {
         if (entry->ec->GetReliableMessageContext() == rc && entry->retainedBuf.GetMessageCounter() == ackMessageCounter)
         {
+            AddRttSample(*entry);
+
             // Clear the entry from the retransmision table.
             ClearRetransTable(*entry);
 
@@ -347,6 +400,25 @@ CHIP_ERROR ReliableMessageMgr::SendFromRetransTable(RetransTableEntry * entry)
     return err;
 }
 
+void ReliableMessageMgr::AddRttSample(const RetransTableEntry & entry)
+{
+    // Karn's algorithm: the ack of a retransmitted message may be for any of its transmissions
+    VerifyOrReturn(entry.sendCount == 0 && entry.ec->HasSessionHandle());
+
+    SessionHandle session = entry.ec->GetSessionHandle();
+    VerifyOrReturn(session->IsSecureSession());
+
+    System::Clock::Timestamp rtt            = System::SystemClock().GetMonotonicTimestamp() - entry.firstSendTime;
+    ReliableMessageRttEstimator & estimator = session->AsSecureSession()->GetRttEstimator();
+    estimator.AddSample(std::chrono::duration_cast<System::Clock::Milliseconds32>(rtt));
+    CHIP_METRIC_RECORD(gRoundTripTime, rtt.count());
+
+    ChipLogDetail(ExchangeManager,
+                  "RTT sample %" PRIu32 "ms on exchange " ChipLogFormatExchange ": srtt %" PRIu32 "ms rttvar %" PRIu32 "ms",
+                  static_cast<uint32_t>(rtt.count()), ChipLogValueExchange(&entry.ec.Get()), estimator.GetSmoothedRtt().count(),
+                  estimator.GetRttVariance().count());
+}
+
 void ReliableMessageMgr::ClearRetransTable(ReliableMessageContext * rc)
 {
     mRetransTable.ForEachActiveObject([&](auto * entry) {
@@ -361,7 +433,7 @@ void ReliableMessageMgr::ClearRetransTable(ReliableMessageContext * rc)
 
 void ReliableMessageMgr::ClearRetransTable(RetransTableEntry & entry)
 {
-    mRetransTable.ReleaseObject(&entry);
+    ReleaseRetransEntry(&entry);
     // Expire any virtual ticks that have expired so all wakeup sources reflect the current time
     StartTimer();
 }
@@ -370,22 +442,16 @@ void ReliableMessageMgr::StartTimer()
 {
     // When do we need to next wake up to send an ACK?
     System::Clock::Timestamp nextWakeTime = System::Clock::Timestamp::max();
-
-    ExecuteForAllContext([&](ReliableMessageContext * rc) {
-        if (rc->IsAckPending() && rc->mNextAckTime < nextWakeTime)
-        {
-            nextWakeTime = rc->mNextAckTime;
-        }
-    });
+    if (!mAckQueue.Empty())
+    {
+        nextWakeTime = mAckQueue.begin()->mNextAckTime;
+    }
 
     // When do we need to next wake up for ReliableMessageProtocol retransmit?
-    mRetransTable.ForEachActiveObject([&](auto * entry) {
-        if (entry->nextRetransTime < nextWakeTime)
-        {
-            nextWakeTime = entry->nextRetransTime;
-        }
-        return Loop::Continue;
-    });
+    if (mRetransQueueSize > 0 && mRetransQueue[0]->nextRetransTime < nextWakeTime)
+    {
+        nextWakeTime = mRetransQueue[0]->nextRetransTime;
+    }
 
     if (nextWakeTime != System::Clock::Timestamp::max())
     {
@@ -415,6 +481,117 @@ void ReliableMessageMgr::StopTimer()
     mSystemLayer->CancelTimer(Timeout, this);
 }
 
+void ReliableMessageMgr::ScheduleAck(ReliableMessageContext * rc)
+{
+    rc->Unlink();
+
+    // Search from the end, where new acks go
+    auto position = mAckQueue.end();
+    while (position != mAckQueue.begin())
+    {
+        auto previous = position;
+        --previous;
+        if (previous->mNextAckTime <= rc->mNextAckTime)
+        {
+            break;
+        }
+        position = previous;
+    }
+    mAckQueue.InsertBefore(position, rc);
+}
+
+void ReliableMessageMgr::ScheduleRetransmission(RetransTableEntry * entry)
+{
+    if (entry->queueIndex == kNotQueued)
+    {
+        // AddToRetransTable keeps the table within the queue capacity
+        VerifyOrDie(mRetransQueueSize < mRetransQueueCapacity);
+        entry->queueIndex                 = mRetransQueueSize;
+        mRetransQueue[mRetransQueueSize++] = entry;
+        SiftUp(entry->queueIndex);
+        return;
+    }
+
+    SiftUp(entry->queueIndex);
+    SiftDown(entry->queueIndex);
+}
+
+void ReliableMessageMgr::ReleaseRetransEntry(RetransTableEntry * entry)
+{
+    size_t index = entry->queueIndex;
+    if (index != kNotQueued)
+    {
+        mRetransQueueSize--;
+        if (index != mRetransQueueSize)
+        {
+            SwapQueueEntries(index, mRetransQueueSize);
+            SiftUp(index);
+            SiftDown(index);
+        }
+        entry->queueIndex = kNotQueued;
+    }
+    mRetransTable.ReleaseObject(entry);
+    CHIP_METRIC_GAUGE_SET(gRetransTableEntries, mRetransTable.Allocated());
+}
+
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+bool ReliableMessageMgr::GrowRetransQueue()
+{
+    size_t capacity = (mRetransQueueCapacity == 0) ? CHIP_CONFIG_RMP_RETRANS_TABLE_SIZE : 2 * mRetransQueueCapacity;
+    auto ** queue =
+        static_cast<RetransTableEntry **>(Platform::MemoryRealloc(mRetransQueue, capacity * sizeof(RetransTableEntry *)));
+    VerifyOrReturnValue(queue != nullptr, false);
+
+    mRetransQueue         = queue;
+    mRetransQueueCapacity = capacity;
+    return true;
+}
+#endif // CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+
+void ReliableMessageMgr::SwapQueueEntries(size_t a, size_t b)
+{
+    RetransTableEntry * entry    = mRetransQueue[a];
+    mRetransQueue[a]             = mRetransQueue[b];
+    mRetransQueue[b]             = entry;
+    mRetransQueue[a]->queueIndex = a;
+    mRetransQueue[b]->queueIndex = b;
+}
+
+void ReliableMessageMgr::SiftUp(size_t index)
+{
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+        if (mRetransQueue[parent]->nextRetransTime <= mRetransQueue[index]->nextRetransTime)
+        {
+            break;
+        }
+        SwapQueueEntries(index, parent);
+        index = parent;
+    }
+}
+
+void ReliableMessageMgr::SiftDown(size_t index)
+{
+    while (true)
+    {
+        size_t smallest = index;
+        for (size_t child = 2 * index + 1; child <= 2 * index + 2 && child < mRetransQueueSize; child++)
+        {
+            if (mRetransQueue[child]->nextRetransTime < mRetransQueue[smallest]->nextRetransTime)
+            {
+                smallest = child;
+            }
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        SwapQueueEntries(index, smallest);
+        index = smallest;
+    }
+}
+
 void ReliableMessageMgr::RegisterSessionUpdateDelegate(SessionUpdateDelegate * sessionUpdateDelegate)
 {
     mSessionUpdateDelegate = sessionUpdateDelegate;
@@ -458,6 +635,12 @@ int ReliableMessageMgr::TestGetCountRetransTable()
     });
     return count;
 }
+
+void ReliableMessageMgr::TestSetPendingAck(ReliableMessageContext * rc, uint32_t messageCounter, System::Clock::Timestamp ackTime)
+{
+    rc->mNextAckTime = ackTime;
+    rc->SetPendingPeerAckMessageCounter(messageCounter);
+}
 #endif // CHIP_CONFIG_TEST
 
 } // namespace Messaging
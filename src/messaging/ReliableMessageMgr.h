@@ -28,6 +28,7 @@
 
 #include <lib/core/CHIPError.h>
 #include <lib/support/BitFlags.h>
+#include <lib/support/IntrusiveList.h>
 #include <lib/support/Pool.h>
 #include <messaging/ExchangeContext.h>
 #include <messaging/ReliableMessageProtocolConfig.h>
@@ -63,20 +64,24 @@ public:
         ExchangeHandle ec;                        /**< The context for the stored CHIP message. */
         EncryptedPacketBufferHandle retainedBuf;  /**< The packet buffer holding the CHIP message. */
         System::Clock::Timestamp nextRetransTime; /**< A counter representing the next retransmission time for the message. */
+        System::Clock::Timestamp firstSendTime;   /**< When the message was first sent, to measure the round-trip time. */
         uint8_t sendCount;                        /**< The number of times we have tried to send this entry,
                                                        including both successfully and failure send. */
+        size_t queueIndex;                        /**< Position in the retransmission queue, kNotQueued until scheduled. */
     };
 
-    ReliableMessageMgr(ObjectPool<ExchangeContext, CHIP_CONFIG_MAX_EXCHANGE_CONTEXTS> & contextPool);
+    ReliableMessageMgr();
     ~ReliableMessageMgr();
 
     void Init(chip::System::Layer * systemLayer);
     void Shutdown();
 
     /**
-     * Iterate through active exchange contexts and retrans table entries.  If an
-     * action needs to be triggered by ReliableMessageProtocol time facilities,
-     * execute that action.
+     * Send the standalone acks and the retransmissions which are due. Only the
+     * due entries of the deadline-ordered queues are visited.
+     *
+     * Acks falling due within CHIP_CONFIG_RMP_STANDALONE_ACK_BATCH_WINDOW are
+     * sent along with the due ones, rather than after another wakeup.
      */
     void ExecuteActions();
 
@@ -158,10 +163,8 @@ public:
     void ClearRetransTable(RetransTableEntry & rEntry);
 
     /**
-     * Iterate through active exchange contexts and retrans table entries.
-     * Determine how many ReliableMessageProtocol ticks we need to sleep before we
-     * need to physically wake the CPU to perform an action.  Set a timer to go off
-     * when we next need to wake the system.
+     * Set a timer to go off at the earliest deadline among the pending acks and
+     * the retransmissions, which are the heads of their queues.
      *
      */
     void StartTimer();
@@ -192,27 +195,58 @@ public:
 #if CHIP_CONFIG_TEST
     // Functions for testing
     int TestGetCountRetransTable();
+    // The entry due first, or nullptr if no retransmission is scheduled
+    const RetransTableEntry * TestGetNextRetransmission() const { return mRetransQueueSize > 0 ? mRetransQueue[0] : nullptr; }
+    // Make [rc] owe an ack for [messageCounter], due at [ackTime]
+    void TestSetPendingAck(ReliableMessageContext * rc, uint32_t messageCounter, System::Clock::Timestamp ackTime);
+    // The context whose ack is due first, or nullptr if no ack is pending
+    const ReliableMessageContext * TestGetNextAck() { return mAckQueue.Empty() ? nullptr : &*mAckQueue.begin(); }
 #endif // CHIP_CONFIG_TEST
 
 private:
-    ObjectPool<ExchangeContext, CHIP_CONFIG_MAX_EXCHANGE_CONTEXTS> & mContextPool;
+    friend class ReliableMessageContext;
+
+    static constexpr size_t kNotQueued = SIZE_MAX;
+
     chip::System::Layer * mSystemLayer;
 
-    /* Placeholder function to run a function for all exchanges */
-    template <typename Function>
-    void ExecuteForAllContext(Function function)
-    {
-        mContextPool.ForEachActiveObject([&](auto * ec) {
-            function(ec->GetReliableMessageContext());
-            return Loop::Continue;
-        });
-    }
+    /// Queue the pending ack of [rc] by its mNextAckTime.
+    void ScheduleAck(ReliableMessageContext * rc);
+
+    /// Queue [entry] by its nextRetransTime, or move it after that time changed.
+    void ScheduleRetransmission(RetransTableEntry * entry);
+    void ReleaseRetransEntry(RetransTableEntry * entry);
+
+    /// Feed the round-trip time of the message of [entry], which was just acknowledged, to the estimator of its session.
+    void AddRttSample(const RetransTableEntry & entry);
+
+    // Binary min-heap operations on mRetransQueue
+    void SwapQueueEntries(size_t a, size_t b);
+    void SiftUp(size_t index);
+    void SiftDown(size_t index);
 
     void TicklessDebugDumpRetransTable(const char * log);
 
     // ReliableMessageProtocol Global tables for timer context
     ObjectPool<RetransTableEntry, CHIP_CONFIG_RMP_RETRANS_TABLE_SIZE> mRetransTable;
 
+    // Pending acks, by increasing mNextAckTime. Acks are almost always due a fixed delay after they are queued, so they
+    // are appended at the end.
+    IntrusiveList<ReliableMessageContext, IntrusiveMode::AutoUnlink> mAckQueue;
+
+    // Scheduled retransmissions, as a binary min-heap on nextRetransTime
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    // Grows along with the heap pool; allocated on first use.
+    bool GrowRetransQueue();
+
+    RetransTableEntry ** mRetransQueue = nullptr;
+    size_t mRetransQueueCapacity       = 0;
+#else
+    RetransTableEntry * mRetransQueue[CHIP_CONFIG_RMP_RETRANS_TABLE_SIZE];
+    size_t mRetransQueueCapacity = CHIP_CONFIG_RMP_RETRANS_TABLE_SIZE;
+#endif
+    size_t mRetransQueueSize = 0;
+
     SessionUpdateDelegate * mSessionUpdateDelegate = nullptr;
 };
 
@@ -71,6 +71,18 @@ namespace chip {
 #define CHIP_CONFIG_RMP_DEFAULT_ACK_TIMEOUT (200_ms32)
 #endif // CHIP_CONFIG_RMP_DEFAULT_ACK_TIMEOUT
 
+/**
+ *  @def CHIP_CONFIG_RMP_STANDALONE_ACK_BATCH_WINDOW
+ *
+ *  @brief
+ *    Standalone acks falling due within this delay after a due one are sent
+ *    along with it, so that acks received close together need a single wakeup.
+ *
+ */
+#ifndef CHIP_CONFIG_RMP_STANDALONE_ACK_BATCH_WINDOW
+#define CHIP_CONFIG_RMP_STANDALONE_ACK_BATCH_WINDOW (10_ms32)
+#endif // CHIP_CONFIG_RMP_STANDALONE_ACK_BATCH_WINDOW
+
 /**
  *  @def CHIP_CONFIG_RESOLVE_PEER_ON_FIRST_TRANSMIT_FAILURE
  *
@@ -91,6 +103,33 @@ namespace chip {
 #define CHIP_CONFIG_RESOLVE_PEER_ON_FIRST_TRANSMIT_FAILURE 0
 #endif // CHIP_CONFIG_RESOLVE_PEER_ON_FIRST_TRANSMIT_FAILURE
 
+/**
+ *  @def CHIP_CONFIG_MRP_RTT_ESTIMATION
+ *
+ *  @brief
+ *    When enabled, the round-trip time of each secure session is estimated
+ *    from the acknowledgments of its messages (see ReliableMessageRttEstimator),
+ *    and retransmissions to an active peer are timed from that estimate rather
+ *    than from the active interval the peer advertised.
+ *
+ *    The timeout stays between CHIP_CONFIG_MRP_RTT_MIN_RETRY_INTERVAL and the
+ *    idle interval of the peer, and is still backed off as the spec requires.
+ */
+#ifndef CHIP_CONFIG_MRP_RTT_ESTIMATION
+#define CHIP_CONFIG_MRP_RTT_ESTIMATION 0
+#endif // CHIP_CONFIG_MRP_RTT_ESTIMATION
+
+/**
+ *  @def CHIP_CONFIG_MRP_RTT_MIN_RETRY_INTERVAL
+ *
+ *  @brief
+ *    The lowest retransmission interval derived from a round-trip time estimate.
+ *
+ */
+#ifndef CHIP_CONFIG_MRP_RTT_MIN_RETRY_INTERVAL
+#define CHIP_CONFIG_MRP_RTT_MIN_RETRY_INTERVAL (50_ms32)
+#endif // CHIP_CONFIG_MRP_RTT_MIN_RETRY_INTERVAL
+
 /**
  *  @def CHIP_CONFIG_RMP_RETRANS_TABLE_SIZE
  *
@@ -0,0 +1,98 @@
+/*
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file defines the round-trip time estimator used for adaptive
+ *      retransmission timeouts of the CHIP reliable message protocol.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <stdint.h>
+
+#include <system/SystemClock.h>
+
+namespace chip {
+namespace Messaging {
+
+/**
+ *  @brief
+ *    Estimates the round-trip time to a peer from the time its acknowledgments
+ *    take, and derives a retransmission timeout from it, as TCP does (RFC 6298).
+ *
+ *    Only messages sent once may be sampled (Karn's algorithm): the ack of a
+ *    retransmitted message may be for any of its transmissions.
+ */
+class ReliableMessageRttEstimator
+{
+public:
+    /// Account for a message acknowledged [rtt] after it was sent.
+    void AddSample(System::Clock::Milliseconds32 rtt)
+    {
+        uint32_t sample = rtt.count();
+        if (mSampleCount == 0)
+        {
+            mSmoothedRttMs = sample;
+            mRttVarianceMs = sample / 2;
+        }
+        else
+        {
+            // RTTVAR <- 3/4 RTTVAR + 1/4 |SRTT - R|, then SRTT <- 7/8 SRTT + 1/8 R
+            uint32_t deviation = (sample > mSmoothedRttMs) ? (sample - mSmoothedRttMs) : (mSmoothedRttMs - sample);
+            mRttVarianceMs     = static_cast<uint32_t>((3 * static_cast<uint64_t>(mRttVarianceMs) + deviation) / 4);
+            mSmoothedRttMs     = static_cast<uint32_t>((7 * static_cast<uint64_t>(mSmoothedRttMs) + sample) / 8);
+        }
+        if (mSampleCount < UINT32_MAX)
+        {
+            mSampleCount++;
+        }
+    }
+
+    bool HasEstimate() const { return mSampleCount > 0; }
+    uint32_t GetSampleCount() const { return mSampleCount; }
+    System::Clock::Milliseconds32 GetSmoothedRtt() const { return System::Clock::Milliseconds32(mSmoothedRttMs); }
+    System::Clock::Milliseconds32 GetRttVariance() const { return System::Clock::Milliseconds32(mRttVarianceMs); }
+
+    /**
+     *  The retransmission timeout, SRTT + max(G, 4 * RTTVAR), within [minTimeout, maxTimeout].
+     *
+     *  Only meaningful once HasEstimate().
+     */
+    System::Clock::Milliseconds32 GetRetransmissionTimeout(System::Clock::Milliseconds32 minTimeout,
+                                                           System::Clock::Milliseconds32 maxTimeout) const
+    {
+        uint64_t timeoutMs = mSmoothedRttMs + std::max<uint64_t>(kClockGranularityMs, 4 * static_cast<uint64_t>(mRttVarianceMs));
+        timeoutMs          = std::max<uint64_t>(timeoutMs, minTimeout.count());
+        timeoutMs          = std::min<uint64_t>(timeoutMs, maxTimeout.count());
+        return System::Clock::Milliseconds32(static_cast<uint32_t>(timeoutMs));
+    }
+
+    void Reset() { *this = ReliableMessageRttEstimator(); }
+
+private:
+    // Resolution of the timers retransmissions are scheduled with
+    static constexpr uint32_t kClockGranularityMs = 10;
+
+    uint32_t mSmoothedRttMs = 0;
+    uint32_t mRttVarianceMs = 0;
+    uint32_t mSampleCount   = 0;
+};
+
+} // namespace Messaging
+} // namespace chip
@@ -29,6 +29,7 @@
 #include <lib/support/UnitTestUtils.h>
 #include <messaging/ReliableMessageContext.h>
 #include <messaging/ReliableMessageMgr.h>
+#include <messaging/ReliableMessageRttEstimator.h>
 #include <protocols/Protocols.h>
 #include <protocols/echo/Echo.h>
 #include <transport/SessionManager.h>
@@ -292,6 +293,199 @@ void CheckAddClearRetrans(nlTestSuite * inSuite, void * inContext)
     exchange->Close();
 }
 
+void CheckRetransQueueOrder(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx = *reinterpret_cast<TestContext *>(inContext);
+
+    constexpr size_t kExchangeCount = 4;
+
+    MockAppDelegate mockAppDelegate;
+    ReliableMessageMgr * rm = ctx.GetExchangeManager().GetReliableMessageMgr();
+    ExchangeContext * exchanges[kExchangeCount];
+    ReliableMessageMgr::RetransTableEntry * entries[kExchangeCount];
+
+    for (size_t i = 0; i < kExchangeCount; i++)
+    {
+        exchanges[i] = ctx.NewExchangeToAlice(&mockAppDelegate);
+        NL_TEST_ASSERT(inSuite, exchanges[i] != nullptr);
+        NL_TEST_ASSERT(inSuite, rm->AddToRetransTable(exchanges[i]->GetReliableMessageContext(), &entries[i]) == CHIP_NO_ERROR);
+        // Send counts with disjoint backoff ranges, so that the retransmission times differ
+        entries[i]->sendCount = static_cast<uint8_t>(kExchangeCount - i);
+        rm->StartRetransmision(entries[i]);
+    }
+
+    // Order the entries by retransmission time
+    for (size_t i = 0; i < kExchangeCount; i++)
+    {
+        for (size_t j = i + 1; j < kExchangeCount; j++)
+        {
+            if (entries[j]->nextRetransTime < entries[i]->nextRetransTime)
+            {
+                std::swap(entries[i], entries[j]);
+            }
+        }
+    }
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextRetransmission() == entries[0]);
+
+    // Removing an entry which is not due first keeps the head
+    rm->ClearRetransTable(*entries[2]);
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextRetransmission() == entries[0]);
+
+    // Removing the head exposes the next entry due
+    rm->ClearRetransTable(*entries[0]);
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextRetransmission() == entries[1]);
+    rm->ClearRetransTable(*entries[1]);
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextRetransmission() == entries[3]);
+    rm->ClearRetransTable(*entries[3]);
+
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextRetransmission() == nullptr);
+    NL_TEST_ASSERT(inSuite, rm->TestGetCountRetransTable() == 0);
+
+    for (auto * exchange : exchanges)
+    {
+        exchange->Close();
+    }
+}
+
+void CheckRetransTableGrows(nlTestSuite * inSuite, void * inContext)
+{
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    TestContext & ctx = *reinterpret_cast<TestContext *>(inContext);
+
+    // More messages in flight than the default table size, which only bounds static pools
+    constexpr size_t kExchangeCount = CHIP_CONFIG_RMP_RETRANS_TABLE_SIZE * 2 + 1;
+
+    MockAppDelegate mockAppDelegate;
+    ReliableMessageMgr * rm = ctx.GetExchangeManager().GetReliableMessageMgr();
+    ExchangeContext * exchanges[kExchangeCount];
+    ReliableMessageMgr::RetransTableEntry * entries[kExchangeCount];
+
+    for (size_t i = 0; i < kExchangeCount; i++)
+    {
+        exchanges[i] = ctx.NewExchangeToAlice(&mockAppDelegate);
+        NL_TEST_ASSERT(inSuite, exchanges[i] != nullptr);
+        NL_TEST_ASSERT(inSuite, rm->AddToRetransTable(exchanges[i]->GetReliableMessageContext(), &entries[i]) == CHIP_NO_ERROR);
+        rm->StartRetransmision(entries[i]);
+    }
+    NL_TEST_ASSERT(inSuite, rm->TestGetCountRetransTable() == static_cast<int>(kExchangeCount));
+
+    // The queue still yields the entries in retransmission time order
+    for (size_t i = 0; i < kExchangeCount; i++)
+    {
+        const ReliableMessageMgr::RetransTableEntry * next = rm->TestGetNextRetransmission();
+        NL_TEST_ASSERT(inSuite, next != nullptr);
+        for (auto * entry : entries)
+        {
+            NL_TEST_ASSERT(inSuite, entry == nullptr || next->nextRetransTime <= entry->nextRetransTime);
+        }
+        for (auto *& entry : entries)
+        {
+            if (entry == next)
+            {
+                rm->ClearRetransTable(*entry);
+                entry = nullptr;
+            }
+        }
+    }
+    NL_TEST_ASSERT(inSuite, rm->TestGetCountRetransTable() == 0);
+
+    for (auto * exchange : exchanges)
+    {
+        exchange->Close();
+    }
+#endif // CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+}
+
+/// Refuses to send standalone acks, which leaves them pending
+class AckRefusingDispatch : public Messaging::ApplicationExchangeDispatch
+{
+public:
+    bool MessagePermitted(Protocols::Id protocol, uint8_t type) override
+    {
+        return !(protocol == SecureChannel::Id && type == to_underlying(SecureChannel::MsgType::StandaloneAck));
+    }
+};
+
+class AckRefusingDelegate : public MockAppDelegate
+{
+public:
+    ExchangeMessageDispatch & GetMessageDispatch() override { return mMessageDispatch; }
+
+    AckRefusingDispatch mMessageDispatch;
+};
+
+void CheckStandaloneAckQueue(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx = *reinterpret_cast<TestContext *>(inContext);
+
+    MockAppDelegate mockAppDelegate;
+    ReliableMessageMgr * rm = ctx.GetExchangeManager().GetReliableMessageMgr();
+    auto & loopback         = ctx.GetLoopback();
+
+    ExchangeContext * late    = ctx.NewExchangeToAlice(&mockAppDelegate);
+    ExchangeContext * due     = ctx.NewExchangeToAlice(&mockAppDelegate);
+    ExchangeContext * batched = ctx.NewExchangeToAlice(&mockAppDelegate);
+    NL_TEST_ASSERT(inSuite, late != nullptr && due != nullptr && batched != nullptr);
+
+    // Acks are queued by due time, whatever the order they become pending in
+    const System::Clock::Timestamp now = System::SystemClock().GetMonotonicTimestamp();
+    rm->TestSetPendingAck(late->GetReliableMessageContext(), 1, now + CHIP_CONFIG_RMP_STANDALONE_ACK_BATCH_WINDOW + 1000_ms);
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextAck() == late->GetReliableMessageContext());
+    rm->TestSetPendingAck(batched->GetReliableMessageContext(), 2, now + CHIP_CONFIG_RMP_STANDALONE_ACK_BATCH_WINDOW / 2);
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextAck() == batched->GetReliableMessageContext());
+    rm->TestSetPendingAck(due->GetReliableMessageContext(), 3, now);
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextAck() == due->GetReliableMessageContext());
+
+    // The due ack is sent along with the one falling due within the batching window
+    loopback.mSentMessageCount = 0;
+    rm->ExecuteActions();
+    NL_TEST_ASSERT(inSuite, loopback.mSentMessageCount == 2);
+    NL_TEST_ASSERT(inSuite, !due->GetReliableMessageContext()->IsAckPending());
+    NL_TEST_ASSERT(inSuite, !batched->GetReliableMessageContext()->IsAckPending());
+    NL_TEST_ASSERT(inSuite, late->GetReliableMessageContext()->IsAckPending());
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextAck() == late->GetReliableMessageContext());
+
+    // Closing the exchange sends its ack
+    late->Close();
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextAck() == nullptr);
+    NL_TEST_ASSERT(inSuite, loopback.mSentMessageCount == 3);
+
+    due->Close();
+    batched->Close();
+    ctx.DrainAndServiceIO();
+}
+
+void CheckStandaloneAckSendFailure(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx = *reinterpret_cast<TestContext *>(inContext);
+
+    MockAppDelegate mockAppDelegate;
+    AckRefusingDelegate refusingDelegate;
+    ReliableMessageMgr * rm = ctx.GetExchangeManager().GetReliableMessageMgr();
+    auto & loopback         = ctx.GetLoopback();
+
+    ExchangeContext * refused = ctx.NewExchangeToAlice(&refusingDelegate);
+    ExchangeContext * next    = ctx.NewExchangeToAlice(&mockAppDelegate);
+    NL_TEST_ASSERT(inSuite, refused != nullptr && next != nullptr);
+
+    const System::Clock::Timestamp now = System::SystemClock().GetMonotonicTimestamp();
+    rm->TestSetPendingAck(refused->GetReliableMessageContext(), 1, now);
+    rm->TestSetPendingAck(next->GetReliableMessageContext(), 2, now + 1_ms);
+
+    // The ack which cannot be sent does not hold back the next one, and stays queued
+    loopback.mSentMessageCount = 0;
+    rm->ExecuteActions();
+    NL_TEST_ASSERT(inSuite, loopback.mSentMessageCount == 1);
+    NL_TEST_ASSERT(inSuite, !next->GetReliableMessageContext()->IsAckPending());
+    NL_TEST_ASSERT(inSuite, refused->GetReliableMessageContext()->IsAckPending());
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextAck() == refused->GetReliableMessageContext());
+
+    refused->Close();
+    next->Close();
+    ctx.DrainAndServiceIO();
+    NL_TEST_ASSERT(inSuite, rm->TestGetNextAck() == nullptr);
+}
+
 /**
  * Tests MRP retransmission logic with the following scenario:
  *
@@ -1646,6 +1840,40 @@ void CheckLostStandaloneAck(nlTestSuite * inSuite, void * inContext)
     NL_TEST_ASSERT(inSuite, rm->TestGetCountRetransTable() == 0);
 }
 
+void CheckRttEstimator(nlTestSuite * inSuite, void * inContext)
+{
+    using namespace System::Clock::Literals;
+
+    ReliableMessageRttEstimator estimator;
+    NL_TEST_ASSERT(inSuite, !estimator.HasEstimate());
+
+    // The first sample sets SRTT, and RTTVAR to half of it
+    estimator.AddSample(100_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetSmoothedRtt() == 100_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetRttVariance() == 50_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetRetransmissionTimeout(50_ms32, 5000_ms32) == 300_ms32);
+
+    // Steady samples shrink the variance, and with it the timeout
+    estimator.AddSample(100_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetSmoothedRtt() == 100_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetRttVariance() == 37_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetRetransmissionTimeout(50_ms32, 5000_ms32) == 248_ms32);
+
+    // The timeout stays within bounds
+    NL_TEST_ASSERT(inSuite, estimator.GetRetransmissionTimeout(50_ms32, 200_ms32) == 200_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetRetransmissionTimeout(400_ms32, 5000_ms32) == 400_ms32);
+
+    // A late sample raises both
+    estimator.AddSample(300_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetSmoothedRtt() == 125_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetRttVariance() == 77_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetRetransmissionTimeout(50_ms32, 5000_ms32) == 433_ms32);
+    NL_TEST_ASSERT(inSuite, estimator.GetSampleCount() == 3);
+
+    estimator.Reset();
+    NL_TEST_ASSERT(inSuite, !estimator.HasEstimate());
+}
+
 void CheckGetBackoff(nlTestSuite * inSuite, void * inContext)
 {
     // Run 3x iterations to thoroughly test random jitter always results in backoff within bounds.
@@ -1696,6 +1924,10 @@ int InitializeTestCase(void * inContext)
 const nlTest sTests[] =
 {
     NL_TEST_DEF("Test ReliableMessageMgr::CheckAddClearRetrans", CheckAddClearRetrans),
+    NL_TEST_DEF("Test ReliableMessageMgr::CheckRetransQueueOrder", CheckRetransQueueOrder),
+    NL_TEST_DEF("Test ReliableMessageMgr::CheckRetransTableGrows", CheckRetransTableGrows),
+    NL_TEST_DEF("Test ReliableMessageMgr::CheckStandaloneAckQueue", CheckStandaloneAckQueue),
+    NL_TEST_DEF("Test ReliableMessageMgr::CheckStandaloneAckSendFailure", CheckStandaloneAckSendFailure),
     NL_TEST_DEF("Test ReliableMessageMgr::CheckResendApplicationMessage", CheckResendApplicationMessage),
     NL_TEST_DEF("Test ReliableMessageMgr::CheckCloseExchangeAndResendApplicationMessage", CheckCloseExchangeAndResendApplicationMessage),
     NL_TEST_DEF("Test ReliableMessageMgr::CheckFailedMessageRetainOnSend", CheckFailedMessageRetainOnSend),
@@ -1713,6 +1945,7 @@ const nlTest sTests[] =
     NL_TEST_DEF("Test that dropping an application-level message with a piggyback ack works ok once both sides retransmit", CheckLostResponseWithPiggyback),
     NL_TEST_DEF("Test that an application-level response-to-response after a lost standalone ack to the initial message works", CheckLostStandaloneAck),
     NL_TEST_DEF("Test MRP backoff algorithm", CheckGetBackoff),
+    NL_TEST_DEF("Test MRP round-trip time estimation", CheckRttEstimator),
 
     NL_TEST_SENTINEL()
 };
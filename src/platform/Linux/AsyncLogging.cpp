@@ -0,0 +1,1019 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <platform/Linux/AsyncLogging.h>
+
+#include <lib/core/CHIPConfig.h>
+#include <lib/support/BufferReader.h>
+#include <lib/support/BufferWriter.h>
+#include <lib/support/CodeUtils.h>
+#include <lib/support/logging/CHIPLogging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace chip {
+namespace DeviceLayer {
+
+namespace {
+
+// A log record, as queued in the ring buffers (all little-endian):
+//   timestamp (us since the epoch, 8), thread id (4), category (1),
+//   module length (1) and name, format length (2) and format (not terminated),
+//   argument count (1) and arguments.
+// An argument is a tag and a value: 'i' int64, 'u' uint64, 'f' double (bits of),
+// 'p' uint64, or 's' with a length (2) and the string (not terminated).
+constexpr size_t kMaxRecordSize   = 2048;
+constexpr size_t kMaxFormatLength = 512;
+constexpr uint8_t kMaxArguments   = UINT8_MAX;
+
+static_assert(CHIP_ASYNC_LOG_RING_SIZE >= 4 * kMaxRecordSize, "Async log rings must hold a few records");
+
+// Binary log files start with kBinaryMagic, a version (1) and the process id (4),
+// followed by records made of a type (1), a payload length (4) and the payload:
+//   'F' defines a format: id (4), length (2) and format
+//   'L' is a log line: timestamp, thread id, category, module as above, format id (4), arguments as above
+//   'D' reports dropped lines: timestamp (8), count (8)
+constexpr char kBinaryMagic[]      = "CHIPBLOG";
+constexpr uint8_t kBinaryVersion   = 1;
+constexpr uint8_t kFormatRecord    = 'F';
+constexpr uint8_t kLogRecord       = 'L';
+constexpr uint8_t kDroppedRecord   = 'D';
+constexpr auto kWakeupInterval     = std::chrono::milliseconds(100);
+constexpr auto kFlushCheckInterval = std::chrono::milliseconds(1);
+
+enum class LengthModifier : uint8_t
+{
+    kNone,
+    kChar,
+    kShort,
+    kLong,
+    kLongLong,
+    kIntMax,
+    kSize,
+    kPtrDiff,
+    kLongDouble,
+};
+
+/// A printf conversion specification, between its '%' and its conversion specifier.
+struct Conversion
+{
+    char flags[8]         = {};
+    bool widthFromArg     = false;
+    int width             = -1;
+    bool precisionFromArg = false;
+    int precision         = -1;
+    LengthModifier length = LengthModifier::kNone;
+    char specifier        = '\0';
+};
+
+int ParseNumber(const char *& p, const char * end)
+{
+    int value = 0;
+    while (p < end && *p >= '0' && *p <= '9' && value < 100000)
+    {
+        value = value * 10 + (*p++ - '0');
+    }
+    return value;
+}
+
+/// Parse the conversion specification following a '%', and return where it ends.
+const char * ParseConversion(const char * p, const char * end, Conversion & conversion)
+{
+    size_t flagCount = 0;
+    while (p < end && strchr("-+ #0'", *p) != nullptr && *p != '\0')
+    {
+        if (flagCount < sizeof(conversion.flags) - 1)
+        {
+            conversion.flags[flagCount++] = *p;
+        }
+        p++;
+    }
+
+    if (p < end && *p == '*')
+    {
+        conversion.widthFromArg = true;
+        p++;
+    }
+    else if (p < end && *p >= '0' && *p <= '9')
+    {
+        conversion.width = ParseNumber(p, end);
+    }
+
+    if (p < end && *p == '.')
+    {
+        p++;
+        if (p < end && *p == '*')
+        {
+            conversion.precisionFromArg = true;
+            p++;
+        }
+        else
+        {
+            conversion.precision = ParseNumber(p, end);
+        }
+    }
+
+    if (p < end)
+    {
+        switch (*p)
+        {
+        case 'h':
+            p++;
+            conversion.length = LengthModifier::kShort;
+            if (p < end && *p == 'h')
+            {
+                p++;
+                conversion.length = LengthModifier::kChar;
+            }
+            break;
+        case 'l':
+            p++;
+            conversion.length = LengthModifier::kLong;
+            if (p < end && *p == 'l')
+            {
+                p++;
+                conversion.length = LengthModifier::kLongLong;
+            }
+            break;
+        case 'q':
+            p++;
+            conversion.length = LengthModifier::kLongLong;
+            break;
+        case 'j':
+            p++;
+            conversion.length = LengthModifier::kIntMax;
+            break;
+        case 'z':
+            p++;
+            conversion.length = LengthModifier::kSize;
+            break;
+        case 't':
+            p++;
+            conversion.length = LengthModifier::kPtrDiff;
+            break;
+        case 'L':
+            p++;
+            conversion.length = LengthModifier::kLongDouble;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (p < end)
+    {
+        conversion.specifier = *p++;
+    }
+    return p;
+}
+
+bool IsSignedSpecifier(char specifier)
+{
+    return specifier == 'd' || specifier == 'i' || specifier == 'c';
+}
+
+bool IsUnsignedSpecifier(char specifier)
+{
+    return strchr("ouxX", specifier) != nullptr && specifier != '\0';
+}
+
+bool IsFloatSpecifier(char specifier)
+{
+    return strchr("eEfFgGaA", specifier) != nullptr && specifier != '\0';
+}
+
+/**
+ * Append the arguments the conversions of [format, end) consume to a record.
+ *
+ * Capture stops at the first conversion it does not know the argument type
+ * of, or once the record is full: the rest of the line is printed unformatted.
+ */
+void ENFORCE_FORMAT(2, 0) CaptureArguments(Encoding::LittleEndian::BufferWriter & writer, const char * format, const char * end,
+                                           va_list args)
+{
+    const size_t countOffset = writer.WritePos();
+    uint8_t count            = 0;
+    writer.Put8(0);
+
+    // Tag and the largest value but strings
+    constexpr size_t kMaxValueSize = 1 + sizeof(uint64_t);
+
+    const char * p = format;
+    while (p < end && count < kMaxArguments - 2)
+    {
+        if (*p++ != '%')
+        {
+            continue;
+        }
+
+        Conversion conversion;
+        p = ParseConversion(p, end, conversion);
+        if (conversion.specifier == '%')
+        {
+            continue;
+        }
+        if (writer.Available() < 3 * kMaxValueSize)
+        {
+            break;
+        }
+
+        if (conversion.widthFromArg)
+        {
+            writer.Put8('i').Put64(static_cast<uint64_t>(static_cast<int64_t>(va_arg(args, int))));
+            count++;
+        }
+        if (conversion.precisionFromArg)
+        {
+            const int precision = va_arg(args, int);
+            writer.Put8('i').Put64(static_cast<uint64_t>(static_cast<int64_t>(precision)));
+            conversion.precision = precision;
+            count++;
+        }
+
+        const char specifier = conversion.specifier;
+        if (IsSignedSpecifier(specifier))
+        {
+            int64_t value;
+            switch (conversion.length)
+            {
+            case LengthModifier::kLong:
+                value = va_arg(args, long);
+                break;
+            case LengthModifier::kLongLong:
+                value = va_arg(args, long long);
+                break;
+            case LengthModifier::kIntMax:
+                value = va_arg(args, intmax_t);
+                break;
+            case LengthModifier::kSize:
+                value = va_arg(args, ssize_t);
+                break;
+            case LengthModifier::kPtrDiff:
+                value = va_arg(args, ptrdiff_t);
+                break;
+            case LengthModifier::kChar:
+                value = static_cast<signed char>(va_arg(args, int));
+                break;
+            case LengthModifier::kShort:
+                value = static_cast<short>(va_arg(args, int));
+                break;
+            default:
+                value = va_arg(args, int);
+                break;
+            }
+            writer.Put8('i').Put64(static_cast<uint64_t>(value));
+        }
+        else if (IsUnsignedSpecifier(specifier))
+        {
+            uint64_t value;
+            switch (conversion.length)
+            {
+            case LengthModifier::kLong:
+                value = va_arg(args, unsigned long);
+                break;
+            case LengthModifier::kLongLong:
+                value = va_arg(args, unsigned long long);
+                break;
+            case LengthModifier::kIntMax:
+                value = va_arg(args, uintmax_t);
+                break;
+            case LengthModifier::kSize:
+                value = va_arg(args, size_t);
+                break;
+            case LengthModifier::kPtrDiff:
+                value = static_cast<uint64_t>(va_arg(args, ptrdiff_t));
+                break;
+            case LengthModifier::kChar:
+                value = static_cast<unsigned char>(va_arg(args, unsigned int));
+                break;
+            case LengthModifier::kShort:
+                value = static_cast<unsigned short>(va_arg(args, unsigned int));
+                break;
+            default:
+                value = va_arg(args, unsigned int);
+                break;
+            }
+            writer.Put8('u').Put64(value);
+        }
+        else if (IsFloatSpecifier(specifier))
+        {
+            double value;
+            if (conversion.length == LengthModifier::kLongDouble)
+            {
+                value = static_cast<double>(va_arg(args, long double));
+            }
+            else
+            {
+                value = va_arg(args, double);
+            }
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            writer.Put8('f').Put64(bits);
+        }
+        else if (specifier == 'p')
+        {
+            writer.Put8('p').Put64(reinterpret_cast<uintptr_t>(va_arg(args, void *)));
+        }
+        else if (specifier == 's' && conversion.length == LengthModifier::kNone)
+        {
+            const char * string = va_arg(args, const char *);
+            if (string == nullptr)
+            {
+                string = "(null)";
+            }
+            // Keep room for the remaining conversions
+            size_t maxLength = std::min<size_t>(writer.Available() - 3 * kMaxValueSize, UINT16_MAX);
+            if (conversion.precision >= 0)
+            {
+                maxLength = std::min<size_t>(maxLength, static_cast<size_t>(conversion.precision));
+            }
+            const size_t length = strnlen(string, maxLength);
+            writer.Put8('s').Put16(static_cast<uint16_t>(length)).Put(string, length);
+        }
+        else if (specifier == 'n')
+        {
+            // Nothing is written at the time of the call
+            (void) va_arg(args, void *);
+            continue;
+        }
+        else
+        {
+            // Wide characters and strings, and unknown conversions
+            break;
+        }
+        count++;
+    }
+
+    // The record always has room for its header
+    writer.Buffer()[countOffset] = count;
+}
+
+/// Bounded, always terminated, output line.
+class LineBuilder
+{
+public:
+    LineBuilder(char * buffer, size_t size) : mBuffer(buffer), mSize(size) { mBuffer[0] = '\0'; }
+
+    void Append(const char * text, size_t length)
+    {
+        length = std::min(length, mSize - 1 - mLength);
+        memcpy(mBuffer + mLength, text, length);
+        mLength += length;
+        mBuffer[mLength] = '\0';
+    }
+
+    void ENFORCE_FORMAT(2, 3) AppendFormat(const char * format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        const int written = vsnprintf(mBuffer + mLength, mSize - mLength, format, args);
+        va_end(args);
+        if (written > 0)
+        {
+            mLength = std::min(mLength + static_cast<size_t>(written), mSize - 1);
+        }
+    }
+
+    size_t Length() const { return mLength; }
+
+private:
+    char * mBuffer;
+    size_t mSize;
+    size_t mLength = 0;
+};
+
+/// Format a line from the format and the arguments of a record, as printf would have.
+void FormatArguments(LineBuilder & line, const char * format, const char * end, Encoding::LittleEndian::Reader & reader,
+                     uint8_t count)
+{
+    const char * p = format;
+    while (p < end)
+    {
+        const char * percent = static_cast<const char *>(memchr(p, '%', static_cast<size_t>(end - p)));
+        if (percent == nullptr)
+        {
+            line.Append(p, static_cast<size_t>(end - p));
+            return;
+        }
+        line.Append(p, static_cast<size_t>(percent - p));
+
+        Conversion conversion;
+        const char * next = ParseConversion(percent + 1, end, conversion);
+        if (conversion.specifier == '%')
+        {
+            line.Append("%", 1);
+            p = next;
+            continue;
+        }
+        if (conversion.specifier == 'n')
+        {
+            p = next;
+            continue;
+        }
+
+        const uint8_t needed = static_cast<uint8_t>(1 + (conversion.widthFromArg ? 1 : 0) + (conversion.precisionFromArg ? 1 : 0));
+        if (count < needed)
+        {
+            // Not captured: print the rest as is
+            line.Append(percent, static_cast<size_t>(end - percent));
+            return;
+        }
+        count = static_cast<uint8_t>(count - needed);
+
+        uint8_t tag;
+        uint64_t value;
+        if (conversion.widthFromArg)
+        {
+            VerifyOrReturn(reader.Read8(&tag).Read64(&value).StatusCode() == CHIP_NO_ERROR);
+            conversion.width = static_cast<int>(static_cast<int64_t>(value));
+        }
+        if (conversion.precisionFromArg)
+        {
+            VerifyOrReturn(reader.Read8(&tag).Read64(&value).StatusCode() == CHIP_NO_ERROR);
+            conversion.precision = static_cast<int>(static_cast<int64_t>(value));
+        }
+
+        // Rebuild the specification for the type the argument was captured as
+        char spec[32];
+        LineBuilder specBuilder(spec, sizeof(spec));
+        specBuilder.AppendFormat("%%%s", conversion.flags);
+        if (conversion.width >= 0)
+        {
+            specBuilder.AppendFormat("%d", conversion.width);
+        }
+        else if (conversion.width < -1)
+        {
+            // A negative width from an argument is a '-' flag
+            specBuilder.AppendFormat("-%d", -conversion.width);
+        }
+        if (conversion.precision >= 0)
+        {
+            specBuilder.AppendFormat(".%d", conversion.precision);
+        }
+
+        VerifyOrReturn(reader.Read8(&tag).StatusCode() == CHIP_NO_ERROR);
+        if (tag != 's')
+        {
+            VerifyOrReturn(reader.Read64(&value).StatusCode() == CHIP_NO_ERROR);
+        }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+        switch (tag)
+        {
+        case 'i':
+            if (conversion.specifier == 'c')
+            {
+                specBuilder.AppendFormat("c");
+                line.AppendFormat(spec, static_cast<int>(static_cast<int64_t>(value)));
+            }
+            else
+            {
+                specBuilder.AppendFormat("ll%c", conversion.specifier);
+                line.AppendFormat(spec, static_cast<long long>(value));
+            }
+            break;
+        case 'u':
+            specBuilder.AppendFormat("ll%c", conversion.specifier);
+            line.AppendFormat(spec, static_cast<unsigned long long>(value));
+            break;
+        case 'f': {
+            double number;
+            memcpy(&number, &value, sizeof(number));
+            specBuilder.AppendFormat("%c", conversion.specifier);
+            line.AppendFormat(spec, number);
+            break;
+        }
+        case 'p':
+            specBuilder.AppendFormat("p");
+            line.AppendFormat(spec, reinterpret_cast<void *>(static_cast<uintptr_t>(value)));
+            break;
+        case 's': {
+            uint16_t length = 0;
+            char string[kMaxRecordSize + 1];
+            VerifyOrReturn(reader.Read16(&length).StatusCode() == CHIP_NO_ERROR && length <= kMaxRecordSize);
+            VerifyOrReturn(reader.ReadBytes(reinterpret_cast<uint8_t *>(string), length).StatusCode() == CHIP_NO_ERROR);
+            string[length] = '\0';
+            specBuilder.AppendFormat("s");
+            line.AppendFormat(spec, string);
+            break;
+        }
+        default:
+            return;
+        }
+#pragma GCC diagnostic pop
+
+        p = next;
+    }
+}
+
+/// The fields of a queued record preceding its arguments.
+struct RecordHeader
+{
+    uint64_t timestampUs;
+    uint32_t threadId;
+    uint8_t category;
+    char module[Logging::kMaxModuleNameLen + 1];
+    char format[kMaxFormatLength + 1];
+    uint16_t formatLength;
+    uint8_t argumentCount;
+};
+
+bool ReadRecordHeader(Encoding::LittleEndian::Reader & reader, RecordHeader & header)
+{
+    uint8_t moduleLength = 0;
+    CHIP_ERROR err =
+        reader.Read64(&header.timestampUs).Read32(&header.threadId).Read8(&header.category).Read8(&moduleLength).StatusCode();
+    VerifyOrReturnValue(err == CHIP_NO_ERROR && moduleLength <= Logging::kMaxModuleNameLen, false);
+    err = reader.ReadBytes(reinterpret_cast<uint8_t *>(header.module), moduleLength).Read16(&header.formatLength).StatusCode();
+    VerifyOrReturnValue(err == CHIP_NO_ERROR && header.formatLength <= kMaxFormatLength, false);
+    header.module[moduleLength] = '\0';
+    err = reader.ReadBytes(reinterpret_cast<uint8_t *>(header.format), header.formatLength)
+              .Read8(&header.argumentCount)
+              .StatusCode();
+    header.format[header.formatLength] = '\0';
+    return err == CHIP_NO_ERROR;
+}
+
+uint64_t NowUs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + static_cast<uint64_t>(now.tv_nsec) / 1000;
+}
+
+long long sProcessId;
+
+} // namespace
+
+/**
+ * Single producer, single consumer queue of records, in a ring buffer.
+ *
+ * Each record is preceded by its size (2 bytes); head and tail grow without
+ * wrapping, and are reduced modulo the ring size on access.
+ */
+class AsyncLogRing
+{
+public:
+    static constexpr size_t kSize = CHIP_ASYNC_LOG_RING_SIZE;
+    static_assert((kSize & (kSize - 1)) == 0, "CHIP_ASYNC_LOG_RING_SIZE must be a power of two");
+
+    /// Owning thread only.
+    bool Push(const uint8_t * record, uint16_t size)
+    {
+        const size_t head = mHead.Value.load(std::memory_order_relaxed);
+        const size_t tail = mTail.Value.load(std::memory_order_acquire);
+        if (kSize - (head - tail) < sizeof(size) + size)
+        {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        CopyIn(head, &size, sizeof(size));
+        CopyIn(head + sizeof(size), record, size);
+        mHead.Value.store(head + sizeof(size) + size, std::memory_order_release);
+        return true;
+    }
+
+    /// With the output mutex held only. Returns the size of the record popped, or 0 if empty.
+    size_t Pop(uint8_t * record)
+    {
+        const size_t tail = mTail.Value.load(std::memory_order_relaxed);
+        const size_t head = mHead.Value.load(std::memory_order_acquire);
+        if (head == tail)
+        {
+            return 0;
+        }
+
+        uint16_t size;
+        CopyOut(tail, &size, sizeof(size));
+        CopyOut(tail + sizeof(size), record, size);
+        mTail.Value.store(tail + sizeof(size) + size, std::memory_order_release);
+        return size;
+    }
+
+    uint64_t GetDroppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+    std::atomic<bool> mInUse{ true };
+    AsyncLogRing * mNext = nullptr;
+
+private:
+    void CopyIn(size_t position, const void * data, size_t size)
+    {
+        const size_t offset = position & (kSize - 1);
+        const size_t first  = std::min(size, kSize - offset);
+        memcpy(&mBuffer[offset], data, first);
+        memcpy(&mBuffer[0], static_cast<const uint8_t *>(data) + first, size - first);
+    }
+
+    void CopyOut(size_t position, void * data, size_t size) const
+    {
+        const size_t offset = position & (kSize - 1);
+        const size_t first  = std::min(size, kSize - offset);
+        memcpy(data, &mBuffer[offset], first);
+        memcpy(static_cast<uint8_t *>(data) + first, &mBuffer[0], size - first);
+    }
+
+    // An index padded to a cache line of its own, as the head and the tail are written by different
+    // threads; alignas would not be honored by operator new before C++17.
+    struct PaddedIndex
+    {
+        std::atomic<size_t> Value{ 0 };
+        uint8_t Padding[64 - sizeof(std::atomic<size_t>)];
+    };
+
+    PaddedIndex mHead;
+    PaddedIndex mTail;
+    std::atomic<uint64_t> mDropped{ 0 };
+    uint8_t mBuffer[kSize];
+};
+
+namespace {
+
+/// The ring of the current thread, given back for reuse when the thread exits.
+struct ThreadRing
+{
+    ~ThreadRing()
+    {
+        if (ring != nullptr)
+        {
+            ring->mInUse.store(false, std::memory_order_release);
+        }
+    }
+
+    AsyncLogRing * ring = nullptr;
+    uint32_t threadId   = 0;
+};
+
+thread_local ThreadRing sThreadRing;
+
+} // namespace
+
+AsyncLogger & AsyncLogger::Instance()
+{
+    static AsyncLogger sInstance;
+    return sInstance;
+}
+
+bool AsyncLogger::IsEnabled()
+{
+    static const bool sEnabled = [] {
+        const char * value = getenv("CHIP_ASYNC_LOGGING");
+        return value != nullptr ? strcmp(value, "0") != 0 : CHIP_USE_ASYNC_LOGGING;
+    }();
+    return sEnabled;
+}
+
+void AsyncLogger::Log(const char * module, uint8_t category, const char * format, va_list args)
+{
+    std::call_once(mStartOnce, [this] { Start(); });
+
+    ThreadRing & threadRing = sThreadRing;
+    if (threadRing.ring == nullptr)
+    {
+        threadRing.ring     = AcquireRing();
+        threadRing.threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+    }
+
+    uint8_t record[kMaxRecordSize];
+    Encoding::LittleEndian::BufferWriter writer(record, sizeof(record));
+
+    const size_t moduleLength = strnlen(module, Logging::kMaxModuleNameLen);
+    const size_t formatLength = strnlen(format, kMaxFormatLength);
+    writer.Put64(NowUs()).Put32(threadRing.threadId).Put8(category);
+    writer.Put8(static_cast<uint8_t>(moduleLength)).Put(module, moduleLength);
+    writer.Put16(static_cast<uint16_t>(formatLength)).Put(format, formatLength);
+    CaptureArguments(writer, format, format + formatLength, args);
+
+    size_t size;
+    VerifyOrReturn(writer.Fit(size));
+    if (category == Logging::kLogCategory_Error)
+    {
+        WriteNow(record, size);
+        return;
+    }
+
+    if (threadRing.ring->Push(record, static_cast<uint16_t>(size)))
+    {
+        // Only enters the kernel if the background thread waits
+        sem_post(&mWakeup);
+    }
+}
+
+CHIP_ERROR AsyncLogger::SetBinaryOutput(const char * path)
+{
+    std::call_once(mStartOnce, [this] { Start(); });
+    return OpenBinaryOutput(path);
+}
+
+CHIP_ERROR AsyncLogger::OpenBinaryOutput(const char * path)
+{
+    FILE * file = fopen(path, "wb");
+    VerifyOrReturnError(file != nullptr, CHIP_ERROR_OPEN_FAILED);
+
+    uint8_t header[sizeof(kBinaryMagic) - 1 + 1 + 4];
+    Encoding::LittleEndian::BufferWriter writer(header, sizeof(header));
+    writer.Put(kBinaryMagic, sizeof(kBinaryMagic) - 1).Put8(kBinaryVersion).Put32(static_cast<uint32_t>(sProcessId));
+    if (fwrite(header, sizeof(header), 1, file) != 1)
+    {
+        fclose(file);
+        return CHIP_ERROR_WRITE_FAILED;
+    }
+
+    // Lines queued so far still go to the previous output
+    Flush();
+
+    std::lock_guard<std::mutex> lock(mOutputMutex);
+    if (mBinaryOutput != nullptr)
+    {
+        fclose(mBinaryOutput);
+    }
+    mBinaryOutput = file;
+    mFormatIds.clear();
+    return CHIP_NO_ERROR;
+}
+
+void AsyncLogger::Flush()
+{
+    VerifyOrReturn(mRunning.load());
+    VerifyOrReturn(std::this_thread::get_id() != mThread.get_id());
+
+    // A pass which started after this call drained everything queued before it
+    const uint64_t target = mDrainedPasses.load() + 2;
+    while (mRunning.load() && mDrainedPasses.load() < target)
+    {
+        sem_post(&mWakeup);
+        std::this_thread::sleep_for(kFlushCheckInterval);
+    }
+}
+
+uint64_t AsyncLogger::GetDroppedCount() const
+{
+    uint64_t dropped = 0;
+    for (AsyncLogRing * ring = mRings.load(std::memory_order_acquire); ring != nullptr; ring = ring->mNext)
+    {
+        dropped += ring->GetDroppedCount();
+    }
+    return dropped;
+}
+
+void AsyncLogger::Start()
+{
+    sProcessId = static_cast<long long>(syscall(SYS_getpid));
+    sem_init(&mWakeup, 0, 0);
+    mRunning = true;
+    mThread  = std::thread([this] { Run(); });
+
+    const char * path = getenv("CHIP_BINARY_LOG_FILE");
+    if (path != nullptr && OpenBinaryOutput(path) != CHIP_NO_ERROR)
+    {
+        fprintf(stderr, "Failed to open binary log file %s\n", path);
+    }
+
+    // Lines logged until the process exits are written
+    atexit(StopAtExit);
+}
+
+void AsyncLogger::Stop()
+{
+    VerifyOrReturn(mRunning.exchange(false));
+    sem_post(&mWakeup);
+    mThread.join();
+
+    std::lock_guard<std::mutex> lock(mOutputMutex);
+    if (mBinaryOutput != nullptr)
+    {
+        fclose(mBinaryOutput);
+        mBinaryOutput = nullptr;
+    }
+}
+
+void AsyncLogger::StopAtExit()
+{
+    Instance().Stop();
+}
+
+AsyncLogRing * AsyncLogger::AcquireRing()
+{
+    for (AsyncLogRing * ring = mRings.load(std::memory_order_acquire); ring != nullptr; ring = ring->mNext)
+    {
+        bool inUse = false;
+        if (ring->mInUse.compare_exchange_strong(inUse, true, std::memory_order_acquire))
+        {
+            return ring;
+        }
+    }
+
+    AsyncLogRing * ring = new AsyncLogRing();
+    ring->mNext         = mRings.load(std::memory_order_relaxed);
+    while (!mRings.compare_exchange_weak(ring->mNext, ring, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    return ring;
+}
+
+void AsyncLogger::Run()
+{
+    bool running = true;
+    while (running)
+    {
+        // Read before draining, so that lines queued before Stop() are written
+        running = mRunning.load();
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += std::chrono::duration_cast<std::chrono::nanoseconds>(kWakeupInterval).count();
+        deadline.tv_sec += deadline.tv_nsec / 1000000000;
+        deadline.tv_nsec %= 1000000000;
+        if (running)
+        {
+            sem_timedwait(&mWakeup, &deadline);
+        }
+
+        // Pushes post once per line: consume the posts this pass covers
+        while (sem_trywait(&mWakeup) == 0)
+        {
+        }
+
+        Drain();
+        mDrainedPasses++;
+    }
+}
+
+bool AsyncLogger::Drain()
+{
+    std::lock_guard<std::mutex> lock(mOutputMutex);
+
+    const bool wrote = DrainRings();
+    if (wrote)
+    {
+        fflush(mBinaryOutput != nullptr ? mBinaryOutput : stdout);
+    }
+    return wrote;
+}
+
+void AsyncLogger::WriteNow(const uint8_t * record, size_t size)
+{
+    std::lock_guard<std::mutex> lock(mOutputMutex);
+
+    // The lines queued so far come first, and the process may abort() right after this line
+    DrainRings();
+    WriteRecord(record, size);
+    fflush(mBinaryOutput != nullptr ? mBinaryOutput : stdout);
+}
+
+bool AsyncLogger::DrainRings()
+{
+    bool wrote = false;
+    uint8_t record[kMaxRecordSize];
+    for (AsyncLogRing * ring = mRings.load(std::memory_order_acquire); ring != nullptr; ring = ring->mNext)
+    {
+        size_t size;
+        while ((size = ring->Pop(record)) != 0)
+        {
+            WriteRecord(record, size);
+            wrote = true;
+        }
+    }
+
+    const uint64_t dropped = GetDroppedCount();
+    if (dropped != mReportedDrops)
+    {
+        WriteDropped(dropped - mReportedDrops);
+        mReportedDrops = dropped;
+        wrote          = true;
+    }
+    return wrote;
+}
+
+void AsyncLogger::WriteRecord(const uint8_t * record, size_t size)
+{
+    if (mBinaryOutput != nullptr)
+    {
+        WriteBinaryRecord(record, size);
+    }
+    else
+    {
+        WriteTextRecord(record, size);
+    }
+}
+
+void AsyncLogger::WriteTextRecord(const uint8_t * record, size_t size)
+{
+    Encoding::LittleEndian::Reader reader(record, size);
+    RecordHeader header;
+    VerifyOrReturn(ReadRecordHeader(reader, header));
+
+    char text[kMaxRecordSize + 64];
+    LineBuilder line(text, sizeof(text));
+    line.AppendFormat("[%" PRIu64 ".%06" PRIu64 "][%lld:%lu] CHIP:%s: ", header.timestampUs / 1000000,
+                      header.timestampUs % 1000000, sProcessId, static_cast<unsigned long>(header.threadId), header.module);
+    FormatArguments(line, header.format, header.format + header.formatLength, reader, header.argumentCount);
+    line.Append("\n", 1);
+    fwrite(text, 1, line.Length(), stdout);
+}
+
+size_t AsyncLogger::FormatLine(char * buffer, size_t size, const char * format, va_list args)
+{
+    VerifyOrReturnValue(size > 0, 0);
+    LineBuilder line(buffer, size);
+
+    uint8_t record[kMaxRecordSize];
+    Encoding::LittleEndian::BufferWriter writer(record, sizeof(record));
+    const size_t formatLength = strnlen(format, kMaxFormatLength);
+    CaptureArguments(writer, format, format + formatLength, args);
+
+    size_t recordSize;
+    VerifyOrReturnValue(writer.Fit(recordSize), 0);
+    Encoding::LittleEndian::Reader reader(record, recordSize);
+    uint8_t argumentCount = 0;
+    VerifyOrReturnValue(reader.Read8(&argumentCount).StatusCode() == CHIP_NO_ERROR, 0);
+    FormatArguments(line, format, format + formatLength, reader, argumentCount);
+    return line.Length();
+}
+
+void AsyncLogger::WriteBinaryRecord(const uint8_t * record, size_t size)
+{
+    Encoding::LittleEndian::Reader reader(record, size);
+    RecordHeader header;
+    VerifyOrReturn(ReadRecordHeader(reader, header));
+
+    const uint32_t formatId    = InternFormat(header.format, header.formatLength);
+    const size_t argumentsSize = reader.Remaining();
+    const uint8_t * arguments  = record + reader.OctetsRead();
+    const size_t moduleLength  = strlen(header.module);
+    const size_t payloadSize   = 8 + 4 + 1 + 1 + moduleLength + 4 + 1 + argumentsSize;
+
+    uint8_t prefix[1 + 4 + 8 + 4 + 1 + 1 + Logging::kMaxModuleNameLen + 4 + 1];
+    Encoding::LittleEndian::BufferWriter writer(prefix, sizeof(prefix));
+    writer.Put8(kLogRecord).Put32(static_cast<uint32_t>(payloadSize));
+    writer.Put64(header.timestampUs).Put32(header.threadId).Put8(header.category);
+    writer.Put8(static_cast<uint8_t>(moduleLength)).Put(header.module, moduleLength);
+    writer.Put32(formatId).Put8(header.argumentCount);
+
+    size_t prefixSize;
+    VerifyOrReturn(writer.Fit(prefixSize));
+    fwrite(prefix, 1, prefixSize, mBinaryOutput);
+    fwrite(arguments, 1, argumentsSize, mBinaryOutput);
+}
+
+void AsyncLogger::WriteDropped(uint64_t count)
+{
+    if (mBinaryOutput == nullptr)
+    {
+        const uint64_t now = NowUs();
+        fprintf(stdout, "[%" PRIu64 ".%06" PRIu64 "][%lld] CHIP:LOG: %" PRIu64 " log lines dropped\n", now / 1000000,
+                now % 1000000, sProcessId, count);
+        return;
+    }
+
+    uint8_t buffer[1 + 4 + 8 + 8];
+    Encoding::LittleEndian::BufferWriter writer(buffer, sizeof(buffer));
+    writer.Put8(kDroppedRecord).Put32(8 + 8).Put64(NowUs()).Put64(count);
+    fwrite(buffer, 1, sizeof(buffer), mBinaryOutput);
+}
+
+uint32_t AsyncLogger::InternFormat(const char * format, size_t length)
+{
+    std::string key(format, length);
+    auto it = mFormatIds.find(key);
+    if (it != mFormatIds.end())
+    {
+        return it->second;
+    }
+
+    const uint32_t id = static_cast<uint32_t>(mFormatIds.size());
+    uint8_t prefix[1 + 4 + 4 + 2];
+    Encoding::LittleEndian::BufferWriter writer(prefix, sizeof(prefix));
+    writer.Put8(kFormatRecord).Put32(static_cast<uint32_t>(4 + 2 + length)).Put32(id).Put16(static_cast<uint16_t>(length));
+    fwrite(prefix, 1, sizeof(prefix), mBinaryOutput);
+    fwrite(format, 1, length, mBinaryOutput);
+
+    mFormatIds.emplace(std::move(key), id);
+    return id;
+}
+
+} // namespace DeviceLayer
+} // namespace chip
@@ -0,0 +1,138 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Asynchronous log output for Linux, enabled by the
+ *      chip_use_async_logging build argument or, at run time, by the
+ *      CHIP_ASYNC_LOGGING environment variable.
+ *
+ *      Logging threads only copy the timestamp, thread id, format and
+ *      arguments of a log line into a ring buffer of their own; a background
+ *      thread formats and writes the lines, to stdout, or to a binary log file
+ *      which scripts/tools/decode_binary_log.py turns back into text.
+ *
+ *      Error lines are written before Log() returns, together with the lines
+ *      queued before them, as they often precede an abort(), which skips the
+ *      atexit() handler writing the remaining lines.
+ */
+
+#pragma once
+
+#include <lib/core/CHIPError.h>
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <semaphore.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+/// Size of the ring buffer each logging thread owns. Lines which do not fit are dropped.
+#ifndef CHIP_ASYNC_LOG_RING_SIZE
+#define CHIP_ASYNC_LOG_RING_SIZE (64 * 1024)
+#endif
+
+namespace chip {
+namespace DeviceLayer {
+
+class AsyncLogRing;
+
+class AsyncLogger
+{
+public:
+    static AsyncLogger & Instance();
+
+    /**
+     * Whether log lines go through the asynchronous logger: as set by the
+     * chip_use_async_logging build argument, unless the CHIP_ASYNC_LOGGING
+     * environment variable is set to 1 or 0.
+     */
+    static bool IsEnabled();
+
+    /**
+     * Queue a log line; never blocks, but for the first line of a thread,
+     * which allocates the thread's ring buffer, and for error lines, which
+     * are written synchronously.
+     *
+     * Arguments are captured as the conversions of [format] require them, and
+     * strings are copied: nothing needs to outlive the call.
+     */
+    void Log(const char * module, uint8_t category, const char * format, va_list args);
+
+    /**
+     * Write the log lines to a binary log file from now on, rather than to
+     * stdout. Setting the CHIP_BINARY_LOG_FILE environment variable has the
+     * same effect from the first line.
+     */
+    CHIP_ERROR SetBinaryOutput(const char * path);
+
+    /// Wait until the lines queued so far are written.
+    void Flush();
+
+    /// Number of lines dropped because a ring buffer was full.
+    uint64_t GetDroppedCount() const;
+
+    /**
+     * Format a line into [buffer] the way queued lines are written: the
+     * arguments of [format] are captured into a record, which is then
+     * formatted. Returns the length of the line.
+     */
+    static size_t FormatLine(char * buffer, size_t size, const char * format, va_list args);
+
+private:
+    AsyncLogger() = default;
+
+    void Start();
+    void Stop();
+    static void StopAtExit();
+
+    CHIP_ERROR OpenBinaryOutput(const char * path);
+    AsyncLogRing * AcquireRing();
+    void Run();
+    bool Drain();
+    bool DrainRings();
+    void WriteNow(const uint8_t * record, size_t size);
+    void WriteRecord(const uint8_t * record, size_t size);
+    void WriteTextRecord(const uint8_t * record, size_t size);
+    void WriteBinaryRecord(const uint8_t * record, size_t size);
+    void WriteDropped(uint64_t count);
+    uint32_t InternFormat(const char * format, size_t length);
+
+    std::once_flag mStartOnce;
+    std::thread mThread;
+    sem_t mWakeup;
+    std::atomic<bool> mRunning{ false };
+    std::atomic<uint64_t> mDrainedPasses{ 0 };
+
+    // Rings are only ever added, at the front, and reused once their thread exits
+    std::atomic<AsyncLogRing *> mRings{ nullptr };
+    uint64_t mReportedDrops = 0;
+
+    // Held while writing, by the background thread or by a thread logging an error
+    std::mutex mOutputMutex;
+    FILE * mBinaryOutput = nullptr;
+    // Ids of the formats already defined in the binary log file
+    std::unordered_map<std::string, uint32_t> mFormatIds;
+};
+
+} // namespace DeviceLayer
+} // namespace chip
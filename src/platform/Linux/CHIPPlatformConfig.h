@@ -64,6 +64,14 @@ using CHIP_CONFIG_PERSISTED_STORAGE_KEY_TYPE = const char *;
 #define CHIP_CONFIG_BDX_MAX_NUM_TRANSFERS 1
 #endif // CHIP_CONFIG_BDX_MAX_NUM_TRANSFERS
 
+#ifndef CHIP_IM_SERVER_REPORT_CACHE_SIZE
+#define CHIP_IM_SERVER_REPORT_CACHE_SIZE 8192
+#endif // CHIP_IM_SERVER_REPORT_CACHE_SIZE
+
+#ifndef CHIP_IM_SERVER_REPORT_CACHE_MAX_ENTRIES
+#define CHIP_IM_SERVER_REPORT_CACHE_MAX_ENTRIES 128
+#endif // CHIP_IM_SERVER_REPORT_CACHE_MAX_ENTRIES
+
 // ==================== Security Configuration Overrides ====================
 
 #ifndef CHIP_CONFIG_KVS_PATH
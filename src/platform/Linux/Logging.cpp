@@ -3,6 +3,7 @@
 #include <lib/core/CHIPConfig.h>
 #include <lib/support/EnforceFormat.h>
 #include <lib/support/logging/Constants.h>
+#include <platform/Linux/AsyncLogging.h>
 #include <platform/logging/LogV.h>
 
 #include <cinttypes>
@@ -37,6 +38,14 @@ namespace Platform {
  */
 void ENFORCE_FORMAT(3, 0) LogV(const char * module, uint8_t category, const char * msg, va_list v)
 {
+    if (DeviceLayer::AsyncLogger::IsEnabled())
+    {
+        // Formatted and written by a background thread
+        DeviceLayer::AsyncLogger::Instance().Log(module, category, msg, v);
+        DeviceLayer::OnLogOutput();
+        return;
+    }
+
     struct timeval tv;
 
     // Should not fail per man page of gettimeofday(), but failed to get time is not a fatal error in log. The bad time value will
@@ -0,0 +1,213 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <platform/Linux/MetricsExporter.h>
+
+#include <lib/support/CodeUtils.h>
+#include <lib/support/Metrics.h>
+#include <lib/support/logging/CHIPLogging.h>
+#include <system/SystemClock.h>
+#include <system/SystemError.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace chip {
+namespace DeviceLayer {
+
+namespace {
+
+void WriteAll(int fd, const std::string & text)
+{
+    size_t written = 0;
+    while (written < text.size())
+    {
+        ssize_t result = write(fd, text.data() + written, text.size() - written);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        VerifyOrReturn(result > 0);
+        written += static_cast<size_t>(result);
+    }
+}
+
+} // namespace
+
+MetricsExporter & MetricsExporter::Instance()
+{
+    static MetricsExporter sInstance;
+    return sInstance;
+}
+
+CHIP_ERROR MetricsExporter::Start(const char * socketPath, const char * filePath)
+{
+    VerifyOrReturnError(!mRunning, CHIP_ERROR_INCORRECT_STATE);
+    VerifyOrReturnError(socketPath != nullptr || filePath != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+
+    mSocketPath = socketPath != nullptr ? socketPath : "";
+    mFilePath   = filePath != nullptr ? filePath : "";
+
+    if (socketPath != nullptr)
+    {
+        sockaddr_un address = {};
+        address.sun_family  = AF_UNIX;
+        VerifyOrReturnError(mSocketPath.size() < sizeof(address.sun_path), CHIP_ERROR_INVALID_ARGUMENT);
+        memcpy(address.sun_path, mSocketPath.c_str(), mSocketPath.size() + 1);
+
+        mListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        VerifyOrReturnError(mListenFd >= 0, CHIP_ERROR_POSIX(errno));
+
+        unlink(mSocketPath.c_str());
+        if (bind(mListenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(mListenFd, 4) != 0)
+        {
+            CHIP_ERROR err = CHIP_ERROR_POSIX(errno);
+            close(mListenFd);
+            mListenFd = -1;
+            return err;
+        }
+    }
+
+    if (pipe2(mWakeupFds, O_CLOEXEC) != 0)
+    {
+        CHIP_ERROR err = CHIP_ERROR_POSIX(errno);
+        Stop();
+        return err;
+    }
+
+    mRunning = true;
+    mThread  = std::thread([this] { Run(); });
+    return CHIP_NO_ERROR;
+}
+
+void MetricsExporter::Stop()
+{
+    if (mRunning.exchange(false))
+    {
+        // Wake the background thread up from poll()
+        VerifyOrDo(write(mWakeupFds[1], "", 1) == 1, ChipLogError(DeviceLayer, "Failed to wake the metrics exporter up"));
+        mThread.join();
+    }
+
+    for (int & fd : mWakeupFds)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (mListenFd >= 0)
+    {
+        close(mListenFd);
+        mListenFd = -1;
+        unlink(mSocketPath.c_str());
+    }
+}
+
+void MetricsExporter::Run()
+{
+    const System::Clock::Milliseconds64 interval(kFileIntervalMs);
+    pollfd fds[2]  = { { mWakeupFds[0], POLLIN, 0 }, { mListenFd, POLLIN, 0 } };
+    nfds_t fdCount = mListenFd >= 0 ? 2 : 1;
+
+    WriteFile();
+    System::Clock::Timestamp nextWrite = System::SystemClock().GetMonotonicTimestamp() + interval;
+    while (mRunning)
+    {
+        // Clients served in between do not push the next write back
+        int timeoutMs = -1;
+        if (!mFilePath.empty())
+        {
+            const System::Clock::Timestamp now = System::SystemClock().GetMonotonicTimestamp();
+            timeoutMs = now < nextWrite ? static_cast<int>((nextWrite - now).count()) : 0;
+        }
+
+        int result = poll(fds, fdCount, timeoutMs);
+        if (result < 0 && errno != EINTR)
+        {
+            ChipLogError(DeviceLayer, "Metrics exporter poll failed: %s", strerror(errno));
+            break;
+        }
+        if (result > 0 && fdCount > 1 && (fds[1].revents & POLLIN) != 0)
+        {
+            ServeClient();
+        }
+        if (!mFilePath.empty() && System::SystemClock().GetMonotonicTimestamp() >= nextWrite)
+        {
+            WriteFile();
+            nextWrite = System::SystemClock().GetMonotonicTimestamp() + interval;
+        }
+    }
+    WriteFile();
+}
+
+void MetricsExporter::ServeClient()
+{
+    int clientFd = accept4(mListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    VerifyOrReturn(clientFd >= 0);
+    WriteAll(clientFd, Format());
+    close(clientFd);
+}
+
+void MetricsExporter::WriteFile()
+{
+    VerifyOrReturn(!mFilePath.empty());
+
+    // Replace the file atomically, so that readers never see a partial file
+    std::string tempPath = mFilePath + ".tmp";
+    int fd               = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        ChipLogError(DeviceLayer, "Failed to open %s: %s", tempPath.c_str(), strerror(errno));
+        return;
+    }
+    WriteAll(fd, Format());
+    close(fd);
+
+    if (rename(tempPath.c_str(), mFilePath.c_str()) != 0)
+    {
+        ChipLogError(DeviceLayer, "Failed to write %s: %s", mFilePath.c_str(), strerror(errno));
+    }
+}
+
+const std::string & MetricsExporter::Format()
+{
+    // The text is formatted twice when it does not fit, and the buffer kept at the size needed
+    for (;;)
+    {
+        mText.resize(mText.capacity() > 0 ? mText.capacity() : 4096);
+        Encoding::BufferWriter writer(reinterpret_cast<uint8_t *>(&mText[0]), mText.size());
+        Metrics::WritePrometheusText(writer);
+        if (writer.Fit())
+        {
+            mText.resize(writer.Needed());
+            return mText;
+        }
+        mText.reserve(writer.Needed());
+    }
+}
+
+} // namespace DeviceLayer
+} // namespace chip
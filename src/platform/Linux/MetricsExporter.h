@@ -0,0 +1,76 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Export of the runtime metrics (lib/support/Metrics.h) of a Linux app,
+ *      in the Prometheus text format, enabled by the chip_enable_metrics
+ *      build argument.
+ *
+ *      A background thread writes the metrics to every client connecting to a
+ *      Unix domain socket (e.g. `socat - UNIX-CONNECT:<path>`), and/or rewrites
+ *      a file periodically, as expected by the node_exporter textfile collector.
+ */
+
+#pragma once
+
+#include <lib/core/CHIPError.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace chip {
+namespace DeviceLayer {
+
+class MetricsExporter
+{
+public:
+    /// How often the metrics file is rewritten.
+    static constexpr int kFileIntervalMs = 10000;
+
+    static MetricsExporter & Instance();
+
+    /**
+     * Start exporting the metrics. Either path may be nullptr; an existing
+     * file at [socketPath] is replaced.
+     */
+    CHIP_ERROR Start(const char * socketPath, const char * filePath);
+
+    /// Stop exporting, writing the file a last time and removing the socket.
+    void Stop();
+
+private:
+    MetricsExporter() = default;
+
+    void Run();
+    void ServeClient();
+    void WriteFile();
+    const std::string & Format();
+
+    std::thread mThread;
+    std::atomic<bool> mRunning{ false };
+    int mListenFd     = -1;
+    int mWakeupFds[2] = { -1, -1 };
+    std::string mSocketPath;
+    std::string mFilePath;
+    std::string mText;
+};
+
+} // namespace DeviceLayer
+} // namespace chip
@@ -63,20 +63,27 @@ CHIP_ERROR OTAImageProcessorImpl::Abort()
 
 CHIP_ERROR OTAImageProcessorImpl::ProcessBlock(ByteSpan & block)
 {
-    if (!mOfs.is_open() || !mOfs.good())
+    if (!mWriter.IsOpen())
     {
         return CHIP_ERROR_INTERNAL;
     }
 
-    // Store block data for HandleProcessBlock to access
-    CHIP_ERROR err = SetBlock(block);
-    if (err != CHIP_NO_ERROR)
+    // The block is only valid during this call: parse, hash and queue it for writing right away, the disk is not waited for.
+    mBlockError = ProcessHeader(block);
+    if (mBlockError != CHIP_NO_ERROR)
     {
-        ChipLogError(SoftwareUpdate, "Cannot set block data: %" CHIP_ERROR_FORMAT, err.Format());
+        ChipLogError(SoftwareUpdate, "Image does not contain a valid header");
+        mBlockError = CHIP_ERROR_INVALID_FILE_IDENTIFIER;
+    }
+    else
+    {
+        mBlockError = ProcessPayload(block);
     }
 
     DeviceLayer::PlatformMgr().ScheduleWork(HandleProcessBlock, reinterpret_cast<intptr_t>(this));
-    return CHIP_NO_ERROR;
+
+    // An error keeps the downloader from acknowledging the block, the download is then ended by HandleProcessBlock()
+    return mBlockError;
 }
 
 bool OTAImageProcessorImpl::IsFirstImageRun()
@@ -125,12 +132,27 @@ void OTAImageProcessorImpl::HandlePrepareDownload(intptr_t context)
         return;
     }
 
+    // Drop the state of a previous download which was neither finalized nor aborted
+    imageProcessor->mWriter.Abort();
     unlink(imageProcessor->mImageFile);
 
     imageProcessor->mHeaderParser.Init();
-    imageProcessor->mOfs.open(imageProcessor->mImageFile, std::ofstream::out | std::ofstream::ate | std::ofstream::app);
-    if (!imageProcessor->mOfs.good())
+    imageProcessor->mParams.downloadedBytes = 0;
+    imageProcessor->mParams.totalFileBytes  = 0;
+    imageProcessor->mExpectedDigestLength   = 0;
+    imageProcessor->mBlockError             = CHIP_NO_ERROR;
+    imageProcessor->mPayloadVerified        = false;
+    imageProcessor->mImageReady             = false;
+    imageProcessor->mWaitingForWriter       = false;
+
+    CHIP_ERROR error = imageProcessor->mPayloadDigest.Begin();
+    if (error == CHIP_NO_ERROR)
     {
+        error = imageProcessor->mWriter.Open(imageProcessor->mImageFile, OnChunkWritten, imageProcessor);
+    }
+    if (error != CHIP_NO_ERROR)
+    {
+        ChipLogError(SoftwareUpdate, "Cannot prepare the image file: %" CHIP_ERROR_FORMAT, error.Format());
         imageProcessor->mDownloader->OnPreparedForDownload(CHIP_ERROR_OPEN_FAILED);
         return;
     }
@@ -146,9 +168,21 @@ void OTAImageProcessorImpl::HandleFinalize(intptr_t context)
         return;
     }
 
-    imageProcessor->mOfs.close();
-    imageProcessor->ReleaseBlock();
+    // Waits for the writer to flush the last chunks, the digest has already been verified as the payload was received.
+    CHIP_ERROR error = imageProcessor->mWriter.Close();
+    if (error == CHIP_NO_ERROR && !imageProcessor->mPayloadVerified)
+    {
+        // The payload is incomplete, so its digest has not been verified.
+        error = CHIP_ERROR_INTEGRITY_CHECK_FAILED;
+    }
+    if (error != CHIP_NO_ERROR)
+    {
+        ChipLogError(SoftwareUpdate, "Cannot finalize the OTA image: %" CHIP_ERROR_FORMAT, error.Format());
+        unlink(imageProcessor->mImageFile);
+        return;
+    }
 
+    imageProcessor->mImageReady = true;
     ChipLogProgress(SoftwareUpdate, "OTA image downloaded to %s", imageProcessor->mImageFile);
 }
 
@@ -156,14 +190,17 @@ void OTAImageProcessorImpl::HandleApply(intptr_t context)
 {
     auto * imageProcessor = reinterpret_cast<OTAImageProcessorImpl *>(context);
     VerifyOrReturn(imageProcessor != nullptr);
+    VerifyOrReturn(imageProcessor->mImageReady, ChipLogError(SoftwareUpdate, "No verified OTA image to apply"));
 
     OTARequestorInterface * requestor = chip::GetRequestorInstance();
     VerifyOrReturn(requestor != nullptr);
 
-    // Move the downloaded image to the location where the new image is to be executed from
+    // Move the downloaded image to the location where the new image is to be executed from. The image was synced to disk
+    // and verified while it was downloaded, it does not need to be read again.
     unlink(kImageExecPath);
     rename(imageProcessor->mImageFile, kImageExecPath);
     chmod(kImageExecPath, S_IRUSR | S_IWUSR | S_IXUSR | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+    imageProcessor->mImageReady = false;
 
     // Shutdown the stack and expect to boot into the new image once the event loop is stopped
     DeviceLayer::PlatformMgr().ScheduleWork([](intptr_t) { DeviceLayer::PlatformMgr().HandleServerShuttingDown(); });
@@ -178,9 +215,11 @@ void OTAImageProcessorImpl::HandleAbort(intptr_t context)
         return;
     }
 
-    imageProcessor->mOfs.close();
+    imageProcessor->mWriter.Abort();
     unlink(imageProcessor->mImageFile);
-    imageProcessor->ReleaseBlock();
+    imageProcessor->mHeaderParser.Clear();
+    imageProcessor->mImageReady       = false;
+    imageProcessor->mWaitingForWriter = false;
 }
 
 void OTAImageProcessorImpl::HandleProcessBlock(intptr_t context)
@@ -197,22 +236,51 @@ void OTAImageProcessorImpl::HandleProcessBlock(intptr_t context)
         return;
     }
 
-    ByteSpan block   = imageProcessor->mBlock;
-    CHIP_ERROR error = imageProcessor->ProcessHeader(block);
-    if (error != CHIP_NO_ERROR)
+    if (imageProcessor->mBlockError != CHIP_NO_ERROR)
     {
-        ChipLogError(SoftwareUpdate, "Image does not contain a valid header");
-        imageProcessor->mDownloader->EndDownload(CHIP_ERROR_INVALID_FILE_IDENTIFIER);
+        imageProcessor->mDownloader->EndDownload(imageProcessor->mBlockError);
+        return;
+    }
+
+    // A failed write stops the writer thread, so no chunk written callback would ever resume the download.
+    CHIP_ERROR writerError = imageProcessor->mWriter.GetError();
+    if (writerError != CHIP_NO_ERROR)
+    {
+        imageProcessor->mDownloader->EndDownload(writerError);
         return;
     }
 
-    if (!imageProcessor->mOfs.write(reinterpret_cast<const char *>(block.data()), static_cast<std::streamsize>(block.size())))
+    // Only wait for the disk when all the buffers of the writer are full. The flag is set before checking so that a chunk
+    // written concurrently cannot be missed, and whichever thread clears it requests the next block.
+    imageProcessor->mWaitingForWriter = true;
+    if (imageProcessor->mWriter.CanAcceptBlock() && imageProcessor->mWaitingForWriter.exchange(false))
+    {
+        imageProcessor->mDownloader->FetchNextData();
+    }
+}
+
+void OTAImageProcessorImpl::OnChunkWritten(void * context)
+{
+    auto * imageProcessor = static_cast<OTAImageProcessorImpl *>(context);
+    if (imageProcessor->mWaitingForWriter.exchange(false))
+    {
+        DeviceLayer::PlatformMgr().ScheduleWork(HandleWriterReady, reinterpret_cast<intptr_t>(imageProcessor));
+    }
+}
+
+void OTAImageProcessorImpl::HandleWriterReady(intptr_t context)
+{
+    auto * imageProcessor = reinterpret_cast<OTAImageProcessorImpl *>(context);
+    VerifyOrReturn(imageProcessor != nullptr && imageProcessor->mDownloader != nullptr);
+    VerifyOrReturn(imageProcessor->mWriter.IsOpen());
+
+    CHIP_ERROR writerError = imageProcessor->mWriter.GetError();
+    if (writerError != CHIP_NO_ERROR)
     {
-        imageProcessor->mDownloader->EndDownload(CHIP_ERROR_WRITE_FAILED);
+        imageProcessor->mDownloader->EndDownload(writerError);
         return;
     }
 
-    imageProcessor->mParams.downloadedBytes += block.size();
     imageProcessor->mDownloader->FetchNextData();
 }
 
@@ -228,49 +296,72 @@ CHIP_ERROR OTAImageProcessorImpl::ProcessHeader(ByteSpan & block)
         ReturnErrorOnFailure(error);
 
         mParams.totalFileBytes = header.mPayloadSize;
+
+        // The header is cleared below: keep a copy of the digest to verify the payload against.
+        switch (header.mImageDigestType)
+        {
+        case OTAImageDigestType::kSha256:
+        case OTAImageDigestType::kSha256_128:
+        case OTAImageDigestType::kSha256_120:
+        case OTAImageDigestType::kSha256_96:
+        case OTAImageDigestType::kSha256_64:
+        case OTAImageDigestType::kSha256_32:
+            // Truncated SHA-256 digests are prefixes of the full digest.
+            error = (header.mImageDigest.empty() || header.mImageDigest.size() > sizeof(mExpectedDigest))
+                ? CHIP_ERROR_INVALID_ARGUMENT
+                : CHIP_NO_ERROR;
+            break;
+        default:
+            ChipLogError(SoftwareUpdate, "Unsupported image digest type: %u", to_underlying(header.mImageDigestType));
+            error = CHIP_ERROR_NOT_IMPLEMENTED;
+            break;
+        }
+        if (error == CHIP_NO_ERROR)
+        {
+            memcpy(mExpectedDigest, header.mImageDigest.data(), header.mImageDigest.size());
+            mExpectedDigestLength = header.mImageDigest.size();
+        }
         mHeaderParser.Clear();
+        ReturnErrorOnFailure(error);
+
+        ChipLogProgress(SoftwareUpdate, "OTA image payload: %" PRIu64 " bytes", mParams.totalFileBytes);
     }
 
     return CHIP_NO_ERROR;
 }
 
-CHIP_ERROR OTAImageProcessorImpl::SetBlock(ByteSpan & block)
+CHIP_ERROR OTAImageProcessorImpl::ProcessPayload(const ByteSpan & block)
 {
-    if (!IsSpanUsable(block))
-    {
-        ReleaseBlock();
-        return CHIP_NO_ERROR;
-    }
-    if (mBlock.size() < block.size())
-    {
-        if (!mBlock.empty())
-        {
-            ReleaseBlock();
-        }
-        uint8_t * mBlock_ptr = static_cast<uint8_t *>(chip::Platform::MemoryAlloc(block.size()));
-        if (mBlock_ptr == nullptr)
-        {
-            return CHIP_ERROR_NO_MEMORY;
-        }
-        mBlock = MutableByteSpan(mBlock_ptr, block.size());
-    }
-    CHIP_ERROR err = CopySpanToMutableSpan(block, mBlock);
-    if (err != CHIP_NO_ERROR)
+    ReturnErrorCodeIf(block.empty(), CHIP_NO_ERROR);
+
+    // Data past the payload size given by the header would not be covered by the digest.
+    VerifyOrReturnError(block.size() <= mParams.totalFileBytes - mParams.downloadedBytes, CHIP_ERROR_INTEGRITY_CHECK_FAILED);
+
+    ReturnErrorOnFailure(mPayloadDigest.AddData(block));
+    ReturnErrorOnFailure(mWriter.Write(block));
+    mParams.downloadedBytes += block.size();
+
+    if (mParams.downloadedBytes == mParams.totalFileBytes)
     {
-        ChipLogError(SoftwareUpdate, "Cannot copy block data: %" CHIP_ERROR_FORMAT, err.Format());
-        return err;
+        ReturnErrorOnFailure(VerifyPayloadDigest());
     }
+
     return CHIP_NO_ERROR;
 }
 
-CHIP_ERROR OTAImageProcessorImpl::ReleaseBlock()
+CHIP_ERROR OTAImageProcessorImpl::VerifyPayloadDigest()
 {
-    if (mBlock.data() != nullptr)
+    uint8_t digestBuffer[Crypto::kSHA256_Hash_Length];
+    MutableByteSpan digest(digestBuffer);
+
+    ReturnErrorOnFailure(mPayloadDigest.Finish(digest));
+    if (mExpectedDigestLength > digest.size() || memcmp(digest.data(), mExpectedDigest, mExpectedDigestLength) != 0)
     {
-        chip::Platform::MemoryFree(mBlock.data());
+        ChipLogError(SoftwareUpdate, "OTA image digest mismatch");
+        return CHIP_ERROR_INTEGRITY_CHECK_FAILED;
     }
 
-    mBlock = MutableByteSpan();
+    mPayloadVerified = true;
     return CHIP_NO_ERROR;
 }
 
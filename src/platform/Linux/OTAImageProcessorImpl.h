@@ -19,17 +19,25 @@
 #pragma once
 
 #include <app/clusters/ota-requestor/OTADownloader.h>
+#include <crypto/CHIPCryptoPAL.h>
 #include <lib/core/OTAImageHeader.h>
 #include <platform/CHIPDeviceLayer.h>
 #include <platform/OTAImageProcessor.h>
 
-#include <fstream>
+#include "OTAImageWriter.h"
+
+#include <atomic>
 
 namespace chip {
 
 // Full file path to where the new image will be executed from post-download
 static char kImageExecPath[] = "/tmp/ota.update";
 
+/**
+ * Processes the image as a stream: the header is parsed and the payload digest is computed as blocks are received, and the
+ * payload is written to the image file by a background OTAImageWriter. The next block is requested as soon as the previous
+ * one has been copied, unless all the buffers of the writer are waiting for the disk.
+ */
 class OTAImageProcessorImpl : public OTAImageProcessorInterface
 {
 public:
@@ -53,23 +61,35 @@ private:
     static void HandleAbort(intptr_t context);
     static void HandleProcessBlock(intptr_t context);
 
-    CHIP_ERROR ProcessHeader(ByteSpan & block);
+    // Called from the writer thread when the writer has room for more data
+    static void OnChunkWritten(void * context);
+    static void HandleWriterReady(intptr_t context);
 
-    /**
-     * Called to allocate memory for mBlock if necessary and set it to block
-     */
-    CHIP_ERROR SetBlock(ByteSpan & block);
-
-    /**
-     * Called to release allocated memory for mBlock
-     */
-    CHIP_ERROR ReleaseBlock();
+    CHIP_ERROR ProcessHeader(ByteSpan & block);
+    CHIP_ERROR ProcessPayload(const ByteSpan & block);
+    CHIP_ERROR VerifyPayloadDigest();
 
-    std::ofstream mOfs;
-    MutableByteSpan mBlock;
+    OTAImageWriter mWriter;
     OTADownloader * mDownloader;
     OTAImageHeaderParser mHeaderParser;
     const char * mImageFile = nullptr;
+
+    // Digest of the payload, computed as it is received, and the digest from the header it must match
+    Crypto::Hash_SHA256_stream mPayloadDigest;
+    uint8_t mExpectedDigest[Crypto::kSHA256_Hash_Length];
+    size_t mExpectedDigestLength = 0;
+
+    // Error found while processing the last block, reported to the downloader by HandleProcessBlock()
+    CHIP_ERROR mBlockError = CHIP_NO_ERROR;
+
+    // Whether the complete payload has been received and matches its digest
+    bool mPayloadVerified = false;
+
+    // Whether the verified payload has been synced to the image file
+    bool mImageReady = false;
+
+    // Whether the next block is to be requested once the writer has room for it
+    std::atomic<bool> mWaitingForWriter{ false };
 };
 
 } // namespace chip
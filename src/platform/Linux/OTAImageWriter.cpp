@@ -0,0 +1,258 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "OTAImageWriter.h"
+
+#include <lib/support/CodeUtils.h>
+#include <lib/support/logging/CHIPLogging.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace chip {
+
+constexpr size_t OTAImageWriter::kChunkSize;
+constexpr size_t OTAImageWriter::kChunkCount;
+constexpr size_t OTAImageWriter::kChunkAlign;
+constexpr uint64_t OTAImageWriter::kSyncInterval;
+
+CHIP_ERROR OTAImageWriter::Open(const char * aPath, ChunkWrittenCallback aCallback, void * aContext)
+{
+    VerifyOrReturnError(!IsOpen(), CHIP_ERROR_INCORRECT_STATE);
+
+    // O_DIRECT is not supported by every file system (tmpfs in particular), fall back to buffered writes.
+    mFd       = open(aPath, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, S_IRUSR | S_IWUSR);
+    mDirectIO = mFd >= 0;
+    if (mFd < 0 && errno == EINVAL)
+    {
+        mFd = open(aPath, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    }
+    VerifyOrReturnError(mFd >= 0, CHIP_ERROR_OPEN_FAILED);
+
+    for (auto & chunk : mChunks)
+    {
+        // O_DIRECT requires the buffers to be aligned on the logical block size of the device.
+        if (posix_memalign(reinterpret_cast<void **>(&chunk), kChunkAlign, kChunkSize) != 0)
+        {
+            chunk = nullptr;
+            Abort();
+            return CHIP_ERROR_NO_MEMORY;
+        }
+        mFreeChunks.push_back(chunk);
+    }
+
+    mCallback      = aCallback;
+    mContext       = aContext;
+    mUnsyncedBytes = 0;
+    mStopping      = false;
+    mError         = CHIP_NO_ERROR;
+    mCurrent       = Chunk();
+    mThread        = std::thread(&OTAImageWriter::WriterThread, this);
+
+    ChipLogDetail(SoftwareUpdate, "Writing OTA image to %s%s", aPath, mDirectIO ? " with direct I/O" : "");
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR OTAImageWriter::Write(ByteSpan aData)
+{
+    VerifyOrReturnError(IsOpen(), CHIP_ERROR_INCORRECT_STATE);
+
+    while (!aData.empty())
+    {
+        if (mCurrent.mData == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            ReturnErrorOnFailure(mError);
+            VerifyOrReturnError(!mFreeChunks.empty(), CHIP_ERROR_NO_MEMORY);
+            mCurrent.mData = mFreeChunks.front();
+            mCurrent.mSize = 0;
+            mFreeChunks.pop_front();
+        }
+
+        const size_t size = std::min(aData.size(), kChunkSize - mCurrent.mSize);
+        memcpy(mCurrent.mData + mCurrent.mSize, aData.data(), size);
+        mCurrent.mSize += size;
+        aData = aData.SubSpan(size);
+
+        if (mCurrent.mSize == kChunkSize)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                mQueue.push_back(mCurrent);
+            }
+            mCondition.notify_one();
+            mCurrent = Chunk();
+        }
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+bool OTAImageWriter::CanAcceptBlock()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    // A block fits in the current chunk and, at worst, one more.
+    return mError == CHIP_NO_ERROR && !mFreeChunks.empty();
+}
+
+CHIP_ERROR OTAImageWriter::GetError()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return mError;
+}
+
+CHIP_ERROR OTAImageWriter::Close()
+{
+    VerifyOrReturnError(IsOpen(), CHIP_ERROR_INCORRECT_STATE);
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        if (mCurrent.mData != nullptr)
+        {
+            // Only the last chunk may be partial, which keeps every other write aligned for O_DIRECT.
+            mQueue.push_back(mCurrent);
+            mCurrent = Chunk();
+        }
+        mStopping = true;
+    }
+    mCondition.notify_one();
+    mThread.join();
+
+    CHIP_ERROR err = mError;
+    if (err == CHIP_NO_ERROR && fsync(mFd) != 0)
+    {
+        err = CHIP_ERROR_WRITE_FAILED;
+    }
+    close(mFd);
+    mFd = -1;
+    ReleaseChunks();
+
+    return err;
+}
+
+void OTAImageWriter::Abort()
+{
+    if (mThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            mQueue.clear();
+            mStopping = true;
+        }
+        mCondition.notify_one();
+        mThread.join();
+    }
+
+    if (mFd >= 0)
+    {
+        close(mFd);
+        mFd = -1;
+    }
+    mCurrent = Chunk();
+    ReleaseChunks();
+}
+
+void OTAImageWriter::ReleaseChunks()
+{
+    mQueue.clear();
+    mFreeChunks.clear();
+    for (auto & chunk : mChunks)
+    {
+        free(chunk);
+        chunk = nullptr;
+    }
+}
+
+void OTAImageWriter::WriterThread()
+{
+    while (true)
+    {
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(mLock);
+            mCondition.wait(lock, [this] { return !mQueue.empty() || mStopping; });
+            if (mQueue.empty())
+            {
+                return;
+            }
+            chunk = mQueue.front();
+            mQueue.pop_front();
+        }
+
+        CHIP_ERROR err = WriteChunk(chunk);
+
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            mFreeChunks.push_back(chunk.mData);
+            if (err != CHIP_NO_ERROR)
+            {
+                mError = err;
+                mQueue.clear();
+            }
+        }
+
+        if (mCallback != nullptr)
+        {
+            mCallback(mContext);
+        }
+    }
+}
+
+CHIP_ERROR OTAImageWriter::WriteChunk(const Chunk & aChunk)
+{
+    if (mDirectIO && aChunk.mSize % kChunkAlign != 0)
+    {
+        // The last chunk of the image cannot be written with O_DIRECT.
+        int flags = fcntl(mFd, F_GETFL);
+        VerifyOrReturnError(flags >= 0 && fcntl(mFd, F_SETFL, flags & ~O_DIRECT) == 0, CHIP_ERROR_WRITE_FAILED);
+        mDirectIO = false;
+    }
+
+    size_t written = 0;
+    while (written < aChunk.mSize)
+    {
+        ssize_t result = write(mFd, aChunk.mData + written, aChunk.mSize - written);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            ChipLogError(SoftwareUpdate, "Cannot write OTA image: %s", strerror(errno));
+            return CHIP_ERROR_WRITE_FAILED;
+        }
+        written += static_cast<size_t>(result);
+    }
+
+    // Direct I/O bypasses the page cache, but the metadata and the device cache still need to be flushed. Doing it in
+    // batches spreads the flushes over the download, leaving little for Close(). A download cut by a power loss is not
+    // resumed from the last flush: the file is truncated when opened, so it starts again from zero.
+    mUnsyncedBytes += aChunk.mSize;
+    if (mUnsyncedBytes >= kSyncInterval)
+    {
+        VerifyOrReturnError(fdatasync(mFd) == 0, CHIP_ERROR_WRITE_FAILED);
+        mUnsyncedBytes = 0;
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+} // namespace chip
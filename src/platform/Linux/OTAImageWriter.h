@@ -0,0 +1,125 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <lib/core/CHIPError.h>
+#include <lib/support/Span.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace chip {
+
+/**
+ * Writes a downloaded OTA image to a file from a background thread.
+ *
+ * Data is copied into large aligned chunks, which the writer thread writes with O_DIRECT when the file system supports it,
+ * syncing the file every kSyncInterval bytes rather than after every write. The thread which downloads the image only copies
+ * memory, and never waits for the disk until Close().
+ *
+ * Write() needs a free chunk whenever the current one fills up: a caller should only request more data when
+ * CanAcceptBlock() is true, and otherwise wait for the chunk written callback.
+ */
+class OTAImageWriter
+{
+public:
+    // Larger than any BDX block, so that a block spans at most two chunks
+    static constexpr size_t kChunkSize      = 64 * 1024;
+    static constexpr size_t kChunkCount     = 8;
+    static constexpr size_t kChunkAlign     = 4096;
+    static constexpr uint64_t kSyncInterval = 1024 * 1024;
+
+    /**
+     * Called from the writer thread when a chunk has been written.
+     */
+    using ChunkWrittenCallback = void (*)(void * context);
+
+    ~OTAImageWriter() { Abort(); }
+
+    /**
+     * Create (or truncate) the file at aPath and start the writer thread.
+     */
+    CHIP_ERROR Open(const char * aPath, ChunkWrittenCallback aCallback, void * aContext);
+
+    /**
+     * Queue data to be written.
+     *
+     * @retval CHIP_ERROR_NO_MEMORY  If a new chunk is needed and all the chunks are waiting to be written.
+     * @retval CHIP_ERROR_WRITE_FAILED If writing a previous chunk failed.
+     */
+    CHIP_ERROR Write(ByteSpan aData);
+
+    /**
+     * Whether a block of up to kChunkSize bytes can be written without waiting for the writer thread.
+     */
+    bool CanAcceptBlock();
+
+    /**
+     * The error latched by the writer thread, if writing a chunk failed. No more chunks are written once it is set.
+     */
+    CHIP_ERROR GetError();
+
+    /**
+     * Write all the queued data, sync and close the file. This waits for the writer thread.
+     */
+    CHIP_ERROR Close();
+
+    /**
+     * Stop the writer thread and close the file, discarding the queued data.
+     */
+    void Abort();
+
+    bool IsOpen() const { return mFd >= 0; }
+
+private:
+    struct Chunk
+    {
+        uint8_t * mData = nullptr;
+        size_t mSize    = 0;
+    };
+
+    void WriterThread();
+    CHIP_ERROR WriteChunk(const Chunk & aChunk);
+    void ReleaseChunks();
+
+    int mFd                 = -1;
+    bool mDirectIO          = false;
+    uint64_t mUnsyncedBytes = 0;
+
+    ChunkWrittenCallback mCallback = nullptr;
+    void * mContext                = nullptr;
+
+    // Chunk being filled by Write()
+    Chunk mCurrent;
+
+    // Shared with the writer thread, protected by mLock
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    std::deque<Chunk> mQueue;
+    std::deque<uint8_t *> mFreeChunks;
+    bool mStopping    = false;
+    CHIP_ERROR mError = CHIP_NO_ERROR;
+
+    uint8_t * mChunks[kChunkCount] = {};
+    std::thread mThread;
+};
+
+} // namespace chip
@@ -0,0 +1,154 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements a unit test suite for the capture and the
+ *      formatting of log arguments by the asynchronous Linux logging backend.
+ *
+ */
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <lib/support/EnforceFormat.h>
+#include <lib/support/UnitTestRegistration.h>
+#include <nlunit-test.h>
+#include <platform/Linux/AsyncLogging.h>
+
+using namespace chip;
+using namespace chip::DeviceLayer;
+
+namespace {
+
+constexpr size_t kLineSize = 256;
+
+size_t ENFORCE_FORMAT(3, 4) FormatLine(char * buffer, size_t size, const char * format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    const size_t length = AsyncLogger::FormatLine(buffer, size, format, args);
+    va_end(args);
+    return length;
+}
+
+/// Check that a line formatted from its captured arguments is the line printf writes.
+void ENFORCE_FORMAT(2, 3) CheckRoundTrip(nlTestSuite * inSuite, const char * format, ...)
+{
+    char expected[kLineSize];
+    char actual[kLineSize];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(expected, sizeof(expected), format, args);
+    va_end(args);
+
+    va_start(args, format);
+    const size_t length = AsyncLogger::FormatLine(actual, sizeof(actual), format, args);
+    va_end(args);
+
+    const bool same = strcmp(expected, actual) == 0 && length == strlen(expected);
+    if (!same)
+    {
+        printf("Format \"%s\": expected \"%s\", got \"%s\"\n", format, expected, actual);
+    }
+    NL_TEST_ASSERT(inSuite, same);
+}
+
+void TestIntegers(nlTestSuite * inSuite, void * inContext)
+{
+    CheckRoundTrip(inSuite, "no conversion");
+    CheckRoundTrip(inSuite, "%d %i %d", 42, -42, INT32_MIN);
+    CheckRoundTrip(inSuite, "%u %x %X %o", UINT32_MAX, 0xbeefu, 0xbeefu, 0755u);
+    CheckRoundTrip(inSuite, "%hhd %hhu %hd %hu", static_cast<signed char>(-5), static_cast<unsigned char>(250),
+                   static_cast<short>(-300), static_cast<unsigned short>(60000));
+    CheckRoundTrip(inSuite, "%ld %lu %lld %llx", -1234567L, 1234567UL, INT64_MIN, 0x0123456789abcdefULL);
+    CheckRoundTrip(inSuite, "%jd %ju %zu %zd %td", INTMAX_MIN, UINTMAX_MAX, SIZE_MAX, static_cast<ssize_t>(-7),
+                   static_cast<ptrdiff_t>(-9));
+    CheckRoundTrip(inSuite, "%" PRIu8 " %" PRIx16 " %" PRId32 " %" PRIu64 " %" PRIX64, static_cast<uint8_t>(200),
+                   static_cast<uint16_t>(0xabcd), INT32_MAX, UINT64_MAX, UINT64_C(0xDEADBEEFCAFE));
+    CheckRoundTrip(inSuite, "%c%c%c", 'a', 'B', '!');
+}
+
+void TestFlagsWidthPrecision(nlTestSuite * inSuite, void * inContext)
+{
+    CheckRoundTrip(inSuite, "[%5d] [%-5d] [%05d] [%+d] [% d]", 42, 42, 42, 42, 42);
+    CheckRoundTrip(inSuite, "[%#x] [%#o] [%08.3x] [%.0d]", 255u, 8u, 0xau, 0);
+    CheckRoundTrip(inSuite, "[%*d] [%-*d] [%*d]", 6, 7, 6, 7, -6, 7);
+    CheckRoundTrip(inSuite, "[%.*f] [%*.*f] [%.*s]", 2, 3.14159, 10, 4, 2.71828, 3, "abcdef");
+    CheckRoundTrip(inSuite, "[%.*d]", -1, 12);
+}
+
+void TestFloatingPoint(nlTestSuite * inSuite, void * inContext)
+{
+    CheckRoundTrip(inSuite, "%f %F %.2f", 1.5, -0.25, 1234.5678);
+    CheckRoundTrip(inSuite, "%e %E %.3e", 6.02214076e23, -1.602e-19, 299792458.0);
+    CheckRoundTrip(inSuite, "%g %G %g", 0.0001, 1e-10, 100000.0);
+    CheckRoundTrip(inSuite, "%a %A", 1.0, -0.5);
+    CheckRoundTrip(inSuite, "%Lf %.1Lf", 2.5L, -3.25L);
+}
+
+void TestStringsAndPointers(nlTestSuite * inSuite, void * inContext)
+{
+    int value = 0;
+
+    CheckRoundTrip(inSuite, "%s, %s!", "Hello", "World");
+    CheckRoundTrip(inSuite, "[%10s] [%-10s] [%.2s] [%s]", "right", "left", "truncated", "");
+    CheckRoundTrip(inSuite, "%p %p", static_cast<void *>(&value), static_cast<void *>(nullptr));
+    CheckRoundTrip(inSuite, "100%% %s %d%%", "done", 50);
+}
+
+void TestUncapturedConversions(nlTestSuite * inSuite, void * inContext)
+{
+    char line[kLineSize];
+
+    // Capture stops at wide strings: the rest of the line is written as is
+    NL_TEST_ASSERT(inSuite, FormatLine(line, sizeof(line), "%d %ls %d", 1, L"wide", 2) == strlen("1 %ls %d"));
+    NL_TEST_ASSERT(inSuite, strcmp(line, "1 %ls %d") == 0);
+
+    // Lines longer than the buffer are truncated, and terminated
+    char shortLine[8];
+    NL_TEST_ASSERT(inSuite, FormatLine(shortLine, sizeof(shortLine), "%s", "longer than the line") == sizeof(shortLine) - 1);
+    NL_TEST_ASSERT(inSuite, strcmp(shortLine, "longer ") == 0);
+}
+
+/**
+ *   Test Suite. It lists all the test functions.
+ */
+const nlTest sTests[] = {
+    NL_TEST_DEF("Test integer conversions", TestIntegers),
+    NL_TEST_DEF("Test flags, width and precision", TestFlagsWidthPrecision),
+    NL_TEST_DEF("Test floating point conversions", TestFloatingPoint),
+    NL_TEST_DEF("Test string and pointer conversions", TestStringsAndPointers),
+    NL_TEST_DEF("Test uncaptured conversions", TestUncapturedConversions),
+    NL_TEST_SENTINEL()
+};
+
+} // namespace
+
+int TestAsyncLogging()
+{
+    nlTestSuite theSuite = { "AsyncLogging tests", &sTests[0], nullptr, nullptr };
+
+    nlTestRunner(&theSuite, nullptr);
+    return nlTestRunnerStats(&theSuite);
+}
+
+CHIP_REGISTER_TEST_SUITE(TestAsyncLogging)
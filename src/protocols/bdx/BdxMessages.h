@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <lib/core/CHIPTLVTags.h>
 #include <lib/support/BitFlags.h>
 #include <lib/support/BufferWriter.h>
 #include <lib/support/CodeUtils.h>
@@ -84,6 +85,16 @@ enum class RangeControlFlags : uint8_t
     kWiderange   = (1U << 4),
 };
 
+/**
+ * Proprietary extension negotiating a windowed transfer, see TransferSession::TransferInitData::WindowSize.
+ *
+ * The window size is an unsigned integer TLV element with this tag, appended to the Metadata of the TransferInit and Accept
+ * messages. A peer which does not know the tag ignores it, and answers with a standard synchronous transfer.
+ */
+constexpr uint16_t kWindowedTransferVendorId  = 0x1049; // Silicon Laboratories
+constexpr uint16_t kWindowedTransferProfileId = 0x0BD0;
+constexpr TLV::Tag kWindowSizeMetadataTag     = TLV::ProfileTag(kWindowedTransferVendorId, kWindowedTransferProfileId, 1);
+
 /**
  * @brief
  *   Interface for defining methods that apply to all BDX messages.
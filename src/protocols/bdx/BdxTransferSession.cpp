@@ -6,6 +6,7 @@
 
 #include <protocols/bdx/BdxTransferSession.h>
 
+#include <lib/core/CHIPTLV.h>
 #include <lib/support/BufferReader.h>
 #include <lib/support/CodeUtils.h>
 #include <lib/support/TypeTraits.h>
@@ -22,19 +23,27 @@
 namespace {
 constexpr uint8_t kBdxVersion = 0; ///< The version of this implementation of the BDX spec
 
+// Size of the metadata element carrying the window size of a windowed transfer
+constexpr size_t kWindowSizeExtensionSize = 16;
+
 /**
  * @brief
- *   Allocate a new PacketBuffer and write data from a BDX message struct.
+ *   Allocate a new PacketBuffer and write data from a BDX message struct, followed by extension metadata if any.
  */
-CHIP_ERROR WriteToPacketBuffer(const ::chip::bdx::BdxMessage & msgStruct, ::chip::System::PacketBufferHandle & msgBuf)
+CHIP_ERROR WriteToPacketBuffer(const ::chip::bdx::BdxMessage & msgStruct, ::chip::System::PacketBufferHandle & msgBuf,
+                               ::chip::ByteSpan extension = ::chip::ByteSpan())
 {
-    size_t msgDataSize = msgStruct.MessageSize();
+    size_t msgDataSize = msgStruct.MessageSize() + extension.size();
     ::chip::Encoding::LittleEndian::PacketBufferWriter bbuf(chip::MessagePacketBuffer::New(msgDataSize), msgDataSize);
     if (bbuf.IsNull())
     {
         return CHIP_ERROR_NO_MEMORY;
     }
     msgStruct.WriteToBuffer(bbuf);
+    if (!extension.empty())
+    {
+        bbuf.Put(extension.data(), extension.size());
+    }
     msgBuf = bbuf.Finalize();
     if (msgBuf.IsNull())
     {
@@ -54,11 +63,64 @@ void PrepareOutgoingMessageEvent(MessageType messageType, chip::bdx::TransferSes
     outputMsgType.MessageType = static_cast<uint8_t>(messageType);
 }
 
+/**
+ * @brief
+ *   Encode the metadata element carrying the window size of a windowed transfer. An empty extension is returned for a
+ *   synchronous transfer.
+ */
+CHIP_ERROR EncodeWindowSizeExtension(uint16_t windowSize, ::chip::MutableByteSpan & extension)
+{
+    if (windowSize <= 1)
+    {
+        extension.reduce_size(0);
+        return CHIP_NO_ERROR;
+    }
+
+    ::chip::TLV::TLVWriter writer;
+    writer.Init(extension.data(), extension.size());
+    ReturnErrorOnFailure(writer.Put(::chip::bdx::kWindowSizeMetadataTag, windowSize));
+    ReturnErrorOnFailure(writer.Finalize());
+    extension.reduce_size(writer.GetLengthWritten());
+    return CHIP_NO_ERROR;
+}
+
+/**
+ * @brief
+ *   Find the window size element in the metadata of a TransferInit or Accept message, and remove it from the metadata handed to
+ *   the application. Returns 0 if there is no such element, leaving metadata which is not TLV untouched.
+ */
+uint16_t ExtractWindowSize(const uint8_t * metadata, size_t & metadataLength)
+{
+    VerifyOrReturnValue(metadata != nullptr && metadataLength > 0, 0);
+
+    ::chip::TLV::TLVReader reader;
+    reader.Init(metadata, metadataLength);
+
+    size_t elementStart = 0;
+    while (reader.Next() == CHIP_NO_ERROR)
+    {
+        uint16_t windowSize = 0;
+        if (reader.GetTag() == ::chip::bdx::kWindowSizeMetadataTag && reader.Get(windowSize) == CHIP_NO_ERROR)
+        {
+            // The element is appended after the metadata of the application
+            metadataLength = elementStart;
+            return windowSize;
+        }
+        VerifyOrReturnValue(reader.Skip() == CHIP_NO_ERROR, 0);
+        elementStart = reader.GetLengthRead();
+    }
+
+    return 0;
+}
+
 } // anonymous namespace
 
 namespace chip {
 namespace bdx {
 
+constexpr uint16_t TransferSession::kMaxWindowSize;
+constexpr System::Clock::Milliseconds32 TransferSession::kWindowRecoveryInterval;
+
 TransferSession::TransferSession()
 {
     mSuppportedXferOpts.ClearAll();
@@ -82,10 +144,33 @@ void TransferSession::PollOutput(OutputEvent & event, System::Clock::Timestamp c
         return;
     }
 
+    if (IsWindowRecoveryDue(curTime))
+    {
+        // Asking for the Blocks again is no progress of the transfer, so it does not restart the timeout.
+        mLastRecoveryTime = curTime;
+        PrepareWindowRecovery();
+        if (mPendingOutput == OutputEventType::kMsgToSend)
+        {
+            event          = OutputEvent::MsgToSendEvent(mMsgTypeData, std::move(mPendingMsgHandle));
+            mPendingOutput = OutputEventType::kNone;
+            return;
+        }
+    }
+
     switch (mPendingOutput)
     {
     case OutputEventType::kNone:
-        event = OutputEvent(OutputEventType::kNone);
+        if (IsWindowed() && mRole == TransferRole::kSender && mState == TransferState::kTransferInProgress && !mBlockRequested &&
+            mNextBlockNum < mWindowEnd)
+        {
+            // The window lets the sender send its next Block without waiting for a BlockQuery.
+            event           = OutputEvent(OutputEventType::kQueryReceived);
+            mBlockRequested = true;
+        }
+        else
+        {
+            event = OutputEvent(OutputEventType::kNone);
+        }
         break;
     case OutputEventType::kInternalError:
         event = OutputEvent::StatusReportEvent(OutputEventType::kInternalError, mStatusReportData);
@@ -147,6 +232,16 @@ CHIP_ERROR TransferSession::StartTransfer(TransferRole role, const TransferInitD
     mStartOffset           = initData.StartOffset;
     mTransferLength        = initData.Length;
 
+    // Only a Receiver Drive transfer can be windowed
+    VerifyOrReturnError(initData.WindowSize <= kMaxWindowSize, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(initData.WindowSize <= 1 || mSuppportedXferOpts.Has(TransferControlFlags::kReceiverDrive),
+                        CHIP_ERROR_INVALID_ARGUMENT);
+    mProposedWindowSize = initData.WindowSize;
+
+    uint8_t extensionBuf[kWindowSizeExtensionSize];
+    MutableByteSpan extension(extensionBuf);
+    ReturnErrorOnFailure(EncodeWindowSizeExtension(mProposedWindowSize, extension));
+
     // Prepare TransferInit message
     TransferInit initMsg;
     initMsg.TransferCtlOptions = initData.TransferCtlFlags;
@@ -159,7 +254,7 @@ CHIP_ERROR TransferSession::StartTransfer(TransferRole role, const TransferInitD
     initMsg.Metadata           = initData.Metadata;
     initMsg.MetadataLength     = initData.MetadataLength;
 
-    ReturnErrorOnFailure(WriteToPacketBuffer(initMsg, mPendingMsgHandle));
+    ReturnErrorOnFailure(WriteToPacketBuffer(initMsg, mPendingMsgHandle, extension));
 
     const MessageType msgType = (mRole == TransferRole::kSender) ? MessageType::SendInit : MessageType::ReceiveInit;
 
@@ -206,7 +301,18 @@ CHIP_ERROR TransferSession::AcceptTransfer(const TransferAcceptData & acceptData
     VerifyOrReturnError(proposedControlOpts.Has(acceptData.ControlMode), CHIP_ERROR_INVALID_ARGUMENT);
     VerifyOrReturnError(acceptData.MaxBlockSize <= mTransferRequestData.MaxBlockSize, CHIP_ERROR_INVALID_ARGUMENT);
 
+    // A window can't be larger than the proposed one, and is only used by a Receiver Drive transfer
+    VerifyOrReturnError(acceptData.WindowSize <= 1 ||
+                            (acceptData.ControlMode == TransferControlFlags::kReceiverDrive &&
+                             acceptData.WindowSize <= mProposedWindowSize),
+                        CHIP_ERROR_INVALID_ARGUMENT);
+
+    uint8_t extensionBuf[kWindowSizeExtensionSize];
+    MutableByteSpan extension(extensionBuf);
+    ReturnErrorOnFailure(EncodeWindowSizeExtension(acceptData.WindowSize, extension));
+
     mTransferMaxBlockSize = acceptData.MaxBlockSize;
+    mWindowSize           = ::chip::max<uint16_t>(acceptData.WindowSize, 1);
 
     if (mRole == TransferRole::kSender)
     {
@@ -222,7 +328,7 @@ CHIP_ERROR TransferSession::AcceptTransfer(const TransferAcceptData & acceptData
         acceptMsg.Metadata       = acceptData.Metadata;
         acceptMsg.MetadataLength = acceptData.MetadataLength;
 
-        ReturnErrorOnFailure(WriteToPacketBuffer(acceptMsg, mPendingMsgHandle));
+        ReturnErrorOnFailure(WriteToPacketBuffer(acceptMsg, mPendingMsgHandle, extension));
         msgType = MessageType::ReceiveAccept;
 
 #if CHIP_AUTOMATION_LOGGING
@@ -239,7 +345,7 @@ CHIP_ERROR TransferSession::AcceptTransfer(const TransferAcceptData & acceptData
         acceptMsg.Metadata       = acceptData.Metadata;
         acceptMsg.MetadataLength = acceptData.MetadataLength;
 
-        ReturnErrorOnFailure(WriteToPacketBuffer(acceptMsg, mPendingMsgHandle));
+        ReturnErrorOnFailure(WriteToPacketBuffer(acceptMsg, mPendingMsgHandle, extension));
         msgType = MessageType::SendAccept;
 
 #if CHIP_AUTOMATION_LOGGING
@@ -268,7 +374,7 @@ CHIP_ERROR TransferSession::PrepareBlockQuery()
     VerifyOrReturnError(mState == TransferState::kTransferInProgress, CHIP_ERROR_INCORRECT_STATE);
     VerifyOrReturnError(mRole == TransferRole::kReceiver, CHIP_ERROR_INCORRECT_STATE);
     VerifyOrReturnError(mPendingOutput == OutputEventType::kNone, CHIP_ERROR_INCORRECT_STATE);
-    VerifyOrReturnError(!mAwaitingResponse, CHIP_ERROR_INCORRECT_STATE);
+    VerifyOrReturnError(!mAwaitingResponse || IsWindowed(), CHIP_ERROR_INCORRECT_STATE);
 
     BlockQuery queryMsg;
     queryMsg.BlockCounter = mNextQueryNum;
@@ -281,7 +387,15 @@ CHIP_ERROR TransferSession::PrepareBlockQuery()
 #endif // CHIP_AUTOMATION_LOGGING
 
     mAwaitingResponse = true;
-    mLastQueryNum     = mNextQueryNum++;
+    if (IsWindowed())
+    {
+        // The query acknowledges the Blocks received so far, mNextQueryNum moves on as Blocks are received.
+        mLastQueryNum = mNextQueryNum;
+    }
+    else
+    {
+        mLastQueryNum = mNextQueryNum++;
+    }
 
     PrepareOutgoingMessageEvent(msgType, mPendingOutput, mMsgTypeData);
 
@@ -308,8 +422,16 @@ CHIP_ERROR TransferSession::PrepareBlockQueryWithSkip(const uint64_t & bytesToSk
     queryMsg.LogMessage(msgType);
 #endif // CHIP_AUTOMATION_LOGGING
 
+    // In a windowed transfer, a skip is only possible while no Block is outstanding: the sender skips from the next Block.
     mAwaitingResponse = true;
-    mLastQueryNum     = mNextQueryNum++;
+    if (IsWindowed())
+    {
+        mLastQueryNum = mNextQueryNum;
+    }
+    else
+    {
+        mLastQueryNum = mNextQueryNum++;
+    }
 
     PrepareOutgoingMessageEvent(msgType, mPendingOutput, mMsgTypeData);
 
@@ -321,7 +443,7 @@ CHIP_ERROR TransferSession::PrepareBlock(const BlockData & inData)
     VerifyOrReturnError(mState == TransferState::kTransferInProgress, CHIP_ERROR_INCORRECT_STATE);
     VerifyOrReturnError(mRole == TransferRole::kSender, CHIP_ERROR_INCORRECT_STATE);
     VerifyOrReturnError(mPendingOutput == OutputEventType::kNone, CHIP_ERROR_INCORRECT_STATE);
-    VerifyOrReturnError(!mAwaitingResponse, CHIP_ERROR_INCORRECT_STATE);
+    VerifyOrReturnError(IsWindowed() ? (mNextBlockNum < mWindowEnd) : !mAwaitingResponse, CHIP_ERROR_INCORRECT_STATE);
 
     // Verify non-zero data is provided and is no longer than MaxBlockSize (BlockEOF may contain 0 length data)
     VerifyOrReturnError((inData.Data != nullptr) && (inData.Length <= mTransferMaxBlockSize), CHIP_ERROR_INVALID_ARGUMENT);
@@ -345,7 +467,13 @@ CHIP_ERROR TransferSession::PrepareBlock(const BlockData & inData)
         mState = TransferState::kAwaitingEOFAck;
     }
 
-    mAwaitingResponse = true;
+    // Keep the length of the Block in case the receiver of a windowed transfer asks for it again
+    mWindowBlockLengths[mNextBlockNum % kMaxWindowSize] = static_cast<uint16_t>(inData.Length);
+    mNumBytesProcessed += inData.Length;
+
+    // In a windowed transfer, the sender only waits for a BlockQuery once the window is full
+    mAwaitingResponse = !IsWindowed() || inData.IsEof || (mNextBlockNum + 1 >= mWindowEnd);
+    mBlockRequested   = false;
     mLastBlockNum     = mNextBlockNum++;
 
     PrepareOutgoingMessageEvent(msgType, mPendingOutput, mMsgTypeData);
@@ -359,6 +487,8 @@ CHIP_ERROR TransferSession::PrepareBlockAck()
     VerifyOrReturnError((mState == TransferState::kTransferInProgress) || (mState == TransferState::kReceivedEOF),
                         CHIP_ERROR_INCORRECT_STATE);
     VerifyOrReturnError(mPendingOutput == OutputEventType::kNone, CHIP_ERROR_INCORRECT_STATE);
+    // In a windowed transfer, the BlockQuery messages acknowledge the Blocks
+    VerifyOrReturnError(!IsWindowed() || mState == TransferState::kReceivedEOF, CHIP_ERROR_INCORRECT_STATE);
 
     CounterMessage ackMsg;
     ackMsg.BlockCounter       = mLastBlockNum;
@@ -426,6 +556,13 @@ void TransferSession::Reset()
     mTimeoutStartTime       = System::Clock::kZero;
     mShouldInitTimeoutStart = true;
     mAwaitingResponse       = false;
+
+    mProposedWindowSize = 0;
+    mWindowSize         = 1;
+    mWindowEnd          = 0;
+    mBlockRequested     = false;
+    mRecoveringWindow   = false;
+    mLastRecoveryTime   = System::Clock::kZero;
 }
 
 CHIP_ERROR TransferSession::HandleMessageReceived(const PayloadHeader & payloadHeader, System::PacketBufferHandle msg,
@@ -546,6 +683,12 @@ void TransferSession::HandleTransferInit(MessageType msgType, System::PacketBuff
     mTransferVersion      = ::chip::min(kBdxVersion, transferInit.Version);
     mTransferMaxBlockSize = ::chip::min(mMaxSupportedBlockSize, transferInit.MaxBlockSize);
 
+    // A proposed window larger than supported can still be accepted with the largest window
+    size_t metadataLength     = transferInit.MetadataLength;
+    const uint16_t windowSize = ExtractWindowSize(transferInit.Metadata, metadataLength);
+    mProposedWindowSize =
+        transferInit.TransferCtlOptions.Has(TransferControlFlags::kReceiverDrive) ? ::chip::min(windowSize, kMaxWindowSize) : 0;
+
     // Accept for now, they may be changed or rejected by the peer if this is a ReceiveInit
     mStartOffset    = transferInit.StartOffset;
     mTransferLength = transferInit.MaxLength;
@@ -557,8 +700,9 @@ void TransferSession::HandleTransferInit(MessageType msgType, System::PacketBuff
     mTransferRequestData.Length           = transferInit.MaxLength;
     mTransferRequestData.FileDesignator   = transferInit.FileDesignator;
     mTransferRequestData.FileDesLength    = transferInit.FileDesLength;
-    mTransferRequestData.Metadata         = transferInit.Metadata;
-    mTransferRequestData.MetadataLength   = transferInit.MetadataLength;
+    mTransferRequestData.Metadata         = (metadataLength > 0) ? transferInit.Metadata : nullptr;
+    mTransferRequestData.MetadataLength   = metadataLength;
+    mTransferRequestData.WindowSize       = mProposedWindowSize;
 
     mPendingMsgHandle = std::move(msgData);
     mPendingOutput    = OutputEventType::kInitReceived;
@@ -582,6 +726,12 @@ void TransferSession::HandleReceiveAccept(System::PacketBufferHandle msgData)
     // Verify that Accept parameters are compatible with the original proposed parameters
     ReturnOnFailure(VerifyProposedMode(rcvAcceptMsg.TransferCtlFlags));
 
+    size_t metadataLength     = rcvAcceptMsg.MetadataLength;
+    const uint16_t windowSize = ExtractWindowSize(rcvAcceptMsg.Metadata, metadataLength);
+    VerifyOrReturn(windowSize <= 1 || (mControlMode == TransferControlFlags::kReceiverDrive && windowSize <= mProposedWindowSize),
+                   PrepareStatusReport(StatusCode::kBadMessageContents));
+    mWindowSize = ::chip::max<uint16_t>(windowSize, 1);
+
     mTransferMaxBlockSize = rcvAcceptMsg.MaxBlockSize;
     mStartOffset          = rcvAcceptMsg.StartOffset;
     mTransferLength       = rcvAcceptMsg.Length;
@@ -592,8 +742,9 @@ void TransferSession::HandleReceiveAccept(System::PacketBufferHandle msgData)
     mTransferAcceptData.MaxBlockSize   = rcvAcceptMsg.MaxBlockSize;
     mTransferAcceptData.StartOffset    = rcvAcceptMsg.StartOffset;
     mTransferAcceptData.Length         = rcvAcceptMsg.Length;
-    mTransferAcceptData.Metadata       = rcvAcceptMsg.Metadata;
-    mTransferAcceptData.MetadataLength = rcvAcceptMsg.MetadataLength;
+    mTransferAcceptData.Metadata       = (metadataLength > 0) ? rcvAcceptMsg.Metadata : nullptr;
+    mTransferAcceptData.MetadataLength = metadataLength;
+    mTransferAcceptData.WindowSize     = mWindowSize;
 
     mPendingMsgHandle = std::move(msgData);
     mPendingOutput    = OutputEventType::kAcceptReceived;
@@ -618,6 +769,12 @@ void TransferSession::HandleSendAccept(System::PacketBufferHandle msgData)
     // Verify that Accept parameters are compatible with the original proposed parameters
     ReturnOnFailure(VerifyProposedMode(sendAcceptMsg.TransferCtlFlags));
 
+    size_t metadataLength     = sendAcceptMsg.MetadataLength;
+    const uint16_t windowSize = ExtractWindowSize(sendAcceptMsg.Metadata, metadataLength);
+    VerifyOrReturn(windowSize <= 1 || (mControlMode == TransferControlFlags::kReceiverDrive && windowSize <= mProposedWindowSize),
+                   PrepareStatusReport(StatusCode::kBadMessageContents));
+    mWindowSize = ::chip::max<uint16_t>(windowSize, 1);
+
     // Note: if VerifyProposedMode() returned with no error, then mControlMode must match the proposed mode in the SendAccept
     // message
     mTransferMaxBlockSize = sendAcceptMsg.MaxBlockSize;
@@ -626,8 +783,9 @@ void TransferSession::HandleSendAccept(System::PacketBufferHandle msgData)
     mTransferAcceptData.MaxBlockSize   = sendAcceptMsg.MaxBlockSize;
     mTransferAcceptData.StartOffset    = mStartOffset;    // Not included in SendAccept msg, so use member
     mTransferAcceptData.Length         = mTransferLength; // Not included in SendAccept msg, so use member
-    mTransferAcceptData.Metadata       = sendAcceptMsg.Metadata;
-    mTransferAcceptData.MetadataLength = sendAcceptMsg.MetadataLength;
+    mTransferAcceptData.Metadata       = (metadataLength > 0) ? sendAcceptMsg.Metadata : nullptr;
+    mTransferAcceptData.MetadataLength = metadataLength;
+    mTransferAcceptData.WindowSize     = mWindowSize;
 
     mPendingMsgHandle = std::move(msgData);
     mPendingOutput    = OutputEventType::kAcceptReceived;
@@ -643,13 +801,20 @@ void TransferSession::HandleSendAccept(System::PacketBufferHandle msgData)
 void TransferSession::HandleBlockQuery(System::PacketBufferHandle msgData)
 {
     VerifyOrReturn(mRole == TransferRole::kSender, PrepareStatusReport(StatusCode::kUnexpectedMessage));
-    VerifyOrReturn(mState == TransferState::kTransferInProgress, PrepareStatusReport(StatusCode::kUnexpectedMessage));
-    VerifyOrReturn(mAwaitingResponse, PrepareStatusReport(StatusCode::kUnexpectedMessage));
+    VerifyOrReturn(mState == TransferState::kTransferInProgress || IsWindowed(),
+                   PrepareStatusReport(StatusCode::kUnexpectedMessage));
+    VerifyOrReturn(mAwaitingResponse || IsWindowed(), PrepareStatusReport(StatusCode::kUnexpectedMessage));
 
     BlockQuery query;
     const CHIP_ERROR err = query.Parse(std::move(msgData));
     VerifyOrReturn(err == CHIP_NO_ERROR, PrepareStatusReport(StatusCode::kBadMessageContents));
 
+    if (IsWindowed())
+    {
+        HandleWindowedQuery(MessageType::BlockQuery, query.BlockCounter, 0);
+        return;
+    }
+
     VerifyOrReturn(query.BlockCounter == mNextBlockNum, PrepareStatusReport(StatusCode::kBadBlockCounter));
 
     mPendingOutput = OutputEventType::kQueryReceived;
@@ -665,13 +830,20 @@ void TransferSession::HandleBlockQuery(System::PacketBufferHandle msgData)
 void TransferSession::HandleBlockQueryWithSkip(System::PacketBufferHandle msgData)
 {
     VerifyOrReturn(mRole == TransferRole::kSender, PrepareStatusReport(StatusCode::kUnexpectedMessage));
-    VerifyOrReturn(mState == TransferState::kTransferInProgress, PrepareStatusReport(StatusCode::kUnexpectedMessage));
-    VerifyOrReturn(mAwaitingResponse, PrepareStatusReport(StatusCode::kUnexpectedMessage));
+    VerifyOrReturn(mState == TransferState::kTransferInProgress || IsWindowed(),
+                   PrepareStatusReport(StatusCode::kUnexpectedMessage));
+    VerifyOrReturn(mAwaitingResponse || IsWindowed(), PrepareStatusReport(StatusCode::kUnexpectedMessage));
 
     BlockQueryWithSkip query;
     const CHIP_ERROR err = query.Parse(std::move(msgData));
     VerifyOrReturn(err == CHIP_NO_ERROR, PrepareStatusReport(StatusCode::kBadMessageContents));
 
+    if (IsWindowed())
+    {
+        HandleWindowedQuery(MessageType::BlockQueryWithSkip, query.BlockCounter, query.BytesToSkip);
+        return;
+    }
+
     VerifyOrReturn(query.BlockCounter == mNextBlockNum, PrepareStatusReport(StatusCode::kBadBlockCounter));
 
     mPendingOutput = OutputEventType::kQueryWithSkipReceived;
@@ -679,6 +851,7 @@ void TransferSession::HandleBlockQueryWithSkip(System::PacketBufferHandle msgDat
     mAwaitingResponse        = false;
     mLastQueryNum            = query.BlockCounter;
     mBytesToSkip.BytesToSkip = query.BytesToSkip;
+    mNumBytesProcessed += static_cast<size_t>(query.BytesToSkip);
 
 #if CHIP_AUTOMATION_LOGGING
     query.LogMessage(MessageType::BlockQueryWithSkip);
@@ -687,6 +860,12 @@ void TransferSession::HandleBlockQueryWithSkip(System::PacketBufferHandle msgDat
 
 void TransferSession::HandleBlock(System::PacketBufferHandle msgData)
 {
+    if (IsWindowed())
+    {
+        HandleWindowedBlock(MessageType::Block, std::move(msgData));
+        return;
+    }
+
     VerifyOrReturn(mRole == TransferRole::kReceiver, PrepareStatusReport(StatusCode::kUnexpectedMessage));
     VerifyOrReturn(mState == TransferState::kTransferInProgress, PrepareStatusReport(StatusCode::kUnexpectedMessage));
     VerifyOrReturn(mAwaitingResponse, PrepareStatusReport(StatusCode::kUnexpectedMessage));
@@ -725,6 +904,12 @@ void TransferSession::HandleBlock(System::PacketBufferHandle msgData)
 
 void TransferSession::HandleBlockEOF(System::PacketBufferHandle msgData)
 {
+    if (IsWindowed())
+    {
+        HandleWindowedBlock(MessageType::BlockEOF, std::move(msgData));
+        return;
+    }
+
     VerifyOrReturn(mRole == TransferRole::kReceiver, PrepareStatusReport(StatusCode::kUnexpectedMessage));
     VerifyOrReturn(mState == TransferState::kTransferInProgress, PrepareStatusReport(StatusCode::kUnexpectedMessage));
     VerifyOrReturn(mAwaitingResponse, PrepareStatusReport(StatusCode::kUnexpectedMessage));
@@ -799,6 +984,134 @@ void TransferSession::HandleBlockAckEOF(System::PacketBufferHandle msgData)
 #endif // CHIP_AUTOMATION_LOGGING
 }
 
+void TransferSession::HandleWindowedBlock(MessageType msgType, System::PacketBufferHandle msgData)
+{
+    VerifyOrReturn(mRole == TransferRole::kReceiver, PrepareStatusReport(StatusCode::kUnexpectedMessage));
+
+    DataBlock blockMsg;
+    const CHIP_ERROR err = blockMsg.Parse(msgData.Retain());
+    VerifyOrReturn(err == CHIP_NO_ERROR, PrepareStatusReport(StatusCode::kBadMessageContents));
+
+    // Blocks sent before the sender went back to an earlier Block may still arrive, even once the transfer is over.
+    VerifyOrReturn(blockMsg.BlockCounter >= mNextQueryNum);
+
+    VerifyOrReturn(mState == TransferState::kTransferInProgress, PrepareStatusReport(StatusCode::kUnexpectedMessage));
+    VerifyOrReturn(blockMsg.BlockCounter < mLastQueryNum + mWindowSize, PrepareStatusReport(StatusCode::kBadBlockCounter));
+
+    if (blockMsg.BlockCounter != mNextQueryNum)
+    {
+        // A Block was lost. Ask the sender to go back to it, and ignore the Blocks which follow it until it arrives.
+        if (!mRecoveringWindow)
+        {
+            PrepareWindowRecovery();
+        }
+        return;
+    }
+
+    const bool isEof = (msgType == MessageType::BlockEOF);
+    VerifyOrReturn((isEof || blockMsg.DataLength > 0) && (blockMsg.DataLength <= mTransferMaxBlockSize),
+                   PrepareStatusReport(StatusCode::kBadMessageContents));
+
+    if (!isEof && IsTransferLengthDefinite())
+    {
+        VerifyOrReturn(mNumBytesProcessed + blockMsg.DataLength <= mTransferLength,
+                       PrepareStatusReport(StatusCode::kLengthMismatch));
+    }
+
+    mBlockEventData.Data         = blockMsg.Data;
+    mBlockEventData.Length       = blockMsg.DataLength;
+    mBlockEventData.IsEof        = isEof;
+    mBlockEventData.BlockCounter = blockMsg.BlockCounter;
+
+    mPendingMsgHandle = std::move(msgData);
+    mPendingOutput    = OutputEventType::kBlockReceived;
+
+    mNumBytesProcessed += blockMsg.DataLength;
+    mLastBlockNum     = blockMsg.BlockCounter;
+    mNextQueryNum     = blockMsg.BlockCounter + 1;
+    mRecoveringWindow = false;
+
+    if (isEof)
+    {
+        mAwaitingResponse = false;
+        mState            = TransferState::kReceivedEOF;
+    }
+    else
+    {
+        // More Blocks are expected until the receiver has received the whole window of its last BlockQuery
+        mAwaitingResponse = (mNextQueryNum < mLastQueryNum + mWindowSize);
+    }
+
+#if CHIP_AUTOMATION_LOGGING
+    blockMsg.LogMessage(msgType);
+#endif // CHIP_AUTOMATION_LOGGING
+}
+
+void TransferSession::HandleWindowedQuery(MessageType msgType, uint32_t blockCounter, uint64_t bytesToSkip)
+{
+    VerifyOrReturn(mState == TransferState::kTransferInProgress || mState == TransferState::kAwaitingEOFAck,
+                   PrepareStatusReport(StatusCode::kUnexpectedMessage));
+
+    // A query which arrives after a later one carries no information.
+    VerifyOrReturn(blockCounter >= mLastQueryNum);
+    VerifyOrReturn(blockCounter <= mNextBlockNum, PrepareStatusReport(StatusCode::kBadBlockCounter));
+
+    mLastQueryNum = blockCounter;
+    mWindowEnd    = blockCounter + mWindowSize;
+
+    if (msgType == MessageType::BlockQueryWithSkip)
+    {
+        // Go back to the Block asked for, which starts bytesToSkip bytes after the end of the Block before it.
+        while (mNextBlockNum > blockCounter)
+        {
+            mNextBlockNum--;
+            mNumBytesProcessed -= mWindowBlockLengths[mNextBlockNum % kMaxWindowSize];
+        }
+        mNumBytesProcessed += static_cast<size_t>(bytesToSkip);
+
+        mState                   = TransferState::kTransferInProgress;
+        mBytesToSkip.BytesToSkip = bytesToSkip;
+        mPendingOutput           = OutputEventType::kQueryWithSkipReceived;
+        mBlockRequested          = true;
+    }
+
+    mAwaitingResponse = (mState == TransferState::kAwaitingEOFAck) || (mNextBlockNum >= mWindowEnd);
+}
+
+void TransferSession::PrepareWindowRecovery()
+{
+    const MessageType msgType = MessageType::BlockQueryWithSkip;
+
+    BlockQueryWithSkip queryMsg;
+    queryMsg.BlockCounter = mNextQueryNum;
+    queryMsg.BytesToSkip  = 0;
+
+    const CHIP_ERROR err = WriteToPacketBuffer(queryMsg, mPendingMsgHandle);
+    VerifyOrReturn(err == CHIP_NO_ERROR,
+                   ChipLogError(BDX, "%s: error preparing message: %" CHIP_ERROR_FORMAT, __FUNCTION__, err.Format()));
+
+#if CHIP_AUTOMATION_LOGGING
+    ChipLogAutomation("Sending BDX Message");
+    queryMsg.LogMessage(msgType);
+#endif // CHIP_AUTOMATION_LOGGING
+
+    mAwaitingResponse = true;
+    mRecoveringWindow = true;
+    mLastQueryNum     = mNextQueryNum;
+
+    PrepareOutgoingMessageEvent(msgType, mPendingOutput, mMsgTypeData);
+}
+
+bool TransferSession::IsWindowRecoveryDue(System::Clock::Timestamp curTime) const
+{
+    VerifyOrReturnValue(IsWindowed() && mRole == TransferRole::kReceiver, false);
+    VerifyOrReturnValue(mState == TransferState::kTransferInProgress && mAwaitingResponse, false);
+    VerifyOrReturnValue(mPendingOutput == OutputEventType::kNone, false);
+
+    // Nothing was received nor sent since the last message or the last recovery
+    return (curTime - ::chip::max(mTimeoutStartTime, mLastRecoveryTime)) >= kWindowRecoveryInterval;
+}
+
 void TransferSession::ResolveTransferControlOptions(const BitFlags<TransferControlFlags> & proposed)
 {
     // Must specify at least one synchronous option
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <lib/core/CHIPConfig.h>
 #include <lib/core/CHIPError.h>
 #include <protocols/bdx/BdxMessages.h>
 #include <system/SystemPacketBuffer.h>
@@ -23,6 +24,25 @@ enum class TransferRole : uint8_t
     kSender   = 1,
 };
 
+/**
+ * @brief
+ *   Windowed transfers
+ *
+ *   A Receiver Drive transfer may be windowed when both peers support the proprietary extension of kWindowSizeMetadataTag: the
+ *   initiator proposes a window size W in its TransferInit message, and the responder accepts at most W in its Accept message.
+ *   When the responder does not accept a window, the transfer falls back to the standard synchronous mode.
+ *
+ *   In a windowed transfer, a BlockQuery with counter N tells the sender that every Block before N was received, and lets it
+ *   send the Blocks up to N + W - 1 without waiting: the sender emits a kQueryReceived event for each Block it may send, and the
+ *   receiver may call PrepareBlockQuery() after every Block it processes. When the receiver gets a Block past the next one it
+ *   expects, or no Block for kWindowRecoveryInterval, it sends a BlockQueryWithSkip with the counter of the next Block expected,
+ *   and the sender goes back to that Block. The sender emits a kQueryWithSkipReceived event, and must read the offset of the next
+ *   Block from GetNumBytesProcessed().
+ *
+ *   MRP only allows one unacknowledged message per exchange: the Block, BlockQuery and BlockQueryWithSkip messages of a windowed
+ *   transfer should be sent without requesting an acknowledgement nor expecting a response, the TransferSession recovers the
+ *   messages lost itself.
+ */
 class DLL_EXPORT TransferSession
 {
 public:
@@ -56,6 +76,10 @@ public:
         // Additional metadata (optional, TLV format)
         const uint8_t * Metadata = nullptr;
         size_t MetadataLength    = 0;
+
+        // Number of Blocks the sender may send ahead of the receiver's BlockQuery (Receiver Drive only). Values above 1 propose a
+        // windowed transfer, see kWindowSizeMetadataTag. 0 or 1 is a standard synchronous transfer.
+        uint16_t WindowSize = 0;
     };
 
     struct TransferAcceptData
@@ -69,6 +93,10 @@ public:
         // Additional metadata (optional, TLV format)
         const uint8_t * Metadata = nullptr;
         size_t MetadataLength    = 0;
+
+        // Accepted window size, no larger than the one proposed by the TransferInit message. 0 or 1 falls back to a standard
+        // synchronous transfer.
+        uint16_t WindowSize = 0;
     };
 
     struct StatusReportData
@@ -144,6 +172,10 @@ public:
         static OutputEvent QueryWithSkipEvent(TransferSkipData bytesToSkip);
     };
 
+    static constexpr uint16_t kMaxWindowSize = CHIP_CONFIG_BDX_MAX_WINDOW_SIZE;
+    static constexpr System::Clock::Milliseconds32 kWindowRecoveryInterval =
+        System::Clock::Milliseconds32(CHIP_CONFIG_BDX_WINDOW_RECOVERY_INTERVAL_MS);
+
     /**
      * @brief
      *   Indicates the presence of pending output and includes any data for the caller to take action on.
@@ -298,6 +330,13 @@ public:
     uint16_t GetTransferBlockSize() const { return mTransferMaxBlockSize; }
     uint32_t GetNextBlockNum() const { return mNextBlockNum; }
     uint32_t GetNextQueryNum() const { return mNextQueryNum; }
+    uint16_t GetWindowSize() const { return mWindowSize; }
+
+    /**
+     * @brief
+     *   Number of bytes received by the receiver. For the sender, offset of the next Block from the start of the transfer, which
+     *   a BlockQueryWithSkip may move forward or, in a windowed transfer, back.
+     */
     size_t GetNumBytesProcessed() const { return mNumBytesProcessed; }
     const uint8_t * GetFileDesignator(uint16_t & fileDesignatorLen) const
     {
@@ -347,6 +386,21 @@ private:
      */
     CHIP_ERROR VerifyProposedMode(const BitFlags<TransferControlFlags> & proposed);
 
+    /**
+     * @brief
+     *   Windowed counterparts of the Block and BlockQuery handlers, see the class description.
+     */
+    void HandleWindowedBlock(MessageType msgType, System::PacketBufferHandle msgData);
+    void HandleWindowedQuery(MessageType msgType, uint32_t blockCounter, uint64_t bytesToSkip);
+
+    /**
+     * @brief
+     *   Prepare a BlockQueryWithSkip asking the sender of a windowed transfer to send again the Blocks from the next one expected.
+     */
+    void PrepareWindowRecovery();
+    bool IsWindowRecoveryDue(System::Clock::Timestamp curTime) const;
+    bool IsWindowed() const { return mWindowSize > 1; }
+
     void PrepareStatusReport(StatusCode code);
     bool IsTransferLengthDefinite() const;
 
@@ -385,6 +439,20 @@ private:
     System::Clock::Timestamp mTimeoutStartTime = System::Clock::kZero;
     bool mShouldInitTimeoutStart               = true;
     bool mAwaitingResponse                     = false;
+
+    // Window proposed by the initiator, and window in use once the transfer is accepted (1 for a synchronous transfer)
+    uint16_t mProposedWindowSize = 0;
+    uint16_t mWindowSize         = 1;
+
+    // Sender of a windowed transfer: Blocks may be sent up to mWindowEnd (excluded). mBlockRequested is set once a kQueryReceived
+    // event has been emitted for the next Block, and mWindowBlockLengths keeps the lengths of the Blocks which may be sent again.
+    uint32_t mWindowEnd                          = 0;
+    bool mBlockRequested                         = false;
+    uint16_t mWindowBlockLengths[kMaxWindowSize] = {};
+
+    // Receiver of a windowed transfer: set once a BlockQueryWithSkip asked for the missing Block, until it arrives
+    bool mRecoveringWindow                     = false;
+    System::Clock::Timestamp mLastRecoveryTime = System::Clock::kZero;
 };
 
 } // namespace bdx
@@ -25,6 +25,10 @@ constexpr System::Clock::Timestamp kNoAdvanceTime = System::Clock::kZero;
 
 const TLV::Tag tlvStrTag  = TLV::ContextTag(4);
 const TLV::Tag tlvListTag = TLV::ProfileTag(7777, 8888);
+
+// Parameters of the windowed transfer tests
+constexpr uint16_t kWindowedBlockSize = 64;
+constexpr uint32_t kMaxWindowedBlocks = 16;
 } // anonymous namespace
 
 // Helper method for generating a complete TLV structure with a list containing a single tag and string
@@ -724,6 +728,312 @@ void TestDuplicateBlockError(nlTestSuite * inSuite, void * inContext)
     }
 }
 
+// Helper method for initializing a windowed transfer between an initiating receiver and a responding sender.
+void SetUpWindowedTransfer(nlTestSuite * inSuite, void * inContext, TransferSession & initiatingReceiver,
+                           TransferSession & respondingSender, uint16_t windowSize)
+{
+    TransferSession::OutputEvent outEvent;
+    TransferControlFlags driveMode = TransferControlFlags::kReceiverDrive;
+    System::Clock::Timeout timeout = System::Clock::Seconds16(24);
+
+    TransferSession::TransferInitData initOptions;
+    initOptions.TransferCtlFlags = driveMode;
+    initOptions.MaxBlockSize     = kWindowedBlockSize;
+    char testFileDes[9]          = { "test.txt" };
+    initOptions.FileDesLength    = static_cast<uint16_t>(strlen(testFileDes));
+    initOptions.FileDesignator   = reinterpret_cast<uint8_t *>(testFileDes);
+    initOptions.WindowSize       = windowSize;
+
+    BitFlags<TransferControlFlags> senderOpts;
+    senderOpts.Set(driveMode);
+
+    SendAndVerifyTransferInit(inSuite, inContext, outEvent, timeout, initiatingReceiver, TransferRole::kReceiver, initOptions,
+                              respondingSender, senderOpts, kWindowedBlockSize);
+    NL_TEST_ASSERT(inSuite, outEvent.transferInitData.WindowSize == windowSize);
+
+    TransferSession::TransferAcceptData acceptData;
+    acceptData.ControlMode  = respondingSender.GetControlMode();
+    acceptData.MaxBlockSize = kWindowedBlockSize;
+    acceptData.WindowSize   = windowSize;
+
+    SendAndVerifyAcceptMsg(inSuite, inContext, outEvent, respondingSender, TransferRole::kSender, acceptData, initiatingReceiver,
+                           initOptions);
+    NL_TEST_ASSERT(inSuite, outEvent.transferAcceptData.WindowSize == windowSize);
+    NL_TEST_ASSERT(inSuite, respondingSender.GetWindowSize() == windowSize);
+    NL_TEST_ASSERT(inSuite, initiatingReceiver.GetWindowSize() == windowSize);
+}
+
+// Helper method for the sender of a windowed transfer: prepare the next Block, filled with its offset in the transfer, and
+// output the message to send in blockEvent.
+void PrepareWindowedBlock(nlTestSuite * inSuite, void * inContext, TransferSession & sender, bool isEof,
+                          TransferSession::OutputEvent & blockEvent)
+{
+    uint8_t data[kWindowedBlockSize];
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = static_cast<uint8_t>(sender.GetNumBytesProcessed() + i);
+    }
+
+    TransferSession::BlockData blockData;
+    blockData.Data   = data;
+    blockData.Length = sizeof(data);
+    blockData.IsEof  = isEof;
+
+    CHIP_ERROR err = sender.PrepareBlock(blockData);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    sender.PollOutput(blockEvent, kNoAdvanceTime);
+    VerifyBdxMessageToSend(inSuite, inContext, blockEvent, isEof ? MessageType::BlockEOF : MessageType::Block);
+}
+
+// Helper method for the receiver of a windowed transfer: pass it a Block message and verify that it is received as the next Block,
+// at the right offset in the transfer.
+void ReceiveWindowedBlock(nlTestSuite * inSuite, void * inContext, TransferSession & receiver,
+                          TransferSession::OutputEvent & blockEvent, uint32_t expectedCounter)
+{
+    TransferSession::OutputEvent outEvent;
+
+    CHIP_ERROR err = AttachHeaderAndSend(blockEvent.msgTypeData, std::move(blockEvent.MsgData), receiver);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    receiver.PollOutput(outEvent, kNoAdvanceTime);
+    NL_TEST_ASSERT(inSuite, outEvent.EventType == TransferSession::OutputEventType::kBlockReceived);
+    if (outEvent.EventType == TransferSession::OutputEventType::kBlockReceived && outEvent.blockdata.Data != nullptr)
+    {
+        const size_t offset = receiver.GetNumBytesProcessed() - outEvent.blockdata.Length;
+        NL_TEST_ASSERT(inSuite, outEvent.blockdata.BlockCounter == expectedCounter);
+        NL_TEST_ASSERT(inSuite, outEvent.blockdata.Data[0] == static_cast<uint8_t>(offset));
+    }
+    VerifyNoMoreOutput(inSuite, inContext, receiver);
+}
+
+// Helper method for completing a windowed transfer while no Block is in flight: the receiver queries the next Block after each
+// Block it receives, and the sender sends Blocks as long as its window allows it. senderEvent is the last event of the sender.
+void CompleteWindowedTransfer(nlTestSuite * inSuite, void * inContext, TransferSession & sender, TransferSession & receiver,
+                              TransferSession::OutputEvent & senderEvent, uint32_t numBlocks)
+{
+    TransferSession::OutputEvent blocks[kMaxWindowedBlocks];
+    uint32_t numBlocksSent     = sender.GetNextBlockNum();
+    uint32_t numBlocksReceived = receiver.GetNextQueryNum();
+    const uint32_t windowSize  = sender.GetWindowSize();
+
+    NL_TEST_ASSERT(inSuite, numBlocks <= kMaxWindowedBlocks);
+    NL_TEST_ASSERT(inSuite, numBlocksSent == numBlocksReceived);
+
+    while (numBlocksReceived < numBlocks)
+    {
+        // The sender fills the window opened by the last BlockQuery, and can't send past it
+        while (senderEvent.EventType == TransferSession::OutputEventType::kQueryReceived)
+        {
+            PrepareWindowedBlock(inSuite, inContext, sender, numBlocksSent == numBlocks - 1, blocks[numBlocksSent]);
+            numBlocksSent++;
+            sender.PollOutput(senderEvent, kNoAdvanceTime);
+        }
+        NL_TEST_ASSERT(inSuite, senderEvent.EventType == TransferSession::OutputEventType::kNone);
+        NL_TEST_ASSERT(inSuite, numBlocksSent == chip::min(numBlocksReceived + windowSize, numBlocks));
+
+        if (numBlocksSent < numBlocks)
+        {
+            uint8_t data[kWindowedBlockSize] = { 0 };
+            TransferSession::BlockData blockData;
+            blockData.Data   = data;
+            blockData.Length = sizeof(data);
+            NL_TEST_ASSERT(inSuite, sender.PrepareBlock(blockData) != CHIP_NO_ERROR);
+        }
+
+        ReceiveWindowedBlock(inSuite, inContext, receiver, blocks[numBlocksReceived], numBlocksReceived);
+        numBlocksReceived++;
+
+        if (numBlocksReceived < numBlocks)
+        {
+            // The BlockQuery for the next Block moves the window on by one Block
+            TransferSession::OutputEvent queryEvent;
+            CHIP_ERROR err = receiver.PrepareBlockQuery();
+            NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+            receiver.PollOutput(queryEvent, kNoAdvanceTime);
+            VerifyBdxMessageToSend(inSuite, inContext, queryEvent, MessageType::BlockQuery);
+            err = AttachHeaderAndSend(queryEvent.msgTypeData, std::move(queryEvent.MsgData), sender);
+            NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+            sender.PollOutput(senderEvent, kNoAdvanceTime);
+        }
+    }
+
+    TransferSession::OutputEvent outEvent;
+    SendAndVerifyBlockAck(inSuite, inContext, sender, receiver, outEvent, true);
+}
+
+// Test a full windowed transfer: the sender sends a window of Blocks ahead of the BlockQuery of the receiver.
+void TestWindowedTransfer(nlTestSuite * inSuite, void * inContext)
+{
+    TransferSession::OutputEvent outEvent;
+    TransferSession initiatingReceiver;
+    TransferSession respondingSender;
+
+    SetUpWindowedTransfer(inSuite, inContext, initiatingReceiver, respondingSender, 4);
+
+    // The first BlockQuery opens the window
+    SendAndVerifyQuery(inSuite, inContext, respondingSender, initiatingReceiver, outEvent);
+    CompleteWindowedTransfer(inSuite, inContext, respondingSender, initiatingReceiver, outEvent, 10);
+    NL_TEST_ASSERT(inSuite, initiatingReceiver.GetNumBytesProcessed() == 10 * kWindowedBlockSize);
+}
+
+// Test that a windowed transfer falls back to a synchronous transfer when the responder does not accept a window, and that the
+// window size extension is invisible to the application metadata.
+void TestWindowedTransferFallback(nlTestSuite * inSuite, void * inContext)
+{
+    CHIP_ERROR err = CHIP_NO_ERROR;
+    TransferSession::OutputEvent outEvent;
+    TransferSession initiatingReceiver;
+    TransferSession respondingSender;
+
+    TransferControlFlags driveMode = TransferControlFlags::kReceiverDrive;
+    System::Clock::Timeout timeout = System::Clock::Seconds16(24);
+
+    uint8_t tlvBuf[64]    = { 0 };
+    char metadataStr[11]  = { "hi_dad.txt" };
+    uint32_t bytesWritten = 0;
+    err                   = WriteChipTLVString(tlvBuf, sizeof(tlvBuf), metadataStr, bytesWritten);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+
+    TransferSession::TransferInitData initOptions;
+    initOptions.TransferCtlFlags = driveMode;
+    initOptions.MaxBlockSize     = kWindowedBlockSize;
+    char testFileDes[9]          = { "test.txt" };
+    initOptions.FileDesLength    = static_cast<uint16_t>(strlen(testFileDes));
+    initOptions.FileDesignator   = reinterpret_cast<uint8_t *>(testFileDes);
+    initOptions.Metadata         = tlvBuf;
+    initOptions.MetadataLength   = bytesWritten;
+    initOptions.WindowSize       = 4;
+
+    BitFlags<TransferControlFlags> senderOpts;
+    senderOpts.Set(driveMode);
+
+    // The metadata received is the one of the application, without the window size
+    SendAndVerifyTransferInit(inSuite, inContext, outEvent, timeout, initiatingReceiver, TransferRole::kReceiver, initOptions,
+                              respondingSender, senderOpts, kWindowedBlockSize);
+    NL_TEST_ASSERT(inSuite, outEvent.transferInitData.WindowSize == 4);
+    err = ReadAndVerifyTLVString(inSuite, inContext, outEvent.transferInitData.Metadata,
+                                 static_cast<uint32_t>(outEvent.transferInitData.MetadataLength), metadataStr,
+                                 static_cast<uint16_t>(strlen(metadataStr)));
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+
+    // A window larger than the proposed one can't be accepted
+    TransferSession::TransferAcceptData acceptData;
+    acceptData.ControlMode  = respondingSender.GetControlMode();
+    acceptData.MaxBlockSize = kWindowedBlockSize;
+    acceptData.WindowSize   = 5;
+    err                     = respondingSender.AcceptTransfer(acceptData);
+    NL_TEST_ASSERT(inSuite, err != CHIP_NO_ERROR);
+
+    acceptData.WindowSize = 0;
+    SendAndVerifyAcceptMsg(inSuite, inContext, outEvent, respondingSender, TransferRole::kSender, acceptData, initiatingReceiver,
+                           initOptions);
+    NL_TEST_ASSERT(inSuite, outEvent.transferAcceptData.WindowSize == 1);
+    NL_TEST_ASSERT(inSuite, respondingSender.GetWindowSize() == 1);
+    NL_TEST_ASSERT(inSuite, initiatingReceiver.GetWindowSize() == 1);
+
+    // Only one Block can be sent per BlockQuery
+    SendAndVerifyQuery(inSuite, inContext, respondingSender, initiatingReceiver, outEvent);
+    SendAndVerifyArbitraryBlock(inSuite, inContext, respondingSender, initiatingReceiver, outEvent, false, 0);
+
+    uint8_t data[kWindowedBlockSize] = { 0 };
+    TransferSession::BlockData blockData;
+    blockData.Data   = data;
+    blockData.Length = sizeof(data);
+    NL_TEST_ASSERT(inSuite, respondingSender.PrepareBlock(blockData) != CHIP_NO_ERROR);
+    VerifyNoMoreOutput(inSuite, inContext, respondingSender);
+}
+
+// Test that the receiver of a windowed transfer recovers a lost Block with a BlockQueryWithSkip, and ignores the Blocks sent
+// before the sender went back to the lost one.
+void TestWindowedTransferRecovery(nlTestSuite * inSuite, void * inContext)
+{
+    CHIP_ERROR err = CHIP_NO_ERROR;
+    TransferSession::OutputEvent outEvent;
+    TransferSession::OutputEvent blocks[4];
+    TransferSession initiatingReceiver;
+    TransferSession respondingSender;
+
+    SetUpWindowedTransfer(inSuite, inContext, initiatingReceiver, respondingSender, 4);
+
+    SendAndVerifyQuery(inSuite, inContext, respondingSender, initiatingReceiver, outEvent);
+    for (auto & block : blocks)
+    {
+        PrepareWindowedBlock(inSuite, inContext, respondingSender, false, block);
+    }
+    VerifyNoMoreOutput(inSuite, inContext, respondingSender);
+
+    ReceiveWindowedBlock(inSuite, inContext, initiatingReceiver, blocks[0], 0);
+
+    // Block 1 is lost: Block 2 makes the receiver ask for it again, and Block 3 is ignored
+    err = AttachHeaderAndSend(blocks[2].msgTypeData, std::move(blocks[2].MsgData), initiatingReceiver);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    initiatingReceiver.PollOutput(outEvent, kNoAdvanceTime);
+    VerifyBdxMessageToSend(inSuite, inContext, outEvent, MessageType::BlockQueryWithSkip);
+    VerifyNoMoreOutput(inSuite, inContext, initiatingReceiver);
+
+    err = AttachHeaderAndSend(blocks[3].msgTypeData, std::move(blocks[3].MsgData), initiatingReceiver);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    VerifyNoMoreOutput(inSuite, inContext, initiatingReceiver);
+
+    // The sender goes back to Block 1
+    err = AttachHeaderAndSend(outEvent.msgTypeData, std::move(outEvent.MsgData), respondingSender);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    respondingSender.PollOutput(outEvent, kNoAdvanceTime);
+    NL_TEST_ASSERT(inSuite, outEvent.EventType == TransferSession::OutputEventType::kQueryWithSkipReceived);
+    NL_TEST_ASSERT(inSuite, outEvent.bytesToSkip.BytesToSkip == 0);
+    NL_TEST_ASSERT(inSuite, respondingSender.GetNextBlockNum() == 1);
+    NL_TEST_ASSERT(inSuite, respondingSender.GetNumBytesProcessed() == kWindowedBlockSize);
+
+    PrepareWindowedBlock(inSuite, inContext, respondingSender, false, blocks[1]);
+    ReceiveWindowedBlock(inSuite, inContext, initiatingReceiver, blocks[1], 1);
+
+    err = initiatingReceiver.PrepareBlockQuery();
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    initiatingReceiver.PollOutput(outEvent, kNoAdvanceTime);
+    VerifyBdxMessageToSend(inSuite, inContext, outEvent, MessageType::BlockQuery);
+    err = AttachHeaderAndSend(outEvent.msgTypeData, std::move(outEvent.MsgData), respondingSender);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    respondingSender.PollOutput(outEvent, kNoAdvanceTime);
+    NL_TEST_ASSERT(inSuite, outEvent.EventType == TransferSession::OutputEventType::kQueryReceived);
+
+    CompleteWindowedTransfer(inSuite, inContext, respondingSender, initiatingReceiver, outEvent, 8);
+    NL_TEST_ASSERT(inSuite, initiatingReceiver.GetNumBytesProcessed() == 8 * kWindowedBlockSize);
+}
+
+// Test that the receiver of a windowed transfer asks for the Blocks again when it receives none for kWindowRecoveryInterval.
+void TestWindowedTransferRecoveryTimer(nlTestSuite * inSuite, void * inContext)
+{
+    CHIP_ERROR err = CHIP_NO_ERROR;
+    TransferSession::OutputEvent outEvent;
+    TransferSession::OutputEvent lostBlock;
+    TransferSession initiatingReceiver;
+    TransferSession respondingSender;
+
+    const System::Clock::Timestamp recoveryTime = kNoAdvanceTime + TransferSession::kWindowRecoveryInterval;
+
+    SetUpWindowedTransfer(inSuite, inContext, initiatingReceiver, respondingSender, 2);
+
+    SendAndVerifyQuery(inSuite, inContext, respondingSender, initiatingReceiver, outEvent);
+    PrepareWindowedBlock(inSuite, inContext, respondingSender, false, lostBlock);
+
+    initiatingReceiver.PollOutput(outEvent, recoveryTime - System::Clock::Milliseconds64(1));
+    NL_TEST_ASSERT(inSuite, outEvent.EventType == TransferSession::OutputEventType::kNone);
+
+    initiatingReceiver.PollOutput(outEvent, recoveryTime);
+    VerifyBdxMessageToSend(inSuite, inContext, outEvent, MessageType::BlockQueryWithSkip);
+
+    // The next recovery is only due after another interval
+    TransferSession::OutputEvent nextEvent;
+    initiatingReceiver.PollOutput(nextEvent, recoveryTime);
+    NL_TEST_ASSERT(inSuite, nextEvent.EventType == TransferSession::OutputEventType::kNone);
+
+    err = AttachHeaderAndSend(outEvent.msgTypeData, std::move(outEvent.MsgData), respondingSender);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    respondingSender.PollOutput(outEvent, kNoAdvanceTime);
+    NL_TEST_ASSERT(inSuite, outEvent.EventType == TransferSession::OutputEventType::kQueryWithSkipReceived);
+    NL_TEST_ASSERT(inSuite, respondingSender.GetNextBlockNum() == 0);
+    NL_TEST_ASSERT(inSuite, respondingSender.GetNumBytesProcessed() == 0);
+}
+
 // Test Suite
 
 /**
@@ -737,6 +1047,10 @@ static const nlTest sTests[] =
     NL_TEST_DEF("TestBadAcceptMessageFields", TestBadAcceptMessageFields),
     NL_TEST_DEF("TestTimeout", TestTimeout),
     NL_TEST_DEF("TestDuplicateBlockError", TestDuplicateBlockError),
+    NL_TEST_DEF("TestWindowedTransfer", TestWindowedTransfer),
+    NL_TEST_DEF("TestWindowedTransferFallback", TestWindowedTransferFallback),
+    NL_TEST_DEF("TestWindowedTransferRecovery", TestWindowedTransferRecovery),
+    NL_TEST_DEF("TestWindowedTransferRecoveryTimer", TestWindowedTransferRecoveryTimer),
     NL_TEST_SENTINEL()
 };
 // clang-format on
@@ -0,0 +1,449 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements chip-bdx-bench, which measures the throughput of BDX transfers for several window sizes.
+ *
+ *      Two TransferSession objects, a receiver initiating the transfer and a responding sender, exchange their messages over a
+ *      simulated link with a given latency, bandwidth and loss rate, driven by a virtual clock. In windowed transfers, Blocks and
+ *      BlockQuery messages are sent without MRP and the TransferSession recovers lost Blocks itself. In synchronous transfers,
+ *      every message is sent with MRP: lost messages are retransmitted after the MRP retransmission interval.
+ */
+
+#include <CHIPVersion.h>
+#include <lib/support/CHIPArgParser.hpp>
+#include <lib/support/CHIPMem.h>
+#include <lib/support/CodeUtils.h>
+#include <lib/support/logging/CHIPLogging.h>
+#include <protocols/bdx/BdxMessages.h>
+#include <protocols/bdx/BdxTransferSession.h>
+#include <system/SystemPacketBuffer.h>
+#include <transport/raw/MessageHeader.h>
+
+#include <inttypes.h>
+#include <map>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+using namespace chip;
+using namespace chip::ArgParser;
+using namespace chip::bdx;
+using chip::System::Clock::Microseconds64;
+using chip::System::Clock::Milliseconds64;
+
+#define TOOL_NAME "chip-bdx-bench"
+#define COPYRIGHT_STRING "Copyright (c) 2022 Project CHIP Authors.\nAll rights reserved.\n"
+
+// Matter message header, MIC and IPv6/UDP headers added to each BDX message on the link
+constexpr uint32_t kMessageOverhead = 80;
+
+// Window sizes compared by the benchmark
+constexpr uint16_t kWindowSizes[] = { 1, 2, 4, 8, 16 };
+
+// Longest simulated transfer before the benchmark gives up
+constexpr Microseconds64 kMaxTransferTime = Microseconds64(3600ull * 1000 * 1000);
+
+// Step of the virtual clock while no message is in flight, which lets the TransferSession timers run
+constexpr Microseconds64 kClockStep = Microseconds64(1000);
+
+bool HandleOption(const char * progName, OptionSet * optSet, int id, const char * name, const char * arg);
+
+// clang-format off
+OptionDef gCmdOptionDefs[] =
+{
+    { "size",          kArgumentRequired, 's' },
+    { "block-size",    kArgumentRequired, 'b' },
+    { "latency",       kArgumentRequired, 'l' },
+    { "bandwidth",     kArgumentRequired, 'w' },
+    { "loss",          kArgumentRequired, 'p' },
+    { "mrp-interval",  kArgumentRequired, 'r' },
+    { }
+};
+
+const char * const gCmdOptionHelp =
+    "   -s, --size <bytes>\n"
+    "\n"
+    "       Size of the transferred file. Defaults to 1048576.\n"
+    "\n"
+    "   -b, --block-size <bytes>\n"
+    "\n"
+    "       Maximum size of a Block. Defaults to 1024.\n"
+    "\n"
+    "   -l, --latency <ms>\n"
+    "\n"
+    "       One-way latency of the link. Defaults to 50.\n"
+    "\n"
+    "   -w, --bandwidth <kbit/s>\n"
+    "\n"
+    "       Bandwidth of the link, in each direction. Defaults to 1000.\n"
+    "\n"
+    "   -p, --loss <percent>\n"
+    "\n"
+    "       Probability that a message is lost. Defaults to 0.\n"
+    "\n"
+    "   -r, --mrp-interval <ms>\n"
+    "\n"
+    "       Delay before MRP retransmits a lost message. Defaults to 300.\n"
+    "\n"
+    ;
+
+OptionSet gCmdOptions =
+{
+    HandleOption,
+    gCmdOptionDefs,
+    "COMMAND OPTIONS",
+    gCmdOptionHelp
+};
+
+HelpOptions gHelpOptions(
+    TOOL_NAME,
+    "Usage: " TOOL_NAME " [ <options...> ]\n",
+    CHIP_VERSION_STRING "\n" COPYRIGHT_STRING,
+    "Compare the throughput of BDX transfers with window sizes 1 to 16 over a simulated link."
+);
+
+OptionSet * gCmdOptionSets[] =
+{
+    &gCmdOptions,
+    &gHelpOptions,
+    nullptr
+};
+// clang-format on
+
+uint64_t gFileSize      = 1024 * 1024;
+uint16_t gBlockSize     = 1024;
+uint32_t gLatencyMs     = 50;
+uint32_t gBandwidthKbps = 1000;
+uint32_t gLossPercent   = 0;
+uint32_t gMrpIntervalMs = 300;
+
+bool HandleOption(const char * progName, OptionSet * optSet, int id, const char * name, const char * arg)
+{
+    bool valid = true;
+
+    switch (id)
+    {
+    case 's':
+        valid = ParseInt(arg, gFileSize) && gFileSize > 0;
+        break;
+    case 'b':
+        valid = ParseInt(arg, gBlockSize) && gBlockSize > 0;
+        break;
+    case 'l':
+        valid = ParseInt(arg, gLatencyMs);
+        break;
+    case 'w':
+        valid = ParseInt(arg, gBandwidthKbps) && gBandwidthKbps > 0;
+        break;
+    case 'p':
+        valid = ParseInt(arg, gLossPercent) && gLossPercent < 100;
+        break;
+    case 'r':
+        valid = ParseInt(arg, gMrpIntervalMs) && gMrpIntervalMs > 0;
+        break;
+    default:
+        PrintArgError("%s: INTERNAL ERROR: Unhandled option: %s\n", progName, name);
+        return false;
+    }
+
+    if (!valid)
+    {
+        PrintArgError("%s: Invalid value specified for %s: %s\n", progName, name, arg);
+    }
+    return valid;
+}
+
+/**
+ * One direction of the simulated link. Messages are serialized at the bandwidth of the link, then delivered after its latency,
+ * unless they are lost. Lost messages sent with MRP are delivered after as many retransmissions as needed.
+ */
+class Link
+{
+public:
+    void Send(TransferSession::OutputEvent & event, bool reliable, Microseconds64 now)
+    {
+        const uint64_t size           = event.MsgData->TotalLength() + kMessageOverhead;
+        const Microseconds64 sendTime = Microseconds64(size * 8 * 1000 / gBandwidthKbps);
+        mFreeAt                       = chip::max(now, mFreeAt) + sendTime;
+        Microseconds64 deliveryTime   = mFreeAt + Milliseconds64(gLatencyMs);
+        mMessageCount++;
+
+        while (IsLost())
+        {
+            mLostCount++;
+            if (!reliable)
+            {
+                return;
+            }
+            deliveryTime += Milliseconds64(gMrpIntervalMs);
+        }
+
+        mInFlight.emplace(deliveryTime, Message{ event.msgTypeData, std::move(event.MsgData) });
+    }
+
+    CHIP_ERROR Deliver(TransferSession & session, Microseconds64 now, bool & delivered)
+    {
+        delivered = false;
+        while (!mInFlight.empty() && mInFlight.begin()->first <= now)
+        {
+            Message message = std::move(mInFlight.begin()->second);
+            mInFlight.erase(mInFlight.begin());
+
+            PayloadHeader payloadHeader;
+            payloadHeader.SetMessageType(message.type.ProtocolId, message.type.MessageType);
+            ReturnErrorOnFailure(session.HandleMessageReceived(payloadHeader, std::move(message.data), ToTimestamp(now)));
+            delivered = true;
+        }
+        return CHIP_NO_ERROR;
+    }
+
+    Microseconds64 GetNextDeliveryTime() const { return mInFlight.empty() ? kMaxTransferTime : mInFlight.begin()->first; }
+    uint32_t GetMessageCount() const { return mMessageCount; }
+    uint32_t GetLostCount() const { return mLostCount; }
+
+    static System::Clock::Timestamp ToTimestamp(Microseconds64 time)
+    {
+        return std::chrono::duration_cast<System::Clock::Timestamp>(time);
+    }
+
+private:
+    struct Message
+    {
+        TransferSession::MessageTypeData type;
+        System::PacketBufferHandle data;
+    };
+
+    // Deterministic, so that the window sizes are compared over the same losses
+    bool IsLost()
+    {
+        mRandomState ^= mRandomState << 13;
+        mRandomState ^= mRandomState >> 7;
+        mRandomState ^= mRandomState << 17;
+        return (mRandomState % 100) < gLossPercent;
+    }
+
+    std::multimap<Microseconds64, Message> mInFlight;
+    Microseconds64 mFreeAt = Microseconds64(0);
+    uint64_t mRandomState  = 0x2545F4914F6CDD1D;
+    uint32_t mMessageCount = 0;
+    uint32_t mLostCount    = 0;
+};
+
+struct BenchResult
+{
+    Microseconds64 duration;
+    uint32_t messageCount;
+    uint32_t lostCount;
+};
+
+class Transfer
+{
+public:
+    explicit Transfer(uint16_t windowSize) : mWindowSize(windowSize) {}
+
+    CHIP_ERROR Run(BenchResult & result)
+    {
+        const System::Clock::Timeout timeout = System::Clock::Seconds16(60);
+        char fileDesignator[]                = "bdx-bench.bin";
+
+        TransferSession::TransferInitData initData;
+        initData.TransferCtlFlags = TransferControlFlags::kReceiverDrive;
+        initData.MaxBlockSize     = gBlockSize;
+        initData.FileDesignator   = reinterpret_cast<uint8_t *>(fileDesignator);
+        initData.FileDesLength    = static_cast<uint16_t>(strlen(fileDesignator));
+        initData.WindowSize       = mWindowSize;
+
+        ReturnErrorOnFailure(mSender.WaitForTransfer(TransferRole::kSender, TransferControlFlags::kReceiverDrive, gBlockSize,
+                                                     timeout));
+        ReturnErrorOnFailure(mReceiver.StartTransfer(TransferRole::kReceiver, initData, timeout));
+
+        while (!mDone)
+        {
+            VerifyOrReturnError(mNow < kMaxTransferTime, CHIP_ERROR_TIMEOUT);
+
+            bool senderOutput      = false;
+            bool receiverOutput    = false;
+            bool senderDelivered   = false;
+            bool receiverDelivered = false;
+            ReturnErrorOnFailure(PollSender(senderOutput));
+            ReturnErrorOnFailure(PollReceiver(receiverOutput));
+            ReturnErrorOnFailure(mToSender.Deliver(mSender, mNow, senderDelivered));
+            ReturnErrorOnFailure(mToReceiver.Deliver(mReceiver, mNow, receiverDelivered));
+
+            if (!senderOutput && !receiverOutput && !senderDelivered && !receiverDelivered)
+            {
+                const Microseconds64 nextDelivery =
+                    chip::min(mToSender.GetNextDeliveryTime(), mToReceiver.GetNextDeliveryTime());
+                mNow = chip::max(mNow + Microseconds64(1), chip::min(nextDelivery, mNow + kClockStep));
+            }
+        }
+
+        result.duration     = mNow;
+        result.messageCount = mToSender.GetMessageCount() + mToReceiver.GetMessageCount();
+        result.lostCount    = mToSender.GetLostCount() + mToReceiver.GetLostCount();
+        return CHIP_NO_ERROR;
+    }
+
+private:
+    // Blocks and BlockQuery messages of a windowed transfer can't be sent with MRP, see TransferSession.
+    bool IsReliable(const TransferSession::OutputEvent & event) const
+    {
+        if (mReceiver.GetWindowSize() <= 1 && mSender.GetWindowSize() <= 1)
+        {
+            return true;
+        }
+
+        switch (static_cast<MessageType>(event.msgTypeData.MessageType))
+        {
+        case MessageType::Block:
+        case MessageType::BlockEOF:
+        case MessageType::BlockQuery:
+        case MessageType::BlockQueryWithSkip:
+            return false;
+        default:
+            return true;
+        }
+    }
+
+    CHIP_ERROR PollSender(bool & hadOutput)
+    {
+        TransferSession::OutputEvent event;
+        mSender.PollOutput(event, Link::ToTimestamp(mNow));
+        hadOutput = event.EventType != TransferSession::OutputEventType::kNone;
+
+        switch (event.EventType)
+        {
+        case TransferSession::OutputEventType::kNone:
+        case TransferSession::OutputEventType::kAckReceived:
+            break;
+        case TransferSession::OutputEventType::kMsgToSend:
+            mToReceiver.Send(event, IsReliable(event), mNow);
+            break;
+        case TransferSession::OutputEventType::kInitReceived: {
+            TransferSession::TransferAcceptData acceptData;
+            acceptData.ControlMode  = TransferControlFlags::kReceiverDrive;
+            acceptData.MaxBlockSize = chip::min(gBlockSize, event.transferInitData.MaxBlockSize);
+            acceptData.WindowSize   = event.transferInitData.WindowSize;
+            return mSender.AcceptTransfer(acceptData);
+        }
+        case TransferSession::OutputEventType::kQueryReceived:
+        case TransferSession::OutputEventType::kQueryWithSkipReceived: {
+            // In a windowed transfer, the sender may have gone back to a lost Block.
+            const uint64_t offset = mSender.GetNumBytesProcessed();
+            VerifyOrReturnError(offset < gFileSize, CHIP_ERROR_INTERNAL);
+
+            TransferSession::BlockData blockData;
+            blockData.Data   = mBlockData;
+            blockData.Length = static_cast<size_t>(chip::min<uint64_t>(mSender.GetTransferBlockSize(), gFileSize - offset));
+            blockData.IsEof  = offset + blockData.Length >= gFileSize;
+            return mSender.PrepareBlock(blockData);
+        }
+        case TransferSession::OutputEventType::kAckEOFReceived:
+            mDone = true;
+            break;
+        default:
+            ChipLogError(BDX, "Sender: unexpected event %s", event.ToString(event.EventType));
+            return CHIP_ERROR_INTERNAL;
+        }
+        return CHIP_NO_ERROR;
+    }
+
+    CHIP_ERROR PollReceiver(bool & hadOutput)
+    {
+        TransferSession::OutputEvent event;
+        mReceiver.PollOutput(event, Link::ToTimestamp(mNow));
+        hadOutput = event.EventType != TransferSession::OutputEventType::kNone;
+
+        switch (event.EventType)
+        {
+        case TransferSession::OutputEventType::kNone:
+            break;
+        case TransferSession::OutputEventType::kMsgToSend:
+            mToSender.Send(event, IsReliable(event), mNow);
+            break;
+        case TransferSession::OutputEventType::kAcceptReceived:
+            return mReceiver.PrepareBlockQuery();
+        case TransferSession::OutputEventType::kBlockReceived:
+            return event.blockdata.IsEof ? mReceiver.PrepareBlockAck() : mReceiver.PrepareBlockQuery();
+        default:
+            ChipLogError(BDX, "Receiver: unexpected event %s", event.ToString(event.EventType));
+            return CHIP_ERROR_INTERNAL;
+        }
+        return CHIP_NO_ERROR;
+    }
+
+    const uint16_t mWindowSize;
+    TransferSession mSender;
+    TransferSession mReceiver;
+    Link mToSender;
+    Link mToReceiver;
+    Microseconds64 mNow = Microseconds64(0);
+    bool mDone          = false;
+
+    // Contents of the Blocks, irrelevant to the benchmark
+    uint8_t mBlockData[UINT16_MAX] = {};
+};
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    if (!ParseArgs(TOOL_NAME, argc, argv, gCmdOptionSets))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (Platform::MemoryInit() != CHIP_NO_ERROR)
+    {
+        fprintf(stderr, "Failed to initialize the memory\n");
+        return EXIT_FAILURE;
+    }
+
+    // The TransferSession logs every message.
+    Logging::SetLogFilter(Logging::kLogCategory_Error);
+
+    printf("File: %" PRIu64 " bytes, blocks of %u bytes, latency %" PRIu32 " ms, bandwidth %" PRIu32 " kbit/s, loss %" PRIu32
+           "%%\n\n",
+           gFileSize, gBlockSize, gLatencyMs, gBandwidthKbps, gLossPercent);
+    printf("%8s %12s %16s %10s %8s\n", "window", "time (ms)", "rate (kbit/s)", "messages", "lost");
+
+    int status = EXIT_SUCCESS;
+    for (uint16_t windowSize : kWindowSizes)
+    {
+        // A Transfer holds a Block buffer, keep it off the stack.
+        auto transfer = Platform::MakeUnique<Transfer>(windowSize);
+        BenchResult result;
+
+        CHIP_ERROR err = transfer ? transfer->Run(result) : CHIP_ERROR_NO_MEMORY;
+        if (err != CHIP_NO_ERROR)
+        {
+            printf("%8u failed: %" CHIP_ERROR_FORMAT "\n", windowSize, err.Format());
+            status = EXIT_FAILURE;
+            continue;
+        }
+
+        const uint64_t durationUs = chip::max<uint64_t>(result.duration.count(), 1);
+        printf("%8u %12" PRIu64 " %16" PRIu64 " %10" PRIu32 " %8" PRIu32 "\n", windowSize, durationUs / 1000,
+               gFileSize * 8 * 1000 / durationUs, result.messageCount, result.lostCount);
+    }
+
+    Platform::MemoryShutdown();
+    return status;
+}
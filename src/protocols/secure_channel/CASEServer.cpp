@@ -19,6 +19,7 @@
 
 #include <lib/core/CHIPError.h>
 #include <lib/support/CodeUtils.h>
+#include <lib/support/Metrics.h>
 #include <lib/support/SafeInt.h>
 #include <lib/support/logging/CHIPLogging.h>
 #include <transport/SessionManager.h>
@@ -29,6 +30,15 @@ using namespace ::chip::Credentials;
 
 namespace chip {
 
+namespace {
+
+CHIP_METRIC_COUNTER(gCASEEstablished, "chip_case_sessions_established_total", "CASE sessions established as a responder");
+CHIP_METRIC_COUNTER(gCASEFailed, "chip_case_sessions_failed_total", "CASE session establishments failed as a responder");
+CHIP_METRIC_HISTOGRAM(gCASEHandshakeTime, "chip_case_handshake_time_ms", "Time from Sigma1 until the CASE session is established",
+                      50, 100, 250, 500, 1000, 2500, 5000, 10000);
+
+} // namespace
+
 CHIP_ERROR CASEServer::ListenForSessionEstablishment(Messaging::ExchangeManager * exchangeManager, SessionManager * sessionManager,
                                                      FabricTable * fabrics, SessionResumptionStorage * sessionResumptionStorage,
                                                      Credentials::CertificateValidityPolicy * certificateValidityPolicy,
@@ -74,6 +84,9 @@ CHIP_ERROR CASEServer::OnMessageReceived(Messaging::ExchangeContext * ec, const
                                          System::PacketBufferHandle && payload)
 {
     ChipLogProgress(Inet, "CASE Server received Sigma1 message. Starting handshake. EC %p", ec);
+#if CHIP_CONFIG_ENABLE_METRICS
+    mHandshakeStart = System::SystemClock().GetMonotonicTimestamp();
+#endif
     CHIP_ERROR err = InitCASEHandshake(ec);
     SuccessOrExit(err);
 
@@ -156,6 +169,7 @@ void CASEServer::PrepareForSessionEstablishment(const ScopedNodeId & previouslyE
 void CASEServer::OnSessionEstablishmentError(CHIP_ERROR err)
 {
     ChipLogError(Inet, "CASE Session establishment failed: %" CHIP_ERROR_FORMAT, err.Format());
+    CHIP_METRIC_INCREMENT(gCASEFailed);
 
     //
     // We're not allowed to call methods that will eventually result in calling SessionManager::AllocateSecureSession
@@ -173,6 +187,8 @@ void CASEServer::OnSessionEstablished(const SessionHandle & session)
 {
     ChipLogProgress(Inet, "CASE Session established to peer: " ChipLogFormatScopedNodeId,
                     ChipLogValueScopedNodeId(session->GetPeer()));
+    CHIP_METRIC_INCREMENT(gCASEEstablished);
+    CHIP_METRIC_RECORD(gCASEHandshakeTime, (System::SystemClock().GetMonotonicTimestamp() - mHandshakeStart).count());
     PrepareForSessionEstablishment(session->GetPeer());
 }
 } // namespace chip
@@ -95,6 +95,11 @@ private:
     FabricTable * mFabrics                              = nullptr;
     Credentials::GroupDataProvider * mGroupDataProvider = nullptr;
 
+#if CHIP_CONFIG_ENABLE_METRICS
+    // When Sigma1 of the handshake in progress was received
+    System::Clock::Timestamp mHandshakeStart = System::Clock::kZero;
+#endif
+
     CHIP_ERROR InitCASEHandshake(Messaging::ExchangeContext * ec);
 
     /*
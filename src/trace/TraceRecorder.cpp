@@ -0,0 +1,489 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <trace/TraceRecorder.h>
+
+#include <lib/support/CodeUtils.h>
+#include <lib/support/TypeTraits.h>
+
+#include <chrono>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace chip {
+namespace Tracing {
+
+std::atomic<uint32_t> gGeneration{ 0 };
+
+struct TraceEvent
+{
+    const Site * site;
+    uint64_t timestampNs;
+    uint32_t threadId;
+    uint32_t id;
+    Phase phase;
+};
+
+/// A single-producer, single-consumer ring of events, owned by one thread at a time.
+class TraceRing
+{
+public:
+    static constexpr size_t kSize = MATTER_TRACE_RECORDER_RING_SIZE;
+    static_assert((kSize & (kSize - 1)) == 0, "MATTER_TRACE_RECORDER_RING_SIZE must be a power of two");
+
+    /// Owning thread only.
+    void Push(const TraceEvent & event)
+    {
+        const size_t head = mHead.Value.load(std::memory_order_relaxed);
+        if (head - mTail.Value.load(std::memory_order_acquire) == kSize)
+        {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        mEvents[head & (kSize - 1)] = event;
+        mHead.Value.store(head + 1, std::memory_order_release);
+    }
+
+    /// Background thread only. Returns false if empty.
+    bool Pop(TraceEvent & event)
+    {
+        const size_t tail = mTail.Value.load(std::memory_order_relaxed);
+        if (tail == mHead.Value.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        event = mEvents[tail & (kSize - 1)];
+        mTail.Value.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint64_t GetDroppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+    std::atomic<bool> mInUse{ true };
+    TraceRing * mNext = nullptr;
+
+private:
+    // An index padded to a cache line of its own, as the head and the tail are written by different
+    // threads; alignas would not be honored by operator new before C++17.
+    struct PaddedIndex
+    {
+        std::atomic<size_t> Value{ 0 };
+        uint8_t Padding[64 - sizeof(std::atomic<size_t>)];
+    };
+
+    PaddedIndex mHead;
+    PaddedIndex mTail;
+    std::atomic<uint64_t> mDropped{ 0 };
+    TraceEvent mEvents[kSize];
+};
+
+namespace {
+
+constexpr auto kDrainInterval = std::chrono::milliseconds(100);
+
+/// The ring of the current thread, given back for reuse when the thread exits.
+struct ThreadRing
+{
+    ~ThreadRing()
+    {
+        if (ring != nullptr)
+        {
+            ring->mInUse.store(false, std::memory_order_release);
+        }
+    }
+
+    TraceRing * ring  = nullptr;
+    uint32_t threadId = 0;
+};
+
+thread_local ThreadRing sThreadRing;
+
+uint32_t sProcessId = 0;
+
+uint64_t NowNs()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void PutJsonString(FILE * output, const char * string)
+{
+    fputc('"', output);
+    for (const char * c = string; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fputc('\\', output);
+        }
+        if (static_cast<unsigned char>(*c) >= 0x20)
+        {
+            fputc(*c, output);
+        }
+    }
+    fputc('"', output);
+}
+
+// Minimal protobuf encoding of the Perfetto trace format (protos/perfetto/trace/trace_packet.proto)
+namespace Proto {
+
+constexpr uint32_t kTracePacket = 1; // Trace.packet
+
+constexpr uint32_t kPacketTimestamp          = 8;
+constexpr uint32_t kPacketSequenceId         = 10;
+constexpr uint32_t kPacketTrackEvent         = 11;
+constexpr uint32_t kPacketTimestampClockId   = 58;
+constexpr uint32_t kPacketTrackDescriptor    = 60;
+constexpr uint32_t kBuiltinClockMonotonic    = 3;
+constexpr uint32_t kTrackDescriptorUuid      = 1;
+constexpr uint32_t kTrackDescriptorName      = 2;
+constexpr uint32_t kTrackDescriptorThread    = 4;
+constexpr uint32_t kThreadDescriptorPid      = 1;
+constexpr uint32_t kThreadDescriptorTid      = 2;
+constexpr uint32_t kTrackEventType           = 9;
+constexpr uint32_t kTrackEventTrackUuid      = 11;
+constexpr uint32_t kTrackEventCategories     = 22;
+constexpr uint32_t kTrackEventName           = 23;
+constexpr uint64_t kTrackEventTypeSliceBegin = 1;
+constexpr uint64_t kTrackEventTypeSliceEnd   = 2;
+constexpr uint64_t kTrackEventTypeInstant    = 3;
+
+constexpr uint32_t kWireVarint    = 0;
+constexpr uint32_t kWireDelimited = 2;
+
+void PutVarint(std::string & out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void PutVarintField(std::string & out, uint32_t field, uint64_t value)
+{
+    PutVarint(out, (field << 3) | kWireVarint);
+    PutVarint(out, value);
+}
+
+void PutBytesField(std::string & out, uint32_t field, const char * data, size_t size)
+{
+    PutVarint(out, (field << 3) | kWireDelimited);
+    PutVarint(out, size);
+    out.append(data, size);
+}
+
+void PutStringField(std::string & out, uint32_t field, const char * string)
+{
+    PutBytesField(out, field, string, strlen(string));
+}
+
+void PutMessageField(std::string & out, uint32_t field, const std::string & message)
+{
+    PutBytesField(out, field, message.data(), message.size());
+}
+
+} // namespace Proto
+
+// Async events are on tracks of their own, out of the range of thread ids
+uint64_t TrackUuid(const TraceEvent & event)
+{
+    const bool async = event.phase == Phase::kAsyncBegin || event.phase == Phase::kAsyncEnd;
+    return async ? ((uint64_t{ 1 } << 32) | event.id) : event.threadId;
+}
+
+} // namespace
+
+bool Site::Refresh(uint32_t generation) const
+{
+    const bool enabled = TraceRecorder::Instance().IsCategoryEnabled(mCategory);
+    mState.store((generation << 1) | (enabled ? 1 : 0), std::memory_order_relaxed);
+    return enabled;
+}
+
+void Record(const Site & site, Phase phase, uint32_t id)
+{
+    ThreadRing & threadRing = sThreadRing;
+    if (threadRing.ring == nullptr)
+    {
+        threadRing.ring     = TraceRecorder::Instance().GetThreadRing();
+        threadRing.threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+    }
+    threadRing.ring->Push(TraceEvent{ &site, NowNs(), threadRing.threadId, id, phase });
+}
+
+TraceRecorder & TraceRecorder::Instance()
+{
+    static TraceRecorder sInstance;
+    return sInstance;
+}
+
+CHIP_ERROR TraceRecorder::Start(const char * path, Format format, const char * categories)
+{
+    VerifyOrReturnError(path != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(mOutput == nullptr, CHIP_ERROR_INCORRECT_STATE);
+
+    mOutput = fopen(path, format == Format::kPerfetto ? "wb" : "w");
+    VerifyOrReturnError(mOutput != nullptr, CHIP_ERROR_OPEN_FAILED);
+    mFormat    = format;
+    mFirstJson = true;
+    mDescribedTracks.clear();
+    sProcessId = static_cast<uint32_t>(getpid());
+
+    {
+        std::lock_guard<std::mutex> lock(mCategoriesMutex);
+        mCategories.clear();
+        for (const char * category = categories; category != nullptr && *category != '\0';)
+        {
+            const char * end = strchr(category, ',');
+            size_t length    = end != nullptr ? static_cast<size_t>(end - category) : strlen(category);
+            if (length > 0)
+            {
+                mCategories.emplace_back(category, length);
+            }
+            category = end != nullptr ? end + 1 : category + length;
+        }
+    }
+
+    // Events left from a previous session
+    TraceEvent event;
+    for (TraceRing * ring = mRings.load(std::memory_order_acquire); ring != nullptr; ring = ring->mNext)
+    {
+        while (ring->Pop(event))
+        {
+        }
+    }
+
+    WriteHeader();
+    mStopping = false;
+    mThread   = std::thread([this] { Run(); });
+
+    // Sites check their category again in the new generation; 0 stands for tracing off
+    mLastGeneration = (mLastGeneration + 1) & (UINT32_MAX >> 1);
+    if (mLastGeneration == 0)
+    {
+        mLastGeneration = 1;
+    }
+    gGeneration.store(mLastGeneration, std::memory_order_release);
+    return CHIP_NO_ERROR;
+}
+
+void TraceRecorder::Stop()
+{
+    VerifyOrReturn(mOutput != nullptr);
+    gGeneration.store(0, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWakeup.notify_one();
+    mThread.join();
+
+    // Events recorded since the last drain of the background thread, which may not have drained at all
+    Drain();
+    WriteFooter();
+    fclose(mOutput);
+    mOutput = nullptr;
+}
+
+bool TraceRecorder::IsCategoryEnabled(const char * category)
+{
+    std::lock_guard<std::mutex> lock(mCategoriesMutex);
+    if (mCategories.empty())
+    {
+        return true;
+    }
+    for (const std::string & enabled : mCategories)
+    {
+        if (enabled == category)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t TraceRecorder::GetDroppedCount() const
+{
+    uint64_t dropped = 0;
+    for (TraceRing * ring = mRings.load(std::memory_order_acquire); ring != nullptr; ring = ring->mNext)
+    {
+        dropped += ring->GetDroppedCount();
+    }
+    return dropped;
+}
+
+TraceRing * TraceRecorder::GetThreadRing()
+{
+    for (TraceRing * ring = mRings.load(std::memory_order_acquire); ring != nullptr; ring = ring->mNext)
+    {
+        bool inUse = false;
+        if (ring->mInUse.compare_exchange_strong(inUse, true, std::memory_order_acquire))
+        {
+            return ring;
+        }
+    }
+
+    TraceRing * ring = new TraceRing();
+    ring->mNext      = mRings.load(std::memory_order_relaxed);
+    while (!mRings.compare_exchange_weak(ring->mNext, ring, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    return ring;
+}
+
+void TraceRecorder::Run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mStopping)
+    {
+        mWakeup.wait_for(lock, kDrainInterval);
+        lock.unlock();
+        Drain();
+        lock.lock();
+    }
+}
+
+void TraceRecorder::Drain()
+{
+    TraceEvent event;
+    for (TraceRing * ring = mRings.load(std::memory_order_acquire); ring != nullptr; ring = ring->mNext)
+    {
+        while (ring->Pop(event))
+        {
+            WriteEvent(event);
+        }
+    }
+    fflush(mOutput);
+}
+
+void TraceRecorder::WriteHeader()
+{
+    if (mFormat == Format::kChromeJson)
+    {
+        fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", mOutput);
+    }
+}
+
+void TraceRecorder::WriteEvent(const TraceEvent & event)
+{
+    if (mFormat == Format::kChromeJson)
+    {
+        WriteJsonEvent(event);
+    }
+    else
+    {
+        WritePerfettoEvent(event);
+    }
+}
+
+void TraceRecorder::WriteFooter()
+{
+    if (mFormat == Format::kChromeJson)
+    {
+        fprintf(mOutput, "\n],\"otherData\":{\"droppedEvents\":\"%" PRIu64 "\"}}\n", GetDroppedCount());
+    }
+}
+
+void TraceRecorder::WriteJsonEvent(const TraceEvent & event)
+{
+    static const char * const kPhases[] = { "B", "E", "i", "b", "e" };
+
+    fputs(mFirstJson ? "\n{\"name\":" : ",\n{\"name\":", mOutput);
+    mFirstJson = false;
+    PutJsonString(mOutput, event.site->GetName());
+    fputs(",\"cat\":", mOutput);
+    PutJsonString(mOutput, event.site->GetCategory());
+    fprintf(mOutput, ",\"ph\":\"%s\",\"ts\":%" PRIu64 ".%03u,\"pid\":%" PRIu32 ",\"tid\":%" PRIu32,
+            kPhases[to_underlying(event.phase)], event.timestampNs / 1000, static_cast<unsigned>(event.timestampNs % 1000),
+            sProcessId, event.threadId);
+    if (event.phase == Phase::kInstant)
+    {
+        fputs(",\"s\":\"t\"", mOutput);
+    }
+    else if (event.phase == Phase::kAsyncBegin || event.phase == Phase::kAsyncEnd)
+    {
+        fprintf(mOutput, ",\"id\":%" PRIu32, event.id);
+    }
+    fputc('}', mOutput);
+}
+
+void TraceRecorder::WritePerfettoEvent(const TraceEvent & event)
+{
+    const uint64_t trackUuid = TrackUuid(event);
+
+    // Describe each track before its first event
+    if (mDescribedTracks.insert(trackUuid).second)
+    {
+        std::string descriptor;
+        Proto::PutVarintField(descriptor, Proto::kTrackDescriptorUuid, trackUuid);
+        if (trackUuid == event.threadId)
+        {
+            std::string thread;
+            Proto::PutVarintField(thread, Proto::kThreadDescriptorPid, sProcessId);
+            Proto::PutVarintField(thread, Proto::kThreadDescriptorTid, event.threadId);
+            Proto::PutMessageField(descriptor, Proto::kTrackDescriptorThread, thread);
+        }
+        else
+        {
+            Proto::PutStringField(descriptor, Proto::kTrackDescriptorName, event.site->GetName());
+        }
+
+        std::string packet;
+        Proto::PutMessageField(packet, Proto::kPacketTrackDescriptor, descriptor);
+        WritePerfettoPacket(packet);
+    }
+
+    uint64_t type = Proto::kTrackEventTypeInstant;
+    if (event.phase == Phase::kBegin || event.phase == Phase::kAsyncBegin)
+    {
+        type = Proto::kTrackEventTypeSliceBegin;
+    }
+    else if (event.phase == Phase::kEnd || event.phase == Phase::kAsyncEnd)
+    {
+        type = Proto::kTrackEventTypeSliceEnd;
+    }
+
+    std::string trackEvent;
+    Proto::PutVarintField(trackEvent, Proto::kTrackEventType, type);
+    Proto::PutVarintField(trackEvent, Proto::kTrackEventTrackUuid, trackUuid);
+    if (type != Proto::kTrackEventTypeSliceEnd)
+    {
+        Proto::PutStringField(trackEvent, Proto::kTrackEventCategories, event.site->GetCategory());
+        Proto::PutStringField(trackEvent, Proto::kTrackEventName, event.site->GetName());
+    }
+
+    std::string packet;
+    Proto::PutVarintField(packet, Proto::kPacketTimestamp, event.timestampNs);
+    Proto::PutVarintField(packet, Proto::kPacketTimestampClockId, Proto::kBuiltinClockMonotonic);
+    Proto::PutVarintField(packet, Proto::kPacketSequenceId, 1);
+    Proto::PutMessageField(packet, Proto::kPacketTrackEvent, trackEvent);
+    WritePerfettoPacket(packet);
+}
+
+void TraceRecorder::WritePerfettoPacket(const std::string & packet)
+{
+    std::string field;
+    Proto::PutMessageField(field, Proto::kTracePacket, packet);
+    fwrite(field.data(), 1, field.size(), mOutput);
+}
+
+} // namespace Tracing
+} // namespace chip
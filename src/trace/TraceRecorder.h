@@ -0,0 +1,222 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      A built-in backend of the MATTER_TRACE_EVENT_* macros for Linux,
+ *      enabled by the chip_build_trace_recorder build argument.
+ *
+ *      Tracing is switched on at runtime by TraceRecorder::Start. Each thread
+ *      records the events of its scopes into a ring buffer of its own, without
+ *      locks, and a background thread writes them to a file in the Chrome
+ *      trace event JSON format or as a Perfetto protobuf trace; both open in
+ *      https://ui.perfetto.dev and chrome://tracing.
+ *
+ *      When tracing is off, a trace event costs one relaxed atomic load.
+ */
+
+#pragma once
+
+#include <lib/core/CHIPError.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/// Number of events the ring buffer of each thread holds. Events which do not fit are dropped.
+#ifndef MATTER_TRACE_RECORDER_RING_SIZE
+#define MATTER_TRACE_RECORDER_RING_SIZE 8192
+#endif
+
+namespace chip {
+namespace Tracing {
+
+/// Category of the events traced without one.
+constexpr const char kDefaultCategory[] = "Matter";
+
+enum class Phase : uint8_t
+{
+    kBegin,
+    kEnd,
+    kInstant,
+    kAsyncBegin,
+    kAsyncEnd,
+};
+
+/// Generation of the current TraceRecorder session, 0 while tracing is off.
+extern std::atomic<uint32_t> gGeneration;
+
+/**
+ * A place where events are traced: the static part of the events. Sites are
+ * static, constant-initialized, objects created by the MATTER_TRACE_EVENT_*
+ * macros, which cache whether their category is enabled.
+ */
+class Site
+{
+public:
+    constexpr Site(const char * name, const char * category) : mName(name), mCategory(category) {}
+
+    bool IsEnabled() const
+    {
+        const uint32_t generation = gGeneration.load(std::memory_order_relaxed);
+        if (generation == 0)
+        {
+            return false;
+        }
+        const uint32_t state = mState.load(std::memory_order_relaxed);
+        return (state >> 1) == generation ? (state & 1) != 0 : Refresh(generation);
+    }
+
+    const char * GetName() const { return mName; }
+    const char * GetCategory() const { return mCategory; }
+
+private:
+    bool Refresh(uint32_t generation) const;
+
+    const char * const mName;
+    const char * const mCategory;
+    // The generation the site was last checked in, and whether its category was enabled in it
+    mutable std::atomic<uint32_t> mState{ 0 };
+};
+
+/// Record an event of an enabled site.
+void Record(const Site & site, Phase phase, uint32_t id = 0);
+
+/// Records the beginning and the end of a scope.
+class Scope
+{
+public:
+    Scope(const Site & site, uint32_t id) : mSite(site.IsEnabled() ? &site : nullptr), mId(id)
+    {
+        if (mSite != nullptr)
+        {
+            Record(*mSite, Phase::kBegin, mId);
+        }
+    }
+    ~Scope()
+    {
+        if (mSite != nullptr)
+        {
+            Record(*mSite, Phase::kEnd, mId);
+        }
+    }
+
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+
+private:
+    const Site * const mSite;
+    const uint32_t mId;
+};
+
+class TraceRing;
+struct TraceEvent;
+
+class TraceRecorder
+{
+public:
+    enum class Format : uint8_t
+    {
+        kChromeJson,
+        kPerfetto,
+    };
+
+    static TraceRecorder & Instance();
+
+    /**
+     * Start tracing into the file at [path], which is replaced.
+     *
+     * @param categories    Comma-separated categories to trace, or nullptr or
+     *                      an empty string to trace them all.
+     */
+    CHIP_ERROR Start(const char * path, Format format, const char * categories = nullptr);
+
+    /// Stop tracing, writing the events recorded so far and closing the file.
+    void Stop();
+
+    bool IsCategoryEnabled(const char * category);
+
+    /// Number of events dropped because the ring buffer of their thread was full.
+    uint64_t GetDroppedCount() const;
+
+    TraceRing * GetThreadRing();
+
+private:
+    TraceRecorder() = default;
+
+    void Run();
+    void Drain();
+    void WriteHeader();
+    void WriteEvent(const TraceEvent & event);
+    void WriteFooter();
+    void WriteJsonEvent(const TraceEvent & event);
+    void WritePerfettoEvent(const TraceEvent & event);
+    void WritePerfettoPacket(const std::string & packet);
+
+    // Rings are only ever added, at the front, and reused once their thread exits
+    std::atomic<TraceRing *> mRings{ nullptr };
+    uint32_t mLastGeneration = 0;
+
+    std::mutex mMutex;
+    std::condition_variable mWakeup;
+    bool mStopping = false;
+    std::thread mThread;
+
+    // Written by Start, before the background thread starts, and read by the threads refreshing sites
+    std::mutex mCategoriesMutex;
+    std::vector<std::string> mCategories;
+
+    // Owned by the background thread while tracing
+    FILE * mOutput  = nullptr;
+    Format mFormat  = Format::kChromeJson;
+    bool mFirstJson = true;
+    std::unordered_set<uint64_t> mDescribedTracks;
+};
+
+} // namespace Tracing
+} // namespace chip
+
+// Pick the label and group, and the trace id, out of the arguments of a pw_trace style macro.
+#define _MATTER_TRACE_PICK_SITE(label, group, ...) label, group
+#define _MATTER_TRACE_PICK_ID(label, group, id, ...) id
+#define _MATTER_TRACE_SITE_ARGS(...) _MATTER_TRACE_PICK_SITE(__VA_ARGS__, ::chip::Tracing::kDefaultCategory, 0)
+#define _MATTER_TRACE_ID_ARG(...) static_cast<uint32_t>(_MATTER_TRACE_PICK_ID(__VA_ARGS__, 0, 0, 0))
+
+#define _MATTER_TRACE_CONCAT_IMPL(a, b) a##b
+#define _MATTER_TRACE_CONCAT(a, b) _MATTER_TRACE_CONCAT_IMPL(a, b)
+#define _MATTER_TRACE_UNIQUE(name) _MATTER_TRACE_CONCAT(name, __LINE__)
+
+#define _MATTER_TRACE_RECORD(phase, ...)                                                                                           \
+    do                                                                                                                             \
+    {                                                                                                                              \
+        static const ::chip::Tracing::Site _matterTraceSite{ _MATTER_TRACE_SITE_ARGS(__VA_ARGS__) };                              \
+        if (_matterTraceSite.IsEnabled())                                                                                          \
+        {                                                                                                                          \
+            ::chip::Tracing::Record(_matterTraceSite, phase, _MATTER_TRACE_ID_ARG(__VA_ARGS__));                                   \
+        }                                                                                                                          \
+    } while (0)
+
+#define _MATTER_TRACE_SCOPE(...)                                                                                                   \
+    static const ::chip::Tracing::Site _MATTER_TRACE_UNIQUE(_matterTraceSite){ _MATTER_TRACE_SITE_ARGS(__VA_ARGS__) };            \
+    ::chip::Tracing::Scope _MATTER_TRACE_UNIQUE(_matterTraceScope)(_MATTER_TRACE_UNIQUE(_matterTraceSite),                         \
+                                                                   _MATTER_TRACE_ID_ARG(__VA_ARGS__))
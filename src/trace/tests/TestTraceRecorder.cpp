@@ -0,0 +1,352 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements a unit test suite for the trace recorder: a
+ *      scope, an instant and an async pair are traced, and the Chrome JSON
+ *      and Perfetto files written are checked.
+ */
+
+#include <trace/TraceRecorder.h>
+#include <trace/trace.h>
+
+#include <lib/support/CodeUtils.h>
+#include <lib/support/UnitTestRegistration.h>
+#include <nlunit-test.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace chip;
+using namespace chip::Tracing;
+
+namespace {
+
+constexpr uint32_t kAsyncId = 7;
+
+/// Trace the events both tests expect, and an event of a category which is not enabled.
+void TraceEvents()
+{
+    {
+        MATTER_TRACE_EVENT_SCOPE("Scope", "TraceTest");
+        MATTER_TRACE_EVENT_INSTANT("Instant", "TraceTest");
+        MATTER_TRACE_EVENT_INSTANT("Filtered", "OtherCategory");
+    }
+    MATTER_TRACE_EVENT_START("Async", "TraceTest", kAsyncId);
+    MATTER_TRACE_EVENT_END("Async", "TraceTest", kAsyncId);
+}
+
+/// Record the events into a temporary file, and return its content.
+bool RecordTrace(TraceRecorder::Format format, std::string & content)
+{
+    char path[] = "/tmp/TestTraceRecorder-XXXXXX";
+    const int fd = mkstemp(path);
+    VerifyOrReturnValue(fd >= 0, false);
+    close(fd);
+
+    bool recorded = TraceRecorder::Instance().Start(path, format, "TraceTest") == CHIP_NO_ERROR;
+    if (recorded)
+    {
+        TraceEvents();
+        TraceRecorder::Instance().Stop();
+
+        FILE * file = fopen(path, "rb");
+        recorded    = file != nullptr;
+        if (recorded)
+        {
+            char buffer[512];
+            size_t read;
+            content.clear();
+            while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            {
+                content.append(buffer, read);
+            }
+            fclose(file);
+        }
+    }
+    unlink(path);
+    return recorded;
+}
+
+uint32_t GetThreadId()
+{
+    return static_cast<uint32_t>(syscall(SYS_gettid));
+}
+
+void TestChromeJson(nlTestSuite * inSuite, void * inContext)
+{
+    std::string trace;
+    NL_TEST_ASSERT(inSuite, RecordTrace(TraceRecorder::Format::kChromeJson, trace));
+
+    // Events are written one per line; timestamps are left out of the comparison
+    std::vector<std::string> lines;
+    for (size_t start = 0, end; start < trace.size(); start = end + 1)
+    {
+        end = trace.find('\n', start);
+        end = (end == std::string::npos) ? trace.size() : end;
+        std::string line = trace.substr(start, end - start);
+
+        const size_t ts = line.find("\"ts\":");
+        if (ts != std::string::npos)
+        {
+            const size_t tsEnd = line.find(',', ts);
+            NL_TEST_ASSERT(inSuite, tsEnd != std::string::npos && tsEnd > ts + 5);
+            line.erase(ts + 5, tsEnd - ts - 5);
+        }
+        lines.push_back(line);
+    }
+
+    char ids[64];
+    snprintf(ids, sizeof(ids), "\"pid\":%" PRIu32 ",\"tid\":%" PRIu32, static_cast<uint32_t>(getpid()), GetThreadId());
+    const std::string pidTid(ids);
+    const std::string expected[] = {
+        "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[",
+        "{\"name\":\"Scope\",\"cat\":\"TraceTest\",\"ph\":\"B\",\"ts\":," + pidTid + "},",
+        "{\"name\":\"Instant\",\"cat\":\"TraceTest\",\"ph\":\"i\",\"ts\":," + pidTid + ",\"s\":\"t\"},",
+        "{\"name\":\"Scope\",\"cat\":\"TraceTest\",\"ph\":\"E\",\"ts\":," + pidTid + "},",
+        "{\"name\":\"Async\",\"cat\":\"TraceTest\",\"ph\":\"b\",\"ts\":," + pidTid + ",\"id\":7},",
+        "{\"name\":\"Async\",\"cat\":\"TraceTest\",\"ph\":\"e\",\"ts\":," + pidTid + ",\"id\":7}",
+        "],\"otherData\":{\"droppedEvents\":\"0\"}}",
+    };
+
+    NL_TEST_ASSERT(inSuite, lines.size() == ArraySize(expected));
+    for (size_t i = 0; i < lines.size() && i < ArraySize(expected); i++)
+    {
+        if (lines[i] != expected[i])
+        {
+            printf("Line %u: expected %s, got %s\n", static_cast<unsigned>(i), expected[i].c_str(), lines[i].c_str());
+        }
+        NL_TEST_ASSERT(inSuite, lines[i] == expected[i]);
+    }
+}
+
+/// A protobuf field, as encoded in a Perfetto trace.
+struct ProtoField
+{
+    uint32_t number;
+    uint64_t value;    // varint fields
+    std::string bytes; // length-delimited fields
+};
+
+bool ReadVarint(const std::string & data, size_t & offset, uint64_t & value)
+{
+    value = 0;
+    for (unsigned shift = 0; offset < data.size() && shift < 64; shift += 7)
+    {
+        const uint8_t byte = static_cast<uint8_t>(data[offset++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Parse a message which only holds varint and length-delimited fields, which is what the recorder writes.
+bool ParseMessage(const std::string & data, std::vector<ProtoField> & fields)
+{
+    fields.clear();
+    size_t offset = 0;
+    while (offset < data.size())
+    {
+        uint64_t key;
+        ProtoField field{ 0, 0, std::string() };
+        VerifyOrReturnValue(ReadVarint(data, offset, key), false);
+        field.number = static_cast<uint32_t>(key >> 3);
+        switch (key & 7)
+        {
+        case 0:
+            VerifyOrReturnValue(ReadVarint(data, offset, field.value), false);
+            break;
+        case 2: {
+            uint64_t length;
+            VerifyOrReturnValue(ReadVarint(data, offset, length) && length <= data.size() - offset, false);
+            field.bytes = data.substr(offset, static_cast<size_t>(length));
+            offset += static_cast<size_t>(length);
+            break;
+        }
+        default:
+            return false;
+        }
+        fields.push_back(field);
+    }
+    return true;
+}
+
+const ProtoField * FindField(const std::vector<ProtoField> & fields, uint32_t number)
+{
+    for (const ProtoField & field : fields)
+    {
+        if (field.number == number)
+        {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+uint64_t VarintField(const std::vector<ProtoField> & fields, uint32_t number, uint64_t absent = UINT64_MAX)
+{
+    const ProtoField * field = FindField(fields, number);
+    return (field != nullptr) ? field->value : absent;
+}
+
+std::string StringField(const std::vector<ProtoField> & fields, uint32_t number)
+{
+    const ProtoField * field = FindField(fields, number);
+    return (field != nullptr) ? field->bytes : std::string();
+}
+
+// Field numbers of protos/perfetto/trace/trace_packet.proto and of the messages it holds
+constexpr uint32_t kTracePacket            = 1;
+constexpr uint32_t kPacketTimestamp        = 8;
+constexpr uint32_t kPacketSequenceId       = 10;
+constexpr uint32_t kPacketTrackEvent       = 11;
+constexpr uint32_t kPacketTimestampClockId = 58;
+constexpr uint32_t kPacketTrackDescriptor  = 60;
+constexpr uint32_t kBuiltinClockMonotonic  = 3;
+constexpr uint32_t kDescriptorUuid         = 1;
+constexpr uint32_t kDescriptorName         = 2;
+constexpr uint32_t kDescriptorThread       = 4;
+constexpr uint32_t kThreadPid              = 1;
+constexpr uint32_t kThreadTid              = 2;
+constexpr uint32_t kEventType              = 9;
+constexpr uint32_t kEventTrackUuid         = 11;
+constexpr uint32_t kEventCategories        = 22;
+constexpr uint32_t kEventName              = 23;
+constexpr uint64_t kTypeSliceBegin         = 1;
+constexpr uint64_t kTypeSliceEnd           = 2;
+constexpr uint64_t kTypeInstant            = 3;
+
+void CheckTrackDescriptor(nlTestSuite * inSuite, const std::vector<ProtoField> & packet, uint64_t uuid, const char * name)
+{
+    std::vector<ProtoField> descriptor;
+    const ProtoField * field = FindField(packet, kPacketTrackDescriptor);
+    NL_TEST_ASSERT(inSuite, field != nullptr && ParseMessage(field->bytes, descriptor));
+    NL_TEST_ASSERT(inSuite, FindField(packet, kPacketTrackEvent) == nullptr);
+    NL_TEST_ASSERT(inSuite, VarintField(descriptor, kDescriptorUuid) == uuid);
+
+    if (name == nullptr)
+    {
+        // The track of a thread
+        std::vector<ProtoField> thread;
+        field = FindField(descriptor, kDescriptorThread);
+        NL_TEST_ASSERT(inSuite, field != nullptr && ParseMessage(field->bytes, thread));
+        NL_TEST_ASSERT(inSuite, VarintField(thread, kThreadPid) == static_cast<uint64_t>(getpid()));
+        NL_TEST_ASSERT(inSuite, VarintField(thread, kThreadTid) == GetThreadId());
+    }
+    else
+    {
+        NL_TEST_ASSERT(inSuite, StringField(descriptor, kDescriptorName) == name);
+        NL_TEST_ASSERT(inSuite, FindField(descriptor, kDescriptorThread) == nullptr);
+    }
+}
+
+void CheckTrackEvent(nlTestSuite * inSuite, const std::vector<ProtoField> & packet, uint64_t type, uint64_t uuid,
+                     const char * name, uint64_t & lastTimestamp)
+{
+    const uint64_t timestamp = VarintField(packet, kPacketTimestamp, 0);
+    NL_TEST_ASSERT(inSuite, timestamp >= lastTimestamp && timestamp > 0);
+    lastTimestamp = timestamp;
+    NL_TEST_ASSERT(inSuite, VarintField(packet, kPacketTimestampClockId) == kBuiltinClockMonotonic);
+    NL_TEST_ASSERT(inSuite, VarintField(packet, kPacketSequenceId) == 1);
+
+    std::vector<ProtoField> event;
+    const ProtoField * field = FindField(packet, kPacketTrackEvent);
+    NL_TEST_ASSERT(inSuite, field != nullptr && ParseMessage(field->bytes, event));
+    NL_TEST_ASSERT(inSuite, VarintField(event, kEventType) == type);
+    NL_TEST_ASSERT(inSuite, VarintField(event, kEventTrackUuid) == uuid);
+
+    // Slice ends close the slice of their track, and have no name of their own
+    NL_TEST_ASSERT(inSuite, StringField(event, kEventName) == (name != nullptr ? name : ""));
+    NL_TEST_ASSERT(inSuite, StringField(event, kEventCategories) == (name != nullptr ? "TraceTest" : ""));
+}
+
+void TestPerfetto(nlTestSuite * inSuite, void * inContext)
+{
+    std::string trace;
+    NL_TEST_ASSERT(inSuite, RecordTrace(TraceRecorder::Format::kPerfetto, trace));
+
+    // A trace is a sequence of packets, each a field of the Trace message
+    std::vector<ProtoField> traceFields;
+    NL_TEST_ASSERT(inSuite, ParseMessage(trace, traceFields));
+    NL_TEST_ASSERT(inSuite, traceFields.size() == 7);
+    VerifyOrReturn(traceFields.size() == 7);
+
+    std::vector<ProtoField> packets[7];
+    for (size_t i = 0; i < traceFields.size(); i++)
+    {
+        NL_TEST_ASSERT(inSuite, traceFields[i].number == kTracePacket);
+        NL_TEST_ASSERT(inSuite, ParseMessage(traceFields[i].bytes, packets[i]));
+    }
+
+    // Thread events are on the track of their thread, async ones on a track of their id
+    const uint64_t threadTrack = GetThreadId();
+    const uint64_t asyncTrack  = (uint64_t{ 1 } << 32) | kAsyncId;
+    uint64_t lastTimestamp     = 0;
+
+    CheckTrackDescriptor(inSuite, packets[0], threadTrack, nullptr);
+    CheckTrackEvent(inSuite, packets[1], kTypeSliceBegin, threadTrack, "Scope", lastTimestamp);
+    CheckTrackEvent(inSuite, packets[2], kTypeInstant, threadTrack, "Instant", lastTimestamp);
+    CheckTrackEvent(inSuite, packets[3], kTypeSliceEnd, threadTrack, nullptr, lastTimestamp);
+    CheckTrackDescriptor(inSuite, packets[4], asyncTrack, "Async");
+    CheckTrackEvent(inSuite, packets[5], kTypeSliceBegin, asyncTrack, "Async", lastTimestamp);
+    CheckTrackEvent(inSuite, packets[6], kTypeSliceEnd, asyncTrack, nullptr, lastTimestamp);
+}
+
+void TestTracingOff(nlTestSuite * inSuite, void * inContext)
+{
+    // Nothing is recorded between sessions: the next trace only holds its own events
+    TraceEvents();
+    NL_TEST_ASSERT(inSuite, TraceRecorder::Instance().GetDroppedCount() == 0);
+
+    std::string trace;
+    NL_TEST_ASSERT(inSuite, RecordTrace(TraceRecorder::Format::kPerfetto, trace));
+
+    std::vector<ProtoField> traceFields;
+    NL_TEST_ASSERT(inSuite, ParseMessage(trace, traceFields));
+    NL_TEST_ASSERT(inSuite, traceFields.size() == 7);
+}
+
+/**
+ *   Test Suite. It lists all the test functions.
+ */
+const nlTest sTests[] = {
+    NL_TEST_DEF("Test Chrome JSON trace", TestChromeJson),
+    NL_TEST_DEF("Test Perfetto trace", TestPerfetto),
+    NL_TEST_DEF("Test tracing off", TestTracingOff),
+    NL_TEST_SENTINEL()
+};
+
+} // namespace
+
+int TestTraceRecorder()
+{
+    nlTestSuite theSuite = { "TraceRecorder tests", &sTests[0], nullptr, nullptr };
+
+    nlTestRunner(&theSuite, nullptr);
+    return nlTestRunnerStats(&theSuite);
+}
+
+CHIP_REGISTER_TEST_SUITE(TestTraceRecorder)
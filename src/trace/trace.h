@@ -54,7 +54,30 @@ void InitializeTracing();
 #define MATTER_TRACE_EVENT_FUNCTION(...) PW_TRACE_FUNCTION(__VA_ARGS__)
 #define MATTER_TRACE_EVENT_FUNCTION_FLAG(...) PW_TRACE_FUNCTION_FLAG(__VA_ARGS__)
 
-#else // defined(PW_TRACE_BACKEND_SET) && PW_TRACE_BACKEND_SET
+#elif defined(MATTER_TRACE_RECORDER) && MATTER_TRACE_RECORDER
+
+#include <trace/TraceRecorder.h>
+
+// Arguments are those of the pw_trace macros: the label, then optionally the group (the
+// category) and the trace id; the data of the DATA variants and the flags are not recorded.
+#define MATTER_TRACE_EVENT_INSTANT(...) _MATTER_TRACE_RECORD(::chip::Tracing::Phase::kInstant, __VA_ARGS__)
+#define MATTER_TRACE_EVENT_INSTANT_FLAG(flag, ...) MATTER_TRACE_EVENT_INSTANT(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_INSTANT_DATA(...) MATTER_TRACE_EVENT_INSTANT(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_INSTANT_DATA_FLAG(flag, ...) MATTER_TRACE_EVENT_INSTANT(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_START(...) _MATTER_TRACE_RECORD(::chip::Tracing::Phase::kAsyncBegin, __VA_ARGS__)
+#define MATTER_TRACE_EVENT_START_FLAG(flag, ...) MATTER_TRACE_EVENT_START(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_START_DATA(...) MATTER_TRACE_EVENT_START(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_START_DATA_FLAG(flag, ...) MATTER_TRACE_EVENT_START(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_END(...) _MATTER_TRACE_RECORD(::chip::Tracing::Phase::kAsyncEnd, __VA_ARGS__)
+#define MATTER_TRACE_EVENT_END_FLAG(flag, ...) MATTER_TRACE_EVENT_END(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_END_DATA(...) MATTER_TRACE_EVENT_END(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_END_DATA_FLAG(flag, ...) MATTER_TRACE_EVENT_END(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_SCOPE(...) _MATTER_TRACE_SCOPE(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_SCOPE_FLAG(flag, ...) MATTER_TRACE_EVENT_SCOPE(__VA_ARGS__)
+#define MATTER_TRACE_EVENT_FUNCTION(...) _MATTER_TRACE_SCOPE(__func__, ##__VA_ARGS__)
+#define MATTER_TRACE_EVENT_FUNCTION_FLAG(flag, ...) _MATTER_TRACE_SCOPE(__func__, ##__VA_ARGS__)
+
+#else // defined(MATTER_TRACE_RECORDER) && MATTER_TRACE_RECORDER
 
 #define _MATTER_TRACE_EVENT_DISABLE(...)                                                                                           \
     do                                                                                                                             \
@@ -202,25 +202,62 @@ CHIP_ERROR CryptoContext::Encrypt(const uint8_t * input, size_t input_length, ui
     else
     {
         VerifyOrReturnError(mKeyAvailable, CHIP_ERROR_INVALID_USE_OF_SESSION_KEY);
-        KeyUsage usage = kR2IKey;
 
-        // Message is encrypted before sending. If the secure session was created by session
-        // initiator, we'll use I2R key to encrypt the message that's being transmitted.
-        // Otherwise, we'll use R2I key, as the responder is sending the message.
-        if (mSessionRole == SessionRole::kInitiator)
-        {
-            usage = kI2RKey;
-        }
+        ReturnErrorOnFailure(AES_CCM_encrypt(input, input_length, AAD, aadLen, mKeys[GetEncryptionKeyUsage()],
+                                             Crypto::kAES_CCM128_Key_Length, nonce.data(), nonce.size(), output, tag, taglen));
+    }
+
+    mac.SetTag(&header, tag, taglen);
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR CryptoContext::EncryptInPlace(const System::PacketBufferHandle & msg, ConstNonceView nonce, PacketHeader & header,
+                                         MessageAuthenticationCode & mac) const
+{
+    VerifyOrReturnError(!msg.IsNull(), CHIP_ERROR_INVALID_ARGUMENT);
+
+    if (!msg->HasChainedBuffer())
+    {
+        return Encrypt(msg->Start(), msg->DataLength(), msg->Start(), nonce, header, mac);
+    }
 
-        ReturnErrorOnFailure(AES_CCM_encrypt(input, input_length, AAD, aadLen, mKeys[usage], Crypto::kAES_CCM128_Key_Length,
-                                             nonce.data(), nonce.size(), output, tag, taglen));
+    const size_t taglen = header.MICTagLength();
+
+    VerifyOrDie(taglen <= kMaxTagLen);
+
+    // Group messages fit in a single datagram, so only session keys encrypt chains of buffers.
+    VerifyOrReturnError(mKeyContext == nullptr, CHIP_ERROR_INVALID_MESSAGE_LENGTH);
+    VerifyOrReturnError(mKeyAvailable, CHIP_ERROR_INVALID_USE_OF_SESSION_KEY);
+
+    uint8_t AAD[kMaxAADLen];
+    uint16_t aadLen = sizeof(AAD);
+    uint8_t tag[kMaxTagLen];
+
+    ReturnErrorOnFailure(GetAdditionalAuthData(header, AAD, aadLen));
+
+    Crypto::AES_CCM_encrypt_stream stream;
+    ReturnErrorOnFailure(stream.Begin(mKeys[GetEncryptionKeyUsage()], Crypto::kAES_CCM128_Key_Length, nonce.data(), nonce.size(),
+                                      AAD, aadLen, msg->TotalLength(), taglen));
+    for (System::PacketBufferHandle buffer = msg.Retain(); !buffer.IsNull(); buffer.Advance())
+    {
+        ReturnErrorOnFailure(stream.EncryptInPlace(MutableByteSpan(buffer->Start(), buffer->DataLength())));
     }
+    ReturnErrorOnFailure(stream.Finish(tag));
 
     mac.SetTag(&header, tag, taglen);
 
     return CHIP_NO_ERROR;
 }
 
+CryptoContext::KeyUsage CryptoContext::GetEncryptionKeyUsage() const
+{
+    // Message is encrypted before sending. If the secure session was created by session
+    // initiator, we'll use I2R key to encrypt the message that's being transmitted.
+    // Otherwise, we'll use R2I key, as the responder is sending the message.
+    return (mSessionRole == SessionRole::kInitiator) ? kI2RKey : kR2IKey;
+}
+
 CHIP_ERROR CryptoContext::Decrypt(const uint8_t * input, size_t input_length, uint8_t * output, ConstNonceView nonce,
                                   const PacketHeader & header, const MessageAuthenticationCode & mac) const
 {
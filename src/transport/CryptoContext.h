@@ -115,6 +115,22 @@ public:
     CHIP_ERROR Encrypt(const uint8_t * input, size_t input_length, uint8_t * output, ConstNonceView nonce, PacketHeader & header,
                        MessageAuthenticationCode & mac) const;
 
+    /**
+     * @brief
+     *   Encrypt, in place, the data of a message buffer or of a chain of buffers
+     *   using keys established in the secure channel. A chain is encrypted buffer
+     *   by buffer, without gathering its data in a contiguous buffer.
+     *
+     * @param msg Message to encrypt
+     * @param nonce Nonce buffer for encrypt
+     * @param header message header structure. Encryption type will be set on the header.
+     * @param mac - output the resulting mac
+     *
+     * @return CHIP_ERROR The result of encryption
+     */
+    CHIP_ERROR EncryptInPlace(const System::PacketBufferHandle & msg, ConstNonceView nonce, PacketHeader & header,
+                              MessageAuthenticationCode & mac) const;
+
     /**
      * @brief
      *   Decrypt the input data using keys established in the secure channel
@@ -172,6 +188,9 @@ private:
     // The encryption operations includes AAD when message authentication tag is generated. This tag
     // is used at the time of decryption to integrity check the received data.
     static CHIP_ERROR GetAdditionalAuthData(const PacketHeader & header, uint8_t * aad, uint16_t & len);
+
+    // The key encrypting the messages sent by this end of the session.
+    KeyUsage GetEncryptionKeyUsage() const;
 };
 
 } // namespace chip
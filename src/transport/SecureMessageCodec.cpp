@@ -40,7 +40,6 @@ CHIP_ERROR Encrypt(const CryptoContext & context, CryptoContext::ConstNonceView
                    PacketHeader & packetHeader, System::PacketBufferHandle & msgBuf)
 {
     VerifyOrReturnError(!msgBuf.IsNull(), CHIP_ERROR_INVALID_ARGUMENT);
-    VerifyOrReturnError(!msgBuf->HasChainedBuffer(), CHIP_ERROR_INVALID_MESSAGE_LENGTH);
     VerifyOrReturnError(msgBuf->TotalLength() <= kMaxAppMessageLen, CHIP_ERROR_MESSAGE_TOO_LONG);
 
     static_assert(std::is_same<decltype(msgBuf->TotalLength()), uint16_t>::value,
@@ -48,17 +47,27 @@ CHIP_ERROR Encrypt(const CryptoContext & context, CryptoContext::ConstNonceView
 
     ReturnErrorOnFailure(payloadHeader.EncodeBeforeData(msgBuf));
 
-    uint8_t * data    = msgBuf->Start();
-    uint16_t totalLen = msgBuf->TotalLength();
-
+    // The message may be a chain of buffers, like the ones of a PacketBufferTLVWriter, which is
+    // encrypted buffer by buffer rather than copied into a single buffer.
     MessageAuthenticationCode mac;
-    ReturnErrorOnFailure(context.Encrypt(data, totalLen, data, nonce, packetHeader, mac));
-
-    uint16_t taglen = 0;
-    ReturnErrorOnFailure(mac.Encode(packetHeader, &data[totalLen], msgBuf->AvailableDataLength(), &taglen));
-
-    VerifyOrReturnError(CanCastTo<uint16_t>(totalLen + taglen), CHIP_ERROR_INTERNAL);
-    msgBuf->SetDataLength(static_cast<uint16_t>(totalLen + taglen));
+    ReturnErrorOnFailure(context.EncryptInPlace(msgBuf, nonce, packetHeader, mac));
+
+    // The tag goes after the data of the last buffer, or in a buffer of its own if it does not fit there.
+    PacketBufferHandle last = msgBuf->Last();
+    if (last->AvailableDataLength() < packetHeader.MICTagLength())
+    {
+        PacketBufferHandle tagBuf = PacketBufferHandle::New(packetHeader.MICTagLength(), 0);
+        VerifyOrReturnError(!tagBuf.IsNull(), CHIP_ERROR_NO_MEMORY);
+        last = tagBuf.Retain();
+        msgBuf->AddToEnd(std::move(tagBuf));
+    }
+
+    uint16_t dataLen = last->DataLength();
+    uint16_t taglen  = 0;
+    ReturnErrorOnFailure(mac.Encode(packetHeader, last->Start() + dataLen, last->AvailableDataLength(), &taglen));
+
+    VerifyOrReturnError(CanCastTo<uint16_t>(dataLen + taglen), CHIP_ERROR_INTERNAL);
+    last->SetDataLength(static_cast<uint16_t>(dataLen + taglen), msgBuf);
 
     return CHIP_NO_ERROR;
 }
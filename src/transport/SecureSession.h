@@ -24,6 +24,7 @@
 #include <app/util/basic-types.h>
 #include <lib/core/ReferenceCounted.h>
 #include <messaging/ReliableMessageProtocolConfig.h>
+#include <messaging/ReliableMessageRttEstimator.h>
 #include <transport/CryptoContext.h>
 #include <transport/Session.h>
 #include <transport/SessionMessageCounter.h>
@@ -176,7 +177,29 @@ public:
     }
 
     const PeerAddress & GetPeerAddress() const { return mPeerAddress; }
-    void SetPeerAddress(const PeerAddress & address) { mPeerAddress = address; }
+    void SetPeerAddress(const PeerAddress & address)
+    {
+        mPeerAddress = address;
+        if (address.GetTransportType() == Transport::Type::kUdp)
+        {
+            mUdpPeerAddress = address;
+        }
+    }
+
+    /**
+     * The address the session uses when it moves back to UDP from TCP: the last UDP address of the
+     * peer on the same IP address, as the TCP port of an incoming connection is an ephemeral port,
+     * or else the current address over UDP.
+     */
+    PeerAddress GetUdpPeerAddress() const
+    {
+        if (mUdpPeerAddress.GetTransportType() == Transport::Type::kUdp &&
+            mUdpPeerAddress.GetIPAddress() == mPeerAddress.GetIPAddress())
+        {
+            return mUdpPeerAddress;
+        }
+        return PeerAddress::UDP(mPeerAddress.GetIPAddress(), mPeerAddress.GetPort(), mPeerAddress.GetInterface());
+    }
 
     Type GetSecureSessionType() const { return mSecureSessionType; }
     bool IsCASESession() const { return GetSecureSessionType() == Type::kCASE; }
@@ -224,9 +247,23 @@ public:
 
     System::Clock::Timestamp GetMRPBaseTimeout() override
     {
+#if CHIP_CONFIG_MRP_RTT_ESTIMATION
+        // While the peer is active, the measured round-trip time replaces its advertised active interval, but never exceeds
+        // its idle interval. Idle peers may be asleep, which no round-trip time measured while they were active reflects.
+        if (IsPeerActive() && mRttEstimator.HasEstimate())
+        {
+            using namespace System::Clock::Literals;
+            return mRttEstimator.GetRetransmissionTimeout(CHIP_CONFIG_MRP_RTT_MIN_RETRY_INTERVAL,
+                                                          GetRemoteMRPConfig().mIdleRetransTimeout);
+        }
+#endif // CHIP_CONFIG_MRP_RTT_ESTIMATION
         return IsPeerActive() ? GetRemoteMRPConfig().mActiveRetransTimeout : GetRemoteMRPConfig().mIdleRetransTimeout;
     }
 
+    /// Round-trip time measured from the acknowledgments of the messages sent on this session
+    Messaging::ReliableMessageRttEstimator & GetRttEstimator() { return mRttEstimator; }
+    const Messaging::ReliableMessageRttEstimator & GetRttEstimator() const { return mRttEstimator; }
+
     CryptoContext & GetCryptoContext() { return mCryptoContext; }
 
     const CryptoContext & GetCryptoContext() const { return mCryptoContext; }
@@ -301,6 +338,7 @@ private:
     uint16_t mPeerSessionId = 0;
 
     PeerAddress mPeerAddress;
+    PeerAddress mUdpPeerAddress;
 
     /// Timestamp of last tx or rx. @see SessionTimestamp in the spec
     System::Clock::Timestamp mLastActivityTime = System::SystemClock().GetMonotonicTimestamp();
@@ -309,6 +347,7 @@ private:
     System::Clock::Timestamp mLastPeerActivityTime = System::SystemClock().GetMonotonicTimestamp();
 
     ReliableMessageProtocolConfig mRemoteMRPConfig = GetDefaultMRPConfig();
+    Messaging::ReliableMessageRttEstimator mRttEstimator;
     CryptoContext mCryptoContext;
     SessionMessageCounter mSessionMessageCounter;
 };
@@ -19,12 +19,32 @@
 #include "lib/support/ScopedBuffer.h"
 #include <access/AuthMode.h>
 #include <lib/support/Defer.h>
+#include <lib/support/Metrics.h>
 #include <transport/SecureSession.h>
 #include <transport/SecureSessionTable.h>
 
 namespace chip {
 namespace Transport {
 
+namespace {
+
+CHIP_METRIC_POOL(gSecureSessionPoolMetrics, "secure_sessions");
+
+} // namespace
+
+SecureSessionTable::SecureSessionTable()
+{
+    CHIP_METRIC_POOL_ATTACH(mEntries, gSecureSessionPoolMetrics);
+}
+
+SecureSessionTable::~SecureSessionTable()
+{
+    mEntries.ReleaseAll();
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    Platform::MemoryFree(mIndex);
+#endif
+}
+
 Optional<SessionHandle> SecureSessionTable::CreateNewSecureSessionForTest(SecureSession::Type secureSessionType,
                                                                           uint16_t localSessionId, NodeId localNodeId,
                                                                           NodeId peerNodeId, CATValues peerCATs,
@@ -52,8 +72,8 @@ Optional<SessionHandle> SecureSessionTable::CreateNewSecureSessionForTest(Secure
         }
     }
 
-    SecureSession * result = mEntries.CreateObject(*this, secureSessionType, localSessionId, localNodeId, peerNodeId, peerCATs,
-                                                   peerSessionId, fabricIndex, config);
+    SecureSession * result =
+        CreateSession(secureSessionType, localSessionId, localNodeId, peerNodeId, peerCATs, peerSessionId, fabricIndex, config);
     return result != nullptr ? MakeOptional<SessionHandle>(*result) : Optional<SessionHandle>::Missing();
 }
 
@@ -73,7 +93,7 @@ Optional<SessionHandle> SecureSessionTable::CreateNewSecureSession(SecureSession
     //
     if (mEntries.Allocated() < GetMaxSessionTableSize())
     {
-        allocated = mEntries.CreateObject(*this, secureSessionType, sessionId.Value());
+        allocated = CreateSession(secureSessionType, sessionId.Value());
     }
     else
     {
@@ -216,7 +236,7 @@ SecureSession * SecureSessionTable::EvictAndAllocate(uint16_t localSessionId, Se
         if (newCount < prevCount)
         {
             ChipLogProgress(SecureChannel, "Successfully evicted a session!");
-            auto * retSession = mEntries.CreateObject(*this, secureSessionType, localSessionId);
+            auto * retSession = CreateSession(secureSessionType, localSessionId);
             VerifyOrDie(session != nullptr);
             return retSession;
         }
@@ -312,69 +332,120 @@ void SecureSessionTable::DefaultEvictionPolicy(EvictionPolicyContext & evictionC
 
 Optional<SessionHandle> SecureSessionTable::FindSecureSessionByLocalKey(uint16_t localSessionId)
 {
-    SecureSession * result = nullptr;
-    mEntries.ForEachActiveObject([&](auto session) {
-        if (session->GetLocalSessionId() == localSessionId)
-        {
-            result = session;
-            return Loop::Break;
-        }
-        return Loop::Continue;
-    });
+    SecureSession * result = FindInIndex(localSessionId);
     return result != nullptr ? MakeOptional<SessionHandle>(*result) : Optional<SessionHandle>::Missing();
 }
 
 Optional<uint16_t> SecureSessionTable::FindUnusedSessionId()
 {
-    uint16_t candidate_base = 0;
-    uint64_t candidate_mask = 0;
-    for (uint32_t i = 0; i <= kMaxSessionID; i += 64)
+    uint16_t candidate = mNextSessionId;
+    for (uint32_t i = 0; i <= kMaxSessionID; i++, candidate++)
     {
-        // candidate_base is the base session ID we are searching from.
-        // We have a 64-bit mask anchored at this ID and iterate over the
-        // whole session table, setting bits in the mask for in-use IDs.
-        // If we can iterate through the entire session table and have
-        // any bits clear in the mask, we have available session IDs.
-        candidate_base = static_cast<uint16_t>(i + mNextSessionId);
-        candidate_mask = 0;
+        // kUnsecuredSessionId is never available
+        if (candidate != kUnsecuredSessionId && FindInIndex(candidate) == nullptr)
         {
-            uint16_t shift = static_cast<uint16_t>(kUnsecuredSessionId - candidate_base);
-            if (shift <= 63)
-            {
-                candidate_mask |= (1ULL << shift); // kUnsecuredSessionId is never available
-            }
+            return MakeOptional<uint16_t>(candidate);
         }
-        mEntries.ForEachActiveObject([&](auto session) {
-            uint16_t shift = static_cast<uint16_t>(session->GetLocalSessionId() - candidate_base);
-            if (shift <= 63)
-            {
-                candidate_mask |= (1ULL << shift);
-            }
-            if (candidate_mask == UINT64_MAX)
-            {
-                return Loop::Break; // No bits clear means this bucket is full.
-            }
-            return Loop::Continue;
-        });
-        if (candidate_mask != UINT64_MAX)
+    }
+
+    return NullOptional;
+}
+
+bool SecureSessionTable::AddToIndex(SecureSession * session)
+{
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    if (2 * (mIndexCount + 1) > mIndexCapacity)
+    {
+        VerifyOrReturnValue(GrowIndex(), false);
+    }
+#else
+    VerifyOrReturnValue(2 * (mIndexCount + 1) <= mIndexCapacity, false);
+#endif
+
+    size_t slot = IndexSlot(session->GetLocalSessionId());
+    while (mIndex[slot] != nullptr)
+    {
+        slot = (slot + 1) & (mIndexCapacity - 1);
+    }
+    mIndex[slot] = session;
+    mIndexCount++;
+    return true;
+}
+
+void SecureSessionTable::RemoveFromIndex(SecureSession * session)
+{
+    VerifyOrReturn(mIndexCount > 0);
+
+    size_t slot = IndexSlot(session->GetLocalSessionId());
+    while (mIndex[slot] != session)
+    {
+        VerifyOrReturn(mIndex[slot] != nullptr);
+        slot = (slot + 1) & (mIndexCapacity - 1);
+    }
+
+    // Backward shift deletion: move up the following entries of the probe
+    // sequence which would no longer be reachable from their home slot.
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & (mIndexCapacity - 1); mIndex[next] != nullptr; next = (next + 1) & (mIndexCapacity - 1))
+    {
+        size_t home = IndexSlot(mIndex[next]->GetLocalSessionId());
+        // Whether home lies cyclically in (hole, next], in which case the entry stays put
+        bool reachable = (hole < next) ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!reachable)
         {
-            break; // Any bit clear means we have an available ID in this bucket.
+            mIndex[hole] = mIndex[next];
+            hole         = next;
         }
     }
-    if (candidate_mask != UINT64_MAX)
+    mIndex[hole] = nullptr;
+    mIndexCount--;
+}
+
+SecureSession * SecureSessionTable::FindInIndex(uint16_t localSessionId) const
+{
+    VerifyOrReturnValue(mIndexCount > 0, nullptr);
+
+    for (size_t slot = IndexSlot(localSessionId); mIndex[slot] != nullptr; slot = (slot + 1) & (mIndexCapacity - 1))
     {
-        uint16_t offset = 0;
-        while (candidate_mask & 1)
+        if (mIndex[slot]->GetLocalSessionId() == localSessionId)
         {
-            candidate_mask >>= 1;
-            ++offset;
+            return mIndex[slot];
         }
-        uint16_t available = static_cast<uint16_t>(candidate_base + offset);
-        return MakeOptional<uint16_t>(available);
     }
+    return nullptr;
+}
 
-    return NullOptional;
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+bool SecureSessionTable::GrowIndex()
+{
+    size_t capacity = (mIndexCapacity == 0) ? IndexCapacityFor(CHIP_CONFIG_SECURE_SESSION_POOL_SIZE) : 2 * mIndexCapacity;
+    auto ** index   = static_cast<SecureSession **>(Platform::MemoryCalloc(capacity, sizeof(SecureSession *)));
+    VerifyOrReturnValue(index != nullptr, false);
+
+    SecureSession ** oldIndex = mIndex;
+    size_t oldCapacity        = mIndexCapacity;
+    mIndex                    = index;
+    mIndexCapacity            = capacity;
+    mIndexCount               = 0;
+
+    for (size_t i = 0; i < oldCapacity; i++)
+    {
+        if (oldIndex[i] != nullptr)
+        {
+            size_t slot = IndexSlot(oldIndex[i]->GetLocalSessionId());
+            while (mIndex[slot] != nullptr)
+            {
+                slot = (slot + 1) & (mIndexCapacity - 1);
+            }
+            mIndex[slot] = oldIndex[i];
+            mIndexCount++;
+        }
+    }
+
+    Platform::MemoryFree(oldIndex);
+    return true;
 }
+#endif // CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
 
 } // namespace Transport
 } // namespace chip
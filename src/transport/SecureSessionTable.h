@@ -39,7 +39,8 @@ constexpr uint16_t kUnsecuredSessionId = 0;
 class SecureSessionTable
 {
 public:
-    ~SecureSessionTable() { mEntries.ReleaseAll(); }
+    SecureSessionTable();
+    ~SecureSessionTable();
 
     void Init() { mNextSessionId = chip::Crypto::GetRandU16(); }
 
@@ -76,7 +77,11 @@ public:
     CHECK_RETURN_VALUE
     Optional<SessionHandle> CreateNewSecureSession(SecureSession::Type secureSessionType, ScopedNodeId sessionEvictionHint);
 
-    void ReleaseSession(SecureSession * session) { mEntries.ReleaseObject(session); }
+    void ReleaseSession(SecureSession * session)
+    {
+        RemoveFromIndex(session);
+        mEntries.ReleaseObject(session);
+    }
 
     template <typename Function>
     Loop ForEachSession(Function && function)
@@ -243,22 +248,70 @@ private:
     /**
      * Find an available session ID that is unused in the secure session table.
      *
-     * The search algorithm iterates over the session ID space in the outer loop
-     * and the session table in the inner loop to locate an available session ID
-     * from the starting mNextSessionId clue.
-     *
-     * The outer-loop considers 64 session IDs in each iteration to give a
-     * runtime complexity of O(CHIP_CONFIG_PEER_CONNECTION_POOL_SIZE^2/64).  Speed up could be
-     * achieved with a sorted session table or additional storage.
+     * Candidate IDs are checked against the session index, in order, from the
+     * starting mNextSessionId clue. Since IDs are allocated sequentially, the
+     * first candidate is free unless the ID space wrapped around onto sessions
+     * which are still alive, so this is O(1) in practice.
      *
      * @return an unused session ID if any is found, else NullOptional
      */
     CHECK_RETURN_VALUE
     Optional<uint16_t> FindUnusedSessionId();
 
+    /**
+     * Allocate a session out of the pool and add it to the session index.
+     *
+     * @return the session, or nullptr if the pool, or the index, is full
+     */
+    template <typename... Args>
+    SecureSession * CreateSession(Args &&... args)
+    {
+        SecureSession * session = mEntries.CreateObject(*this, std::forward<Args>(args)...);
+        if (session != nullptr && !AddToIndex(session))
+        {
+            mEntries.ReleaseObject(session);
+            session = nullptr;
+        }
+        return session;
+    }
+
+    /*
+     * The sessions are indexed by local session ID in an open-addressing hash
+     * table with linear probing, kept at most half full, so that looking up the
+     * session of every received message does not scan the pool. Session IDs
+     * are allocated sequentially, so the ID itself, masked by the power-of-two
+     * capacity, is a collision-free hash for the live sessions.
+     */
+    static constexpr size_t IndexCapacityFor(size_t sessionCount)
+    {
+        size_t capacity = 1;
+        while (capacity < 2 * sessionCount)
+        {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    size_t IndexSlot(uint16_t localSessionId) const { return localSessionId & (mIndexCapacity - 1); }
+    bool AddToIndex(SecureSession * session);
+    void RemoveFromIndex(SecureSession * session);
+    SecureSession * FindInIndex(uint16_t localSessionId) const;
+
     bool mRunningEvictionLogic = false;
     ObjectPool<SecureSession, CHIP_CONFIG_SECURE_SESSION_POOL_SIZE> mEntries;
 
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    // Grows along with the heap pool; allocated on first use.
+    bool GrowIndex();
+
+    SecureSession ** mIndex = nullptr;
+    size_t mIndexCapacity   = 0;
+#else
+    SecureSession * mIndex[IndexCapacityFor(CHIP_CONFIG_SECURE_SESSION_POOL_SIZE)] = {};
+    size_t mIndexCapacity = IndexCapacityFor(CHIP_CONFIG_SECURE_SESSION_POOL_SIZE);
+#endif
+    size_t mIndexCount = 0;
+
     size_t GetMaxSessionTableSize() const
     {
 #if CONFIG_BUILD_FOR_HOST_UNIT_TEST
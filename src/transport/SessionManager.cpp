@@ -35,11 +35,13 @@
 #include <inttypes.h>
 #include <lib/core/CHIPKeyIds.h>
 #include <lib/support/CodeUtils.h>
+#include <lib/support/Metrics.h>
 #include <lib/support/SafeInt.h>
 #include <lib/support/logging/CHIPLogging.h>
 #include <platform/CHIPDeviceLayer.h>
 #include <protocols/Protocols.h>
 #include <protocols/secure_channel/Constants.h>
+#include <trace/trace.h>
 #include <transport/GroupPeerMessageCounter.h>
 #include <transport/GroupSession.h>
 #include <transport/SecureMessageCodec.h>
@@ -54,6 +56,15 @@ using System::PacketBufferHandle;
 using Transport::PeerAddress;
 using Transport::SecureSession;
 
+namespace {
+
+CHIP_METRIC_COUNTER(gMessagesSent, "chip_transport_messages_sent_total", "Messages handed to the transports");
+CHIP_METRIC_COUNTER(gMessagesReceived, "chip_transport_messages_received_total", "Messages received from the transports");
+CHIP_METRIC_COUNTER(gDecryptFailures, "chip_transport_decrypt_failures_total", "Received messages which failed to decrypt");
+CHIP_METRIC_COUNTER(gDuplicateMessages, "chip_transport_duplicate_messages_total", "Received messages with a duplicate counter");
+
+} // namespace
+
 uint32_t EncryptedPacketBufferHandle::GetMessageCounter() const
 {
     PacketHeader header;
@@ -141,6 +152,7 @@ void SessionManager::FabricRemoved(FabricIndex fabricIndex)
 CHIP_ERROR SessionManager::PrepareMessage(const SessionHandle & sessionHandle, PayloadHeader & payloadHeader,
                                           System::PacketBufferHandle && message, EncryptedPacketBufferHandle & preparedMessage)
 {
+    MATTER_TRACE_EVENT_SCOPE("PrepareMessage", "SessionManager");
     PacketHeader packetHeader;
     bool isControlMsg = IsControlMessage(payloadHeader);
     if (isControlMsg)
@@ -176,7 +188,7 @@ CHIP_ERROR SessionManager::PrepareMessage(const SessionHandle & sessionHandle, P
         }
 
         // Trace before any encryption
-        CHIP_TRACE_MESSAGE_SENT(payloadHeader, packetHeader, message->Start(), message->TotalLength());
+        CHIP_TRACE_MESSAGE_SENT(payloadHeader, packetHeader, message->Start(), message->DataLength());
 
         Crypto::SymmetricKeyContext * keyContext =
             groups->GetKeyContext(groupSession->GetFabricIndex(), groupSession->GetGroupId());
@@ -211,7 +223,7 @@ CHIP_ERROR SessionManager::PrepareMessage(const SessionHandle & sessionHandle, P
             .SetSessionType(Header::SessionType::kUnicastSession);
 
         // Trace before any encryption
-        CHIP_TRACE_MESSAGE_SENT(payloadHeader, packetHeader, message->Start(), message->TotalLength());
+        CHIP_TRACE_MESSAGE_SENT(payloadHeader, packetHeader, message->Start(), message->DataLength());
 
         CryptoContext::NonceStorage nonce;
         NodeId sourceNodeId = session->GetLocalScopedNodeId().GetNodeId();
@@ -242,7 +254,7 @@ CHIP_ERROR SessionManager::PrepareMessage(const SessionHandle & sessionHandle, P
         }
 
         // Trace after all headers are settled.
-        CHIP_TRACE_MESSAGE_SENT(payloadHeader, packetHeader, message->Start(), message->TotalLength());
+        CHIP_TRACE_MESSAGE_SENT(payloadHeader, packetHeader, message->Start(), message->DataLength());
 
         ReturnErrorOnFailure(payloadHeader.EncodeBeforeData(message));
 
@@ -302,6 +314,7 @@ CHIP_ERROR SessionManager::PrepareMessage(const SessionHandle & sessionHandle, P
 CHIP_ERROR SessionManager::SendPreparedMessage(const SessionHandle & sessionHandle,
                                                const EncryptedPacketBufferHandle & preparedMessage)
 {
+    MATTER_TRACE_EVENT_SCOPE("SendPreparedMessage", "SessionManager");
     VerifyOrReturnError(mState == State::kInitialized, CHIP_ERROR_INCORRECT_STATE);
     VerifyOrReturnError(!preparedMessage.IsNull(), CHIP_ERROR_INVALID_ARGUMENT);
 
@@ -357,8 +370,8 @@ CHIP_ERROR SessionManager::SendPreparedMessage(const SessionHandle & sessionHand
     }
 
     PacketBufferHandle msgBuf = preparedMessage.CastToWritable();
+    // Chains of buffers are sent as is by the transports which can, and refused by the others.
     VerifyOrReturnError(!msgBuf.IsNull(), CHIP_ERROR_INVALID_ARGUMENT);
-    VerifyOrReturnError(!msgBuf->HasChainedBuffer(), CHIP_ERROR_INVALID_MESSAGE_LENGTH);
 
 #if CHIP_SYSTEM_CONFIG_MULTICAST_HOMING
     if (sessionHandle->GetSessionType() == Transport::Session::SessionType::kGroupOutgoing)
@@ -388,6 +401,7 @@ CHIP_ERROR SessionManager::SendPreparedMessage(const SessionHandle & sessionHand
                     if (mTransportMgr != nullptr)
                     {
                         CHIP_TRACE_PREPARED_MESSAGE_SENT(destination, &tempBuf);
+                        CHIP_METRIC_INCREMENT(gMessagesSent);
                         if (CHIP_NO_ERROR != mTransportMgr->SendMessage(*destination, std::move(tempBuf)))
                         {
                             ChipLogError(Inet, "Failed to send Multicast message on interface %s", name);
@@ -417,6 +431,7 @@ CHIP_ERROR SessionManager::SendPreparedMessage(const SessionHandle & sessionHand
     if (mTransportMgr != nullptr)
     {
         CHIP_TRACE_PREPARED_MESSAGE_SENT(destination, &msgBuf);
+        CHIP_METRIC_INCREMENT(gMessagesSent);
         return mTransportMgr->SendMessage(*destination, std::move(msgBuf));
     }
 
@@ -490,6 +505,43 @@ void SessionManager::UpdateAllSessionsPeerAddress(const ScopedNodeId & node, con
     });
 }
 
+CHIP_ERROR SessionManager::SetSessionTransport(const SessionHandle & session, Transport::Type transportType)
+{
+    VerifyOrReturnError(session->IsSecureSession(), CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(transportType == Transport::Type::kUdp || transportType == Transport::Type::kTcp,
+                        CHIP_ERROR_INVALID_ARGUMENT);
+
+    SecureSession * secure                 = session->AsSecureSession();
+    const Transport::PeerAddress & current = secure->GetPeerAddress();
+    const Transport::Type currentType      = current.GetTransportType();
+    VerifyOrReturnError(currentType == Transport::Type::kUdp || currentType == Transport::Type::kTcp,
+                        CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(currentType != transportType, CHIP_NO_ERROR);
+
+    const Transport::PeerAddress address = (transportType == Transport::Type::kTcp)
+        ? Transport::PeerAddress::TCP(current.GetIPAddress(), current.GetPort(), current.GetInterface())
+        : secure->GetUdpPeerAddress();
+    VerifyOrReturnError(mTransportMgr != nullptr && mTransportMgr->CanSendToPeer(address), CHIP_ERROR_UNSUPPORTED_CHIP_FEATURE);
+
+    secure->SetPeerAddress(address);
+    return CHIP_NO_ERROR;
+}
+
+void SessionManager::OnConnectionClosed(const Transport::PeerAddress & peerAddress)
+{
+    VerifyOrReturn(peerAddress.GetTransportType() == Transport::Type::kTcp);
+
+    // A new connection to the peer of a closed connection would go to the same port, which is an
+    // ephemeral port of the peer when the peer opened the connection: sessions move back to UDP.
+    mSecureSessions.ForEachSession([&peerAddress](auto session) {
+        if (session->GetPeerAddress() == peerAddress)
+        {
+            session->SetPeerAddress(session->GetUdpPeerAddress());
+        }
+        return Loop::Continue;
+    });
+}
+
 Optional<SessionHandle> SessionManager::AllocateSession(SecureSession::Type secureSessionType,
                                                         const ScopedNodeId & sessionEvictionHint)
 {
@@ -541,7 +593,9 @@ CHIP_ERROR SessionManager::InjectCaseSessionWithTestKey(SessionHolder & sessionH
 
 void SessionManager::OnMessageReceived(const PeerAddress & peerAddress, System::PacketBufferHandle && msg)
 {
+    MATTER_TRACE_EVENT_SCOPE("OnMessageReceived", "SessionManager");
     CHIP_TRACE_PREPARED_MESSAGE_RECEIVED(&peerAddress, &msg);
+    CHIP_METRIC_INCREMENT(gMessagesReceived);
     PacketHeader packetHeader;
 
     CHIP_ERROR err = packetHeader.DecodeAndConsume(msg);
@@ -571,6 +625,7 @@ void SessionManager::OnMessageReceived(const PeerAddress & peerAddress, System::
 void SessionManager::UnauthenticatedMessageDispatch(const PacketHeader & packetHeader, const Transport::PeerAddress & peerAddress,
                                                     System::PacketBufferHandle && msg)
 {
+    MATTER_TRACE_EVENT_SCOPE("UnauthenticatedMessageDispatch", "SessionManager");
     Optional<NodeId> source      = packetHeader.GetSourceNodeId();
     Optional<NodeId> destination = packetHeader.GetDestinationNodeId();
     if ((source.HasValue() && destination.HasValue()) || (!source.HasValue() && !destination.HasValue()))
@@ -624,6 +679,7 @@ void SessionManager::UnauthenticatedMessageDispatch(const PacketHeader & packetH
                       packetHeader.GetMessageCounter(), ChipLogValueExchangeIdFromReceivedHeader(payloadHeader));
         isDuplicate = SessionMessageDelegate::DuplicateMessage::Yes;
         err         = CHIP_NO_ERROR;
+        CHIP_METRIC_INCREMENT(gDuplicateMessages);
     }
     else
     {
@@ -642,6 +698,7 @@ void SessionManager::UnauthenticatedMessageDispatch(const PacketHeader & packetH
 void SessionManager::SecureUnicastMessageDispatch(const PacketHeader & packetHeader, const Transport::PeerAddress & peerAddress,
                                                   System::PacketBufferHandle && msg)
 {
+    MATTER_TRACE_EVENT_SCOPE("SecureUnicastMessageDispatch", "SessionManager");
     CHIP_ERROR err = CHIP_NO_ERROR;
 
     Optional<SessionHandle> session = mSecureSessions.FindSecureSessionByLocalKey(packetHeader.GetSessionId());
@@ -687,6 +744,7 @@ void SessionManager::SecureUnicastMessageDispatch(const PacketHeader & packetHea
     if (SecureMessageCodec::Decrypt(secureSession->GetCryptoContext(), nonce, payloadHeader, packetHeader, msg) != CHIP_NO_ERROR)
     {
         ChipLogError(Inet, "Secure transport received message, but failed to decode/authenticate it, discarding");
+        CHIP_METRIC_INCREMENT(gDecryptFailures);
         return;
     }
 
@@ -700,6 +758,7 @@ void SessionManager::SecureUnicastMessageDispatch(const PacketHeader & packetHea
                       packetHeader.GetMessageCounter(), ChipLogValueExchangeIdFromReceivedHeader(payloadHeader));
         isDuplicate = SessionMessageDelegate::DuplicateMessage::Yes;
         err         = CHIP_NO_ERROR;
+        CHIP_METRIC_INCREMENT(gDuplicateMessages);
     }
     if (err != CHIP_NO_ERROR)
     {
@@ -739,6 +798,7 @@ void SessionManager::SecureUnicastMessageDispatch(const PacketHeader & packetHea
 void SessionManager::SecureGroupMessageDispatch(const PacketHeader & packetHeader, const Transport::PeerAddress & peerAddress,
                                                 System::PacketBufferHandle && msg)
 {
+    MATTER_TRACE_EVENT_SCOPE("SecureGroupMessageDispatch", "SessionManager");
     PayloadHeader payloadHeader;
     Credentials::GroupDataProvider * groups = Credentials::GetGroupDataProvider();
     VerifyOrReturn(nullptr != groups);
@@ -793,6 +853,7 @@ void SessionManager::SecureGroupMessageDispatch(const PacketHeader & packetHeade
     if (!decrypted)
     {
         ChipLogError(Inet, "Failed to retrieve Key. Discarding everything");
+        CHIP_METRIC_INCREMENT(gDecryptFailures);
         return;
     }
     msg = std::move(msgCopy);
@@ -369,6 +369,26 @@ public:
      */
     void UpdateAllSessionsPeerAddress(const ScopedNodeId & node, const Transport::PeerAddress & addr);
 
+    /**
+     * @brief
+     *   Move a secure session between UDP and TCP: the messages of the session
+     *   are then sent to the same address and port of the peer, over the other
+     *   transport. TCP suits large interactions, like wildcard reads, which it
+     *   carries without MRP and in fewer messages; moving back to UDP leaves the
+     *   TCP connection to the idle timeout of the TCP transport, and goes back to
+     *   the last UDP address of the peer. Sessions also move back to UDP when
+     *   their TCP connection is closed by the peer or by the idle timeout.
+     *
+     * @param session         The secure session to move.
+     * @param transportType   Transport::Type::kUdp or Transport::Type::kTcp.
+     *
+     * @retval #CHIP_ERROR_INVALID_ARGUMENT if the session is not a secure session or
+     *         the session or the requested transport is neither UDP nor TCP.
+     * @retval #CHIP_ERROR_UNSUPPORTED_CHIP_FEATURE if no transport can send to the peer
+     *         over the requested transport.
+     */
+    CHIP_ERROR SetSessionTransport(const SessionHandle & session, Transport::Type transportType);
+
     /**
      * @brief
      *   Return the System Layer pointer used by current SessionManager.
@@ -411,6 +431,15 @@ public:
      */
     void OnMessageReceived(const Transport::PeerAddress & source, System::PacketBufferHandle && msgBuf) override;
 
+    /**
+     * @brief
+     *   Move the secure sessions using a TCP connection closed by the peer or by the network, like
+     *   by the idle timeout of the TCP transport, back to UDP. Implements TransportMgrDelegate
+     *
+     * @param peerAddress   the address of the peer of the connection
+     */
+    void OnConnectionClosed(const Transport::PeerAddress & peerAddress) override;
+
     Optional<SessionHandle> CreateUnauthenticatedSession(const Transport::PeerAddress & peerAddress,
                                                          const ReliableMessageProtocolConfig & config)
     {
@@ -51,6 +51,14 @@ public:
      * @param msgBuf    the buffer containing a full CHIP message (except for the optional length field).
      */
     virtual void OnMessageReceived(const Transport::PeerAddress & source, System::PacketBufferHandle && msgBuf) = 0;
+
+    /**
+     * @brief
+     *   Handle a connection closed by the peer or by the network, like when it was idle for too long.
+     *
+     * @param peerAddress   the address of the peer of the connection
+     */
+    virtual void OnConnectionClosed(const Transport::PeerAddress & peerAddress) {}
 };
 
 template <typename... TransportTypes>
@@ -33,6 +33,11 @@ void TransportMgrBase::Disconnect(const Transport::PeerAddress & address)
     mTransport->Disconnect(address);
 }
 
+bool TransportMgrBase::CanSendToPeer(const Transport::PeerAddress & address)
+{
+    return mTransport != nullptr && mTransport->CanSendToPeer(address);
+}
+
 CHIP_ERROR TransportMgrBase::Init(Transport::Base * transport)
 {
     if (mTransport != nullptr)
@@ -83,4 +88,14 @@ void TransportMgrBase::HandleMessageReceived(const Transport::PeerAddress & peer
     }
 }
 
+void TransportMgrBase::HandleConnectionClosed(const Transport::PeerAddress & peerAddress)
+{
+    assertChipStackLockedByCurrentThread();
+
+    if (mSessionManager != nullptr)
+    {
+        mSessionManager->OnConnectionClosed(peerAddress);
+    }
+}
+
 } // namespace chip
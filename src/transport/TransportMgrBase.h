@@ -41,12 +41,16 @@ public:
 
     void Disconnect(const Transport::PeerAddress & address);
 
+    bool CanSendToPeer(const Transport::PeerAddress & address);
+
     void SetSessionManager(TransportMgrDelegate * sessionManager) { mSessionManager = sessionManager; }
 
     CHIP_ERROR MulticastGroupJoinLeave(const Transport::PeerAddress & address, bool join);
 
     void HandleMessageReceived(const Transport::PeerAddress & peerAddress, System::PacketBufferHandle && msg) override;
 
+    void HandleConnectionClosed(const Transport::PeerAddress & peerAddress) override;
+
 private:
     TransportMgrDelegate * mSessionManager = nullptr;
     Transport::Base * mTransport           = nullptr;
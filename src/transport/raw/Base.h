@@ -38,6 +38,12 @@ class RawTransportDelegate
 public:
     virtual ~RawTransportDelegate() {}
     virtual void HandleMessageReceived(const Transport::PeerAddress & peerAddress, System::PacketBufferHandle && msg) = 0;
+
+    /**
+     * Handle a connection of a connection-oriented transport closed by the peer or by the network,
+     * like when it was idle for too long, rather than by Disconnect.
+     */
+    virtual void HandleConnectionClosed(const Transport::PeerAddress & peerAddress) {}
 };
 
 /**
@@ -102,7 +108,19 @@ protected:
         mDelegate->HandleMessageReceived(source, std::move(buffer));
     }
 
-    RawTransportDelegate * mDelegate;
+    /**
+     * Method used by connection-oriented subclasses to notify that a connection was closed by the
+     * peer or by the network.
+     */
+    void HandleConnectionClosed(const PeerAddress & peerAddress)
+    {
+        if (mDelegate != nullptr)
+        {
+            mDelegate->HandleConnectionClosed(peerAddress);
+        }
+    }
+
+    RawTransportDelegate * mDelegate = nullptr;
 };
 
 } // namespace Transport
@@ -32,6 +32,7 @@
 
 #include <inttypes.h>
 #include <limits>
+#include <string.h>
 
 namespace chip {
 namespace Transport {
@@ -58,19 +59,15 @@ TCPBase::~TCPBase()
         mListenSocket = nullptr;
     }
 
-    CloseActiveConnections();
+    // The active connections are closed by the TCP class, which owns their pool.
 }
 
 void TCPBase::CloseActiveConnections()
 {
-    for (size_t i = 0; i < mActiveConnectionsSize; i++)
-    {
-        if (mActiveConnections[i].InUse())
-        {
-            mActiveConnections[i].Free();
-            mUsedEndPointCount--;
-        }
-    }
+    mActiveConnections.ForEachActiveObject([&](ActiveConnectionState * connection) {
+        CloseConnection(connection);
+        return Loop::Continue;
+    });
 }
 
 CHIP_ERROR TCPBase::Init(TcpListenParameters & params)
@@ -101,6 +98,10 @@ CHIP_ERROR TCPBase::Init(TcpListenParameters & params)
     mListenSocket->OnAcceptError        = OnAcceptError;
     mEndpointType                       = params.GetAddressType();
 
+    mIdleTimeout         = params.GetIdleTimeout();
+    mKeepAliveInterval   = params.GetKeepAliveInterval();
+    mKeepAliveProbeCount = params.GetKeepAliveProbeCount();
+
     mState = State::kInitialized;
 
 exit:
@@ -134,35 +135,95 @@ TCPBase::ActiveConnectionState * TCPBase::FindActiveConnection(const PeerAddress
         return nullptr;
     }
 
-    for (size_t i = 0; i < mActiveConnectionsSize; i++)
-    {
-        if (!mActiveConnections[i].InUse())
-        {
-            continue;
-        }
+    ActiveConnectionState * found = nullptr;
+    mActiveConnections.ForEachActiveObject([&](ActiveConnectionState * connection) {
         Inet::IPAddress addr;
         uint16_t port;
-        mActiveConnections[i].mEndPoint->GetPeerInfo(&addr, &port);
+        connection->mEndPoint->GetPeerInfo(&addr, &port);
 
         if ((addr == address.GetIPAddress()) && (port == address.GetPort()))
         {
-            return &mActiveConnections[i];
+            found = connection;
+            return Loop::Break;
         }
-    }
+        return Loop::Continue;
+    });
 
-    return nullptr;
+    return found;
 }
 
 TCPBase::ActiveConnectionState * TCPBase::FindActiveConnection(const Inet::TCPEndPoint * endPoint)
 {
-    for (size_t i = 0; i < mActiveConnectionsSize; i++)
+    ActiveConnectionState * found = nullptr;
+    mActiveConnections.ForEachActiveObject([&](ActiveConnectionState * connection) {
+        if (connection->mEndPoint == endPoint)
+        {
+            found = connection;
+            return Loop::Break;
+        }
+        return Loop::Continue;
+    });
+    return found;
+}
+
+void TCPBase::InitEndPoint(Inet::TCPEndPoint * endPoint)
+{
+    endPoint->mAppState            = reinterpret_cast<void *>(this);
+    endPoint->OnDataReceived       = OnTcpReceive;
+    endPoint->OnConnectComplete    = OnConnectionComplete;
+    endPoint->OnConnectionClosed   = OnConnectionClosed;
+    endPoint->OnConnectionReceived = OnConnectionReceived;
+    endPoint->OnAcceptError        = OnAcceptError;
+    endPoint->OnPeerClose          = OnPeerClosed;
+}
+
+CHIP_ERROR TCPBase::AddActiveConnection(Inet::TCPEndPoint * endPoint)
+{
+    ActiveConnectionState * connection = mActiveConnections.CreateObject(endPoint);
+    if (connection == nullptr)
+    {
+        endPoint->Free();
+        mUsedEndPointCount--;
+        return CHIP_ERROR_NO_MEMORY;
+    }
+
+    Inet::IPAddress ipAddress;
+    uint16_t port;
+    Inet::InterfaceId interfaceId;
+
+    endPoint->GetPeerInfo(&ipAddress, &port);
+    endPoint->GetInterfaceId(&interfaceId);
+    connection->mPeerAddress = PeerAddress::TCP(ipAddress, port, interfaceId);
+
+#if INET_TCP_IDLE_CHECK_INTERVAL > 0
+    endPoint->SetIdleTimeout(mIdleTimeout.count());
+#endif // INET_TCP_IDLE_CHECK_INTERVAL > 0
+
+    if (mKeepAliveInterval != 0)
     {
-        if (mActiveConnections[i].mEndPoint == endPoint)
+        CHIP_ERROR err = endPoint->EnableKeepAlive(mKeepAliveInterval, mKeepAliveProbeCount);
+        if (err != CHIP_NO_ERROR)
         {
-            return &mActiveConnections[i];
+            // The idle timeout still closes connections to peers which went away.
+            ChipLogError(Inet, "Failed to enable TCP keep-alive: %s", ErrorStr(err));
         }
     }
-    return nullptr;
+
+    return CHIP_NO_ERROR;
+}
+
+void TCPBase::CloseConnection(ActiveConnectionState * connection)
+{
+    connection->mEndPoint->Free();
+    mActiveConnections.ReleaseObject(connection);
+    mUsedEndPointCount--;
+}
+
+void TCPBase::ReleaseClosedConnection(ActiveConnectionState * connection)
+{
+    const PeerAddress peerAddress = connection->mPeerAddress;
+    CloseConnection(connection);
+    HandleConnectionClosed(peerAddress);
 }
 
 CHIP_ERROR TCPBase::SendMessage(const Transport::PeerAddress & address, System::PacketBufferHandle && msgBuf)
@@ -173,16 +234,17 @@ CHIP_ERROR TCPBase::SendMessage(const Transport::PeerAddress & address, System::
 
     VerifyOrReturnError(address.GetTransportType() == Type::kTcp, CHIP_ERROR_INVALID_ARGUMENT);
     VerifyOrReturnError(mState == State::kInitialized, CHIP_ERROR_INCORRECT_STATE);
-    VerifyOrReturnError(kPacketSizeBytes + msgBuf->DataLength() <= std::numeric_limits<uint16_t>::max(),
+    VerifyOrReturnError(kPacketSizeBytes + msgBuf->TotalLength() <= std::numeric_limits<uint16_t>::max(),
                         CHIP_ERROR_INVALID_ARGUMENT);
 
-    // The check above about kPacketSizeBytes + msgBuf->DataLength() means it definitely fits in uint16_t.
+    // The check above about kPacketSizeBytes + msgBuf->TotalLength() means it definitely fits in uint16_t.
     VerifyOrReturnError(msgBuf->EnsureReservedSize(static_cast<uint16_t>(kPacketSizeBytes)), CHIP_ERROR_NO_MEMORY);
 
     msgBuf->SetStart(msgBuf->Start() - kPacketSizeBytes);
 
+    // The message may be a chain of buffers, which the endpoint sends as is.
     uint8_t * output = msgBuf->Start();
-    LittleEndian::Write16(output, static_cast<uint16_t>(msgBuf->DataLength() - kPacketSizeBytes));
+    LittleEndian::Write16(output, static_cast<uint16_t>(msgBuf->TotalLength() - kPacketSizeBytes));
 
     // Reuse existing connection if one exists, otherwise a new one
     // will be established
@@ -222,7 +284,7 @@ CHIP_ERROR TCPBase::SendAfterConnect(const PeerAddress & addr, System::PacketBuf
     }
 
     // Ensures sufficient active connections size exist
-    VerifyOrReturnError(mUsedEndPointCount < mActiveConnectionsSize, CHIP_ERROR_NO_MEMORY);
+    VerifyOrReturnError(mUsedEndPointCount < mMaxActiveConnections, CHIP_ERROR_NO_MEMORY);
 
 #if INET_CONFIG_ENABLE_TCP_ENDPOINT
     Inet::TCPEndPoint * endPoint = nullptr;
@@ -230,13 +292,7 @@ CHIP_ERROR TCPBase::SendAfterConnect(const PeerAddress & addr, System::PacketBuf
     auto EndPointDeletor = [](Inet::TCPEndPoint * e) { e->Free(); };
     std::unique_ptr<Inet::TCPEndPoint, decltype(EndPointDeletor)> endPointHolder(endPoint, EndPointDeletor);
 
-    endPoint->mAppState            = reinterpret_cast<void *>(this);
-    endPoint->OnDataReceived       = OnTcpReceive;
-    endPoint->OnConnectComplete    = OnConnectionComplete;
-    endPoint->OnConnectionClosed   = OnConnectionClosed;
-    endPoint->OnConnectionReceived = OnConnectionReceived;
-    endPoint->OnAcceptError        = OnAcceptError;
-    endPoint->OnPeerClose          = OnPeerClosed;
+    InitEndPoint(endPoint);
 
     ReturnErrorOnFailure(endPoint->Connect(addr.GetIPAddress(), addr.GetPort(), addr.GetInterface()));
 
@@ -297,17 +353,53 @@ CHIP_ERROR TCPBase::ProcessSingleMessage(const PeerAddress & peerAddress, Active
     // `state->mReceived->Start()` currently points to the message data.
     // On exit, `state->mReceived` will have had `messageSize` bytes consumed, no matter what.
     System::PacketBufferHandle message;
-    if (state->mReceived->DataLength() == messageSize)
+    const uint16_t headLength = state->mReceived->DataLength();
+    // Upper layers get the buffers passed upstream for themselves, so only buffers of no one else are reused.
+    const bool canReuseHead = state->mReceived.HasSoleOwnership();
+
+    // When the head buffer also contains the start of a next message, shorter than this one, that start is moved to a buffer
+    // of its own. Without a buffer for it, the message is copied instead.
+    System::PacketBufferHandle remainder;
+    if (canReuseHead && headLength > messageSize && headLength - messageSize <= messageSize)
+    {
+        remainder = System::PacketBufferHandle::New(static_cast<uint16_t>(headLength - messageSize), 0);
+    }
+
+    if (headLength == messageSize)
     {
         // In this case, the head packet buffer contains exactly the message.
         // This is common because typical messages fit in a network packet, and are delivered as such.
         // Peel off the head to pass upstream, which effectively consumes it from `state->mReceived`.
         message = state->mReceived.PopHead();
     }
+    else if (!remainder.IsNull())
+    {
+        // Move the start of the next message to its buffer, and pass the head upstream.
+        const uint16_t remainderLength = static_cast<uint16_t>(headLength - messageSize);
+        message                        = state->mReceived.PopHead();
+        memcpy(remainder->Start(), message->Start() + messageSize, remainderLength);
+        remainder->SetDataLength(remainderLength);
+        message->SetDataLength(messageSize);
+        if (!state->mReceived.IsNull())
+        {
+            remainder.AddToEnd(std::move(state->mReceived));
+        }
+        state->mReceived = std::move(remainder);
+    }
+    else if (canReuseHead && headLength < messageSize && state->mReceived->AvailableDataLength() >= messageSize - headLength)
+    {
+        // The message continues in the next buffers, and its end fits in the head buffer after its start.
+        // Move only the end of the message into the head, and pass the head upstream.
+        const uint16_t missingLength = static_cast<uint16_t>(messageSize - headLength);
+        message                      = state->mReceived.PopHead();
+        CHIP_ERROR err               = state->mReceived->Read(message->Start() + headLength, missingLength);
+        state->mReceived.Consume(missingLength);
+        ReturnErrorOnFailure(err);
+        message->SetDataLength(messageSize);
+    }
     else
     {
-        // The message is either longer or shorter than the head buffer.
-        // In either case, copy the message to a fresh linear buffer to pass upstream. We always copy, rather than provide
+        // Copy the message to a fresh linear buffer to pass upstream. We always copy, rather than provide
         // a shared reference to the current buffer, in case upper layers manipulate the buffer in ways that would affect
         // our use, e.g. chaining it elsewhere or reusing space beyond the current message.
         message = System::PacketBufferHandle::New(messageSize, 0);
@@ -396,26 +488,9 @@ void TCPBase::OnConnectionComplete(Inet::TCPEndPoint * endPoint, CHIP_ERROR inet
         endPoint->Free();
         tcp->mUsedEndPointCount--;
     }
-    else
+    else if (tcp->AddActiveConnection(endPoint) != CHIP_NO_ERROR)
     {
-        bool connectionStored = false;
-        for (size_t i = 0; i < tcp->mActiveConnectionsSize; i++)
-        {
-            if (!tcp->mActiveConnections[i].InUse())
-            {
-                tcp->mActiveConnections[i].Init(endPoint);
-                connectionStored = true;
-                break;
-            }
-        }
-
-        // since we track end points counts, we always expect to store the
-        // connection.
-        if (!connectionStored)
-        {
-            endPoint->Free();
-            ChipLogError(Inet, "Internal logic error: insufficient space to store active connection");
-        }
+        ChipLogError(Inet, "Insufficient memory to store active connection");
     }
 }
 
@@ -423,16 +498,13 @@ void TCPBase::OnConnectionClosed(Inet::TCPEndPoint * endPoint, CHIP_ERROR err)
 {
     TCPBase * tcp = reinterpret_cast<TCPBase *>(endPoint->mAppState);
 
-    ChipLogProgress(Inet, "Connection closed.");
+    ChipLogProgress(Inet, "Connection closed: %s", ErrorStr(err));
 
-    for (size_t i = 0; i < tcp->mActiveConnectionsSize; i++)
+    ActiveConnectionState * connection = tcp->FindActiveConnection(endPoint);
+    if (connection != nullptr)
     {
-        if (tcp->mActiveConnections[i].mEndPoint == endPoint)
-        {
-            ChipLogProgress(Inet, "Freeing closed connection.");
-            tcp->mActiveConnections[i].Free();
-            tcp->mUsedEndPointCount--;
-        }
+        ChipLogProgress(Inet, "Freeing closed connection.");
+        tcp->ReleaseClosedConnection(connection);
     }
 }
 
@@ -441,25 +513,15 @@ void TCPBase::OnConnectionReceived(Inet::TCPEndPoint * listenEndPoint, Inet::TCP
 {
     TCPBase * tcp = reinterpret_cast<TCPBase *>(listenEndPoint->mAppState);
 
-    if (tcp->mUsedEndPointCount < tcp->mActiveConnectionsSize)
+    if (tcp->mUsedEndPointCount < tcp->mMaxActiveConnections)
     {
         // have space to use one more (even if considering pending connections)
-        for (size_t i = 0; i < tcp->mActiveConnectionsSize; i++)
+        tcp->InitEndPoint(endPoint);
+        tcp->mUsedEndPointCount++;
+        if (tcp->AddActiveConnection(endPoint) != CHIP_NO_ERROR)
         {
-            if (!tcp->mActiveConnections[i].InUse())
-            {
-                tcp->mActiveConnections[i].Init(endPoint);
-                break;
-            }
+            ChipLogError(Inet, "Insufficient memory to accept new connections");
         }
-
-        endPoint->mAppState            = listenEndPoint->mAppState;
-        endPoint->OnDataReceived       = OnTcpReceive;
-        endPoint->OnConnectComplete    = OnConnectionComplete;
-        endPoint->OnConnectionClosed   = OnConnectionClosed;
-        endPoint->OnConnectionReceived = OnConnectionReceived;
-        endPoint->OnAcceptError        = OnAcceptError;
-        endPoint->OnPeerClose          = OnPeerClosed;
     }
     else
     {
@@ -476,54 +538,39 @@ void TCPBase::OnAcceptError(Inet::TCPEndPoint * endPoint, CHIP_ERROR err)
 void TCPBase::Disconnect(const PeerAddress & address)
 {
     // Closes an existing connection
-    for (size_t i = 0; i < mActiveConnectionsSize; i++)
-    {
-        if (mActiveConnections[i].InUse())
-        {
-            Inet::IPAddress ipAddress;
-            uint16_t port;
-            Inet::InterfaceId interfaceId;
+    mActiveConnections.ForEachActiveObject([&](ActiveConnectionState * connection) {
+        Inet::IPAddress ipAddress;
+        uint16_t port;
+        Inet::InterfaceId interfaceId;
 
-            mActiveConnections[i].mEndPoint->GetPeerInfo(&ipAddress, &port);
-            mActiveConnections[i].mEndPoint->GetInterfaceId(&interfaceId);
-            if (address == PeerAddress::TCP(ipAddress, port, interfaceId))
-            {
-                // NOTE: this leaves the socket in TIME_WAIT.
-                // Calling Abort() would clean it since SO_LINGER would be set to 0,
-                // however this seems not to be useful.
-                mActiveConnections[i].Free();
-                mUsedEndPointCount--;
-            }
+        connection->mEndPoint->GetPeerInfo(&ipAddress, &port);
+        connection->mEndPoint->GetInterfaceId(&interfaceId);
+        if (address == PeerAddress::TCP(ipAddress, port, interfaceId))
+        {
+            // NOTE: this leaves the socket in TIME_WAIT.
+            // Calling Abort() would clean it since SO_LINGER would be set to 0,
+            // however this seems not to be useful.
+            CloseConnection(connection);
         }
-    }
+        return Loop::Continue;
+    });
 }
 
 void TCPBase::OnPeerClosed(Inet::TCPEndPoint * endPoint)
 {
     TCPBase * tcp = reinterpret_cast<TCPBase *>(endPoint->mAppState);
 
-    for (size_t i = 0; i < tcp->mActiveConnectionsSize; i++)
+    ActiveConnectionState * connection = tcp->FindActiveConnection(endPoint);
+    if (connection != nullptr)
     {
-        if (tcp->mActiveConnections[i].mEndPoint == endPoint)
-        {
-            ChipLogProgress(Inet, "Freeing connection: connection closed by peer");
-            tcp->mActiveConnections[i].Free();
-            tcp->mUsedEndPointCount--;
-        }
+        ChipLogProgress(Inet, "Freeing connection: connection closed by peer");
+        tcp->ReleaseClosedConnection(connection);
     }
 }
 
 bool TCPBase::HasActiveConnections() const
 {
-    for (size_t i = 0; i < mActiveConnectionsSize; i++)
-    {
-        if (mActiveConnections[i].InUse())
-        {
-            return true;
-        }
-    }
-
-    return false;
+    return mActiveConnections.ForEachActiveObject([](const ActiveConnectionState *) { return Loop::Break; }) == Loop::Break;
 }
 
 } // namespace Transport
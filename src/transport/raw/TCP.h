@@ -34,6 +34,7 @@
 #include <lib/core/CHIPCore.h>
 #include <lib/support/CodeUtils.h>
 #include <lib/support/PoolWrapper.h>
+#include <system/SystemClock.h>
 #include <transport/raw/Base.h>
 
 namespace chip {
@@ -73,11 +74,38 @@ public:
         return *this;
     }
 
+    /// Connections without any traffic for this long are closed; zero keeps idle connections open.
+    System::Clock::Milliseconds32 GetIdleTimeout() const { return mIdleTimeout; }
+    TcpListenParameters & SetIdleTimeout(System::Clock::Milliseconds32 timeout)
+    {
+        mIdleTimeout = timeout;
+
+        return *this;
+    }
+
+    uint16_t GetKeepAliveInterval() const { return mKeepAliveInterval; }
+    uint16_t GetKeepAliveProbeCount() const { return mKeepAliveProbeCount; }
+
+    /**
+     * Send TCP keep-alive probes on idle connections every [intervalSeconds], closing a connection
+     * after [probeCount] unanswered probes. A zero interval disables keep-alive.
+     */
+    TcpListenParameters & SetKeepAlive(uint16_t intervalSeconds, uint16_t probeCount)
+    {
+        mKeepAliveInterval   = intervalSeconds;
+        mKeepAliveProbeCount = probeCount;
+
+        return *this;
+    }
+
 private:
     Inet::EndPointManager<Inet::TCPEndPoint> * mEndPointManager;   ///< Associated endpoint factory
     Inet::IPAddressType mAddressType = Inet::IPAddressType::kIPv6; ///< type of listening socket
     uint16_t mListenPort             = CHIP_PORT;                  ///< TCP listen port
     Inet::InterfaceId mInterfaceId   = Inet::InterfaceId::Null();  ///< Interface to listen on
+    System::Clock::Milliseconds32 mIdleTimeout = System::Clock::Seconds32(CHIP_CONFIG_TCP_IDLE_TIMEOUT_SECS); ///< Idle timeout
+    uint16_t mKeepAliveInterval                = 0; ///< Keep-alive probe interval, in seconds
+    uint16_t mKeepAliveProbeCount              = 0; ///< Unanswered keep-alive probes closing a connection
 };
 
 /**
@@ -111,34 +139,25 @@ protected:
      */
     struct ActiveConnectionState
     {
-        void Init(Inet::TCPEndPoint * endPoint)
-        {
-            mEndPoint = endPoint;
-            mReceived = nullptr;
-        }
-
-        void Free()
-        {
-            mEndPoint->Free();
-            mEndPoint = nullptr;
-            mReceived = nullptr;
-        }
-        bool InUse() const { return mEndPoint != nullptr; }
+        explicit ActiveConnectionState(Inet::TCPEndPoint * endPoint) : mEndPoint(endPoint) {}
 
         // Associated endpoint.
         Inet::TCPEndPoint * mEndPoint;
 
+        // Address of the peer, which the endpoint no longer knows once the connection is closed.
+        PeerAddress mPeerAddress;
+
         // Buffers received but not yet consumed.
         System::PacketBufferHandle mReceived;
     };
 
+    using ActiveConnectionPoolType = PoolInterface<ActiveConnectionState, Inet::TCPEndPoint *>;
+
 public:
     using PendingPacketPoolType = PoolInterface<PendingPacket, const PeerAddress &, System::PacketBufferHandle &&>;
-    TCPBase(ActiveConnectionState * activeConnectionsBuffer, size_t bufferSize, PendingPacketPoolType & packetBuffers) :
-        mActiveConnections(activeConnectionsBuffer), mActiveConnectionsSize(bufferSize), mPendingPackets(packetBuffers)
-    {
-        // activeConnectionsBuffer must be initialized by the caller.
-    }
+    TCPBase(ActiveConnectionPoolType & activeConnections, size_t maxActiveConnections, PendingPacketPoolType & packetBuffers) :
+        mActiveConnections(activeConnections), mMaxActiveConnections(maxActiveConnections), mPendingPackets(packetBuffers)
+    {}
     ~TCPBase() override;
 
     /**
@@ -183,6 +202,27 @@ public:
 private:
     friend class TCPTest;
 
+    /**
+     * Set the callbacks of a new endpoint of the transport.
+     */
+    void InitEndPoint(Inet::TCPEndPoint * endPoint);
+
+    /**
+     * Store a connection which was established or accepted, applying the idle timeout and keep-alive
+     * options. Frees the endpoint if the connection cannot be stored.
+     */
+    CHIP_ERROR AddActiveConnection(Inet::TCPEndPoint * endPoint);
+
+    /**
+     * Close a connection and release its state.
+     */
+    void CloseConnection(ActiveConnectionState * connection);
+
+    /**
+     * Release the state of a connection closed by the peer or by the network, and notify the delegate.
+     */
+    void ReleaseClosedConnection(ActiveConnectionState * connection);
+
     /**
      * Find an active connection to the given peer or return nullptr if
      * no active connection exists.
@@ -217,6 +257,10 @@ private:
     /**
      * Process a single message of the specified size from a buffer.
      *
+     * The message is passed upstream in the buffer it was received in whenever it can be, moving only
+     * the bytes beyond a buffer boundary: either the end of a message split across buffers, or the
+     * start of the next message when it is shorter than the message.
+     *
      * @param[in]     peerAddress   The peer the data is coming from.
      * @param[in,out] state         The connection state, which contains the message. On entry, the payload points to the message
      *                              body (after the length). On exit, it points after the message (or the queue is null, if there
@@ -257,30 +301,39 @@ private:
     // Number of active and 'pending connection' endpoints
     size_t mUsedEndPointCount = 0;
 
-    // Currently active connections
-    ActiveConnectionState * mActiveConnections;
-    const size_t mActiveConnectionsSize;
+    // Options of the connections
+    System::Clock::Milliseconds32 mIdleTimeout = System::Clock::kZero;
+    uint16_t mKeepAliveInterval                = 0;
+    uint16_t mKeepAliveProbeCount              = 0;
+
+    // Currently active connections, and the largest number of active and 'pending connection' endpoints
+    ActiveConnectionPoolType & mActiveConnections;
+    const size_t mMaxActiveConnections;
 
     // Data to be sent when connections succeed
     PendingPacketPoolType & mPendingPackets;
 };
 
+/**
+ * A TCP transport of at most kActiveConnectionsSize connections. With heap pools, the state of the
+ * connections is only allocated while they are open.
+ */
 template <size_t kActiveConnectionsSize, size_t kPendingPacketSize>
 class TCP : public TCPBase
 {
 public:
-    TCP() : TCPBase(mConnectionsBuffer, kActiveConnectionsSize, mPendingPackets)
+    TCP() : TCPBase(mConnections, kActiveConnectionsSize, mPendingPackets) {}
+    ~TCP() override
     {
-        for (size_t i = 0; i < kActiveConnectionsSize; ++i)
-        {
-            mConnectionsBuffer[i].Init(nullptr);
-        }
+        // Connections must be closed before their pool is destroyed.
+        CloseActiveConnections();
+        mPendingPackets.ReleaseAll();
     }
-    ~TCP() override { mPendingPackets.ReleaseAll(); }
 
 private:
     friend class TCPTest;
-    TCPBase::ActiveConnectionState mConnectionsBuffer[kActiveConnectionsSize];
+    PoolImpl<ActiveConnectionState, kActiveConnectionsSize, ObjectPoolMem::kDefault, ActiveConnectionPoolType::Interface>
+        mConnections;
     PoolImpl<PendingPacket, kPendingPacketSize, ObjectPoolMem::kInline, PendingPacketPoolType::Interface> mPendingPackets;
 };
 
@@ -54,6 +54,10 @@ class TCPTest
 {
 public:
     static void CheckProcessReceivedBuffer(nlTestSuite * inSuite, void * inContext);
+    static void CheckConnectionPool(nlTestSuite * inSuite, void * inContext);
+
+private:
+    static size_t ActiveConnectionCount(TCPBase & tcp);
 };
 } // namespace Transport
 } // namespace chip
@@ -72,6 +76,8 @@ constexpr uint32_t kMessageCounter  = 18;
 
 using TestContext = chip::Test::IOContext;
 
+constexpr System::Clock::Milliseconds32 kDefaultIdleTimeout = System::Clock::Seconds32(CHIP_CONFIG_TCP_IDLE_TIMEOUT_SECS);
+
 const char PAYLOAD[] = "Hello!";
 
 class MockTransportMgrDelegate : public chip::TransportMgrDelegate
@@ -105,9 +111,21 @@ public:
         mReceiveHandlerCallCount++;
     }
 
-    void InitializeMessageTest(TCPImpl & tcp, const IPAddress & addr)
+    void OnConnectionClosed(const Transport::PeerAddress & peerAddress) override
+    {
+        NL_TEST_ASSERT(mSuite, peerAddress.GetTransportType() == Transport::Type::kTcp);
+
+        mLastClosedPeerAddress = peerAddress;
+        mConnectionClosedCallCount++;
+    }
+
+    void InitializeMessageTest(Transport::TCPBase & tcp, const IPAddress & addr,
+                               System::Clock::Milliseconds32 idleTimeout = kDefaultIdleTimeout)
     {
-        CHIP_ERROR err = tcp.Init(Transport::TcpListenParameters(mContext.GetTCPEndPointManager()).SetAddressType(addr.Type()));
+        Transport::TcpListenParameters params(mContext.GetTCPEndPointManager());
+        params.SetAddressType(addr.Type()).SetIdleTimeout(idleTimeout);
+
+        CHIP_ERROR err = tcp.Init(params);
 
         // retry a few times in case the port is somehow in use.
         // this is a WORKAROUND for flaky testing if we run tests very fast after each other.
@@ -126,7 +144,7 @@ public:
         {
             ChipLogProgress(NotSpecified, "RETRYING tcp initialization");
             chip::test_utils::SleepMillis(100);
-            err = tcp.Init(Transport::TcpListenParameters(mContext.GetTCPEndPointManager()).SetAddressType(addr.Type()));
+            err = tcp.Init(params);
         }
 
         NL_TEST_ASSERT(mSuite, err == CHIP_NO_ERROR);
@@ -134,10 +152,11 @@ public:
         mTransportMgrBase.SetSessionManager(this);
         mTransportMgrBase.Init(&tcp);
 
-        mReceiveHandlerCallCount = 0;
+        mReceiveHandlerCallCount   = 0;
+        mConnectionClosedCallCount = 0;
     }
 
-    void SingleMessageTest(TCPImpl & tcp, const IPAddress & addr)
+    void SingleMessageTest(Transport::TCPBase & tcp, const IPAddress & addr)
     {
         chip::System::PacketBufferHandle buffer = chip::System::PacketBufferHandle::NewWithData(PAYLOAD, sizeof(PAYLOAD));
         NL_TEST_ASSERT(mSuite, !buffer.IsNull());
@@ -161,14 +180,16 @@ public:
         SetCallback(nullptr);
     }
 
-    void FinalizeMessageTest(TCPImpl & tcp, const IPAddress & addr)
+    void FinalizeMessageTest(Transport::TCPBase & tcp, const IPAddress & addr)
     {
         // Disconnect and wait for seeing peer close
         tcp.Disconnect(Transport::PeerAddress::TCP(addr));
         mContext.DriveIOUntil(chip::System::Clock::Seconds16(5), [&tcp]() { return !tcp.HasActiveConnections(); });
     }
 
-    int mReceiveHandlerCallCount = 0;
+    int mReceiveHandlerCallCount   = 0;
+    int mConnectionClosedCallCount = 0;
+    Transport::PeerAddress mLastClosedPeerAddress;
 
 private:
     nlTestSuite * mSuite;
@@ -232,6 +253,30 @@ void CheckMessageTest6(nlTestSuite * inSuite, void * inContext)
     CheckMessageTest(inSuite, inContext, addr);
 }
 
+/////////////////////////// Idle timeout test
+
+#if INET_TCP_IDLE_CHECK_INTERVAL > 0
+void CheckIdleTimeoutTest(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx = *reinterpret_cast<TestContext *>(inContext);
+    TCPImpl tcp;
+
+    IPAddress addr;
+    IPAddress::FromString("::1", addr);
+
+    MockTransportMgrDelegate gMockTransportMgrDelegate(inSuite, ctx);
+    gMockTransportMgrDelegate.InitializeMessageTest(tcp, addr, System::Clock::Milliseconds32(500));
+    gMockTransportMgrDelegate.SingleMessageTest(tcp, addr);
+    NL_TEST_ASSERT(inSuite, tcp.HasActiveConnections());
+
+    // Both ends of the connection go idle: they are closed, and the delegate is told about each of them
+    ctx.DriveIOUntil(chip::System::Clock::Seconds16(5), [&tcp]() { return !tcp.HasActiveConnections(); });
+    NL_TEST_ASSERT(inSuite, !tcp.HasActiveConnections());
+    NL_TEST_ASSERT(inSuite, gMockTransportMgrDelegate.mConnectionClosedCallCount == 2);
+    NL_TEST_ASSERT(inSuite, gMockTransportMgrDelegate.mLastClosedPeerAddress.GetIPAddress() == addr);
+}
+#endif // INET_TCP_IDLE_CHECK_INTERVAL > 0
+
 // Generates a packet buffer or a chain of packet buffers for a single message.
 struct TestData
 {
@@ -359,6 +404,18 @@ void TestData::Free()
     mMessageOffset = 0;
 }
 
+// A packet buffer of [capacity] bytes holding the first [length] bytes of [data].
+System::PacketBufferHandle NewBufferWithData(const uint8_t * data, size_t length, size_t capacity)
+{
+    System::PacketBufferHandle buffer = System::PacketBufferHandle::New(capacity, 0 /* reserve */);
+    if (!buffer.IsNull())
+    {
+        memcpy(buffer->Start(), data, length);
+        buffer->SetDataLength(static_cast<uint16_t>(length));
+    }
+    return buffer;
+}
+
 int TestDataCallbackCheck(const uint8_t * message, size_t length, int count, void * data)
 {
     if (data == nullptr)
@@ -440,6 +497,36 @@ void chip::Transport::TCPTest::CheckProcessReceivedBuffer(nlTestSuite * inSuite,
     NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
     NL_TEST_ASSERT(inSuite, gMockTransportMgrDelegate.mReceiveHandlerCallCount == 2);
 
+    // Test two messages in a single packet buffer, the second one either shorter or longer than the first.
+    const uint16_t kTwoMessagesSizes[][2][2] = { { { 151, 0 }, { 60, 0 } }, { { 60, 0 }, { 151, 0 } } };
+    for (const auto & sizes : kTwoMessagesSizes)
+    {
+        gMockTransportMgrDelegate.mReceiveHandlerCallCount = 0;
+        NL_TEST_ASSERT(inSuite, testData[0].Init(sizes[0]));
+        NL_TEST_ASSERT(inSuite, testData[1].Init(sizes[1]));
+        uint8_t wire[512];
+        const size_t wireLength = testData[0].mTotalLength + testData[1].mTotalLength;
+        NL_TEST_ASSERT(inSuite, wireLength <= sizeof(wire));
+        memcpy(wire, testData[0].mPayload, testData[0].mTotalLength);
+        memcpy(wire + testData[0].mTotalLength, testData[1].mPayload, testData[1].mTotalLength);
+        err = tcp.ProcessReceivedBuffer(lEndPoint, lPeerAddress, NewBufferWithData(wire, wireLength, wireLength));
+        NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, gMockTransportMgrDelegate.mReceiveHandlerCallCount == 2);
+    }
+
+    // Test a message split across two packet buffers, the first one with room for the rest of the message.
+    gMockTransportMgrDelegate.mReceiveHandlerCallCount = 0;
+    NL_TEST_ASSERT(inSuite, testData[0].Init((const uint16_t[]){ 200, 0 }));
+    {
+        const size_t kSplit             = 50;
+        System::PacketBufferHandle head = NewBufferWithData(testData[0].mPayload, kSplit, testData[0].mTotalLength);
+        head.AddToEnd(NewBufferWithData(testData[0].mPayload + kSplit, testData[0].mTotalLength - kSplit,
+                                        testData[0].mTotalLength - kSplit));
+        err = tcp.ProcessReceivedBuffer(lEndPoint, lPeerAddress, std::move(head));
+    }
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, gMockTransportMgrDelegate.mReceiveHandlerCallCount == 1);
+
     // Test a message that is too large to coalesce into a single packet buffer.
     gMockTransportMgrDelegate.mReceiveHandlerCallCount = 0;
     gMockTransportMgrDelegate.SetCallback(TestDataCallbackCheck, &testData[1]);
@@ -453,6 +540,79 @@ void chip::Transport::TCPTest::CheckProcessReceivedBuffer(nlTestSuite * inSuite,
     gMockTransportMgrDelegate.FinalizeMessageTest(tcp, addr);
 }
 
+size_t chip::Transport::TCPTest::ActiveConnectionCount(TCPBase & tcp)
+{
+    size_t count = 0;
+    tcp.mActiveConnections.ForEachActiveObject([&count](TCPBase::ActiveConnectionState *) {
+        count++;
+        return Loop::Continue;
+    });
+    return count;
+}
+
+void chip::Transport::TCPTest::CheckConnectionPool(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx = *reinterpret_cast<TestContext *>(inContext);
+
+    IPAddress addr;
+    IPAddress::FromString("::1", addr);
+
+    {
+        TCPImpl tcp;
+
+        MockTransportMgrDelegate gMockTransportMgrDelegate(inSuite, ctx);
+        gMockTransportMgrDelegate.InitializeMessageTest(tcp, addr);
+
+        // A message to itself opens two connections, the one it is sent on and the one it is received on.
+        // Closing them releases their state, which the next connections reuse: there are more of them
+        // than the table holds.
+        constexpr int kRounds = 3;
+        static_assert(2 * kRounds > static_cast<int>(kMaxTcpActiveConnectionCount),
+                      "The connections must not all fit in the table");
+        for (int i = 0; i < kRounds; i++)
+        {
+            gMockTransportMgrDelegate.mReceiveHandlerCallCount = 0;
+            gMockTransportMgrDelegate.SingleMessageTest(tcp, addr);
+            NL_TEST_ASSERT(inSuite, tcp.mUsedEndPointCount == 2);
+            NL_TEST_ASSERT(inSuite, ActiveConnectionCount(tcp) == 2);
+
+            gMockTransportMgrDelegate.FinalizeMessageTest(tcp, addr);
+            NL_TEST_ASSERT(inSuite, tcp.mUsedEndPointCount == 0);
+            NL_TEST_ASSERT(inSuite, ActiveConnectionCount(tcp) == 0);
+        }
+
+        // Only the end closed by its peer is reported, not the one closed by Disconnect
+        NL_TEST_ASSERT(inSuite, gMockTransportMgrDelegate.mConnectionClosedCallCount == kRounds);
+    }
+
+    {
+        Transport::TCP<1, kMaxTcpPendingPackets> tcp;
+
+        MockTransportMgrDelegate gMockTransportMgrDelegate(inSuite, ctx);
+        gMockTransportMgrDelegate.InitializeMessageTest(tcp, addr);
+
+        // The connection being opened takes the only slot
+        CHIP_ERROR err = tcp.SendMessage(Transport::PeerAddress::TCP(addr),
+                                         chip::System::PacketBufferHandle::NewWithData(PAYLOAD, sizeof(PAYLOAD)));
+        NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, tcp.mUsedEndPointCount == 1);
+
+        // Messages to the same peer wait for that connection, others have no room
+        err = tcp.SendMessage(Transport::PeerAddress::TCP(addr),
+                              chip::System::PacketBufferHandle::NewWithData(PAYLOAD, sizeof(PAYLOAD)));
+        NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+        err = tcp.SendMessage(Transport::PeerAddress::TCP(addr, CHIP_PORT + 1),
+                              chip::System::PacketBufferHandle::NewWithData(PAYLOAD, sizeof(PAYLOAD)));
+        NL_TEST_ASSERT(inSuite, err == CHIP_ERROR_NO_MEMORY);
+
+        // The incoming connection is refused, so the message is not received, and the slot is released
+        ctx.DriveIOUntil(chip::System::Clock::Seconds16(5), [&tcp]() { return tcp.mUsedEndPointCount == 0; });
+        NL_TEST_ASSERT(inSuite, tcp.mUsedEndPointCount == 0);
+        NL_TEST_ASSERT(inSuite, !tcp.HasActiveConnections());
+        NL_TEST_ASSERT(inSuite, gMockTransportMgrDelegate.mReceiveHandlerCallCount == 0);
+    }
+}
+
 // Test Suite
 /**
  *  Test Suite that lists all the test functions.
@@ -468,6 +628,10 @@ static const nlTest sTests[] =
     NL_TEST_DEF("Simple Init Test IPV6",        CheckSimpleInitTest6),
     NL_TEST_DEF("Message Self Test IPV6",       CheckMessageTest6),
     NL_TEST_DEF("ProcessReceivedBuffer Test",   chip::Transport::TCPTest::CheckProcessReceivedBuffer),
+#if INET_TCP_IDLE_CHECK_INTERVAL > 0
+    NL_TEST_DEF("Idle Timeout Test",            CheckIdleTimeoutTest),
+#endif
+    NL_TEST_DEF("Connection Pool Test",         chip::Transport::TCPTest::CheckConnectionPool),
 
     NL_TEST_SENTINEL()
 };
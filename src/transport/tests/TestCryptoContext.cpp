@@ -23,8 +23,11 @@
 #include <lib/core/CHIPCore.h>
 #include <lib/support/CHIPMem.h>
 #include <lib/support/UnitTestRegistration.h>
+#include <protocols/echo/Echo.h>
 
+#include <system/SystemPacketBuffer.h>
 #include <transport/CryptoContext.h>
+#include <transport/SecureMessageCodec.h>
 
 using namespace chip;
 
@@ -67,10 +70,126 @@ void TestBuildPrivacyNonce(nlTestSuite * apSuite, void * apContext)
     }
 }
 
+void TestEncryptChainInPlace(nlTestSuite * apSuite, void * apContext)
+{
+    constexpr uint8_t kSecret[]        = "Test secret for key derivation.";
+    constexpr size_t kPlaintextLength  = 300;
+    constexpr size_t kBufferLengths[3] = { 7, 200, 93 };
+
+    CryptoContext initiator;
+    CryptoContext responder;
+    NL_TEST_ASSERT(apSuite,
+                   initiator.InitFromSecret(ByteSpan(kSecret), ByteSpan(), CryptoContext::SessionInfoType::kSessionEstablishment,
+                                            CryptoContext::SessionRole::kInitiator) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite,
+                   responder.InitFromSecret(ByteSpan(kSecret), ByteSpan(), CryptoContext::SessionInfoType::kSessionEstablishment,
+                                            CryptoContext::SessionRole::kResponder) == CHIP_NO_ERROR);
+
+    uint8_t plaintext[kPlaintextLength];
+    for (size_t i = 0; i < kPlaintextLength; i++)
+    {
+        plaintext[i] = static_cast<uint8_t>(i);
+    }
+
+    PacketHeader header;
+    header.SetSessionId(1).SetMessageCounter(2);
+    CryptoContext::NonceStorage nonce;
+    NL_TEST_ASSERT(apSuite, CryptoContext::BuildNonce(nonce, header.GetSecurityFlags(), 2, 0x1234) == CHIP_NO_ERROR);
+
+    // A chain of buffers which split AES blocks
+    System::PacketBufferHandle chain;
+    size_t offset = 0;
+    for (size_t length : kBufferLengths)
+    {
+        chain.AddToEnd(System::PacketBufferHandle::NewWithData(&plaintext[offset], length));
+        offset += length;
+    }
+    NL_TEST_ASSERT(apSuite, !chain.IsNull() && chain->TotalLength() == kPlaintextLength);
+
+    MessageAuthenticationCode chainMac;
+    NL_TEST_ASSERT(apSuite, initiator.EncryptInPlace(chain, nonce, header, chainMac) == CHIP_NO_ERROR);
+
+    // The chain is encrypted as the same data in a single buffer would be
+    uint8_t ciphertext[kPlaintextLength];
+    MessageAuthenticationCode mac;
+    NL_TEST_ASSERT(apSuite, initiator.Encrypt(plaintext, kPlaintextLength, ciphertext, nonce, header, mac) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, memcmp(chainMac.GetTag(), mac.GetTag(), header.MICTagLength()) == 0);
+
+    offset = 0;
+    for (System::PacketBufferHandle buffer = chain.Retain(); !buffer.IsNull(); buffer.Advance())
+    {
+        NL_TEST_ASSERT(apSuite, memcmp(buffer->Start(), &ciphertext[offset], buffer->DataLength()) == 0);
+        offset += buffer->DataLength();
+    }
+
+    uint8_t decrypted[kPlaintextLength];
+    NL_TEST_ASSERT(apSuite, responder.Decrypt(ciphertext, kPlaintextLength, decrypted, nonce, header, chainMac) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, memcmp(decrypted, plaintext, kPlaintextLength) == 0);
+}
+
+void TestEncryptChainAppendsTagBuffer(nlTestSuite * apSuite, void * apContext)
+{
+    constexpr uint8_t kSecret[] = "Test secret for key derivation.";
+
+    CryptoContext initiator;
+    CryptoContext responder;
+    NL_TEST_ASSERT(apSuite,
+                   initiator.InitFromSecret(ByteSpan(kSecret), ByteSpan(), CryptoContext::SessionInfoType::kSessionEstablishment,
+                                            CryptoContext::SessionRole::kInitiator) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite,
+                   responder.InitFromSecret(ByteSpan(kSecret), ByteSpan(), CryptoContext::SessionInfoType::kSessionEstablishment,
+                                            CryptoContext::SessionRole::kResponder) == CHIP_NO_ERROR);
+
+    PacketHeader packetHeader;
+    packetHeader.SetSessionId(1).SetMessageCounter(2);
+    CryptoContext::NonceStorage nonce;
+    NL_TEST_ASSERT(apSuite, CryptoContext::BuildNonce(nonce, packetHeader.GetSecurityFlags(), 2, 0x1234) == CHIP_NO_ERROR);
+
+    // A chain whose last buffer has no room left for the tag
+    uint8_t plaintext[150];
+    for (size_t i = 0; i < sizeof(plaintext); i++)
+    {
+        plaintext[i] = static_cast<uint8_t>(i);
+    }
+    System::PacketBufferHandle chain = System::PacketBufferHandle::NewWithData(plaintext, 50);
+    System::PacketBufferHandle full  = System::PacketBufferHandle::New(100, 0);
+    NL_TEST_ASSERT(apSuite, !chain.IsNull() && !full.IsNull());
+    // Move the start of the data up, so that it ends at the end of the buffer
+    full->SetStart(full->Start() + full->MaxDataLength() - 100);
+    memcpy(full->Start(), &plaintext[50], 100);
+    full->SetDataLength(100);
+    NL_TEST_ASSERT(apSuite, full->AvailableDataLength() == 0);
+    chain->AddToEnd(std::move(full));
+    const uint16_t plaintextLength = chain->TotalLength();
+
+    PayloadHeader payloadHeader;
+    payloadHeader.SetExchangeID(3).SetMessageType(Protocols::Echo::MsgType::EchoRequest);
+    NL_TEST_ASSERT(apSuite, SecureMessageCodec::Encrypt(initiator, nonce, payloadHeader, packetHeader, chain) == CHIP_NO_ERROR);
+
+    System::PacketBufferHandle tag = chain->Last();
+    NL_TEST_ASSERT(apSuite, tag->DataLength() == packetHeader.MICTagLength());
+    NL_TEST_ASSERT(apSuite,
+                   chain->TotalLength() == payloadHeader.EncodeSizeBytes() + plaintextLength + packetHeader.MICTagLength());
+
+    // Flatten the chain, as it is received
+    System::PacketBufferHandle message = System::PacketBufferHandle::New(chain->TotalLength());
+    NL_TEST_ASSERT(apSuite, !message.IsNull() && chain->Read(message->Start(), chain->TotalLength()) == CHIP_NO_ERROR);
+    message->SetDataLength(chain->TotalLength());
+
+    PayloadHeader decodedHeader;
+    NL_TEST_ASSERT(apSuite, SecureMessageCodec::Decrypt(responder, nonce, decodedHeader, packetHeader, message) == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(apSuite, decodedHeader.GetExchangeID() == 3);
+    NL_TEST_ASSERT(apSuite, decodedHeader.HasMessageType(Protocols::Echo::MsgType::EchoRequest));
+    NL_TEST_ASSERT(apSuite, message->DataLength() == plaintextLength);
+    NL_TEST_ASSERT(apSuite, memcmp(message->Start(), plaintext, plaintextLength) == 0);
+}
+
 /**
  *   Test Suite. It lists all the test functions.
  */
-const nlTest sTests[] = { NL_TEST_DEF("TestBuildPrivacyNonce", TestBuildPrivacyNonce), NL_TEST_SENTINEL() };
+const nlTest sTests[] = { NL_TEST_DEF("TestBuildPrivacyNonce", TestBuildPrivacyNonce),
+                          NL_TEST_DEF("TestEncryptChainInPlace", TestEncryptChainInPlace),
+                          NL_TEST_DEF("TestEncryptChainAppendsTagBuffer", TestEncryptChainAppendsTagBuffer), NL_TEST_SENTINEL() };
 
 /**
  *  Set up the test suite.
@@ -47,6 +47,13 @@ public:
     //
     static void ValidateSessionSorting(nlTestSuite * inSuite, void * inContext);
 
+    //
+    // This test creates sessions whose IDs collide in the session ID index, including
+    // a probe sequence wrapping around the end of the index, then removes them in an
+    // order that exercises the backward shift deletion.
+    //
+    static void ValidateIndexCollisions(nlTestSuite * inSuite, void * inContext);
+
 private:
     struct SessionParameters
     {
@@ -88,6 +95,11 @@ private:
     //
     void CreateSessionTable(std::vector<SessionParameters> & sessionParams);
 
+    //
+    // Checks that the index holds exactly the given sessions and that each of them is found by its ID.
+    //
+    static void CheckIndex(nlTestSuite * inSuite, SecureSessionTable & table, const std::vector<SecureSession *> & sessions);
+
     nlTestSuite * mTestSuite;
     Platform::UniquePtr<SecureSessionTable> mSessionTable;
     std::vector<Platform::UniquePtr<SessionNotificationListener>> mSessionList;
@@ -363,6 +375,96 @@ void TestSecureSessionTable::ValidateSessionSorting(nlTestSuite * inSuite, void
     }
 }
 
+void TestSecureSessionTable::CheckIndex(nlTestSuite * inSuite, SecureSessionTable & table,
+                                        const std::vector<SecureSession *> & sessions)
+{
+    NL_TEST_ASSERT(inSuite, table.mIndexCount == sessions.size());
+    for (SecureSession * session : sessions)
+    {
+        auto found = table.FindSecureSessionByLocalKey(session->GetLocalSessionId());
+        NL_TEST_ASSERT(inSuite, found.HasValue() && found.Value()->AsSecureSession() == session);
+    }
+}
+
+void TestSecureSessionTable::ValidateIndexCollisions(nlTestSuite * inSuite, void * inContext)
+{
+    auto table = Platform::MakeUnique<SecureSessionTable>();
+    NL_TEST_ASSERT(inSuite, table.get() != nullptr);
+    table->Init();
+
+    std::vector<SecureSession *> sessions;
+    auto createSession = [&](uint16_t localSessionId) {
+        auto session = table->CreateNewSecureSessionForTest(SecureSession::Type::kPASE, localSessionId, kUndefinedNodeId,
+                                                            kUndefinedNodeId, CATValues{}, localSessionId, kUndefinedFabricIndex,
+                                                            GetDefaultMRPConfig());
+        NL_TEST_ASSERT(inSuite, session.HasValue());
+        if (session.HasValue())
+        {
+            sessions.push_back(session.Value()->AsSecureSession());
+        }
+    };
+    // kUnsecuredSessionId for an empty slot
+    auto idAtSlot = [&](size_t slot) {
+        return (table->mIndex[slot] != nullptr) ? table->mIndex[slot]->GetLocalSessionId() : kUnsecuredSessionId;
+    };
+    auto removeSession = [&](uint16_t localSessionId) {
+        for (auto it = sessions.begin(); it != sessions.end(); ++it)
+        {
+            if ((*it)->GetLocalSessionId() == localSessionId)
+            {
+                (*it)->MarkForEviction();
+                sessions.erase(it);
+                break;
+            }
+        }
+        NL_TEST_ASSERT(inSuite, !table->FindSecureSessionByLocalKey(localSessionId).HasValue());
+        CheckIndex(inSuite, *table, sessions);
+    };
+
+    // The index is allocated by the first session on heap pools, so its capacity is only known then.
+    createSession(1);
+    const auto capacity = static_cast<uint16_t>(table->mIndexCapacity);
+    NL_TEST_ASSERT(inSuite, capacity >= 16);
+    removeSession(1);
+
+    // The sessions fill a single probe sequence, from the last slot of the index around to its start:
+    //   slot:  capacity-1   0              1              2         3   4
+    //   id:    capacity-1   2*capacity-1   3*capacity-1   capacity  1   2
+    // where the IDs home at slots capacity-1, capacity-1, capacity-1, 0, 1 and 2.
+    createSession(static_cast<uint16_t>(capacity - 1));
+    createSession(static_cast<uint16_t>(2 * capacity - 1));
+    createSession(static_cast<uint16_t>(3 * capacity - 1));
+    createSession(capacity);
+    createSession(1);
+    createSession(2);
+    CheckIndex(inSuite, *table, sessions);
+    NL_TEST_ASSERT(inSuite, idAtSlot(capacity - 1) == capacity - 1);
+    NL_TEST_ASSERT(inSuite, idAtSlot(2) == capacity);
+    NL_TEST_ASSERT(inSuite, idAtSlot(4) == 2);
+
+    // IDs which share the home slot of the sessions but are not in the table
+    NL_TEST_ASSERT(inSuite, !table->FindSecureSessionByLocalKey(static_cast<uint16_t>(4 * capacity - 1)).HasValue());
+    NL_TEST_ASSERT(inSuite, !table->FindSecureSessionByLocalKey(static_cast<uint16_t>(2 * capacity)).HasValue());
+
+    // Removing the head of the sequence shifts every following entry back across the end of the index
+    removeSession(static_cast<uint16_t>(capacity - 1));
+    NL_TEST_ASSERT(inSuite, idAtSlot(capacity - 1) == 2 * capacity - 1);
+    NL_TEST_ASSERT(inSuite, table->mIndex[4] == nullptr);
+
+    // Removing an entry in the middle of the sequence
+    removeSession(capacity);
+
+    // Removing the entry which wrapped around leaves the ones after it reachable
+    removeSession(static_cast<uint16_t>(3 * capacity - 1));
+    removeSession(static_cast<uint16_t>(2 * capacity - 1));
+    NL_TEST_ASSERT(inSuite, table->mIndex[capacity - 1] == nullptr);
+    NL_TEST_ASSERT(inSuite, table->mIndex[0] == nullptr);
+
+    removeSession(2);
+    removeSession(1);
+    NL_TEST_ASSERT(inSuite, table->mIndexCount == 0);
+}
+
 Platform::UniquePtr<TestSecureSessionTable> gTestSecureSessionTable;
 
 } // namespace Transport
@@ -379,6 +481,7 @@ namespace {
 const nlTest sTests[] =
 {
     NL_TEST_DEF("Validate Session Sorting (Over Minima)",               chip::Transport::TestSecureSessionTable::ValidateSessionSorting),
+    NL_TEST_DEF("Validate Session Index Collisions",                     chip::Transport::TestSecureSessionTable::ValidateIndexCollisions),
     NL_TEST_SENTINEL()
 };
 // clang-format on
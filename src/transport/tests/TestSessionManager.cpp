@@ -991,6 +991,86 @@ static void SessionShiftingTest(nlTestSuite * inSuite, void * inContext)
     sessionManager.Shutdown();
 }
 
+void SessionTransportTest(nlTestSuite * inSuite, void * inContext)
+{
+    TestContext & ctx = *reinterpret_cast<TestContext *>(inContext);
+
+    IPAddress addr;
+    IPAddress::FromString("::1", addr);
+
+    FabricTableHolder fabricTableHolder;
+    secure_channel::MessageCounterManager messageCounterManager;
+    TestPersistentStorageDelegate deviceStorage;
+
+    SessionManager sessionManager;
+
+    NL_TEST_ASSERT(inSuite, CHIP_NO_ERROR == fabricTableHolder.Init());
+    NL_TEST_ASSERT(inSuite,
+                   CHIP_NO_ERROR ==
+                       sessionManager.Init(&ctx.GetSystemLayer(), &ctx.GetTransportMgr(), &messageCounterManager, &deviceStorage,
+                                           &fabricTableHolder.GetFabricTable()));
+
+    const Transport::PeerAddress udpPeer(Transport::PeerAddress::UDP(addr, CHIP_PORT));
+    const Transport::PeerAddress tcpPeer(Transport::PeerAddress::TCP(addr, CHIP_PORT));
+
+    // Peers opening a TCP connection do it from an ephemeral port
+    const Transport::PeerAddress ephemeralPeer(Transport::PeerAddress::TCP(addr, 50001));
+    const Transport::PeerAddress otherEphemeralPeer(Transport::PeerAddress::TCP(addr, 50002));
+
+    SessionHolder session;
+    CHIP_ERROR err = sessionManager.InjectPaseSessionWithTestKey(session, 1, kUndefinedNodeId, 2, kUndefinedFabricIndex, udpPeer,
+                                                                 CryptoContext::SessionRole::kInitiator);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+
+    SessionHolder tcpSession;
+    err = sessionManager.InjectPaseSessionWithTestKey(tcpSession, 3, kUndefinedNodeId, 4, kUndefinedFabricIndex, otherEphemeralPeer,
+                                                      CryptoContext::SessionRole::kInitiator);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+
+    SecureSession * secure    = session->AsSecureSession();
+    SecureSession * tcpSecure = tcpSession->AsSecureSession();
+
+    // ==== Move the session to TCP and back ====
+    err = sessionManager.SetSessionTransport(session.Get().Value(), Transport::Type::kTcp);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, secure->GetPeerAddress() == tcpPeer);
+
+    err = sessionManager.SetSessionTransport(session.Get().Value(), Transport::Type::kTcp);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, secure->GetPeerAddress() == tcpPeer);
+
+    err = sessionManager.SetSessionTransport(session.Get().Value(), Transport::Type::kUdp);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, secure->GetPeerAddress() == udpPeer);
+
+    err = sessionManager.SetSessionTransport(session.Get().Value(), Transport::Type::kBle);
+    NL_TEST_ASSERT(inSuite, err == CHIP_ERROR_INVALID_ARGUMENT);
+    NL_TEST_ASSERT(inSuite, secure->GetPeerAddress() == udpPeer);
+
+    // ==== A session on a connection opened by the peer goes back to its UDP address ====
+    secure->SetPeerAddress(ephemeralPeer);
+    err = sessionManager.SetSessionTransport(session.Get().Value(), Transport::Type::kUdp);
+    NL_TEST_ASSERT(inSuite, err == CHIP_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, secure->GetPeerAddress() == udpPeer);
+
+    // ==== Closing the connection moves its sessions back to UDP, and only them ====
+    secure->SetPeerAddress(ephemeralPeer);
+
+    sessionManager.OnConnectionClosed(udpPeer);
+    NL_TEST_ASSERT(inSuite, secure->GetPeerAddress() == ephemeralPeer);
+
+    sessionManager.OnConnectionClosed(ephemeralPeer);
+    NL_TEST_ASSERT(inSuite, secure->GetPeerAddress() == udpPeer);
+    NL_TEST_ASSERT(inSuite, tcpSecure->GetPeerAddress() == otherEphemeralPeer);
+
+    // Without a UDP address, the session keeps the address of the connection over UDP
+    sessionManager.OnConnectionClosed(otherEphemeralPeer);
+    NL_TEST_ASSERT(inSuite, tcpSecure->GetPeerAddress() == Transport::PeerAddress::UDP(addr, otherEphemeralPeer.GetPort()));
+    NL_TEST_ASSERT(inSuite, secure->GetPeerAddress() == udpPeer);
+
+    sessionManager.Shutdown();
+}
+
 // Test Suite
 
 /**
@@ -1008,6 +1088,7 @@ const nlTest sTests[] =
     NL_TEST_DEF("Session Allocation Test",        SessionAllocationTest),
     NL_TEST_DEF("Session Counter Exhausted Test", SessionCounterExhaustedTest),
     NL_TEST_DEF("SessionShiftingTest",            SessionShiftingTest),
+    NL_TEST_DEF("Session Transport Test",         SessionTransportTest),
 
     NL_TEST_SENTINEL()
 };
@@ -0,0 +1,271 @@
+/*
+ *
+ *    Copyright (c) 2022 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements chip-session-lookup-bench, which measures how the number of secure sessions affects the handling
+ *      of received messages by the SessionManager.
+ *
+ *      A SessionManager holds a given number of idle sessions, established before the pair of sessions exchanging messages
+ *      over the loopback transport of the unit tests. Every received message looks its session up by local session ID.
+ */
+
+#define CHIP_ENABLE_TEST_ENCRYPTED_BUFFER_API // Up here in case some other header
+                                              // includes SessionManager.h indirectly
+
+#include <CHIPVersion.h>
+#include <credentials/PersistentStorageOpCertStore.h>
+#include <crypto/PersistentStorageOperationalKeystore.h>
+#include <lib/support/CHIPArgParser.hpp>
+#include <lib/support/CHIPMem.h>
+#include <lib/support/CodeUtils.h>
+#include <lib/support/TestPersistentStorageDelegate.h>
+#include <lib/support/logging/CHIPLogging.h>
+#include <protocols/echo/Echo.h>
+#include <protocols/secure_channel/MessageCounterManager.h>
+#include <transport/SessionManager.h>
+#include <transport/tests/LoopbackTransportManager.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <vector>
+
+#undef CHIP_ENABLE_TEST_ENCRYPTED_BUFFER_API
+
+namespace {
+
+using namespace chip;
+using namespace chip::ArgParser;
+using namespace chip::Transport;
+
+#define TOOL_NAME "chip-session-lookup-bench"
+#define COPYRIGHT_STRING "Copyright (c) 2022 Project CHIP Authors.\nAll rights reserved.\n"
+
+const uint8_t kPayload[] = "Hello!";
+
+bool HandleOption(const char * progName, OptionSet * optSet, int id, const char * name, const char * arg);
+
+// clang-format off
+OptionDef gCmdOptionDefs[] =
+{
+    { "sessions",      kArgumentRequired, 's' },
+    { "messages",      kArgumentRequired, 'm' },
+    { }
+};
+
+const char * const gCmdOptionHelp =
+    "   -s, --sessions <count>\n"
+    "\n"
+    "       Number of idle sessions. Defaults to 2000, capped by the session pool size when it is not on the heap.\n"
+    "\n"
+    "   -m, --messages <count>\n"
+    "\n"
+    "       Number of messages sent and received. Defaults to 1000.\n"
+    "\n"
+    ;
+
+OptionSet gCmdOptions =
+{
+    HandleOption,
+    gCmdOptionDefs,
+    "COMMAND OPTIONS",
+    gCmdOptionHelp
+};
+
+HelpOptions gHelpOptions(
+    TOOL_NAME,
+    "Usage: " TOOL_NAME " [ <options...> ]\n",
+    CHIP_VERSION_STRING "\n" COPYRIGHT_STRING,
+    "Measure the handling of received messages by a SessionManager holding many idle sessions."
+);
+
+OptionSet * gCmdOptionSets[] =
+{
+    &gCmdOptions,
+    &gHelpOptions,
+    nullptr
+};
+// clang-format on
+
+uint32_t gIdleSessionCount = 2000;
+uint32_t gMessageCount     = 1000;
+
+bool HandleOption(const char * progName, OptionSet * optSet, int id, const char * name, const char * arg)
+{
+    bool valid = true;
+
+    switch (id)
+    {
+    case 's':
+        // Session IDs 1 and 2 are used by the sessions exchanging messages
+        valid = ParseInt(arg, gIdleSessionCount) && gIdleSessionCount < UINT16_MAX - 100;
+        break;
+    case 'm':
+        valid = ParseInt(arg, gMessageCount) && gMessageCount > 0;
+        break;
+    default:
+        PrintArgError("%s: INTERNAL ERROR: Unhandled option: %s\n", progName, name);
+        return false;
+    }
+
+    if (!valid)
+    {
+        PrintArgError("%s: Invalid value specified for %s: %s\n", progName, name, arg);
+    }
+    return valid;
+}
+
+class CountingDelegate : public SessionMessageDelegate
+{
+public:
+    void OnMessageReceived(const PacketHeader & header, const PayloadHeader & payloadHeader, const SessionHandle & session,
+                           DuplicateMessage isDuplicate, System::PacketBufferHandle && msgBuf) override
+    {
+        mReceived++;
+    }
+
+    uint32_t mReceived = 0;
+};
+
+CHIP_ERROR RunBench(Test::LoopbackTransportManager & ctx, uint32_t idleSessionCount, uint64_t & durationUs)
+{
+    TestPersistentStorageDelegate storage;
+    PersistentStorageOperationalKeystore opKeyStore;
+    Credentials::PersistentStorageOpCertStore opCertStore;
+    FabricTable fabricTable;
+
+    ReturnErrorOnFailure(opKeyStore.Init(&storage));
+    ReturnErrorOnFailure(opCertStore.Init(&storage));
+
+    FabricTable::InitParams initParams;
+    initParams.storage             = &storage;
+    initParams.operationalKeystore = &opKeyStore;
+    initParams.opCertStore         = &opCertStore;
+    ReturnErrorOnFailure(fabricTable.Init(initParams));
+
+    CountingDelegate delegate;
+    SessionManager sessionManager;
+    secure_channel::MessageCounterManager messageCounterManager;
+    ReturnErrorOnFailure(
+        sessionManager.Init(&ctx.GetSystemLayer(), &ctx.GetTransportMgr(), &messageCounterManager, &storage, &fabricTable));
+    sessionManager.SetMessageDelegate(&delegate);
+
+    Inet::IPAddress addr;
+    Inet::IPAddress::FromString("::1", addr);
+    const PeerAddress peer = PeerAddress::UDP(addr, CHIP_PORT);
+
+    CHIP_ERROR err = CHIP_NO_ERROR;
+
+    // Sessions with other peers, established before the ones exchanging messages
+    std::vector<SessionHolder> idleSessions(idleSessionCount);
+    for (uint32_t i = 0; i < idleSessionCount && err == CHIP_NO_ERROR; i++)
+    {
+        const auto sessionId = static_cast<uint16_t>(100 + i);
+        err = sessionManager.InjectPaseSessionWithTestKey(idleSessions[i], sessionId, kUndefinedNodeId, sessionId,
+                                                          kUndefinedFabricIndex, peer, CryptoContext::SessionRole::kInitiator);
+    }
+
+    SessionHolder senderSession;
+    SessionHolder receiverSession;
+    SuccessOrExit(err);
+    SuccessOrExit(err = sessionManager.InjectPaseSessionWithTestKey(senderSession, 2, kUndefinedNodeId, 1, kUndefinedFabricIndex,
+                                                                    peer, CryptoContext::SessionRole::kInitiator));
+    SuccessOrExit(err = sessionManager.InjectPaseSessionWithTestKey(receiverSession, 1, kUndefinedNodeId, 2, kUndefinedFabricIndex,
+                                                                    peer, CryptoContext::SessionRole::kResponder));
+
+    {
+        PayloadHeader payloadHeader;
+        payloadHeader.SetExchangeID(0);
+        payloadHeader.SetMessageType(Protocols::Echo::MsgType::EchoRequest);
+
+        const uint64_t start = System::SystemClock().GetMonotonicMicroseconds64().count();
+        for (uint32_t i = 0; i < gMessageCount; i++)
+        {
+            System::PacketBufferHandle buffer = MessagePacketBuffer::NewWithData(kPayload, sizeof(kPayload));
+            VerifyOrExit(!buffer.IsNull(), err = CHIP_ERROR_NO_MEMORY);
+
+            EncryptedPacketBufferHandle preparedMessage;
+            SuccessOrExit(err = sessionManager.PrepareMessage(senderSession.Get().Value(), payloadHeader, std::move(buffer),
+                                                              preparedMessage));
+            SuccessOrExit(err = sessionManager.SendPreparedMessage(senderSession.Get().Value(), preparedMessage));
+
+            ctx.DrainAndServiceIO();
+        }
+        durationUs = System::SystemClock().GetMonotonicMicroseconds64().count() - start;
+
+        VerifyOrExit(delegate.mReceived == gMessageCount, err = CHIP_ERROR_INTERNAL);
+    }
+
+exit:
+    idleSessions.clear();
+    senderSession.Release();
+    receiverSession.Release();
+    sessionManager.Shutdown();
+    fabricTable.Shutdown();
+    opKeyStore.Finish();
+    opCertStore.Finish();
+    return err;
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    if (!ParseArgs(TOOL_NAME, argc, argv, gCmdOptionSets))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (Platform::MemoryInit() != CHIP_NO_ERROR)
+    {
+        fprintf(stderr, "Failed to initialize the memory\n");
+        return EXIT_FAILURE;
+    }
+
+    // Every session and every message is logged.
+    Logging::SetLogFilter(Logging::kLogCategory_Error);
+
+#if !CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+    gIdleSessionCount = std::min<uint32_t>(gIdleSessionCount, CHIP_CONFIG_SECURE_SESSION_POOL_SIZE - 2);
+#endif
+
+    Test::LoopbackTransportManager ctx;
+    CHIP_ERROR err = ctx.Init();
+
+    uint64_t durationUs = 0;
+    if (err == CHIP_NO_ERROR)
+    {
+        err = RunBench(ctx, gIdleSessionCount, durationUs);
+        ctx.Shutdown();
+    }
+
+    int status = EXIT_SUCCESS;
+    if (err != CHIP_NO_ERROR)
+    {
+        printf("Failed: %" CHIP_ERROR_FORMAT "\n", err.Format());
+        status = EXIT_FAILURE;
+    }
+    else
+    {
+        printf("%10s %10s %12s %14s\n", "sessions", "messages", "time (us)", "us/message");
+        printf("%10" PRIu32 " %10" PRIu32 " %12" PRIu64 " %14.2f\n", gIdleSessionCount + 2, gMessageCount, durationUs,
+               static_cast<double>(durationUs) / gMessageCount);
+    }
+
+    Platform::MemoryShutdown();
+    return status;
+}